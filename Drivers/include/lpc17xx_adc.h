@@ -38,6 +38,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "LPC17xx.h"
 #include "lpc_types.h"
+#include "lpc17xx_gpdma.h"
 
 
 #ifdef __cplusplus
@@ -45,6 +46,27 @@ extern "C"
 {
 #endif
 
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup ADC_Public_Macros ADC Public Macros
+ * @{
+ */
+
+/** Acquisition engine status: at least one block is ready to read */
+#define ADC_ACQ_DONE			((1UL<<0))
+/** Acquisition engine status: blocks were overwritten before being read */
+#define ADC_ACQ_OVERRUN			((1UL<<1))
+/** Acquisition engine status: conversions were lost in ADC (OVERRUN bit) */
+#define ADC_ACQ_HW_OVERRUN		((1UL<<2))
+/** Acquisition engine status: GPDMA error, acquisition is stopped */
+#define ADC_ACQ_ERROR			((1UL<<3))
+
+/** Convert a 12-bit result to q15: mid-scale is 0, full range is [-1, 1) */
+#define ADC_ACQ_Q15(n)			((int16_t)(((n) << 4) - 0x8000))
+
+/**
+ * @}
+ */
+
 /* Private macros ------------------------------------------------------------- */
 /** @defgroup ADC_Private_Macros ADC Private Macros
  * @{
@@ -248,6 +270,34 @@ typedef enum
 	ADC_DATA_DONE		 /*Done bit*/
 }ADC_DATA_STATUS;
 
+/** @brief ADC acquisition engine: conversions of a channel set are moved
+ * by GPDMA from ADGDR into a circular buffer of blocks, then split per
+ * channel by ADC_AcqRead(). The application fills the configuration
+ * fields, the other fields are for driver use. */
+typedef struct {
+	uint8_t ChannelMask;	/**< Configuration: channels to convert, bit n is AD0.n.
+								 Timer triggered start converts one channel only */
+	uint8_t DMAChannel;		/**< Configuration: GPDMA channel, 0 to 7 */
+	uint8_t StartMode;		/**< Configuration: start mode, should be:
+								 - ADC_START_CONTINUOUS: burst mode, ADC rate
+								 is shared by all channels in ChannelMask
+								 - ADC_START_ON_xxx: one conversion per edge,
+								 e.g. ADC_START_ON_MAT01 paced by timer match */
+	uint8_t EdgeOption;		/**< Configuration: ADC_START_ON_RISING or
+								 ADC_START_ON_FALLING, used with ADC_START_ON_xxx */
+	uint16_t BlockSize;		/**< Configuration: conversions per block, 1 to 4095 */
+	uint16_t NumBlocks;		/**< Configuration: blocks in buffer, at least 2 */
+	uint32_t* buf;			/**< Configuration: raw ADGDR words, BlockSize * NumBlocks */
+	GPDMA_LLI_Type* lli;	/**< Configuration: NumBlocks LLIs, word aligned */
+	__IO uint32_t head;		/**< Blocks completed, updated by ADC_AcqDMAHandler() */
+	uint32_t tail;			/**< Blocks read, updated by ADC_AcqRead() */
+	uint32_t overrun;		/**< Blocks overwritten before being read */
+	uint32_t hw_overrun;	/**< Conversions with OVERRUN bit set */
+	uint32_t flags;			/**< ADC_ACQ_OVERRUN/ADC_ACQ_HW_OVERRUN since last
+								 ADC_AcqGetStatus() */
+	__IO uint32_t error;	/**< GPDMA errors */
+} ADC_ACQ_Type;
+
 /**
  * @}
  */
@@ -277,6 +327,14 @@ FlagStatus ADC_ChannelGetStatus(LPC_ADC_TypeDef *ADCx, uint8_t channel, uint32_t
 uint32_t ADC_GlobalGetData(LPC_ADC_TypeDef *ADCx);
 FlagStatus	ADC_GlobalGetStatus(LPC_ADC_TypeDef *ADCx, uint32_t StatusType);
 
+/* Acquisition engine functions -------------------*/
+Status ADC_AcqInit(LPC_ADC_TypeDef *ADCx, ADC_ACQ_Type *acq);
+void ADC_AcqStart(LPC_ADC_TypeDef *ADCx, ADC_ACQ_Type *acq);
+void ADC_AcqStop(LPC_ADC_TypeDef *ADCx, ADC_ACQ_Type *acq);
+void ADC_AcqDMAHandler(ADC_ACQ_Type *acq);
+uint32_t ADC_AcqGetStatus(ADC_ACQ_Type *acq);
+uint32_t ADC_AcqRead(ADC_ACQ_Type *acq, int16_t *dst[8], uint32_t len, uint32_t num[8]);
+
 /**
  * @}
  */
@@ -0,0 +1,204 @@
+/**********************************************************************
+* $Id$		lpc17xx_blkdev.h				2011-03-09
+*//**
+* @file		lpc17xx_blkdev.h
+* @brief	Contains the block device interface (asynchronous block
+* 			read/write with completion callback) and the sector cache
+* 			block device for LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup BLKDEV BLKDEV
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC17XX_BLKDEV_H_
+#define LPC17XX_BLKDEV_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup BLKDEV_Public_Macros BLKDEV Public Macros
+ * @{
+ */
+
+/** Maximum number of cache lines */
+#define BLK_CACHE_LINE_MAX		32
+/** Maximum number of blocks per cache line (one bit each in Valid/Dirty) */
+#define BLK_CACHE_BLOCKS_MAX	32
+/** Tag of a free cache line */
+#define BLK_CACHE_NO_TAG		0xFFFFFFFF
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup BLKDEV_Public_Types BLKDEV Public Types
+ * @{
+ */
+
+/** Completion callback: status is SUCCESS or ERROR */
+typedef void (*BLKDEV_DONE)(void *arg, Status status);
+
+/**
+ * @brief Block device. A driver fills BlockSize, BlockCount and the entry
+ * points, the user of the device fills Done and arg.
+ *
+ * Read() and Write() start a transfer of n blocks from block lba and
+ * return at once. They return ERROR only when the request is refused
+ * (device busy, or out of range); otherwise Done() is called exactly once
+ * when the transfer is over, possibly before Read()/Write() returns. The
+ * buffer must stay valid until then. One request at a time: Busy is set
+ * while a request is in progress.
+ *
+ * The entry points, Poll() and the interrupt handlers of the driver must
+ * run at a single interrupt priority (or with it masked): they are not
+ * reentrant against each other.
+ */
+typedef struct _BLKDEV_Type {
+	uint32_t BlockSize;			/**< Block size (bytes) */
+	uint32_t BlockCount;		/**< Number of blocks */
+	Status (*Read)(struct _BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n);
+								/**< Start reading n blocks from lba into buf */
+	Status (*Write)(struct _BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n);
+								/**< Start writing n blocks from buf to lba */
+	Status (*Sync)(struct _BLKDEV_Type *dev);	/**< Start writing back all
+								 buffered data, Done() when it is on the medium.
+								 NULL if the device buffers nothing */
+	void (*Poll)(struct _BLKDEV_Type *dev);	/**< Background work and timeouts,
+								 to be called periodically. May be NULL */
+	BLKDEV_DONE Done;			/**< Completion callback, set by the user */
+	void *arg;					/**< Argument of Done() */
+	__IO uint8_t Busy;			/**< A request is in progress */
+	uint8_t Reserved[3];
+} BLKDEV_Type;
+
+/**
+ * @brief Cache line: LineBlocks blocks from block Tag, with one Valid
+ * and one Dirty bit per block.
+ */
+typedef struct {
+	uint32_t Tag;				/**< First block, BLK_CACHE_NO_TAG when free */
+	uint32_t Valid;				/**< Blocks read from or written to the line */
+	uint32_t Dirty;				/**< Blocks not yet written back */
+	uint32_t Used;				/**< Last use, for LRU replacement */
+} BLK_CACHE_LINE_Type;
+
+/**
+ * @brief Sector cache: a block device in front of another one. Reads
+ * are served from lines filled in whole runs of blocks, sequential reads
+ * prefetch the next lines (read-ahead); writes are kept in the lines and
+ * coalesced into multi-block writes of the lower device (write-back).
+ * Dirty lines are written back when evicted, when fully written, by
+ * Sync(), and after FlushDelay idle Poll() calls.
+ *
+ * The application fills the configuration fields, the other fields are
+ * for driver use. The lower device Done/arg are taken over by
+ * BLK_CacheInit().
+ */
+typedef struct {
+	BLKDEV_Type dev;			/**< Block device interface, filled by
+								 BLK_CacheInit() */
+	BLKDEV_Type *Lower;			/**< Configuration: cached device */
+	uint8_t *Buf;				/**< Configuration: NumLines * LineBlocks blocks,
+								 reachable by the DMA of the lower device */
+	uint8_t NumLines;			/**< Configuration: 1 to BLK_CACHE_LINE_MAX */
+	uint8_t LineBlocks;			/**< Configuration: 1 to BLK_CACHE_BLOCKS_MAX */
+	uint8_t ReadAhead;			/**< Configuration: lines prefetched after a
+								 sequential read, 0 disables read-ahead, at most
+								 NumLines - 1 */
+	uint8_t Reserved;
+	uint32_t FlushDelay;		/**< Configuration: idle Poll() calls before
+								 dirty lines are written back, 0 never */
+	BLK_CACHE_LINE_Type line[BLK_CACHE_LINE_MAX];	/**< Cache lines */
+	uint8_t op;					/**< Request in progress */
+	uint8_t ioop;				/**< Lower device operation in progress */
+	uint8_t ioreq;				/**< Lower operation is part of the request */
+	uint8_t run;				/**< Request processing is running */
+	uint8_t miss;				/**< Request waited for a lower device read */
+	uint8_t bgerr;				/**< Background write-back failed, retried at
+								 the next request */
+	uint8_t Reserved2[2];
+	uint32_t lba;				/**< Request: next block */
+	uint32_t n;					/**< Request: blocks left */
+	uint8_t *buf;				/**< Request: next buffer position */
+	Status status;				/**< Request status */
+	BLK_CACHE_LINE_Type *io;	/**< Line of the lower operation */
+	uint32_t iomask;			/**< Blocks of the lower operation */
+	uint32_t next;				/**< Block following the last read request */
+	uint32_t ahead;				/**< Next block to prefetch */
+	uint32_t aheadn;			/**< Lines left to prefetch */
+	uint32_t clock;				/**< LRU clock */
+	uint32_t idle;				/**< Idle Poll() calls */
+	uint32_t reads;				/**< Statistics: read requests */
+	uint32_t misses;			/**< Statistics: read requests that waited for
+								 the lower device */
+	uint32_t fills;				/**< Statistics: lower device reads */
+	uint32_t writebacks;		/**< Statistics: lower device writes */
+} BLK_CACHE_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup BLKDEV_Public_Functions BLKDEV Public Functions
+ * @{
+ */
+
+/* Synchronous access --------------------*/
+Status BLK_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n);
+Status BLK_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n);
+Status BLK_Sync(BLKDEV_Type *dev);
+void BLK_Poll(BLKDEV_Type *dev);
+
+/* Sector cache --------------------------*/
+Status BLK_CacheInit(BLK_CACHE_Type *cache);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_BLKDEV_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
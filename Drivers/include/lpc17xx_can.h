@@ -297,6 +297,30 @@ extern "C"
 /** CAN control 11-bit or 29-bit Identifier */
 #define CAN_TFI_FF				((uint32_t)(1<<31))
 
+/*********************************************************************//**
+ * Macro defines for FullCAN message object (first word)
+ **********************************************************************/
+/** FullCAN object semaphore bits */
+#define CAN_FCAN_SEM_MASK		((uint32_t)(3<<24))
+/** FullCAN object is being updated by acceptance filter */
+#define CAN_FCAN_SEM_UPDATING	((uint32_t)(1<<24))
+/** FullCAN object has been updated by acceptance filter */
+#define CAN_FCAN_SEM_DONE		((uint32_t)(3<<24))
+
+/*********************************************************************//**
+ * Macro defines for CAN_RXFRAME_Type (receive ring frame) fields
+ **********************************************************************/
+/** Time stamp, timer ticks modulo 2^28 */
+#define CAN_RXFRAME_TIME(f)		((f)->stamp >> 4)
+/** Data Length Code */
+#define CAN_RXFRAME_DLC(f)		((f)->stamp & 0x0F)
+/** Identifier, 11 or 29 bit */
+#define CAN_RXFRAME_ID(f)			((f)->id & 0x1FFFFFFF)
+/** Remote frame */
+#define CAN_RXFRAME_IS_RTR(f)		(((f)->id >> 30) & 0x01)
+/** Extended (29 bit) identifier */
+#define CAN_RXFRAME_IS_EXT(f)		(((f)->id >> 31) & 0x01)
+
 /*********************************************************************//**
  * Macro defines for CAN Transmit Identifier Register
  **********************************************************************/
@@ -478,7 +502,7 @@ extern "C"
 #define PARAM_I2S_DATA(data) 	((data>=0)&&(data <= 0xFFFFFFFF))
 
 /** Macro to check frequency value */
-#define PRAM_I2S_FREQ(freq)		((freq>=16000)&&(freq <= 96000))
+#define PRAM_I2S_FREQ(freq)		((freq>=8000)&&(freq <= 96000))
 
 /** Macro to check Frame Identifier */
 #define PARAM_ID_11(n)			((n>>11)==0) /*-- 11 bit --*/
@@ -804,6 +828,134 @@ typedef struct {
 	uint8_t EFF_GPR_NumEntry;		/**< Group Extended ID Entry Number */
 } AF_SectionDef;
 
+/**
+ * @brief Acceptance Filter ID set entry, input of CAN_BuildAFImage()
+ */
+typedef struct {
+	uint8_t controller; 	/**< CAN Controller, should be:
+								 - CAN1_CTRL: CAN1 Controller
+								 - CAN2_CTRL: CAN2 Controller
+							*/
+	uint8_t format; 		/**< Identifier Format, should be:
+								 - STD_ID_FORMAT: Standard ID - 11 bit format
+								 - EXT_ID_FORMAT: Extended ID - 29 bit format
+							*/
+	uint8_t fullcan; 		/**< FullCAN object, should be:
+								 - 0: message goes to CAN controller Rx buffer
+								 - 1: message goes to FullCAN object section,
+								 only for single standard ID
+							*/
+	uint8_t reserved; 		/**< Reserved */
+	uint32_t lowerID; 		/**< ID, or ID lower bound of a range */
+	uint32_t upperID; 		/**< ID upper bound of a range, equal lowerID
+								 for a single ID
+							*/
+} AF_ID_Entry;
+
+/**
+ * @brief Acceptance Filter Look-Up Table image, built by CAN_BuildAFImage()
+ * or by the host AFLUT generator, loaded by CAN_LoadAFImage()
+ */
+typedef struct {
+	const uint32_t* lut; 			/**< LUT words, ENDofTable/4 words */
+	uint16_t SFF_sa; 				/**< Standard Frame Individual Start Address */
+	uint16_t SFF_GRP_sa; 			/**< Standard Frame Group Start Address */
+	uint16_t EFF_sa; 				/**< Extended Frame Start Address */
+	uint16_t EFF_GRP_sa; 			/**< Extended Frame Group Start Address */
+	uint16_t ENDofTable; 			/**< End of AF Tables */
+	uint16_t FC_NumEntry;			/**< FullCAN Entry Number */
+	uint16_t SFF_NumEntry;			/**< Standard ID Entry Number */
+	uint16_t SFF_GPR_NumEntry;		/**< Group Standard ID Entry Number */
+	uint16_t EFF_NumEntry;			/**< Extended ID Entry Number */
+	uint16_t EFF_GPR_NumEntry;		/**< Group Extended ID Entry Number */
+} AF_ImageDef;
+
+/**
+ * @brief FullCAN object mirror, one per FullCAN object, see CAN_FullCANReadAll()
+ */
+typedef struct {
+	__IO uint32_t seq; 		/**< Update sequence, odd while being written,
+								 seq/2 is the number of updates */
+	__IO uint32_t frame; 	/**< First word of object, semaphore cleared:
+								 ID (10:0), DLC (19:16), RTR (30), SCC (31:29) */
+	__IO uint32_t dataA; 	/**< Data bytes 1-4 */
+	__IO uint32_t dataB; 	/**< Data bytes 5-8 */
+} CAN_FCAN_MIRROR_Type;
+
+/**
+ * @brief Compact received CAN frame, 16 bytes, see CAN_RXFRAME_xxx() macros
+ */
+typedef struct {
+	uint32_t stamp; 		/**< Time stamp (31:4), DLC (3:0) */
+	uint32_t id; 			/**< Identifier (28:0), RTR (30), FF (31) */
+	uint32_t dataA; 		/**< Data bytes 1-4 */
+	uint32_t dataB; 		/**< Data bytes 5-8 */
+} CAN_RXFRAME_Type;
+
+/**
+ * @brief CAN receive ring, single producer (CAN_RxRingHandler),
+ * single consumer (CAN_ReadFrames)
+ */
+typedef struct {
+	CAN_RXFRAME_Type* buf; 	/**< Frame buffer */
+	uint32_t mask; 			/**< Buffer size - 1, size is a power of 2 */
+	__IO uint32_t* timer; 	/**< Free running counter used as time stamp,
+								 e.g. &LPC_TIM0->TC at 1us */
+	__IO uint32_t head; 	/**< Write index, updated by interrupt */
+	__IO uint32_t tail; 	/**< Read index, updated by reader */
+	__IO uint32_t overrun; 	/**< Frames dropped, ring full */
+	__IO uint32_t hw_overrun; /**< Controller data overruns, frames lost in hardware */
+} CAN_RXRING_Type;
+
+/**
+ * @brief CAN transmit latency statistics of one ID, see CAN_TXSCHED_Type
+ */
+typedef struct {
+	uint32_t id; 			/**< CAN identifier */
+	uint32_t format; 		/**< STD_ID_FORMAT or EXT_ID_FORMAT */
+	uint32_t count; 		/**< Number of frames sent */
+	uint32_t lat_last; 		/**< Latency of last frame, submit to TX done, timer ticks */
+	uint32_t lat_max; 		/**< Maximum latency, timer ticks */
+	uint32_t lat_sum; 		/**< Sum of latencies, lat_sum/count is the mean */
+} CAN_TXSTAT_Type;
+
+/**
+ * @brief CAN transmit queue entry, frame packed in TX buffer register format
+ */
+typedef struct {
+	uint32_t key; 			/**< Scheduling key, lower is sent first: bus
+								 arbitration order of the identifier */
+	uint32_t seq; 			/**< Submit sequence, keeps order of equal keys */
+	uint32_t tfi; 			/**< CANxTFIn value: PRIO, DLC, RTR, FF */
+	uint32_t tid; 			/**< CANxTIDn value */
+	uint32_t tda; 			/**< CANxTDAn value */
+	uint32_t tdb; 			/**< CANxTDBn value */
+	uint32_t time; 			/**< Submit time */
+	CAN_TXSTAT_Type* stat; 	/**< Statistics of this ID, NULL if none */
+} CAN_TXQ_ENTRY_Type;
+
+/**
+ * @brief CAN transmit scheduler. The application fills the configuration
+ * fields, the other fields are for driver use.
+ */
+typedef struct {
+	CAN_TXQ_ENTRY_Type* heap; 	/**< Configuration: priority queue storage */
+	uint16_t size; 				/**< Configuration: number of entries in heap */
+	uint16_t stat_num; 			/**< Configuration: number of entries in stat */
+	CAN_TXSTAT_Type* stat; 		/**< Configuration: per-ID statistics table,
+									 id and format filled, may be NULL */
+	__IO uint32_t* timer; 		/**< Configuration: free running counter used
+									 for latency, e.g. &LPC_TIM0->TC, may be NULL */
+	uint32_t busoff_cnt; 		/**< Number of bus-off recoveries */
+	uint32_t abort_cnt; 		/**< Number of frames pre-empted by a higher
+									 priority frame and re-queued */
+	uint16_t num; 				/**< Driver use: number of frames in heap */
+	uint8_t busy; 				/**< Driver use: TX buffers loaded, bit n = buffer n+1 */
+	uint8_t aborting; 			/**< Driver use: TX buffers being aborted */
+	uint32_t seq; 				/**< Driver use: next submit sequence */
+	CAN_TXQ_ENTRY_Type hw[3]; 	/**< Driver use: frames loaded in TX buffers */
+} CAN_TXSCHED_Type;
+
 /**
  * @}
  */
@@ -822,6 +974,9 @@ void CAN_DeInit(LPC_CAN_TypeDef *CANx);
 Status CAN_SendMsg(LPC_CAN_TypeDef *CANx, CAN_MSG_Type *CAN_Msg);
 Status CAN_ReceiveMsg(LPC_CAN_TypeDef *CANx, CAN_MSG_Type *CAN_Msg);
 CAN_ERROR FCAN_ReadObj(LPC_CANAF_TypeDef* CANAFx, CAN_MSG_Type *CAN_Msg);
+uint32_t CAN_FullCANReadAll(LPC_CANAF_TypeDef* CANAFx, CAN_FCAN_MIRROR_Type* mirror,
+		uint32_t num);
+uint32_t CAN_FullCANMirrorGet(CAN_FCAN_MIRROR_Type* mirror, CAN_MSG_Type* CAN_Msg);
 
 /* CAN configure functions ---------------*/
 void CAN_ModeConfig(LPC_CAN_TypeDef* CANx, CAN_MODE_Type mode,
@@ -837,6 +992,21 @@ CAN_ERROR CAN_LoadExplicitEntry(LPC_CAN_TypeDef* CANx, uint32_t ID,
 CAN_ERROR CAN_LoadGroupEntry(LPC_CAN_TypeDef* CANx, uint32_t lowerID,
 		uint32_t upperID, CAN_ID_FORMAT_Type format);
 CAN_ERROR CAN_RemoveEntry(AFLUT_ENTRY_Type EntryType, uint16_t position);
+CAN_ERROR CAN_BuildAFImage(AF_ID_Entry* IDs, uint16_t num, uint32_t* buf,
+		uint16_t size, AF_ImageDef* Image);
+void CAN_LoadAFImage(LPC_CANAF_TypeDef* CANAFx, const AF_ImageDef* Image);
+
+/* CAN receive ring functions --------------*/
+void CAN_RxRingInit(LPC_CAN_TypeDef* CANx, CAN_RXRING_Type* ring, CAN_RXFRAME_Type* buf,
+		uint32_t size, __IO uint32_t* timer);
+uint32_t CAN_RxRingHandler(LPC_CAN_TypeDef* CANx);
+uint32_t CAN_ReadFrames(LPC_CAN_TypeDef* CANx, CAN_RXFRAME_Type* buf, uint32_t n);
+
+/* CAN transmit scheduler functions --------*/
+void CAN_TxSchedInit(LPC_CAN_TypeDef* CANx, CAN_TXSCHED_Type* sched);
+Status CAN_TxSchedSubmit(LPC_CAN_TypeDef* CANx, CAN_MSG_Type* CAN_Msg);
+void CAN_TxSchedHandler(LPC_CAN_TypeDef* CANx, uint32_t IntStatus);
+uint32_t CAN_TxSchedPending(LPC_CAN_TypeDef* CANx);
 
 /* CAN interrupt functions -----------------*/
 void CAN_IRQCmd(LPC_CAN_TypeDef* CANx, CAN_INT_EN_Type arg, FunctionalState NewState);
@@ -115,6 +115,8 @@ extern "C"
 #define	CLKPWR_PCLKSEL_CCLK_DIV_1  ((uint32_t)(1))
 /** Peripheral clock divider is set to 2 from CCLK */
 #define	CLKPWR_PCLKSEL_CCLK_DIV_2  ((uint32_t)(2))
+/** Peripheral clock divider is set to 8 from CCLK (6 for CAN) */
+#define	CLKPWR_PCLKSEL_CCLK_DIV_8  ((uint32_t)(3))
 
 
 /********************************************************************
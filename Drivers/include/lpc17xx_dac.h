@@ -36,6 +36,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "LPC17xx.h"
 #include "lpc_types.h"
+#include "lpc17xx_gpdma.h"
 
 
 #ifdef __cplusplus
@@ -68,6 +69,8 @@ is VALUE/1024 
 #define DAC_DMA_ENA			((uint32_t)(1<<3))
 /** DCAR DACCTRL mask bit */
 #define DAC_DACCTRL_MASK	((uint32_t)(0x0F))
+/** Convert a q15 sample to DACR value field: mid-scale for 0 */
+#define DAC_Q15_VALUE(s)	((uint32_t)(((uint16_t)(s) ^ 0x8000) & 0xFFC0))
 
 /** Macro to determine if it is valid DAC peripheral */
 #define PARAM_DACx(n)	(((uint32_t *)n)==((uint32_t *)LPC_DAC))
@@ -114,6 +117,31 @@ typedef struct
 
 } DAC_CONVERTER_CFG_Type;
 
+/**
+ * @brief DAC streaming player: two blocks of DACR values played by GPDMA
+ * in turn (ping-pong) at the DAC timer rate. When a block is done, it is
+ * refilled by the generator while the other one plays. The application
+ * fills the configuration fields, the other fields are for driver use.
+ */
+typedef struct
+{
+	uint8_t DMAChannel;		/**< Configuration: GPDMA channel, 0 to 7 */
+	uint8_t RESERVED;
+	uint16_t BlockSize;		/**< Configuration: samples per block, 1 to 4095 */
+	uint32_t Rate;			/**< Configuration: update rate (Hz), up to 1MHz with
+								 DAC_MAX_CURRENT_700uA, 400KHz with 350uA */
+	uint32_t* buf;			/**< Configuration: 2 * BlockSize words */
+	GPDMA_LLI_Type* lli;	/**< Configuration: 2 LLIs, word aligned */
+	void (*Generator)(void *arg, int16_t *dst, uint32_t n);	/**< Configuration:
+								 writes n q15 samples to dst, called from
+								 DAC_StreamDMAHandler() */
+	void* arg;				/**< Configuration: Generator argument */
+	uint32_t last;			/**< Last refilled block */
+	__IO uint32_t blocks;	/**< Blocks refilled */
+	__IO uint32_t underrun;	/**< Blocks played twice, refill was late */
+	__IO uint32_t error;	/**< GPDMA errors */
+} DAC_STREAM_Type;
+
 /**
  * @}
  */
@@ -129,6 +157,11 @@ void    DAC_SetBias (LPC_DAC_TypeDef *DACx,uint32_t bias);
 void    DAC_ConfigDAConverterControl (LPC_DAC_TypeDef *DACx,DAC_CONVERTER_CFG_Type *DAC_ConverterConfigStruct);
 void 	DAC_SetDMATimeOut(LPC_DAC_TypeDef *DACx,uint32_t time_out);
 
+Status	DAC_StreamInit(LPC_DAC_TypeDef *DACx, DAC_STREAM_Type *stream);
+void	DAC_StreamStart(LPC_DAC_TypeDef *DACx, DAC_STREAM_Type *stream);
+void	DAC_StreamStop(LPC_DAC_TypeDef *DACx, DAC_STREAM_Type *stream);
+void	DAC_StreamDMAHandler(DAC_STREAM_Type *stream);
+
 /**
  * @}
  */
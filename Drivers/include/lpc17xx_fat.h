@@ -0,0 +1,200 @@
+/**********************************************************************
+* $Id$		lpc17xx_fat.h				2011-03-09
+*//**
+* @file		lpc17xx_fat.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the FAT16/FAT32 file layer on a block device
+* 			for LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup FAT FAT
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC17XX_FAT_H_
+#define LPC17XX_FAT_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_blkdev.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup FAT_Public_Macros FAT Public Macros
+ * @{
+ */
+
+/** Sector size (bytes), the block size of the device */
+#define FAT_SECTOR_SIZE		512
+/** FAT sectors read at once into the FAT window */
+#define FAT_WIN_SECTORS		4
+/** Runs of contiguous clusters cached per file */
+#define FAT_EXTENTS			8
+
+/** File system types */
+#define FAT_TYPE_NONE		0
+#define FAT_TYPE_FAT16		16
+#define FAT_TYPE_FAT32		32
+
+/** Open modes, may be combined */
+#define FAT_MODE_READ		0x01	/**< Read */
+#define FAT_MODE_WRITE		0x02	/**< Write */
+#define FAT_MODE_CREATE		0x04	/**< Create the file if it does not exist */
+#define FAT_MODE_TRUNC		0x08	/**< Truncate the file to 0 bytes */
+#define FAT_MODE_APPEND		0x10	/**< Start at the end of the file */
+
+/** Free cluster count unknown */
+#define FAT_FREE_UNKNOWN	0xFFFFFFFF
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup FAT_Public_Types FAT Public Types
+ * @{
+ */
+
+/** Run of contiguous clusters of a file */
+typedef struct {
+	uint32_t Index;				/**< Position in the file (clusters) */
+	uint32_t Cluster;			/**< First cluster */
+	uint32_t Count;				/**< Number of clusters */
+} FAT_EXTENT_Type;
+
+/**
+ * @brief FAT16/FAT32 volume on a block device of 512 byte blocks: the
+ * whole device, or the first partition of its MBR.
+ *
+ * FAT sectors are accessed through a window of FAT_WIN_SECTORS sectors,
+ * read at once and written back (to every FAT copy) only when the window
+ * moves or on FAT_Sync()/FAT_Close(): allocations made while appending
+ * stay in memory until then. The application fills the configuration
+ * fields, the other fields are set by FAT_Mount() or for driver use.
+ */
+typedef struct {
+	BLKDEV_Type *Dev;			/**< Configuration: block device */
+	uint32_t (*GetTime)(void);	/**< Configuration: current date and time in
+								 FAT format (date << 16 | time), may be NULL */
+	uint8_t Type;				/**< FAT_TYPE_xxx */
+	uint8_t SecPerClus;			/**< Sectors per cluster */
+	uint8_t NumFats;			/**< Number of FAT copies */
+	uint8_t clshift;			/**< log2 of the cluster size (bytes) */
+	uint32_t FatStart;			/**< First sector of the first FAT */
+	uint32_t FatSize;			/**< Sectors per FAT */
+	uint32_t RootStart;			/**< FAT16: first root directory sector */
+	uint32_t RootSectors;		/**< FAT16: root directory sectors */
+	uint32_t RootCluster;		/**< FAT32: first root directory cluster */
+	uint32_t DataStart;			/**< Sector of cluster 2 */
+	uint32_t ClusterCount;		/**< Number of data clusters */
+	uint32_t FreeCount;			/**< Free clusters, FAT_FREE_UNKNOWN if unknown */
+	uint32_t InfoSector;		/**< FAT32: FSInfo sector, 0 if none */
+	uint32_t nextfree;			/**< Allocation hint */
+	uint8_t infodirty;			/**< FSInfo to be updated */
+	uint8_t bufdirty;			/**< buf to be written back */
+	uint8_t windirty;			/**< Window sectors to be written back, one bit
+								 each */
+	uint8_t Reserved;
+	uint32_t winsec;			/**< FAT sector of win[0] */
+	uint32_t bufsec;			/**< Sector in buf */
+	uint32_t fatreads;			/**< Statistics: FAT window reads */
+	uint32_t fatwrites;			/**< Statistics: FAT sector writes (all copies) */
+	uint8_t win[FAT_WIN_SECTORS * FAT_SECTOR_SIZE];	/**< FAT window */
+	uint8_t buf[FAT_SECTOR_SIZE];	/**< Directory, boot and FSInfo sectors */
+} FAT_VOLUME_Type;
+
+/**
+ * @brief File of the root directory, 8.3 name.
+ *
+ * The cluster chain is cached as runs of contiguous clusters, filled by
+ * walking the chain ahead of the position (prefetch); data transfers of
+ * whole sectors go directly between the user buffer and the device, one
+ * request per run. Partial sectors go through the file sector buffer.
+ * Size and first cluster are written to the directory entry only by
+ * FAT_Sync() and FAT_Close().
+ */
+typedef struct {
+	FAT_VOLUME_Type *vol;		/**< Volume */
+	uint8_t mode;				/**< FAT_MODE_xxx */
+	uint8_t dirty;				/**< Directory entry to be updated */
+	uint8_t bufdirty;			/**< buf to be written back */
+	uint8_t numext;				/**< Cached runs */
+	uint32_t dirsec;			/**< Sector of the directory entry */
+	uint32_t dirofs;			/**< Offset of the directory entry */
+	uint32_t start;				/**< First cluster, 0 if none */
+	uint32_t Size;				/**< File size (bytes) */
+	uint32_t Pos;				/**< Read/write position (bytes) */
+	uint32_t clusters;			/**< Clusters in the chain */
+	uint32_t last;				/**< Last cluster of the chain */
+	uint32_t bufsec;			/**< Sector in buf */
+	FAT_EXTENT_Type ext[FAT_EXTENTS];	/**< Cached runs, by increasing Index */
+	uint8_t buf[FAT_SECTOR_SIZE];	/**< Partial sector buffer */
+} FAT_FILE_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup FAT_Public_Functions FAT Public Functions
+ * @{
+ */
+
+/* Volume --------------------------------*/
+Status FAT_Mount(FAT_VOLUME_Type *vol);
+Status FAT_GetFree(FAT_VOLUME_Type *vol, uint32_t *clusters);
+
+/* Files ---------------------------------*/
+Status FAT_Open(FAT_VOLUME_Type *vol, FAT_FILE_Type *file, const char *name, uint8_t mode);
+uint32_t FAT_Read(FAT_FILE_Type *file, uint8_t *buf, uint32_t len);
+uint32_t FAT_Write(FAT_FILE_Type *file, const uint8_t *buf, uint32_t len);
+Status FAT_Seek(FAT_FILE_Type *file, uint32_t pos);
+Status FAT_Preallocate(FAT_FILE_Type *file, uint32_t size);
+Status FAT_Sync(FAT_FILE_Type *file);
+Status FAT_Close(FAT_FILE_Type *file);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_FAT_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -400,9 +400,12 @@ typedef struct {
 void GPDMA_Init(void);
 //Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig, fnGPDMACbs_Type *pfnGPDMACbs);
 Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig);
+Status GPDMA_SetupLLI(GPDMA_Channel_CFG_Type *GPDMAChannelConfig);
 IntStatus GPDMA_IntGetStatus(GPDMA_Status_Type type, uint8_t channel);
 void GPDMA_ClearIntPending(GPDMA_StateClear_Type type, uint8_t channel);
 void GPDMA_ChannelCmd(uint8_t channelNum, FunctionalState NewState);
+uint32_t GPDMA_GetSrcAddr(uint8_t channelNum);
+uint32_t GPDMA_GetDstAddr(uint8_t channelNum);
 //void GPDMA_IntHandler(void);
 
 /**
@@ -223,6 +223,13 @@ extern "C"
 #define I2C_SETUP_STATUS_ARBF   (1<<8)	/**< Arbitration false */
 #define I2C_SETUP_STATUS_NOACKF (1<<9)	/**< No ACK returned */
 #define I2C_SETUP_STATUS_DONE   (1<<10)	/**< Status DONE */
+#define I2C_SETUP_STATUS_TIMEOUT (1<<11)	/**< Time out (bus manager only) */
+
+/*********************************************************************//**
+ * I2C bus manager segment flags
+ **********************************************************************/
+#define I2C_SEG_WRITE				((0))		/**< Segment writes data to slave */
+#define I2C_SEG_READ				((1))		/**< Segment reads data from slave */
 
 /*********************************************************************//**
  * I2C monitor control configuration defines
@@ -230,6 +237,23 @@ extern "C"
 #define I2C_MONITOR_CFG_SCL_OUTPUT	I2C_I2MMCTRL_ENA_SCL		/**< SCL output enable */
 #define I2C_MONITOR_CFG_MATCHALL	I2C_I2MMCTRL_MATCH_ALL		/**< Select interrupt register match */
 
+/*********************************************************************//**
+ * I2C monitor capture ring event decoding, applied to I2C_MON_EVENT_Type.stat
+ **********************************************************************/
+/** Address byte after a START/repeated START, data holds SLA+R/W */
+#define I2C_MON_IS_START(stat)		(((stat)==I2C_I2STAT_S_RX_SLAW_ACK) \
+									|| ((stat)==I2C_I2STAT_S_RX_ARB_LOST_M_SLA) \
+									|| ((stat)==I2C_I2STAT_S_RX_GENCALL_ACK) \
+									|| ((stat)==I2C_I2STAT_S_RX_ARB_LOST_M_GENCALL) \
+									|| ((stat)==I2C_I2STAT_S_TX_SLAR_ACK) \
+									|| ((stat)==I2C_I2STAT_S_TX_ARB_LOST_M_SLA))
+/** STOP (or repeated START) condition */
+#define I2C_MON_IS_STOP(stat)		((stat)==I2C_I2STAT_S_RX_STA_STO_SLVREC_SLVTRX)
+/** Byte has been NOT acknowledged */
+#define I2C_MON_IS_NACK(stat)		(((stat)==I2C_I2STAT_S_RX_PRE_SLA_DAT_NACK) \
+									|| ((stat)==I2C_I2STAT_S_RX_PRE_GENCALL_DAT_NACK) \
+									|| ((stat)==I2C_I2STAT_S_TX_DAT_NACK))
+
 /* ---------------- CHECK PARAMETER DEFINITIONS ---------------------------- */
 /* Macros check I2C slave address */
 #define PARAM_I2C_SLAVEADDR_CH(n)	((n>=0) && (n<=3))
@@ -316,6 +340,69 @@ typedef struct
   void 				(*callback)(void);
 } I2C_S_SETUP_Type;
 
+/**
+ * @brief Bus manager transaction segment. Each segment is preceded by a
+ * (repeated) start condition and the slave address with its direction bit.
+ */
+typedef struct
+{
+  uint8_t*          data;						/**< Pointer to data to write or read buffer */
+  uint32_t          length;						/**< Data length, a write segment with length
+													 0 only addresses the slave */
+  uint32_t          flags;						/**< I2C_SEG_WRITE or I2C_SEG_READ */
+} I2C_SEG_Type;
+
+/**
+ * @brief Bus manager transaction structure definitions
+ */
+typedef struct I2C_XFER_Struct
+{
+  uint32_t          sl_addr7bit;				/**< Slave address in 7bit mode */
+  I2C_SEG_Type*     seg;						/**< Pointer to array of segments */
+  uint32_t          seg_num;					/**< Number of segments */
+  uint32_t          retransmissions_max;		/**< Max Re-Transmission on arbitration lost */
+  uint32_t          timeout;					/**< Time out in I2C_BusTick() periods, 0: none */
+  uint32_t          status;						/**< Status of transaction, I2C_SETUP_STATUS_DONE
+													 when succeeded */
+  void 				(*callback)(struct I2C_XFER_Struct *xfer);	/**< Called from I2C interrupt
+													 when transaction completes or fails, could be NULL */
+  void*             arg;						/**< User data, not used by driver */
+  /* Driver use only */
+  struct I2C_XFER_Struct* next;					/**< Next queued transaction */
+  uint32_t          seg_idx;					/**< Current segment */
+  uint32_t          count;						/**< Data counter in current segment */
+  uint32_t          retransmissions_count;		/**< Current Re-Transmission counter */
+  uint32_t          tick_left;					/**< Time out ticks left */
+} I2C_XFER_Type;
+
+/**
+ * @brief I2C monitor capture event, 8 bytes
+ */
+typedef struct
+{
+  uint32_t          time;						/**< Free running timer value at capture */
+  uint8_t           data;						/**< Byte seen on the bus (I2DATA_BUFFER) */
+  uint8_t           stat;						/**< I2STAT code, decode with I2C_MON_IS_xxx() */
+  uint16_t          seq;						/**< Sequence number (low 16 bits), a gap
+													 tells the host that events were dropped */
+} I2C_MON_EVENT_Type;
+
+/**
+ * @brief I2C monitor capture ring, single producer (I2C interrupt),
+ * single consumer (I2C_MonitorRingRead)
+ */
+typedef struct
+{
+  I2C_MON_EVENT_Type* buf;						/**< Event buffer */
+  uint32_t          mask;						/**< Buffer size - 1, size is a power of 2 */
+  __IO uint32_t*    timer;						/**< Pointer to free running counter,
+													 e.g. &LPC_TIM0->TC */
+  __IO uint32_t     head;						/**< Write index, updated by interrupt */
+  __IO uint32_t     tail;						/**< Read index, updated by reader */
+  uint32_t          seq;						/**< Next sequence number */
+  __IO uint32_t     overrun;					/**< Number of events dropped, ring full */
+} I2C_MON_RING_Type;
+
 /**
  * @brief Transfer option type definitions
  */
@@ -349,6 +436,11 @@ Status I2C_SlaveTransferData(LPC_I2C_TypeDef *I2Cx, \
 uint32_t I2C_MasterTransferComplete(LPC_I2C_TypeDef *I2Cx);
 uint32_t I2C_SlaveTransferComplete(LPC_I2C_TypeDef *I2Cx);
 
+/* I2C bus manager functions ---------- */
+Status I2C_BusSubmit(LPC_I2C_TypeDef *I2Cx, I2C_XFER_Type *xfer);
+void I2C_BusTick(LPC_I2C_TypeDef *I2Cx);
+FlagStatus I2C_BusIdle(LPC_I2C_TypeDef *I2Cx);
+
 
 void I2C_SetOwnSlaveAddr(LPC_I2C_TypeDef *I2Cx, I2C_OWNSLAVEADDR_CFG_Type *OwnSlaveAddrConfigStruct);
 uint8_t I2C_GetLastStatusCode(LPC_I2C_TypeDef* I2Cx);
@@ -358,6 +450,10 @@ void I2C_MonitorModeConfig(LPC_I2C_TypeDef *I2Cx, uint32_t MonitorCfgType, Funct
 void I2C_MonitorModeCmd(LPC_I2C_TypeDef *I2Cx, FunctionalState NewState);
 uint8_t I2C_MonitorGetDatabuffer(LPC_I2C_TypeDef *I2Cx);
 BOOL_8 I2C_MonitorHandler(LPC_I2C_TypeDef *I2Cx, uint8_t *buffer, uint32_t size);
+void I2C_MonitorRingInit(LPC_I2C_TypeDef *I2Cx, I2C_MON_RING_Type *ring, \
+		I2C_MON_EVENT_Type *buf, uint32_t size, __IO uint32_t *timer);
+void I2C_MonitorRingHandler(LPC_I2C_TypeDef *I2Cx);
+uint32_t I2C_MonitorRingRead(I2C_MON_RING_Type *ring, I2C_MON_EVENT_Type *buf, uint32_t len);
 
 /* I2C Interrupt handler functions ------*/
 void I2C_IntCmd (LPC_I2C_TypeDef *I2Cx, Bool NewState);
@@ -36,6 +36,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "LPC17xx.h"
 #include "lpc_types.h"
+#include "lpc17xx_gpdma.h"
 
 
 #ifdef __cplusplus
@@ -85,6 +86,13 @@ extern "C"
 /** I2S select DMA bit */
 #define I2S_DMA_1			((uint8_t)(0))
 #define I2S_DMA_2			((uint8_t)(1))
+/** I2S clock planner: let the planner choose the I2S PCLK divider */
+#define I2S_CLKPLAN_ANY_PCLK	((uint8_t)(0xFF))
+/** I2S stream sample format of the Process() callback buffers */
+#define I2S_STREAM_Q15		((uint8_t)(0))	/**< int16_t L,R: the ring periods
+												 themselves, no copy */
+#define I2S_STREAM_Q31		((uint8_t)(1))	/**< int32_t L,R: converted to and
+												 from work buffers */
 
 /**
  * @}
@@ -224,7 +232,7 @@ extern "C"
 /** Macro to determine if it is valid I2S peripheral */
 #define PARAM_I2Sx(n)	(((uint32_t *)n)==((uint32_t *)LPC_I2S))
 /** Macro to check Data to send valid */
-#define PRAM_I2S_FREQ(freq)		((freq>=16000)&&(freq <= 96000))
+#define PRAM_I2S_FREQ(freq)		((freq>=8000)&&(freq <= 96000))
 /* Macro check I2S word width type */
 #define PARAM_I2S_WORDWIDTH(n)	((n==I2S_WORDWIDTH_8)||(n==I2S_WORDWIDTH_16)\
 ||(n==I2S_WORDWIDTH_32))
@@ -256,6 +264,12 @@ extern "C"
 #define PARAM_I2S_HALFPERIOD(n)	(n<512)
 /* Macro check I2S bit-rate value */
 #define PARAM_I2S_BITRATE(n)	(n<=63)
+/* Macro check I2S clock planner sample rate, same range as I2S_FreqConfig() */
+#define PARAM_I2S_PLAN_FREQ(freq)	PRAM_I2S_FREQ(freq)
+/* Macro check I2S clock planner word width (bits) */
+#define PARAM_I2S_PLAN_WIDTH(n)	((n==8)||(n==16)||(n==32))
+/* Macro check I2S stream sample format */
+#define PARAM_I2S_STREAM_FMT(n)	((n==I2S_STREAM_Q15)||(n==I2S_STREAM_Q31))
 /**
  * @}
  */
@@ -320,6 +334,102 @@ typedef struct{
 	uint8_t Reserved;
 }I2S_MODEConf_Type;
 
+/**
+ * @brief I2S clock plan: PCLK divider, fractional rate divider X/Y and
+ * bit rate divider giving the sample rate closest to Freq. WS half period
+ * is one word (as set by I2S_Config()), so a frame is 2 * WordWidth bits:
+ * Freq = PCLK_I2S * X / (2 * Y * (BitRate + 1) * 2 * WordWidth)
+ */
+typedef struct {
+	uint32_t Cclk;			/**< Configuration: CPU clock (Hz) */
+	uint32_t Freq;			/**< Configuration: sample rate (Hz), 8000 to 96000 */
+	uint16_t MclkRatio;		/**< Configuration: MCLK / Freq for a codec clocked
+								 by TX_MCLK (e.g. 256), 0 if MCLK is not used */
+	uint8_t WordWidth;		/**< Configuration: bits per sample: 8, 16 or 32 */
+	uint8_t PclkDiv;		/**< Configuration: I2S PCLK divider, should be:
+								 - CLKPWR_PCLKSEL_CCLK_DIV_x: this divider only
+								 - I2S_CLKPLAN_ANY_PCLK: best of all dividers
+								 Result: the chosen divider */
+	uint8_t X;				/**< Result: fractional divider numerator */
+	uint8_t Y;				/**< Result: fractional divider denominator */
+	uint8_t BitRate;		/**< Result: bit rate divider - 1 */
+	uint8_t Reserved;
+	int32_t Ppb;			/**< Result: rate error, parts per billion */
+} I2S_CLKPLAN_Type;
+
+/**
+ * @brief I2S clock tracking: the fractional rate divider is nudged so that
+ * the sample rate follows an external reference (e.g. USB SOF or a host
+ * word clock) measured with a timer capture. The measured offset is low-pass
+ * filtered; X/Y alternates between the two closest settings around the
+ * corrected ratio so that the average rate matches it.
+ */
+typedef struct {
+	uint32_t RefHz;			/**< Configuration: nominal reference frequency */
+	uint32_t TimerHz;		/**< Configuration: capture timer clock frequency */
+	uint8_t TRMode;			/**< Configuration: rate register to update, should be:
+								 - I2S_TX_MODE
+								 - I2S_RX_MODE */
+	uint8_t Shift;			/**< Configuration: filter, each measurement has a
+								 weight of 1/2^Shift */
+	uint8_t lo_x, lo_y;		/**< Closest setting below the corrected ratio */
+	uint8_t hi_x, hi_y;		/**< Closest setting above the corrected ratio */
+	uint8_t Reserved[2];
+	uint32_t base;			/**< Planned X/Y, Q31 */
+	uint32_t lo, hi;		/**< lo_x/lo_y and hi_x/hi_y, Q31 */
+	int32_t acc;			/**< Rate error accumulated by the alternation, Q31 */
+	int32_t Ppb;			/**< Filtered correction, parts per billion */
+	uint32_t updates;		/**< Measurements taken */
+	uint32_t rejected;		/**< Measurements off by more than 1000 ppm */
+} I2S_CLKTRACK_Type;
+
+/**
+ * @brief I2S full-duplex stream: TX and RX run on two GPDMA channels, each
+ * over a ring of NumPeriods periods of PeriodSize 16-bit stereo frames
+ * (one word per frame, left channel in the low half-word). Each received
+ * period is passed to Process() with the period of output to fill.
+ * The application fills the configuration fields, the other fields are
+ * for driver use and statistics.
+ */
+typedef struct {
+	uint8_t TxDMAChannel;	/**< Configuration: GPDMA channel for TX */
+	uint8_t RxDMAChannel;	/**< Configuration: GPDMA channel for RX */
+	uint8_t Format;			/**< Configuration: sample format of Process()
+								 buffers, should be:
+								 - I2S_STREAM_Q15
+								 - I2S_STREAM_Q31 */
+	uint8_t Lead;			/**< Configuration: periods of silence played
+								 before the first processed period, 1 to
+								 NumPeriods - 1. Output latency is about Lead
+								 periods; 2 leaves one period to Process() */
+	uint16_t PeriodSize;	/**< Configuration: frames per period, multiple
+								 of 4, up to 4092 */
+	uint16_t NumPeriods;	/**< Configuration: periods per ring, at least 2 */
+	uint32_t* txbuf;		/**< Configuration: TX ring, NumPeriods * PeriodSize words */
+	uint32_t* rxbuf;		/**< Configuration: RX ring, NumPeriods * PeriodSize words */
+	GPDMA_LLI_Type* txlli;	/**< Configuration: NumPeriods LLIs for TX */
+	GPDMA_LLI_Type* rxlli;	/**< Configuration: NumPeriods LLIs for RX */
+	int32_t* work_in;		/**< Configuration: I2S_STREAM_Q31 only,
+								 2 * PeriodSize samples */
+	int32_t* work_out;		/**< Configuration: I2S_STREAM_Q31 only,
+								 2 * PeriodSize samples */
+	void (*Process)(void *arg, const void *in, void *out, uint32_t frames);	/**<
+								 Configuration: called with one period of
+								 interleaved L,R input samples, fills the same
+								 number of output frames */
+	void* arg;				/**< Configuration: Process() argument */
+	__IO uint32_t tx_played;	/**< TX periods moved to the FIFO */
+	__IO uint32_t rx_done;		/**< RX periods received */
+	uint32_t tx_filled;		/**< TX periods written, including the silence */
+	uint32_t rx_read;		/**< RX periods processed */
+	uint32_t latency;		/**< Frames between the end of the last Process()
+								 call and the start of its output (TX FIFO not
+								 counted) */
+	__IO uint32_t underrun;	/**< TX periods played without new data */
+	uint32_t overrun;		/**< RX periods overwritten before Process() */
+	__IO uint32_t error;	/**< GPDMA errors */
+} I2S_STREAM_Type;
+
 
 /**
  * @}
@@ -337,6 +447,11 @@ void I2S_DeInit(LPC_I2S_TypeDef *I2Sx);
 /* I2S configuration functions --------*/
 void I2S_Config(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode, I2S_CFG_Type* ConfigStruct);
 Status I2S_FreqConfig(LPC_I2S_TypeDef *I2Sx, uint32_t Freq, uint8_t TRMode);
+Status I2S_ClkPlan(I2S_CLKPLAN_Type *plan);
+void I2S_ClkPlanApply(LPC_I2S_TypeDef *I2Sx, const I2S_CLKPLAN_Type *plan, uint8_t TRMode);
+void I2S_ClkTrackInit(I2S_CLKTRACK_Type *track, const I2S_CLKPLAN_Type *plan);
+void I2S_ClkTrackUpdate(LPC_I2S_TypeDef *I2Sx, I2S_CLKTRACK_Type *track,
+		uint32_t periods, uint32_t ticks);
 void I2S_SetBitRate(LPC_I2S_TypeDef *I2Sx, uint8_t bitrate, uint8_t TRMode);
 void I2S_ModeConfig(LPC_I2S_TypeDef *I2Sx, I2S_MODEConf_Type* ModeConfig, uint8_t TRMode);
 uint8_t I2S_GetLevel(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode);
@@ -359,6 +474,17 @@ void I2S_IRQConfig(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode, uint8_t level);
 FunctionalState I2S_GetIRQStatus(LPC_I2S_TypeDef *I2Sx,uint8_t TRMode);
 uint8_t I2S_GetIRQDepth(LPC_I2S_TypeDef *I2Sx,uint8_t TRMode);
 
+/* I2S stream functions -------------*/
+Status I2S_StreamInit(LPC_I2S_TypeDef *I2Sx, I2S_STREAM_Type *stream);
+void I2S_StreamStart(LPC_I2S_TypeDef *I2Sx, I2S_STREAM_Type *stream);
+void I2S_StreamStop(LPC_I2S_TypeDef *I2Sx, I2S_STREAM_Type *stream);
+void I2S_StreamDMAHandler(I2S_STREAM_Type *stream);
+uint32_t I2S_StreamProcess(I2S_STREAM_Type *stream);
+void I2S_ConvertToQ31(const uint32_t *src, int32_t *dst, uint32_t frames);
+void I2S_ConvertFromQ31(const int32_t *src, uint32_t *dst, uint32_t frames);
+void I2S_ConvertToQ15(const uint32_t *src, int16_t *dst, uint32_t frames);
+void I2S_ConvertFromQ15(const int16_t *src, uint32_t *dst, uint32_t frames);
+
 /**
  * @}
  */
@@ -84,6 +84,10 @@
 #define _I2C0
 #define _I2C1
 #define _I2C2
+/* Un-comment one of the lines below to build the I2C interrupt handlers
+   for master only or slave only operation */
+//#define _I2C_MASTER_ONLY
+//#define _I2C_SLAVE_ONLY
 
 /* TIMER ------------------------------- */
 #define _TIM
@@ -116,6 +120,17 @@
 /* USB device ------------------------------- */
 #define _USBDEV
 #define _USB_DMA
+#define _USBDEV_CDC
+#define _USBDEV_MSC
+#define _USBDEV_HID
+#define _USBDEV_AUDIO
+
+/* Block devices ------------------------------- */
+#define _BLKDEV
+#define _SDCARD
+
+/* File system ------------------------------- */
+#define _FAT
 
 /* QEI ------------------------------- */
 #define _QEI
@@ -0,0 +1,154 @@
+/**********************************************************************
+* $Id$		lpc17xx_sdcard.h				2011-03-09
+*//**
+* @file		lpc17xx_sdcard.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the SD/SDHC card block device (SPI mode on SSP
+* 			with GPDMA data transfers) for LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup SDCARD SDCARD
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC17XX_SDCARD_H_
+#define LPC17XX_SDCARD_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_blkdev.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup SDCARD_Public_Macros SDCARD Public Macros
+ * @{
+ */
+
+/** Block size (bytes) */
+#define SDC_BLOCK_SIZE		512
+
+/** Card types */
+#define SDC_TYPE_NONE		0	/**< Not initialized */
+#define SDC_TYPE_SDV1		1	/**< SD version 1.x, byte addressing */
+#define SDC_TYPE_SDV2		2	/**< SD version 2.0 standard capacity, byte addressing */
+#define SDC_TYPE_SDHC		3	/**< SDHC/SDXC, block addressing */
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup SDCARD_Public_Types SDCARD Public Types
+ * @{
+ */
+
+/**
+ * @brief SD card on SSP in SPI mode, as a block device. Commands and
+ * tokens are polled, data blocks are moved by two GPDMA channels (SSP
+ * receive, SSP transmit). One block is read or written by CMD17/CMD24,
+ * more by the multiple block commands CMD18/CMD25; with PreErase, ACMD23
+ * announces the length of a multiple block write so that the card can
+ * erase ahead. Command CRC7 is always computed; with CRCCheck the card
+ * checks the CRCs (CMD59) and the driver checks the CRC16 of the blocks
+ * received. Both CRCs are table driven.
+ *
+ * The waits for the card (read data token, write busy) are polled by
+ * slices: the rest of a wait is done by SDC_Poll() or BLK_Poll(). The
+ * application fills the configuration fields, routes the SSP pins and
+ * calls SDC_DMAHandler() from the GPDMA interrupt, at the priority of the
+ * block device users, or leaves the GPDMA interrupt disabled and relies
+ * on the polling alone. The other fields are for driver use.
+ */
+typedef struct {
+	BLKDEV_Type dev;			/**< Block device interface, filled by SDC_Init() */
+	LPC_SSP_TypeDef *SSPx;		/**< Configuration: LPC_SSP0 or LPC_SSP1 */
+	uint8_t CSPort;				/**< Configuration: GPIO port of chip select */
+	uint8_t CSPin;				/**< Configuration: GPIO pin of chip select */
+	uint8_t DMATx;				/**< Configuration: GPDMA channel to SSP */
+	uint8_t DMARx;				/**< Configuration: GPDMA channel from SSP */
+	uint32_t ClockRate;			/**< Configuration: SPI clock after card
+								 initialization (Hz), up to 25MHz. Lowered to the
+								 card transfer rate by SDC_Init() */
+	uint8_t CRCCheck;			/**< Configuration: TRUE to check the CRCs */
+	uint8_t PreErase;			/**< Configuration: TRUE to send ACMD23 before
+								 multiple block writes */
+	uint8_t Type;				/**< Card type, SDC_TYPE_xxx */
+	uint8_t state;				/**< Transfer state */
+	uint8_t single;				/**< Single block transfer (CMD17, CMD24) */
+	uint8_t Reserved;
+	uint16_t crc;				/**< CRC16 of the block being transmitted */
+	uint8_t *buf;				/**< Next block buffer */
+	uint32_t n;					/**< Blocks left */
+	uint32_t wait;				/**< Bytes left to poll before timeout */
+	GPDMA_LLI_Type lli[2];		/**< Receive and transmit LLIs */
+	uint32_t fill;				/**< 0xFF, transmitted while receiving */
+	uint32_t dummy;				/**< Sink of the bytes received while transmitting */
+	uint8_t CID[16];			/**< Card identification register, read by
+								 SDC_Init() */
+	uint32_t timeouts;			/**< Statistics: card timeouts */
+	uint32_t errors;			/**< Statistics: card or GPDMA errors */
+	uint32_t crcerrors;			/**< Statistics: CRC errors, detected by the
+								 driver or reported by the card */
+} SDC_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup SDCARD_Public_Functions SDCARD Public Functions
+ * @{
+ */
+
+Status SDC_Init(SDC_Type *sd);
+void SDC_Poll(SDC_Type *sd);
+void SDC_DMAHandler(SDC_Type *sd);
+uint8_t SDC_Crc7(const uint8_t *data, uint32_t len);
+uint16_t SDC_Crc16(uint16_t crc, const uint8_t *data, uint32_t len);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_SDCARD_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -274,6 +274,34 @@ typedef struct {
 	uint32_t status;			/**< Current status of SPI activity */
 } SPI_DATA_SETUP_Type;
 
+/**
+ * @brief SPI sequence segment structure definitions, used for interrupt
+ * stream transfer (8-bit frames only)
+ */
+typedef struct {
+	const uint8_t *tx_data;		/**< Pointer to transmit data, NULL: send 0xFF */
+	uint8_t *rx_data;			/**< Pointer to receive data, NULL: discard */
+	uint32_t length;			/**< Length of segment data */
+	uint32_t tag;				/**< User tag, passed to seg_hook before the
+								first frame of this segment is sent */
+} SPI_SEQ_SEG_Type;
+
+/**
+ * @brief SPI sequence structure definitions, a batch of segments that is
+ * sent back to back from the SPI interrupt
+ */
+typedef struct {
+	const SPI_SEQ_SEG_Type *seg;	/**< Pointer to array of segments */
+	uint32_t seg_num;				/**< Number of segments */
+	void (*seg_hook)(uint32_t tag);	/**< Called (from interrupt) before each
+									segment starts, e.g. to drive a D/C or
+									CS pin. NULL if not used */
+	void (*callback)(void);			/**< Called (from interrupt) when the
+									sequence completes or fails. NULL if not used */
+	uint32_t status;				/**< Current status of sequence, SPI_STAT_DONE
+									or SPI_STAT_ERROR ORed with SPSR on completion */
+} SPI_SEQ_Type;
+
 /**
  * @}
  */
@@ -295,6 +323,13 @@ void SPI_SendData(LPC_SPI_TypeDef *SPIx, uint16_t Data);
 uint16_t SPI_ReceiveData(LPC_SPI_TypeDef *SPIx);
 int32_t SPI_ReadWrite (LPC_SPI_TypeDef *SPIx, SPI_DATA_SETUP_Type *dataCfg, SPI_TRANSFER_Type xfType);
 
+/* SPI interrupt stream functions ---*/
+Status SPI_StreamStart (LPC_SPI_TypeDef *SPIx, SPI_SEQ_Type *seq);
+Status SPI_StreamWrite (LPC_SPI_TypeDef *SPIx, const uint8_t *tx_data, uint32_t length, \
+						void (*callback)(void));
+FlagStatus SPI_StreamBusy (LPC_SPI_TypeDef *SPIx);
+void SPI_StreamHandler (LPC_SPI_TypeDef *SPIx);
+
 /* SPI Interrupt functions ---------*/
 void SPI_IntCmd(LPC_SPI_TypeDef *SPIx, FunctionalState NewState);
 IntStatus SPI_GetIntStatus (LPC_SPI_TypeDef *SPIx);
@@ -165,6 +165,9 @@ extern "C"
 #define SSP_STAT_DONE		(1UL<<8)		/**< Done */
 #define SSP_STAT_ERROR		(1UL<<9)		/**< Error */
 
+/** SSP TX/RX FIFO depth (frames) */
+#define SSP_FIFO_DEPTH		8
+
 /**
  * @}
  */
@@ -443,6 +446,7 @@ void SSP_SendData(LPC_SSP_TypeDef* SSPx, uint16_t Data);
 uint16_t SSP_ReceiveData(LPC_SSP_TypeDef* SSPx);
 int32_t SSP_ReadWrite (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg, \
 						SSP_TRANSFER_Type xfType);
+int32_t SSP_ReadWriteBurst (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg);
 
 /* SSP IRQ function ------------------------------------------------------------*/
 void SSP_IntConfig(LPC_SSP_TypeDef *SSPx, uint32_t IntType, FunctionalState NewState);
@@ -0,0 +1,752 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev.h			2011-03-09
+*//**
+* @file		lpc17xx_usbdev.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the USB device controller: hardware layer,
+* 			chapter 9 core, endpoint dispatch table and class driver
+* 			registration on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup USBDEV USBDEV
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC17XX_USBDEV_H_
+#define LPC17XX_USBDEV_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include <stddef.h>
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup USBDEV_Public_Macros USBDEV Public Macros
+ * @{
+ */
+
+#if defined   (  __GNUC__  )
+#define __packed __attribute__((__packed__))
+#endif
+
+/*********************************************************************//**
+ * USB standard (chapter 9) definitions
+ **********************************************************************/
+/* bmRequestType.Dir */
+#define REQUEST_HOST_TO_DEVICE     0
+#define REQUEST_DEVICE_TO_HOST     1
+
+/* bmRequestType.Type */
+#define REQUEST_STANDARD           0
+#define REQUEST_CLASS              1
+#define REQUEST_VENDOR             2
+#define REQUEST_RESERVED           3
+
+/* bmRequestType.Recipient */
+#define REQUEST_TO_DEVICE          0
+#define REQUEST_TO_INTERFACE       1
+#define REQUEST_TO_ENDPOINT        2
+#define REQUEST_TO_OTHER           3
+
+/* USB Standard Request Codes */
+#define USB_REQUEST_GET_STATUS                 0
+#define USB_REQUEST_CLEAR_FEATURE              1
+#define USB_REQUEST_SET_FEATURE                3
+#define USB_REQUEST_SET_ADDRESS                5
+#define USB_REQUEST_GET_DESCRIPTOR             6
+#define USB_REQUEST_SET_DESCRIPTOR             7
+#define USB_REQUEST_GET_CONFIGURATION          8
+#define USB_REQUEST_SET_CONFIGURATION          9
+#define USB_REQUEST_GET_INTERFACE              10
+#define USB_REQUEST_SET_INTERFACE              11
+#define USB_REQUEST_SYNC_FRAME                 12
+
+/* USB GET_STATUS Bit Values */
+#define USB_GETSTATUS_SELF_POWERED             0x01
+#define USB_GETSTATUS_REMOTE_WAKEUP            0x02
+#define USB_GETSTATUS_ENDPOINT_STALL           0x01
+
+/* USB Standard Feature selectors */
+#define USB_FEATURE_ENDPOINT_STALL             0
+#define USB_FEATURE_REMOTE_WAKEUP              1
+
+/* USB Descriptor Types */
+#define USB_DEVICE_DESCRIPTOR_TYPE             1
+#define USB_CONFIGURATION_DESCRIPTOR_TYPE      2
+#define USB_STRING_DESCRIPTOR_TYPE             3
+#define USB_INTERFACE_DESCRIPTOR_TYPE          4
+#define USB_ENDPOINT_DESCRIPTOR_TYPE           5
+#define USB_DEVICE_QUALIFIER_DESCRIPTOR_TYPE   6
+#define USB_OTHER_SPEED_CONFIG_DESCRIPTOR_TYPE 7
+#define USB_INTERFACE_POWER_DESCRIPTOR_TYPE    8
+#define USB_OTG_DESCRIPTOR_TYPE                     9
+#define USB_DEBUG_DESCRIPTOR_TYPE                  10
+#define USB_INTERFACE_ASSOCIATION_DESCRIPTOR_TYPE  11
+
+/* USB Descriptor Sizes */
+#define USB_DEVICE_DESC_SIZE        (sizeof(USB_DEVICE_DESCRIPTOR))
+#define USB_CONFIGUARTION_DESC_SIZE (sizeof(USB_CONFIGURATION_DESCRIPTOR))
+#define USB_INTERFACE_DESC_SIZE     (sizeof(USB_INTERFACE_DESCRIPTOR))
+#define USB_ENDPOINT_DESC_SIZE      (sizeof(USB_ENDPOINT_DESCRIPTOR))
+#define USB_IAD_DESC_SIZE           8
+
+/* USB Device Classes */
+#define USB_DEVICE_CLASS_RESERVED              0x00
+#define USB_DEVICE_CLASS_AUDIO                 0x01
+#define USB_DEVICE_CLASS_COMMUNICATIONS        0x02
+#define USB_DEVICE_CLASS_HUMAN_INTERFACE       0x03
+#define USB_DEVICE_CLASS_MONITOR               0x04
+#define USB_DEVICE_CLASS_PHYSICAL_INTERFACE    0x05
+#define USB_DEVICE_CLASS_POWER                 0x06
+#define USB_DEVICE_CLASS_PRINTER               0x07
+#define USB_DEVICE_CLASS_STORAGE               0x08
+#define USB_DEVICE_CLASS_HUB                   0x09
+#define USB_DEVICE_CLASS_MISCELLANEOUS         0xEF
+#define USB_DEVICE_CLASS_VENDOR_SPECIFIC       0xFF
+
+/* bmAttributes in Configuration Descriptor */
+#define USB_CONFIG_POWERED_MASK                0x40
+#define USB_CONFIG_BUS_POWERED                 0x80
+#define USB_CONFIG_SELF_POWERED                0xC0
+#define USB_CONFIG_REMOTE_WAKEUP               0x20
+
+/* bMaxPower in Configuration Descriptor */
+#define USB_CONFIG_POWER_MA(mA)                ((mA)/2)
+
+/* bEndpointAddress in Endpoint Descriptor */
+#define USB_ENDPOINT_DIRECTION_MASK            0x80
+#define USB_ENDPOINT_OUT(addr)                 ((addr) | 0x00)
+#define USB_ENDPOINT_IN(addr)                  ((addr) | 0x80)
+
+/* bmAttributes in Endpoint Descriptor */
+#define USB_ENDPOINT_TYPE_MASK                 0x03
+#define USB_ENDPOINT_TYPE_CONTROL              0x00
+#define USB_ENDPOINT_TYPE_ISOCHRONOUS          0x01
+#define USB_ENDPOINT_TYPE_BULK                 0x02
+#define USB_ENDPOINT_TYPE_INTERRUPT            0x03
+#define USB_ENDPOINT_SYNC_MASK                 0x0C
+#define USB_ENDPOINT_SYNC_NO_SYNCHRONIZATION   0x00
+#define USB_ENDPOINT_SYNC_ASYNCHRONOUS         0x04
+#define USB_ENDPOINT_SYNC_ADAPTIVE             0x08
+#define USB_ENDPOINT_SYNC_SYNCHRONOUS          0x0C
+#define USB_ENDPOINT_USAGE_MASK                0x30
+#define USB_ENDPOINT_USAGE_DATA                0x00
+#define USB_ENDPOINT_USAGE_FEEDBACK            0x10
+#define USB_ENDPOINT_USAGE_IMPLICIT_FEEDBACK   0x20
+#define USB_ENDPOINT_USAGE_RESERVED            0x30
+
+/** Low byte and high byte of a 16-bit value, for descriptor tables */
+#define WBVAL(x) ((x) & 0xFF),(((x) >> 8) & 0xFF)
+
+/** Physical endpoint bit of an endpoint address (bit 7: IN), for the
+ * EPMask of class drivers and DMAEndpoints */
+#define USBDEV_EP_BIT(n)	(1UL << ((((n) & 0x0F) << 1) | (((n) >> 7) & 1)))
+
+/*********************************************************************//**
+ * Declarative descriptor tables: the descriptors of a configuration are
+ * the members of a structure, in the order they are sent, initialized
+ * with the macros below. bLength, wTotalLength and the offsets of the
+ * class descriptors are computed by the compiler, USB_DESC_ASSERT()
+ * turns a mismatch with the application definitions into a build error
+ **********************************************************************/
+/** Build error (negative array size) if cond is false */
+#define USB_DESC_ASSERT(name, cond)	typedef char usb_desc_assert_##name[(cond) ? 1 : -1]
+
+/** Type of a string descriptor of n UTF-16 characters */
+#define USB_STRING_DESC(n)	struct { uint8_t bLength; uint8_t bDescriptorType; uint16_t wString[n]; }
+
+/** Header of a string descriptor of n characters, followed by the
+ * braced characters in its initializer */
+#define USB_STRING_DESC_HDR(n)	(2 + 2 * (n)), USB_STRING_DESCRIPTOR_TYPE
+
+/** Configuration descriptor at the start of the structure type, its
+ * wTotalLength is the size of type */
+#define USB_CONFIG_DESC_INIT(type, nif, value, istr, attr, power) \
+	{ USB_CONFIGUARTION_DESC_SIZE, USB_CONFIGURATION_DESCRIPTOR_TYPE, \
+	  sizeof(type), (nif), (value), (istr), (attr), (power) }
+
+/** Interface descriptor */
+#define USB_INTERFACE_DESC_INIT(num, alt, neps, cls, sub, proto, istr) \
+	{ USB_INTERFACE_DESC_SIZE, USB_INTERFACE_DESCRIPTOR_TYPE, \
+	  (num), (alt), (neps), (cls), (sub), (proto), (istr) }
+
+/** Endpoint descriptor */
+#define USB_ENDPOINT_DESC_INIT(addr, attr, size, interval) \
+	{ USB_ENDPOINT_DESC_SIZE, USB_ENDPOINT_DESCRIPTOR_TYPE, \
+	  (addr), (attr), (size), (interval) }
+
+/** Number of endpoint descriptors from member first to the end of the
+ * structure type, when they are the last descriptors of an interface */
+#define USB_DESC_ENDPOINTS(type, first) \
+	((sizeof(type) - offsetof(type, first)) / USB_ENDPOINT_DESC_SIZE)
+
+/*********************************************************************//**
+ * USB device controller definitions
+ **********************************************************************/
+/* USB RAM Definitions */
+#define USB_RAM_ADR     0x20080000  /* USB RAM Start Address */
+#define USB_RAM_SZ      0x00004000  /* USB RAM Size (16kB) */
+
+/* DMA Endpoint Descriptors */
+#define DD_NISO_CNT             16  /* Non-Iso EP DMA Descr. Count (max. 32) */
+#define DD_ISO_CNT               8  /* Iso EP DMA Descriptor Count (max. 32) */
+#define DD_NISO_SZ    (DD_NISO_CNT * 16)    /* Non-Iso DMA Descr. Size */
+#define DD_ISO_SZ     (DD_ISO_CNT  * 20)    /* Iso DMA Descriptor Size */
+#define DD_NISO_ADR   (USB_RAM_ADR + 128)   /* Non-Iso DMA Descr. Address */
+#define DD_ISO_ADR    (DD_NISO_ADR + DD_NISO_SZ) /* Iso DMA Descr. Address */
+#define DD_SZ                 (128 + DD_NISO_SZ + DD_ISO_SZ) /* Descr. Size */
+
+/* DMA Buffer Memory Definitions */
+#define DMA_BUF_ADR   (USB_RAM_ADR + DD_SZ) /* DMA Buffer Start Address */
+#define DMA_BUF_SZ    (USB_RAM_SZ  - DD_SZ) /* DMA Buffer Size */
+
+/** Number of physical endpoints */
+#define USB_EP_NUM          32
+/** Largest interface number + 1 handled by the core */
+#define USB_IF_NUM          8
+/** Size of endpoint 0 buffer, largest control OUT data stage kept by
+ * the core */
+#define USB_EP0_BUF_SIZE    64
+/** Deferred calls queued at most, a power of 2 */
+#define USB_DEFER_NUM       16
+/** Configuration and string descriptors indexed by USB_Init() for the
+ * GET_DESCRIPTOR requests, the ones beyond are not sent */
+#define USB_CONFIG_NUM      4
+#define USB_STRING_NUM      16
+
+/* USB Error Codes */
+#define USB_ERR_PID         0x0001  /* PID Error */
+#define USB_ERR_UEPKT       0x0002  /* Unexpected Packet */
+#define USB_ERR_DCRC        0x0004  /* Data CRC Error */
+#define USB_ERR_TIMOUT      0x0008  /* Bus Time-out Error */
+#define USB_ERR_EOP         0x0010  /* End of Packet Error */
+#define USB_ERR_B_OVRN      0x0020  /* Buffer Overrun */
+#define USB_ERR_BTSTF       0x0040  /* Bit Stuff Error */
+#define USB_ERR_TGL         0x0080  /* Toggle Bit Error */
+
+/* USB DMA Status Codes */
+#define USB_DMA_INVALID     0x0000  /* DMA Invalid - Not Configured */
+#define USB_DMA_IDLE        0x0001  /* DMA Idle - Waiting for Trigger */
+#define USB_DMA_BUSY        0x0002  /* DMA Busy - Transfer in progress */
+#define USB_DMA_DONE        0x0003  /* DMA Transfer Done (no Errors)*/
+#define USB_DMA_OVER_RUN    0x0004  /* Data Over Run */
+#define USB_DMA_UNDER_RUN   0x0005  /* Data Under Run (Short Packet) */
+#define USB_DMA_ERROR       0x0006  /* Error */
+#define USB_DMA_UNKNOWN     0xFFFF  /* Unknown State */
+
+/*********************************************************************//**
+ * Endpoint events, passed to the handlers of the endpoint dispatch table
+ **********************************************************************/
+#define USB_EVT_SETUP       1   /* Setup Packet */
+#define USB_EVT_OUT         2   /* OUT Packet */
+#define USB_EVT_IN          3   /*  IN Packet */
+#define USB_EVT_OUT_NAK     4   /* OUT Packet - Not Acknowledged */
+#define USB_EVT_IN_NAK      5   /*  IN Packet - Not Acknowledged */
+#define USB_EVT_OUT_STALL   6   /* OUT Packet - Stalled */
+#define USB_EVT_IN_STALL    7   /*  IN Packet - Stalled */
+#define USB_EVT_OUT_DMA_EOT 8   /* DMA OUT EP - End of Transfer */
+#define USB_EVT_IN_DMA_EOT  9   /* DMA  IN EP - End of Transfer */
+#define USB_EVT_OUT_DMA_NDR 10  /* DMA OUT EP - New Descriptor Request */
+#define USB_EVT_IN_DMA_NDR  11  /* DMA  IN EP - New Descriptor Request */
+#define USB_EVT_OUT_DMA_ERR 12  /* DMA OUT EP - Error */
+#define USB_EVT_IN_DMA_ERR  13  /* DMA  IN EP - Error */
+
+/*********************************************************************//**
+ * Device events, passed to the Event callbacks of the device and of the
+ * class drivers. Each one is also the bit selecting it in EventMask.
+ **********************************************************************/
+/** Bus reset, core state is already reset */
+#define USBDEV_EVT_RESET        ((uint32_t)(1<<0))
+/** Suspend */
+#define USBDEV_EVT_SUSPEND      ((uint32_t)(1<<1))
+/** Resume */
+#define USBDEV_EVT_RESUME       ((uint32_t)(1<<2))
+/** VBUS connect change, param: TRUE if connected */
+#define USBDEV_EVT_POWER        ((uint32_t)(1<<3))
+/** Start of frame, param: frame number. Enables the frame interrupt */
+#define USBDEV_EVT_SOF          ((uint32_t)(1<<4))
+/** Bus error, param: error status (USB_ERR_xxx). Enables the error
+ * interrupt */
+#define USBDEV_EVT_ERROR        ((uint32_t)(1<<5))
+/** Set configuration, param: configuration value (0: deconfigured) */
+#define USBDEV_EVT_CONFIGURE    ((uint32_t)(1<<6))
+/** Set interface, param: interface number | (alternate setting << 8) */
+#define USBDEV_EVT_INTERFACE    ((uint32_t)(1<<7))
+/** Set/clear feature, param: the feature selector */
+#define USBDEV_EVT_FEATURE      ((uint32_t)(1<<8))
+/** Endpoint halt cleared by the host, param: endpoint address. Only
+ * sent to the class driver owning the endpoint */
+#define USBDEV_EVT_CLEAR_HALT   ((uint32_t)(1<<9))
+
+/**
+ * @}
+ */
+
+/* Private Macros ------------------------------------------------------------- */
+/** @defgroup USBDEV_Private_Macros USBDEV Private Macros
+ * @{
+ */
+
+/* ---------------- CHECK PARAMETER DEFINITIONS ---------------------------- */
+/** Macro to check an endpoint address: number 0 to 15, direction bit 7 */
+#define PARAM_USBDEV_EP(n)		(((n) & 0x70) == 0)
+/** Macro to check the interface range of a class driver */
+#define PARAM_USBDEV_IF(first, num)	(((num) > 0) && (((first) + (num)) <= USB_IF_NUM))
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup USBDEV_Public_Types USBDEV Public Types
+ * @{
+ */
+
+#if defined     (  __CC_ARM  )
+typedef __packed union {
+#elif defined   (  __GNUC__  )
+typedef union __packed {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef union {
+#endif
+  uint16_t W;
+#if defined     (  __CC_ARM  )
+  __packed struct {
+#elif defined   (  __GNUC__  )
+  struct __packed {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+  struct {
+#endif
+    uint8_t L;
+    uint8_t H;
+  } WB;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+} WORD_BYTE;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** bmRequestType Definition */
+#if defined     (  __CC_ARM  )
+typedef __packed union _REQUEST_TYPE {
+#elif defined   (  __GNUC__  )
+typedef union __packed _REQUEST_TYPE {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef union _REQUEST_TYPE {
+#endif
+#if defined     (  __CC_ARM  )
+	__packed struct _BM {
+#elif defined   (  __GNUC__  )
+	struct __packed _BM {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+	struct _BM {
+#endif
+    uint8_t Recipient : 5;
+    uint8_t Type      : 2;
+    uint8_t Dir       : 1;
+  } BM;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+  uint8_t B;
+} REQUEST_TYPE;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB Default Control Pipe Setup Packet */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_SETUP_PACKET {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_SETUP_PACKET {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_SETUP_PACKET {
+#endif
+  REQUEST_TYPE bmRequestType;
+  uint8_t      bRequest;
+  WORD_BYTE    wValue;
+  WORD_BYTE    wIndex;
+  uint16_t     wLength;
+} USB_SETUP_PACKET;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB Standard Device Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_DEVICE_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_DEVICE_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_DEVICE_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint16_t bcdUSB;
+  uint8_t  bDeviceClass;
+  uint8_t  bDeviceSubClass;
+  uint8_t  bDeviceProtocol;
+  uint8_t  bMaxPacketSize0;
+  uint16_t idVendor;
+  uint16_t idProduct;
+  uint16_t bcdDevice;
+  uint8_t  iManufacturer;
+  uint8_t  iProduct;
+  uint8_t  iSerialNumber;
+  uint8_t  bNumConfigurations;
+} USB_DEVICE_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB Standard Configuration Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_CONFIGURATION_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_CONFIGURATION_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_CONFIGURATION_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint16_t wTotalLength;
+  uint8_t  bNumInterfaces;
+  uint8_t  bConfigurationValue;
+  uint8_t  iConfiguration;
+  uint8_t  bmAttributes;
+  uint8_t  bMaxPower;
+} USB_CONFIGURATION_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB Standard Interface Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_INTERFACE_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_INTERFACE_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_INTERFACE_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint8_t  bInterfaceNumber;
+  uint8_t  bAlternateSetting;
+  uint8_t  bNumEndpoints;
+  uint8_t  bInterfaceClass;
+  uint8_t  bInterfaceSubClass;
+  uint8_t  bInterfaceProtocol;
+  uint8_t  iInterface;
+} USB_INTERFACE_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB Standard Endpoint Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_ENDPOINT_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_ENDPOINT_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_ENDPOINT_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint8_t  bEndpointAddress;
+  uint8_t  bmAttributes;
+  uint16_t wMaxPacketSize;
+  uint8_t  bInterval;
+} USB_ENDPOINT_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB String Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_STRING_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_STRING_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_STRING_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint16_t bString/*[]*/;
+} USB_STRING_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/** USB Common Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _USB_COMMON_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _USB_COMMON_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _USB_COMMON_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+} USB_COMMON_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/**
+ * @brief USB DMA Descriptor
+ */
+typedef struct _USB_DMA_DESCRIPTOR {
+  uint32_t BufAdr;                     /* DMA Buffer Address */
+  uint16_t BufLen;                     /* DMA Buffer Length */
+  uint16_t MaxSize;                    /* Maximum Packet Size */
+  uint32_t InfoAdr;                    /* Packet Info Memory Address */
+  union {                              /* DMA Configuration */
+    struct {
+      uint32_t Link   : 1;             /* Link to existing Descriptors */
+      uint32_t IsoEP  : 1;             /* Isonchronous Endpoint */
+      uint32_t ATLE   : 1;             /* ATLE (Auto Transfer Length Extract) */
+      uint32_t Rsrvd  : 5;             /* Reserved */
+      uint32_t LenPos : 8;             /* Length Position (ATLE) */
+    } Type;
+    uint32_t Val;
+  } Cfg;
+} USB_DMA_DESCRIPTOR;
+
+/**
+ * @brief Control transfer data stage: data pointer and remaining count
+ */
+typedef struct _USB_EP_DATA {
+  uint8_t  *pData;
+  uint16_t Count;
+} USB_EP_DATA;
+
+/** Endpoint event handler of the dispatch table: arg is the pointer given
+ * to USB_RegisterEP(), event one of USB_EVT_xxx */
+typedef void (*USBDEV_EP_HANDLER)(void *arg, uint32_t event);
+
+/** Deferred call queued by USB_Defer(), run by USB_Task() in the main loop,
+ * with the arguments given to USB_Defer() */
+typedef void (*USBDEV_DEFER_FUNC)(void *arg, uint32_t event, uint32_t param);
+
+/**
+ * @brief Durations of one kind of interrupt event, measured with the
+ * cycle counter of the core (DWT)
+ */
+typedef struct {
+	uint32_t Count;					/**< Number of events */
+	uint32_t Cycles;				/**< Total duration (CPU cycles), wraps around */
+	uint32_t Max;					/**< Longest duration (CPU cycles) */
+} USBDEV_ISR_STAT_Type;
+
+/**
+ * @brief Interrupt statistics, read by USB_GetStats(). Each duration
+ * includes the callbacks and handlers called for the event
+ */
+typedef struct {
+	USBDEV_ISR_STAT_Type Total;		/**< Whole USB_IntHandler() */
+	USBDEV_ISR_STAT_Type Device;	/**< Device status: reset, connect change,
+									 suspend and resume */
+	USBDEV_ISR_STAT_Type Frame;		/**< Start of frame */
+	USBDEV_ISR_STAT_Type Error;		/**< Error interrupt */
+	USBDEV_ISR_STAT_Type EP[USB_EP_NUM];	/**< Slave and DMA events of each
+									 physical endpoint */
+	USBDEV_ISR_STAT_Type Deferred;	/**< Deferred calls run by USB_Task() */
+	uint32_t DeferQueued;			/**< Most deferred calls queued at once */
+	uint32_t DeferLost;				/**< Deferred calls lost, queue full */
+} USBDEV_STATS_Type;
+
+/**
+ * @brief Device configuration, given to USB_Init(). The descriptors
+ * stay in use while the device is running.
+ */
+typedef struct {
+	const uint8_t *DeviceDescriptor;	/**< Device descriptor, bMaxPacketSize0
+									 sets the endpoint 0 packet size (8 to 64) */
+	const uint8_t *ConfigDescriptor;	/**< Configuration descriptors with all their
+									 interface, class and endpoint descriptors,
+									 one after another, terminated by a 0 byte.
+									 USB_CONFIG_NUM at most */
+	const uint8_t *StringDescriptor;	/**< String descriptors in index order,
+									 index 0 (LANGID) first, terminated by a 0 byte.
+									 USB_STRING_NUM at most, NULL if there are none */
+	uint32_t EventMask;				/**< Device events passed to Event(),
+									 or'ed USBDEV_EVT_xxx bits */
+	void (*Event)(uint32_t event, uint32_t param);	/**< Device event callback,
+									 called from the interrupt handler, may be NULL */
+	uint32_t DMAEndpoints;			/**< Physical endpoints (bit 2*n: OUT n, bit 2*n+1:
+									 IN n) serviced by DMA from reset on: their slave
+									 interrupts are disabled and DMA is enabled.
+									 Used only with _USB_DMA */
+	uint32_t DeferMask;				/**< Device events of EventMask passed to
+									 Event() from USB_Task() in the main loop instead
+									 of the interrupt handler, or'ed USBDEV_EVT_xxx
+									 bits */
+} USBDEV_CFG_Type;
+
+/**
+ * @brief Class driver. A class driver owns a range of consecutive
+ * interfaces and a set of endpoints; several of them registered with
+ * USB_RegisterClass() form a composite device.
+ */
+typedef struct _USBDEV_CLASS_Type {
+	uint8_t FirstIF;				/**< First interface owned by the class */
+	uint8_t NumIF;					/**< Number of consecutive interfaces owned */
+	uint8_t Reserved[2];
+	uint32_t EPMask;				/**< Physical endpoints owned (same coding as
+									 DMAEndpoints), for endpoint recipient requests
+									 and USBDEV_EVT_CLEAR_HALT */
+	uint32_t EventMask;				/**< Device events passed to Event(), or'ed
+									 USBDEV_EVT_xxx bits */
+	uint32_t (*Request)(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data);
+									/**< Setup stage of class and vendor requests to
+									 the interfaces or endpoints of the class, and of
+									 standard GET_DESCRIPTOR to its interfaces. data
+									 points to EP0Buf with Count = wLength: for IN
+									 requests, set pData/Count to the data to send;
+									 for OUT requests, pData is where the data stage
+									 is received. Return TRUE to accept, FALSE to stall */
+	uint32_t (*DataOut)(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len);
+									/**< OUT data stage of an accepted request is
+									 complete. Return TRUE to acknowledge, FALSE to
+									 stall. May be NULL if the class has no OUT requests */
+	void (*Event)(void *arg, uint32_t event, uint32_t param);	/**< Device events,
+									 USBDEV_EVT_xxx, may be NULL */
+	void *arg;						/**< Argument of the callbacks */
+	struct _USBDEV_CLASS_Type *next;	/**< Private: next registered class */
+} USBDEV_CLASS_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Variables ----------------------------------------------------------- */
+/** @defgroup USBDEV_Public_Variables USBDEV Public Variables
+ * @{
+ */
+
+/* USB Core Global Variables */
+extern uint16_t USB_DeviceStatus;
+extern uint8_t  USB_DeviceAddress;
+extern uint8_t  USB_Configuration;
+extern uint32_t USB_EndPointMask;
+extern uint32_t USB_EndPointHalt;
+extern uint32_t USB_EndPointStall;
+extern uint8_t  USB_AltSetting[USB_IF_NUM];
+
+/* USB Endpoint 0 Buffer */
+extern uint8_t  EP0Buf[USB_EP0_BUF_SIZE];
+
+/* USB Endpoint 0 Data Info */
+extern USB_EP_DATA EP0Data;
+
+/* USB Setup Packet */
+extern USB_SETUP_PACKET SetupPacket;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup USBDEV_Public_Functions USBDEV Public Functions
+ * @{
+ */
+
+/* Device functions ------------------*/
+void USB_Init(const USBDEV_CFG_Type *cfg);
+void USB_Connect(uint32_t con);
+void USB_RegisterClass(USBDEV_CLASS_Type *cls);
+void USB_RegisterEP(uint32_t EPNum, USBDEV_EP_HANDLER handler, void *arg);
+void USB_IntHandler(void);
+void USB_ResetCore(void);
+void USB_Reset(void);
+void USB_Suspend(void);
+void USB_Resume(void);
+void USB_WakeUp(void);
+void USB_WakeUpCfg(uint32_t cfg);
+void USB_SetAddress(uint32_t adr);
+void USB_Configure(uint32_t cfg);
+uint32_t USB_GetFrame(void);
+Status USB_Defer(USBDEV_DEFER_FUNC func, void *arg, uint32_t event, uint32_t param);
+uint32_t USB_Task(void);
+void USB_GetStats(USBDEV_STATS_Type *stats);
+void USB_ClearStats(void);
+
+/* Endpoint functions ----------------*/
+void USB_ConfigEP(USB_ENDPOINT_DESCRIPTOR *pEPD);
+void USB_DirCtrlEP(uint32_t dir);
+void USB_EnableEP(uint32_t EPNum);
+void USB_DisableEP(uint32_t EPNum);
+void USB_ResetEP(uint32_t EPNum);
+void USB_SetStallEP(uint32_t EPNum);
+void USB_ClrStallEP(uint32_t EPNum);
+void USB_ClearEPBuf(uint32_t EPNum);
+uint32_t USB_ReadEP(uint32_t EPNum, uint8_t *pData);
+uint32_t USB_WriteEP(uint32_t EPNum, uint8_t *pData, uint32_t cnt);
+
+/* DMA functions ---------------------*/
+uint32_t USB_DMA_Setup(uint32_t EPNum, USB_DMA_DESCRIPTOR *pDD);
+void USB_DMA_Enable(uint32_t EPNum);
+void USB_DMA_Disable(uint32_t EPNum);
+uint32_t USB_DMA_Status(uint32_t EPNum);
+uint32_t USB_DMA_BufAdr(uint32_t EPNum);
+uint32_t USB_DMA_BufCnt(uint32_t EPNum);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_USBDEV_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
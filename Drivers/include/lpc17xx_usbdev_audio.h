@@ -1,24 +1,53 @@
-/*----------------------------------------------------------------------------
- *      U S B  -  K e r n e l
- *----------------------------------------------------------------------------
- *      Name:    AUDIO.H
- *      Purpose: USB Audio Device Class Definitions
- *      Version: V1.10
- *----------------------------------------------------------------------------
- *      This software is supplied "AS IS" without any warranties, express,
- *      implied or statutory, including but not limited to the implied
- *      warranties of fitness for purpose, satisfactory quality and
- *      noninfringement. Keil extends you a royalty-free right to reproduce
- *      and distribute executable files created using this software for use
- *      on Philips LPC2xxx microcontroller devices only. Nothing else gives
- *      you the right to use this software.
- *
- *      Copyright (c) 2005-2006 Keil Software.
- *---------------------------------------------------------------------------*/
-
-#ifndef __AUDIO_H__
-#define __AUDIO_H__
-
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_audio.h			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_audio.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the USB audio class driver (audio control
+* 			with one feature unit, audio streaming)
+* 			on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup USBDEV_AUDIO USBDEV_AUDIO
+ * @ingroup USBDEV
+ * @{
+ */
+
+#ifndef LPC17XX_USBDEV_AUDIO_H_
+#define LPC17XX_USBDEV_AUDIO_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup USBDEV_AUDIO_Public_Macros USBDEV_AUDIO Public Macros
+ * @{
+ */
 
 /* Audio Interface Subclass Codes */
 #define AUDIO_SUBCLASS_UNDEFINED                0x00
@@ -369,4 +398,154 @@
 #define AUDIO_TERMINAL_SYNTHESIZER              0x0713
 
 
-#endif  /* __AUDIO_H__ */
+/* Feedback value (full speed): samples per frame in 10.14 format */
+#define AUDIO_FEEDBACK_SIZE                     3
+#define AUDIO_FEEDBACK_VALUE(rate)              ((((rate) / 1000) << 14) | \
+                                                 ((((rate) % 1000) << 14) / 1000))
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup USBDEV_AUDIO_Public_Types USBDEV_AUDIO Public Types
+ * @{
+ */
+
+/**
+ * @brief Isochronous OUT stream of the audio class driver, asynchronous
+ * endpoint with explicit feedback.
+ *
+ * From the selection of a non zero alternate setting of IF, the packet
+ * of the data endpoint is read into the ring buffer on each SOF (no
+ * copy, Buf has MaxPacket bytes of slack past Size for a packet that
+ * wraps around). The player takes the samples with USB_AudioRead(), it
+ * gets none until Target bytes are buffered, then until the ring runs
+ * empty (underrun).
+ * Every 2^FeedbackShift frames, the samples played during the period
+ * (Position) give the rate of the output clock in samples per frame of
+ * the host clock. Their average, corrected by the distance of the mean
+ * level of the period (LevelMean) to Target, is loaded into FeedbackEP
+ * on each SOF:
+ * a host that follows it keeps the level at Target, whatever the drift
+ * between the clocks.
+ *
+ * The application fills the configuration fields, the other fields are
+ * for driver use. Level and statistics are updated on each SOF.
+ */
+typedef struct {
+	uint8_t IF;					/**< Configuration: streaming interface of EP */
+	uint8_t FeedbackEP;			/**< Configuration: isochronous IN feedback
+								 endpoint, 0 if none */
+	uint8_t FeedbackShift;		/**< Configuration: feedback and LevelMean
+								 period is 2^FeedbackShift frames (bRefresh of
+								 FeedbackEP), 1 to 9 */
+	uint8_t SampleBytes;		/**< Configuration: bytes per sample, all
+								 channels */
+	uint16_t MaxPacket;			/**< Configuration: wMaxPacketSize of EP */
+	uint16_t Reserved;
+	uint32_t Rate;				/**< Configuration: nominal sample rate (Hz) */
+	uint8_t *Buf;				/**< Configuration: Size + MaxPacket bytes, word
+								 aligned */
+	uint32_t Size;				/**< Configuration: ring size (bytes), power of 2,
+								 at least 2 * Target */
+	uint32_t Target;			/**< Configuration: level (bytes) at which playback
+								 starts and that the feedback maintains */
+	uint32_t (*Position)(void *arg);	/**< Configuration: samples played by
+								 the output since any origin, free running. May
+								 be NULL: the feedback is then the nominal rate
+								 corrected by the level only */
+	void *arg;					/**< Configuration: Position argument */
+	__IO uint32_t head;			/**< Bytes received, free running */
+	__IO uint32_t tail;			/**< Bytes read by the player, free running */
+	__IO uint8_t active;		/**< Alternate setting of IF is not 0 */
+	uint8_t primed;				/**< Player reached Target since the last underrun */
+	uint16_t period;			/**< Frames since the last feedback measure */
+	uint32_t pos;				/**< Position at the last feedback measure */
+	uint32_t levelsum;			/**< Sum of Level since the last measure */
+	uint32_t rate;				/**< Average output rate, samples per frame 10.14,
+								 times 2^AUDIO_FEEDBACK_AVG */
+	uint8_t fb[4];				/**< Feedback packet */
+	uint32_t Level;				/**< Statistics: bytes buffered after the last
+								 packet */
+	uint32_t LevelMean;			/**< Statistics: mean Level over the last
+								 period */
+	uint32_t LevelMin;			/**< Statistics: lowest Level while playing,
+								 since the start */
+	uint32_t LevelMax;			/**< Statistics: highest Level while playing,
+								 since the start */
+	uint32_t Feedback;			/**< Statistics: last feedback value (10.14) */
+	uint32_t Frames;			/**< Statistics: frames since the start */
+	uint32_t Packets;			/**< Statistics: packets received */
+	uint32_t Missed;			/**< Statistics: frames without packet */
+	uint32_t Overruns;			/**< Statistics: packets dropped, ring full */
+	uint32_t Underruns;			/**< Statistics: ring run empty while playing */
+} USBDEV_AUDIO_STREAM_Type;
+
+/**
+ * @brief Audio class driver instance. The application fills the
+ * configuration fields and the initial control values before
+ * USB_AudioInit().
+ */
+typedef struct _USBDEV_AUDIO_Type {
+	uint8_t CIF;					/**< Configuration: audio control interface */
+	uint8_t NumIF;					/**< Configuration: number of interfaces, audio
+									 control and streaming interfaces */
+	uint8_t FeatureUnit;			/**< Configuration: feature unit ID (bUnitID) */
+	uint8_t EP;						/**< Configuration: isochronous endpoint */
+	void (*ControlChange)(struct _USBDEV_AUDIO_Type *audio);	/**< Configuration:
+									 Mute or VolCur set by the host. May be NULL */
+	void (*Streaming)(struct _USBDEV_AUDIO_Type *audio, uint8_t ifn, uint8_t alt);
+									/**< Configuration: alternate setting of a
+									 streaming interface selected, 0 is zero
+									 bandwidth. May be NULL */
+	void (*Frame)(struct _USBDEV_AUDIO_Type *audio, uint32_t frame);	/**<
+									 Configuration: start of frame (every 1ms), move
+									 a packet of EP. May be NULL */
+	void (*Endpoint)(struct _USBDEV_AUDIO_Type *audio, uint32_t event);	/**<
+									 Configuration: events of EP (USB_EVT_xxx, DMA
+									 events if EP is in DMAEndpoints). May be NULL */
+	USBDEV_AUDIO_STREAM_Type *Stream;	/**< Configuration: NULL, or stream
+									 engine of EP (OUT, not in DMAEndpoints),
+									 Endpoint must then be NULL */
+	uint16_t VolCur;				/**< Volume current value */
+	uint16_t VolMin;				/**< Volume minimum value */
+	uint16_t VolMax;				/**< Volume maximum value */
+	uint16_t VolRes;				/**< Volume resolution */
+	uint8_t Mute;					/**< Mute state */
+	uint8_t Reserved[3];
+	USBDEV_CLASS_Type cls;			/**< Private: class driver registered */
+} USBDEV_AUDIO_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup USBDEV_AUDIO_Public_Functions USBDEV_AUDIO Public Functions
+ * @{
+ */
+
+void USB_AudioInit(USBDEV_AUDIO_Type *audio);
+uint32_t USB_AudioRead(USBDEV_AUDIO_Type *audio, uint8_t *dst, uint32_t len);
+uint32_t USB_AudioLevel(USBDEV_AUDIO_Type *audio);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_USBDEV_AUDIO_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
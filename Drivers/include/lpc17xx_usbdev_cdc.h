@@ -1,28 +1,54 @@
-/*----------------------------------------------------------------------------
- *      U S B  -  K e r n e l
- *----------------------------------------------------------------------------
- *      Name:    CDC.h
- *      Purpose: USB Communication Device Class Definitions
- * Version: V1.20
- *----------------------------------------------------------------------------
- *      This software is supplied "AS IS" without any warranties, express,
- *      implied or statutory, including but not limited to the implied
- *      warranties of fitness for purpose, satisfactory quality and
- *      noninfringement. Keil extends you a royalty-free right to reproduce
- *      and distribute executable files created using this software for use
- *      on NXP Semiconductors LPC family microcontroller devices only. Nothing
- *      else gives you the right to use this software.
- *
- * Copyright (c) 2009 Keil - An ARM Company. All rights reserved.
- *---------------------------------------------------------------------------*/
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_cdc.h			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_cdc.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the USB CDC (communication device class, abstract
+* 			control model) class driver on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup USBDEV_CDC USBDEV_CDC
+ * @ingroup USBDEV
+ * @{
+ */
 
-#ifndef __CDC_H
-#define __CDC_H
-#include "lpc_types.h"
+#ifndef LPC17XX_USBDEV_CDC_H_
+#define LPC17XX_USBDEV_CDC_H_
 
-#if defined   (  __GNUC__  )
-#define __packed __attribute__((__packed__))
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev.h"
+#include "lpc17xx_gpdma.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
 #endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup USBDEV_CDC_Public_Macros USBDEV_CDC Public Macros
+ * @{
+ */
+
 /*----------------------------------------------------------------------------
  *      Definitions  based on usbcdc11.pdf (www.usb.org)
  *---------------------------------------------------------------------------*/
@@ -168,6 +194,21 @@
 #define CDC_SERIAL_STATE_TX_CARRIER             (1 << 1)  // state of transmission carrier
 #define CDC_SERIAL_STATE_RX_CARRIER             (1 << 0)  // state of receiver carrier
 
+/** Size of the SERIAL_STATE notification */
+#define CDC_NOTIFICATION_SIZE                   10
+
+/** Max packet size of the bulk data endpoints (full speed) */
+#define CDC_MAX_PACKET                          64
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup USBDEV_CDC_Public_Types USBDEV_CDC Public Types
+ * @{
+ */
 
 /*----------------------------------------------------------------------------
  *      Structures  based on usbcdc11.pdf (www.usb.org)
@@ -279,5 +320,129 @@ typedef struct _CDC_LINE_CODING {
 // see  USB_SETUP_PACKET in file usb.h
 typedef USB_SETUP_PACKET CDC_NOTIFICATION_HEADER;
 
-#endif /* __CDC_H */
+/**
+ * @brief UART bridge of the CDC class driver (only with _USB_DMA): the
+ * bulk data endpoints are served by USB DMA in place, from and into two
+ * rings that GPDMA moves from and to the UART FIFOs, no byte is copied
+ * by the CPU.
+ *
+ * UART to host: GPDMA fills RxBuf through a circular chain of RxBlocks
+ * LLIs, without interrupt. On each SOF and at the end of each IN
+ * transfer, the bytes received since the last transfer are sent in one
+ * DMA transfer. The chain is cut before the block holding the oldest
+ * unsent byte: when the host does not read, the GPDMA channel stops, the
+ * UART FIFO fills and RTS (auto-RTS) holds the sender instead of data
+ * being overwritten.
+ * Host to UART: DEP_OUT is armed with a DMA transfer into the free space
+ * of TxBuf, a multiple of CDC_MAX_PACKET bytes. When TxBuf is full it is
+ * left unarmed: the device NAKs the host until GPDMA has sent enough
+ * bytes to the UART.
+ *
+ * The UART is initialized by the application in FIFO DMA mode with RX
+ * trigger level 0 (FCR = 0x0F). The application fills the configuration
+ * fields, the other fields are for driver use.
+ */
+typedef struct {
+	LPC_UART_TypeDef *UARTx;	/**< Configuration: LPC_UART0/2/3 or
+								 (LPC_UART_TypeDef *)LPC_UART1 */
+	uint8_t DMARx;				/**< Configuration: GPDMA channel UART to RxBuf */
+	uint8_t DMATx;				/**< Configuration: GPDMA channel TxBuf to UART */
+	uint16_t RxBlocks;			/**< Configuration: blocks in RxBuf, at least 3 */
+	uint16_t RxBlockSize;		/**< Configuration: bytes per block, 1 to 4095 */
+	uint16_t TxSize;			/**< Configuration: bytes of TxBuf, a multiple of
+								 CDC_MAX_PACKET */
+	uint8_t *RxBuf;				/**< Configuration: RxBlocks * RxBlockSize bytes
+								 (64KB at most) in AHB SRAM, e.g. from DMA_BUF_ADR */
+	uint8_t *TxBuf;				/**< Configuration: TxSize bytes in AHB SRAM */
+	GPDMA_LLI_Type *RxLLI;		/**< Configuration: RxBlocks LLIs, word aligned */
+	uint32_t rxtail;			/**< Offset of the oldest unsent byte in RxBuf */
+	uint32_t rxcut;				/**< Block whose LLI ends the chain */
+	uint32_t inlen;				/**< Bytes of the IN transfer in flight, 0 if none */
+	uint32_t txhead;			/**< Offset in TxBuf of the next OUT transfer */
+	uint32_t txtail;			/**< Offset in TxBuf of the next byte to the UART */
+	uint32_t txwrap;			/**< End of the data before the end of TxBuf when
+								 txhead wrapped around, 0 if not wrapped */
+	uint32_t outlen;			/**< Bytes of the armed OUT transfer, 0 if none */
+	uint32_t txlen;				/**< Bytes of the GPDMA transmit in flight, 0 if none */
+	uint8_t connrx;				/**< GPDMA connection of the UART receiver */
+	uint8_t conntx;				/**< GPDMA connection of the UART transmitter */
+	uint8_t running;			/**< Started by the configuration of the device */
+	uint8_t Reserved;
+	uint32_t InBytes;			/**< Statistics: bytes sent to the host */
+	uint32_t OutBytes;			/**< Statistics: bytes received from the host */
+	uint32_t RxHolds;			/**< Statistics: frames (ms) with the UART receive
+								 stopped, RxBuf full */
+	uint32_t OutHolds;			/**< Statistics: frames (ms) with DEP_OUT NAKing,
+								 TxBuf full */
+	uint32_t Errors;			/**< Statistics: USB DMA and GPDMA errors */
+} USBDEV_CDC_BRIDGE_Type;
+
+/**
+ * @brief CDC class driver instance. The application fills the
+ * configuration fields before USB_CdcInit().
+ */
+typedef struct _USBDEV_CDC_Type {
+	uint8_t CIF;					/**< Configuration: communication interface,
+									 the data interface must follow it */
+	uint8_t CEP_IN;					/**< Configuration: notification endpoint (IN) */
+	uint8_t DEP_IN;					/**< Configuration: bulk data IN endpoint */
+	uint8_t DEP_OUT;				/**< Configuration: bulk data OUT endpoint */
+	uint32_t (*SetLineCoding)(struct _USBDEV_CDC_Type *cdc);	/**< Configuration:
+									 LineCoding was changed by the host. Return
+									 FALSE to refuse it. May be NULL */
+	uint32_t (*SetControlLineState)(struct _USBDEV_CDC_Type *cdc, uint16_t state);
+									/**< Configuration: CDC_DTE_PRESENT and
+									 CDC_ACTIVATE_CARRIER bits. May be NULL */
+	uint32_t (*SendBreak)(struct _USBDEV_CDC_Type *cdc, uint16_t duration);
+									/**< Configuration: 0xFFFF start of break, 0 stop
+									 of break, otherwise duration in ms. May be NULL */
+	void (*BulkOut)(struct _USBDEV_CDC_Type *cdc);	/**< Configuration: a packet was
+									 received on DEP_OUT, read it with USB_ReadEP() */
+	void (*BulkIn)(struct _USBDEV_CDC_Type *cdc);	/**< Configuration: DEP_IN is
+									 empty, USB_CdcWrite() can be called */
+	USBDEV_CDC_BRIDGE_Type *Bridge;	/**< Configuration: NULL, or UART bridge
+									 serving the bulk data endpoints (only with
+									 _USB_DMA, DEP_IN and DEP_OUT in DMAEndpoints).
+									 BulkOut, BulkIn and USB_CdcWrite() are then
+									 not used */
+	CDC_LINE_CODING LineCoding;		/**< Line coding, initial value set by the
+									 application, then changed by the host */
+	uint16_t SerialState;			/**< Last UART state sent by USB_CdcNotify() */
+	uint8_t InBusy;					/**< DEP_IN holds a packet not yet read by the host */
+	uint8_t NotifyBusy;				/**< CEP_IN holds a notification not yet read */
+	uint8_t NotifyBuf[CDC_NOTIFICATION_SIZE];	/**< SERIAL_STATE notification */
+	USBDEV_CLASS_Type cls;			/**< Private: class driver registered */
+} USBDEV_CDC_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup USBDEV_CDC_Public_Functions USBDEV_CDC Public Functions
+ * @{
+ */
+
+void USB_CdcInit(USBDEV_CDC_Type *cdc);
+uint32_t USB_CdcWrite(USBDEV_CDC_Type *cdc, uint8_t *buf, uint32_t len);
+Status USB_CdcNotify(USBDEV_CDC_Type *cdc, uint16_t state);
+void USB_CdcBridgeDMAHandler(USBDEV_CDC_Type *cdc);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_USBDEV_CDC_H_ */
+
+/**
+ * @}
+ */
 
+/* --------------------------------- End Of File ------------------------------ */
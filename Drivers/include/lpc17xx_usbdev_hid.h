@@ -1,28 +1,52 @@
-/*----------------------------------------------------------------------------
- *      U S B  -  K e r n e l
- *----------------------------------------------------------------------------
- *      Name:    HID.H
- *      Purpose: USB HID (Human Interface Device) Definitions
- *      Version: V1.10
- *----------------------------------------------------------------------------
- *      This software is supplied "AS IS" without any warranties, express,
- *      implied or statutory, including but not limited to the implied
- *      warranties of fitness for purpose, satisfactory quality and
- *      noninfringement. Keil extends you a royalty-free right to reproduce
- *      and distribute executable files created using this software for use
- *      on NXP Semiconductors LPC family microcontroller devices only. Nothing
- *      else gives you the right to use this software.
- *
- *      Copyright (c) 2005-2009 Keil Software.
- *---------------------------------------------------------------------------*/
-
-#ifndef __HID_H__
-#define __HID_H__
-
-#if defined   (  __GNUC__  )
-#define __packed __attribute__((__packed__))
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_hid.h			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_hid.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the USB HID (human interface device) class driver
+* 			on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup USBDEV_HID USBDEV_HID
+ * @ingroup USBDEV
+ * @{
+ */
+
+#ifndef LPC17XX_USBDEV_HID_H_
+#define LPC17XX_USBDEV_HID_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
 #endif
 
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup USBDEV_HID_Public_Macros USBDEV_HID Public Macros
+ * @{
+ */
 
 /* HID Subclass Codes */
 #define HID_SUBCLASS_NONE               0x00
@@ -39,41 +63,6 @@
 #define HID_REPORT_DESCRIPTOR_TYPE      0x22
 #define HID_PHYSICAL_DESCRIPTOR_TYPE    0x23
 
-
-/* HID Descriptor */
-#if defined     (  __CC_ARM  )
-typedef __packed struct _HID_DESCRIPTOR {
-#elif defined   (  __GNUC__  )
-typedef struct __packed _HID_DESCRIPTOR {
-#elif defined   (  __IAR_SYSTEMS_ICC__  )
-#pragma pack(1)
-typedef struct _HID_DESCRIPTOR {
-#endif
-  uint8_t  bLength;
-  uint8_t  bDescriptorType;
-  uint16_t  bcdHID;
-  uint8_t  bCountryCode;
-  uint8_t  bNumDescriptors;
-  /* Array of one or more descriptors */
-#if defined     (  __CC_ARM  )
-  __packed struct _HID_DESCRIPTOR_LIST {
-#elif defined   (  __GNUC__  )
-  struct __packed _HID_DESCRIPTOR_LIST {
-#elif defined   (  __IAR_SYSTEMS_ICC__  )
-#pragma pack(1)
-  struct _HID_DESCRIPTOR_LIST {
-#endif
-    uint8_t  bDescriptorType;
-    uint16_t  wDescriptorLength;
-  } DescriptorList[1];
-#ifdef __IAR_SYSTEMS_ICC__
-#pragma pack()
-#endif
-} HID_DESCRIPTOR;
-#ifdef __IAR_SYSTEMS_ICC__
-#pragma pack()
-#endif
-
 /* HID Request Codes */
 #define HID_REQUEST_GET_REPORT          0x01
 #define HID_REQUEST_GET_IDLE            0x02
@@ -87,6 +76,10 @@ typedef struct _HID_DESCRIPTOR {
 #define HID_REPORT_OUTPUT               0x02
 #define HID_REPORT_FEATURE              0x03
 
+/* HID Protocols (GET_PROTOCOL/SET_PROTOCOL) */
+#define HID_PROTOCOL_BOOT               0x00
+#define HID_PROTOCOL_REPORT             0x01
+
 
 /* Usage Pages */
 #define HID_USAGE_PAGE_UNDEFINED        0x00
@@ -376,5 +369,178 @@ typedef struct _HID_DESCRIPTOR {
 #define HID_UsageMin(x)        0x19,x
 #define HID_UsageMax(x)        0x29,x
 
+/** Max number of reports with their own idle rate */
+#define HID_REPORT_NUM_MAX              4
+
+/** Max report size of the report queue: max packet size of a full speed
+ * interrupt endpoint, one packet per frame (64KB/s per direction) */
+#define HID_QUEUE_REPORT_MAX            64
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup USBDEV_HID_Public_Types USBDEV_HID Public Types
+ * @{
+ */
+
+/* HID Descriptor */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _HID_DESCRIPTOR {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _HID_DESCRIPTOR {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+typedef struct _HID_DESCRIPTOR {
+#endif
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint16_t  bcdHID;
+  uint8_t  bCountryCode;
+  uint8_t  bNumDescriptors;
+  /* Array of one or more descriptors */
+#if defined     (  __CC_ARM  )
+  __packed struct _HID_DESCRIPTOR_LIST {
+#elif defined   (  __GNUC__  )
+  struct __packed _HID_DESCRIPTOR_LIST {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+#pragma pack(1)
+  struct _HID_DESCRIPTOR_LIST {
+#endif
+    uint8_t  bDescriptorType;
+    uint16_t  wDescriptorLength;
+  } DescriptorList[1];
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+} HID_DESCRIPTOR;
+#ifdef __IAR_SYSTEMS_ICC__
+#pragma pack()
+#endif
+
+/**
+ * @brief Report queue of the HID class driver (only with _USB_DMA): the
+ * interrupt endpoints carry reports of ReportSize bytes, their max packet
+ * size, served by USB DMA in place from and into two rings of report
+ * slots, no report is copied by the CPU.
+ *
+ * Device to host: the application takes a free slot of InBuf with
+ * USB_HidInSlot(), fills it and posts it with USB_HidInPost(). At the end
+ * of each IN transfer and on each SOF, the posted reports contiguous in
+ * InBuf (half of InBuf at most) are sent in one DMA transfer of one packet
+ * per report: the endpoint is reloaded by the DMA engine as soon as the
+ * host has read a report, every poll of the host (each frame with
+ * bInterval 1) carries a report while the queue is not empty.
+ * Host to device: EP_OUT is armed with a DMA transfer of one report into
+ * the next free slot of OutBuf, so that each report is available as soon
+ * as it is received; USB_HidOutReport() returns the oldest one, freed by
+ * USB_HidOutRelease(), a shorter report is completed with zeros. When
+ * OutBuf is full EP_OUT is left unarmed: the device NAKs the host until a
+ * report is released.
+ *
+ * Slot indexes run freely, the rings hold a power of 2 of slots. The
+ * application fills the configuration fields, the other fields are for
+ * driver use.
+ */
+typedef struct {
+	uint16_t ReportSize;		/**< Configuration: bytes per report, wMaxPacketSize
+								 of EP_IN and EP_OUT, HID_QUEUE_REPORT_MAX at most */
+	uint16_t InSlots;			/**< Configuration: slots of InBuf, a power of 2,
+								 at least 2 */
+	uint16_t OutSlots;			/**< Configuration: slots of OutBuf, a power of 2,
+								 at least 2 (not used without EP_OUT) */
+	uint16_t Reserved;
+	uint8_t *InBuf;				/**< Configuration: InSlots * ReportSize bytes in
+								 AHB SRAM, e.g. from DMA_BUF_ADR */
+	uint8_t *OutBuf;			/**< Configuration: OutSlots * ReportSize bytes in
+								 AHB SRAM, NULL without EP_OUT */
+	__IO uint32_t inhead;		/**< Reports posted by the application */
+	__IO uint32_t intail;		/**< Reports sent, or dropped by a reset */
+	__IO uint32_t inlen;		/**< Reports of the IN transfer in flight, 0 if none */
+	__IO uint32_t outhead;		/**< Reports received */
+	__IO uint32_t outtail;		/**< Reports released by the application */
+	__IO uint32_t outlen;		/**< Bytes of the armed OUT transfer, 0 if none */
+	__IO uint8_t running;		/**< Started by the configuration of the device */
+	uint8_t Reserved2[3];
+	uint32_t InCount;			/**< Statistics: reports sent to the host */
+	uint32_t OutCount;			/**< Statistics: reports received from the host */
+	uint32_t InIdle;			/**< Statistics: frames (ms) with no report to send */
+	uint32_t OutHolds;			/**< Statistics: frames (ms) with EP_OUT NAKing,
+								 OutBuf full */
+	uint32_t Errors;			/**< Statistics: USB DMA errors */
+} USBDEV_HID_QUEUE_Type;
+
+/**
+ * @brief HID class driver instance. The application fills the
+ * configuration fields before USB_HidInit().
+ */
+typedef struct _USBDEV_HID_Type {
+	uint8_t IF;						/**< Configuration: interface */
+	uint8_t EP_IN;					/**< Configuration: interrupt IN endpoint */
+	uint8_t EP_OUT;					/**< Configuration: interrupt OUT endpoint,
+									 0 if none */
+	uint8_t NumReports;				/**< Configuration: number of report IDs (1 if
+									 reports have no ID), HID_REPORT_NUM_MAX at most */
+	const uint8_t *HidDescriptor;	/**< Configuration: HID descriptor, within the
+									 configuration descriptor */
+	const uint8_t *ReportDescriptor;	/**< Configuration: report descriptor */
+	uint32_t ReportDescSize;		/**< Configuration: report descriptor size */
+	uint32_t (*GetReport)(struct _USBDEV_HID_Type *hid, uint8_t type, uint8_t id,
+						uint8_t *buf, uint32_t *len);	/**< Configuration: GET_REPORT
+									 request, type HID_REPORT_xxx. Store the report in
+									 buf (*len bytes at most) and its size in *len.
+									 Return FALSE to stall. May be NULL */
+	uint32_t (*SetReport)(struct _USBDEV_HID_Type *hid, uint8_t type, uint8_t id,
+						uint8_t *buf, uint32_t len);	/**< Configuration: SET_REPORT
+									 request. Return FALSE to stall. May be NULL */
+	void (*InReady)(struct _USBDEV_HID_Type *hid);	/**< Configuration: EP_IN is
+									 empty (device configured or last report read by
+									 the host), write the next report with
+									 USB_WriteEP(). May be NULL */
+	void (*OutReport)(struct _USBDEV_HID_Type *hid);	/**< Configuration: a report
+									 was received on EP_OUT, read it with USB_ReadEP() */
+	USBDEV_HID_QUEUE_Type *Queue;	/**< Configuration: NULL, or report queue
+									 serving the interrupt endpoints (only with
+									 _USB_DMA, EP_IN and EP_OUT in DMAEndpoints).
+									 InReady and OutReport are then not used */
+	uint8_t Protocol;				/**< Current protocol, HID_PROTOCOL_BOOT or HID_PROTOCOL_REPORT */
+	uint8_t IdleTime[HID_REPORT_NUM_MAX];	/**< Idle rate of each report (4ms units) */
+	uint8_t Reserved[3];
+	USBDEV_CLASS_Type cls;			/**< Private: class driver registered */
+} USBDEV_HID_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup USBDEV_HID_Public_Functions USBDEV_HID Public Functions
+ * @{
+ */
+
+void USB_HidInit(USBDEV_HID_Type *hid);
+uint8_t *USB_HidInSlot(USBDEV_HID_Type *hid);
+Status USB_HidInPost(USBDEV_HID_Type *hid);
+uint8_t *USB_HidOutReport(USBDEV_HID_Type *hid);
+void USB_HidOutRelease(USBDEV_HID_Type *hid);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_USBDEV_HID_H_ */
+
+/**
+ * @}
+ */
 
-#endif  /* __HID_H__ */
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,243 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_msc.h			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_msc.h
+* @brief	Contains all macro definitions and function prototypes
+* 			support for the USB MSC (mass storage class, bulk-only
+* 			transport, SCSI transparent command set) class driver on
+* 			LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup USBDEV_MSC USBDEV_MSC
+ * @ingroup USBDEV
+ * @{
+ */
+
+#ifndef LPC17XX_USBDEV_MSC_H_
+#define LPC17XX_USBDEV_MSC_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev.h"
+#include "lpc17xx_blkdev.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup USBDEV_MSC_Public_Macros USBDEV_MSC Public Macros
+ * @{
+ */
+
+/* MSC Subclass Codes */
+#define MSC_SUBCLASS_RBC                0x01
+#define MSC_SUBCLASS_SFF8020I_MMC2      0x02
+#define MSC_SUBCLASS_QIC157             0x03
+#define MSC_SUBCLASS_UFI                0x04
+#define MSC_SUBCLASS_SFF8070I           0x05
+#define MSC_SUBCLASS_SCSI               0x06
+
+/* MSC Protocol Codes */
+#define MSC_PROTOCOL_CBI_INT            0x00
+#define MSC_PROTOCOL_CBI_NOINT          0x01
+#define MSC_PROTOCOL_BULK_ONLY          0x50
+
+/* MSC Request Codes */
+#define MSC_REQUEST_RESET               0xFF
+#define MSC_REQUEST_GET_MAX_LUN         0xFE
+
+/* MSC Bulk-only Stage */
+#define MSC_BS_CBW                      0       /* Command Block Wrapper */
+#define MSC_BS_DATA_OUT                 1       /* Data Out Phase */
+#define MSC_BS_DATA_IN                  2       /* Data In Phase */
+#define MSC_BS_DATA_IN_LAST             3       /* Data In Last Phase */
+#define MSC_BS_DATA_IN_LAST_STALL       4       /* Data In Last Phase with Stall */
+#define MSC_BS_CSW                      5       /* Command Status Wrapper */
+#define MSC_BS_ERROR                    6       /* Error */
+#define MSC_BS_DEV                      7       /* Wait for the block device */
+
+#define MSC_CBW_Signature               0x43425355
+#define MSC_CSW_Signature               0x53425355
+
+/* CSW Status Definitions */
+#define CSW_CMD_PASSED                  0x00
+#define CSW_CMD_FAILED                  0x01
+#define CSW_PHASE_ERROR                 0x02
+
+/* SCSI Commands */
+#define SCSI_TEST_UNIT_READY            0x00
+#define SCSI_REQUEST_SENSE              0x03
+#define SCSI_FORMAT_UNIT                0x04
+#define SCSI_INQUIRY                    0x12
+#define SCSI_MODE_SELECT6               0x15
+#define SCSI_MODE_SENSE6                0x1A
+#define SCSI_START_STOP_UNIT            0x1B
+#define SCSI_MEDIA_REMOVAL              0x1E
+#define SCSI_READ_FORMAT_CAPACITIES     0x23
+#define SCSI_READ_CAPACITY              0x25
+#define SCSI_READ10                     0x28
+#define SCSI_WRITE10                    0x2A
+#define SCSI_VERIFY10                   0x2F
+#define SCSI_SYNCHRONIZE_CACHE10        0x35
+#define SCSI_MODE_SELECT10              0x55
+#define SCSI_MODE_SENSE10               0x5A
+
+/** Max packet size of the bulk endpoints */
+#define MSC_MAX_PACKET                  64
+/** Size of the vendor, product and revision fields of INQUIRY data */
+#define MSC_INQUIRY_ID_SIZE             28
+/** Room at the end of DMABuf where the CBW is received by DMA */
+#define MSC_DMA_CBW_SIZE                32
+
+/**
+ * @}
+ */
+
+
+/* Public Types --------------------------------------------------------------- */
+/** @defgroup USBDEV_MSC_Public_Types USBDEV_MSC Public Types
+ * @{
+ */
+
+/** Bulk-only Command Block Wrapper */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _MSC_CBW {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _MSC_CBW {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+typedef __packed struct _MSC_CBW {
+#endif
+  uint32_t dSignature;
+  uint32_t dTag;
+  uint32_t dDataLength;
+  uint8_t  bmFlags;
+  uint8_t  bLUN;
+  uint8_t  bCBLength;
+  uint8_t  CB[16];
+} MSC_CBW;
+
+/** Bulk-only Command Status Wrapper */
+#if defined     (  __CC_ARM  )
+typedef __packed struct _MSC_CSW {
+#elif defined   (  __GNUC__  )
+typedef struct __packed _MSC_CSW {
+#elif defined   (  __IAR_SYSTEMS_ICC__  )
+typedef __packed struct _MSC_CSW {
+#endif
+  uint32_t dSignature;
+  uint32_t dTag;
+  uint32_t dDataResidue;
+  uint8_t  bStatus;
+} MSC_CSW;
+
+/**
+ * @brief MSC class driver instance, one logical unit. The application
+ * fills the configuration fields before USB_MscInit().
+ *
+ * With DMABuf set (only with _USB_DMA), both bulk endpoints must be in
+ * USBDEV_CFG_Type.DMAEndpoints: CBW, data and CSW are all moved by the
+ * USB DMA engine, READ10/WRITE10 data by whole multiples of BlockSize
+ * per descriptor, i.e. one interrupt per chunk instead of per packet.
+ * In DMA mode the medium may also be a block device (Dev): each chunk is
+ * then read into or written from DMABuf by the asynchronous block device
+ * requests, and the transport waits for their completion callback.
+ */
+typedef struct _USBDEV_MSC_Type {
+	uint8_t IF;						/**< Configuration: interface */
+	uint8_t EP_IN;					/**< Configuration: bulk IN endpoint */
+	uint8_t EP_OUT;					/**< Configuration: bulk OUT endpoint */
+	uint8_t DevStage;				/**< Private: bulk stage resumed when Dev is done */
+	uint32_t BlockSize;				/**< Configuration: block size (bytes) */
+	uint32_t BlockCount;			/**< Configuration: number of blocks */
+	const uint8_t *InquiryID;		/**< Configuration: vendor (8), product (16) and
+									 revision (4) of INQUIRY data, space padded.
+									 NULL for default */
+	uint32_t (*Read)(struct _USBDEV_MSC_Type *msc, uint32_t offset, uint8_t *buf, uint32_t len);
+									/**< Configuration: read len bytes (MSC_MAX_PACKET
+									 at most, a DMA chunk with DMABuf) at byte offset
+									 of the medium. Return FALSE on error */
+	uint32_t (*Write)(struct _USBDEV_MSC_Type *msc, uint32_t offset, uint8_t *buf, uint32_t len);
+									/**< Configuration: write len bytes (MSC_MAX_PACKET
+									 at most, a DMA chunk with DMABuf) at byte offset
+									 of the medium. Return FALSE on error */
+	uint8_t *DMABuf;				/**< Configuration: NULL for slave mode, otherwise
+									 DMABufSize bytes the USB DMA can reach (AHB
+									 SRAM, e.g. from DMA_BUF_ADR). Used only with
+									 _USB_DMA */
+	uint32_t DMABufSize;			/**< Configuration: size of DMABuf, at least
+									 BlockSize + MSC_DMA_CBW_SIZE */
+	uint8_t *(*Map)(struct _USBDEV_MSC_Type *msc, uint32_t offset, uint32_t len);
+									/**< Configuration: with DMABuf, NULL or address
+									 of len bytes at byte offset of the medium if the
+									 whole medium is reachable by the USB DMA: data
+									 is then moved straight from/to the medium,
+									 Read/Write are used for VERIFY10 only */
+	BLKDEV_Type *Dev;				/**< Configuration: with DMABuf, NULL or block
+									 device of the medium (BlockSize and BlockCount
+									 are taken from it, Read/Write/Map are unused).
+									 SYNCHRONIZE CACHE(10) calls its Sync(). Its
+									 Done/arg are set by USB_MscInit() */
+	MSC_CBW CBW;					/**< Private: Command Block Wrapper */
+	MSC_CSW CSW;					/**< Private: Command Status Wrapper */
+	uint32_t Offset;				/**< Private: R/W Offset */
+	uint32_t Length;				/**< Private: R/W Length */
+	uint8_t BulkStage;				/**< Private: Bulk Stage, MSC_BS_xxx */
+	uint8_t BulkLen;				/**< Private: Bulk In/Out Length */
+	uint8_t MemOK;					/**< Private: Verify/Read/Write OK */
+	uint8_t DMAMapped;				/**< Private: DMA data moved through Map() */
+	uint32_t DMALen;				/**< Private: length of the DMA data chunk */
+	uint32_t LBA;					/**< Private: next block of the data stage */
+	uint32_t BulkBuf[MSC_MAX_PACKET / 4];	/**< Private: Bulk In/Out Buffer */
+	USBDEV_CLASS_Type cls;			/**< Private: class driver registered */
+} USBDEV_MSC_Type;
+
+/**
+ * @}
+ */
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup USBDEV_MSC_Public_Functions USBDEV_MSC Public Functions
+ * @{
+ */
+
+void USB_MscInit(USBDEV_MSC_Type *msc);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LPC17XX_USBDEV_MSC_H_ */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -31,6 +31,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "lpc17xx_adc.h"
 #include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
 
 /* If this source file built with example, the LPC17xx FW library configuration
  * file in each example directory ("lpc17xx_libcfg.h") must be included,
@@ -332,6 +333,221 @@ FlagStatus	ADC_GlobalGetStatus(LPC_ADC_TypeDef *ADCx, uint32_t StatusType)
 	}
 }
 
+#ifdef _GPDMA
+/*********************************************************************//**
+ * @brief 		Initialize ADC acquisition engine: select channels, build
+ * 				a circular GPDMA LLI chain over the blocks of the buffer and
+ * 				setup the GPDMA channel. ADC must be initialized before by
+ * 				ADC_Init() with the aggregate conversion rate (<= 200KHz).
+ * 				ADC interrupt must stay disabled in NVIC: the channels are
+ * 				enabled in ADINTEN only to generate DMA requests.
+ * @param[in]	ADCx pointer to LPC_ADC_TypeDef, should be: LPC_ADC
+ * @param[in]	acq	point to ADC_ACQ_Type structure, configuration fields
+ * 				must be filled
+ * @return 		ERROR if GPDMA channel is enabled, otherwise SUCCESS
+ **********************************************************************/
+Status ADC_AcqInit(LPC_ADC_TypeDef *ADCx, ADC_ACQ_Type *acq)
+{
+	GPDMA_Channel_CFG_Type GPDMACfg;
+	uint32_t i, next;
+
+	CHECK_PARAM(PARAM_ADCx(ADCx));
+	CHECK_PARAM(acq->ChannelMask != 0);
+	CHECK_PARAM((acq->StartMode == ADC_START_CONTINUOUS) \
+			|| ((acq->ChannelMask & (acq->ChannelMask - 1)) == 0));
+	CHECK_PARAM((acq->BlockSize > 0) && (acq->BlockSize <= 0xFFF));
+	CHECK_PARAM(acq->NumBlocks >= 2);
+
+	/* One LLI per block, last one links back to the first one, each block
+	 * generates a terminal count interrupt */
+	for (i = 0; i < acq->NumBlocks; i++) {
+		next = ((i + 1) == acq->NumBlocks) ? 0 : (i + 1);
+		acq->lli[i].SrcAddr = (uint32_t) &ADCx->ADGDR;
+		acq->lli[i].DstAddr = (uint32_t) (acq->buf + (i * acq->BlockSize));
+		acq->lli[i].NextLLI = (uint32_t) &acq->lli[next];
+		acq->lli[i].Control = GPDMA_DMACCxControl_TransferSize((uint32_t)acq->BlockSize) \
+						| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) \
+						| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) \
+						| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) \
+						| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) \
+						| GPDMA_DMACCxControl_DI \
+						| GPDMA_DMACCxControl_I;
+	}
+	acq->head = 0;
+	acq->tail = 0;
+	acq->overrun = 0;
+	acq->hw_overrun = 0;
+	acq->flags = 0;
+	acq->error = 0;
+
+	/* Stop conversions, select channels. Each conversion of a channel
+	 * enabled in ADINTEN requests one DMA transfer from ADGDR */
+	ADCx->ADCR &= ~(ADC_CR_BURST | ADC_CR_START_MASK | 0xFF);
+	ADCx->ADCR |= acq->ChannelMask;
+	ADCx->ADINTEN = acq->ChannelMask;
+
+	GPDMACfg.ChannelNum = acq->DMAChannel;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	GPDMACfg.SrcConn = GPDMA_CONN_ADC;
+	GPDMACfg.DstConn = 0;
+	GPDMACfg.DMALLI = (uint32_t) &acq->lli[0];
+	return GPDMA_SetupLLI(&GPDMACfg);
+}
+
+/*********************************************************************//**
+ * @brief 		Start ADC acquisition: enable GPDMA channel, then start
+ * 				burst mode or arm the selected start edge
+ * @param[in]	ADCx pointer to LPC_ADC_TypeDef, should be: LPC_ADC
+ * @param[in]	acq	point to ADC_ACQ_Type structure
+ * @return 		None
+ **********************************************************************/
+void ADC_AcqStart(LPC_ADC_TypeDef *ADCx, ADC_ACQ_Type *acq)
+{
+	CHECK_PARAM(PARAM_ADCx(ADCx));
+
+	acq->error = 0;
+	GPDMA_ChannelCmd(acq->DMAChannel, ENABLE);
+	if (acq->StartMode == ADC_START_CONTINUOUS) {
+		ADC_BurstCmd(ADCx, ENABLE);
+	} else {
+		ADC_EdgeStartConfig(ADCx, acq->EdgeOption);
+		ADC_StartCmd(ADCx, acq->StartMode);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Stop ADC acquisition. Blocks already completed can still
+ * 				be read, ADC_AcqStart() resumes in the current block.
+ * @param[in]	ADCx pointer to LPC_ADC_TypeDef, should be: LPC_ADC
+ * @param[in]	acq	point to ADC_ACQ_Type structure
+ * @return 		None
+ **********************************************************************/
+void ADC_AcqStop(LPC_ADC_TypeDef *ADCx, ADC_ACQ_Type *acq)
+{
+	CHECK_PARAM(PARAM_ADCx(ADCx));
+
+	ADC_BurstCmd(ADCx, DISABLE);
+	ADC_StartCmd(ADCx, ADC_START_CONTINUOUS);
+	GPDMA_ChannelCmd(acq->DMAChannel, DISABLE);
+}
+
+/*********************************************************************//**
+ * @brief 		ADC acquisition GPDMA interrupt handler, should be called
+ * 				from DMA_IRQHandler(). A block must last longer than the
+ * 				worst DMA interrupt latency, otherwise completed blocks
+ * 				are not counted.
+ * @param[in]	acq	point to ADC_ACQ_Type structure
+ * @return 		None
+ **********************************************************************/
+void ADC_AcqDMAHandler(ADC_ACQ_Type *acq)
+{
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, acq->DMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, acq->DMAChannel);
+		acq->head++;
+	}
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, acq->DMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, acq->DMAChannel);
+		acq->error++;
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Get ADC acquisition status. ADC_ACQ_OVERRUN and
+ * 				ADC_ACQ_HW_OVERRUN are cleared after read, ADC_ACQ_ERROR
+ * 				stays set until ADC_AcqStart()
+ * @param[in]	acq	point to ADC_ACQ_Type structure
+ * @return 		Status flags, an OR of:
+ * 				- ADC_ACQ_DONE: at least one block is ready
+ * 				- ADC_ACQ_OVERRUN: blocks were lost, reader too slow
+ * 				- ADC_ACQ_HW_OVERRUN: conversions were lost in ADC
+ * 				- ADC_ACQ_ERROR: GPDMA error
+ **********************************************************************/
+uint32_t ADC_AcqGetStatus(ADC_ACQ_Type *acq)
+{
+	uint32_t status;
+
+	status = acq->flags;
+	acq->flags = 0;
+	if (acq->head != acq->tail) {
+		status |= ADC_ACQ_DONE;
+	}
+	if ((acq->head - acq->tail) > (uint32_t)(acq->NumBlocks - 1)) {
+		status |= ADC_ACQ_OVERRUN;
+	}
+	if (acq->error) {
+		status |= ADC_ACQ_ERROR;
+	}
+	return status;
+}
+
+/*********************************************************************//**
+ * @brief 		Read the oldest completed block and split it per channel
+ * 				into q15 samples (see ADC_ACQ_Q15()). Words without DONE
+ * 				bit (stale ADGDR reads) are skipped. If the reader lags by
+ * 				a whole buffer, the oldest blocks are dropped.
+ * @param[in]	acq	point to ADC_ACQ_Type structure
+ * @param[in]	dst	array of 8 destination pointers indexed by channel
+ * 				number, NULL for a channel that is not wanted
+ * @param[in]	len	size of each destination array (samples); samples
+ * 				beyond len are dropped. BlockSize covers any channel set.
+ * @param[out]	num	array of 8, number of samples written per channel
+ * @return 		Number of samples written, 0 if no block is ready or if
+ * 				the block was overwritten while being read
+ **********************************************************************/
+uint32_t ADC_AcqRead(ADC_ACQ_Type *acq, int16_t *dst[8], uint32_t len, uint32_t num[8])
+{
+	uint32_t head, t, i, w, ch, total;
+	uint32_t *p;
+
+	for (ch = 0; ch < 8; ch++) {
+		num[ch] = 0;
+	}
+
+	head = acq->head;
+	if ((head - acq->tail) > (uint32_t)(acq->NumBlocks - 1)) {
+		// Reader is too slow, oldest blocks were overwritten
+		acq->overrun += (head - acq->tail) - (acq->NumBlocks - 1);
+		acq->flags |= ADC_ACQ_OVERRUN;
+		acq->tail = head - (acq->NumBlocks - 1);
+	}
+	if (head == acq->tail) {
+		return 0;
+	}
+
+	t = acq->tail;
+	p = acq->buf + ((t % acq->NumBlocks) * acq->BlockSize);
+	total = 0;
+	for (i = 0; i < acq->BlockSize; i++) {
+		w = p[i];
+		if (!(w & ADC_GDR_DONE_FLAG)) {
+			continue;
+		}
+		ch = ADC_GDR_CH(w);
+		if ((dst[ch] == NULL) || (num[ch] >= len)) {
+			continue;
+		}
+		if (w & ADC_GDR_OVERRUN_FLAG) {
+			acq->hw_overrun++;
+			acq->flags |= ADC_ACQ_HW_OVERRUN;
+		}
+		dst[ch][num[ch]++] = ADC_ACQ_Q15(ADC_GDR_RESULT(w));
+		total++;
+	}
+	acq->tail = t + 1;
+
+	// GPDMA came back to this block while it was being read
+	if ((acq->head - t) > (uint32_t)(acq->NumBlocks - 1)) {
+		acq->overrun++;
+		acq->flags |= ADC_ACQ_OVERRUN;
+		for (ch = 0; ch < 8; ch++) {
+			num[ch] = 0;
+		}
+		return 0;
+	}
+	return total;
+}
+#endif /* _GPDMA */
+
 /**
  * @}
  */
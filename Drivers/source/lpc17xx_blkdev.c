@@ -0,0 +1,787 @@
+/**********************************************************************
+* $Id$		lpc17xx_blkdev.c				2011-03-09
+*//**
+* @file		lpc17xx_blkdev.c
+* @brief	Contains the block device synchronous helpers and the sector
+* 			cache (read-ahead, write-back coalescing) for LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup BLKDEV
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_blkdev.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _BLKDEV
+
+/* Private Macros ------------------------------------------------------------- */
+/** Request and lower device operations */
+#define BLK_OP_NONE		0
+#define BLK_OP_READ		1
+#define BLK_OP_WRITE	2
+#define BLK_OP_SYNC		3
+
+/** Bits 0 to n - 1 */
+#define BLK_MASK(n)		(((n) >= 32) ? 0xFFFFFFFF : ((1UL << (n)) - 1))
+
+
+/* Private Types -------------------------------------------------------------- */
+/** Completion of a synchronous request */
+typedef struct {
+	__IO uint8_t done;
+	uint8_t Reserved[3];
+	Status status;
+} BLK_WAIT_Type;
+
+
+/* Private Functions ---------------------------------------------------------- */
+static void blk_WaitDone(void *arg, Status status);
+static Status blk_Wait(BLKDEV_Type *dev, uint32_t op, uint32_t lba, uint8_t *buf, uint32_t n);
+static void blk_Copy(uint8_t *dst, const uint8_t *src, uint32_t len);
+static uint32_t cache_FirstRun(uint32_t mask, uint32_t *first);
+static uint32_t cache_Span(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line);
+static uint8_t *cache_Data(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line, uint32_t blk);
+static BLK_CACHE_LINE_Type *cache_Find(BLK_CACHE_Type *cache, uint32_t tag);
+static BLK_CACHE_LINE_Type *cache_FindDirty(BLK_CACHE_Type *cache, Bool full);
+static BLK_CACHE_LINE_Type *cache_Victim(BLK_CACHE_Type *cache, Bool clean);
+static uint32_t cache_FillMask(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line, uint32_t mask);
+static void cache_StartIO(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line, uint32_t op, uint32_t mask);
+static void cache_IODone(BLK_CACHE_Type *cache, Status status);
+static void cache_LowerDone(void *arg, Status status);
+static void cache_Finish(BLK_CACHE_Type *cache);
+static Bool cache_Step(BLK_CACHE_Type *cache);
+static Bool cache_Background(BLK_CACHE_Type *cache);
+static void cache_Process(BLK_CACHE_Type *cache);
+static Status cache_Start(BLK_CACHE_Type *cache, uint32_t op, uint32_t lba, uint8_t *buf, uint32_t n);
+static Status cache_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n);
+static Status cache_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n);
+static Status cache_Sync(BLKDEV_Type *dev);
+static void cache_Poll(BLKDEV_Type *dev);
+
+/*********************************************************************//**
+ * @brief		Completion callback of the synchronous helpers
+ * @param[in]	arg		point to BLK_WAIT_Type structure
+ * @param[in]	status	Request status
+ * @return 		None
+ **********************************************************************/
+static void blk_WaitDone(void *arg, Status status)
+{
+	BLK_WAIT_Type *wait = (BLK_WAIT_Type *)arg;
+
+	wait->status = status;
+	wait->done = TRUE;
+}
+
+/*********************************************************************//**
+ * @brief		Start a request with blk_WaitDone() as completion callback,
+ * 				then poll the device until it is done. The user callback
+ * 				is restored afterwards.
+ * @param[in]	dev		Block device, not busy
+ * @param[in]	op		BLK_OP_READ, BLK_OP_WRITE or BLK_OP_SYNC
+ * @param[in]	lba		First block
+ * @param[in]	buf		Data buffer
+ * @param[in]	n		Number of blocks
+ * @return 		Request status
+ **********************************************************************/
+static Status blk_Wait(BLKDEV_Type *dev, uint32_t op, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	BLK_WAIT_Type wait;
+	BLKDEV_DONE done;
+	void *arg;
+	Status ret;
+
+	if (dev->Busy) {
+		return ERROR;
+	}
+	if ((op == BLK_OP_SYNC) && (dev->Sync == NULL)) {
+		return SUCCESS;
+	}
+
+	done = dev->Done;
+	arg = dev->arg;
+	wait.done = FALSE;
+	wait.status = ERROR;
+	dev->Done = blk_WaitDone;
+	dev->arg = &wait;
+
+	if (op == BLK_OP_READ) {
+		ret = dev->Read(dev, lba, buf, n);
+	} else if (op == BLK_OP_WRITE) {
+		ret = dev->Write(dev, lba, buf, n);
+	} else {
+		ret = dev->Sync(dev);
+	}
+	if (ret == SUCCESS) {
+		while (!wait.done) {
+			BLK_Poll(dev);
+		}
+		ret = wait.status;
+	}
+
+	dev->Done = done;
+	dev->arg = arg;
+	return ret;
+}
+
+/*********************************************************************//**
+ * @brief		Copy len bytes, by words when both buffers and len allow it
+ * @param[in]	dst		Destination
+ * @param[in]	src		Source
+ * @param[in]	len		Number of bytes
+ * @return 		None
+ **********************************************************************/
+static void blk_Copy(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+	uint32_t *wdst;
+	const uint32_t *wsrc;
+
+	if ((((uint32_t)dst | (uint32_t)src | len) & 3) == 0) {
+		wdst = (uint32_t *)dst;
+		wsrc = (const uint32_t *)src;
+		for (len >>= 2; len != 0; len--) {
+			*wdst++ = *wsrc++;
+		}
+	} else {
+		for (; len != 0; len--) {
+			*dst++ = *src++;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Find the first run of consecutive set bits
+ * @param[in]	mask	Bit mask, not 0
+ * @param[out]	first	First bit of the run
+ * @return 		Number of bits in the run
+ **********************************************************************/
+static uint32_t cache_FirstRun(uint32_t mask, uint32_t *first)
+{
+	uint32_t i, n;
+
+	for (i = 0; !(mask & (1UL << i)); i++);
+	for (n = 0; ((i + n) < 32) && (mask & (1UL << (i + n))); n++);
+	*first = i;
+	return n;
+}
+
+/*********************************************************************//**
+ * @brief		Number of blocks of a line inside the device (the last
+ * 				line may be clipped)
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	line	Cache line with a tag
+ * @return 		Number of blocks
+ **********************************************************************/
+static uint32_t cache_Span(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line)
+{
+	uint32_t left = cache->dev.BlockCount - line->Tag;
+
+	return (left < cache->LineBlocks) ? left : cache->LineBlocks;
+}
+
+/*********************************************************************//**
+ * @brief		Address of a block of a cache line
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	line	Cache line
+ * @param[in]	blk		Block in the line
+ * @return 		Block data
+ **********************************************************************/
+static uint8_t *cache_Data(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line, uint32_t blk)
+{
+	return cache->Buf + ((((uint32_t)(line - cache->line) * cache->LineBlocks) + blk)
+			* cache->dev.BlockSize);
+}
+
+/*********************************************************************//**
+ * @brief		Look up a cache line
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	tag		First block of the line
+ * @return 		Cache line, NULL if not cached
+ **********************************************************************/
+static BLK_CACHE_LINE_Type *cache_Find(BLK_CACHE_Type *cache, uint32_t tag)
+{
+	uint32_t i;
+
+	for (i = 0; i < cache->NumLines; i++) {
+		if (cache->line[i].Tag == tag) {
+			return &cache->line[i];
+		}
+	}
+	return NULL;
+}
+
+/*********************************************************************//**
+ * @brief		Find a line to write back
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	full	TRUE: only a line with all its blocks dirty
+ * @return 		Cache line, NULL if none
+ **********************************************************************/
+static BLK_CACHE_LINE_Type *cache_FindDirty(BLK_CACHE_Type *cache, Bool full)
+{
+	BLK_CACHE_LINE_Type *line;
+	uint32_t i;
+
+	for (i = 0; i < cache->NumLines; i++) {
+		line = &cache->line[i];
+		if (line->Dirty == 0) {
+			continue;
+		}
+		if (!full || (line->Dirty == BLK_MASK(cache_Span(cache, line)))) {
+			return line;
+		}
+	}
+	return NULL;
+}
+
+/*********************************************************************//**
+ * @brief		Choose a line to replace: a free line, else the least
+ * 				recently used clean line, else the least recently used
+ * 				dirty line
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	clean	TRUE for read-ahead: only a clean line not used
+ * 						since the last request
+ * @return 		Cache line, NULL if none
+ **********************************************************************/
+static BLK_CACHE_LINE_Type *cache_Victim(BLK_CACHE_Type *cache, Bool clean)
+{
+	BLK_CACHE_LINE_Type *line, *best = NULL;
+	uint32_t i;
+
+	for (i = 0; i < cache->NumLines; i++) {
+		line = &cache->line[i];
+		if (line->Tag == BLK_CACHE_NO_TAG) {
+			return line;
+		}
+		if (clean && ((line->Dirty != 0) || (line->Used == cache->clock))) {
+			continue;
+		}
+		if ((best == NULL)
+				|| ((best->Dirty != 0) && (line->Dirty == 0))
+				|| (((best->Dirty == 0) == (line->Dirty == 0))
+					&& ((int32_t)(line->Used - best->Used) < 0))) {
+			best = line;
+		}
+	}
+	return best;
+}
+
+/*********************************************************************//**
+ * @brief		Blocks to fill: the first run of missing blocks in mask,
+ * 				extended with the following missing blocks up to the end
+ * 				of the line, so that sequential reads fill whole lines
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	line	Cache line
+ * @param[in]	mask	Blocks wanted, at least one missing
+ * @return 		Blocks to read from the lower device
+ **********************************************************************/
+static uint32_t cache_FillMask(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line, uint32_t mask)
+{
+	uint32_t missing, span, first, n;
+
+	span = cache_Span(cache, line);
+	missing = ~line->Valid & BLK_MASK(span);
+	n = cache_FirstRun(mask & missing, &first);
+	while (((first + n) < span) && (missing & (1UL << (first + n)))) {
+		n++;
+	}
+	return BLK_MASK(n) << first;
+}
+
+/*********************************************************************//**
+ * @brief		Start a lower device operation on the first run of
+ * 				blocks of mask: one multi-block read or write
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	line	Cache line, NULL for BLK_OP_SYNC
+ * @param[in]	op		BLK_OP_READ, BLK_OP_WRITE or BLK_OP_SYNC
+ * @param[in]	mask	Blocks of the line, not 0 unless BLK_OP_SYNC
+ * @return 		None
+ **********************************************************************/
+static void cache_StartIO(BLK_CACHE_Type *cache, BLK_CACHE_LINE_Type *line, uint32_t op, uint32_t mask)
+{
+	BLKDEV_Type *lower = cache->Lower;
+	uint32_t first, n;
+	Status ret;
+
+	cache->io = line;
+	cache->ioop = op;
+	cache->ioreq = (cache->op != BLK_OP_NONE);
+
+	if (op == BLK_OP_SYNC) {
+		cache->iomask = 0;
+		ret = lower->Sync(lower);
+	} else {
+		n = cache_FirstRun(mask, &first);
+		cache->iomask = BLK_MASK(n) << first;
+		if (op == BLK_OP_READ) {
+			cache->fills++;
+			if (cache->ioreq) {
+				cache->miss = TRUE;
+			}
+			ret = lower->Read(lower, line->Tag + first, cache_Data(cache, line, first), n);
+		} else {
+			ret = lower->Write(lower, line->Tag + first, cache_Data(cache, line, first), n);
+		}
+	}
+	if (ret != SUCCESS) {
+		cache_IODone(cache, ERROR);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Account for the end of a lower device operation
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	status	Status of the operation
+ * @return 		None
+ **********************************************************************/
+static void cache_IODone(BLK_CACHE_Type *cache, Status status)
+{
+	BLK_CACHE_LINE_Type *line = cache->io;
+
+	if (status == SUCCESS) {
+		if (cache->ioop == BLK_OP_READ) {
+			line->Valid |= cache->iomask;
+		} else if (cache->ioop == BLK_OP_WRITE) {
+			line->Dirty &= ~cache->iomask;
+			cache->writebacks++;
+		}
+	} else if (cache->ioreq) {
+		cache->status = ERROR;
+	} else {
+		// Background work failed: stop it until the next request
+		cache->aheadn = 0;
+		cache->bgerr = TRUE;
+	}
+	cache->io = NULL;
+	cache->ioop = BLK_OP_NONE;
+}
+
+/*********************************************************************//**
+ * @brief		Completion callback of the lower device
+ * @param[in]	arg		point to BLK_CACHE_Type structure
+ * @param[in]	status	Status of the operation
+ * @return 		None
+ **********************************************************************/
+static void cache_LowerDone(void *arg, Status status)
+{
+	BLK_CACHE_Type *cache = (BLK_CACHE_Type *)arg;
+
+	cache_IODone(cache, status);
+	cache_Process(cache);
+}
+
+/*********************************************************************//**
+ * @brief		End the request and call the completion callback, which
+ * 				may start the next request
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cache_Finish(BLK_CACHE_Type *cache)
+{
+	if ((cache->op == BLK_OP_READ) && cache->miss) {
+		cache->misses++;
+	}
+	cache->op = BLK_OP_NONE;
+	cache->dev.Busy = FALSE;
+	if (cache->dev.Done != NULL) {
+		cache->dev.Done(cache->dev.arg, cache->status);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		One step of the request in progress: copy the part of
+ * 				the request inside one line, or start the lower device
+ * 				operation it waits for (write back the victim line, fill
+ * 				the missing blocks, write back for Sync)
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @return 		TRUE if the request made progress, FALSE if there is no
+ * 				request
+ **********************************************************************/
+static Bool cache_Step(BLK_CACHE_Type *cache)
+{
+	BLK_CACHE_LINE_Type *line;
+	uint32_t tag, off, cnt, mask, size;
+	uint8_t *data;
+
+	if (cache->op == BLK_OP_NONE) {
+		return FALSE;
+	}
+	if ((cache->status != SUCCESS)
+			|| ((cache->op != BLK_OP_SYNC) && (cache->n == 0))) {
+		cache_Finish(cache);
+		return TRUE;
+	}
+
+	if (cache->op == BLK_OP_SYNC) {
+		// n is set while the lower device Sync is still to be done
+		line = cache_FindDirty(cache, FALSE);
+		if (line != NULL) {
+			cache_StartIO(cache, line, BLK_OP_WRITE, line->Dirty);
+		} else if ((cache->n != 0) && (cache->Lower->Sync != NULL)) {
+			cache->n = 0;
+			cache_StartIO(cache, NULL, BLK_OP_SYNC, 0);
+		} else {
+			cache_Finish(cache);
+		}
+		return TRUE;
+	}
+
+	off = cache->lba % cache->LineBlocks;
+	tag = cache->lba - off;
+	cnt = cache->LineBlocks - off;
+	if (cnt > cache->n) {
+		cnt = cache->n;
+	}
+	mask = BLK_MASK(cnt) << off;
+
+	line = cache_Find(cache, tag);
+	if (line == NULL) {
+		line = cache_Victim(cache, FALSE);
+		if (line->Dirty != 0) {
+			cache_StartIO(cache, line, BLK_OP_WRITE, line->Dirty);
+			return TRUE;
+		}
+		line->Tag = tag;
+		line->Valid = 0;
+	}
+
+	data = cache_Data(cache, line, off);
+	size = cnt * cache->dev.BlockSize;
+	if (cache->op == BLK_OP_READ) {
+		if ((line->Valid & mask) != mask) {
+			cache_StartIO(cache, line, BLK_OP_READ, cache_FillMask(cache, line, mask));
+			return TRUE;
+		}
+		blk_Copy(cache->buf, data, size);
+	} else {
+		blk_Copy(data, cache->buf, size);
+		line->Valid |= mask;
+		line->Dirty |= mask;
+	}
+	line->Used = ++cache->clock;
+	cache->lba += cnt;
+	cache->buf += size;
+	cache->n -= cnt;
+	return TRUE;
+}
+
+/*********************************************************************//**
+ * @brief		Start background work when there is no request:
+ * 				write-behind of fully written lines, read-ahead, then
+ * 				write-back of all dirty lines once the cache is idle
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @return 		TRUE if some work was done, FALSE if there is none
+ **********************************************************************/
+static Bool cache_Background(BLK_CACHE_Type *cache)
+{
+	BLK_CACHE_LINE_Type *line;
+	uint32_t full;
+
+	if (!cache->bgerr) {
+		line = cache_FindDirty(cache, TRUE);
+		if (line != NULL) {
+			cache_StartIO(cache, line, BLK_OP_WRITE, line->Dirty);
+			return TRUE;
+		}
+	}
+
+	if (cache->aheadn != 0) {
+		if (cache->ahead >= cache->dev.BlockCount) {
+			cache->aheadn = 0;
+			return TRUE;
+		}
+		line = cache_Find(cache, cache->ahead);
+		if (line == NULL) {
+			// Never evict dirty lines or the lines of the last request
+			line = cache_Victim(cache, TRUE);
+			if (line == NULL) {
+				cache->aheadn = 0;
+				return TRUE;
+			}
+			line->Tag = cache->ahead;
+			line->Valid = 0;
+			line->Used = cache->clock;
+		}
+		full = BLK_MASK(cache_Span(cache, line));
+		if (line->Valid != full) {
+			cache_StartIO(cache, line, BLK_OP_READ, cache_FillMask(cache, line, full));
+		} else {
+			cache->ahead += cache->LineBlocks;
+			cache->aheadn--;
+		}
+		return TRUE;
+	}
+
+	if (!cache->bgerr && (cache->FlushDelay != 0) && (cache->idle >= cache->FlushDelay)) {
+		line = cache_FindDirty(cache, FALSE);
+		if (line != NULL) {
+			cache_StartIO(cache, line, BLK_OP_WRITE, line->Dirty);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*********************************************************************//**
+ * @brief		Run the cache until it waits for the lower device or has
+ * 				nothing to do. Lower device completions and requests from
+ * 				the completion callback during the run are picked up by
+ * 				the running loop.
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cache_Process(BLK_CACHE_Type *cache)
+{
+	if (cache->run) {
+		return;
+	}
+	cache->run = TRUE;
+	while (cache->ioop == BLK_OP_NONE) {
+		if (!cache_Step(cache) && !cache_Background(cache)) {
+			break;
+		}
+	}
+	cache->run = FALSE;
+}
+
+/*********************************************************************//**
+ * @brief		Accept a request and start processing it
+ * @param[in]	cache	point to BLK_CACHE_Type structure
+ * @param[in]	op		BLK_OP_READ, BLK_OP_WRITE or BLK_OP_SYNC
+ * @param[in]	lba		First block
+ * @param[in]	buf		Data buffer
+ * @param[in]	n		Number of blocks
+ * @return 		ERROR if busy or out of range, otherwise SUCCESS
+ **********************************************************************/
+static Status cache_Start(BLK_CACHE_Type *cache, uint32_t op, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	if (cache->dev.Busy) {
+		return ERROR;
+	}
+	if ((op != BLK_OP_SYNC) && ((n == 0) || (lba >= cache->dev.BlockCount)
+			|| (n > (cache->dev.BlockCount - lba)))) {
+		return ERROR;
+	}
+
+	cache->dev.Busy = TRUE;
+	cache->op = op;
+	cache->lba = lba;
+	cache->buf = buf;
+	cache->n = n;
+	cache->status = SUCCESS;
+	cache->miss = FALSE;
+	cache->bgerr = FALSE;
+	cache->idle = 0;
+
+	if (op == BLK_OP_READ) {
+		cache->reads++;
+		// Sequential read: prefetch the lines following the request
+		if ((cache->ReadAhead != 0) && (lba == cache->next)) {
+			cache->ahead = lba + n - 1;
+			cache->ahead += cache->LineBlocks - (cache->ahead % cache->LineBlocks);
+			cache->aheadn = cache->ReadAhead;
+		} else {
+			cache->aheadn = 0;
+		}
+		cache->next = lba + n;
+	}
+
+	cache_Process(cache);
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Read entry point of the cache, see BLKDEV_Type
+ **********************************************************************/
+static Status cache_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	return cache_Start((BLK_CACHE_Type *)dev, BLK_OP_READ, lba, buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Write entry point of the cache, see BLKDEV_Type. Done()
+ * 				is called once the data is in the cache.
+ **********************************************************************/
+static Status cache_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n)
+{
+	return cache_Start((BLK_CACHE_Type *)dev, BLK_OP_WRITE, lba, (uint8_t *)buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Sync entry point of the cache: write back all dirty
+ * 				lines, then Sync the lower device
+ **********************************************************************/
+static Status cache_Sync(BLKDEV_Type *dev)
+{
+	return cache_Start((BLK_CACHE_Type *)dev, BLK_OP_SYNC, 0, NULL, 1);
+}
+
+/*********************************************************************//**
+ * @brief		Poll entry point of the cache: poll the lower device,
+ * 				count idle time and run background work
+ **********************************************************************/
+static void cache_Poll(BLKDEV_Type *dev)
+{
+	BLK_CACHE_Type *cache = (BLK_CACHE_Type *)dev;
+
+	BLK_Poll(cache->Lower);
+	if ((cache->op == BLK_OP_NONE) && (cache->ioop == BLK_OP_NONE)
+			&& (cache->idle < cache->FlushDelay)) {
+		cache->idle++;
+	}
+	cache_Process(cache);
+}
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup BLKDEV_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Read blocks and wait for completion. Must not be called
+ * 				from the interrupt priority of the device.
+ * @param[in]	dev		Block device
+ * @param[in]	lba		First block
+ * @param[in]	buf		Destination buffer, n * BlockSize bytes
+ * @param[in]	n		Number of blocks
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status BLK_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	return blk_Wait(dev, BLK_OP_READ, lba, buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Write blocks and wait for completion. Must not be called
+ * 				from the interrupt priority of the device.
+ * @param[in]	dev		Block device
+ * @param[in]	lba		First block
+ * @param[in]	buf		Source buffer, n * BlockSize bytes
+ * @param[in]	n		Number of blocks
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status BLK_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n)
+{
+	return blk_Wait(dev, BLK_OP_WRITE, lba, (uint8_t *)buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Write back buffered data and wait for completion
+ * @param[in]	dev		Block device
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status BLK_Sync(BLKDEV_Type *dev)
+{
+	return blk_Wait(dev, BLK_OP_SYNC, 0, NULL, 0);
+}
+
+/*********************************************************************//**
+ * @brief		Run the background work and timeouts of a device
+ * @param[in]	dev		Block device
+ * @return 		None
+ **********************************************************************/
+void BLK_Poll(BLKDEV_Type *dev)
+{
+	if (dev->Poll != NULL) {
+		dev->Poll(dev);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Initialize a sector cache in front of its lower device.
+ * 				All lines are free; the lower device completion callback
+ * 				is set to the cache.
+ * @param[in]	cache	point to BLK_CACHE_Type structure, configuration
+ * 				fields must be filled
+ * @return 		ERROR if the configuration is out of range, otherwise
+ * 				SUCCESS
+ **********************************************************************/
+Status BLK_CacheInit(BLK_CACHE_Type *cache)
+{
+	BLKDEV_Type *lower = cache->Lower;
+	uint32_t i;
+
+	CHECK_PARAM(lower != NULL);
+	CHECK_PARAM(cache->Buf != NULL);
+
+	if ((cache->NumLines == 0) || (cache->NumLines > BLK_CACHE_LINE_MAX)
+			|| (cache->LineBlocks == 0) || (cache->LineBlocks > BLK_CACHE_BLOCKS_MAX)
+			|| (cache->ReadAhead >= cache->NumLines)) {
+		return ERROR;
+	}
+
+	cache->dev.BlockSize = lower->BlockSize;
+	cache->dev.BlockCount = lower->BlockCount;
+	cache->dev.Read = cache_Read;
+	cache->dev.Write = cache_Write;
+	cache->dev.Sync = cache_Sync;
+	cache->dev.Poll = cache_Poll;
+	cache->dev.Busy = FALSE;
+	lower->Done = cache_LowerDone;
+	lower->arg = cache;
+
+	for (i = 0; i < BLK_CACHE_LINE_MAX; i++) {
+		cache->line[i].Tag = BLK_CACHE_NO_TAG;
+		cache->line[i].Valid = 0;
+		cache->line[i].Dirty = 0;
+		cache->line[i].Used = 0;
+	}
+	cache->op = BLK_OP_NONE;
+	cache->ioop = BLK_OP_NONE;
+	cache->ioreq = FALSE;
+	cache->run = FALSE;
+	cache->miss = FALSE;
+	cache->bgerr = FALSE;
+	cache->io = NULL;
+	cache->next = 0;
+	cache->aheadn = 0;
+	cache->clock = 0;
+	cache->idle = 0;
+	cache->reads = 0;
+	cache->misses = 0;
+	cache->fills = 0;
+	cache->writebacks = 0;
+	return SUCCESS;
+}
+
+/**
+ * @}
+ */
+
+#endif /* _BLKDEV */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -60,6 +60,12 @@ uint16_t CANAF_gstd_cnt = 0;
 uint16_t CANAF_ext_cnt = 0;
 uint16_t CANAF_gext_cnt = 0;
 
+/* Transmit scheduler of CAN1 and CAN2 */
+static CAN_TXSCHED_Type *can_txsched[2];
+
+/* Receive ring of CAN1 and CAN2 */
+static CAN_RXRING_Type *can_rxring[2];
+
 /* End of Private Variables ----------------------------------------------------*/
 /**
  * @}
@@ -67,6 +73,16 @@ uint16_t CANAF_gext_cnt = 0;
 
 /* Private Variables ---------------------------------------------------------- */
 static void can_SetBaudrate (LPC_CAN_TypeDef *CANx, uint32_t baudrate);
+static uint32_t can_AFKey (AF_ID_Entry *IDs);
+static int32_t can_AFCompare (AF_ID_Entry *a, AF_ID_Entry *b);
+static void can_AFSift (AF_ID_Entry *IDs, uint16_t root, uint16_t num);
+static void can_AFSort (AF_ID_Entry *IDs, uint16_t num);
+static void can_AFPut16 (uint32_t *buf, uint16_t idx, uint32_t entry);
+static Bool can_TxBefore (CAN_TXQ_ENTRY_Type *a, CAN_TXQ_ENTRY_Type *b);
+static void can_TxPush (CAN_TXSCHED_Type *sched, CAN_TXQ_ENTRY_Type *entry);
+static void can_TxPop (CAN_TXSCHED_Type *sched, CAN_TXQ_ENTRY_Type *entry);
+static void can_TxService (LPC_CAN_TypeDef *CANx, CAN_TXSCHED_Type *sched);
+static void can_RxDrain (LPC_CAN_TypeDef *CANx, CAN_RXRING_Type *ring, uint32_t icr);
 
 /*********************************************************************//**
  * @brief 		Setting CAN baud rate (bps)
@@ -123,6 +139,303 @@ static void can_SetBaudrate (LPC_CAN_TypeDef *CANx, uint32_t baudrate)
 	/* Return to normal operating */
 	CANx->MOD = 0;
 }
+
+/*********************************************************************//**
+ * @brief 		Get sort key of an AF ID set entry: section, controller, ID.
+ * 				Sections are sorted in LUT order: FullCAN, standard, extended
+ * @param[in] 	IDs	point to AF_ID_Entry object
+ * @return 		Sort key
+ ***********************************************************************/
+static uint32_t can_AFKey (AF_ID_Entry *IDs)
+{
+	uint32_t sec;
+
+	if (IDs->fullcan)
+		sec = 0;
+	else if (IDs->format == STD_ID_FORMAT)
+		sec = 1;
+	else
+		sec = 2;
+	return (sec << 30) | (((uint32_t)IDs->controller) << 29) | IDs->lowerID;
+}
+
+/*********************************************************************//**
+ * @brief 		Compare two AF ID set entries
+ * @param[in] 	a, b	point to AF_ID_Entry objects
+ * @return 		<0, 0, >0 if a sorts before, same as, after b
+ ***********************************************************************/
+static int32_t can_AFCompare (AF_ID_Entry *a, AF_ID_Entry *b)
+{
+	uint32_t ka = can_AFKey(a);
+	uint32_t kb = can_AFKey(b);
+
+	if (ka != kb)
+		return (ka < kb) ? -1 : 1;
+	if (a->upperID != b->upperID)
+		return (a->upperID < b->upperID) ? -1 : 1;
+	return 0;
+}
+
+/*********************************************************************//**
+ * @brief 		Sift down one element of the heap used by can_AFSort()
+ * @param[in] 	IDs		point to AF ID set
+ * @param[in] 	root	index of element to sift down
+ * @param[in] 	num		number of elements in heap
+ * @return 		None
+ ***********************************************************************/
+static void can_AFSift (AF_ID_Entry *IDs, uint16_t root, uint16_t num)
+{
+	AF_ID_Entry tmp;
+	uint16_t child;
+
+	tmp = IDs[root];
+	while ((child = (root << 1) + 1) < num)
+	{
+		if ((child + 1 < num) && (can_AFCompare(&IDs[child], &IDs[child + 1]) < 0))
+			child++;
+		if (can_AFCompare(&tmp, &IDs[child]) >= 0)
+			break;
+		IDs[root] = IDs[child];
+		root = child;
+	}
+	IDs[root] = tmp;
+}
+
+/*********************************************************************//**
+ * @brief 		Sort AF ID set in place (heap sort, no extra memory)
+ * @param[in] 	IDs		point to AF ID set
+ * @param[in] 	num		number of entries
+ * @return 		None
+ ***********************************************************************/
+static void can_AFSort (AF_ID_Entry *IDs, uint16_t num)
+{
+	AF_ID_Entry tmp;
+	uint16_t i;
+
+	for (i = num >> 1; i > 0; i--)
+	{
+		can_AFSift(IDs, i - 1, num);
+	}
+	for (i = num; i > 1; i--)
+	{
+		tmp = IDs[0];
+		IDs[0] = IDs[i - 1];
+		IDs[i - 1] = tmp;
+		can_AFSift(IDs, 0, i - 1);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Write a 16-bit entry into LUT image. An even entry goes to
+ * 				upper half word and fills the lower half with a disabled
+ * 				entry (0xFFFF), in case it is the last one of the section
+ * @param[in] 	buf		point to LUT image
+ * @param[in] 	idx		half word index
+ * @param[in] 	entry	16-bit entry value
+ * @return 		None
+ ***********************************************************************/
+static void can_AFPut16 (uint32_t *buf, uint16_t idx, uint32_t entry)
+{
+	if ((idx & 0x01) == 0)
+	{
+		buf[idx >> 1] = (entry << 16) | 0x0000FFFF;
+	}
+	else
+	{
+		buf[idx >> 1] = (buf[idx >> 1] & 0xFFFF0000) | entry;
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Compare two transmit queue entries
+ * @param[in] 	a, b	point to CAN_TXQ_ENTRY_Type objects
+ * @return 		TRUE if a must be sent before b
+ ***********************************************************************/
+static Bool can_TxBefore (CAN_TXQ_ENTRY_Type *a, CAN_TXQ_ENTRY_Type *b)
+{
+	if (a->key != b->key)
+		return (a->key < b->key) ? TRUE : FALSE;
+	return ((int32_t)(a->seq - b->seq) < 0) ? TRUE : FALSE;
+}
+
+/*********************************************************************//**
+ * @brief 		Insert a frame into transmit priority queue (heap)
+ * @param[in] 	sched	point to transmit scheduler, heap not full
+ * @param[in] 	entry	point to frame to insert
+ * @return 		None
+ ***********************************************************************/
+static void can_TxPush (CAN_TXSCHED_Type *sched, CAN_TXQ_ENTRY_Type *entry)
+{
+	uint16_t i, parent;
+
+	i = sched->num++;
+	while (i > 0)
+	{
+		parent = (i - 1) >> 1;
+		if (can_TxBefore(entry, &sched->heap[parent]) == FALSE)
+			break;
+		sched->heap[i] = sched->heap[parent];
+		i = parent;
+	}
+	sched->heap[i] = *entry;
+}
+
+/*********************************************************************//**
+ * @brief 		Remove the most urgent frame from transmit priority queue
+ * @param[in] 	sched	point to transmit scheduler, heap not empty
+ * @param[out] 	entry	point to receive the frame
+ * @return 		None
+ ***********************************************************************/
+static void can_TxPop (CAN_TXSCHED_Type *sched, CAN_TXQ_ENTRY_Type *entry)
+{
+	CAN_TXQ_ENTRY_Type *heap = sched->heap;
+	uint16_t i, child, num;
+
+	*entry = heap[0];
+	num = --sched->num;
+	i = 0;
+	while ((child = (i << 1) + 1) < num)
+	{
+		if ((child + 1 < num) && can_TxBefore(&heap[child + 1], &heap[child]))
+			child++;
+		if (can_TxBefore(&heap[child], &heap[num]) == FALSE)
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = heap[num];
+}
+
+/*********************************************************************//**
+ * @brief 		Transmit scheduler service: account released TX buffers,
+ * 				load free ones with the most urgent frames, and pre-empt
+ * 				the least urgent loaded frame if a more urgent one waits.
+ * 				Called with CAN interrupt disabled or from the handler.
+ * @param[in] 	CANx	point to LPC_CAN_TypeDef object
+ * @param[in] 	sched	point to transmit scheduler
+ * @return 		None
+ ***********************************************************************/
+static void can_TxService (LPC_CAN_TypeDef *CANx, CAN_TXSCHED_Type *sched)
+{
+	CAN_TXQ_ENTRY_Type *hw;
+	CAN_TXSTAT_Type *stat;
+	__IO uint32_t *buf;
+	uint32_t sr, n, m, lat;
+
+	/* Released buffers: sent, or aborted and re-queued */
+	sr = CANx->SR;
+	for (n = 0; n < 3; n++)
+	{
+		if (((sched->busy & (1 << n)) == 0) || ((sr & (CAN_SR_TBS1 << (n << 3))) == 0))
+			continue;
+		hw = &sched->hw[n];
+		if (sr & (CAN_SR_TCS1 << (n << 3)))
+		{
+			stat = hw->stat;
+			if (stat != NULL)
+			{
+				lat = (sched->timer != NULL) ? (*sched->timer - hw->time) : 0;
+				stat->count++;
+				stat->lat_last = lat;
+				stat->lat_sum += lat;
+				if (lat > stat->lat_max)
+					stat->lat_max = lat;
+			}
+		}
+		else
+		{
+			can_TxPush(sched, hw);
+			sched->abort_cnt++;
+		}
+		sched->busy &= ~(1 << n);
+		sched->aborting &= ~(1 << n);
+	}
+
+	/* Load free buffers, frames with the same ID are never loaded
+	 * together so that they leave in submit order */
+	for (n = 0; (n < 3) && (sched->num != 0); n++)
+	{
+		if (sched->busy & (1 << n))
+			continue;
+		for (m = 0; m < 3; m++)
+		{
+			if ((sched->busy & (1 << m)) && (sched->hw[m].key == sched->heap[0].key))
+				break;
+		}
+		if (m < 3)
+			break;
+		hw = &sched->hw[n];
+		can_TxPop(sched, hw);
+		buf = &CANx->TFI1 + (n << 2);
+		buf[0] = hw->tfi;
+		buf[1] = hw->tid;
+		buf[2] = hw->tda;
+		buf[3] = hw->tdb;
+		CANx->CMR = CAN_CMR_TR | (CAN_CMR_STB1 << n);
+		sched->busy |= (1 << n);
+	}
+
+	/* All buffers loaded: pre-empt the least urgent one if needed */
+	if ((sched->busy == 0x07) && (sched->aborting == 0) && (sched->num != 0))
+	{
+		m = 0;
+		for (n = 1; n < 3; n++)
+		{
+			if (can_TxBefore(&sched->hw[m], &sched->hw[n]))
+				m = n;
+		}
+		if (can_TxBefore(&sched->heap[0], &sched->hw[m])
+			&& (sched->heap[0].key != sched->hw[m].key))
+		{
+			CANx->CMR = CAN_CMR_AT | (CAN_CMR_STB1 << m);
+			sched->aborting |= (1 << m);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Drain CAN controller receive buffer into its receive ring
+ * @param[in] 	CANx	point to LPC_CAN_TypeDef object
+ * @param[in] 	ring	point to receive ring
+ * @param[in] 	icr		interrupt status read from CANxICR
+ * @return 		None
+ ***********************************************************************/
+static void can_RxDrain (LPC_CAN_TypeDef *CANx, CAN_RXRING_Type *ring, uint32_t icr)
+{
+	CAN_RXFRAME_Type *f;
+	uint32_t head, rfs, time;
+
+	head = ring->head;
+	while (CANx->SR & CAN_SR_RBS)
+	{
+		time = (ring->timer != NULL) ? *ring->timer : 0;
+		if ((head - ring->tail) <= ring->mask)
+		{
+			rfs = CANx->RFS;
+			f = &ring->buf[head & ring->mask];
+			f->stamp = (time << 4) | ((rfs >> 16) & 0x0F);
+			f->id = CANx->RID | (rfs & 0xC0000000);
+			f->dataA = CANx->RDA;
+			f->dataB = CANx->RDB;
+			head++;
+		}
+		else
+		{
+			ring->overrun++;
+		}
+		/* Release receive buffer */
+		CANx->CMR = CAN_CMR_RRB;
+	}
+	/* Frames are written before the reader sees the new head */
+	__DMB();
+	ring->head = head;
+
+	if ((icr & CAN_ICR_DOI) || (CANx->GSR & CAN_GSR_DOS))
+	{
+		ring->hw_overrun++;
+		CANx->CMR = CAN_CMR_CDO;
+	}
+}
 /* End of Private Functions ----------------------------------------------------*/
 
 
@@ -1326,6 +1639,217 @@ CAN_ERROR CAN_RemoveEntry(AFLUT_ENTRY_Type EntryType, uint16_t position)
 	return CAN_OK;
 }
 
+/********************************************************************//**
+ * @brief		Build a complete Acceptance Filter Look-Up Table image
+ * 				from an ID set, in O(n.log(n)) and without touching the
+ * 				hardware. The ID set is sorted, duplicate and overlapping
+ * 				or contiguous IDs of the same controller are coalesced into
+ * 				group (range) entries, then each section is written in one
+ * 				pass. The image is loaded by CAN_LoadAFImage().
+ * @param[in]	IDs		point to ID set, it is sorted and coalesced in place
+ * @param[in]	num		number of entries in ID set
+ * @param[out]	buf		point to buffer that receives LUT words, also
+ * 						holds room for FullCAN objects
+ * @param[in]	size	size of buf in words, max 512
+ * @param[out]	Image	point to AF_ImageDef that describes the result
+ * @return 		CAN Error	could be:
+ * 				- CAN_OBJECTS_FULL_ERROR: image does not fit in buf/AF RAM
+ * 				- CAN_AF_ENTRY_ERROR: invalid entry in ID set
+ * 				- CAN_OK: image is built successfully
+ *********************************************************************/
+CAN_ERROR CAN_BuildAFImage(AF_ID_Entry* IDs, uint16_t num, uint32_t* buf,
+		uint16_t size, AF_ImageDef* Image)
+{
+	uint16_t i, w, idx;
+	uint16_t fc = 0, sff = 0, gsff = 0, eff = 0, geff = 0;
+	uint32_t words, ctrl;
+	AF_ID_Entry *cur, *last;
+
+	/* Check ID set */
+	for (i = 0; i < num; i++)
+	{
+		cur = &IDs[i];
+		if ((cur->controller > CAN2_CTRL) || (cur->lowerID > cur->upperID)
+			|| ((cur->format == STD_ID_FORMAT) && ((cur->upperID >> 11) != 0))
+			|| ((cur->format == EXT_ID_FORMAT) && ((cur->upperID >> 29) != 0))
+			|| ((cur->format != STD_ID_FORMAT) && (cur->format != EXT_ID_FORMAT))
+			|| (cur->fullcan && ((cur->format != STD_ID_FORMAT) || (cur->lowerID != cur->upperID))))
+		{
+			return CAN_AF_ENTRY_ERROR;
+		}
+	}
+
+	can_AFSort(IDs, num);
+
+	/* Coalesce: drop duplicates, merge overlapping and contiguous ranges */
+	w = 0;
+	for (i = 1; i < num; i++)
+	{
+		last = &IDs[w];
+		cur = &IDs[i];
+		if ((last->fullcan == cur->fullcan) && (last->format == cur->format)
+			&& (last->controller == cur->controller))
+		{
+			if (cur->fullcan)
+			{
+				if (cur->lowerID == last->lowerID)
+					continue;
+			}
+			else if (cur->lowerID <= last->upperID + 1)
+			{
+				if (cur->upperID > last->upperID)
+					last->upperID = cur->upperID;
+				continue;
+			}
+		}
+		IDs[++w] = *cur;
+	}
+	if (num != 0)
+		num = w + 1;
+
+	/* Count section entries and check space */
+	for (i = 0; i < num; i++)
+	{
+		cur = &IDs[i];
+		if (cur->fullcan)
+			fc++;
+		else if (cur->format == STD_ID_FORMAT)
+		{
+			if (cur->lowerID == cur->upperID)
+				sff++;
+			else
+				gsff++;
+		}
+		else
+		{
+			if (cur->lowerID == cur->upperID)
+				eff++;
+			else
+				geff++;
+		}
+	}
+	words = ((fc + 1) >> 1) + ((sff + 1) >> 1) + gsff + eff + (geff << 1);
+	if ((fc > MAX_HW_FULLCAN_OBJ) || (size > 512) || (words + fc * 3 > size))
+	{
+		return CAN_OBJECTS_FULL_ERROR;
+	}
+
+	/* Write sections, in LUT order */
+	w = 0;
+	for (i = 0, idx = 0; i < fc; i++)
+	{
+		ctrl = IDs[i].controller;
+		can_AFPut16(buf, idx++, (ctrl << 13) | (1 << 11) | IDs[i].lowerID);
+	}
+	w += (fc + 1) >> 1;
+	Image->SFF_sa = w << 2;
+	for (idx = 0; i < num; i++)
+	{
+		if ((IDs[i].format != STD_ID_FORMAT) || (IDs[i].lowerID != IDs[i].upperID))
+			continue;
+		ctrl = IDs[i].controller;
+		can_AFPut16(&buf[w], idx++, (ctrl << 13) | IDs[i].lowerID);
+	}
+	w += (sff + 1) >> 1;
+	Image->SFF_GRP_sa = w << 2;
+	for (i = fc; i < num; i++)
+	{
+		if ((IDs[i].format != STD_ID_FORMAT) || (IDs[i].lowerID == IDs[i].upperID))
+			continue;
+		ctrl = IDs[i].controller;
+		buf[w++] = (ctrl << 29) | (IDs[i].lowerID << 16) | (ctrl << 13) | IDs[i].upperID;
+	}
+	Image->EFF_sa = w << 2;
+	for (i = fc + sff + gsff; i < num; i++)
+	{
+		if (IDs[i].lowerID != IDs[i].upperID)
+			continue;
+		ctrl = IDs[i].controller;
+		buf[w++] = (ctrl << 29) | IDs[i].lowerID;
+	}
+	Image->EFF_GRP_sa = w << 2;
+	for (i = fc + sff + gsff; i < num; i++)
+	{
+		if (IDs[i].lowerID == IDs[i].upperID)
+			continue;
+		ctrl = IDs[i].controller;
+		buf[w++] = (ctrl << 29) | IDs[i].lowerID;
+		buf[w++] = (ctrl << 29) | IDs[i].upperID;
+	}
+	Image->ENDofTable = w << 2;
+
+	/* FullCAN object section follows the table */
+	for (i = 0; i < fc * 3; i++)
+	{
+		buf[w++] = 0x00;
+	}
+
+	Image->lut = buf;
+	Image->FC_NumEntry = fc;
+	Image->SFF_NumEntry = sff;
+	Image->SFF_GPR_NumEntry = gsff;
+	Image->EFF_NumEntry = eff;
+	Image->EFF_GPR_NumEntry = geff;
+	return CAN_OK;
+}
+
+/********************************************************************//**
+ * @brief		Load an Acceptance Filter Look-Up Table image built by
+ * 				CAN_BuildAFImage() or by the host AFLUT generator. This is
+ * 				a single bounded-time copy of ENDofTable/4 words plus the
+ * 				FullCAN objects. While copying, the filter is in bypass
+ * 				mode: messages are accepted unfiltered instead of dropped.
+ * 				Dynamic CAN_LoadxxxEntry()/CAN_RemoveEntry() still work on
+ * 				the loaded table.
+ * @param[in]	CANAFx	pointer to LPC_CANAF_TypeDef
+ * 				Should be: LPC_CANAF
+ * @param[in]	Image	point to AF_ImageDef object
+ * @return 		None
+ *********************************************************************/
+void CAN_LoadAFImage(LPC_CANAF_TypeDef* CANAFx, const AF_ImageDef* Image)
+{
+	uint32_t i, words;
+
+	CHECK_PARAM(PARAM_CANAFx(CANAFx));
+
+	/* Acceptance Filter Bypass mode while LUT is written */
+	CANAFx->AFMR = 0x02;
+
+	words = Image->ENDofTable >> 2;
+	for (i = 0; i < words; i++)
+	{
+		LPC_CANAF_RAM->mask[i] = Image->lut[i];
+	}
+	/* Clear FullCAN objects */
+	for (i = 0; i < ((uint32_t)Image->FC_NumEntry * 3); i++)
+	{
+		LPC_CANAF_RAM->mask[words + i] = 0x00;
+	}
+
+	CANAFx->SFF_sa = Image->SFF_sa;
+	CANAFx->SFF_GRP_sa = Image->SFF_GRP_sa;
+	CANAFx->EFF_sa = Image->EFF_sa;
+	CANAFx->EFF_GRP_sa = Image->EFF_GRP_sa;
+	CANAFx->ENDofTable = Image->ENDofTable;
+
+	CANAF_FullCAN_cnt = Image->FC_NumEntry;
+	CANAF_std_cnt = Image->SFF_NumEntry;
+	CANAF_gstd_cnt = Image->SFF_GPR_NumEntry;
+	CANAF_ext_cnt = Image->EFF_NumEntry;
+	CANAF_gext_cnt = Image->EFF_GPR_NumEntry;
+
+	if(Image->FC_NumEntry == 0)
+	{
+		FULLCAN_ENABLE = DISABLE;
+		CANAFx->AFMR = 0x00; // Normal mode
+	}
+	else
+	{
+		FULLCAN_ENABLE = ENABLE;
+		CANAFx->AFMR = 0x04;
+	}
+}
+
 /********************************************************************//**
  * @brief		Send message data
  * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
@@ -1479,6 +2003,188 @@ Status CAN_SendMsg (LPC_CAN_TypeDef *CANx, CAN_MSG_Type *CAN_Msg)
 	}
 }
 
+/********************************************************************//**
+ * @brief		Initialize CAN transmit scheduler. Frames submitted with
+ * 				CAN_TxSchedSubmit() are kept in a priority queue ordered by
+ * 				bus arbitration order of their identifier, and the three TX
+ * 				buffers are kept loaded with the most urgent ones. Should be
+ * 				called after CAN_Init(), CAN_TxSchedHandler() must be called
+ * 				from CAN interrupt handler.
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @param[in]	sched	point to CAN_TXSCHED_Type object, configuration
+ * 				fields filled by application
+ * @return 		None
+ *********************************************************************/
+void CAN_TxSchedInit(LPC_CAN_TypeDef* CANx, CAN_TXSCHED_Type* sched)
+{
+	uint16_t i;
+
+	CHECK_PARAM(PARAM_CANx(CANx));
+
+	sched->num = 0;
+	sched->busy = 0;
+	sched->aborting = 0;
+	sched->seq = 0;
+	sched->busoff_cnt = 0;
+	sched->abort_cnt = 0;
+	for (i = 0; (sched->stat != NULL) && (i < sched->stat_num); i++)
+	{
+		sched->stat[i].count = 0;
+		sched->stat[i].lat_last = 0;
+		sched->stat[i].lat_max = 0;
+		sched->stat[i].lat_sum = 0;
+	}
+	can_txsched[(CANx == LPC_CAN1) ? 0 : 1] = sched;
+
+	/* Transmit priority mode: buffers are sent in TFI PRIO order */
+	CANx->MOD |= CAN_MOD_RM;
+	CANx->MOD |= CAN_MOD_TPM;
+	CANx->MOD &= ~CAN_MOD_RM;
+	CANx->IER |= CAN_IER_TIE1 | CAN_IER_TIE2 | CAN_IER_TIE3 | CAN_IER_EIE;
+}
+
+/********************************************************************//**
+ * @brief		Submit a frame to CAN transmit scheduler
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @param[in]	CAN_Msg point to the CAN_MSG_Type Structure, it contains message
+ * 				information such as: ID, DLC, RTR, ID Format
+ * @return 		Status:
+ * 				- SUCCESS: frame is queued (or already loaded in a TX buffer)
+ * 				- ERROR: queue is full, or CAN_TxSchedInit() has not been
+ * 				called for CANx
+ * Note: the CAN interrupt is disabled while the queue is updated, then
+ * restored to its previous state
+ *********************************************************************/
+Status CAN_TxSchedSubmit(LPC_CAN_TypeDef* CANx, CAN_MSG_Type* CAN_Msg)
+{
+	CAN_TXSCHED_Type *sched;
+	CAN_TXQ_ENTRY_Type entry;
+	uint32_t key, irqen;
+	uint16_t i;
+
+	CHECK_PARAM(PARAM_CANx(CANx));
+	CHECK_PARAM(PARAM_ID_FORMAT(CAN_Msg->format));
+	CHECK_PARAM(PARAM_DLC(CAN_Msg->len));
+	CHECK_PARAM(PARAM_FRAME_TYPE(CAN_Msg->type));
+
+	sched = can_txsched[(CANx == LPC_CAN1) ? 0 : 1];
+	if (sched == NULL)
+	{
+		return ERROR;
+	}
+
+	/* Key in bus arbitration order: base ID, IDE, extended ID, RTR */
+	if (CAN_Msg->format == STD_ID_FORMAT)
+	{
+		CHECK_PARAM(PARAM_ID_11(CAN_Msg->id));
+		key = CAN_Msg->id << 19;
+	}
+	else
+	{
+		CHECK_PARAM(PARAM_ID_29(CAN_Msg->id));
+		key = ((CAN_Msg->id >> 18) << 19) | (1 << 18) | (CAN_Msg->id & 0x3FFFF);
+	}
+	key = (key << 1) | ((CAN_Msg->type == REMOTE_FRAME) ? 1 : 0);
+
+	entry.key = key;
+	entry.tfi = CAN_TFI_PRIO(key >> 23) | CAN_TFI_DLC(CAN_Msg->len);
+	if (CAN_Msg->type == REMOTE_FRAME)
+		entry.tfi |= CAN_TFI_RTR;
+	if (CAN_Msg->format == EXT_ID_FORMAT)
+		entry.tfi |= CAN_TFI_FF;
+	entry.tid = CAN_Msg->id;
+	entry.tda = (CAN_Msg->dataA[0])|((CAN_Msg->dataA[1])<<8)|((CAN_Msg->dataA[2])<<16)|((CAN_Msg->dataA[3])<<24);
+	entry.tdb = (CAN_Msg->dataB[0])|((CAN_Msg->dataB[1])<<8)|((CAN_Msg->dataB[2])<<16)|((CAN_Msg->dataB[3])<<24);
+	entry.stat = NULL;
+	for (i = 0; (sched->stat != NULL) && (i < sched->stat_num); i++)
+	{
+		if ((sched->stat[i].id == CAN_Msg->id) && (sched->stat[i].format == CAN_Msg->format))
+		{
+			entry.stat = &sched->stat[i];
+			break;
+		}
+	}
+
+	irqen = NVIC->ISER[((uint32_t)CAN_IRQn) >> 5] & (1UL << (((uint32_t)CAN_IRQn) & 0x1F));
+	NVIC_DisableIRQ(CAN_IRQn);
+	/* Keep room to re-queue the frames loaded in TX buffers */
+	if (sched->num + (sched->busy & 1) + ((sched->busy >> 1) & 1) + ((sched->busy >> 2) & 1)
+		>= sched->size)
+	{
+		if (irqen)
+			NVIC_EnableIRQ(CAN_IRQn);
+		return ERROR;
+	}
+	entry.seq = sched->seq++;
+	entry.time = (sched->timer != NULL) ? *sched->timer : 0;
+	can_TxPush(sched, &entry);
+	can_TxService(CANx, sched);
+	if (irqen)
+		NVIC_EnableIRQ(CAN_IRQn);
+
+	return SUCCESS;
+}
+
+/********************************************************************//**
+ * @brief		CAN transmit scheduler interrupt handler: refills TX buffers
+ * 				and recovers from bus-off. Should be called from CAN
+ * 				interrupt handler with the interrupt status of CANx.
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @param[in]	IntStatus	value returned by CAN_IntGetStatus(CANx), read
+ * 				once by application since reading clears it
+ * @return 		None
+ *********************************************************************/
+void CAN_TxSchedHandler(LPC_CAN_TypeDef* CANx, uint32_t IntStatus)
+{
+	CAN_TXSCHED_Type *sched = can_txsched[(CANx == LPC_CAN1) ? 0 : 1];
+	uint32_t n;
+
+	if (sched == NULL)
+		return;
+
+	/* Bus-off: controller entered reset mode, TX requests are lost */
+	if ((IntStatus & CAN_ICR_EI) && (CANx->GSR & CAN_GSR_BS) && (CANx->MOD & CAN_MOD_RM))
+	{
+		sched->busoff_cnt++;
+		for (n = 0; n < 3; n++)
+		{
+			if (sched->busy & (1 << n))
+				can_TxPush(sched, &sched->hw[n]);
+		}
+		sched->busy = 0;
+		sched->aborting = 0;
+		/* Leave reset mode, bus-on after 128 x 11 recessive bits */
+		CANx->MOD &= ~CAN_MOD_RM;
+	}
+	can_TxService(CANx, sched);
+}
+
+/********************************************************************//**
+ * @brief		Get number of frames pending in CAN transmit scheduler
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @return 		Number of frames queued or loaded in TX buffers, 0 if
+ * 				CAN_TxSchedInit() has not been called for CANx
+ *********************************************************************/
+uint32_t CAN_TxSchedPending(LPC_CAN_TypeDef* CANx)
+{
+	CAN_TXSCHED_Type *sched = can_txsched[(CANx == LPC_CAN1) ? 0 : 1];
+
+	CHECK_PARAM(PARAM_CANx(CANx));
+
+	if (sched == NULL)
+		return 0;
+
+	return sched->num + (sched->busy & 1) + ((sched->busy >> 1) & 1) + ((sched->busy >> 2) & 1);
+}
+
 /********************************************************************//**
  * @brief		Receive message data
  * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
@@ -1545,6 +2251,99 @@ Status CAN_ReceiveMsg (LPC_CAN_TypeDef *CANx, CAN_MSG_Type *CAN_Msg)
 	return SUCCESS;
 }
 
+/********************************************************************//**
+ * @brief		Attach a receive ring to CAN controller. After that,
+ * 				CAN_RxRingHandler() drains every received frame into the
+ * 				ring with a time stamp, and CAN_ReadFrames() reads them.
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @param[in]	ring	point to receive ring control structure
+ * @param[in]	buf		point to frame buffer
+ * @param[in]	size	number of frames in buffer, must be a power of 2
+ * @param[in]	timer	point to a free running counter used as time stamp,
+ * 						e.g. &LPC_TIM0->TC at 1us. NULL: time stamp is 0
+ * @return 		None
+ *********************************************************************/
+void CAN_RxRingInit(LPC_CAN_TypeDef* CANx, CAN_RXRING_Type* ring, CAN_RXFRAME_Type* buf,
+		uint32_t size, __IO uint32_t* timer)
+{
+	CHECK_PARAM(PARAM_CANx(CANx));
+	CHECK_PARAM((size != 0) && ((size & (size - 1)) == 0));
+
+	ring->buf = buf;
+	ring->mask = size - 1;
+	ring->timer = timer;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->overrun = 0;
+	ring->hw_overrun = 0;
+	can_rxring[(CANx == LPC_CAN1) ? 0 : 1] = ring;
+
+	CANx->IER |= CAN_IER_RIE | CAN_IER_DOIE;
+}
+
+/********************************************************************//**
+ * @brief		Receive ring interrupt handler: reads CANxICR once, drains
+ * 				the received frames into the ring attached to CANx and
+ * 				clears a data overrun. Should be called from CAN interrupt
+ * 				handler for each controller, instead of CAN_IntGetStatus()
+ * 				since CANxICR is reset after read.
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @return 		Interrupt status read from CANxICR, e.g. for
+ * 				CAN_TxSchedHandler()
+ *********************************************************************/
+uint32_t CAN_RxRingHandler(LPC_CAN_TypeDef* CANx)
+{
+	CAN_RXRING_Type *ring;
+	uint32_t icr;
+
+	CHECK_PARAM(PARAM_CANx(CANx));
+
+	icr = CANx->ICR;
+	ring = can_rxring[(CANx == LPC_CAN1) ? 0 : 1];
+	if (ring != NULL)
+		can_RxDrain(CANx, ring, icr);
+	return icr;
+}
+
+/********************************************************************//**
+ * @brief		Read received frames from receive ring
+ * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
+ * 				- LPC_CAN1: CAN1 peripheral
+ * 				- LPC_CAN2: CAN2 peripheral
+ * @param[out]	buf		point to buffer to store frames
+ * @param[in]	n		max number of frames to read
+ * @return 		Number of frames read, 0 if CAN_RxRingInit() has not been
+ * 				called for CANx
+ *********************************************************************/
+uint32_t CAN_ReadFrames(LPC_CAN_TypeDef* CANx, CAN_RXFRAME_Type* buf, uint32_t n)
+{
+	CAN_RXRING_Type *ring;
+	uint32_t tail, num, i;
+
+	CHECK_PARAM(PARAM_CANx(CANx));
+
+	ring = can_rxring[(CANx == LPC_CAN1) ? 0 : 1];
+	if (ring == NULL)
+		return 0;
+	tail = ring->tail;
+	num = ring->head - tail;
+	if (num > n)
+		num = n;
+	/* Frames are read after the head, and before the slots are freed */
+	__DMB();
+	for (i = 0; i < num; i++)
+	{
+		buf[i] = ring->buf[(tail + i) & ring->mask];
+	}
+	__DMB();
+	ring->tail = tail + num;
+	return num;
+}
+
 /********************************************************************//**
  * @brief		Receive FullCAN Object
  * @param[in]	CANAFx: CAN Acceptance Filter register, should be: LPC_CANAF
@@ -1631,6 +2430,120 @@ CAN_ERROR FCAN_ReadObj (LPC_CANAF_TypeDef* CANAFx, CAN_MSG_Type *CAN_Msg)
 	}
 	return CAN_FULL_OBJ_NOT_RCV;
 }
+
+/********************************************************************//**
+ * @brief		Read all updated FullCAN objects in one pass, using the
+ * 				FCANIC0/1 pending bitmaps, into an application mirror table.
+ * 				Each object is copied only if the snapshot is consistent
+ * 				(semaphore still cleared after copy), otherwise it is read
+ * 				again. Can be called from the FullCAN interrupt or polled.
+ * @param[in]	CANAFx	pointer to LPC_CANAF_TypeDef, should be: LPC_CANAF
+ * @param[in]	mirror	point to mirror table, indexed by FullCAN object
+ * 				number (order of FullCAN section of AFLUT)
+ * @param[in]	num		number of entries in mirror table, max 64. A
+ * 				received object numbered num or above is dropped: its
+ * 				semaphore is cleared so that its pending bit does not
+ * 				raise the FullCAN interrupt again
+ * @return		Number of objects updated in mirror table
+ *********************************************************************/
+uint32_t CAN_FullCANReadAll(LPC_CANAF_TypeDef* CANAFx, CAN_FCAN_MIRROR_Type* mirror,
+		uint32_t num)
+{
+	__IO uint32_t *pObj;
+	CAN_FCAN_MIRROR_Type *m;
+	uint32_t pend, w0, dataA, dataB;
+	uint32_t word, obj, tries, cnt = 0;
+
+	CHECK_PARAM(PARAM_CANAFx(CANAFx));
+
+	for (word = 0; word < 2; word++)
+	{
+		pend = (word == 0) ? CANAFx->FCANIC0 : CANAFx->FCANIC1;
+		obj = word << 5;
+		while (pend != 0)
+		{
+			if ((pend & 0xFF) == 0)
+			{
+				pend >>= 8;
+				obj += 8;
+				continue;
+			}
+			if ((pend & 0x01) && (obj >= num))
+			{
+				/* No mirror entry: drop it, this clears pending bit */
+				pObj = (__IO uint32_t *)(CANAFx->ENDofTable + LPC_CANAF_RAM_BASE + obj * 12);
+				w0 = pObj[0];
+				if ((w0 & CAN_FCAN_SEM_MASK) == CAN_FCAN_SEM_DONE)
+					pObj[0] = w0 & ~CAN_FCAN_SEM_MASK;
+			}
+			else if (pend & 0x01)
+			{
+				pObj = (__IO uint32_t *)(CANAFx->ENDofTable + LPC_CANAF_RAM_BASE + obj * 12);
+				for (tries = 0; tries < 4; tries++)
+				{
+					w0 = pObj[0];
+					if ((w0 & CAN_FCAN_SEM_MASK) == CAN_FCAN_SEM_UPDATING)
+						continue;
+					if ((w0 & CAN_FCAN_SEM_MASK) != CAN_FCAN_SEM_DONE)
+						break;
+					/* Clear semaphore, this also clears pending bit */
+					pObj[0] = w0 & ~CAN_FCAN_SEM_MASK;
+					dataA = pObj[1];
+					dataB = pObj[2];
+					/* Updated again while copying: read again */
+					if ((pObj[0] & CAN_FCAN_SEM_MASK) != 0)
+						continue;
+					m = &mirror[obj];
+					/* Odd sequence is seen before the payload, the
+					 * payload before the even one */
+					m->seq++;
+					__DMB();
+					m->frame = w0 & ~CAN_FCAN_SEM_MASK;
+					m->dataA = dataA;
+					m->dataB = dataB;
+					__DMB();
+					m->seq++;
+					cnt++;
+					break;
+				}
+			}
+			pend >>= 1;
+			obj++;
+		}
+	}
+	return cnt;
+}
+
+/********************************************************************//**
+ * @brief		Get latest value of one FullCAN object from mirror table,
+ * 				in constant time. Safe against CAN_FullCANReadAll() running
+ * 				in interrupt.
+ * @param[in]	mirror	point to mirror table entry
+ * @param[out]	CAN_Msg point to the CAN_MSG_Type Structure to fill
+ * @return		Number of updates of this object, 0: never received
+ *********************************************************************/
+uint32_t CAN_FullCANMirrorGet(CAN_FCAN_MIRROR_Type* mirror, CAN_MSG_Type* CAN_Msg)
+{
+	uint32_t seq, frame, dataA, dataB;
+
+	do
+	{
+		seq = mirror->seq;
+		__DMB();
+		frame = mirror->frame;
+		dataA = mirror->dataA;
+		dataB = mirror->dataB;
+		__DMB();
+	} while ((seq & 0x01) || (seq != mirror->seq));
+
+	CAN_Msg->id = frame & 0x7FF;
+	CAN_Msg->len = (uint8_t)((frame >> 16) & 0x0F);
+	CAN_Msg->format = STD_ID_FORMAT; //FullCAN Object ID always is 11-bit value
+	CAN_Msg->type = (uint8_t)((frame >> 30) & 0x01);
+	*((uint32_t *) &CAN_Msg->dataA[0]) = dataA;
+	*((uint32_t *) &CAN_Msg->dataB[0]) = dataB;
+	return seq >> 1;
+}
 /********************************************************************//**
  * @brief		Get CAN Control Status
  * @param[in]	CANx pointer to LPC_CAN_TypeDef, should be:
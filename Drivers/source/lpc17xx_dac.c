@@ -31,6 +31,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "lpc17xx_dac.h"
 #include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
 
 /* If this source file built with example, the LPC17xx FW library configuration
  * file in each example directory ("lpc17xx_libcfg.h") must be included,
@@ -132,6 +133,142 @@ void DAC_SetDMATimeOut(LPC_DAC_TypeDef *DACx, uint32_t time_out)
 	DACx->DACCNTVAL = DAC_CCNT_VALUE(time_out);
 }
 
+#ifdef _GPDMA
+/*********************************************************************//**
+ * @brief 		Refill one block of DAC stream: the generator writes q15
+ * 				samples in the first half of the block, they are expanded
+ * 				in place into DACR words, last one first
+ * @param[in] 	stream	point to DAC_STREAM_Type structure
+ * @param[in] 	block	block number, 0 or 1
+ * @return 		None
+ ***********************************************************************/
+static void dac_StreamFill(DAC_STREAM_Type *stream, uint32_t block)
+{
+	uint32_t *p;
+	int16_t *s;
+	uint32_t i, bias;
+
+	p = stream->buf + (block * stream->BlockSize);
+	s = (int16_t *) p;
+	stream->Generator(stream->arg, s, stream->BlockSize);
+
+	bias = LPC_DAC->DACR & DAC_BIAS_EN;
+	for (i = stream->BlockSize; i > 0; i--) {
+		p[i - 1] = DAC_Q15_VALUE(s[i - 1]) | bias;
+	}
+	stream->last = block;
+	stream->blocks++;
+}
+
+/*********************************************************************//**
+ * @brief 		Initialize DAC streaming player: set DAC timer to the
+ * 				update rate, fill both blocks from the generator and setup
+ * 				the GPDMA channel with two LLIs linked to each other.
+ * 				DAC_Init() must be called before.
+ * @param[in] 	DACx pointer to LPC_DAC_TypeDef, should be: LPC_DAC
+ * @param[in] 	stream	point to DAC_STREAM_Type structure, configuration
+ * 				fields must be filled
+ * @return 		ERROR if GPDMA channel is enabled, otherwise SUCCESS
+ ***********************************************************************/
+Status DAC_StreamInit(LPC_DAC_TypeDef *DACx, DAC_STREAM_Type *stream)
+{
+	GPDMA_Channel_CFG_Type GPDMACfg;
+	uint32_t i;
+
+	CHECK_PARAM(PARAM_DACx(DACx));
+	CHECK_PARAM((stream->BlockSize > 0) && (stream->BlockSize <= 0xFFF));
+	CHECK_PARAM((stream->Rate > 0) && (stream->Rate <= 1000000));
+
+	/* DAC timer reloads every PCLK_DAC / Rate clocks, then requests DMA */
+	DACx->DACCTRL &= ~DAC_DACCTRL_MASK;
+	DAC_SetDMATimeOut(DACx, CLKPWR_GetPCLK(CLKPWR_PCLKSEL_DAC) / stream->Rate);
+
+	for (i = 0; i < 2; i++) {
+		stream->lli[i].SrcAddr = (uint32_t) (stream->buf + (i * stream->BlockSize));
+		stream->lli[i].DstAddr = (uint32_t) &DACx->DACR;
+		stream->lli[i].NextLLI = (uint32_t) &stream->lli[i ^ 1];
+		stream->lli[i].Control = GPDMA_DMACCxControl_TransferSize((uint32_t)stream->BlockSize) \
+						| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) \
+						| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) \
+						| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) \
+						| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) \
+						| GPDMA_DMACCxControl_SI \
+						| GPDMA_DMACCxControl_I;
+	}
+	stream->blocks = 0;
+	stream->underrun = 0;
+	stream->error = 0;
+	dac_StreamFill(stream, 0);
+	dac_StreamFill(stream, 1);
+
+	GPDMACfg.ChannelNum = stream->DMAChannel;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	GPDMACfg.SrcConn = 0;
+	GPDMACfg.DstConn = GPDMA_CONN_DAC;
+	GPDMACfg.DMALLI = (uint32_t) &stream->lli[0];
+	return GPDMA_SetupLLI(&GPDMACfg);
+}
+
+/*********************************************************************//**
+ * @brief 		Start DAC streaming player: enable GPDMA channel, then DAC
+ * 				timer with double buffering and DMA requests
+ * @param[in] 	DACx pointer to LPC_DAC_TypeDef, should be: LPC_DAC
+ * @param[in] 	stream	point to DAC_STREAM_Type structure
+ * @return 		None
+ ***********************************************************************/
+void DAC_StreamStart(LPC_DAC_TypeDef *DACx, DAC_STREAM_Type *stream)
+{
+	CHECK_PARAM(PARAM_DACx(DACx));
+
+	GPDMA_ChannelCmd(stream->DMAChannel, ENABLE);
+	DACx->DACCTRL |= DAC_DBLBUF_ENA | DAC_CNT_ENA | DAC_DMA_ENA;
+}
+
+/*********************************************************************//**
+ * @brief 		Stop DAC streaming player, output keeps the last value
+ * @param[in] 	DACx pointer to LPC_DAC_TypeDef, should be: LPC_DAC
+ * @param[in] 	stream	point to DAC_STREAM_Type structure
+ * @return 		None
+ ***********************************************************************/
+void DAC_StreamStop(LPC_DAC_TypeDef *DACx, DAC_STREAM_Type *stream)
+{
+	CHECK_PARAM(PARAM_DACx(DACx));
+
+	DACx->DACCTRL &= ~DAC_DACCTRL_MASK;
+	GPDMA_ChannelCmd(stream->DMAChannel, DISABLE);
+}
+
+/*********************************************************************//**
+ * @brief 		DAC streaming player GPDMA interrupt handler, should be
+ * 				called from DMA_IRQHandler(). Refills the block that is
+ * 				not being played. The generator must take less time than
+ * 				one block, otherwise blocks are played twice (underrun).
+ * @param[in] 	stream	point to DAC_STREAM_Type structure
+ * @return 		None
+ ***********************************************************************/
+void DAC_StreamDMAHandler(DAC_STREAM_Type *stream)
+{
+	uint32_t playing;
+
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, stream->DMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, stream->DMAChannel);
+		stream->error++;
+	}
+	if (!GPDMA_IntGetStatus(GPDMA_STAT_INTTC, stream->DMAChannel)) {
+		return;
+	}
+	GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, stream->DMAChannel);
+
+	playing = (GPDMA_GetSrcAddr(stream->DMAChannel) - (uint32_t)stream->buf) / 4;
+	playing = (playing < stream->BlockSize) ? 0 : 1;
+	if ((playing ^ 1) == stream->last) {
+		// Terminal count was missed, the block was played twice
+		stream->underrun++;
+	}
+	dac_StreamFill(stream, playing ^ 1);
+}
+#endif /* _GPDMA */
+
 /**
  * @}
  */
@@ -773,6 +773,55 @@ void EMAC_ReadPacketBuffer(EMAC_PACKETBUF_Type *pDataStruct)
 	}
 }
 
+/*********************************************************************//**
+ * @brief		Get Tx packet data buffer at current index due to
+ * 				TxProduceIndex, so that a frame can be built in place
+ * 				instead of being copied by EMAC_WritePacketBuffer()
+ * @param[in]	None
+ * @return		Word-aligned pointer to Tx packet data buffer, or NULL if
+ * 				no Tx descriptor is free
+ **********************************************************************/
+uint32_t *EMAC_GetTxPacketBuffer(void)
+{
+	uint32_t idx, next;
+
+	idx = LPC_EMAC->TxProduceIndex;
+	next = idx + 1;
+	if (next == EMAC_NUM_TX_FRAG) next = 0;
+	if (next == LPC_EMAC->TxConsumeIndex) {
+		return NULL;
+	}
+	return (uint32_t *)Tx_Desc[idx].Packet;
+}
+
+/*********************************************************************//**
+ * @brief		Send the frame built in Tx packet data buffer returned by
+ * 				EMAC_GetTxPacketBuffer(), update TxProduceIndex
+ * @param[in]	ulDataLen	Frame length in bytes
+ * @return		None
+ **********************************************************************/
+void EMAC_SendTxPacketBuffer(uint32_t ulDataLen)
+{
+	uint32_t idx;
+
+	idx = LPC_EMAC->TxProduceIndex;
+	Tx_Desc[idx].Ctrl = (ulDataLen - 1) | (EMAC_TCTRL_INT | EMAC_TCTRL_LAST);
+	EMAC_UpdateTxProduceIndex();
+}
+
+/*********************************************************************//**
+ * @brief		Get Rx packet data buffer at current index due to
+ * 				RxConsumeIndex, so that a frame can be parsed in place
+ * 				instead of being copied by EMAC_ReadPacketBuffer(). It is
+ * 				valid until EMAC_UpdateRxConsumeIndex() is called.
+ * @param[in]	None
+ * @return		Word-aligned pointer to Rx packet data buffer
+ **********************************************************************/
+uint32_t *EMAC_GetRxPacketBuffer(void)
+{
+	return (uint32_t *)Rx_Desc[LPC_EMAC->RxConsumeIndex].Packet;
+}
+
 /*********************************************************************//**
  * @brief 		Enable/Disable interrupt for each type in EMAC
  * @param[in]	ulIntType	Interrupt Type, should be:
@@ -0,0 +1,1371 @@
+/**********************************************************************
+* $Id$		lpc17xx_fat.c				2011-03-09
+*//**
+* @file		lpc17xx_fat.c
+* @brief	Contains all functions support for the FAT16/FAT32 file
+* 			layer on a block device on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup FAT
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_fat.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _FAT
+
+/* Private Macros ------------------------------------------------------------- */
+/** No sector */
+#define FAT_NO_SECTOR		0xFFFFFFFF
+/** Cluster values returned by fat_Get(): end of chain, error */
+#define FAT_EOC				0x0FFFFFFF
+#define FAT_BAD				0xFFFFFFFF
+/** Default date and time: 1 January 2011, 00:00 */
+#define FAT_DEFAULT_TIME	((((2011UL - 1980) << 9) | (1 << 5) | 1) << 16)
+
+/** Boot sector fields */
+#define FAT_BS_BYTSPERSEC	11
+#define FAT_BS_SECPERCLUS	13
+#define FAT_BS_RSVDSECCNT	14
+#define FAT_BS_NUMFATS		16
+#define FAT_BS_ROOTENTCNT	17
+#define FAT_BS_TOTSEC16		19
+#define FAT_BS_FATSZ16		22
+#define FAT_BS_TOTSEC32		32
+#define FAT_BS_FATSZ32		36
+#define FAT_BS_ROOTCLUS		44
+#define FAT_BS_FSINFO		48
+#define FAT_BS_SIGNATURE	510
+/** MBR: first partition entry, type and start fields */
+#define FAT_MBR_PART		446
+#define FAT_MBR_TYPE		4
+#define FAT_MBR_START		8
+/** FSInfo fields and signatures */
+#define FAT_FSI_LEADSIG		0
+#define FAT_FSI_STRUCSIG	484
+#define FAT_FSI_FREECOUNT	488
+#define FAT_FSI_NXTFREE		492
+#define FAT_FSI_LEADSIG_VAL		0x41615252
+#define FAT_FSI_STRUCSIG_VAL	0x61417272
+
+/** Directory entry: size, fields, attributes */
+#define FAT_DIR_SIZE		32
+#define FAT_DIR_ATTR		11
+#define FAT_DIR_CRTTIME		14
+#define FAT_DIR_LSTACCDATE	18
+#define FAT_DIR_CLUSHI		20
+#define FAT_DIR_WRTTIME		22
+#define FAT_DIR_CLUSLO		26
+#define FAT_DIR_FILESIZE	28
+#define FAT_ATTR_READONLY	0x01
+#define FAT_ATTR_VOLUME		0x08
+#define FAT_ATTR_DIRECTORY	0x10
+#define FAT_ATTR_ARCHIVE	0x20
+/** First name byte: end of directory, deleted entry */
+#define FAT_DIR_END			0x00
+#define FAT_DIR_DELETED		0xE5
+
+/** Little endian loads */
+#define FAT_LD16(p)		((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8))
+#define FAT_LD32(p)		(FAT_LD16(p) | (FAT_LD16((p) + 2) << 16))
+
+/** Cluster in range */
+#define FAT_VALID(vol, cl)	(((cl) >= 2) && ((cl) < ((vol)->ClusterCount + 2)))
+/** First sector of a cluster */
+#define FAT_CLUSTER_SECTOR(vol, cl)	((vol)->DataStart + (((cl) - 2) * (vol)->SecPerClus))
+
+
+/* Private Functions ---------------------------------------------------------- */
+static void fat_St16(uint8_t *p, uint32_t val);
+static void fat_St32(uint8_t *p, uint32_t val);
+static void fat_Copy(uint8_t *dst, const uint8_t *src, uint32_t len);
+static void fat_Fill(uint8_t *dst, uint8_t val, uint32_t len);
+static uint32_t fat_Time(FAT_VOLUME_Type *vol);
+static Status fat_WinFlush(FAT_VOLUME_Type *vol);
+static uint8_t *fat_Entry(FAT_VOLUME_Type *vol, uint32_t cl);
+static uint32_t fat_Get(FAT_VOLUME_Type *vol, uint32_t cl);
+static Status fat_Set(FAT_VOLUME_Type *vol, uint32_t cl, uint32_t val);
+static Status fat_BufFlush(FAT_VOLUME_Type *vol);
+static Status fat_BufLoad(FAT_VOLUME_Type *vol, uint32_t sec);
+static uint32_t fat_FindFree(FAT_VOLUME_Type *vol, uint32_t hint, uint32_t *count, Bool exact);
+static Status fat_FreeChain(FAT_VOLUME_Type *vol, uint32_t cl);
+static Status fat_Prefetch(FAT_FILE_Type *file, uint32_t index, uint32_t cl, Bool count);
+static uint32_t fat_Map(FAT_FILE_Type *file, uint32_t index, uint32_t *run);
+static Status fat_Link(FAT_FILE_Type *file, uint32_t cl, uint32_t count);
+static Status fat_Extend(FAT_FILE_Type *file, uint32_t count, Bool contiguous);
+static Status fat_Trim(FAT_FILE_Type *file);
+static Status fat_FileFlush(FAT_FILE_Type *file);
+static Status fat_FileLoad(FAT_FILE_Type *file, uint32_t sec, Bool load);
+static Status fat_Name(const char *name, uint8_t *sfn);
+static Status fat_DirFind(FAT_VOLUME_Type *vol, const uint8_t *sfn, Bool create, FAT_FILE_Type *file, Bool *found);
+
+/*********************************************************************//**
+ * @brief		Store a 16 bit little endian value
+ * @param[out]	p		Destination
+ * @param[in]	val		Value
+ * @return 		None
+ **********************************************************************/
+static void fat_St16(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+}
+
+/*********************************************************************//**
+ * @brief		Store a 32 bit little endian value
+ * @param[out]	p		Destination
+ * @param[in]	val		Value
+ * @return 		None
+ **********************************************************************/
+static void fat_St32(uint8_t *p, uint32_t val)
+{
+	fat_St16(p, val);
+	fat_St16(p + 2, val >> 16);
+}
+
+/*********************************************************************//**
+ * @brief		Copy bytes
+ * @param[out]	dst		Destination
+ * @param[in]	src		Source
+ * @param[in]	len		Number of bytes
+ * @return 		None
+ **********************************************************************/
+static void fat_Copy(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+	while (len--) {
+		*dst++ = *src++;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Fill bytes
+ * @param[out]	dst		Destination
+ * @param[in]	val		Fill value
+ * @param[in]	len		Number of bytes
+ * @return 		None
+ **********************************************************************/
+static void fat_Fill(uint8_t *dst, uint8_t val, uint32_t len)
+{
+	while (len--) {
+		*dst++ = val;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Current date and time
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @return 		Date << 16 | time, FAT format
+ **********************************************************************/
+static uint32_t fat_Time(FAT_VOLUME_Type *vol)
+{
+	return (vol->GetTime != NULL) ? vol->GetTime() : FAT_DEFAULT_TIME;
+}
+
+/*********************************************************************//**
+ * @brief		Write the dirty sectors of the FAT window to every FAT
+ * 				copy, consecutive dirty sectors in one request
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_WinFlush(FAT_VOLUME_Type *vol)
+{
+	uint32_t i, n, copy;
+
+	i = 0;
+	while (vol->windirty != 0) {
+		if (!(vol->windirty & (1 << i))) {
+			i++;
+			continue;
+		}
+		for (n = 1; (vol->windirty & (1 << (i + n))) != 0; n++);
+		for (copy = 0; copy < vol->NumFats; copy++) {
+			if (BLK_Write(vol->Dev, vol->FatStart + (copy * vol->FatSize) + vol->winsec + i,
+					&vol->win[i * FAT_SECTOR_SIZE], n) != SUCCESS) {
+				return ERROR;
+			}
+		}
+		vol->fatwrites += n;
+		vol->windirty &= ~(((1 << n) - 1) << i);
+		i += n;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Get the FAT entry of a cluster in the window, moving the
+ * 				window if needed: the window then starts at the sector of
+ * 				the entry, so that a chain walk reads ahead.
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	cl		Cluster, valid
+ * @return 		Pointer to the entry, NULL on device error
+ **********************************************************************/
+static uint8_t *fat_Entry(FAT_VOLUME_Type *vol, uint32_t cl)
+{
+	uint32_t ofs, sec, n;
+
+	ofs = (vol->Type == FAT_TYPE_FAT32) ? (cl * 4) : (cl * 2);
+	sec = ofs / FAT_SECTOR_SIZE;
+	if ((vol->winsec == FAT_NO_SECTOR) || (sec < vol->winsec)
+			|| (sec >= (vol->winsec + FAT_WIN_SECTORS))) {
+		if (fat_WinFlush(vol) != SUCCESS) {
+			return NULL;
+		}
+		n = vol->FatSize - sec;
+		if (n > FAT_WIN_SECTORS) {
+			n = FAT_WIN_SECTORS;
+		}
+		vol->winsec = FAT_NO_SECTOR;
+		if (BLK_Read(vol->Dev, vol->FatStart + sec, vol->win, n) != SUCCESS) {
+			return NULL;
+		}
+		vol->winsec = sec;
+		vol->fatreads++;
+	}
+	return &vol->win[ofs - (vol->winsec * FAT_SECTOR_SIZE)];
+}
+
+/*********************************************************************//**
+ * @brief		Read a FAT entry
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	cl		Cluster, valid
+ * @return 		Next cluster, 0 if free, FAT_EOC at the end of the chain,
+ * 				FAT_BAD on device error or for a bad or invalid entry
+ **********************************************************************/
+static uint32_t fat_Get(FAT_VOLUME_Type *vol, uint32_t cl)
+{
+	uint8_t *p;
+	uint32_t val;
+
+	p = fat_Entry(vol, cl);
+	if (p == NULL) {
+		return FAT_BAD;
+	}
+	if (vol->Type == FAT_TYPE_FAT32) {
+		val = FAT_LD32(p) & 0x0FFFFFFF;
+		if (val >= 0x0FFFFFF8) {
+			return FAT_EOC;
+		}
+	} else {
+		val = FAT_LD16(p);
+		if (val >= 0xFFF8) {
+			return FAT_EOC;
+		}
+	}
+	if ((val != 0) && !FAT_VALID(vol, val)) {
+		return FAT_BAD;
+	}
+	return val;
+}
+
+/*********************************************************************//**
+ * @brief		Write a FAT entry in the window
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	cl		Cluster, valid
+ * @param[in]	val		Next cluster, 0 (free) or FAT_EOC
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_Set(FAT_VOLUME_Type *vol, uint32_t cl, uint32_t val)
+{
+	uint8_t *p;
+
+	p = fat_Entry(vol, cl);
+	if (p == NULL) {
+		return ERROR;
+	}
+	if (vol->Type == FAT_TYPE_FAT32) {
+		// The upper 4 bits are reserved
+		fat_St32(p, (FAT_LD32(p) & 0xF0000000) | val);
+	} else {
+		fat_St16(p, val);
+	}
+	vol->windirty |= 1 << ((p - vol->win) / FAT_SECTOR_SIZE);
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Write back the volume sector buffer if it is dirty
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_BufFlush(FAT_VOLUME_Type *vol)
+{
+	if (vol->bufdirty) {
+		if (BLK_Write(vol->Dev, vol->bufsec, vol->buf, 1) != SUCCESS) {
+			return ERROR;
+		}
+		vol->bufdirty = FALSE;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Read a sector into the volume sector buffer
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	sec		Sector
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_BufLoad(FAT_VOLUME_Type *vol, uint32_t sec)
+{
+	if (vol->bufsec == sec) {
+		return SUCCESS;
+	}
+	if (fat_BufFlush(vol) != SUCCESS) {
+		return ERROR;
+	}
+	vol->bufsec = FAT_NO_SECTOR;
+	if (BLK_Read(vol->Dev, sec, vol->buf, 1) != SUCCESS) {
+		return ERROR;
+	}
+	vol->bufsec = sec;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Find free clusters, from hint to the end of the volume
+ * 				then from its start
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	hint	First cluster to look at
+ * @param[in]	count	Number of clusters wanted, then number found
+ * @param[in]	exact	TRUE: only a run of count clusters is accepted,
+ * 				FALSE: the first free run, up to count clusters
+ * @return 		First cluster of the run, 0 if none or on device error
+ **********************************************************************/
+static uint32_t fat_FindFree(FAT_VOLUME_Type *vol, uint32_t hint, uint32_t *count, Bool exact)
+{
+	uint32_t i, cl, val, first, n;
+
+	if (!FAT_VALID(vol, hint)) {
+		hint = 2;
+	}
+	cl = hint;
+	first = 0;
+	n = 0;
+	for (i = 0; i < vol->ClusterCount; i++, cl++) {
+		if (cl == (vol->ClusterCount + 2)) {
+			// Runs do not wrap
+			if ((n != 0) && !exact) {
+				break;
+			}
+			cl = 2;
+			n = 0;
+		}
+		val = fat_Get(vol, cl);
+		if (val == 0) {
+			if (n++ == 0) {
+				first = cl;
+			}
+			if (n == *count) {
+				return first;
+			}
+		} else {
+			if (val == FAT_BAD) {
+				// Device error, or bad cluster
+				if (fat_Entry(vol, cl) == NULL) {
+					return 0;
+				}
+			}
+			if ((n != 0) && !exact) {
+				break;
+			}
+			n = 0;
+		}
+	}
+	if ((n == 0) || exact) {
+		return 0;
+	}
+	*count = n;
+	return first;
+}
+
+/*********************************************************************//**
+ * @brief		Free a cluster chain
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	cl		First cluster to free, 0 for none
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_FreeChain(FAT_VOLUME_Type *vol, uint32_t cl)
+{
+	uint32_t next;
+
+	while (FAT_VALID(vol, cl)) {
+		next = fat_Get(vol, cl);
+		if ((next == 0) || (next == FAT_BAD) || (fat_Set(vol, cl, 0) != SUCCESS)) {
+			return ERROR;
+		}
+		if (vol->FreeCount != FAT_FREE_UNKNOWN) {
+			vol->FreeCount++;
+		}
+		vol->infodirty = TRUE;
+		cl = next;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Walk the chain from a known cluster and cache its runs
+ * 				(prefetch). With count, the walk goes on to the end of the
+ * 				chain to find its length and last cluster.
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @param[in]	index	Position of cl in the file (clusters)
+ * @param[in]	cl		Cluster
+ * @param[in]	count	TRUE to walk the whole chain
+ * @return 		ERROR on device error or broken chain, otherwise SUCCESS
+ **********************************************************************/
+static Status fat_Prefetch(FAT_FILE_Type *file, uint32_t index, uint32_t cl, Bool count)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	FAT_EXTENT_Type *ext;
+	uint32_t next, walk;
+
+	ext = &file->ext[0];
+	ext->Index = index;
+	ext->Cluster = cl;
+	ext->Count = 1;
+	file->numext = 1;
+	// Without count, the walk stops after one FAT window of entries
+	walk = (FAT_WIN_SECTORS * FAT_SECTOR_SIZE) / 2;
+	for (;;) {
+		if (!count && (--walk == 0)) {
+			break;
+		}
+		next = fat_Get(vol, cl);
+		if (next == FAT_EOC) {
+			break;
+		}
+		if ((next == 0) || (next == FAT_BAD) || (++index >= vol->ClusterCount)) {
+			return ERROR;
+		}
+		if (next == (cl + 1)) {
+			if (ext == &file->ext[file->numext - 1]) {
+				ext->Count++;
+			}
+		} else if (file->numext < FAT_EXTENTS) {
+			ext = &file->ext[file->numext++];
+			ext->Index = index;
+			ext->Cluster = next;
+			ext->Count = 1;
+		} else if (!count) {
+			break;
+		} else {
+			// Runs past the cache are only counted
+			ext = NULL;
+		}
+		cl = next;
+	}
+	if (count) {
+		file->clusters = index + 1;
+		file->last = cl;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Map a position of the file (clusters) to its cluster. On
+ * 				a cache miss, the chain is walked from the nearest cached
+ * 				run before the position, or from the first cluster, and
+ * 				the runs from the position on are cached.
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @param[in]	index	Position (clusters), less than the chain length
+ * @param[out]	run		Number of contiguous clusters from the cluster
+ * @return 		Cluster, 0 on error
+ **********************************************************************/
+static uint32_t fat_Map(FAT_FILE_Type *file, uint32_t index, uint32_t *run)
+{
+	FAT_EXTENT_Type *ext;
+	uint32_t i, cl, at;
+
+	for (i = 0; i < file->numext; i++) {
+		ext = &file->ext[i];
+		if ((index >= ext->Index) && ((index - ext->Index) < ext->Count)) {
+			*run = ext->Count - (index - ext->Index);
+			return ext->Cluster + (index - ext->Index);
+		}
+	}
+
+	at = 0;
+	cl = file->start;
+	for (i = 0; i < file->numext; i++) {
+		ext = &file->ext[i];
+		if ((ext->Index + ext->Count - 1) < index) {
+			at = ext->Index + ext->Count - 1;
+			cl = ext->Cluster + ext->Count - 1;
+		}
+	}
+	while (at < index) {
+		cl = fat_Get(file->vol, cl);
+		if (!FAT_VALID(file->vol, cl)) {
+			return 0;
+		}
+		at++;
+	}
+	if (fat_Prefetch(file, index, cl, FALSE) != SUCCESS) {
+		return 0;
+	}
+	*run = file->ext[0].Count;
+	return cl;
+}
+
+/*********************************************************************//**
+ * @brief		Append a run of free clusters to the chain of the file
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @param[in]	cl		First cluster of the run
+ * @param[in]	count	Number of clusters
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_Link(FAT_FILE_Type *file, uint32_t cl, uint32_t count)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	FAT_EXTENT_Type *ext;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		if (fat_Set(vol, cl + i, (i == (count - 1)) ? FAT_EOC : (cl + i + 1)) != SUCCESS) {
+			return ERROR;
+		}
+	}
+	if (file->clusters == 0) {
+		file->start = cl;
+		file->dirty = TRUE;
+	} else if (fat_Set(vol, file->last, cl) != SUCCESS) {
+		return ERROR;
+	}
+
+	// Keep the cache when it reaches the end of the chain
+	if (file->numext == 0) {
+		file->ext[0].Index = 0;
+		file->ext[0].Cluster = cl;
+		file->ext[0].Count = count;
+		file->numext = 1;
+	} else if ((file->ext[file->numext - 1].Index + file->ext[file->numext - 1].Count)
+			== file->clusters) {
+		ext = &file->ext[file->numext - 1];
+		if ((ext->Cluster + ext->Count) == cl) {
+			ext->Count += count;
+		} else {
+			if (file->numext == FAT_EXTENTS) {
+				for (i = 1; i < FAT_EXTENTS; i++) {
+					file->ext[i - 1] = file->ext[i];
+				}
+				file->numext--;
+			}
+			ext = &file->ext[file->numext++];
+			ext->Index = file->clusters;
+			ext->Cluster = cl;
+			ext->Count = count;
+		}
+	}
+
+	file->clusters += count;
+	file->last = cl + count - 1;
+	vol->nextfree = cl + count;
+	if (vol->FreeCount != FAT_FREE_UNKNOWN) {
+		vol->FreeCount -= count;
+	}
+	vol->infodirty = TRUE;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Add clusters to the chain of the file, from the cluster
+ * 				that follows its end when it is free
+ * @param[in]	file		point to FAT_FILE_Type structure
+ * @param[in]	count		Number of clusters
+ * @param[in]	contiguous	TRUE: one run of count clusters or nothing
+ * @return 		ERROR if the volume is full or on device error
+ **********************************************************************/
+static Status fat_Extend(FAT_FILE_Type *file, uint32_t count, Bool contiguous)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	uint32_t cl, n;
+
+	while (count != 0) {
+		n = count;
+		cl = fat_FindFree(vol, (file->clusters != 0) ? (file->last + 1) : vol->nextfree,
+				&n, contiguous);
+		if ((cl == 0) || (fat_Link(file, cl, n) != SUCCESS)) {
+			return ERROR;
+		}
+		count -= n;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Free the clusters past the end of the file (unused
+ * 				preallocation)
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_Trim(FAT_FILE_Type *file)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	uint32_t keep, cl, next, run, i;
+
+	keep = (file->Size + (1UL << vol->clshift) - 1) >> vol->clshift;
+	if (file->clusters <= keep) {
+		return SUCCESS;
+	}
+	if (keep == 0) {
+		next = file->start;
+		file->start = 0;
+		file->dirty = TRUE;
+		file->last = 0;
+	} else {
+		cl = fat_Map(file, keep - 1, &run);
+		if (cl == 0) {
+			return ERROR;
+		}
+		next = fat_Get(vol, cl);
+		if (fat_Set(vol, cl, FAT_EOC) != SUCCESS) {
+			return ERROR;
+		}
+		file->last = cl;
+	}
+	file->clusters = keep;
+	for (i = 0; i < file->numext; i++) {
+		if (file->ext[i].Index >= keep) {
+			break;
+		}
+		if ((file->ext[i].Index + file->ext[i].Count) > keep) {
+			file->ext[i].Count = keep - file->ext[i].Index;
+		}
+	}
+	file->numext = i;
+	return fat_FreeChain(vol, next);
+}
+
+/*********************************************************************//**
+ * @brief		Write back the file sector buffer if it is dirty
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_FileFlush(FAT_FILE_Type *file)
+{
+	if (file->bufdirty) {
+		if (BLK_Write(file->vol->Dev, file->bufsec, file->buf, 1) != SUCCESS) {
+			return ERROR;
+		}
+		file->bufdirty = FALSE;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Bring a sector into the file sector buffer
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @param[in]	sec		Sector
+ * @param[in]	load	TRUE to read it, FALSE to clear the buffer (sector
+ * 				past the end of the file)
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_FileLoad(FAT_FILE_Type *file, uint32_t sec, Bool load)
+{
+	if (file->bufsec == sec) {
+		return SUCCESS;
+	}
+	if (fat_FileFlush(file) != SUCCESS) {
+		return ERROR;
+	}
+	file->bufsec = FAT_NO_SECTOR;
+	if (load) {
+		if (BLK_Read(file->vol->Dev, sec, file->buf, 1) != SUCCESS) {
+			return ERROR;
+		}
+	} else {
+		fat_Fill(file->buf, 0, FAT_SECTOR_SIZE);
+	}
+	file->bufsec = sec;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Convert a file name to its 8.3 directory form
+ * @param[in]	name	File name, "NAME.EXT"
+ * @param[out]	sfn		11 bytes, blank padded, upper case
+ * @return 		ERROR if the name is not a valid 8.3 name
+ **********************************************************************/
+static Status fat_Name(const char *name, uint8_t *sfn)
+{
+	uint32_t i, max;
+	uint8_t c;
+
+	fat_Fill(sfn, ' ', 11);
+	i = 0;
+	max = 8;
+	while ((c = (uint8_t)*name++) != 0) {
+		if ((c == '.') && (max == 8) && (i != 0)) {
+			i = 8;
+			max = 11;
+			continue;
+		}
+		if ((i == max) || (c <= ' ') || (c == '.') || (c == '"') || (c == '*')
+				|| (c == '+') || (c == ',') || (c == '/') || (c == ':')
+				|| (c == ';') || (c == '<') || (c == '=') || (c == '>')
+				|| (c == '?') || (c == '[') || (c == '\\') || (c == ']')
+				|| (c == '|') || (c == 0x7F)) {
+			return ERROR;
+		}
+		if ((c >= 'a') && (c <= 'z')) {
+			c -= 'a' - 'A';
+		}
+		sfn[i++] = c;
+	}
+	if ((i == 0) || (sfn[0] == FAT_DIR_DELETED)) {
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Look for a file in the root directory. When it is not
+ * 				found, the first free entry is returned; with create, a
+ * 				full FAT32 root directory gets a new cluster.
+ * @param[in]	vol		point to FAT_VOLUME_Type structure
+ * @param[in]	sfn		8.3 name
+ * @param[in]	create	TRUE if a free entry is needed
+ * @param[out]	file	dirsec/dirofs: entry found, or free entry
+ * 				(dirsec FAT_NO_SECTOR if none)
+ * @param[out]	found	TRUE if the file was found
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+static Status fat_DirFind(FAT_VOLUME_Type *vol, const uint8_t *sfn, Bool create, FAT_FILE_Type *file, Bool *found)
+{
+	uint32_t cl, prev, sec, n, i, j, k;
+	uint8_t *e;
+
+	*found = FALSE;
+	file->dirsec = FAT_NO_SECTOR;
+	if (vol->Type == FAT_TYPE_FAT32) {
+		cl = vol->RootCluster;
+		sec = FAT_CLUSTER_SECTOR(vol, cl);
+		n = vol->SecPerClus;
+	} else {
+		cl = 0;
+		sec = vol->RootStart;
+		n = vol->RootSectors;
+	}
+	for (;;) {
+		for (i = 0; i < n; i++, sec++) {
+			if (fat_BufLoad(vol, sec) != SUCCESS) {
+				return ERROR;
+			}
+			for (j = 0; j < FAT_SECTOR_SIZE; j += FAT_DIR_SIZE) {
+				e = &vol->buf[j];
+				if ((e[0] == FAT_DIR_END) || (e[0] == FAT_DIR_DELETED)) {
+					if (file->dirsec == FAT_NO_SECTOR) {
+						file->dirsec = sec;
+						file->dirofs = j;
+					}
+					if (e[0] == FAT_DIR_END) {
+						return SUCCESS;
+					}
+					continue;
+				}
+				// Volume label and long name entries have the volume bit
+				if (e[FAT_DIR_ATTR] & (FAT_ATTR_VOLUME | FAT_ATTR_DIRECTORY)) {
+					continue;
+				}
+				for (k = 0; (k < 11) && (e[k] == sfn[k]); k++);
+				if (k == 11) {
+					file->dirsec = sec;
+					file->dirofs = j;
+					*found = TRUE;
+					return SUCCESS;
+				}
+			}
+		}
+		if (cl == 0) {
+			// FAT16 root directory: fixed size
+			return SUCCESS;
+		}
+		prev = cl;
+		cl = fat_Get(vol, cl);
+		if (cl == FAT_EOC) {
+			break;
+		}
+		if (!FAT_VALID(vol, cl)) {
+			return ERROR;
+		}
+		sec = FAT_CLUSTER_SECTOR(vol, cl);
+		n = vol->SecPerClus;
+	}
+	if (!create || (file->dirsec != FAT_NO_SECTOR)) {
+		return SUCCESS;
+	}
+
+	// Full FAT32 root directory: link a cleared cluster
+	n = 1;
+	cl = fat_FindFree(vol, vol->nextfree, &n, TRUE);
+	if ((cl == 0) || (fat_BufFlush(vol) != SUCCESS)) {
+		return ERROR;
+	}
+	fat_Fill(vol->buf, 0, FAT_SECTOR_SIZE);
+	vol->bufsec = FAT_NO_SECTOR;
+	sec = FAT_CLUSTER_SECTOR(vol, cl);
+	for (i = 0; i < vol->SecPerClus; i++) {
+		if (BLK_Write(vol->Dev, sec + i, vol->buf, 1) != SUCCESS) {
+			return ERROR;
+		}
+	}
+	vol->bufsec = sec;
+	if ((fat_Set(vol, cl, FAT_EOC) != SUCCESS) || (fat_Set(vol, prev, cl) != SUCCESS)) {
+		return ERROR;
+	}
+	vol->nextfree = cl + 1;
+	if (vol->FreeCount != FAT_FREE_UNKNOWN) {
+		vol->FreeCount--;
+	}
+	vol->infodirty = TRUE;
+	file->dirsec = sec;
+	file->dirofs = 0;
+	return SUCCESS;
+}
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup FAT_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Mount a volume: boot sector at block 0, or in the first
+ * 				MBR partition, and FSInfo of FAT32
+ * @param[in]	vol		point to FAT_VOLUME_Type structure, configuration
+ * 				fields must be filled
+ * @return 		ERROR on device error, or if no FAT16/FAT32 volume of
+ * 				512 byte sectors is found
+ **********************************************************************/
+Status FAT_Mount(FAT_VOLUME_Type *vol)
+{
+	uint32_t base, total, rsvd, n;
+	uint8_t *p;
+
+	CHECK_PARAM(vol->Dev->BlockSize == FAT_SECTOR_SIZE);
+
+	vol->Type = FAT_TYPE_NONE;
+	vol->winsec = FAT_NO_SECTOR;
+	vol->windirty = 0;
+	vol->bufsec = FAT_NO_SECTOR;
+	vol->bufdirty = FALSE;
+	vol->infodirty = FALSE;
+	vol->fatreads = 0;
+	vol->fatwrites = 0;
+
+	base = 0;
+	if (fat_BufLoad(vol, 0) != SUCCESS) {
+		return ERROR;
+	}
+	p = vol->buf;
+	if (FAT_LD16(&p[FAT_BS_SIGNATURE]) != 0xAA55) {
+		return ERROR;
+	}
+	if (((p[0] != 0xEB) && (p[0] != 0xE9))
+			|| (FAT_LD16(&p[FAT_BS_BYTSPERSEC]) != FAT_SECTOR_SIZE)) {
+		// Partition table
+		p = &vol->buf[FAT_MBR_PART];
+		n = p[FAT_MBR_TYPE];
+		if ((n != 0x04) && (n != 0x06) && (n != 0x0B) && (n != 0x0C) && (n != 0x0E)) {
+			return ERROR;
+		}
+		base = FAT_LD32(&p[FAT_MBR_START]);
+		if (fat_BufLoad(vol, base) != SUCCESS) {
+			return ERROR;
+		}
+		p = vol->buf;
+		if ((FAT_LD16(&p[FAT_BS_SIGNATURE]) != 0xAA55)
+				|| (FAT_LD16(&p[FAT_BS_BYTSPERSEC]) != FAT_SECTOR_SIZE)) {
+			return ERROR;
+		}
+	}
+
+	vol->SecPerClus = p[FAT_BS_SECPERCLUS];
+	for (n = 0; (n < 8) && ((1UL << n) != vol->SecPerClus); n++);
+	if (n == 8) {
+		return ERROR;
+	}
+	vol->clshift = n + 9;
+	vol->NumFats = p[FAT_BS_NUMFATS];
+	rsvd = FAT_LD16(&p[FAT_BS_RSVDSECCNT]);
+	vol->FatSize = FAT_LD16(&p[FAT_BS_FATSZ16]);
+	if (vol->FatSize == 0) {
+		vol->FatSize = FAT_LD32(&p[FAT_BS_FATSZ32]);
+	}
+	total = FAT_LD16(&p[FAT_BS_TOTSEC16]);
+	if (total == 0) {
+		total = FAT_LD32(&p[FAT_BS_TOTSEC32]);
+	}
+	vol->RootSectors = ((FAT_LD16(&p[FAT_BS_ROOTENTCNT]) * FAT_DIR_SIZE) + FAT_SECTOR_SIZE - 1)
+			/ FAT_SECTOR_SIZE;
+	vol->FatStart = base + rsvd;
+	vol->RootStart = vol->FatStart + (vol->NumFats * vol->FatSize);
+	vol->DataStart = vol->RootStart + vol->RootSectors;
+	if ((rsvd == 0) || (vol->NumFats == 0) || (vol->FatSize == 0)
+			|| (total <= (vol->DataStart - base))
+			|| ((base + total) > vol->Dev->BlockCount)) {
+		return ERROR;
+	}
+	vol->ClusterCount = (total - (vol->DataStart - base)) / vol->SecPerClus;
+
+	// The cluster count alone decides the FAT type
+	vol->FreeCount = FAT_FREE_UNKNOWN;
+	vol->nextfree = 2;
+	vol->InfoSector = 0;
+	if (vol->ClusterCount < 4085) {
+		// FAT12
+		return ERROR;
+	} else if (vol->ClusterCount < 65525) {
+		vol->Type = FAT_TYPE_FAT16;
+		vol->RootCluster = 0;
+		n = 2;
+	} else {
+		vol->Type = FAT_TYPE_FAT32;
+		vol->RootCluster = FAT_LD32(&p[FAT_BS_ROOTCLUS]);
+		n = FAT_LD16(&p[FAT_BS_FSINFO]);
+		if ((n != 0) && (n < rsvd)) {
+			vol->InfoSector = base + n;
+		}
+		n = 4;
+	}
+	if (((vol->ClusterCount + 2) * n) > (vol->FatSize * FAT_SECTOR_SIZE)) {
+		vol->Type = FAT_TYPE_NONE;
+		return ERROR;
+	}
+
+	if (vol->InfoSector != 0) {
+		if (fat_BufLoad(vol, vol->InfoSector) != SUCCESS) {
+			vol->Type = FAT_TYPE_NONE;
+			return ERROR;
+		}
+		p = vol->buf;
+		if ((FAT_LD32(&p[FAT_FSI_LEADSIG]) == FAT_FSI_LEADSIG_VAL)
+				&& (FAT_LD32(&p[FAT_FSI_STRUCSIG]) == FAT_FSI_STRUCSIG_VAL)) {
+			n = FAT_LD32(&p[FAT_FSI_FREECOUNT]);
+			if (n <= vol->ClusterCount) {
+				vol->FreeCount = n;
+			}
+			vol->nextfree = FAT_LD32(&p[FAT_FSI_NXTFREE]);
+		} else {
+			vol->InfoSector = 0;
+		}
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Get the number of free clusters, counted through the FAT
+ * 				if FSInfo did not give it
+ * @param[in]	vol			point to FAT_VOLUME_Type structure, mounted
+ * @param[out]	clusters	Number of free clusters
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status FAT_GetFree(FAT_VOLUME_Type *vol, uint32_t *clusters)
+{
+	uint32_t cl, n, val;
+
+	if (vol->FreeCount == FAT_FREE_UNKNOWN) {
+		n = 0;
+		for (cl = 2; cl < (vol->ClusterCount + 2); cl++) {
+			val = fat_Get(vol, cl);
+			if (val == 0) {
+				n++;
+			} else if ((val == FAT_BAD) && (fat_Entry(vol, cl) == NULL)) {
+				return ERROR;
+			}
+		}
+		vol->FreeCount = n;
+		vol->infodirty = TRUE;
+	}
+	*clusters = vol->FreeCount;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Open a file of the root directory. The cluster chain is
+ * 				walked once to find its end and cache its first runs.
+ * @param[in]	vol		point to FAT_VOLUME_Type structure, mounted
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @param[in]	name	8.3 file name
+ * @param[in]	mode	FAT_MODE_xxx
+ * @return 		ERROR if the file does not exist (without FAT_MODE_CREATE),
+ * 				is read-only (for writing), the directory is full, or on
+ * 				device error
+ **********************************************************************/
+Status FAT_Open(FAT_VOLUME_Type *vol, FAT_FILE_Type *file, const char *name, uint8_t mode)
+{
+	uint8_t sfn[11];
+	uint8_t *e;
+	uint32_t time;
+	Bool found;
+
+	file->vol = vol;
+	file->mode = 0;
+	file->dirty = FALSE;
+	file->bufdirty = FALSE;
+	file->bufsec = FAT_NO_SECTOR;
+	file->numext = 0;
+	file->start = 0;
+	file->Size = 0;
+	file->Pos = 0;
+	file->clusters = 0;
+	file->last = 0;
+
+	if ((vol->Type == FAT_TYPE_NONE) || (fat_Name(name, sfn) != SUCCESS)
+			|| (fat_DirFind(vol, sfn, (mode & FAT_MODE_CREATE) ? TRUE : FALSE, file, &found) != SUCCESS)) {
+		return ERROR;
+	}
+	if (!found) {
+		if (!(mode & FAT_MODE_CREATE) || (file->dirsec == FAT_NO_SECTOR)
+				|| (fat_BufLoad(vol, file->dirsec) != SUCCESS)) {
+			return ERROR;
+		}
+		// New entry, written by the next FAT_Sync()
+		e = &vol->buf[file->dirofs];
+		fat_Fill(e, 0, FAT_DIR_SIZE);
+		fat_Copy(e, sfn, 11);
+		e[FAT_DIR_ATTR] = FAT_ATTR_ARCHIVE;
+		time = fat_Time(vol);
+		fat_St16(&e[FAT_DIR_CRTTIME], time);
+		fat_St16(&e[FAT_DIR_CRTTIME + 2], time >> 16);
+		fat_St16(&e[FAT_DIR_LSTACCDATE], time >> 16);
+		vol->bufdirty = TRUE;
+		file->dirty = TRUE;
+	} else {
+		if (fat_BufLoad(vol, file->dirsec) != SUCCESS) {
+			return ERROR;
+		}
+		e = &vol->buf[file->dirofs];
+		if ((mode & (FAT_MODE_WRITE | FAT_MODE_TRUNC)) && (e[FAT_DIR_ATTR] & FAT_ATTR_READONLY)) {
+			return ERROR;
+		}
+		file->start = FAT_LD16(&e[FAT_DIR_CLUSLO]);
+		if (vol->Type == FAT_TYPE_FAT32) {
+			file->start |= FAT_LD16(&e[FAT_DIR_CLUSHI]) << 16;
+		}
+		file->Size = FAT_LD32(&e[FAT_DIR_FILESIZE]);
+		if (file->start != 0) {
+			if (!FAT_VALID(vol, file->start)
+					|| (fat_Prefetch(file, 0, file->start, TRUE) != SUCCESS)) {
+				return ERROR;
+			}
+		}
+		if ((file->Size != 0)
+				&& (((file->Size - 1) >> vol->clshift) >= file->clusters)) {
+			// Chain shorter than the size
+			return ERROR;
+		}
+	}
+
+	file->mode = mode;
+	if (mode & FAT_MODE_TRUNC) {
+		file->Size = 0;
+		file->dirty = TRUE;
+		if (fat_Trim(file) != SUCCESS) {
+			return ERROR;
+		}
+	}
+	if (mode & FAT_MODE_APPEND) {
+		file->Pos = file->Size;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Read from the current position. Whole sectors are read
+ * 				directly into buf, one device request per run of
+ * 				contiguous clusters.
+ * @param[in]	file	point to FAT_FILE_Type structure, open for reading
+ * @param[out]	buf		Destination buffer
+ * @param[in]	len		Number of bytes
+ * @return 		Number of bytes read, less than len at the end of the file
+ * 				or on error
+ **********************************************************************/
+uint32_t FAT_Read(FAT_FILE_Type *file, uint8_t *buf, uint32_t len)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	uint32_t done, cl, run, sec, n, ofs;
+
+	if (!(file->mode & FAT_MODE_READ)) {
+		return 0;
+	}
+	if (len > (file->Size - file->Pos)) {
+		len = file->Size - file->Pos;
+	}
+	done = 0;
+	while (done < len) {
+		cl = fat_Map(file, file->Pos >> vol->clshift, &run);
+		if (cl == 0) {
+			break;
+		}
+		n = (file->Pos >> 9) & (vol->SecPerClus - 1);
+		sec = FAT_CLUSTER_SECTOR(vol, cl) + n;
+		ofs = file->Pos & (FAT_SECTOR_SIZE - 1);
+		if ((ofs == 0) && ((len - done) >= FAT_SECTOR_SIZE)) {
+			n = (run * vol->SecPerClus) - n;
+			if (n > ((len - done) / FAT_SECTOR_SIZE)) {
+				n = (len - done) / FAT_SECTOR_SIZE;
+			}
+			// The sector buffer may hold newer data
+			if ((file->bufsec >= sec) && (file->bufsec < (sec + n))
+					&& (fat_FileFlush(file) != SUCCESS)) {
+				break;
+			}
+			if (BLK_Read(vol->Dev, sec, buf + done, n) != SUCCESS) {
+				break;
+			}
+			n *= FAT_SECTOR_SIZE;
+		} else {
+			if (fat_FileLoad(file, sec, TRUE) != SUCCESS) {
+				break;
+			}
+			n = FAT_SECTOR_SIZE - ofs;
+			if (n > (len - done)) {
+				n = len - done;
+			}
+			fat_Copy(buf + done, &file->buf[ofs], n);
+		}
+		done += n;
+		file->Pos += n;
+	}
+	return done;
+}
+
+/*********************************************************************//**
+ * @brief		Write at the current position. Clusters missing for the
+ * 				whole write are allocated first (following the chain when
+ * 				possible); whole sectors are then written directly from
+ * 				buf, one device request per run of contiguous clusters.
+ * 				The FAT and the directory entry are updated in memory
+ * 				only, see FAT_Sync().
+ * @param[in]	file	point to FAT_FILE_Type structure, open for writing
+ * @param[in]	buf		Source buffer
+ * @param[in]	len		Number of bytes
+ * @return 		Number of bytes written, less than len if the volume is
+ * 				full or on error
+ **********************************************************************/
+uint32_t FAT_Write(FAT_FILE_Type *file, const uint8_t *buf, uint32_t len)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	uint32_t done, cl, run, sec, n, ofs, need;
+
+	if (!(file->mode & FAT_MODE_WRITE)) {
+		return 0;
+	}
+	if (len > (0xFFFFFFFF - file->Pos)) {
+		len = 0xFFFFFFFF - file->Pos;
+	}
+	if (len == 0) {
+		return 0;
+	}
+	need = ((file->Pos + len - 1) >> vol->clshift) + 1;
+	if (file->clusters < need) {
+		fat_Extend(file, need - file->clusters, FALSE);
+		if (file->clusters <= (file->Pos >> vol->clshift)) {
+			return 0;
+		}
+		if (file->clusters < need) {
+			len = (file->clusters << vol->clshift) - file->Pos;
+		}
+	}
+
+	done = 0;
+	while (done < len) {
+		cl = fat_Map(file, file->Pos >> vol->clshift, &run);
+		if (cl == 0) {
+			break;
+		}
+		n = (file->Pos >> 9) & (vol->SecPerClus - 1);
+		sec = FAT_CLUSTER_SECTOR(vol, cl) + n;
+		ofs = file->Pos & (FAT_SECTOR_SIZE - 1);
+		if ((ofs == 0) && ((len - done) >= FAT_SECTOR_SIZE)) {
+			n = (run * vol->SecPerClus) - n;
+			if (n > ((len - done) / FAT_SECTOR_SIZE)) {
+				n = (len - done) / FAT_SECTOR_SIZE;
+			}
+			// The sector buffer is overwritten
+			if ((file->bufsec >= sec) && (file->bufsec < (sec + n))) {
+				file->bufsec = FAT_NO_SECTOR;
+				file->bufdirty = FALSE;
+			}
+			if (BLK_Write(vol->Dev, sec, buf + done, n) != SUCCESS) {
+				break;
+			}
+			n *= FAT_SECTOR_SIZE;
+		} else {
+			if (fat_FileLoad(file, sec, ((file->Pos - ofs) < file->Size) ? TRUE : FALSE) != SUCCESS) {
+				break;
+			}
+			n = FAT_SECTOR_SIZE - ofs;
+			if (n > (len - done)) {
+				n = len - done;
+			}
+			fat_Copy(&file->buf[ofs], buf + done, n);
+			file->bufdirty = TRUE;
+		}
+		done += n;
+		file->Pos += n;
+		if (file->Pos > file->Size) {
+			file->Size = file->Pos;
+		}
+		file->dirty = TRUE;
+	}
+	return done;
+}
+
+/*********************************************************************//**
+ * @brief		Move the read/write position
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @param[in]	pos		New position, at most the file size
+ * @return 		ERROR if pos is past the end of the file
+ **********************************************************************/
+Status FAT_Seek(FAT_FILE_Type *file, uint32_t pos)
+{
+	if (pos > file->Size) {
+		return ERROR;
+	}
+	file->Pos = pos;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Allocate the clusters for a file size ahead of the
+ * 				writes, as one run of contiguous clusters (following the
+ * 				chain when possible): appends within the preallocation
+ * 				touch neither the FAT nor the free cluster search, and go
+ * 				to the device as long multiple block writes. The file
+ * 				size is not changed; clusters still unused are freed by
+ * 				FAT_Close().
+ * @param[in]	file	point to FAT_FILE_Type structure, open for writing
+ * @param[in]	size	File size to allocate for (bytes)
+ * @return 		ERROR if no free run is long enough, or on device error
+ **********************************************************************/
+Status FAT_Preallocate(FAT_FILE_Type *file, uint32_t size)
+{
+	uint32_t need;
+
+	if (!(file->mode & FAT_MODE_WRITE)) {
+		return ERROR;
+	}
+	if (size == 0) {
+		return SUCCESS;
+	}
+	need = ((size - 1) >> file->vol->clshift) + 1;
+	if (file->clusters >= need) {
+		return SUCCESS;
+	}
+	return fat_Extend(file, need - file->clusters, TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Write everything the file has in memory to the device:
+ * 				partial sector, FAT window (every copy), FSInfo, then the
+ * 				directory entry (first cluster, size, date), then sync the
+ * 				device. Data and FAT are written before the entry that
+ * 				refers to them.
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status FAT_Sync(FAT_FILE_Type *file)
+{
+	FAT_VOLUME_Type *vol = file->vol;
+	uint32_t time;
+	uint8_t *e;
+
+	if ((fat_FileFlush(file) != SUCCESS) || (fat_WinFlush(vol) != SUCCESS)) {
+		return ERROR;
+	}
+	if (vol->infodirty && (vol->InfoSector != 0)) {
+		if (fat_BufLoad(vol, vol->InfoSector) != SUCCESS) {
+			return ERROR;
+		}
+		fat_St32(&vol->buf[FAT_FSI_FREECOUNT], vol->FreeCount);
+		fat_St32(&vol->buf[FAT_FSI_NXTFREE], vol->nextfree);
+		vol->bufdirty = TRUE;
+	}
+	vol->infodirty = FALSE;
+	if (file->dirty) {
+		if (fat_BufLoad(vol, file->dirsec) != SUCCESS) {
+			return ERROR;
+		}
+		e = &vol->buf[file->dirofs];
+		if (vol->Type == FAT_TYPE_FAT32) {
+			fat_St16(&e[FAT_DIR_CLUSHI], file->start >> 16);
+		}
+		fat_St16(&e[FAT_DIR_CLUSLO], file->start);
+		fat_St32(&e[FAT_DIR_FILESIZE], file->Size);
+		if (file->mode & FAT_MODE_WRITE) {
+			time = fat_Time(vol);
+			fat_St16(&e[FAT_DIR_WRTTIME], time);
+			fat_St16(&e[FAT_DIR_WRTTIME + 2], time >> 16);
+			e[FAT_DIR_ATTR] |= FAT_ATTR_ARCHIVE;
+		}
+		vol->bufdirty = TRUE;
+		file->dirty = FALSE;
+	}
+	if (fat_BufFlush(vol) != SUCCESS) {
+		return ERROR;
+	}
+	return BLK_Sync(vol->Dev);
+}
+
+/*********************************************************************//**
+ * @brief		Close a file: free the unused preallocated clusters, then
+ * 				FAT_Sync()
+ * @param[in]	file	point to FAT_FILE_Type structure
+ * @return 		SUCCESS or ERROR
+ **********************************************************************/
+Status FAT_Close(FAT_FILE_Type *file)
+{
+	Status ret = SUCCESS;
+
+	if ((file->mode & FAT_MODE_WRITE) && (fat_Trim(file) != SUCCESS)) {
+		ret = ERROR;
+	}
+	if (FAT_Sync(file) != SUCCESS) {
+		ret = ERROR;
+	}
+	file->mode = 0;
+	return ret;
+}
+
+/**
+ * @}
+ */
+
+#endif /* _FAT */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
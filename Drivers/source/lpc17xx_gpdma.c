@@ -352,6 +352,90 @@ Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig)
 	return SUCCESS;
 }
 
+/********************************************************************//**
+ * @brief 		Setup GPDMA channel to run a prepared Linker List Item
+ * 				chain, e.g. a circular chain for continuous streaming.
+ * 				The first transfer is loaded from the first LLI, so each
+ * 				LLI (including the first one) fully defines its addresses
+ * 				and Control value (transfer size, burst size, width,
+ * 				increment, terminal count interrupt).
+ * @param[in]	GPDMAChannelConfig Pointer to a GPDMA_CH_CFG_Type
+ * 									structure, only these fields are used:
+ * 									- ChannelNum
+ * 									- TransferType
+ * 									- SrcConn, DstConn
+ * 									- DMALLI: address of first LLI, must not be 0
+ * @return		ERROR if selected channel is enabled before
+ * 				or SUCCESS if channel is configured successfully
+ *********************************************************************/
+Status GPDMA_SetupLLI(GPDMA_Channel_CFG_Type *GPDMAChannelConfig)
+{
+	LPC_GPDMACH_TypeDef *pDMAch;
+	GPDMA_LLI_Type *pLLI;
+	uint32_t tmp1, tmp2;
+
+	if (LPC_GPDMA->DMACEnbldChns & (GPDMA_DMACEnbldChns_Ch(GPDMAChannelConfig->ChannelNum))) {
+		// This channel is enabled, return ERROR, need to release this channel first
+		return ERROR;
+	}
+
+	// Get Channel pointer
+	pDMAch = (LPC_GPDMACH_TypeDef *) pGPDMACh[GPDMAChannelConfig->ChannelNum];
+	pLLI = (GPDMA_LLI_Type *) GPDMAChannelConfig->DMALLI;
+
+	// Reset the Interrupt status
+	LPC_GPDMA->DMACIntTCClear = GPDMA_DMACIntTCClear_Ch(GPDMAChannelConfig->ChannelNum);
+	LPC_GPDMA->DMACIntErrClr = GPDMA_DMACIntErrClr_Ch(GPDMAChannelConfig->ChannelNum);
+
+	// Clear DMA configure
+	pDMAch->DMACCControl = 0x00;
+	pDMAch->DMACCConfig = 0x00;
+
+	/* Load first transfer from the first LLI */
+	pDMAch->DMACCSrcAddr = pLLI->SrcAddr;
+	pDMAch->DMACCDestAddr = pLLI->DstAddr;
+	pDMAch->DMACCLLI = pLLI->NextLLI;
+	pDMAch->DMACCControl = pLLI->Control;
+
+	/* Configure DMA Request Select for peripherals shared with timer match */
+	tmp1 = 0;
+	if (GPDMAChannelConfig->TransferType != GPDMA_TRANSFERTYPE_M2P) {
+		tmp1 = GPDMAChannelConfig->SrcConn;
+	}
+	tmp2 = 0;
+	if (GPDMAChannelConfig->TransferType != GPDMA_TRANSFERTYPE_P2M) {
+		tmp2 = GPDMAChannelConfig->DstConn;
+	}
+	if (GPDMAChannelConfig->TransferType != GPDMA_TRANSFERTYPE_M2M) {
+		if (tmp1 > 15) {
+			DMAREQSEL |= (1<<(tmp1 - 16));
+		} else if (tmp1 > 7) {
+			DMAREQSEL &= ~(1<<(tmp1 - 8));
+		}
+		if (tmp2 > 15) {
+			DMAREQSEL |= (1<<(tmp2 - 16));
+		} else if (tmp2 > 7) {
+			DMAREQSEL &= ~(1<<(tmp2 - 8));
+		}
+	}
+
+	/* Enable DMA channels, little endian */
+	LPC_GPDMA->DMACConfig = GPDMA_DMACConfig_E;
+	while (!(LPC_GPDMA->DMACConfig & GPDMA_DMACConfig_E));
+
+	// Calculate absolute value for Connection number
+	tmp1 = ((tmp1 > 15) ? (tmp1 - 8) : tmp1);
+	tmp2 = ((tmp2 > 15) ? (tmp2 - 8) : tmp2);
+
+	// Configure DMA Channel, enable Error Counter and Terminate counter
+	pDMAch->DMACCConfig = GPDMA_DMACCxConfig_IE | GPDMA_DMACCxConfig_ITC \
+		| GPDMA_DMACCxConfig_TransferType((uint32_t)GPDMAChannelConfig->TransferType) \
+		| GPDMA_DMACCxConfig_SrcPeripheral(tmp1) \
+		| GPDMA_DMACCxConfig_DestPeripheral(tmp2);
+
+	return SUCCESS;
+}
+
 
 /*********************************************************************//**
  * @brief		Enable/Disable DMA channel
@@ -374,6 +458,36 @@ void GPDMA_ChannelCmd(uint8_t channelNum, FunctionalState NewState)
 		pDMAch->DMACCConfig &= ~GPDMA_DMACCxConfig_E;
 	}
 }
+
+/*********************************************************************//**
+ * @brief		Get current source address of DMA channel, e.g. to know
+ * 				which block of a circular LLI chain is being transferred
+ * @param[in]	channelNum	GPDMA channel, should be in range from 0 to 7
+ * @return		Address of next source data
+ **********************************************************************/
+uint32_t GPDMA_GetSrcAddr(uint8_t channelNum)
+{
+	LPC_GPDMACH_TypeDef *pDMAch;
+
+	// Get Channel pointer
+	pDMAch = (LPC_GPDMACH_TypeDef *) pGPDMACh[channelNum];
+	return pDMAch->DMACCSrcAddr;
+}
+
+/*********************************************************************//**
+ * @brief		Get current destination address of DMA channel, e.g. to
+ * 				know which block of a circular LLI chain is being filled
+ * @param[in]	channelNum	GPDMA channel, should be in range from 0 to 7
+ * @return		Address of next destination data
+ **********************************************************************/
+uint32_t GPDMA_GetDstAddr(uint8_t channelNum)
+{
+	LPC_GPDMACH_TypeDef *pDMAch;
+
+	// Get Channel pointer
+	pDMAch = (LPC_GPDMACH_TypeDef *) pGPDMACh[channelNum];
+	return pDMAch->DMACCDestAddr;
+}
 /*********************************************************************//**
  * @brief		Check if corresponding channel does have an active interrupt
  * 				request or not
@@ -410,11 +524,11 @@ IntStatus GPDMA_IntGetStatus(GPDMA_Status_Type type, uint8_t channel)
 			return SET;
 		return RESET;
 	case GPDMA_STAT_RAWINTTC: //check status of the terminal count interrupt for DMA channels
-		if (LPC_GPDMA->DMACRawIntErrStat & GPDMA_DMACRawIntTCStat_Ch(channel))
+		if (LPC_GPDMA->DMACRawIntTCStat & GPDMA_DMACRawIntTCStat_Ch(channel))
 			return SET;
 		return RESET;
 	case GPDMA_STAT_RAWINTERR: //check status of the error interrupt for DMA channels
-		if (LPC_GPDMA->DMACRawIntTCStat & GPDMA_DMACRawIntErrStat_Ch(channel))
+		if (LPC_GPDMA->DMACRawIntErrStat & GPDMA_DMACRawIntErrStat_Ch(channel))
 			return SET;
 		return RESET;
 	default: //check enable status for DMA channels
@@ -63,6 +63,39 @@ typedef struct
   int32_t		dir;								/* Current direction phase, 0 - write, 1 - read */
 } I2C_CFG_T;
 
+/**
+ * @brief I2C bus manager queue type, the head is the running transaction
+ */
+typedef struct
+{
+  I2C_XFER_Type *head;								/* Running transaction, NULL if idle */
+  I2C_XFER_Type *tail;								/* Last queued transaction */
+} I2C_BUS_T;
+
+/**
+ * @brief I2C master interrupt action type, one action per I2STAT code
+ */
+typedef void (*I2C_M_ACTION_T)(LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+
+/**
+ * @brief I2C bus manager interrupt action type, one action per I2STAT code
+ */
+typedef void (*I2C_B_ACTION_T)(LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+
+/**
+ * @brief I2C master state: actions of one I2STAT code
+ */
+typedef struct
+{
+  I2C_M_ACTION_T	xfer;							/* I2C_MasterTransferData() action */
+  I2C_B_ACTION_T	bus;							/* Bus manager action */
+} I2C_M_STATE_T;
+
+/**
+ * @brief I2C slave interrupt action type, one action per I2STAT code
+ */
+typedef void (*I2C_S_ACTION_T)(LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+
 /**
  * @}
  */
@@ -78,6 +111,18 @@ static uint32_t I2C_SlaveComplete[3];
 
 static uint32_t I2C_MonitorBufferIndex;
 
+/**
+ * @brief I2C monitor capture ring for I2C0, I2C1 and I2C2
+ */
+static I2C_MON_RING_Type *i2cmon[3];
+
+#ifndef _I2C_SLAVE_ONLY
+/**
+ * @brief I2C bus manager queue for I2C0, I2C1 and I2C2
+ */
+static I2C_BUS_T i2cbus[3];
+#endif /* _I2C_SLAVE_ONLY */
+
 /* Private Functions ---------------------------------------------------------- */
 
 /* Get I2C number */
@@ -98,6 +143,52 @@ static uint32_t I2C_GetByte (LPC_I2C_TypeDef *I2Cx, uint8_t *retdat, Bool ack);
 /* I2C set clock (hz) */
 static void I2C_SetClock (LPC_I2C_TypeDef *I2Cx, uint32_t target_clock);
 
+#ifndef _I2C_SLAVE_ONLY
+/* Bus manager: end running transaction and start next one */
+static uint32_t I2C_BusLock (LPC_I2C_TypeDef *I2Cx);
+static void I2C_BusUnlock (LPC_I2C_TypeDef *I2Cx, uint32_t state);
+static uint32_t I2C_BusFirstSeg (I2C_XFER_Type *xfer);
+static void I2C_BusDone (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t status);
+
+/* Bus manager: interrupt handler part */
+
+/* Master interrupt actions */
+static void I2C_M_End (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_Retry (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_NextStage (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActNoInf (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActStart (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActTxAck (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActNack (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActArbLost (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActRxSlaAck (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActRxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_M_ActRxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_B_NextSeg (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_End (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActNoInf (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActStart (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActTxAck (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActTxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActNack (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActArbLost (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActRxSlaAck (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActRxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+static void I2C_B_ActRxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code);
+#endif /* _I2C_SLAVE_ONLY */
+
+#ifndef _I2C_MASTER_ONLY
+/* Slave interrupt actions */
+static void I2C_S_End (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActNoInf (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActAddrAck (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActRxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActRxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActStaSto (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActTxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+static void I2C_S_ActTxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num);
+#endif /* _I2C_MASTER_ONLY */
+
 /*--------------------------------------------------------------------------------*/
 /********************************************************************//**
  * @brief		Convert from I2C peripheral to number
@@ -240,6 +331,635 @@ static void I2C_SetClock (LPC_I2C_TypeDef *I2Cx, uint32_t target_clock)
 	I2Cx->I2SCLH = (uint32_t)(temp / 2);
 	I2Cx->I2SCLL = (uint32_t)(temp - I2Cx->I2SCLH);
 }
+
+#ifndef _I2C_SLAVE_ONLY
+/*********************************************************************//**
+ * @brief 		Bus manager: disable the I2Cx interrupt in the NVIC
+ * @param[in] 	I2Cx	I2C peripheral selected, should be:
+ * 				- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @return 		Previous state of the interrupt, for I2C_BusUnlock()
+ ***********************************************************************/
+static uint32_t I2C_BusLock (LPC_I2C_TypeDef *I2Cx)
+{
+	uint32_t irq = (uint32_t)I2C0_IRQn + I2C_getNum(I2Cx);
+	uint32_t state;
+
+	state = (NVIC->ISER[irq >> 5] >> (irq & 0x1F)) & 1;
+	I2C_IntCmd(I2Cx, FALSE);
+	return state;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus manager: restore the I2Cx interrupt state saved by
+ * 				I2C_BusLock(), it stays disabled if it was
+ * @param[in] 	I2Cx	I2C peripheral selected, should be:
+ * 				- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	state	Value returned by I2C_BusLock()
+ * @return 		None
+ ***********************************************************************/
+static void I2C_BusUnlock (LPC_I2C_TypeDef *I2Cx, uint32_t state)
+{
+	if (state){
+		I2C_IntCmd(I2Cx, TRUE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Bus manager: first segment of a transaction, read segments
+ * 				without data are skipped as they can not be done on the bus
+ * @param[in]	xfer	Transaction
+ * @return 		Segment index, seg_num if there is no segment to transfer
+ ***********************************************************************/
+static uint32_t I2C_BusFirstSeg (I2C_XFER_Type *xfer)
+{
+	uint32_t idx;
+
+	for (idx = 0; idx < xfer->seg_num; idx++){
+		if (((xfer->seg[idx].flags & I2C_SEG_READ) == 0) || (xfer->seg[idx].length != 0)){
+			break;
+		}
+	}
+	return idx;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus manager: end running transaction, then start the next
+ * 				queued one (STOP followed by START) or release the bus
+ * @param[in] 	I2Cx	I2C peripheral selected, should be:
+ * 				- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	bus		Bus manager queue of I2Cx
+ * @param[in]	status	Status to save in finished transaction
+ * @return 		None
+ ***********************************************************************/
+static void I2C_BusDone (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t status)
+{
+	I2C_XFER_Type *xfer = bus->head;
+	I2C_XFER_Type *next = xfer->next;
+
+	bus->head = next;
+	if (next == NULL){
+		bus->tail = NULL;
+		I2Cx->I2CONSET = I2C_I2CONSET_STO;
+	} else {
+		next->seg_idx = I2C_BusFirstSeg(next);
+		next->count = 0;
+		next->retransmissions_count = 0;
+		next->tick_left = next->timeout;
+		I2Cx->I2CONSET = I2C_I2CONSET_STO | I2C_I2CONSET_STA;
+	}
+	I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
+
+	xfer->next = NULL;
+	xfer->status = status;
+	if (xfer->callback != NULL){
+		xfer->callback(xfer);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: end of transfer, send stop condition
+ * @param[in]	I2Cx		I2C peripheral selected
+ * @param[in]	txrx_setup	Running master transfer setup
+ * @param[in]	num			I2C number: 0..2
+ * @return 		None
+ ***********************************************************************/
+static void I2C_M_End (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)txrx_setup;
+	// Disable interrupt
+	I2C_IntCmd(I2Cx, 0);
+	// Send stop
+	I2C_Stop(I2Cx);
+
+	I2C_MasterComplete[num] = TRUE;
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: restart whole transfer if retransmission
+ * 				is available, otherwise end of transfer
+ * @param[in]	I2Cx		I2C peripheral selected
+ * @param[in]	txrx_setup	Running master transfer setup
+ * @param[in]	num			I2C number: 0..2
+ * @return 		None
+ ***********************************************************************/
+static void I2C_M_Retry (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	if (txrx_setup->retransmissions_count < txrx_setup->retransmissions_max){
+		// Restart from transmit phase
+		txrx_setup->tx_count = 0;
+		txrx_setup->rx_count = 0;
+		i2cdat[num].dir = 0;
+		I2Cx->I2CONSET = I2C_I2CONSET_STA;
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
+		txrx_setup->retransmissions_count++;
+	} else {
+		I2C_M_End(I2Cx, txrx_setup, num);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: transmit phase is over, switch to receive
+ * 				phase (repeat start or SLA+R) or end of transfer
+ * @param[in]	I2Cx		I2C peripheral selected
+ * @param[in]	txrx_setup	Running master transfer setup
+ * @param[in]	num			I2C number: 0..2
+ * @return 		None
+ ***********************************************************************/
+static void I2C_M_NextStage (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	// change direction
+	i2cdat[num].dir = 1;
+	// Check if any data to receive
+	if ((txrx_setup->rx_length != 0) && (txrx_setup->rx_data != NULL)){
+		// check whether if we need to issue an repeat start
+		if ((txrx_setup->tx_length != 0) && (txrx_setup->tx_data != NULL)){
+			I2Cx->I2CONSET = I2C_I2CONSET_STA;
+			I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
+		} else {
+			// Send SLA+R
+			I2Cx->I2DAT = (txrx_setup->sl_addr7bit << 1) | 0x01;
+			I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+		}
+	} else {
+		// success, no more data
+		txrx_setup->status |= I2C_SETUP_STATUS_DONE;
+		I2C_M_End(I2Cx, txrx_setup, num);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: no relevant information
+ ***********************************************************************/
+static void I2C_M_ActNoInf (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)txrx_setup;
+	(void)num;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: a start/repeat start condition has been
+ * 				transmitted, send SLA+W or SLA+R depending on phase
+ ***********************************************************************/
+static void I2C_M_ActStart (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	I2Cx->I2CONCLR = I2C_I2CONCLR_STAC;
+	if (i2cdat[num].dir == 0){
+		if ((txrx_setup->tx_data != NULL) && (txrx_setup->tx_length != 0)){
+			I2Cx->I2DAT = (txrx_setup->sl_addr7bit << 1);
+			I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+		} else {
+			I2C_M_NextStage(I2Cx, txrx_setup, num);
+		}
+	} else {
+		if ((txrx_setup->rx_data != NULL) && (txrx_setup->rx_length != 0)){
+			I2Cx->I2DAT = (txrx_setup->sl_addr7bit << 1) | 0x01;
+			I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+		} else {
+			txrx_setup->status |= I2C_SETUP_STATUS_DONE;
+			I2C_M_End(I2Cx, txrx_setup, num);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: SLA+W or data has been transmitted, ACK
+ * 				has been received
+ ***********************************************************************/
+static void I2C_M_ActTxAck (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	if ((txrx_setup->tx_count < txrx_setup->tx_length) \
+			&& (txrx_setup->tx_data != NULL)){
+		I2Cx->I2DAT = *(uint8_t *)(txrx_setup->tx_data + txrx_setup->tx_count);
+		txrx_setup->tx_count++;
+		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+	} else {
+		I2C_M_NextStage(I2Cx, txrx_setup, num);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: SLA+R/W or data has been transmitted, NACK
+ * 				has been received
+ ***********************************************************************/
+static void I2C_M_ActNack (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	txrx_setup->status |= I2C_SETUP_STATUS_NOACKF;
+	I2C_M_Retry(I2Cx, txrx_setup, num);
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: arbitration lost
+ ***********************************************************************/
+static void I2C_M_ActArbLost (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	txrx_setup->status |= I2C_SETUP_STATUS_ARBF;
+	I2C_M_Retry(I2Cx, txrx_setup, num);
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: SLA+R has been transmitted, ACK has been
+ * 				received
+ ***********************************************************************/
+static void I2C_M_ActRxSlaAck (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)num;
+	if (txrx_setup->rx_count < (txrx_setup->rx_length - 1)) {
+		/*Data will be received,  ACK will be return*/
+		I2Cx->I2CONSET = I2C_I2CONSET_AA;
+	} else {
+		/*Last data will be received,  NACK will be return*/
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC;
+	}
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: data has been received, ACK has been
+ * 				returned
+ ***********************************************************************/
+static void I2C_M_ActRxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	if ((txrx_setup->rx_data != NULL) && (txrx_setup->rx_count < txrx_setup->rx_length)){
+		*(uint8_t *)(txrx_setup->rx_data + txrx_setup->rx_count) = (I2Cx->I2DAT & I2C_I2DAT_BITMASK);
+		txrx_setup->rx_count++;
+	}
+	I2C_M_ActRxSlaAck(I2Cx, txrx_setup, num);
+}
+
+/*********************************************************************//**
+ * @brief 		Master action: last data has been received, NACK has been
+ * 				returned
+ ***********************************************************************/
+static void I2C_M_ActRxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *txrx_setup, int32_t num)
+{
+	if ((txrx_setup->rx_data != NULL) && (txrx_setup->rx_count < txrx_setup->rx_length)){
+		*(uint8_t *)(txrx_setup->rx_data + txrx_setup->rx_count) = (I2Cx->I2DAT & I2C_I2DAT_BITMASK);
+		txrx_setup->rx_count++;
+	}
+	txrx_setup->status |= I2C_SETUP_STATUS_DONE;
+	I2C_M_End(I2Cx, txrx_setup, num);
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: the current segment is done, go on with the
+ * 				next one (repeat start) or end the transaction. Read
+ * 				segments without data are skipped, they can not be done
+ * 				on the bus
+ * @param[in]	I2Cx	I2C peripheral selected
+ * @param[in]	bus		Bus manager queue of I2Cx
+ * @param[in]	code	I2STAT status code
+ * @return 		None
+ ***********************************************************************/
+static void I2C_B_NextSeg (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+	I2C_SEG_Type *seg = &xfer->seg[xfer->seg_idx];
+
+	do {
+		xfer->seg_idx++;
+		seg++;
+	} while ((xfer->seg_idx < xfer->seg_num) \
+			&& (seg->flags & I2C_SEG_READ) && (seg->length == 0));
+
+	if (xfer->seg_idx < xfer->seg_num){
+		// Repeat start for next segment
+		xfer->count = 0;
+		I2Cx->I2CONSET = I2C_I2CONSET_STA;
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
+	} else {
+		I2C_BusDone(I2Cx, bus, code | I2C_SETUP_STATUS_DONE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: unexpected status, end of transaction
+ ***********************************************************************/
+static void I2C_B_End (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_BusDone(I2Cx, bus, code);
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: no relevant information, e.g. spurious or
+ * 				re-entered interrupt. The running transaction goes on.
+ * 				SI is clear with this status and is not written: the next
+ * 				event of the transaction may set it at any time
+ ***********************************************************************/
+static void I2C_B_ActNoInf (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	(void)I2Cx;
+	(void)bus;
+	(void)code;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: a start/repeat start condition has been
+ * 				transmitted, send SLA+R/W of the current segment
+ ***********************************************************************/
+static void I2C_B_ActStart (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+
+	(void)code;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_STAC;
+	I2Cx->I2DAT = (xfer->sl_addr7bit << 1) | (xfer->seg[xfer->seg_idx].flags & I2C_SEG_READ);
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: SLA+W or data has been transmitted, ACK has
+ * 				been received
+ ***********************************************************************/
+static void I2C_B_ActTxAck (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+	I2C_SEG_Type *seg = &xfer->seg[xfer->seg_idx];
+
+	if (xfer->count < seg->length){
+		I2Cx->I2DAT = seg->data[xfer->count++];
+		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+	} else {
+		I2C_B_NextSeg(I2Cx, bus, code);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: data has been transmitted, NACK has been
+ * 				received. Allowed on the last byte of a segment only
+ ***********************************************************************/
+static void I2C_B_ActTxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+
+	if (xfer->count >= xfer->seg[xfer->seg_idx].length){
+		I2C_B_NextSeg(I2Cx, bus, code);
+	} else {
+		I2C_BusDone(I2Cx, bus, code | I2C_SETUP_STATUS_NOACKF);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: SLA+R/W has been transmitted, NACK has been
+ * 				received
+ ***********************************************************************/
+static void I2C_B_ActNack (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_BusDone(I2Cx, bus, code | I2C_SETUP_STATUS_NOACKF);
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: arbitration lost, restart whole transaction
+ * 				when bus is free
+ ***********************************************************************/
+static void I2C_B_ActArbLost (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+
+	if (xfer->retransmissions_count < xfer->retransmissions_max){
+		xfer->retransmissions_count++;
+		xfer->seg_idx = I2C_BusFirstSeg(xfer);
+		xfer->count = 0;
+		I2Cx->I2CONSET = I2C_I2CONSET_STA;
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
+	} else {
+		I2C_BusDone(I2Cx, bus, code | I2C_SETUP_STATUS_ARBF);
+	}
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: SLA+R has been transmitted, ACK has been
+ * 				received
+ ***********************************************************************/
+static void I2C_B_ActRxSlaAck (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+
+	(void)code;
+	if (xfer->seg[xfer->seg_idx].length > 1){
+		I2Cx->I2CONSET = I2C_I2CONSET_AA;
+	} else {
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC;
+	}
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: data has been received, ACK has been returned
+ ***********************************************************************/
+static void I2C_B_ActRxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+	I2C_SEG_Type *seg = &xfer->seg[xfer->seg_idx];
+
+	(void)code;
+	seg->data[xfer->count++] = (uint8_t)(I2Cx->I2DAT & I2C_I2DAT_BITMASK);
+	if (xfer->count >= (seg->length - 1)){
+		/* Last data will be received, NACK will be returned */
+		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC;
+	}
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus action: last data has been received, NACK has been
+ * 				returned
+ ***********************************************************************/
+static void I2C_B_ActRxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_BUS_T *bus, uint32_t code)
+{
+	I2C_XFER_Type *xfer = bus->head;
+
+	xfer->seg[xfer->seg_idx].data[xfer->count++] = (uint8_t)(I2Cx->I2DAT & I2C_I2DAT_BITMASK);
+	I2C_B_NextSeg(I2Cx, bus, code);
+}
+
+/**
+ * @brief Master state/action table, indexed by (I2STAT >> 3): action of
+ * I2C_MasterTransferData() and action of the bus manager
+ */
+static const I2C_M_STATE_T I2C_MasterActTbl[32] = {
+	{ I2C_M_Retry,			I2C_B_End },			/* 0x00: bus error */
+	{ I2C_M_ActStart,		I2C_B_ActStart },		/* 0x08: start transmitted */
+	{ I2C_M_ActStart,		I2C_B_ActStart },		/* 0x10: repeat start transmitted */
+	{ I2C_M_ActTxAck,		I2C_B_ActTxAck },		/* 0x18: SLA+W transmitted, ACK */
+	{ I2C_M_ActNack,		I2C_B_ActNack },		/* 0x20: SLA+W transmitted, NACK */
+	{ I2C_M_ActTxAck,		I2C_B_ActTxAck },		/* 0x28: data transmitted, ACK */
+	{ I2C_M_ActNack,		I2C_B_ActTxDatNack },	/* 0x30: data transmitted, NACK */
+	{ I2C_M_ActArbLost,		I2C_B_ActArbLost },		/* 0x38: arbitration lost */
+	{ I2C_M_ActRxSlaAck,	I2C_B_ActRxSlaAck },	/* 0x40: SLA+R transmitted, ACK */
+	{ I2C_M_ActNack,		I2C_B_ActNack },		/* 0x48: SLA+R transmitted, NACK */
+	{ I2C_M_ActRxDatAck,	I2C_B_ActRxDatAck },	/* 0x50: data received, ACK returned */
+	{ I2C_M_ActRxDatNack,	I2C_B_ActRxDatNack },	/* 0x58: data received, NACK returned */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0x60 - 0x68: slave codes */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0x70 - 0x78 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0x80 - 0x88 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0x90 - 0x98 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0xA0 - 0xA8 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0xB0 - 0xB8 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0xC0 - 0xC8 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0xD0 - 0xD8 */
+	{ I2C_M_Retry, I2C_B_End }, { I2C_M_Retry, I2C_B_End },	/* 0xE0 - 0xE8 */
+	{ I2C_M_Retry, I2C_B_End },								/* 0xF0 */
+	{ I2C_M_ActNoInf,		I2C_B_ActNoInf }		/* 0xF8: no relevant information */
+};
+#endif /* _I2C_SLAVE_ONLY */
+
+#ifndef _I2C_MASTER_ONLY
+/*********************************************************************//**
+ * @brief 		Slave action: end of transfer
+ * @param[in]	I2Cx		I2C peripheral selected
+ * @param[in]	txrx_setup	Running slave transfer setup
+ * @param[in]	num			I2C number: 0..2
+ * @return 		None
+ ***********************************************************************/
+static void I2C_S_End (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)txrx_setup;
+	// Disable interrupt
+	I2C_IntCmd(I2Cx, 0);
+	I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC | I2C_I2CONCLR_STAC;
+	I2C_SlaveComplete[num] = TRUE;
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: no relevant information
+ ***********************************************************************/
+static void I2C_S_ActNoInf (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)txrx_setup;
+	(void)num;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: own SLA+W or general call address has been
+ * 				received, ACK has been returned
+ ***********************************************************************/
+static void I2C_S_ActAddrAck (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)txrx_setup;
+	(void)num;
+	I2Cx->I2CONSET = I2C_I2CONSET_AA;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: data has been received, ACK has been
+ * 				returned. Data that over-flow the receive length are
+ * 				ignored.
+ ***********************************************************************/
+static void I2C_S_ActRxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)num;
+	if ((txrx_setup->rx_count < txrx_setup->rx_length) \
+			&& (txrx_setup->rx_data != NULL)){
+		*(uint8_t *)(txrx_setup->rx_data + txrx_setup->rx_count) = (uint8_t)I2Cx->I2DAT;
+		txrx_setup->rx_count++;
+	}
+	I2Cx->I2CONSET = I2C_I2CONSET_AA;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: data has been received, NOT ACK has been
+ * 				returned
+ ***********************************************************************/
+static void I2C_S_ActRxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)txrx_setup;
+	(void)num;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: a stop or a repeat start condition.
+ * 				The status code does not tell one from the other, so wait
+ * 				for a time out: if the bus stays idle, this was a stop
+ * 				condition, otherwise the next session is handled.
+ ***********************************************************************/
+static void I2C_S_ActStaSto (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	uint32_t timeout;
+
+	// Temporally lock the interrupt for timeout condition
+	I2C_IntCmd(I2Cx, 0);
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+	// enable time out
+	timeout = I2C_SLAVE_TIME_OUT;
+	while (!(I2Cx->I2CONSET & I2C_I2CONSET_SI)){
+		if (--timeout == 0){
+			// timeout occur, it's really a stop condition
+			txrx_setup->status |= I2C_SETUP_STATUS_DONE;
+			I2C_S_End(I2Cx, txrx_setup, num);
+			return;
+		}
+	}
+	// re-Enable interrupt
+	I2C_IntCmd(I2Cx, 1);
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: own SLA+R has been received or data has been
+ * 				transmitted, ACK has been received
+ ***********************************************************************/
+static void I2C_S_ActTxDatAck (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	(void)num;
+	if ((txrx_setup->tx_count < txrx_setup->tx_length) \
+			&& (txrx_setup->tx_data != NULL)){
+		I2Cx->I2DAT = *(uint8_t *) (txrx_setup->tx_data + txrx_setup->tx_count);
+		txrx_setup->tx_count++;
+	}
+	I2Cx->I2CONSET = I2C_I2CONSET_AA;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief 		Slave action: data has been transmitted, NACK has been
+ * 				received, there's no more data to send.
+ * 				Note: Don't wait for stop event since in slave transmit
+ * 				mode there is no proof a stop has been received.
+ ***********************************************************************/
+static void I2C_S_ActTxDatNack (LPC_I2C_TypeDef *I2Cx, I2C_S_SETUP_Type *txrx_setup, int32_t num)
+{
+	I2Cx->I2CONSET = I2C_I2CONSET_AA;
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+	txrx_setup->status |= I2C_SETUP_STATUS_DONE;
+	I2C_S_End(I2Cx, txrx_setup, num);
+}
+
+/**
+ * @brief Slave state/action table, indexed by (I2STAT >> 3)
+ */
+static const I2C_S_ACTION_T I2C_SlaveActTbl[32] = {
+	I2C_S_End, I2C_S_End, I2C_S_End, I2C_S_End,				/* 0x00 - 0x18: master codes */
+	I2C_S_End, I2C_S_End, I2C_S_End, I2C_S_End,				/* 0x20 - 0x38 */
+	I2C_S_End, I2C_S_End, I2C_S_End, I2C_S_End,				/* 0x40 - 0x58 */
+	I2C_S_ActAddrAck,		/* 0x60: own SLA+W received, ACK */
+	I2C_S_End,				/* 0x68: arbitration lost in SLA+R/W as master */
+	I2C_S_ActAddrAck,		/* 0x70: general call received, ACK */
+	I2C_S_End,				/* 0x78: arbitration lost in general call as master */
+	I2C_S_ActRxDatAck,		/* 0x80: data received (own SLA), ACK */
+	I2C_S_ActRxDatNack,		/* 0x88: data received (own SLA), NACK */
+	I2C_S_ActRxDatAck,		/* 0x90: data received (general call), ACK */
+	I2C_S_ActRxDatNack,		/* 0x98: data received (general call), NACK */
+	I2C_S_ActStaSto,		/* 0xA0: stop or repeat start received */
+	I2C_S_ActTxDatAck,		/* 0xA8: own SLA+R received, ACK */
+	I2C_S_End,				/* 0xB0: arbitration lost in SLA+R/W as master */
+	I2C_S_ActTxDatAck,		/* 0xB8: data transmitted, ACK */
+	I2C_S_ActTxDatNack,		/* 0xC0: data transmitted, NACK */
+	I2C_S_End, I2C_S_End, I2C_S_End,						/* 0xC8 - 0xD8 */
+	I2C_S_End, I2C_S_End, I2C_S_End,						/* 0xE0 - 0xF0 */
+	I2C_S_ActNoInf			/* 0xF8: no relevant information */
+};
+#endif /* _I2C_MASTER_ONLY */
+
 /* End of Private Functions --------------------------------------------------- */
 
 
@@ -402,6 +1122,7 @@ void I2C_IntCmd (LPC_I2C_TypeDef *I2Cx, Bool NewState)
 }
 
 
+#ifndef _I2C_SLAVE_ONLY
 /*********************************************************************//**
  * @brief 		General Master Interrupt handler for I2C peripheral
  * @param[in]	I2Cx	I2C peripheral selected, should be:
@@ -409,6 +1130,8 @@ void I2C_IntCmd (LPC_I2C_TypeDef *I2Cx, Bool NewState)
  * 				- LPC_I2C1
  * 				- LPC_I2C2
  * @return 		None
+ * Note: The status code is dispatched through I2C_MasterActTbl[], to
+ * the bus manager action while it has a running transaction
  **********************************************************************/
 void I2C_MasterHandler (LPC_I2C_TypeDef  *I2Cx)
 {
@@ -417,195 +1140,23 @@ void I2C_MasterHandler (LPC_I2C_TypeDef  *I2Cx)
 	I2C_M_SETUP_Type *txrx_setup;
 
 	tmp = I2C_getNum(I2Cx);
-	txrx_setup = (I2C_M_SETUP_Type *) i2cdat[tmp].txrx_setup;
-
 	returnCode = (I2Cx->I2STAT & I2C_STAT_CODE_BITMASK);
-	// Save current status
-	txrx_setup->status = returnCode;
-	// there's no relevant information
-	if (returnCode == I2C_I2STAT_NO_INF){
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		return;
-	}
 
-	/* ----------------------------- TRANSMIT PHASE --------------------------*/
-	if (i2cdat[tmp].dir == 0){
-		switch (returnCode)
-		{
-		/* A start/repeat start condition has been transmitted -------------------*/
-		case I2C_I2STAT_M_TX_START:
-		case I2C_I2STAT_M_TX_RESTART:
-			I2Cx->I2CONCLR = I2C_I2CONCLR_STAC;
-			/*
-			 * If there's any transmit data, then start to
-			 * send SLA+W right now, otherwise check whether if there's
-			 * any receive data for next state.
-			 */
-			if ((txrx_setup->tx_data != NULL) && (txrx_setup->tx_length != 0)){
-				I2Cx->I2DAT = (txrx_setup->sl_addr7bit << 1);
-				I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-			} else {
-				goto next_stage;
-			}
-			break;
-
-		/* SLA+W has been transmitted, ACK has been received ----------------------*/
-		case I2C_I2STAT_M_TX_SLAW_ACK:
-		/* Data has been transmitted, ACK has been received */
-		case I2C_I2STAT_M_TX_DAT_ACK:
-			/* Send more data */
-			if ((txrx_setup->tx_count < txrx_setup->tx_length) \
-					&& (txrx_setup->tx_data != NULL)){
-				I2Cx->I2DAT =  *(uint8_t *)(txrx_setup->tx_data + txrx_setup->tx_count);
-				txrx_setup->tx_count++;
-				I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-			}
-			// no more data, switch to next stage
-			else {
-next_stage:
-				// change direction
-				i2cdat[tmp].dir = 1;
-				// Check if any data to receive
-				if ((txrx_setup->rx_length != 0) && (txrx_setup->rx_data != NULL)){
-						// check whether if we need to issue an repeat start
-						if ((txrx_setup->tx_length != 0) && (txrx_setup->tx_data != NULL)){
-							// Send out an repeat start command
-							I2Cx->I2CONSET = I2C_I2CONSET_STA;
-							I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
-						}
-						// Don't need issue an repeat start, just goto send SLA+R
-						else {
-							goto send_slar;
-						}
-				}
-				// no more data send, the go to end stage now
-				else {
-					// success, goto end stage
-					txrx_setup->status |= I2C_SETUP_STATUS_DONE;
-					goto end_stage;
-				}
-			}
-			break;
-
-		/* SLA+W has been transmitted, NACK has been received ----------------------*/
-		case I2C_I2STAT_M_TX_SLAW_NACK:
-		/* Data has been transmitted, NACK has been received -----------------------*/
-		case I2C_I2STAT_M_TX_DAT_NACK:
-			// update status
-			txrx_setup->status |= I2C_SETUP_STATUS_NOACKF;
-			goto retry;
-		/* Arbitration lost in SLA+R/W or Data bytes -------------------------------*/
-		case I2C_I2STAT_M_TX_ARB_LOST:
-			// update status
-			txrx_setup->status |= I2C_SETUP_STATUS_ARBF;
-		default:
-			goto retry;
-		}
+	// Bus manager has a running transaction
+	if (i2cbus[tmp].head != NULL){
+		I2C_MasterActTbl[returnCode >> 3].bus(I2Cx, &i2cbus[tmp], returnCode);
+		return;
 	}
 
-	/* ----------------------------- RECEIVE PHASE --------------------------*/
-	else if (i2cdat[tmp].dir == 1){
-		switch (returnCode){
-			/* A start/repeat start condition has been transmitted ---------------------*/
-		case I2C_I2STAT_M_RX_START:
-		case I2C_I2STAT_M_RX_RESTART:
-			I2Cx->I2CONCLR = I2C_I2CONCLR_STAC;
-			/*
-			 * If there's any receive data, then start to
-			 * send SLA+R right now, otherwise check whether if there's
-			 * any receive data for end of state.
-			 */
-			if ((txrx_setup->rx_data != NULL) && (txrx_setup->rx_length != 0)){
-send_slar:
-				I2Cx->I2DAT = (txrx_setup->sl_addr7bit << 1) | 0x01;
-				I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-			} else {
-				// Success, goto end stage
-				txrx_setup->status |= I2C_SETUP_STATUS_DONE;
-				goto end_stage;
-			}
-			break;
-
-		/* SLA+R has been transmitted, ACK has been received -----------------*/
-		case I2C_I2STAT_M_RX_SLAR_ACK:
-			if (txrx_setup->rx_count < (txrx_setup->rx_length - 1)) {
-				/*Data will be received,  ACK will be return*/
-				I2Cx->I2CONSET = I2C_I2CONSET_AA;
-			}
-			else {
-				/*Last data will be received,  NACK will be return*/
-				I2Cx->I2CONCLR = I2C_I2CONSET_AA;
-			}
-			I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-			break;
-
-		/* Data has been received, ACK has been returned ----------------------*/
-		case I2C_I2STAT_M_RX_DAT_ACK:
-			// Note save data and increase counter first, then check later
-			/* Save data  */
-			if ((txrx_setup->rx_data != NULL) && (txrx_setup->rx_count < txrx_setup->rx_length)){
-				*(uint8_t *)(txrx_setup->rx_data + txrx_setup->rx_count) = (I2Cx->I2DAT & I2C_I2DAT_BITMASK);
-				txrx_setup->rx_count++;
-			}
-			if (txrx_setup->rx_count < (txrx_setup->rx_length - 1)) {
-				/*Data will be received,  ACK will be return*/
-				I2Cx->I2CONSET = I2C_I2CONSET_AA;
-			}
-			else {
-				/*Last data will be received,  NACK will be return*/
-				I2Cx->I2CONCLR = I2C_I2CONSET_AA;
-			}
-
-			I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-			break;
+	txrx_setup = (I2C_M_SETUP_Type *) i2cdat[tmp].txrx_setup;
+	// Save current status
+	txrx_setup->status = returnCode;
 
-		/* Data has been received, NACK has been return -------------------------*/
-		case I2C_I2STAT_M_RX_DAT_NACK:
-			/* Save the last data */
-			if ((txrx_setup->rx_data != NULL) && (txrx_setup->rx_count < txrx_setup->rx_length)){
-				*(uint8_t *)(txrx_setup->rx_data + txrx_setup->rx_count) = (I2Cx->I2DAT & I2C_I2DAT_BITMASK);
-				txrx_setup->rx_count++;
-			}
-			// success, go to end stage
-			txrx_setup->status |= I2C_SETUP_STATUS_DONE;
-			goto end_stage;
-
-		/* SLA+R has been transmitted, NACK has been received ------------------*/
-		case I2C_I2STAT_M_RX_SLAR_NACK:
-			// update status
-			txrx_setup->status |= I2C_SETUP_STATUS_NOACKF;
-			goto retry;
-
-		/* Arbitration lost ----------------------------------------------------*/
-		case I2C_I2STAT_M_RX_ARB_LOST:
-			// update status
-			txrx_setup->status |= I2C_SETUP_STATUS_ARBF;
-		default:
-retry:
-			// check if retransmission is available
-			if (txrx_setup->retransmissions_count < txrx_setup->retransmissions_max){
-				// Clear tx count
-				txrx_setup->tx_count = 0;
-				I2Cx->I2CONSET = I2C_I2CONSET_STA;
-				I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC;
-				txrx_setup->retransmissions_count++;
-			}
-			// End of stage
-			else {
-end_stage:
-				// Disable interrupt
-				I2C_IntCmd(I2Cx, 0);
-				// Send stop
-				I2C_Stop(I2Cx);
-
-				I2C_MasterComplete[tmp] = TRUE;
-			}
-			break;
-		}
-	}
+	I2C_MasterActTbl[returnCode >> 3].xfer(I2Cx, txrx_setup, tmp);
 }
+#endif /* _I2C_SLAVE_ONLY */
 
-
+#ifndef _I2C_MASTER_ONLY
 /*********************************************************************//**
  * @brief 		General Slave Interrupt handler for I2C peripheral
  * @param[in]	I2Cx	I2C peripheral selected, should be:
@@ -613,13 +1164,13 @@ end_stage:
  *  			- LPC_I2C1
  *  			- LPC_I2C2
  * @return 		None
+ * Note: The status code is dispatched through I2C_SlaveActTbl[]
  **********************************************************************/
 void I2C_SlaveHandler (LPC_I2C_TypeDef  *I2Cx)
 {
 	int32_t tmp;
 	uint8_t returnCode;
 	I2C_S_SETUP_Type *txrx_setup;
-	uint32_t timeout;
 
 	tmp = I2C_getNum(I2Cx);
 	txrx_setup = (I2C_S_SETUP_Type *) i2cdat[tmp].txrx_setup;
@@ -627,131 +1178,10 @@ void I2C_SlaveHandler (LPC_I2C_TypeDef  *I2Cx)
 	returnCode = (I2Cx->I2STAT & I2C_STAT_CODE_BITMASK);
 	// Save current status
 	txrx_setup->status = returnCode;
-	// there's no relevant information
-	if (returnCode == I2C_I2STAT_NO_INF){
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		return;
-	}
-
-
-	switch (returnCode)
-	{
-
-	/* No status information */
-	case I2C_I2STAT_NO_INF:
-		I2Cx->I2CONSET = I2C_I2CONSET_AA;
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		break;
-
-	/* Reading phase -------------------------------------------------------- */
-	/* Own SLA+R has been received, ACK has been returned */
-	case I2C_I2STAT_S_RX_SLAW_ACK:
-	/* General call address has been received, ACK has been returned */
-	case I2C_I2STAT_S_RX_GENCALL_ACK:
-		I2Cx->I2CONSET = I2C_I2CONSET_AA;
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		break;
-
-	/* Previously addressed with own SLA;
-	 * DATA byte has been received;
-	 * ACK has been returned */
-	case I2C_I2STAT_S_RX_PRE_SLA_DAT_ACK:
-	/* DATA has been received, ACK hasn been return */
-	case I2C_I2STAT_S_RX_PRE_GENCALL_DAT_ACK:
-		/*
-		 * All data bytes that over-flow the specified receive
-		 * data length, just ignore them.
-		 */
-		if ((txrx_setup->rx_count < txrx_setup->rx_length) \
-				&& (txrx_setup->rx_data != NULL)){
-			*(uint8_t *)(txrx_setup->rx_data + txrx_setup->rx_count) = (uint8_t)I2Cx->I2DAT;
-			txrx_setup->rx_count++;
-		}
-		I2Cx->I2CONSET = I2C_I2CONSET_AA;
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		break;
-
-	/* Previously addressed with own SLA;
-	 * DATA byte has been received;
-	 * NOT ACK has been returned */
-	case I2C_I2STAT_S_RX_PRE_SLA_DAT_NACK:
-	/* DATA has been received, NOT ACK has been returned */
-	case I2C_I2STAT_S_RX_PRE_GENCALL_DAT_NACK:
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		break;
-
-	/*
-	 * Note that: Return code only let us know a stop condition mixed
-	 * with a repeat start condition in the same code value.
-	 * So we should provide a time-out. In case this is really a stop
-	 * condition, this will return back after time out condition. Otherwise,
-	 * next session that is slave receive data will be completed.
-	 */
-
-	/* A Stop or a repeat start condition */
-	case I2C_I2STAT_S_RX_STA_STO_SLVREC_SLVTRX:
-		// Temporally lock the interrupt for timeout condition
-		I2C_IntCmd(I2Cx, 0);
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		// enable time out
-		timeout = I2C_SLAVE_TIME_OUT;
-		while(1){
-			if (I2Cx->I2CONSET & I2C_I2CONSET_SI){
-				// re-Enable interrupt
-				I2C_IntCmd(I2Cx, 1);
-				break;
-			} else {
-				timeout--;
-				if (timeout == 0){
-					// timeout occur, it's really a stop condition
-					txrx_setup->status |= I2C_SETUP_STATUS_DONE;
-					goto s_int_end;
-				}
-			}
-		}
-		break;
-
-	/* Writing phase -------------------------------------------------------- */
-	/* Own SLA+R has been received, ACK has been returned */
-	case I2C_I2STAT_S_TX_SLAR_ACK:
-	/* Data has been transmitted, ACK has been received */
-	case I2C_I2STAT_S_TX_DAT_ACK:
-		/*
-		 * All data bytes that over-flow the specified receive
-		 * data length, just ignore them.
-		 */
-		if ((txrx_setup->tx_count < txrx_setup->tx_length) \
-				&& (txrx_setup->tx_data != NULL)){
-			I2Cx->I2DAT = *(uint8_t *) (txrx_setup->tx_data + txrx_setup->tx_count);
-			txrx_setup->tx_count++;
-		}
-		I2Cx->I2CONSET = I2C_I2CONSET_AA;
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		break;
 
-	/* Data has been transmitted, NACK has been received,
-	 * that means there's no more data to send, exit now */
-	/*
-	 * Note: Don't wait for stop event since in slave transmit mode,
-	 * since there no proof lets us know when a stop signal has been received
-	 * on slave side.
-	 */
-	case I2C_I2STAT_S_TX_DAT_NACK:
-		I2Cx->I2CONSET = I2C_I2CONSET_AA;
-		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
-		txrx_setup->status |= I2C_SETUP_STATUS_DONE;
-		goto s_int_end;
-
-	// Other status must be captured
-	default:
-s_int_end:
-		// Disable interrupt
-		I2C_IntCmd(I2Cx, 0);
-		I2Cx->I2CONCLR = I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC | I2C_I2CONCLR_STAC;
-		I2C_SlaveComplete[tmp] = TRUE;
-		break;
-	}
+	I2C_SlaveActTbl[returnCode >> 3](I2Cx, txrx_setup, tmp);
 }
+#endif /* _I2C_MASTER_ONLY */
 
 /*********************************************************************//**
  * @brief 		Transmit and Receive data in master mode
@@ -956,6 +1386,125 @@ error:
 	return ERROR;
 }
 
+#ifndef _I2C_SLAVE_ONLY
+/*********************************************************************//**
+ * @brief 		Queue a transaction on the I2C bus manager. Transactions
+ * 				are run in order and advanced entirely from
+ * 				I2C_MasterHandler(), the callback of each transaction is
+ * 				called from interrupt when it is finished.
+ * @param[in]	I2Cx	I2C peripheral selected, should be:
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	xfer	Pointer to a I2C_XFER_Type structure that describes
+ * 						the transaction. It must stay valid until its
+ * 						callback has been called.
+ * @return 		SUCCESS or ERROR (no segment to transfer: no segment, or
+ * 				only read segments of length 0)
+ *
+ * Note:
+ * - The application must call I2C_MasterHandler() from the I2Cx interrupt
+ * handler. I2C_MasterTransferData() must not be used on the same bus while
+ * the bus manager is not idle.
+ * - The I2Cx interrupt is enabled when the transaction starts on an idle
+ * queue, it may have been disabled by an I2C_MasterTransferData() in
+ * interrupt mode.
+ * - A combined write-read transaction is made of one write segment then one
+ * read segment, they are separated by a repeated start.
+ * - I2C_BusTick() must be called periodically if time out is used.
+ **********************************************************************/
+Status I2C_BusSubmit(LPC_I2C_TypeDef *I2Cx, I2C_XFER_Type *xfer)
+{
+	I2C_BUS_T *bus;
+	int32_t tmp;
+	uint32_t state;
+
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+
+	if ((xfer->seg_num == 0) || (xfer->seg == NULL)){
+		return ERROR;
+	}
+	xfer->seg_idx = I2C_BusFirstSeg(xfer);
+	if (xfer->seg_idx >= xfer->seg_num){
+		return ERROR;
+	}
+
+	tmp = I2C_getNum(I2Cx);
+	bus = &i2cbus[tmp];
+
+	xfer->next = NULL;
+	xfer->status = 0;
+	xfer->count = 0;
+	xfer->retransmissions_count = 0;
+	xfer->tick_left = xfer->timeout;
+
+	state = I2C_BusLock(I2Cx);
+	if (bus->head == NULL){
+		bus->head = xfer;
+		bus->tail = xfer;
+		/* Start condition -------------------------------------------------------------- */
+		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+		I2Cx->I2CONSET = I2C_I2CONSET_STA;
+		/* Queue was idle: the interrupt runs the transaction */
+		state = 1;
+	} else {
+		bus->tail->next = xfer;
+		bus->tail = xfer;
+	}
+	I2C_BusUnlock(I2Cx, state);
+
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief 		Bus manager time base, should be called periodically
+ * 				(e.g. from a 1ms timer interrupt). When the time out of the
+ * 				running transaction expires, a stop condition is issued,
+ * 				the transaction ends with I2C_SETUP_STATUS_TIMEOUT and the
+ * 				next queued one is started.
+ * @param[in]	I2Cx	I2C peripheral selected, should be:
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @return 		None
+ **********************************************************************/
+void I2C_BusTick(LPC_I2C_TypeDef *I2Cx)
+{
+	I2C_BUS_T *bus;
+	I2C_XFER_Type *xfer;
+	uint32_t state;
+
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+
+	bus = &i2cbus[I2C_getNum(I2Cx)];
+
+	state = I2C_BusLock(I2Cx);
+	xfer = bus->head;
+	if ((xfer != NULL) && (xfer->timeout != 0)){
+		if (--xfer->tick_left == 0){
+			I2C_BusDone(I2Cx, bus, (I2Cx->I2STAT & I2C_STAT_CODE_BITMASK) \
+							| I2C_SETUP_STATUS_TIMEOUT);
+		}
+	}
+	I2C_BusUnlock(I2Cx, state);
+}
+
+/*********************************************************************//**
+ * @brief 		Get bus manager state
+ * @param[in]	I2Cx	I2C peripheral selected, should be:
+ *  			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @return 		SET if no transaction is running or queued, otherwise RESET
+ **********************************************************************/
+FlagStatus I2C_BusIdle(LPC_I2C_TypeDef *I2Cx)
+{
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+
+	return ((i2cbus[I2C_getNum(I2Cx)].head == NULL) ? SET : RESET);
+}
+#endif /* _I2C_SLAVE_ONLY */
+
 /*********************************************************************//**
  * @brief 		Receive and Transmit data in slave mode
  * @param[in]	I2Cx			I2C peripheral selected, should be
@@ -1329,6 +1878,107 @@ BOOL_8 I2C_MonitorHandler(LPC_I2C_TypeDef *I2Cx, uint8_t *buffer, uint32_t size)
 	}
 	return ret;
 }
+
+/*********************************************************************//**
+ * @brief		Attach a capture ring to I2C monitor mode. After that,
+ * 				I2C_MonitorRingHandler() records every byte seen on the bus
+ * 				with its I2STAT code and a time stamp, without ever stopping.
+ * @param[in]	I2Cx	I2C peripheral selected, should be
+ *    			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @param[in]	ring	Pointer to ring control structure
+ * @param[in]	buf		Pointer to event buffer
+ * @param[in]	size	Number of events in buffer, must be a power of 2
+ * @param[in]	timer	Pointer to a free running counter used as time stamp,
+ * 						e.g. &LPC_TIM0->TC. NULL: time stamp is always 0
+ * @return		None
+ **********************************************************************/
+void I2C_MonitorRingInit(LPC_I2C_TypeDef *I2Cx, I2C_MON_RING_Type *ring, \
+		I2C_MON_EVENT_Type *buf, uint32_t size, __IO uint32_t *timer)
+{
+	CHECK_PARAM(PARAM_I2Cx(I2Cx));
+	CHECK_PARAM((size != 0) && ((size & (size - 1)) == 0));
+
+	ring->buf = buf;
+	ring->mask = size - 1;
+	ring->timer = timer;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->seq = 0;
+	ring->overrun = 0;
+	i2cmon[I2C_getNum(I2Cx)] = ring;
+}
+
+/*********************************************************************//**
+ * @brief		Monitor mode interrupt handler for capture ring, should be
+ * 				called from I2Cx interrupt handler after
+ * 				I2C_MonitorRingInit() and I2C_MonitorModeCmd().
+ * @param[in]	I2Cx	I2C peripheral selected, should be
+ *    			- LPC_I2C0
+ * 				- LPC_I2C1
+ * 				- LPC_I2C2
+ * @return		None
+ * Note:	When the ring is full the event is dropped and counted in
+ * overrun, the sequence number still advances so the host sees the gap.
+ **********************************************************************/
+void I2C_MonitorRingHandler(LPC_I2C_TypeDef *I2Cx)
+{
+	I2C_MON_RING_Type *ring = i2cmon[I2C_getNum(I2Cx)];
+	I2C_MON_EVENT_Type *evt;
+	uint32_t time;
+	uint32_t head;
+
+	if (ring == NULL){
+		I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+		return;
+	}
+	time = (ring->timer != NULL) ? *ring->timer : 0;
+	head = ring->head;
+	if ((head - ring->tail) <= ring->mask){
+		evt = &ring->buf[head & ring->mask];
+		evt->time = time;
+		evt->data = (uint8_t)(I2Cx->I2DATA_BUFFER);
+		evt->stat = (uint8_t)(I2Cx->I2STAT & I2C_STAT_CODE_BITMASK);
+		evt->seq = (uint16_t) ring->seq;
+		/* Event is written before the reader sees the new head */
+		__DMB();
+		ring->head = head + 1;
+	} else {
+		ring->overrun++;
+	}
+	ring->seq++;
+
+	I2Cx->I2CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/*********************************************************************//**
+ * @brief		Read events from I2C monitor capture ring
+ * @param[in]	ring	Pointer to ring control structure
+ * @param[out]	buf		Pointer to buffer to store events
+ * @param[in]	len		Max number of events to read
+ * @return		Number of events read
+ **********************************************************************/
+uint32_t I2C_MonitorRingRead(I2C_MON_RING_Type *ring, I2C_MON_EVENT_Type *buf, uint32_t len)
+{
+	uint32_t tail = ring->tail;
+	uint32_t num;
+	uint32_t i;
+
+	num = ring->head - tail;
+	if (num > len){
+		num = len;
+	}
+	/* Events are read after the head, and before the slots are freed */
+	__DMB();
+	for (i = 0; i < num; i++){
+		buf[i] = ring->buf[(tail + i) & ring->mask];
+	}
+	__DMB();
+	ring->tail = tail + num;
+	return num;
+}
+
 /*********************************************************************//**
  * @brief 		Get status of Master Transfer
  * @param[in]	I2Cx	I2C peripheral selected, should be:
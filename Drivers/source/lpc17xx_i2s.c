@@ -32,6 +32,7 @@
 /* Includes ------------------------------------------------------------------- */
 #include "lpc17xx_i2s.h"
 #include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
 
 
 /* If this source file built with example, the LPC17xx FW library configuration
@@ -50,7 +51,7 @@
 /* Private Functions ---------------------------------------------------------- */
 
 static uint8_t i2s_GetWordWidth(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode);
-static uint8_t i2s_GetChannel(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode);
+static void i2s_ClkBracket(I2S_CLKTRACK_Type *track, uint32_t target);
 
 /********************************************************************//**
  * @brief		Get I2S wordwidth value
@@ -82,26 +83,37 @@ static uint8_t i2s_GetWordWidth(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode) {
 }
 
 /********************************************************************//**
- * @brief		Get I2S channel value
- * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
- * @param[in]	TRMode is the I2S mode, should be:
- * 				- I2S_TX_MODE = 0: transmit mode
- * 				- I2S_RX_MODE = 1: receive mode
- * @return 		The channel value, should be: 1(mono) or 2(stereo)
+ * @brief		Find the fractional divider settings closest to a ratio,
+ * 				one below (or equal) and one above (or equal)
+ * @param[in]	track	point to I2S_CLKTRACK_Type structure
+ * @param[in]	target	X/Y ratio, Q31, up to 1
+ * @return 		none
  *********************************************************************/
-static uint8_t i2s_GetChannel(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode) {
-	uint8_t value;
-
-	CHECK_PARAM(PARAM_I2Sx(I2Sx));
-	CHECK_PARAM(PARAM_I2S_TRX(TRMode));
-
-	if (TRMode == I2S_TX_MODE) {
-		value = ((I2Sx->I2SDAO) & 0x04)>>2; /* get bit[2] */
-	} else {
-		value = ((I2Sx->I2SDAI) & 0x04)>>2; /* get bit[2] */
+static void i2s_ClkBracket(I2S_CLKTRACK_Type *track, uint32_t target)
+{
+	uint32_t x, y, lx, ly, hx, hy;
+
+	lx = 0; ly = 1;
+	hx = 1; hy = 1;
+	for (y = 1; y <= 255; y++) {
+		x = (uint32_t)(((uint64_t)target * y) >> 31);
+		if ((x >= 1) && (x <= y) && ((x * ly) > (lx * y))) {
+			lx = x; ly = y;
+		}
+		if (((uint64_t)x << 31) != ((uint64_t)target * y)) {
+			x++;
+		}
+		if ((x >= 1) && (x <= y) && ((x * hy) < (hx * y))) {
+			hx = x; hy = y;
+		}
 	}
-        if(value == I2S_MONO) return 1;
-          return 2;
+	if (lx == 0) {
+		lx = hx; ly = hy;
+	}
+	track->lo_x = lx; track->lo_y = ly;
+	track->hi_x = hx; track->hi_y = hy;
+	track->lo = (uint32_t)(((uint64_t)lx << 31) / ly);
+	track->hi = (uint32_t)(((uint64_t)hx << 31) / hy);
 }
 
 /* End of Private Functions --------------------------------------------------- */
@@ -307,10 +319,13 @@ void I2S_Stop(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode) {
 }
 
 /********************************************************************//**
- * @brief		Set frequency for I2S
+ * @brief		Set frequency for I2S. Only the rate and bit rate
+ * 				registers of the selected direction are written: the
+ * 				other direction keeps its rate (previous versions reset
+ * 				both I2STXRATE and I2SRXRATE)
  * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
  * @param[in]	Freq is the frequency for I2S will be set. It can range
- * 				from 16-96 kHz(16, 22.05, 32, 44.1, 48, 96kHz)
+ * 				from 8-96 kHz(8, 11.025, 16, 22.05, 32, 44.1, 48, 96kHz)
  * @param[in]	TRMode is transmit/receive mode, should be:
  * 				- I2S_TX_MODE = 0: transmit mode
  * 				- I2S_RX_MODE = 1: receive mode
@@ -318,36 +333,190 @@ void I2S_Stop(LPC_I2S_TypeDef *I2Sx, uint8_t TRMode) {
  *********************************************************************/
 Status I2S_FreqConfig(LPC_I2S_TypeDef *I2Sx, uint32_t Freq, uint8_t TRMode) {
 
-	uint32_t i2sMclk;
-	uint8_t bitrate, channel, wordwidth;
+	I2S_CLKPLAN_Type plan;
 
 	CHECK_PARAM(PARAM_I2Sx(I2Sx));
 	CHECK_PARAM(PRAM_I2S_FREQ(Freq));
 	CHECK_PARAM(PARAM_I2S_TRX(TRMode));
 
-	//set i2s reference is i2s_pclk/2 as default
-	i2sMclk = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_I2S)/2;
-	I2Sx->I2STXRATE = 1  | (1<<8);
-	I2Sx->I2SRXRATE = 1  | (1<<8);
-	if(TRMode == I2S_TX_MODE)
-	{
-		channel = i2s_GetChannel(I2Sx,I2S_TX_MODE);
-		wordwidth = i2s_GetWordWidth(I2Sx,I2S_TX_MODE);
+	// Plan on the current I2S PCLK, word width already configured
+	plan.Cclk = SystemCoreClock;
+	plan.Freq = Freq;
+	plan.MclkRatio = 0;
+	plan.WordWidth = i2s_GetWordWidth(I2Sx, TRMode);
+	plan.PclkDiv = CLKPWR_GetPCLKSEL(CLKPWR_PCLKSEL_I2S);
+	if (I2S_ClkPlan(&plan) != SUCCESS) {
+		return ERROR;
 	}
-	else
-	{
-		channel = i2s_GetChannel(I2Sx,I2S_RX_MODE);
-		wordwidth = i2s_GetWordWidth(I2Sx,I2S_RX_MODE);
+	I2S_ClkPlanApply(I2Sx, &plan, TRMode);
+	return SUCCESS;
+}
+
+/********************************************************************//**
+ * @brief		Plan the I2S clock for a sample rate: all PCLK dividers
+ * 				(or the given one), bit rate dividers and fractional
+ * 				dividers X/Y (X <= Y <= 255) are enumerated and the setting
+ * 				with the smallest rate error is kept. The search does not
+ * 				touch the hardware, so it can also run on a host to build
+ * 				constant plans offline.
+ * @param[in]	plan	point to I2S_CLKPLAN_Type structure, configuration
+ * 				fields must be filled. Result fields are filled.
+ * @return 		ERROR if no setting exists (e.g. MclkRatio not a multiple
+ * 				of the frame size), otherwise SUCCESS
+ *********************************************************************/
+Status I2S_ClkPlan(I2S_CLKPLAN_Type *plan)
+{
+	/* PCLK dividers in PCLKSEL order: 4, 1, 2, 8 */
+	const uint8_t div[4] = {4, 1, 2, 8};
+	uint64_t k, d, err, best_err, best_d;
+	uint32_t sel, want, pclk, fbits, br, x, y;
+	Bool found = FALSE;
+
+	CHECK_PARAM(PARAM_I2S_PLAN_FREQ(plan->Freq));
+	CHECK_PARAM(PARAM_I2S_PLAN_WIDTH(plan->WordWidth));
+
+	fbits = 2 * plan->WordWidth;
+	want = plan->PclkDiv;
+	best_err = 1;
+	best_d = 0;
+	for (sel = 0; sel < 4; sel++) {
+		if ((want != I2S_CLKPLAN_ANY_PCLK) && (want != sel)) {
+			continue;
+		}
+		pclk = plan->Cclk / div[sel];
+		for (br = 0; br < 64; br++) {
+			if ((plan->MclkRatio != 0) && (plan->MclkRatio != ((br + 1) * fbits))) {
+				continue;
+			}
+			// X/Y = k / pclk must not exceed 1
+			k = 2 * (uint64_t)(br + 1) * fbits * plan->Freq;
+			if (k > pclk) {
+				break;
+			}
+			for (y = 1; y <= 255; y++) {
+				d = k * y;
+				x = (uint32_t)((d + (pclk / 2)) / pclk);
+				if ((x == 0) || (x > y)) {
+					continue;
+				}
+				err = ((uint64_t)pclk * x > d) ? ((uint64_t)pclk * x - d) : (d - (uint64_t)pclk * x);
+				// Relative error err / d smaller than best_err / best_d
+				if ((found == FALSE) || ((err * best_d) < (best_err * d))) {
+					found = TRUE;
+					best_err = err;
+					best_d = d;
+					plan->PclkDiv = sel;
+					plan->X = x;
+					plan->Y = y;
+					plan->BitRate = br;
+					plan->Ppb = (int32_t)(((int64_t)pclk * x - (int64_t)d) * 1000000000LL / (int64_t)d);
+				}
+			}
+		}
 	}
-	bitrate = i2sMclk/(Freq * channel * wordwidth) - 1;
-	if (TRMode == I2S_TX_MODE)// Transmitter
-	{
-		I2Sx->I2STXBITRATE = bitrate;
-	} else //Receiver
-	{
-		I2Sx->I2SRXBITRATE = bitrate;
+	return (found == TRUE) ? SUCCESS : ERROR;
+}
+
+/********************************************************************//**
+ * @brief		Apply an I2S clock plan: I2S PCLK divider (shared by TX
+ * 				and RX), fractional rate and bit rate dividers
+ * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
+ * @param[in]	plan	point to I2S_CLKPLAN_Type structure, from
+ * 				I2S_ClkPlan() or a constant plan built offline
+ * @param[in]	TRMode is transmit/receive mode, should be:
+ * 				- I2S_TX_MODE = 0: transmit mode
+ * 				- I2S_RX_MODE = 1: receive mode
+ * @return 		none
+ *********************************************************************/
+void I2S_ClkPlanApply(LPC_I2S_TypeDef *I2Sx, const I2S_CLKPLAN_Type *plan, uint8_t TRMode)
+{
+	CHECK_PARAM(PARAM_I2Sx(I2Sx));
+	CHECK_PARAM(PARAM_I2S_TRX(TRMode));
+
+	CLKPWR_SetPCLKDiv(CLKPWR_PCLKSEL_I2S, plan->PclkDiv);
+	if (TRMode == I2S_TX_MODE) {
+		I2Sx->I2STXRATE = plan->Y | (plan->X << 8);
+		I2Sx->I2STXBITRATE = plan->BitRate;
+	} else {
+		I2Sx->I2SRXRATE = plan->Y | (plan->X << 8);
+		I2Sx->I2SRXBITRATE = plan->BitRate;
+	}
+}
+
+/********************************************************************//**
+ * @brief		Initialize I2S clock tracking around a plan, which must be
+ * 				applied before
+ * @param[in]	track	point to I2S_CLKTRACK_Type structure, configuration
+ * 				fields must be filled
+ * @param[in]	plan	point to the applied I2S_CLKPLAN_Type structure
+ * @return 		none
+ *********************************************************************/
+void I2S_ClkTrackInit(I2S_CLKTRACK_Type *track, const I2S_CLKPLAN_Type *plan)
+{
+	CHECK_PARAM(PARAM_I2S_TRX(track->TRMode));
+
+	track->base = (uint32_t)(((uint64_t)plan->X << 31) / plan->Y);
+	track->lo_x = track->hi_x = plan->X;
+	track->lo_y = track->hi_y = plan->Y;
+	track->lo = track->hi = track->base;
+	track->acc = 0;
+	track->Ppb = 0;
+	track->updates = 0;
+	track->rejected = 0;
+}
+
+/********************************************************************//**
+ * @brief		Take one reference measurement and nudge the fractional
+ * 				rate divider. Should be called at a regular interval with
+ * 				the timer ticks counted over a number of reference periods
+ * 				(difference of two captures).
+ * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
+ * @param[in]	track	point to I2S_CLKTRACK_Type structure
+ * @param[in]	periods	number of reference periods measured
+ * @param[in]	ticks	timer ticks counted over these periods
+ * @return 		none
+ *********************************************************************/
+void I2S_ClkTrackUpdate(LPC_I2S_TypeDef *I2Sx, I2S_CLKTRACK_Type *track,
+		uint32_t periods, uint32_t ticks)
+{
+	int64_t num, den;
+	int32_t meas;
+	uint32_t target, rate;
+
+	CHECK_PARAM(PARAM_I2Sx(I2Sx));
+
+	// Less ticks than expected: local clock slower than the reference
+	num = ((int64_t)periods * track->TimerHz) - ((int64_t)ticks * track->RefHz);
+	den = (int64_t)ticks * track->RefHz;
+	if ((den == 0) || (((num < 0) ? -num : num) * 1000 > den)) {
+		track->rejected++;
+		return;
+	}
+	meas = (int32_t)((num * 1000000000LL) / den);
+	track->Ppb += (meas - track->Ppb) / (1 << track->Shift);
+	track->updates++;
+
+	target = track->base + (int32_t)(((int64_t)track->base * track->Ppb) / 1000000000LL);
+	if (target > 0x80000000UL) {
+		target = 0x80000000UL;
+	}
+	if ((target < track->lo) || (target > track->hi)) {
+		i2s_ClkBracket(track, target);
+		track->acc = 0;
+	}
+	// Alternate between both settings, the average tracks the target
+	if (track->acc <= 0) {
+		rate = track->hi_y | (track->hi_x << 8);
+		track->acc += (int32_t)(track->hi - target);
+	} else {
+		rate = track->lo_y | (track->lo_x << 8);
+		track->acc += (int32_t)(track->lo - target);
+	}
+	if (track->TRMode == I2S_TX_MODE) {
+		I2Sx->I2STXRATE = rate;
+	} else {
+		I2Sx->I2SRXRATE = rate;
 	}
-	return SUCCESS;
 }
 
 /********************************************************************//**
@@ -587,6 +756,305 @@ uint8_t I2S_GetIRQDepth(LPC_I2S_TypeDef *I2Sx,uint8_t TRMode)
 	else
 		return (((I2Sx->I2SIRQ)>>8)&0xFF);
 }
+
+/********************************************************************//**
+ * @brief		Convert 16-bit stereo frames to interleaved q31 samples
+ * @param[in]	src		frames, left channel in the low half-word
+ * @param[out]	dst		2 * frames samples: L, R, L, R...
+ * @param[in]	frames	number of frames
+ * @return 		none
+ *********************************************************************/
+void I2S_ConvertToQ31(const uint32_t *src, int32_t *dst, uint32_t frames)
+{
+	uint32_t w;
+
+	while (frames--) {
+		w = *src++;
+		*dst++ = (int32_t)(w << 16);
+		*dst++ = (int32_t)(w & 0xFFFF0000);
+	}
+}
+
+/********************************************************************//**
+ * @brief		Convert interleaved q31 samples to 16-bit stereo frames,
+ * 				with rounding and saturation
+ * @param[in]	src		2 * frames samples: L, R, L, R...
+ * @param[out]	dst		frames, left channel in the low half-word
+ * @param[in]	frames	number of frames
+ * @return 		none
+ *********************************************************************/
+void I2S_ConvertFromQ31(const int32_t *src, uint32_t *dst, uint32_t frames)
+{
+	int32_t l, r;
+
+	while (frames--) {
+		l = *src++;
+		r = *src++;
+		l = (l > 0x7FFF7FFF) ? 0x7FFF : ((l + 0x8000) >> 16);
+		r = (r > 0x7FFF7FFF) ? 0x7FFF : ((r + 0x8000) >> 16);
+		*dst++ = ((uint32_t)r << 16) | ((uint32_t)l & 0xFFFF);
+	}
+}
+
+/********************************************************************//**
+ * @brief		Convert 16-bit stereo frames to interleaved q15 samples.
+ * 				Both have the same memory layout, so this is a word copy;
+ * 				I2S_StreamProcess() does not call it, it passes the ring
+ * 				periods directly
+ * @param[in]	src		frames, left channel in the low half-word
+ * @param[out]	dst		2 * frames samples: L, R, L, R..., word aligned
+ * @param[in]	frames	number of frames
+ * @return 		none
+ *********************************************************************/
+void I2S_ConvertToQ15(const uint32_t *src, int16_t *dst, uint32_t frames)
+{
+	uint32_t *p = (uint32_t *) dst;
+
+	while (frames--) {
+		*p++ = *src++;
+	}
+}
+
+/********************************************************************//**
+ * @brief		Convert interleaved q15 samples to 16-bit stereo frames
+ * @param[in]	src		2 * frames samples: L, R, L, R..., word aligned
+ * @param[out]	dst		frames, left channel in the low half-word
+ * @param[in]	frames	number of frames
+ * @return 		none
+ *********************************************************************/
+void I2S_ConvertFromQ15(const int16_t *src, uint32_t *dst, uint32_t frames)
+{
+	const uint32_t *p = (const uint32_t *) src;
+
+	while (frames--) {
+		*dst++ = *p++;
+	}
+}
+
+#ifdef _GPDMA
+/********************************************************************//**
+ * @brief		Build a circular LLI chain, one LLI per period
+ * @param[in]	lli		NumPeriods LLIs
+ * @param[in]	buf		ring buffer
+ * @param[in]	fifo	I2S FIFO address
+ * @param[in]	stream	point to I2S_STREAM_Type structure
+ * @param[in]	tx		TRUE for TX ring (memory to FIFO), FALSE for RX
+ * @return 		none
+ *********************************************************************/
+static void i2s_StreamBuildLLI(GPDMA_LLI_Type *lli, uint32_t *buf, uint32_t fifo,
+		I2S_STREAM_Type *stream, Bool tx)
+{
+	uint32_t i, ctrl;
+
+	/* FIFO DMA requests are raised at level 4: 4 word bursts */
+	ctrl = GPDMA_DMACCxControl_TransferSize((uint32_t)stream->PeriodSize) \
+			| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) \
+			| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4) \
+			| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) \
+			| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) \
+			| GPDMA_DMACCxControl_I;
+	ctrl |= (tx == TRUE) ? GPDMA_DMACCxControl_SI : GPDMA_DMACCxControl_DI;
+
+	for (i = 0; i < stream->NumPeriods; i++) {
+		if (tx == TRUE) {
+			lli[i].SrcAddr = (uint32_t) (buf + (i * stream->PeriodSize));
+			lli[i].DstAddr = fifo;
+		} else {
+			lli[i].SrcAddr = fifo;
+			lli[i].DstAddr = (uint32_t) (buf + (i * stream->PeriodSize));
+		}
+		lli[i].NextLLI = (uint32_t) &lli[(i + 1) % stream->NumPeriods];
+		lli[i].Control = ctrl;
+	}
+}
+
+/********************************************************************//**
+ * @brief		Initialize I2S full-duplex stream: zero the TX ring (Lead
+ * 				periods of silence are played first) and setup both GPDMA
+ * 				channels on circular LLI chains. I2S must be configured
+ * 				before (I2S_Config(), I2S_ModeConfig(), I2S_FreqConfig())
+ * 				for 16-bit stereo, RX clocked with TX.
+ * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
+ * @param[in]	stream	point to I2S_STREAM_Type structure, configuration
+ * 				fields must be filled
+ * @return 		ERROR if a GPDMA channel is enabled, otherwise SUCCESS
+ *********************************************************************/
+Status I2S_StreamInit(LPC_I2S_TypeDef *I2Sx, I2S_STREAM_Type *stream)
+{
+	GPDMA_Channel_CFG_Type GPDMACfg;
+	uint32_t i;
+
+	CHECK_PARAM(PARAM_I2Sx(I2Sx));
+	CHECK_PARAM(PARAM_I2S_STREAM_FMT(stream->Format));
+	CHECK_PARAM((stream->PeriodSize > 0) && (stream->PeriodSize <= 4092)
+			&& ((stream->PeriodSize & 3) == 0));
+	CHECK_PARAM(stream->NumPeriods >= 2);
+	CHECK_PARAM((stream->Lead > 0) && (stream->Lead < stream->NumPeriods));
+
+	for (i = 0; i < (uint32_t)(stream->NumPeriods * stream->PeriodSize); i++) {
+		stream->txbuf[i] = 0;
+	}
+	i2s_StreamBuildLLI(stream->txlli, stream->txbuf, (uint32_t) &I2Sx->I2STXFIFO,
+			stream, TRUE);
+	i2s_StreamBuildLLI(stream->rxlli, stream->rxbuf, (uint32_t) &I2Sx->I2SRXFIFO,
+			stream, FALSE);
+
+	stream->tx_played = 0;
+	stream->rx_done = 0;
+	stream->tx_filled = stream->Lead;
+	stream->rx_read = 0;
+	stream->latency = 0;
+	stream->underrun = 0;
+	stream->overrun = 0;
+	stream->error = 0;
+
+	/* TX on DMA1 request, RX on DMA2 request */
+	GPDMACfg.ChannelNum = stream->TxDMAChannel;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	GPDMACfg.SrcConn = 0;
+	GPDMACfg.DstConn = GPDMA_CONN_I2S_Channel_0;
+	GPDMACfg.DMALLI = (uint32_t) &stream->txlli[0];
+	if (GPDMA_SetupLLI(&GPDMACfg) != SUCCESS) {
+		return ERROR;
+	}
+	GPDMACfg.ChannelNum = stream->RxDMAChannel;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	GPDMACfg.SrcConn = GPDMA_CONN_I2S_Channel_1;
+	GPDMACfg.DstConn = 0;
+	GPDMACfg.DMALLI = (uint32_t) &stream->rxlli[0];
+	return GPDMA_SetupLLI(&GPDMACfg);
+}
+
+/********************************************************************//**
+ * @brief		Start I2S full-duplex stream: enable both GPDMA channels,
+ * 				then I2S with DMA requests at FIFO level 4
+ * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
+ * @param[in]	stream	point to I2S_STREAM_Type structure
+ * @return 		none
+ *********************************************************************/
+void I2S_StreamStart(LPC_I2S_TypeDef *I2Sx, I2S_STREAM_Type *stream)
+{
+	I2S_DMAConf_Type DMACfg;
+
+	CHECK_PARAM(PARAM_I2Sx(I2Sx));
+
+	GPDMA_ChannelCmd(stream->TxDMAChannel, ENABLE);
+	GPDMA_ChannelCmd(stream->RxDMAChannel, ENABLE);
+
+	DMACfg.DMAIndex = I2S_DMA_1;
+	DMACfg.depth = 4;
+	I2S_DMAConfig(I2Sx, &DMACfg, I2S_TX_MODE);
+	DMACfg.DMAIndex = I2S_DMA_2;
+	I2S_DMAConfig(I2Sx, &DMACfg, I2S_RX_MODE);
+
+	I2S_Start(I2Sx);
+	I2S_DMACmd(I2Sx, I2S_DMA_2, I2S_RX_MODE, ENABLE);
+	I2S_DMACmd(I2Sx, I2S_DMA_1, I2S_TX_MODE, ENABLE);
+}
+
+/********************************************************************//**
+ * @brief		Stop I2S full-duplex stream
+ * @param[in]	I2Sx I2S peripheral selected, should be: LPC_I2S
+ * @param[in]	stream	point to I2S_STREAM_Type structure
+ * @return 		none
+ *********************************************************************/
+void I2S_StreamStop(LPC_I2S_TypeDef *I2Sx, I2S_STREAM_Type *stream)
+{
+	CHECK_PARAM(PARAM_I2Sx(I2Sx));
+
+	I2S_DMACmd(I2Sx, I2S_DMA_1, I2S_TX_MODE, DISABLE);
+	I2S_DMACmd(I2Sx, I2S_DMA_2, I2S_RX_MODE, DISABLE);
+	I2S_Stop(I2Sx, I2S_TX_MODE);
+	I2S_Stop(I2Sx, I2S_RX_MODE);
+	GPDMA_ChannelCmd(stream->TxDMAChannel, DISABLE);
+	GPDMA_ChannelCmd(stream->RxDMAChannel, DISABLE);
+}
+
+/********************************************************************//**
+ * @brief		I2S stream GPDMA interrupt handler, should be called from
+ * 				DMA_IRQHandler(). Counts the periods done on each channel
+ * 				and the TX periods started without new data (underrun).
+ * @param[in]	stream	point to I2S_STREAM_Type structure
+ * @return 		none
+ *********************************************************************/
+void I2S_StreamDMAHandler(I2S_STREAM_Type *stream)
+{
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, stream->TxDMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, stream->TxDMAChannel);
+		stream->error++;
+	}
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, stream->RxDMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, stream->RxDMAChannel);
+		stream->error++;
+	}
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, stream->RxDMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, stream->RxDMAChannel);
+		stream->rx_done++;
+	}
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, stream->TxDMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, stream->TxDMAChannel);
+		stream->tx_played++;
+		// The period now played was not written since its last turn
+		if ((int32_t)(stream->tx_filled - stream->tx_played) <= 0) {
+			stream->underrun++;
+		}
+	}
+}
+
+/********************************************************************//**
+ * @brief		Process all received periods: each one is passed to
+ * 				Process() with the next TX period to fill, converted to
+ * 				and from q31 work buffers if needed. Can be called from
+ * 				the main loop, or from DMA_IRQHandler() after
+ * 				I2S_StreamDMAHandler() for the lowest latency.
+ * @param[in]	stream	point to I2S_STREAM_Type structure
+ * @return 		Number of periods processed
+ *********************************************************************/
+uint32_t I2S_StreamProcess(I2S_STREAM_Type *stream)
+{
+	uint32_t *in, *out;
+	uint32_t done, played, ringsize, pos, start, cnt;
+
+	ringsize = stream->NumPeriods * stream->PeriodSize;
+	cnt = 0;
+	while (1) {
+		done = stream->rx_done;
+		if (done == stream->rx_read) {
+			break;
+		}
+		if ((done - stream->rx_read) >= stream->NumPeriods) {
+			// Oldest periods were overwritten, keep the last complete one
+			stream->overrun += done - stream->rx_read - 1;
+			stream->rx_read = done - 1;
+		}
+		played = stream->tx_played;
+		if ((int32_t)(stream->tx_filled - played) <= 0) {
+			// Output fell behind: write the period after the one playing
+			stream->tx_filled = played + 1;
+		}
+
+		in = stream->rxbuf + ((stream->rx_read % stream->NumPeriods) * stream->PeriodSize);
+		start = (stream->tx_filled % stream->NumPeriods) * stream->PeriodSize;
+		out = stream->txbuf + start;
+		if (stream->Format == I2S_STREAM_Q31) {
+			I2S_ConvertToQ31(in, stream->work_in, stream->PeriodSize);
+			stream->Process(stream->arg, stream->work_in, stream->work_out,
+					stream->PeriodSize);
+			I2S_ConvertFromQ31(stream->work_out, out, stream->PeriodSize);
+		} else {
+			stream->Process(stream->arg, in, out, stream->PeriodSize);
+		}
+		stream->rx_read++;
+		stream->tx_filled++;
+		cnt++;
+
+		// Distance from the frame now read by TX DMA to the output start
+		pos = (GPDMA_GetSrcAddr(stream->TxDMAChannel) - (uint32_t)stream->txbuf) / 4;
+		stream->latency = (start + ringsize - pos) % ringsize;
+	}
+	return cnt;
+}
+#endif /* _GPDMA */
 /**
  * @}
  */
@@ -0,0 +1,890 @@
+/**********************************************************************
+* $Id$		lpc17xx_sdcard.c				2011-03-09
+*//**
+* @file		lpc17xx_sdcard.c
+* @brief	Contains all functions support for the SD/SDHC card block
+* 			device (SPI mode on SSP with GPDMA data transfers) on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup SDCARD
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_sdcard.h"
+#include "lpc17xx_ssp.h"
+#include "lpc17xx_gpio.h"
+#include "lpc17xx_clkpwr.h"
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _SDCARD
+
+/* Private Macros ------------------------------------------------------------- */
+/** SD commands, SPI mode */
+#define SDC_CMD0		0		/**< GO_IDLE_STATE */
+#define SDC_CMD8		8		/**< SEND_IF_COND */
+#define SDC_CMD9		9		/**< SEND_CSD */
+#define SDC_CMD10		10		/**< SEND_CID */
+#define SDC_CMD12		12		/**< STOP_TRANSMISSION */
+#define SDC_CMD16		16		/**< SET_BLOCKLEN */
+#define SDC_CMD17		17		/**< READ_SINGLE_BLOCK */
+#define SDC_CMD18		18		/**< READ_MULTIPLE_BLOCK */
+#define SDC_CMD24		24		/**< WRITE_BLOCK */
+#define SDC_CMD25		25		/**< WRITE_MULTIPLE_BLOCK */
+#define SDC_CMD55		55		/**< APP_CMD */
+#define SDC_CMD58		58		/**< READ_OCR */
+#define SDC_CMD59		59		/**< CRC_ON_OFF */
+#define SDC_ACMD23		23		/**< SET_WR_BLK_ERASE_COUNT */
+#define SDC_ACMD41		41		/**< SD_SEND_OP_COND */
+
+/** R1 response bits */
+#define SDC_R1_IDLE			0x01
+#define SDC_R1_ILLEGAL_CMD	0x04
+#define SDC_R1_NO_RESPONSE	0x80
+
+/** Data tokens */
+#define SDC_TOKEN_START			0xFE	/**< Start of a read block, of a CMD24 block */
+#define SDC_TOKEN_MULTI_WRITE	0xFC	/**< Start of a CMD25 block */
+#define SDC_TOKEN_STOP			0xFD	/**< End of CMD25 */
+/** Data response: mask, data accepted, rejected for a CRC error */
+#define SDC_DATA_RESP_MASK		0x1F
+#define SDC_DATA_RESP_ACCEPTED	0x05
+#define SDC_DATA_RESP_CRC_ERROR	0x0B
+
+/** OCR: card capacity status */
+#define SDC_OCR_CCS			0x40
+/** ACMD41 argument: host capacity support */
+#define SDC_ACMD41_HCS		(1UL << 30)
+/** ACMD23 argument: largest block count */
+#define SDC_ACMD23_MAX		0x7FFFFF
+
+/** Identification clock rate (Hz) */
+#define SDC_INIT_CLOCK		400000
+/** Highest clock rate of the SPI mode (Hz) */
+#define SDC_MAX_CLOCK		25000000
+/** ACMD41 retries, at least 1s at the identification clock rate */
+#define SDC_INIT_RETRIES	2000
+/** Bytes polled by one call before the wait is left to SDC_Poll() */
+#define SDC_POLL_SLICE		512
+/** Read and write/busy timeouts (ms) */
+#define SDC_READ_TIMEOUT	100
+#define SDC_WRITE_TIMEOUT	250
+
+/** Transfer states */
+#define SDC_ST_IDLE			0	/**< No transfer */
+#define SDC_ST_RD_TOKEN		1	/**< Wait for the start token of a read block */
+#define SDC_ST_RD_DATA		2	/**< GPDMA receives a block */
+#define SDC_ST_WR_DATA		3	/**< GPDMA transmits a block */
+#define SDC_ST_WR_BUSY		4	/**< Card programs the block */
+#define SDC_ST_STOP			5	/**< Wait for the end of the stop command */
+
+
+/* Private Variables ---------------------------------------------------------- */
+/** CRC7 (x^7 + x^3 + 1) of one byte: crc = table[(crc << 1) ^ data] */
+static const uint8_t sdc_Crc7Table[256] = {
+	0x00, 0x09, 0x12, 0x1B, 0x24, 0x2D, 0x36, 0x3F, 0x48, 0x41, 0x5A, 0x53, 0x6C, 0x65, 0x7E, 0x77,
+	0x19, 0x10, 0x0B, 0x02, 0x3D, 0x34, 0x2F, 0x26, 0x51, 0x58, 0x43, 0x4A, 0x75, 0x7C, 0x67, 0x6E,
+	0x32, 0x3B, 0x20, 0x29, 0x16, 0x1F, 0x04, 0x0D, 0x7A, 0x73, 0x68, 0x61, 0x5E, 0x57, 0x4C, 0x45,
+	0x2B, 0x22, 0x39, 0x30, 0x0F, 0x06, 0x1D, 0x14, 0x63, 0x6A, 0x71, 0x78, 0x47, 0x4E, 0x55, 0x5C,
+	0x64, 0x6D, 0x76, 0x7F, 0x40, 0x49, 0x52, 0x5B, 0x2C, 0x25, 0x3E, 0x37, 0x08, 0x01, 0x1A, 0x13,
+	0x7D, 0x74, 0x6F, 0x66, 0x59, 0x50, 0x4B, 0x42, 0x35, 0x3C, 0x27, 0x2E, 0x11, 0x18, 0x03, 0x0A,
+	0x56, 0x5F, 0x44, 0x4D, 0x72, 0x7B, 0x60, 0x69, 0x1E, 0x17, 0x0C, 0x05, 0x3A, 0x33, 0x28, 0x21,
+	0x4F, 0x46, 0x5D, 0x54, 0x6B, 0x62, 0x79, 0x70, 0x07, 0x0E, 0x15, 0x1C, 0x23, 0x2A, 0x31, 0x38,
+	0x41, 0x48, 0x53, 0x5A, 0x65, 0x6C, 0x77, 0x7E, 0x09, 0x00, 0x1B, 0x12, 0x2D, 0x24, 0x3F, 0x36,
+	0x58, 0x51, 0x4A, 0x43, 0x7C, 0x75, 0x6E, 0x67, 0x10, 0x19, 0x02, 0x0B, 0x34, 0x3D, 0x26, 0x2F,
+	0x73, 0x7A, 0x61, 0x68, 0x57, 0x5E, 0x45, 0x4C, 0x3B, 0x32, 0x29, 0x20, 0x1F, 0x16, 0x0D, 0x04,
+	0x6A, 0x63, 0x78, 0x71, 0x4E, 0x47, 0x5C, 0x55, 0x22, 0x2B, 0x30, 0x39, 0x06, 0x0F, 0x14, 0x1D,
+	0x25, 0x2C, 0x37, 0x3E, 0x01, 0x08, 0x13, 0x1A, 0x6D, 0x64, 0x7F, 0x76, 0x49, 0x40, 0x5B, 0x52,
+	0x3C, 0x35, 0x2E, 0x27, 0x18, 0x11, 0x0A, 0x03, 0x74, 0x7D, 0x66, 0x6F, 0x50, 0x59, 0x42, 0x4B,
+	0x17, 0x1E, 0x05, 0x0C, 0x33, 0x3A, 0x21, 0x28, 0x5F, 0x56, 0x4D, 0x44, 0x7B, 0x72, 0x69, 0x60,
+	0x0E, 0x07, 0x1C, 0x15, 0x2A, 0x23, 0x38, 0x31, 0x46, 0x4F, 0x54, 0x5D, 0x62, 0x6B, 0x70, 0x79
+};
+
+/** CRC16-CCITT (x^16 + x^12 + x^5 + 1) of one byte:
+ * crc = (crc << 8) ^ table[(crc >> 8) ^ data] */
+static const uint16_t sdc_Crc16Table[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+/** CSD TRAN_SPEED time value, times 10 */
+static const uint8_t sdc_TranSpeed[16] = {
+	0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80
+};
+
+
+/* Private Functions ---------------------------------------------------------- */
+static uint8_t sdc_Xfer(SDC_Type *sd, uint8_t data);
+static void sdc_Deselect(SDC_Type *sd);
+static Status sdc_Select(SDC_Type *sd);
+static uint8_t sdc_Command(SDC_Type *sd, uint8_t cmd, uint32_t arg);
+static uint8_t sdc_AppCommand(SDC_Type *sd, uint8_t cmd, uint32_t arg);
+static Status sdc_ReadRegister(SDC_Type *sd, uint8_t *dst, uint32_t len);
+static void sdc_SetWait(SDC_Type *sd, uint8_t state, uint32_t ms);
+static Status sdc_DMAStart(SDC_Type *sd, uint8_t *rx, const uint8_t *tx);
+static void sdc_DMAStop(SDC_Type *sd);
+static void sdc_Finish(SDC_Type *sd, Status status);
+static void sdc_Abort(SDC_Type *sd);
+static void sdc_WriteBlock(SDC_Type *sd);
+static void sdc_Run(SDC_Type *sd);
+static Status sdc_Start(SDC_Type *sd, uint8_t write, uint32_t lba, uint8_t *buf, uint32_t n);
+static Status sdc_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n);
+static Status sdc_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n);
+static void sdc_Poll(BLKDEV_Type *dev);
+
+/*********************************************************************//**
+ * @brief		Transmit one byte and return the byte received
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	data	Byte to transmit
+ * @return 		Byte received
+ **********************************************************************/
+static uint8_t sdc_Xfer(SDC_Type *sd, uint8_t data)
+{
+	SSP_SendData(sd->SSPx, data);
+	while (SSP_GetStatus(sd->SSPx, SSP_STAT_RXFIFO_NOTEMPTY) == RESET);
+	return (uint8_t)SSP_ReceiveData(sd->SSPx);
+}
+
+/*********************************************************************//**
+ * @brief		Deselect the card, then one byte so that it releases
+ * 				its data output
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void sdc_Deselect(SDC_Type *sd)
+{
+	GPIO_SetValue(sd->CSPort, (1UL << sd->CSPin));
+	sdc_Xfer(sd, 0xFF);
+}
+
+/*********************************************************************//**
+ * @brief		Select the card and wait until it is ready (not busy)
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		ERROR on timeout, otherwise SUCCESS
+ **********************************************************************/
+static Status sdc_Select(SDC_Type *sd)
+{
+	uint32_t i;
+
+	GPIO_ClearValue(sd->CSPort, (1UL << sd->CSPin));
+	for (i = (sd->ClockRate / 8000) * SDC_WRITE_TIMEOUT; i != 0; i--) {
+		if (sdc_Xfer(sd, 0xFF) == 0xFF) {
+			return SUCCESS;
+		}
+	}
+	sd->timeouts++;
+	sdc_Deselect(sd);
+	return ERROR;
+}
+
+/*********************************************************************//**
+ * @brief		Send a command and wait for its R1 response
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	cmd		Command index
+ * @param[in]	arg		Command argument
+ * @return 		R1, SDC_R1_NO_RESPONSE set if the card did not answer
+ **********************************************************************/
+static uint8_t sdc_Command(SDC_Type *sd, uint8_t cmd, uint32_t arg)
+{
+	uint32_t i;
+	uint8_t frame[5], r1;
+
+	frame[0] = 0x40 | cmd;
+	frame[1] = (uint8_t)(arg >> 24);
+	frame[2] = (uint8_t)(arg >> 16);
+	frame[3] = (uint8_t)(arg >> 8);
+	frame[4] = (uint8_t)arg;
+	for (i = 0; i < 5; i++) {
+		sdc_Xfer(sd, frame[i]);
+	}
+	sdc_Xfer(sd, (SDC_Crc7(frame, 5) << 1) | 0x01);
+	if (cmd == SDC_CMD12) {
+		// Stuff byte
+		sdc_Xfer(sd, 0xFF);
+	}
+	r1 = SDC_R1_NO_RESPONSE;
+	for (i = 0; (i < 10) && (r1 & SDC_R1_NO_RESPONSE); i++) {
+		r1 = sdc_Xfer(sd, 0xFF);
+	}
+	return r1;
+}
+
+/*********************************************************************//**
+ * @brief		Send an application specific command (CMD55 first)
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	cmd		Command index
+ * @param[in]	arg		Command argument
+ * @return 		R1 of the command
+ **********************************************************************/
+static uint8_t sdc_AppCommand(SDC_Type *sd, uint8_t cmd, uint32_t arg)
+{
+	uint8_t r1;
+
+	r1 = sdc_Command(sd, SDC_CMD55, 0);
+	if (r1 & ~SDC_R1_IDLE) {
+		return r1;
+	}
+	return sdc_Command(sd, cmd, arg);
+}
+
+/*********************************************************************//**
+ * @brief		Read a register data block (CSD, CID), polled
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[out]	dst		Destination buffer
+ * @param[in]	len		Register size (bytes)
+ * @return 		ERROR on timeout, error token or CRC error (CRCCheck),
+ * 				otherwise SUCCESS
+ **********************************************************************/
+static Status sdc_ReadRegister(SDC_Type *sd, uint8_t *dst, uint32_t len)
+{
+	uint32_t i;
+	uint16_t crc;
+	uint8_t token = 0xFF;
+
+	for (i = (sd->ClockRate / 8000) * SDC_READ_TIMEOUT; (i != 0) && (token == 0xFF); i--) {
+		token = sdc_Xfer(sd, 0xFF);
+	}
+	if (token != SDC_TOKEN_START) {
+		return ERROR;
+	}
+	for (i = 0; i < len; i++) {
+		dst[i] = sdc_Xfer(sd, 0xFF);
+	}
+	crc = (uint16_t)sdc_Xfer(sd, 0xFF) << 8;
+	crc |= sdc_Xfer(sd, 0xFF);
+	if (sd->CRCCheck && (crc != SDC_Crc16(0, dst, len))) {
+		sd->crcerrors++;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Enter a waiting state
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	state	SDC_ST_RD_TOKEN, SDC_ST_WR_BUSY or SDC_ST_STOP
+ * @param[in]	ms		Timeout (ms), counted in polled bytes
+ * @return 		None
+ **********************************************************************/
+static void sdc_SetWait(SDC_Type *sd, uint8_t state, uint32_t ms)
+{
+	sd->state = state;
+	sd->wait = (sd->ClockRate / 8000) * ms;
+}
+
+/*********************************************************************//**
+ * @brief		Move one block by GPDMA: receive channel from SSP into
+ * 				rx, transmit channel from tx to SSP. rx or tx may be the
+ * 				fixed sink/fill word, then the address does not increment.
+ * 				The receive channel interrupts at terminal count.
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	rx		Receive buffer or &sd->dummy
+ * @param[in]	tx		Transmit buffer or &sd->fill
+ * @return 		ERROR if a channel could not be set up (still enabled),
+ * 				then neither channel is started, otherwise SUCCESS
+ **********************************************************************/
+static Status sdc_DMAStart(SDC_Type *sd, uint8_t *rx, const uint8_t *tx)
+{
+	GPDMA_Channel_CFG_Type GPDMACfg;
+	uint32_t ctrl;
+
+	ctrl = GPDMA_DMACCxControl_TransferSize(SDC_BLOCK_SIZE) \
+			| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) \
+			| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4) \
+			| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_BYTE) \
+			| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_BYTE);
+
+	sd->lli[0].SrcAddr = (uint32_t) &sd->SSPx->DR;
+	sd->lli[0].DstAddr = (uint32_t) rx;
+	sd->lli[0].NextLLI = 0;
+	sd->lli[0].Control = ctrl | GPDMA_DMACCxControl_I \
+			| ((rx != (uint8_t *)&sd->dummy) ? GPDMA_DMACCxControl_DI : 0);
+	sd->lli[1].SrcAddr = (uint32_t) tx;
+	sd->lli[1].DstAddr = (uint32_t) &sd->SSPx->DR;
+	sd->lli[1].NextLLI = 0;
+	sd->lli[1].Control = ctrl \
+			| ((tx != (const uint8_t *)&sd->fill) ? GPDMA_DMACCxControl_SI : 0);
+
+	GPDMACfg.ChannelNum = sd->DMARx;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	GPDMACfg.SrcConn = (sd->SSPx == LPC_SSP0) ? GPDMA_CONN_SSP0_Rx : GPDMA_CONN_SSP1_Rx;
+	GPDMACfg.DstConn = 0;
+	GPDMACfg.DMALLI = (uint32_t) &sd->lli[0];
+	if (GPDMA_SetupLLI(&GPDMACfg) != SUCCESS) {
+		return ERROR;
+	}
+
+	GPDMACfg.ChannelNum = sd->DMATx;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	GPDMACfg.SrcConn = 0;
+	GPDMACfg.DstConn = (sd->SSPx == LPC_SSP0) ? GPDMA_CONN_SSP0_Tx : GPDMA_CONN_SSP1_Tx;
+	GPDMACfg.DMALLI = (uint32_t) &sd->lli[1];
+	if (GPDMA_SetupLLI(&GPDMACfg) != SUCCESS) {
+		return ERROR;
+	}
+
+	GPDMA_ChannelCmd(sd->DMARx, ENABLE);
+	GPDMA_ChannelCmd(sd->DMATx, ENABLE);
+	SSP_DMACmd(sd->SSPx, SSP_DMA_RX, ENABLE);
+	SSP_DMACmd(sd->SSPx, SSP_DMA_TX, ENABLE);
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Stop the GPDMA channels and drain the SSP receive FIFO
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void sdc_DMAStop(SDC_Type *sd)
+{
+	SSP_DMACmd(sd->SSPx, SSP_DMA_TX, DISABLE);
+	SSP_DMACmd(sd->SSPx, SSP_DMA_RX, DISABLE);
+	GPDMA_ChannelCmd(sd->DMATx, DISABLE);
+	GPDMA_ChannelCmd(sd->DMARx, DISABLE);
+	while (SSP_GetStatus(sd->SSPx, SSP_STAT_BUSY) == SET);
+	while (SSP_GetStatus(sd->SSPx, SSP_STAT_RXFIFO_NOTEMPTY) == SET) {
+		SSP_ReceiveData(sd->SSPx);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		End the request: deselect the card and call the
+ * 				completion callback
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	status	Request status
+ * @return 		None
+ **********************************************************************/
+static void sdc_Finish(SDC_Type *sd, Status status)
+{
+	sdc_Deselect(sd);
+	if (status != SUCCESS) {
+		sd->errors++;
+	}
+	sd->state = SDC_ST_IDLE;
+	sd->dev.Busy = FALSE;
+	if (sd->dev.Done != NULL) {
+		sd->dev.Done(sd->dev.arg, status);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Stop a failed transfer: stop token (multiple block
+ * 				write) or CMD12 (multiple block read), then wait until
+ * 				the card is ready, polled
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void sdc_Abort(SDC_Type *sd)
+{
+	uint32_t i;
+
+	if (sd->single || (sd->state == SDC_ST_STOP)) {
+		// Nothing to stop
+	} else if ((sd->state == SDC_ST_WR_DATA) || (sd->state == SDC_ST_WR_BUSY)) {
+		sdc_Xfer(sd, SDC_TOKEN_STOP);
+		sdc_Xfer(sd, 0xFF);
+	} else {
+		sdc_Command(sd, SDC_CMD12, 0);
+	}
+	for (i = (sd->ClockRate / 8000) * SDC_WRITE_TIMEOUT; i != 0; i--) {
+		if (sdc_Xfer(sd, 0xFF) == 0xFF) {
+			break;
+		}
+	}
+	sdc_Finish(sd, ERROR);
+}
+
+/*********************************************************************//**
+ * @brief		Start the transmission of the next block. With CRCCheck,
+ * 				its CRC16 is computed while GPDMA transmits it. The
+ * 				request is aborted if GPDMA cannot be set up.
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void sdc_WriteBlock(SDC_Type *sd)
+{
+	sdc_Xfer(sd, 0xFF);
+	sdc_Xfer(sd, sd->single ? SDC_TOKEN_START : SDC_TOKEN_MULTI_WRITE);
+	sd->state = SDC_ST_WR_DATA;
+	if (sdc_DMAStart(sd, (uint8_t *)&sd->dummy, sd->buf) != SUCCESS) {
+		sdc_Abort(sd);
+		return;
+	}
+	sd->crc = sd->CRCCheck ? SDC_Crc16(0, sd->buf, SDC_BLOCK_SIZE) : 0xFFFF;
+}
+
+/*********************************************************************//**
+ * @brief		Poll the card in the waiting states, at most
+ * 				SDC_POLL_SLICE bytes, then move on to the next state
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void sdc_Run(SDC_Type *sd)
+{
+	uint32_t i;
+	uint8_t data;
+
+	for (i = 0; i < SDC_POLL_SLICE; i++) {
+		if ((sd->state != SDC_ST_RD_TOKEN) && (sd->state != SDC_ST_WR_BUSY)
+				&& (sd->state != SDC_ST_STOP)) {
+			return;
+		}
+		if (sd->wait == 0) {
+			sd->timeouts++;
+			sdc_Abort(sd);
+			return;
+		}
+		sd->wait--;
+
+		data = sdc_Xfer(sd, 0xFF);
+		if (sd->state == SDC_ST_RD_TOKEN) {
+			if (data == SDC_TOKEN_START) {
+				sd->state = SDC_ST_RD_DATA;
+				if (sdc_DMAStart(sd, sd->buf, (uint8_t *)&sd->fill) != SUCCESS) {
+					sdc_Abort(sd);
+				}
+				return;
+			} else if (data != 0xFF) {
+				// Error token
+				sdc_Abort(sd);
+				return;
+			}
+		} else if (data == 0xFF) {
+			if ((sd->state == SDC_ST_STOP) || ((sd->n == 0) && sd->single)) {
+				sdc_Finish(sd, SUCCESS);
+				return;
+			}
+			// Write busy is over
+			if (sd->n != 0) {
+				sdc_WriteBlock(sd);
+				return;
+			}
+			sdc_Xfer(sd, SDC_TOKEN_STOP);
+			sdc_Xfer(sd, 0xFF);
+			sdc_SetWait(sd, SDC_ST_STOP, SDC_WRITE_TIMEOUT);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Accept a request and send its command: CMD17/CMD24 for
+ * 				one block, CMD18/CMD25 for more, the latter preceded by
+ * 				ACMD23 with PreErase
+ * @param[in]	sd		point to SDC_Type structure
+ * @param[in]	write	TRUE to write, FALSE to read
+ * @param[in]	lba		First block
+ * @param[in]	buf		Data buffer
+ * @param[in]	n		Number of blocks
+ * @return 		ERROR if busy or out of range, otherwise SUCCESS
+ **********************************************************************/
+static Status sdc_Start(SDC_Type *sd, uint8_t write, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	uint8_t cmd;
+
+	if (sd->dev.Busy || (n == 0) || (lba >= sd->dev.BlockCount)
+			|| (n > (sd->dev.BlockCount - lba))) {
+		return ERROR;
+	}
+	sd->dev.Busy = TRUE;
+	sd->buf = buf;
+	sd->n = n;
+	sd->single = (n == 1);
+
+	if (sdc_Select(sd) != SUCCESS) {
+		sdc_Finish(sd, ERROR);
+		return SUCCESS;
+	}
+	if (write) {
+		cmd = sd->single ? SDC_CMD24 : SDC_CMD25;
+		if (!sd->single && sd->PreErase && (n <= SDC_ACMD23_MAX)
+				&& (sdc_AppCommand(sd, SDC_ACMD23, n) != 0)) {
+			sdc_Finish(sd, ERROR);
+			return SUCCESS;
+		}
+	} else {
+		cmd = sd->single ? SDC_CMD17 : SDC_CMD18;
+	}
+	if (sdc_Command(sd, cmd, (sd->Type == SDC_TYPE_SDHC) ? lba : (lba * SDC_BLOCK_SIZE)) != 0) {
+		sdc_Finish(sd, ERROR);
+		return SUCCESS;
+	}
+	if (write) {
+		sdc_WriteBlock(sd);
+	} else {
+		sdc_SetWait(sd, SDC_ST_RD_TOKEN, SDC_READ_TIMEOUT);
+		sdc_Run(sd);
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Read entry point, see BLKDEV_Type
+ **********************************************************************/
+static Status sdc_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	return sdc_Start((SDC_Type *)dev, FALSE, lba, buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Write entry point, see BLKDEV_Type
+ **********************************************************************/
+static Status sdc_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n)
+{
+	return sdc_Start((SDC_Type *)dev, TRUE, lba, (uint8_t *)buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Poll entry point, see BLKDEV_Type
+ **********************************************************************/
+static void sdc_Poll(BLKDEV_Type *dev)
+{
+	SDC_Poll((SDC_Type *)dev);
+}
+
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup SDCARD_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize the card, polled: identification at 400KHz
+ * 				(CMD0, CMD8, ACMD41, CMD59 with CRCCheck, CMD58), block
+ * 				length, CID, capacity and transfer rate from the CSD, then
+ * 				SSP at ClockRate. The SSP peripheral clock is raised if
+ * 				ClockRate needs it. SSP pins must be routed and GPDMA
+ * 				initialized.
+ * @param[in]	sd		point to SDC_Type structure, configuration fields
+ * 				must be filled
+ * @return 		ERROR if no card answers or the card is not supported
+ * 				(MMC, voltage range), otherwise SUCCESS
+ **********************************************************************/
+Status SDC_Init(SDC_Type *sd)
+{
+	SSP_CFG_Type SSP_ConfigStruct;
+	uint32_t i, clock, csize, hcs, pclksel;
+	uint8_t r1, reg[16];
+
+	CHECK_PARAM((sd->SSPx == LPC_SSP0) || (sd->SSPx == LPC_SSP1));
+	CHECK_PARAM(sd->DMATx != sd->DMARx);
+
+	sd->Type = SDC_TYPE_NONE;
+	sd->state = SDC_ST_IDLE;
+	sd->fill = 0xFFFFFFFF;
+	sd->timeouts = 0;
+	sd->errors = 0;
+	sd->crcerrors = 0;
+	sd->dev.BlockSize = SDC_BLOCK_SIZE;
+	sd->dev.BlockCount = 0;
+	sd->dev.Read = sdc_Read;
+	sd->dev.Write = sdc_Write;
+	sd->dev.Sync = NULL;
+	sd->dev.Poll = sdc_Poll;
+	sd->dev.Busy = FALSE;
+
+	// SSP clock is at most PCLK / 2
+	clock = (sd->ClockRate < SDC_MAX_CLOCK) ? sd->ClockRate : SDC_MAX_CLOCK;
+	pclksel = (sd->SSPx == LPC_SSP0) ? CLKPWR_PCLKSEL_SSP0 : CLKPWR_PCLKSEL_SSP1;
+	if (CLKPWR_GetPCLK(pclksel) < (2 * clock)) {
+		CLKPWR_SetPCLKDiv(pclksel, (SystemCoreClock >= (4 * clock)) ? \
+				CLKPWR_PCLKSEL_CCLK_DIV_2 : CLKPWR_PCLKSEL_CCLK_DIV_1);
+	}
+
+	GPIO_SetDir(sd->CSPort, (1UL << sd->CSPin), 1);
+	GPIO_SetValue(sd->CSPort, (1UL << sd->CSPin));
+
+	SSP_ConfigStructInit(&SSP_ConfigStruct);
+	SSP_ConfigStruct.ClockRate = SDC_INIT_CLOCK;
+	SSP_Init(sd->SSPx, &SSP_ConfigStruct);
+	SSP_Cmd(sd->SSPx, ENABLE);
+
+	// Timeouts are counted in bytes at the identification clock rate
+	sd->ClockRate = SDC_INIT_CLOCK;
+
+	// At least 74 clocks with chip select high
+	for (i = 0; i < 10; i++) {
+		sdc_Xfer(sd, 0xFF);
+	}
+
+	GPIO_ClearValue(sd->CSPort, (1UL << sd->CSPin));
+	r1 = SDC_R1_NO_RESPONSE;
+	for (i = 0; (i < 10) && (r1 != SDC_R1_IDLE); i++) {
+		r1 = sdc_Command(sd, SDC_CMD0, 0);
+	}
+	if (r1 != SDC_R1_IDLE) {
+		goto error;
+	}
+
+	// SD 2.0 answers CMD8 with the voltage range and check pattern
+	hcs = 0;
+	r1 = sdc_Command(sd, SDC_CMD8, 0x1AA);
+	if (r1 == SDC_R1_IDLE) {
+		for (i = 0; i < 4; i++) {
+			reg[i] = sdc_Xfer(sd, 0xFF);
+		}
+		if (((reg[2] & 0x0F) != 0x01) || (reg[3] != 0xAA)) {
+			goto error;
+		}
+		hcs = SDC_ACMD41_HCS;
+	} else if (!(r1 & SDC_R1_ILLEGAL_CMD)) {
+		goto error;
+	}
+
+	for (i = 0; i < SDC_INIT_RETRIES; i++) {
+		r1 = sdc_AppCommand(sd, SDC_ACMD41, hcs);
+		if (r1 != SDC_R1_IDLE) {
+			break;
+		}
+	}
+	if (r1 != 0) {
+		// MMC or no answer
+		goto error;
+	}
+	if (sd->CRCCheck && (sdc_Command(sd, SDC_CMD59, 1) != 0)) {
+		goto error;
+	}
+
+	sd->Type = SDC_TYPE_SDV1;
+	if (hcs) {
+		sd->Type = SDC_TYPE_SDV2;
+		if (sdc_Command(sd, SDC_CMD58, 0) != 0) {
+			goto error;
+		}
+		for (i = 0; i < 4; i++) {
+			reg[i] = sdc_Xfer(sd, 0xFF);
+		}
+		if (reg[0] & SDC_OCR_CCS) {
+			sd->Type = SDC_TYPE_SDHC;
+		}
+	}
+	if ((sd->Type != SDC_TYPE_SDHC)
+			&& (sdc_Command(sd, SDC_CMD16, SDC_BLOCK_SIZE) != 0)) {
+		goto error;
+	}
+
+	if ((sdc_Command(sd, SDC_CMD10, 0) != 0) || (sdc_ReadRegister(sd, sd->CID, 16) != SUCCESS)) {
+		goto error;
+	}
+	if ((sdc_Command(sd, SDC_CMD9, 0) != 0) || (sdc_ReadRegister(sd, reg, 16) != SUCCESS)) {
+		goto error;
+	}
+	if ((reg[0] >> 6) == 1) {
+		// CSD version 2.0: (C_SIZE + 1) * 512KB
+		csize = ((uint32_t)(reg[7] & 0x3F) << 16) | ((uint32_t)reg[8] << 8) | reg[9];
+		sd->dev.BlockCount = (csize + 1) << 10;
+	} else {
+		// CSD version 1.0: (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN
+		csize = ((uint32_t)(reg[6] & 0x03) << 10) | ((uint32_t)reg[7] << 2) | (reg[8] >> 6);
+		i = (((reg[9] & 0x03) << 1) | (reg[10] >> 7)) + 2 + (reg[5] & 0x0F);
+		sd->dev.BlockCount = (csize + 1) << (i - 9);
+	}
+	// TRAN_SPEED: time value * 10^unit * 10Kbit/s
+	csize = sdc_TranSpeed[(reg[3] >> 3) & 0x0F] * 10000UL;
+	for (i = (reg[3] & 0x07); (i != 0) && (csize < clock); i--) {
+		csize *= 10;
+	}
+	if ((csize != 0) && (csize < clock)) {
+		clock = csize;
+	}
+	sdc_Deselect(sd);
+
+	SSP_ConfigStruct.ClockRate = clock;
+	SSP_Init(sd->SSPx, &SSP_ConfigStruct);
+	SSP_Cmd(sd->SSPx, ENABLE);
+	sd->ClockRate = clock;
+	return SUCCESS;
+
+error:
+	sdc_Deselect(sd);
+	sd->Type = SDC_TYPE_NONE;
+	sd->ClockRate = clock;
+	return ERROR;
+}
+
+/*********************************************************************//**
+ * @brief		Continue the request in progress, to be called
+ * 				periodically: end of block if the GPDMA interrupt is not
+ * 				used, waits for the card (read token, write busy, stop).
+ * 				Same as BLK_Poll(&sd->dev).
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+void SDC_Poll(SDC_Type *sd)
+{
+	if ((sd->state == SDC_ST_RD_DATA) || (sd->state == SDC_ST_WR_DATA)) {
+		SDC_DMAHandler(sd);
+	} else {
+		sdc_Run(sd);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		GPDMA interrupt handler of the card: end of a block
+ * 				(receive channel terminal count) or GPDMA error. The CRC16
+ * 				of a received block is checked with CRCCheck, while the
+ * 				card prepares the next one.
+ * @param[in]	sd		point to SDC_Type structure
+ * @return 		None
+ **********************************************************************/
+void SDC_DMAHandler(SDC_Type *sd)
+{
+	uint16_t crc;
+	uint8_t resp;
+
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, sd->DMARx)
+			|| GPDMA_IntGetStatus(GPDMA_STAT_INTERR, sd->DMATx)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, sd->DMARx);
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, sd->DMATx);
+		if ((sd->state == SDC_ST_RD_DATA) || (sd->state == SDC_ST_WR_DATA)) {
+			sdc_DMAStop(sd);
+			sdc_Abort(sd);
+		}
+		return;
+	}
+	if (!GPDMA_IntGetStatus(GPDMA_STAT_INTTC, sd->DMARx)) {
+		return;
+	}
+	GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, sd->DMARx);
+	sdc_DMAStop(sd);
+
+	if (sd->state == SDC_ST_RD_DATA) {
+		crc = (uint16_t)sdc_Xfer(sd, 0xFF) << 8;
+		crc |= sdc_Xfer(sd, 0xFF);
+		if (sd->CRCCheck && (crc != SDC_Crc16(0, sd->buf, SDC_BLOCK_SIZE))) {
+			sd->crcerrors++;
+			sdc_Abort(sd);
+			return;
+		}
+		sd->buf += SDC_BLOCK_SIZE;
+		sd->n--;
+		if (sd->n != 0) {
+			sdc_SetWait(sd, SDC_ST_RD_TOKEN, SDC_READ_TIMEOUT);
+		} else if (sd->single) {
+			sdc_Finish(sd, SUCCESS);
+			return;
+		} else {
+			sdc_Command(sd, SDC_CMD12, 0);
+			sdc_SetWait(sd, SDC_ST_STOP, SDC_WRITE_TIMEOUT);
+		}
+	} else if (sd->state == SDC_ST_WR_DATA) {
+		sdc_Xfer(sd, (uint8_t)(sd->crc >> 8));
+		sdc_Xfer(sd, (uint8_t)sd->crc);
+		resp = sdc_Xfer(sd, 0xFF) & SDC_DATA_RESP_MASK;
+		if (resp != SDC_DATA_RESP_ACCEPTED) {
+			if (resp == SDC_DATA_RESP_CRC_ERROR) {
+				sd->crcerrors++;
+			}
+			sdc_Abort(sd);
+			return;
+		}
+		sd->buf += SDC_BLOCK_SIZE;
+		sd->n--;
+		sdc_SetWait(sd, SDC_ST_WR_BUSY, SDC_WRITE_TIMEOUT);
+	} else {
+		return;
+	}
+	sdc_Run(sd);
+}
+
+/*********************************************************************//**
+ * @brief		Compute the CRC7 of a command or register, table driven
+ * @param[in]	data	Bytes to compute the CRC of
+ * @param[in]	len		Number of bytes
+ * @return 		CRC7 (7 bits; a command sends (CRC7 << 1) | 1)
+ **********************************************************************/
+uint8_t SDC_Crc7(const uint8_t *data, uint32_t len)
+{
+	uint8_t crc = 0;
+
+	while (len--) {
+		crc = sdc_Crc7Table[(uint8_t)(crc << 1) ^ *data++];
+	}
+	return crc;
+}
+
+/*********************************************************************//**
+ * @brief		Compute or continue the CRC16 of a data block, table
+ * 				driven
+ * @param[in]	crc		0 to start, or the CRC of the previous bytes
+ * @param[in]	data	Bytes to compute the CRC of
+ * @param[in]	len		Number of bytes
+ * @return 		CRC16, sent MSB first after the block
+ **********************************************************************/
+uint16_t SDC_Crc16(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+	while (len--) {
+		crc = (uint16_t)(crc << 8) ^ sdc_Crc16Table[(uint8_t)(crc >> 8) ^ *data++];
+	}
+	return crc;
+}
+
+/**
+ * @}
+ */
+
+#endif /* _SDCARD */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
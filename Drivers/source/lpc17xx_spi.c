@@ -44,6 +44,97 @@
 
 #ifdef _SPI
 
+/* Private Types -------------------------------------------------------------- */
+/** @defgroup SPI_Private_Types SPI Private Types
+ * @{
+ */
+
+/**
+ * @brief Interrupt stream state. Kept as small as possible since it is
+ * the only data touched by SPI_StreamHandler() on every frame
+ */
+typedef struct {
+	const uint8_t *tx;				/**< Next data to send, NULL: send 0xFF */
+	uint8_t *rx;					/**< Next receive location, NULL: discard */
+	uint32_t left;					/**< Frames left in current segment */
+	const SPI_SEQ_SEG_Type *seg;	/**< Next segment to load */
+	uint32_t seg_left;				/**< Segments left to load */
+	SPI_SEQ_Type *seq;				/**< Running sequence, NULL if idle */
+} SPI_STREAM_Type;
+
+/**
+ * @}
+ */
+
+/* Private Variables ---------------------------------------------------------- */
+/** @defgroup SPI_Private_Variables SPI Private Variables
+ * @{
+ */
+
+/** Interrupt stream state */
+static SPI_STREAM_Type spi_stream;
+
+/** Segment and sequence used by SPI_StreamWrite() */
+static SPI_SEQ_SEG_Type spi_stream_wseg;
+static SPI_SEQ_Type spi_stream_wseq;
+
+/**
+ * @}
+ */
+
+/* Private Functions ---------------------------------------------------------- */
+/** @defgroup SPI_Private_Functions SPI Private Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief 		Load next non-empty segment of running stream
+ * @param[in] 	st	Pointer to stream state
+ * @return 		TRUE if a segment has been loaded, FALSE if sequence is over
+ ***********************************************************************/
+static Bool spi_stream_next (SPI_STREAM_Type *st)
+{
+	const SPI_SEQ_SEG_Type *seg;
+
+	while (st->seg_left != 0){
+		seg = st->seg++;
+		st->seg_left--;
+		if (seg->length != 0){
+			st->tx = seg->tx_data;
+			st->rx = seg->rx_data;
+			st->left = seg->length;
+			if (st->seq->seg_hook != NULL){
+				st->seq->seg_hook(seg->tag);
+			}
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*********************************************************************//**
+ * @brief 		Terminate running stream
+ * @param[in] 	SPIx	SPI peripheral selected, should be LPC_SPI
+ * @param[in] 	st		Pointer to stream state
+ * @param[in] 	status	Status to save in sequence
+ * @return 		None
+ ***********************************************************************/
+static void spi_stream_end (LPC_SPI_TypeDef *SPIx, SPI_STREAM_Type *st, uint32_t status)
+{
+	SPI_SEQ_Type *seq = st->seq;
+
+	SPIx->SPCR &= (~SPI_SPCR_SPIE) & SPI_SPCR_BITMASK;
+	seq->status = status;
+	st->seq = NULL;
+	if (seq->callback != NULL){
+		seq->callback();
+	}
+}
+
+/**
+ * @}
+ */
+
 
 /* Public Functions ----------------------------------------------------------- */
 /** @addtogroup SPI_Public_Functions
@@ -334,6 +425,133 @@ int32_t SPI_ReadWrite (LPC_SPI_TypeDef *SPIx, SPI_DATA_SETUP_Type *dataCfg, \
 }
 
 
+/*********************************************************************//**
+ * @brief 		Start an interrupt driven stream of segments on SPI.
+ * 				All segments are transferred back to back, the SPI interrupt
+ * 				handler SPI_StreamHandler() sends one frame per interrupt
+ * 				and only touches a small private state structure.
+ * @param[in]	SPIx 	Pointer to SPI peripheral, should be LPC_SPI
+ * @param[in]	seq		Pointer to a SPI_SEQ_Type structure that describes
+ * 						the sequence. It and its segments must stay valid
+ * 						until the sequence is complete.
+ * @return 		SUCCESS if sequence has been started (or is empty),
+ * 				ERROR if a stream is already running or SPI is not
+ * 				configured for 8-bit frames.
+ * Note: 		Application must call SPI_StreamHandler() from its
+ * 				SPI_IRQHandler() and enable the SPI interrupt in NVIC.
+ * 				Master mode only.
+ ***********************************************************************/
+Status SPI_StreamStart (LPC_SPI_TypeDef *SPIx, SPI_SEQ_Type *seq)
+{
+	SPI_STREAM_Type *st = &spi_stream;
+	uint32_t temp;
+
+	CHECK_PARAM(PARAM_SPIx(SPIx));
+
+	if ((st->seq != NULL) || (SPI_GetDataSize(SPIx) != 8)){
+		return ERROR;
+	}
+
+	//read for empty buffer
+	temp = SPIx->SPDR;
+	//dummy to clear status
+	temp = SPIx->SPSR;
+	(void) temp;
+	if (SPIx->SPINT & SPI_SPINT_INTFLAG){
+		SPIx->SPINT = SPI_SPINT_INTFLAG;
+	}
+
+	seq->status = 0;
+	st->seq = seq;
+	st->seg = seq->seg;
+	st->seg_left = seq->seg_num;
+	if (spi_stream_next(st) == FALSE){
+		spi_stream_end(SPIx, st, SPI_STAT_DONE);
+		return SUCCESS;
+	}
+
+	// Send first frame, the rest is chained from interrupt
+	SPIx->SPDR = (st->tx != NULL) ? *st->tx++ : 0xFF;
+	SPIx->SPCR |= SPI_SPCR_SPIE;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief 		Start a "fire and forget" transmit only stream on SPI.
+ * 				Received data is discarded.
+ * @param[in]	SPIx 		Pointer to SPI peripheral, should be LPC_SPI
+ * @param[in]	tx_data		Pointer to data to send, must stay valid until
+ * 							the transfer is complete
+ * @param[in]	length		Number of bytes to send
+ * @param[in]	callback	Called from interrupt when done, could be NULL
+ * @return 		SUCCESS if transfer has been started, ERROR if busy
+ ***********************************************************************/
+Status SPI_StreamWrite (LPC_SPI_TypeDef *SPIx, const uint8_t *tx_data, uint32_t length, \
+						void (*callback)(void))
+{
+	if (spi_stream.seq != NULL){
+		return ERROR;
+	}
+
+	spi_stream_wseg.tx_data = tx_data;
+	spi_stream_wseg.rx_data = NULL;
+	spi_stream_wseg.length = length;
+	spi_stream_wseg.tag = 0;
+	spi_stream_wseq.seg = &spi_stream_wseg;
+	spi_stream_wseq.seg_num = 1;
+	spi_stream_wseq.seg_hook = NULL;
+	spi_stream_wseq.callback = callback;
+	return SPI_StreamStart(SPIx, &spi_stream_wseq);
+}
+
+/*********************************************************************//**
+ * @brief 		Check whether an interrupt stream is running
+ * @param[in]	SPIx 	Pointer to SPI peripheral, should be LPC_SPI
+ * @return 		SET if running, otherwise RESET
+ ***********************************************************************/
+FlagStatus SPI_StreamBusy (LPC_SPI_TypeDef *SPIx)
+{
+	CHECK_PARAM(PARAM_SPIx(SPIx));
+
+	return ((spi_stream.seq != NULL) ? SET : RESET);
+}
+
+/*********************************************************************//**
+ * @brief 		SPI interrupt stream handler, should be called from
+ * 				SPI_IRQHandler() when SPI_StreamStart() is used.
+ * @param[in]	SPIx 	Pointer to SPI peripheral, should be LPC_SPI
+ * @return 		None
+ ***********************************************************************/
+void SPI_StreamHandler (LPC_SPI_TypeDef *SPIx)
+{
+	SPI_STREAM_Type *st = &spi_stream;
+	uint32_t stat;
+	uint32_t data;
+
+	SPIx->SPINT = SPI_SPINT_INTFLAG;
+	// Reading SPSR then SPDR clears SPIF
+	stat = SPIx->SPSR;
+	data = SPIx->SPDR;
+
+	if (st->seq == NULL){
+		return;
+	}
+	if (stat & (SPI_SPSR_ABRT | SPI_SPSR_MODF | SPI_SPSR_ROVR | SPI_SPSR_WCOL)){
+		spi_stream_end(SPIx, st, stat | SPI_STAT_ERROR);
+		return;
+	}
+
+	if (st->rx != NULL){
+		*st->rx++ = (uint8_t) data;
+	}
+	if ((--st->left == 0) && (spi_stream_next(st) == FALSE)){
+		spi_stream_end(SPIx, st, stat | SPI_STAT_DONE);
+		return;
+	}
+	SPIx->SPDR = (st->tx != NULL) ? *st->tx++ : 0xFF;
+}
+
+
 /********************************************************************//**
  * @brief 		Enable or disable SPIx interrupt.
  * @param[in]	SPIx	SPI peripheral selected, should be LPC_SPI
@@ -46,6 +46,73 @@
 
 #ifdef _SSP
 
+/* Private Macros ------------------------------------------------------------- */
+/** @addtogroup SSP_Private_Macros
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Instantiates one burst transfer loop for a fixed data width
+ * 				and direction. All width/direction tests are resolved by the
+ * 				compiler, so the loop body is only: wait RNE, read DR,
+ * 				(store), write DR.
+ * 				The TX FIFO is primed with SSP_FIFO_DEPTH frames, after
+ * 				that one frame is written for every frame read back, so
+ * 				exactly SSP_FIFO_DEPTH frames are in flight: the TX FIFO
+ * 				never runs dry and the RX FIFO can never overrun.
+ * @param[in]	name	Name of generated function
+ * @param[in]	type	uint8_t or uint16_t
+ * @param[in]	dummy	Value sent when there is no transmit buffer
+ * @param[in]	tx_en	1: transmit data from buffer, 0: transmit dummy
+ * @param[in]	rx_en	1: store received data, 0: discard received data
+ **********************************************************************/
+#define SSP_BURST_FUNC(name, type, dummy, tx_en, rx_en) \
+static void name (LPC_SSP_TypeDef *SSPx, const type *wdata, type *rdata, uint32_t len) \
+{ \
+	uint32_t txleft = len; \
+	uint32_t rxleft = len; \
+	uint32_t tmp; \
+	/* Prime TX FIFO */ \
+	while ((txleft != 0) && ((len - txleft) < SSP_FIFO_DEPTH)) { \
+		SSPx->DR = (tx_en) ? *wdata++ : (dummy); \
+		txleft--; \
+	} \
+	/* Keep the FIFO full: one frame in for every frame out */ \
+	while (rxleft != 0) { \
+		while (!(SSPx->SR & SSP_SR_RNE)); \
+		tmp = SSPx->DR; \
+		if (rx_en) { \
+			*rdata++ = (type) tmp; \
+		} \
+		rxleft--; \
+		if (txleft != 0) { \
+			SSPx->DR = (tx_en) ? *wdata++ : (dummy); \
+			txleft--; \
+		} \
+	} \
+	(void) tmp; \
+}
+
+/**
+ * @}
+ */
+
+/* Private Functions ---------------------------------------------------------- */
+/** @addtogroup SSP_Private_Functions
+ * @{
+ */
+
+SSP_BURST_FUNC(ssp_burst8_tx,    uint8_t,  0xFF,   1, 0)
+SSP_BURST_FUNC(ssp_burst8_rx,    uint8_t,  0xFF,   0, 1)
+SSP_BURST_FUNC(ssp_burst8_txrx,  uint8_t,  0xFF,   1, 1)
+SSP_BURST_FUNC(ssp_burst16_tx,   uint16_t, 0xFFFF, 1, 0)
+SSP_BURST_FUNC(ssp_burst16_rx,   uint16_t, 0xFFFF, 0, 1)
+SSP_BURST_FUNC(ssp_burst16_txrx, uint16_t, 0xFFFF, 1, 1)
+
+/**
+ * @}
+ */
+
 /* Public Functions ----------------------------------------------------------- */
 /** @addtogroup SSP_Public_Functions
  * @{
@@ -513,6 +580,89 @@ int32_t SSP_ReadWrite (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg, \
 	return (-1);
 }
 
+/*********************************************************************//**
+ * @brief 		SSP burst read write data function (polling mode only).
+ * 				Same semantic as SSP_ReadWrite() in polling mode, but the
+ * 				data width and direction are decoded once per call and the
+ * 				transfer is done by a specialized loop that keeps the
+ * 				FIFO full, so there is no idle gap between frames.
+ * @param[in]	SSPx 	Pointer to SSP peripheral, should be
+ * 						- LPC_SSP0: SSP0 peripheral
+ * 						- LPC_SSP1: SSP1 peripheral
+ * @param[in]	dataCfg	Pointer to a SSP_DATA_SETUP_Type structure that
+ * 						contains specified information about transmit
+ * 						data configuration. tx_data or rx_data could be
+ * 						NULL for receive only or transmit only transfer,
+ * 						not both.
+ * @return 		Actual Data length has been transferred.
+ * 				Return (-1) if error or if both tx_data and rx_data
+ * 				are NULL.
+ * Note: This function should be used in master mode only, the RX overrun
+ * flag is checked once at the end of transfer.
+ ***********************************************************************/
+int32_t SSP_ReadWriteBurst (LPC_SSP_TypeDef *SSPx, SSP_DATA_SETUP_Type *dataCfg)
+{
+	uint32_t stat;
+	uint32_t len;
+
+	CHECK_PARAM(PARAM_SSPx(SSPx));
+
+	dataCfg->rx_cnt = 0;
+	dataCfg->tx_cnt = 0;
+	dataCfg->status = 0;
+
+	// Nothing to send and nowhere to store: the rx loops need rx_data
+	if ((dataCfg->tx_data == NULL) && (dataCfg->rx_data == NULL)){
+		dataCfg->status = SSP_STAT_ERROR;
+		return (-1);
+	}
+
+	/* Clear all remaining data in RX FIFO */
+	while (SSPx->SR & SSP_SR_RNE){
+		stat = SSPx->DR;
+	}
+
+	// Clear status
+	SSPx->ICR = SSP_ICR_BITMASK;
+
+	if (SSP_GetDataSize(SSPx) > 8){
+		len = dataCfg->length >> 1;
+		if (dataCfg->tx_data == NULL){
+			ssp_burst16_rx(SSPx, NULL, (uint16_t *)dataCfg->rx_data, len);
+		} else if (dataCfg->rx_data == NULL){
+			ssp_burst16_tx(SSPx, (uint16_t *)dataCfg->tx_data, NULL, len);
+		} else {
+			ssp_burst16_txrx(SSPx, (uint16_t *)dataCfg->tx_data, \
+								(uint16_t *)dataCfg->rx_data, len);
+		}
+		len <<= 1;
+	} else {
+		len = dataCfg->length;
+		if (dataCfg->tx_data == NULL){
+			ssp_burst8_rx(SSPx, NULL, (uint8_t *)dataCfg->rx_data, len);
+		} else if (dataCfg->rx_data == NULL){
+			ssp_burst8_tx(SSPx, (uint8_t *)dataCfg->tx_data, NULL, len);
+		} else {
+			ssp_burst8_txrx(SSPx, (uint8_t *)dataCfg->tx_data, \
+								(uint8_t *)dataCfg->rx_data, len);
+		}
+	}
+
+	// Check overrun error
+	if ((stat = SSPx->RIS) & SSP_RIS_ROR){
+		// save status and return
+		dataCfg->status = stat | SSP_STAT_ERROR;
+		return (-1);
+	}
+
+	dataCfg->tx_cnt = len;
+	dataCfg->rx_cnt = len;
+	// save status
+	dataCfg->status = SSP_STAT_DONE;
+
+	return len;
+}
+
 /*********************************************************************//**
  * @brief		Checks whether the specified SSP status flag is set or not
  * @param[in]	SSPx	SSP peripheral selected, should be:
@@ -0,0 +1,1778 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev.c			2011-03-09
+*//**
+* @file		lpc17xx_usbdev.c
+* @brief	Contains all functions support for the USB device controller:
+* 			hardware layer, chapter 9 core, endpoint dispatch table and
+* 			class driver registration on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup USBDEV
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev.h"
+#include "lpc17xx_clkpwr.h"
+
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _USBDEV
+
+/* Private Macros ------------------------------------------------------------- */
+/* Device Interrupt Bit Definitions */
+#define FRAME_INT           0x00000001
+#define EP_FAST_INT         0x00000002
+#define EP_SLOW_INT         0x00000004
+#define DEV_STAT_INT        0x00000008
+#define CCEMTY_INT          0x00000010
+#define CDFULL_INT          0x00000020
+#define RxENDPKT_INT        0x00000040
+#define TxENDPKT_INT        0x00000080
+#define EP_RLZED_INT        0x00000100
+#define ERR_INT             0x00000200
+
+/* Rx & Tx Packet Length Definitions */
+#define PKT_LNGTH_MASK      0x000003FF
+#define PKT_DV              0x00000400
+#define PKT_RDY             0x00000800
+
+/* USB Control Definitions */
+#define CTRL_RD_EN          0x00000001
+#define CTRL_WR_EN          0x00000002
+
+/* Command Codes */
+#define CMD_SET_ADDR        0x00D00500
+#define CMD_CFG_DEV         0x00D80500
+#define CMD_SET_MODE        0x00F30500
+#define CMD_RD_FRAME        0x00F50500
+#define DAT_RD_FRAME        0x00F50200
+#define CMD_SET_DEV_STAT    0x00FE0500
+#define CMD_GET_DEV_STAT    0x00FE0500
+#define DAT_GET_DEV_STAT    0x00FE0200
+#define CMD_RD_ERR_STAT     0x00FB0500
+#define DAT_RD_ERR_STAT     0x00FB0200
+#define DAT_WR_BYTE(x)     (0x00000100 | ((x) << 16))
+#define CMD_SEL_EP(x)      (0x00000500 | ((x) << 16))
+#define CMD_SET_EP_STAT(x) (0x00400500 | ((x) << 16))
+#define CMD_CLR_BUF         0x00F20500
+#define CMD_VALID_BUF       0x00FA0500
+
+/* Device Address Register Definitions */
+#define DEV_EN              0x80
+
+/* Device Configure Register Definitions */
+#define CONF_DVICE          0x01
+
+/* Device Status Register Definitions */
+#define DEV_CON             0x01
+#define DEV_CON_CH          0x02
+#define DEV_SUS             0x04
+#define DEV_SUS_CH          0x08
+#define DEV_RST             0x10
+
+/* Endpoint Select Register Definitions */
+#define EP_SEL_STP          0x04
+
+/* Endpoint Status Register Definitions */
+#define EP_STAT_ST          0x01
+#define EP_STAT_DA          0x20
+
+/* DMA Interrupt Bit Definitions */
+#define EOT_INT             0x01
+#define NDD_REQ_INT         0x02
+#define SYS_ERR_INT         0x04
+
+/** Isochronous Endpoint Logical Address Mask */
+#define EP_MSK_ISO          0x1248
+
+/** Bit of an endpoint address (bit 7: IN) in USB_EndPointMask/Halt/Stall */
+#define EP_MSK(n)           (((n) & 0x80) ? ((1 << 16) << ((n) & 0x0F)) : (1 << ((n) & 0x0F)))
+
+#ifdef _USB_DMA
+/** UDCA (USB Device Communication Area) at the start of USB RAM */
+#define UDCA                ((volatile uint32_t *)USB_RAM_ADR)
+#endif
+
+/** DWT cycle counter of the core, for the interrupt statistics */
+#define DWT_CTRL            (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT          (*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA  0x00000001
+
+/* Public Variables ----------------------------------------------------------- */
+/** @addtogroup USBDEV_Public_Variables
+ * @{
+ */
+
+uint16_t USB_DeviceStatus;
+uint8_t  USB_DeviceAddress;
+uint8_t  USB_Configuration;
+uint32_t USB_EndPointMask;
+uint32_t USB_EndPointHalt;
+uint32_t USB_EndPointStall;						/* EP must stay stalled */
+uint8_t  USB_AltSetting[USB_IF_NUM];
+
+uint8_t  EP0Buf[USB_EP0_BUF_SIZE];
+
+USB_EP_DATA EP0Data;
+
+USB_SETUP_PACKET SetupPacket;
+
+/**
+ * @}
+ */
+
+/* Private Variables ---------------------------------------------------------- */
+/** Device configuration given to USB_Init() */
+static const USBDEV_CFG_Type *usb_cfg;
+/** Registered class drivers */
+static USBDEV_CLASS_Type *usb_classes;
+/** Endpoint dispatch table, indexed by physical endpoint */
+static struct {
+	USBDEV_EP_HANDLER handler;
+	void *arg;
+} usb_ep[USB_EP_NUM];
+/** Endpoint 0 max packet size */
+static uint32_t usb_MaxPacket0;
+/** Number of interfaces of the current configuration */
+static uint8_t usb_NumInterfaces;
+/** A zero length packet must end the control IN data stage */
+static uint8_t usb_zlp;
+/** Class driver that accepted the current control OUT request */
+static USBDEV_CLASS_Type *usb_ReqClass;
+/** Start of the current control OUT data stage */
+static uint8_t *usb_OutBuf;
+/** Configuration descriptors by index, set by USB_Init() */
+static const uint8_t *usb_config[USB_CONFIG_NUM];
+static uint32_t usb_NumConfigs;
+/** String descriptors by index, set by USB_Init() */
+static const uint8_t *usb_string[USB_STRING_NUM];
+static uint32_t usb_NumStrings;
+/** SIE command in progress: device interrupt bit (CCEMTY_INT or
+ * CDFULL_INT) to wait for before the next one, 0 if none */
+static uint32_t usb_cmdwait;
+/** Deferred calls, run by USB_Task() */
+static struct {
+	USBDEV_DEFER_FUNC func;
+	void *arg;
+	uint32_t event;
+	uint32_t param;
+} usb_defer[USB_DEFER_NUM];
+/** Calls queued by USB_Defer() and run by USB_Task(), free running */
+static volatile uint32_t usb_deferhead;
+static volatile uint32_t usb_defertail;
+/** Interrupt statistics */
+static USBDEV_STATS_Type usb_stats;
+
+#ifdef _USB_DMA
+/** UDCA saved values */
+static uint32_t udca[USB_EP_NUM];
+/** DMA Descriptor Memory Usage */
+static uint32_t DDMemMap[2];
+/* DMA Descriptor Memory Layout */
+static const uint32_t DDAdr[2] = { DD_NISO_ADR, DD_ISO_ADR };
+static const uint32_t DDSz [2] = { 16,          20         };
+#endif
+
+/* Private Functions ---------------------------------------------------------- */
+
+static uint32_t EPAdr(uint32_t EPNum);
+static void usb_CmdSync(void);
+static void WrCmd(uint32_t cmd);
+static void WrCmdDat(uint32_t cmd, uint32_t val);
+static void WrCmdEP(uint32_t EPNum, uint32_t cmd);
+static uint32_t RdCmdDat(uint32_t cmd);
+static void usb_Stat(USBDEV_ISR_STAT_Type *stat, uint32_t start);
+static void usb_DeferEvent(void *arg, uint32_t event, uint32_t param);
+static void usb_DevEvent(uint32_t event, uint32_t param);
+static void usb_Event(uint32_t event, uint32_t param);
+static void usb_SetDevIntEn(void);
+static USBDEV_CLASS_Type *usb_FindClass(void);
+static void usb_DataInStage(void);
+static void usb_DataInStart(void);
+static uint32_t usb_ReqGetStatus(void);
+static uint32_t usb_ReqSetClrFeature(uint32_t sc);
+static void usb_IndexDescriptors(void);
+static uint32_t usb_ReqGetDescriptor(void);
+static void usb_DisableEPs(void);
+static uint32_t usb_ReqSetConfiguration(void);
+static uint32_t usb_ReqSetInterface(void);
+static void usb_EndPoint0(void *arg, uint32_t event);
+
+/*********************************************************************//**
+ * @brief		Get endpoint physical address
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		Endpoint physical address
+ **********************************************************************/
+static uint32_t EPAdr(uint32_t EPNum)
+{
+	uint32_t val;
+
+	val = (EPNum & 0x0F) << 1;
+	if (EPNum & 0x80) {
+		val += 1;
+	}
+	return (val);
+}
+
+/*********************************************************************//**
+ * @brief		Wait for the end of the SIE command in progress. Commands
+ * 				are posted: the CPU goes on while the SIE runs one, and
+ * 				waits only before the next command or a packet transfer
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void usb_CmdSync(void)
+{
+	if (usb_cmdwait != 0) {
+		while ((LPC_USB->USBDevIntSt & usb_cmdwait) == 0);
+		usb_cmdwait = 0;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Write SIE command, posted
+ * @param[in]	cmd		Command
+ * @return 		None
+ **********************************************************************/
+static void WrCmd(uint32_t cmd)
+{
+	usb_CmdSync();
+	LPC_USB->USBDevIntClr = CCEMTY_INT;
+	LPC_USB->USBCmdCode = cmd;
+	usb_cmdwait = CCEMTY_INT;
+}
+
+/*********************************************************************//**
+ * @brief		Write SIE command and its data
+ * @param[in]	cmd		Command
+ * @param[in]	val		Data
+ * @return 		None
+ **********************************************************************/
+static void WrCmdDat(uint32_t cmd, uint32_t val)
+{
+	WrCmd(cmd);
+	WrCmd(val);
+}
+
+/*********************************************************************//**
+ * @brief		Write SIE command to an endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @param[in]	cmd		Command
+ * @return 		None
+ **********************************************************************/
+static void WrCmdEP(uint32_t EPNum, uint32_t cmd)
+{
+	WrCmd(CMD_SEL_EP(EPAdr(EPNum)));
+	WrCmd(cmd);
+}
+
+/*********************************************************************//**
+ * @brief		Read SIE command data
+ * @param[in]	cmd		Command
+ * @return 		Data value
+ **********************************************************************/
+static uint32_t RdCmdDat(uint32_t cmd)
+{
+	usb_CmdSync();
+	LPC_USB->USBDevIntClr = CCEMTY_INT | CDFULL_INT;
+	LPC_USB->USBCmdCode = cmd;
+	while ((LPC_USB->USBDevIntSt & CDFULL_INT) == 0);
+	return (LPC_USB->USBCmdData);
+}
+
+/*********************************************************************//**
+ * @brief		Add the duration of an interrupt event to its statistics
+ * @param[in]	stat	Point to USBDEV_ISR_STAT_Type structure
+ * @param[in]	start	Cycle counter at the start of the event
+ * @return 		None
+ **********************************************************************/
+static void usb_Stat(USBDEV_ISR_STAT_Type *stat, uint32_t start)
+{
+	uint32_t t;
+
+	t = DWT_CYCCNT - start;
+	stat->Count++;
+	stat->Cycles += t;
+	if (t > stat->Max) {
+		stat->Max = t;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Deferred device event: pass it to the device callback
+ * @param[in]	arg		Not used
+ * @param[in]	event	USBDEV_EVT_xxx
+ * @param[in]	param	Event parameter
+ * @return 		None
+ **********************************************************************/
+static void usb_DeferEvent(void *arg, uint32_t event, uint32_t param)
+{
+	(void)arg;
+	usb_cfg->Event(event, param);
+}
+
+/*********************************************************************//**
+ * @brief		Pass a device event to the device callback, now or from
+ * 				USB_Task() if it is in DeferMask
+ * @param[in]	event	USBDEV_EVT_xxx
+ * @param[in]	param	Event parameter
+ * @return 		None
+ **********************************************************************/
+static void usb_DevEvent(uint32_t event, uint32_t param)
+{
+	if ((usb_cfg->Event != NULL) && (usb_cfg->EventMask & event)) {
+		if (usb_cfg->DeferMask & event) {
+			USB_Defer(usb_DeferEvent, NULL, event, param);
+		} else {
+			usb_cfg->Event(event, param);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Pass a device event to the device callback (now or from
+ * 				USB_Task() if it is in DeferMask) and to every registered
+ * 				class driver that selected it
+ * @param[in]	event	USBDEV_EVT_xxx
+ * @param[in]	param	Event parameter
+ * @return 		None
+ **********************************************************************/
+static void usb_Event(uint32_t event, uint32_t param)
+{
+	USBDEV_CLASS_Type *cls;
+
+	usb_DevEvent(event, param);
+	for (cls = usb_classes; cls != NULL; cls = cls->next) {
+		if ((cls->Event != NULL) && (cls->EventMask & event)) {
+			cls->Event(cls->arg, event, param);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Enable the device interrupts: always device status and
+ * 				slow endpoint, frame and error when a callback needs them
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void usb_SetDevIntEn(void)
+{
+	USBDEV_CLASS_Type *cls;
+	uint32_t mask;
+
+	mask = usb_cfg->EventMask;
+	for (cls = usb_classes; cls != NULL; cls = cls->next) {
+		mask |= cls->EventMask;
+	}
+	LPC_USB->USBDevIntEn = DEV_STAT_INT | EP_SLOW_INT |
+				((mask & USBDEV_EVT_SOF) ? FRAME_INT : 0) |
+				((mask & USBDEV_EVT_ERROR) ? ERR_INT : 0);
+}
+
+/*********************************************************************//**
+ * @brief		Find the class driver owning the recipient (interface or
+ * 				endpoint) of the current setup packet
+ * @param[in]	None (global SetupPacket)
+ * @return 		Class driver, NULL if none
+ **********************************************************************/
+static USBDEV_CLASS_Type *usb_FindClass(void)
+{
+	USBDEV_CLASS_Type *cls;
+	uint32_t n;
+
+	n = SetupPacket.wIndex.WB.L;
+	for (cls = usb_classes; cls != NULL; cls = cls->next) {
+		switch (SetupPacket.bmRequestType.BM.Recipient) {
+		case REQUEST_TO_INTERFACE:
+			if ((n >= cls->FirstIF) && (n < (cls->FirstIF + cls->NumIF))) {
+				return cls;
+			}
+			break;
+		case REQUEST_TO_ENDPOINT:
+			if (cls->EPMask & (1 << EPAdr(n))) {
+				return cls;
+			}
+			break;
+		default:
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+/*********************************************************************//**
+ * @brief		Control IN data stage: send the next packet
+ * @param[in]	None (global EP0Data)
+ * @return 		None
+ **********************************************************************/
+static void usb_DataInStage(void)
+{
+	uint32_t cnt;
+
+	if (EP0Data.Count > usb_MaxPacket0) {
+		cnt = usb_MaxPacket0;
+	} else {
+		cnt = EP0Data.Count;
+	}
+	cnt = USB_WriteEP(0x80, EP0Data.pData, cnt);
+	EP0Data.pData += cnt;
+	EP0Data.Count -= cnt;
+	// A short packet ends the data stage
+	if (cnt < usb_MaxPacket0) {
+		usb_zlp = FALSE;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Start a control IN data stage. When less data than
+ * 				requested is sent and its length is a multiple of the max
+ * 				packet size, a zero length packet ends the data stage.
+ * @param[in]	None (global EP0Data, SetupPacket)
+ * @return 		None
+ **********************************************************************/
+static void usb_DataInStart(void)
+{
+	if (EP0Data.Count >= SetupPacket.wLength) {
+		EP0Data.Count = SetupPacket.wLength;
+		usb_zlp = FALSE;
+	} else {
+		usb_zlp = TRUE;
+	}
+	usb_DataInStage();
+}
+
+/*********************************************************************//**
+ * @brief		Get Status request
+ * @param[in]	None (global SetupPacket)
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t usb_ReqGetStatus(void)
+{
+	uint32_t n, m;
+
+	switch (SetupPacket.bmRequestType.BM.Recipient) {
+	case REQUEST_TO_DEVICE:
+		EP0Buf[0] = (uint8_t)USB_DeviceStatus;
+		EP0Buf[1] = 0;
+		break;
+	case REQUEST_TO_INTERFACE:
+		if ((USB_Configuration == 0) || (SetupPacket.wIndex.WB.L >= usb_NumInterfaces)) {
+			return (FALSE);
+		}
+		EP0Buf[0] = 0;
+		EP0Buf[1] = 0;
+		break;
+	case REQUEST_TO_ENDPOINT:
+		n = SetupPacket.wIndex.WB.L & 0x8F;
+		m = EP_MSK(n);
+		if (((USB_Configuration == 0) && ((n & 0x0F) != 0)) || !(USB_EndPointMask & m)) {
+			return (FALSE);
+		}
+		EP0Buf[0] = (USB_EndPointHalt & m) ? 1 : 0;
+		EP0Buf[1] = 0;
+		break;
+	default:
+		return (FALSE);
+	}
+	EP0Data.pData = EP0Buf;
+	EP0Data.Count = 2;
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Set/Clear Feature request
+ * @param[in]	sc		0 - Clear, 1 - Set (global SetupPacket)
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t usb_ReqSetClrFeature(uint32_t sc)
+{
+	USBDEV_CLASS_Type *cls;
+	uint32_t n, m;
+
+	switch (SetupPacket.bmRequestType.BM.Recipient) {
+	case REQUEST_TO_DEVICE:
+		if (SetupPacket.wValue.W != USB_FEATURE_REMOTE_WAKEUP) {
+			return (FALSE);
+		}
+		USB_WakeUpCfg(sc);
+		if (sc) {
+			USB_DeviceStatus |=  USB_GETSTATUS_REMOTE_WAKEUP;
+		} else {
+			USB_DeviceStatus &= ~USB_GETSTATUS_REMOTE_WAKEUP;
+		}
+		break;
+	case REQUEST_TO_ENDPOINT:
+		n = SetupPacket.wIndex.WB.L & 0x8F;
+		m = EP_MSK(n);
+		if ((USB_Configuration == 0) || ((n & 0x0F) == 0) || !(USB_EndPointMask & m)
+				|| (SetupPacket.wValue.W != USB_FEATURE_ENDPOINT_STALL)) {
+			return (FALSE);
+		}
+		if (sc) {
+			USB_SetStallEP(n);
+			USB_EndPointHalt |=  m;
+		} else {
+			if ((USB_EndPointStall & m) != 0) {
+				return (TRUE);
+			}
+			USB_ClrStallEP(n);
+			if ((USB_EndPointHalt & m) != 0) {
+				USB_EndPointHalt &= ~m;
+				cls = usb_FindClass();
+				if ((cls != NULL) && (cls->Event != NULL)) {
+					cls->Event(cls->arg, USBDEV_EVT_CLEAR_HALT, n);
+				}
+			}
+		}
+		break;
+	default:
+		return (FALSE);
+	}
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Index the configuration and string descriptors once, so
+ * 				that the Get Descriptor request does not walk them
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void usb_IndexDescriptors(void)
+{
+	const uint8_t *pD;
+
+	usb_NumConfigs = 0;
+	for (pD = usb_cfg->ConfigDescriptor; (pD[0] != 0) && (usb_NumConfigs < USB_CONFIG_NUM);
+			pD += ((USB_CONFIGURATION_DESCRIPTOR *)pD)->wTotalLength) {
+		usb_config[usb_NumConfigs++] = pD;
+	}
+	usb_NumStrings = 0;
+	pD = usb_cfg->StringDescriptor;
+	if (pD != NULL) {
+		for (; (pD[0] != 0) && (usb_NumStrings < USB_STRING_NUM); pD += pD[0]) {
+			usb_string[usb_NumStrings++] = pD;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Get Descriptor request. Class descriptors of an interface
+ * 				are asked to the class driver owning it.
+ * @param[in]	None (global SetupPacket)
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t usb_ReqGetDescriptor(void)
+{
+	USBDEV_CLASS_Type *cls;
+	const uint8_t *pD;
+	uint32_t len, n;
+
+	switch (SetupPacket.bmRequestType.BM.Recipient) {
+	case REQUEST_TO_DEVICE:
+		switch (SetupPacket.wValue.WB.H) {
+		case USB_DEVICE_DESCRIPTOR_TYPE:
+			pD = usb_cfg->DeviceDescriptor;
+			len = USB_DEVICE_DESC_SIZE;
+			break;
+		case USB_CONFIGURATION_DESCRIPTOR_TYPE:
+			n = SetupPacket.wValue.WB.L;
+			if (n >= usb_NumConfigs) {
+				return (FALSE);
+			}
+			pD = usb_config[n];
+			len = ((USB_CONFIGURATION_DESCRIPTOR *)pD)->wTotalLength;
+			break;
+		case USB_STRING_DESCRIPTOR_TYPE:
+			n = SetupPacket.wValue.WB.L;
+			if (n >= usb_NumStrings) {
+				return (FALSE);
+			}
+			pD = usb_string[n];
+			len = pD[0];
+			break;
+		default:
+			return (FALSE);
+		}
+		EP0Data.pData = (uint8_t *)pD;
+		EP0Data.Count = len;
+		break;
+	case REQUEST_TO_INTERFACE:
+		cls = usb_FindClass();
+		if ((cls == NULL) || (cls->Request == NULL)) {
+			return (FALSE);
+		}
+		EP0Data.pData = EP0Buf;
+		return (cls->Request(cls->arg, &SetupPacket, &EP0Data));
+	default:
+		return (FALSE);
+	}
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Disable all endpoints but endpoint 0, clear their halt
+ * 				and stall state
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void usb_DisableEPs(void)
+{
+	uint32_t n;
+
+	for (n = 1; n < 16; n++) {
+		if (USB_EndPointMask & (1 << n)) {
+			USB_DisableEP(n);
+		}
+		if (USB_EndPointMask & ((1 << 16) << n)) {
+			USB_DisableEP(n | 0x80);
+		}
+	}
+	USB_EndPointMask  = 0x00010001;
+	USB_EndPointHalt  = 0x00000000;
+	USB_EndPointStall = 0x00000000;
+}
+
+/*********************************************************************//**
+ * @brief		Set Configuration request: realize and enable the
+ * 				endpoints of alternate setting 0 of every interface
+ * @param[in]	None (global SetupPacket)
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t usb_ReqSetConfiguration(void)
+{
+	const uint8_t *pD;
+	uint32_t alt = 0;
+	uint32_t n, found;
+
+	if (SetupPacket.bmRequestType.BM.Recipient != REQUEST_TO_DEVICE) {
+		return (FALSE);
+	}
+
+	if (SetupPacket.wValue.WB.L == 0) {
+		USB_Configuration = 0;
+		usb_DisableEPs();
+		USB_Configure(FALSE);
+		return (TRUE);
+	}
+
+	found = FALSE;
+	pD = usb_cfg->ConfigDescriptor;
+	while (pD[0] != 0) {
+		switch (pD[1]) {
+		case USB_CONFIGURATION_DESCRIPTOR_TYPE:
+			if (found || (((USB_CONFIGURATION_DESCRIPTOR *)pD)->bConfigurationValue
+					!= SetupPacket.wValue.WB.L)) {
+				pD += ((USB_CONFIGURATION_DESCRIPTOR *)pD)->wTotalLength;
+				continue;
+			}
+			found = TRUE;
+			USB_Configuration = SetupPacket.wValue.WB.L;
+			usb_NumInterfaces = ((USB_CONFIGURATION_DESCRIPTOR *)pD)->bNumInterfaces;
+			for (n = 0; n < USB_IF_NUM; n++) {
+				USB_AltSetting[n] = 0;
+			}
+			usb_DisableEPs();
+			USB_Configure(TRUE);
+			if (((USB_CONFIGURATION_DESCRIPTOR *)pD)->bmAttributes & USB_CONFIG_POWERED_MASK) {
+				USB_DeviceStatus |=  USB_GETSTATUS_SELF_POWERED;
+			} else {
+				USB_DeviceStatus &= ~USB_GETSTATUS_SELF_POWERED;
+			}
+			break;
+		case USB_INTERFACE_DESCRIPTOR_TYPE:
+			alt = ((USB_INTERFACE_DESCRIPTOR *)pD)->bAlternateSetting;
+			break;
+		case USB_ENDPOINT_DESCRIPTOR_TYPE:
+			if (alt == 0) {
+				n = ((USB_ENDPOINT_DESCRIPTOR *)pD)->bEndpointAddress & 0x8F;
+				USB_EndPointMask |= EP_MSK(n);
+				USB_ConfigEP((USB_ENDPOINT_DESCRIPTOR *)pD);
+				USB_EnableEP(n);
+				USB_ResetEP(n);
+			}
+			break;
+		}
+		pD += pD[0];
+	}
+	return (found);
+}
+
+/*********************************************************************//**
+ * @brief		Set Interface request: disable the endpoints of the old
+ * 				alternate setting, enable the ones of the new
+ * @param[in]	None (global SetupPacket)
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t usb_ReqSetInterface(void)
+{
+	const uint8_t *pD;
+	uint32_t ifn = 0, alt = 0, old = 0, msk = 0;
+	uint32_t n, m, set;
+
+	if ((SetupPacket.bmRequestType.BM.Recipient != REQUEST_TO_INTERFACE)
+			|| (USB_Configuration == 0) || (SetupPacket.wIndex.WB.L >= USB_IF_NUM)) {
+		return (FALSE);
+	}
+
+	set = FALSE;
+	pD = usb_cfg->ConfigDescriptor;
+	while (pD[0] != 0) {
+		switch (pD[1]) {
+		case USB_CONFIGURATION_DESCRIPTOR_TYPE:
+			if (((USB_CONFIGURATION_DESCRIPTOR *)pD)->bConfigurationValue != USB_Configuration) {
+				pD += ((USB_CONFIGURATION_DESCRIPTOR *)pD)->wTotalLength;
+				continue;
+			}
+			break;
+		case USB_INTERFACE_DESCRIPTOR_TYPE:
+			ifn = ((USB_INTERFACE_DESCRIPTOR *)pD)->bInterfaceNumber;
+			alt = ((USB_INTERFACE_DESCRIPTOR *)pD)->bAlternateSetting;
+			msk = 0;
+			if ((ifn == SetupPacket.wIndex.WB.L) && (alt == SetupPacket.wValue.WB.L)) {
+				set = TRUE;
+				old = USB_AltSetting[ifn];
+				USB_AltSetting[ifn] = (uint8_t)alt;
+			}
+			break;
+		case USB_ENDPOINT_DESCRIPTOR_TYPE:
+			if (ifn == SetupPacket.wIndex.WB.L) {
+				n = ((USB_ENDPOINT_DESCRIPTOR *)pD)->bEndpointAddress & 0x8F;
+				m = EP_MSK(n);
+				if (alt == SetupPacket.wValue.WB.L) {
+					USB_EndPointMask |=  m;
+					USB_EndPointHalt &= ~m;
+					USB_ConfigEP((USB_ENDPOINT_DESCRIPTOR *)pD);
+					USB_EnableEP(n);
+					USB_ResetEP(n);
+					msk |= m;
+				} else if ((alt == old) && ((msk & m) == 0)) {
+					USB_EndPointMask &= ~m;
+					USB_EndPointHalt &= ~m;
+					USB_DisableEP(n);
+				}
+			}
+			break;
+		}
+		pD += pD[0];
+	}
+	return (set);
+}
+
+/*********************************************************************//**
+ * @brief		Endpoint 0 event handler: standard requests are handled
+ * 				here, class and vendor requests are passed to the class
+ * 				driver owning their interface or endpoint
+ * @param[in]	arg		Not used
+ * @param[in]	event	USB_EVT_xxx
+ * @return 		None
+ **********************************************************************/
+static void usb_EndPoint0(void *arg, uint32_t event)
+{
+	USBDEV_CLASS_Type *cls;
+	uint32_t cnt;
+
+	(void)arg;
+
+	switch (event) {
+	case USB_EVT_SETUP:
+		USB_ReadEP(0x00, (uint8_t *)&SetupPacket);
+		EP0Data.pData = EP0Buf;
+		EP0Data.Count = SetupPacket.wLength;
+		usb_ReqClass = NULL;
+		switch (SetupPacket.bmRequestType.BM.Type) {
+		case REQUEST_STANDARD:
+			switch (SetupPacket.bRequest) {
+			case USB_REQUEST_GET_STATUS:
+				if (!usb_ReqGetStatus()) {
+					goto stall_i;
+				}
+				usb_DataInStart();
+				break;
+			case USB_REQUEST_CLEAR_FEATURE:
+			case USB_REQUEST_SET_FEATURE:
+				if (!usb_ReqSetClrFeature(SetupPacket.bRequest == USB_REQUEST_SET_FEATURE)) {
+					goto stall_i;
+				}
+				USB_WriteEP(0x80, NULL, 0);
+				usb_Event(USBDEV_EVT_FEATURE, SetupPacket.wValue.W);
+				break;
+			case USB_REQUEST_SET_ADDRESS:
+				if (SetupPacket.bmRequestType.BM.Recipient != REQUEST_TO_DEVICE) {
+					goto stall_i;
+				}
+				// New address is set when the status stage is done
+				USB_DeviceAddress = 0x80 | SetupPacket.wValue.WB.L;
+				USB_WriteEP(0x80, NULL, 0);
+				break;
+			case USB_REQUEST_GET_DESCRIPTOR:
+				if (!usb_ReqGetDescriptor()) {
+					goto stall_i;
+				}
+				usb_DataInStart();
+				break;
+			case USB_REQUEST_GET_CONFIGURATION:
+				if (SetupPacket.bmRequestType.BM.Recipient != REQUEST_TO_DEVICE) {
+					goto stall_i;
+				}
+				EP0Data.pData = &USB_Configuration;
+				EP0Data.Count = 1;
+				usb_DataInStart();
+				break;
+			case USB_REQUEST_SET_CONFIGURATION:
+				if (!usb_ReqSetConfiguration()) {
+					goto stall_i;
+				}
+				USB_WriteEP(0x80, NULL, 0);
+				usb_Event(USBDEV_EVT_CONFIGURE, USB_Configuration);
+				break;
+			case USB_REQUEST_GET_INTERFACE:
+				if ((SetupPacket.bmRequestType.BM.Recipient != REQUEST_TO_INTERFACE)
+						|| (USB_Configuration == 0)
+						|| (SetupPacket.wIndex.WB.L >= usb_NumInterfaces)) {
+					goto stall_i;
+				}
+				EP0Data.pData = USB_AltSetting + SetupPacket.wIndex.WB.L;
+				EP0Data.Count = 1;
+				usb_DataInStart();
+				break;
+			case USB_REQUEST_SET_INTERFACE:
+				if (!usb_ReqSetInterface()) {
+					goto stall_i;
+				}
+				USB_WriteEP(0x80, NULL, 0);
+				cls = usb_FindClass();
+				if ((cls != NULL) && (cls->Event != NULL)) {
+					cls->Event(cls->arg, USBDEV_EVT_INTERFACE,
+							SetupPacket.wIndex.WB.L | (SetupPacket.wValue.WB.L << 8));
+				}
+				usb_DevEvent(USBDEV_EVT_INTERFACE,
+						SetupPacket.wIndex.WB.L | (SetupPacket.wValue.WB.L << 8));
+				break;
+			default:
+				goto stall_i;
+			}
+			break;
+		case REQUEST_CLASS:
+		case REQUEST_VENDOR:
+			cls = usb_FindClass();
+			if ((cls == NULL) || (cls->Request == NULL)
+					|| !cls->Request(cls->arg, &SetupPacket, &EP0Data)) {
+				goto stall_i;
+			}
+			if (SetupPacket.wLength == 0) {
+				USB_WriteEP(0x80, NULL, 0);
+			} else if (SetupPacket.bmRequestType.BM.Dir == REQUEST_DEVICE_TO_HOST) {
+				usb_DataInStart();
+			} else {
+				// OUT data stage, received in EP0Buf unless the class gave its buffer
+				if ((EP0Data.pData == EP0Buf) && (SetupPacket.wLength > USB_EP0_BUF_SIZE)) {
+					goto stall_i;
+				}
+				EP0Data.Count = SetupPacket.wLength;
+				usb_OutBuf = EP0Data.pData;
+				usb_ReqClass = cls;
+			}
+			break;
+		default:
+stall_i:
+			USB_SetStallEP(0x80);
+			EP0Data.Count = 0;
+			usb_zlp = FALSE;
+			break;
+		}
+		break;
+
+	case USB_EVT_OUT:
+		if ((SetupPacket.bmRequestType.BM.Dir == REQUEST_HOST_TO_DEVICE) && EP0Data.Count) {
+			cnt = USB_ReadEP(0x00, EP0Data.pData);
+			if (cnt > EP0Data.Count) {
+				goto stall_i;
+			}
+			EP0Data.pData += cnt;
+			EP0Data.Count -= cnt;
+			if (EP0Data.Count == 0) {
+				cls = usb_ReqClass;
+				usb_ReqClass = NULL;
+				if ((cls == NULL) || (cls->DataOut == NULL)
+						|| !cls->DataOut(cls->arg, &SetupPacket, usb_OutBuf, SetupPacket.wLength)) {
+					goto stall_i;
+				}
+				USB_WriteEP(0x80, NULL, 0);
+			}
+		} else {
+			// Status stage of an IN request
+			USB_ReadEP(0x00, EP0Buf);
+		}
+		break;
+
+	case USB_EVT_IN:
+		if (SetupPacket.bmRequestType.BM.Dir == REQUEST_DEVICE_TO_HOST) {
+			if (EP0Data.Count || usb_zlp) {
+				usb_DataInStage();
+			}
+		} else if (USB_DeviceAddress & 0x80) {
+			USB_DeviceAddress &= 0x7F;
+			USB_SetAddress(USB_DeviceAddress);
+		}
+		break;
+
+	case USB_EVT_OUT_STALL:
+		USB_ClrStallEP(0x00);
+		break;
+
+	case USB_EVT_IN_STALL:
+		USB_ClrStallEP(0x80);
+		break;
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup USBDEV_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize USB device controller: pins, clock, endpoint 0
+ * 				handlers and interrupt. The device stays disconnected
+ * 				until USB_Connect(TRUE). Class drivers and endpoint
+ * 				handlers may be registered before or after.
+ * @param[in]	cfg		Point to USBDEV_CFG_Type structure, kept in use
+ * @return 		None
+ **********************************************************************/
+void USB_Init(const USBDEV_CFG_Type *cfg)
+{
+	CHECK_PARAM((cfg->DeviceDescriptor != NULL) && (cfg->ConfigDescriptor != NULL));
+
+	usb_cfg = cfg;
+	usb_MaxPacket0 = cfg->DeviceDescriptor[7];
+	usb_IndexDescriptors();
+	USB_RegisterEP(0x00, usb_EndPoint0, NULL);
+	USB_RegisterEP(0x80, usb_EndPoint0, NULL);
+
+	LPC_PINCON->PINSEL1 &= ~((3<<26)|(3<<28));	/* P0.29 D+, P0.30 D- */
+	LPC_PINCON->PINSEL1 |=  ((1<<26)|(1<<28));	/* PINSEL1 26.27, 28.29  = 01 */
+
+	LPC_PINCON->PINSEL3 &= ~((3<< 4)|(3<<28));	/* P1.18 GoodLink, P1.30 VBUS */
+	LPC_PINCON->PINSEL3 |=  ((1<< 4)|(2<<28));	/* PINSEL3 4.5 = 01, 28.29 = 10 */
+
+	LPC_PINCON->PINSEL4 &= ~((3<<18)        );	/* P2.9 SoftConnect */
+	LPC_PINCON->PINSEL4 |=  ((1<<18)        );	/* PINSEL4 18.19 = 01 */
+
+	CLKPWR_ConfigPPWR(CLKPWR_PCONP_PCUSB, ENABLE);
+
+	LPC_USB->USBClkCtrl = 0x1A;					/* Dev, PortSel, AHB clock enable */
+	while ((LPC_USB->USBClkSt & 0x1A) != 0x1A);
+
+	/* Cycle counter for the interrupt statistics */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+	NVIC_EnableIRQ(USB_IRQn);
+
+	USB_Reset();
+	USB_ResetCore();
+	USB_SetAddress(0);
+}
+
+/*********************************************************************//**
+ * @brief		Connect/disconnect the device (SoftConnect)
+ * @param[in]	con		TRUE to connect, FALSE to disconnect
+ * @return 		None
+ **********************************************************************/
+void USB_Connect(uint32_t con)
+{
+	WrCmdDat(CMD_SET_DEV_STAT, DAT_WR_BYTE(con ? DEV_CON : 0));
+}
+
+/*********************************************************************//**
+ * @brief		Register a class driver. Its interfaces and endpoints
+ * 				must not overlap the ones of the classes already
+ * 				registered.
+ * @param[in]	cls		Point to USBDEV_CLASS_Type structure, kept in use
+ * @return 		None
+ **********************************************************************/
+void USB_RegisterClass(USBDEV_CLASS_Type *cls)
+{
+	USBDEV_CLASS_Type **p;
+
+	CHECK_PARAM(PARAM_USBDEV_IF(cls->FirstIF, cls->NumIF));
+
+	cls->next = NULL;
+	for (p = &usb_classes; *p != NULL; p = &(*p)->next);
+	*p = cls;
+	if (usb_cfg != NULL) {
+		usb_SetDevIntEn();
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Set the handler of an endpoint in the dispatch table
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @param[in]	handler	Event handler, NULL to ignore the endpoint events
+ * @param[in]	arg		Argument of the handler
+ * @return 		None
+ **********************************************************************/
+void USB_RegisterEP(uint32_t EPNum, USBDEV_EP_HANDLER handler, void *arg)
+{
+	uint32_t n;
+
+	CHECK_PARAM(PARAM_USBDEV_EP(EPNum));
+
+	n = EPAdr(EPNum);
+	usb_ep[n].handler = NULL;
+	usb_ep[n].arg = arg;
+	usb_ep[n].handler = handler;
+}
+
+/*********************************************************************//**
+ * @brief		Reset USB core state
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_ResetCore(void)
+{
+	USB_DeviceStatus  = (usb_cfg->ConfigDescriptor[7] & USB_CONFIG_POWERED_MASK)
+						? USB_GETSTATUS_SELF_POWERED : 0;
+	USB_DeviceAddress = 0;
+	USB_Configuration = 0;
+	USB_EndPointMask  = 0x00010001;
+	USB_EndPointHalt  = 0x00000000;
+	USB_EndPointStall = 0x00000000;
+	usb_ReqClass = NULL;
+	usb_zlp = FALSE;
+}
+
+/*********************************************************************//**
+ * @brief		Reset USB device controller, called on bus reset
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_Reset(void)
+{
+#ifdef _USB_DMA
+	uint32_t n;
+#endif
+
+	usb_CmdSync();								/* Before CCEMTY is cleared */
+	LPC_USB->USBEpInd = 0;
+	LPC_USB->USBMaxPSize = usb_MaxPacket0;
+	LPC_USB->USBEpInd = 1;
+	LPC_USB->USBMaxPSize = usb_MaxPacket0;
+	while ((LPC_USB->USBDevIntSt & EP_RLZED_INT) == 0);
+
+	LPC_USB->USBEpIntClr  = 0xFFFFFFFF;
+#ifdef _USB_DMA
+	LPC_USB->USBEpIntEn   = 0xFFFFFFFF ^ usb_cfg->DMAEndpoints;
+#else
+	LPC_USB->USBEpIntEn   = 0xFFFFFFFF;
+#endif
+	LPC_USB->USBDevIntClr = 0xFFFFFFFF;
+	usb_SetDevIntEn();
+
+#ifdef _USB_DMA
+	/* No descriptor left when DMA is enabled: an emptied IN endpoint
+	 * would reload it at once */
+	DDMemMap[0] = 0x00000000;
+	DDMemMap[1] = 0x00000000;
+	for (n = 0; n < USB_EP_NUM; n++) {
+		udca[n] = 0;
+		UDCA[n] = 0;
+	}
+	LPC_USB->USBUDCAH   = USB_RAM_ADR;
+	LPC_USB->USBDMARClr = 0xFFFFFFFF;
+	LPC_USB->USBEpDMADis  = 0xFFFFFFFF;
+	LPC_USB->USBEpDMAEn   = usb_cfg->DMAEndpoints;
+	LPC_USB->USBEoTIntClr = 0xFFFFFFFF;
+	LPC_USB->USBNDDRIntClr = 0xFFFFFFFF;
+	LPC_USB->USBSysErrIntClr = 0xFFFFFFFF;
+	LPC_USB->USBDMAIntEn  = EOT_INT | NDD_REQ_INT | SYS_ERR_INT;
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Suspend, performed by hardware
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_Suspend(void)
+{
+	/* Performed by Hardware */
+}
+
+/*********************************************************************//**
+ * @brief		Resume, performed by hardware
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_Resume(void)
+{
+	/* Performed by Hardware */
+}
+
+/*********************************************************************//**
+ * @brief		Remote wakeup, if enabled by the host
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_WakeUp(void)
+{
+	if (USB_DeviceStatus & USB_GETSTATUS_REMOTE_WAKEUP) {
+		WrCmdDat(CMD_SET_DEV_STAT, DAT_WR_BYTE(DEV_CON));
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Remote wakeup configuration, not needed
+ * @param[in]	cfg		Enable/Disable
+ * @return 		None
+ **********************************************************************/
+void USB_WakeUpCfg(uint32_t cfg)
+{
+	/* Not needed */
+	(void)cfg;
+}
+
+/*********************************************************************//**
+ * @brief		Set USB address
+ * @param[in]	adr		USB address
+ * @return 		None
+ **********************************************************************/
+void USB_SetAddress(uint32_t adr)
+{
+	WrCmdDat(CMD_SET_ADDR, DAT_WR_BYTE(DEV_EN | adr));	/* Don't wait for next */
+	WrCmdDat(CMD_SET_ADDR, DAT_WR_BYTE(DEV_EN | adr));	/*  Setup Status Phase */
+}
+
+/*********************************************************************//**
+ * @brief		Configure/deconfigure device
+ * @param[in]	cfg		TRUE to configure, FALSE to deconfigure
+ * @return 		None
+ **********************************************************************/
+void USB_Configure(uint32_t cfg)
+{
+	WrCmdDat(CMD_CFG_DEV, DAT_WR_BYTE(cfg ? CONF_DVICE : 0));
+	usb_CmdSync();
+
+	LPC_USB->USBReEp = 0x00000003;
+	while ((LPC_USB->USBDevIntSt & EP_RLZED_INT) == 0);
+	LPC_USB->USBDevIntClr = EP_RLZED_INT;
+}
+
+/*********************************************************************//**
+ * @brief		Get last frame number
+ * @param[in]	None
+ * @return 		Frame number
+ **********************************************************************/
+uint32_t USB_GetFrame(void)
+{
+	uint32_t val;
+
+	WrCmd(CMD_RD_FRAME);
+	val = RdCmdDat(DAT_RD_FRAME);
+	val = val | (RdCmdDat(DAT_RD_FRAME) << 8);
+
+	return (val);
+}
+
+/*********************************************************************//**
+ * @brief		Defer a call to USB_Task() in the main loop: work of the
+ * 				callbacks and handlers that need not be done in the
+ * 				interrupt. To be called from the USB interrupt only
+ * @param[in]	func	Function to call
+ * @param[in]	arg		Its first argument
+ * @param[in]	event	Its second argument, e.g. USBDEV_EVT_xxx
+ * @param[in]	param	Its third argument
+ * @return 		ERROR if USB_DEFER_NUM calls are already queued,
+ * 				otherwise SUCCESS
+ **********************************************************************/
+Status USB_Defer(USBDEV_DEFER_FUNC func, void *arg, uint32_t event, uint32_t param)
+{
+	uint32_t n, idx;
+
+	n = usb_deferhead - usb_defertail;
+	if (n >= USB_DEFER_NUM) {
+		usb_stats.DeferLost++;
+		return ERROR;
+	}
+	idx = usb_deferhead & (USB_DEFER_NUM - 1);
+	usb_defer[idx].func = func;
+	usb_defer[idx].arg = arg;
+	usb_defer[idx].event = event;
+	usb_defer[idx].param = param;
+	__DMB();									/* Entry before the index USB_Task() reads */
+	usb_deferhead++;
+	if (n >= usb_stats.DeferQueued) {
+		usb_stats.DeferQueued = n + 1;
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Run the deferred calls, in the order they were queued.
+ * 				To be called from the main loop
+ * @param[in]	None
+ * @return 		Number of calls run
+ **********************************************************************/
+uint32_t USB_Task(void)
+{
+	uint32_t n, idx, start;
+
+	for (n = 0; usb_defertail != usb_deferhead; n++) {
+		start = DWT_CYCCNT;
+		idx = usb_defertail & (USB_DEFER_NUM - 1);
+		usb_defer[idx].func(usb_defer[idx].arg, usb_defer[idx].event, usb_defer[idx].param);
+		usb_defertail++;						/* Entry free once run */
+		usb_Stat(&usb_stats.Deferred, start);
+	}
+	return n;
+}
+
+/*********************************************************************//**
+ * @brief		Read the interrupt statistics
+ * @param[in]	stats	Point to USBDEV_STATS_Type structure, filled with
+ * 				a consistent copy of the statistics
+ * @return 		None
+ **********************************************************************/
+void USB_GetStats(USBDEV_STATS_Type *stats)
+{
+	NVIC_DisableIRQ(USB_IRQn);
+	*stats = usb_stats;
+	NVIC_EnableIRQ(USB_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		Clear the interrupt statistics
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_ClearStats(void)
+{
+	uint32_t *p;
+	uint32_t n;
+
+	p = (uint32_t *)&usb_stats;
+	NVIC_DisableIRQ(USB_IRQn);
+	for (n = 0; n < (sizeof(usb_stats) / 4); n++) {
+		p[n] = 0;
+	}
+	NVIC_EnableIRQ(USB_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		Realize an endpoint according to its descriptor
+ * @param[in]	pEPD	Point to endpoint descriptor
+ * @return 		None
+ **********************************************************************/
+void USB_ConfigEP(USB_ENDPOINT_DESCRIPTOR *pEPD)
+{
+	uint32_t num;
+
+	num = EPAdr(pEPD->bEndpointAddress);
+	LPC_USB->USBReEp |= (1 << num);
+	LPC_USB->USBEpInd = num;
+	LPC_USB->USBMaxPSize = pEPD->wMaxPacketSize;
+	while ((LPC_USB->USBDevIntSt & EP_RLZED_INT) == 0);
+	LPC_USB->USBDevIntClr = EP_RLZED_INT;
+}
+
+/*********************************************************************//**
+ * @brief		Set direction of control endpoint, not needed
+ * @param[in]	dir		Out (dir == 0), In (dir <> 0)
+ * @return 		None
+ **********************************************************************/
+void USB_DirCtrlEP(uint32_t dir)
+{
+	/* Not needed */
+	(void)dir;
+}
+
+/*********************************************************************//**
+ * @brief		Enable endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_EnableEP(uint32_t EPNum)
+{
+	WrCmdDat(CMD_SET_EP_STAT(EPAdr(EPNum)), DAT_WR_BYTE(0));
+}
+
+/*********************************************************************//**
+ * @brief		Disable endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_DisableEP(uint32_t EPNum)
+{
+	WrCmdDat(CMD_SET_EP_STAT(EPAdr(EPNum)), DAT_WR_BYTE(EP_STAT_DA));
+}
+
+/*********************************************************************//**
+ * @brief		Reset endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_ResetEP(uint32_t EPNum)
+{
+	WrCmdDat(CMD_SET_EP_STAT(EPAdr(EPNum)), DAT_WR_BYTE(0));
+}
+
+/*********************************************************************//**
+ * @brief		Stall endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_SetStallEP(uint32_t EPNum)
+{
+	WrCmdDat(CMD_SET_EP_STAT(EPAdr(EPNum)), DAT_WR_BYTE(EP_STAT_ST));
+}
+
+/*********************************************************************//**
+ * @brief		Clear stall of endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_ClrStallEP(uint32_t EPNum)
+{
+	WrCmdDat(CMD_SET_EP_STAT(EPAdr(EPNum)), DAT_WR_BYTE(0));
+}
+
+/*********************************************************************//**
+ * @brief		Clear endpoint buffer
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_ClearEPBuf(uint32_t EPNum)
+{
+	WrCmdEP(EPNum, CMD_CLR_BUF);
+}
+
+/*********************************************************************//**
+ * @brief		Read a packet from an OUT endpoint. Words are stored
+ * 				straight when pData is word aligned; the bytes of the last
+ * 				partial word are stored one by one, never past the packet.
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @param[in]	pData	Point to data buffer, of max packet size at least
+ * @return 		Number of bytes read
+ **********************************************************************/
+uint32_t USB_ReadEP(uint32_t EPNum, uint8_t *pData)
+{
+	uint32_t cnt, n, val;
+
+	usb_CmdSync();
+	LPC_USB->USBCtrl = ((EPNum & 0x0F) << 2) | CTRL_RD_EN;
+
+	do {
+		cnt = LPC_USB->USBRxPLen;
+	} while ((cnt & PKT_RDY) == 0);
+	cnt &= PKT_LNGTH_MASK;
+
+	if (((uint32_t)pData & 3) == 0) {
+		for (n = 0; n < cnt / 4; n++) {
+			*((uint32_t *)pData) = LPC_USB->USBRxData;
+			pData += 4;
+		}
+	} else {
+		for (n = 0; n < cnt / 4; n++) {
+			val = LPC_USB->USBRxData;
+			pData[0] = (uint8_t)val;
+			pData[1] = (uint8_t)(val >> 8);
+			pData[2] = (uint8_t)(val >> 16);
+			pData[3] = (uint8_t)(val >> 24);
+			pData += 4;
+		}
+	}
+	if (cnt & 3) {
+		val = LPC_USB->USBRxData;
+		for (n = 0; n < (cnt & 3); n++) {
+			*pData++ = (uint8_t)val;
+			val >>= 8;
+		}
+	}
+	LPC_USB->USBCtrl = 0;
+
+	if (((EP_MSK_ISO >> (EPNum & 0x0F)) & 1) == 0) {	/* Non-Isochronous Endpoint */
+		WrCmdEP(EPNum, CMD_CLR_BUF);
+	}
+
+	return (cnt);
+}
+
+/*********************************************************************//**
+ * @brief		Write a packet to an IN endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @param[in]	pData	Point to data buffer
+ * @param[in]	cnt		Number of bytes to write, max packet size at most
+ * @return 		Number of bytes written
+ **********************************************************************/
+uint32_t USB_WriteEP(uint32_t EPNum, uint8_t *pData, uint32_t cnt)
+{
+	uint32_t n, val;
+
+	usb_CmdSync();
+	LPC_USB->USBCtrl = ((EPNum & 0x0F) << 2) | CTRL_WR_EN;
+
+	LPC_USB->USBTxPLen = cnt;
+
+	if (((uint32_t)pData & 3) == 0) {
+		for (n = 0; n < cnt / 4; n++) {
+			LPC_USB->USBTxData = *((uint32_t *)pData);
+			pData += 4;
+		}
+	} else {
+		for (n = 0; n < cnt / 4; n++) {
+			LPC_USB->USBTxData = pData[0] | (pData[1] << 8)
+						| (pData[2] << 16) | (pData[3] << 24);
+			pData += 4;
+		}
+	}
+	if (cnt & 3) {
+		val = 0;
+		for (n = 0; n < (cnt & 3); n++) {
+			val |= pData[n] << (8 * n);
+		}
+		LPC_USB->USBTxData = val;
+	}
+	LPC_USB->USBCtrl = 0;
+	WrCmdEP(EPNum, CMD_VALID_BUF);
+	return (cnt);
+}
+
+#ifdef _USB_DMA
+/*********************************************************************//**
+ * @brief		Setup a DMA transfer: a descriptor is taken from USB RAM
+ * 				and filled. With Cfg.Type.Link set it is linked behind the
+ * 				last descriptor of the endpoint, otherwise the descriptors
+ * 				of the endpoint are freed and the new one replaces them.
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @param[in]	pDD		Point to DMA descriptor
+ * @return 		TRUE - Success, FALSE - No descriptor memory left
+ **********************************************************************/
+uint32_t USB_DMA_Setup(uint32_t EPNum, USB_DMA_DESCRIPTOR *pDD)
+{
+	uint32_t num, ptr, nxt, iso, n;
+	uint32_t *dd;
+
+	iso = pDD->Cfg.Type.IsoEP;					/* Iso or Non-Iso Descriptor */
+	num = EPAdr(EPNum);							/* Endpoint's Physical Address */
+
+	ptr = 0;									/* Current Descriptor */
+	nxt = udca[num];							/* Initial Descriptor */
+	while (nxt) {								/* Go through Descriptor List */
+		ptr = nxt;								/* Current Descriptor */
+		if (!pDD->Cfg.Type.Link) {				/* Check for Linked Descriptors */
+			n = (ptr - DDAdr[iso]) / DDSz[iso];	/* Descriptor Index */
+			DDMemMap[iso] &= ~(1 << n);			/* Unmark Memory Usage */
+		}
+		nxt = *((uint32_t *)ptr);				/* Next Descriptor */
+	}
+
+	for (n = 0; n < 32; n++) {					/* Search for available Memory */
+		if ((DDMemMap[iso] & (1 << n)) == 0) {
+			break;								/* Memory found */
+		}
+	}
+	if (n == 32) {
+		return (FALSE);							/* Memory not available */
+	}
+
+	DDMemMap[iso] |= 1 << n;					/* Mark Memory Usage */
+	nxt = DDAdr[iso] + n * DDSz[iso];			/* Next Descriptor */
+
+	/* Fill in DMA Descriptor */
+	dd = (uint32_t *)nxt;
+	dd[0] = 0;									/* Next DD Pointer */
+	dd[1] = pDD->Cfg.Type.ATLE |
+			(pDD->Cfg.Type.IsoEP << 4) |
+			(pDD->MaxSize <<  5) |
+			(pDD->BufLen  << 16);
+	dd[2] = pDD->BufAdr;
+	dd[3] = pDD->Cfg.Type.LenPos << 8;
+	if (iso) {
+		dd[4] = pDD->InfoAdr;
+	}
+
+	if (ptr && pDD->Cfg.Type.Link) {
+		*((uint32_t *)(ptr + 0))  = nxt;		/* Link in new Descriptor */
+		*((uint32_t *)(ptr + 4)) |= 0x00000004;	/* Next DD is Valid */
+	} else {
+		udca[num] = nxt;						/* Save new Descriptor */
+		UDCA[num] = nxt;						/* Update UDCA in USB */
+	}
+
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Enable DMA of an endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_DMA_Enable(uint32_t EPNum)
+{
+	LPC_USB->USBEpDMAEn = 1 << EPAdr(EPNum);
+}
+
+/*********************************************************************//**
+ * @brief		Disable DMA of an endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		None
+ **********************************************************************/
+void USB_DMA_Disable(uint32_t EPNum)
+{
+	LPC_USB->USBEpDMADis = 1 << EPAdr(EPNum);
+}
+
+/*********************************************************************//**
+ * @brief		Get DMA status of an endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		DMA status, USB_DMA_xxx
+ **********************************************************************/
+uint32_t USB_DMA_Status(uint32_t EPNum)
+{
+	uint32_t ptr, val;
+
+	ptr = UDCA[EPAdr(EPNum)];					/* Current Descriptor */
+	if (ptr == 0) {
+		return (USB_DMA_INVALID);
+	}
+
+	val = *((uint32_t *)(ptr + 3*4));			/* Status Information */
+	switch ((val >> 1) & 0x0F) {
+	case 0x00:									/* Not serviced */
+		return (USB_DMA_IDLE);
+	case 0x01:									/* Being serviced */
+		return (USB_DMA_BUSY);
+	case 0x02:									/* Normal Completition */
+		return (USB_DMA_DONE);
+	case 0x03:									/* Data Under Run */
+		return (USB_DMA_UNDER_RUN);
+	case 0x08:									/* Data Over Run */
+		return (USB_DMA_OVER_RUN);
+	case 0x09:									/* System Error */
+		return (USB_DMA_ERROR);
+	}
+
+	return (USB_DMA_UNKNOWN);
+}
+
+/*********************************************************************//**
+ * @brief		Get current DMA buffer address of an endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		DMA address, -1 when DMA is invalid
+ **********************************************************************/
+uint32_t USB_DMA_BufAdr(uint32_t EPNum)
+{
+	uint32_t ptr;
+
+	ptr = UDCA[EPAdr(EPNum)];					/* Current Descriptor */
+	if (ptr == 0) {
+		return ((uint32_t)(-1));				/* DMA Invalid */
+	}
+	return (*((uint32_t *)(ptr + 2*4)));		/* Buffer Address */
+}
+
+/*********************************************************************//**
+ * @brief		Get current DMA count of an endpoint: number of bytes or
+ * 				of isochronous packets transferred
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @return 		DMA count, -1 when DMA is invalid
+ **********************************************************************/
+uint32_t USB_DMA_BufCnt(uint32_t EPNum)
+{
+	uint32_t ptr;
+
+	ptr = UDCA[EPAdr(EPNum)];					/* Current Descriptor */
+	if (ptr == 0) {
+		return ((uint32_t)(-1));				/* DMA Invalid */
+	}
+	return (*((uint32_t *)(ptr + 3*4)) >> 16);	/* Current Count */
+}
+#endif /* _USB_DMA */
+
+/*********************************************************************//**
+ * @brief		USB interrupt handler sub-routine, to be called from
+ * 				USB_IRQHandler(). Endpoint events are dispatched through
+ * 				the endpoint table, lowest pending endpoint first, device
+ * 				events to the callbacks. The duration of each event is
+ * 				added to the interrupt statistics.
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_IntHandler(void)
+{
+	uint32_t disr, val, n;
+	uint32_t episr, start, t;
+#ifdef _USB_DMA
+	uint32_t dmaisr, evt;
+	uint32_t m;
+#endif
+
+	start = DWT_CYCCNT;
+	disr = LPC_USB->USBDevIntSt;				/* Device Interrupt Status */
+
+	/* Device Status Interrupt (Reset, Connect change, Suspend/Resume) */
+	if (disr & DEV_STAT_INT) {
+		LPC_USB->USBDevIntClr = DEV_STAT_INT;
+		WrCmd(CMD_GET_DEV_STAT);
+		val = RdCmdDat(DAT_GET_DEV_STAT);		/* Device Status */
+		if (val & DEV_RST) {					/* Reset */
+			USB_Reset();
+			USB_ResetCore();
+			usb_Event(USBDEV_EVT_RESET, 0);
+		}
+		if (val & DEV_CON_CH) {					/* Connect change */
+			usb_Event(USBDEV_EVT_POWER, val & DEV_CON);
+		}
+		if (val & DEV_SUS_CH) {					/* Suspend/Resume */
+			if (val & DEV_SUS) {				/* Suspend */
+				USB_Suspend();
+				usb_Event(USBDEV_EVT_SUSPEND, 0);
+			} else {							/* Resume */
+				USB_Resume();
+				usb_Event(USBDEV_EVT_RESUME, 0);
+			}
+		}
+		usb_CmdSync();
+		usb_Stat(&usb_stats.Device, start);
+		usb_Stat(&usb_stats.Total, start);
+		return;
+	}
+
+	/* Start of Frame Interrupt */
+	if (disr & FRAME_INT) {
+		t = DWT_CYCCNT;
+		LPC_USB->USBDevIntClr = FRAME_INT;
+		usb_Event(USBDEV_EVT_SOF, USB_GetFrame());
+		usb_Stat(&usb_stats.Frame, t);
+	}
+
+	/* Error Interrupt */
+	if (disr & ERR_INT) {
+		t = DWT_CYCCNT;
+		LPC_USB->USBDevIntClr = ERR_INT;
+		WrCmd(CMD_RD_ERR_STAT);
+		val = RdCmdDat(DAT_RD_ERR_STAT);
+		usb_Event(USBDEV_EVT_ERROR, val);
+		usb_Stat(&usb_stats.Error, t);
+	}
+
+	/* Endpoint's Slow Interrupt: acknowledged before the endpoint
+	 * interrupts are read, one arriving meanwhile sets it again */
+	if (disr & EP_SLOW_INT) {
+		LPC_USB->USBDevIntClr = EP_SLOW_INT;
+		episr = LPC_USB->USBEpIntSt;
+		while (episr != 0) {
+			t = DWT_CYCCNT;
+			n = __CLZ(__RBIT(episr));			/* Lowest pending endpoint */
+			episr &= episr - 1;
+
+			/* Select Endpoint/Clear Interrupt runs in the SIE: only the
+			 * control OUT endpoint waits for its status (setup packet) */
+			usb_CmdSync();
+			LPC_USB->USBDevIntClr = CDFULL_INT;
+			LPC_USB->USBEpIntClr = (1 << n);
+			if (n == 0) {
+				while ((LPC_USB->USBDevIntSt & CDFULL_INT) == 0);
+				val = LPC_USB->USBCmdData;		/* Select Endpoint status */
+			} else {
+				usb_cmdwait = CDFULL_INT;
+				val = 0;
+			}
+
+			if (usb_ep[n].handler == NULL) {
+				continue;
+			}
+			if (n & 1) {						/* IN Endpoint */
+				usb_ep[n].handler(usb_ep[n].arg, USB_EVT_IN);
+			} else if ((n == 0) && (val & EP_SEL_STP)) {
+				usb_ep[n].handler(usb_ep[n].arg, USB_EVT_SETUP);
+			} else {							/* OUT Endpoint */
+				usb_ep[n].handler(usb_ep[n].arg, USB_EVT_OUT);
+			}
+			usb_Stat(&usb_stats.EP[n], t);
+		}
+	}
+
+#ifdef _USB_DMA
+	dmaisr = LPC_USB->USBDMAIntSt;
+	for (m = 0; m < 3; m++) {
+		if ((dmaisr & (1 << m)) == 0) {
+			continue;
+		}
+		switch (m) {
+		case 0:									/* End of Transfer Interrupt */
+			val = LPC_USB->USBEoTIntSt;
+			LPC_USB->USBEoTIntClr = val;
+			evt = USB_EVT_OUT_DMA_EOT;
+			break;
+		case 1:									/* New DD Request Interrupt */
+			val = LPC_USB->USBNDDRIntSt;
+			LPC_USB->USBNDDRIntClr = val;
+			evt = USB_EVT_OUT_DMA_NDR;
+			break;
+		default:								/* System Error Interrupt */
+			val = LPC_USB->USBSysErrIntSt;
+			LPC_USB->USBSysErrIntClr = val;
+			evt = USB_EVT_OUT_DMA_ERR;
+			break;
+		}
+		// OUT and IN events of each kind follow each other: IN = OUT + 1
+		val &= ~3UL;							/* No DMA on endpoint 0 */
+		while (val != 0) {
+			t = DWT_CYCCNT;
+			n = __CLZ(__RBIT(val));
+			val &= val - 1;
+			if (usb_ep[n].handler != NULL) {
+				usb_ep[n].handler(usb_ep[n].arg, evt + (n & 1));
+				usb_Stat(&usb_stats.EP[n], t);
+			}
+		}
+	}
+#endif /* _USB_DMA */
+
+	/* Nothing left in progress for the code interrupted */
+	usb_CmdSync();
+	usb_Stat(&usb_stats.Total, start);
+}
+
+/**
+ * @}
+ */
+
+#endif /* _USBDEV */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
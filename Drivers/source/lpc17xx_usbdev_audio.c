@@ -0,0 +1,464 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_audio.c			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_audio.c
+* @brief	Contains all functions support for the USB audio class driver on
+* 			LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup USBDEV_AUDIO
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev_audio.h"
+
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _USBDEV_AUDIO
+
+/* Private Macros ------------------------------------------------------------- */
+/** Feedback correction (10.14) per sample of distance between level and
+ * Target: 1/256 sample per frame */
+#define AUDIO_FEEDBACK_GAIN		64
+/** Weight of a new measure in the average output rate: 1/2^n. The
+ * average is kept with n more fraction bits, so that it has no dead band */
+#define AUDIO_FEEDBACK_AVG		3
+
+/* Private Functions ---------------------------------------------------------- */
+
+static uint32_t audio_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data);
+static uint32_t audio_DataOut(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len);
+static void audio_StreamStart(USBDEV_AUDIO_Type *audio);
+static void audio_StreamFeedback(USBDEV_AUDIO_Type *audio, uint32_t level);
+static void audio_StreamFrame(USBDEV_AUDIO_Type *audio);
+static void audio_Event(void *arg, uint32_t event, uint32_t param);
+static void audio_EP(void *arg, uint32_t event);
+
+/*********************************************************************//**
+ * @brief		Setup stage of audio class requests: GET requests of the
+ * 				feature unit master channel (mute and volume)
+ * @param[in]	arg		Point to USBDEV_AUDIO_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	data	Point to data stage, pData is EP0Buf
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t audio_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data)
+{
+	USBDEV_AUDIO_Type *audio = (USBDEV_AUDIO_Type *)arg;
+	uint8_t *buf = data->pData;
+	uint32_t val;
+
+	/* Entity ID in wIndex high byte, interface in low byte */
+	if ((setup->bmRequestType.BM.Type != REQUEST_CLASS)
+			|| (setup->bmRequestType.BM.Recipient != REQUEST_TO_INTERFACE)
+			|| (setup->wIndex.WB.L != audio->CIF)
+			|| (setup->wIndex.WB.H != audio->FeatureUnit)
+			|| (setup->wValue.WB.L != 0)) {
+		return (FALSE);
+	}
+	switch (setup->wValue.WB.H) {
+	case AUDIO_MUTE_CONTROL:
+		switch (setup->bRequest) {
+		case AUDIO_REQUEST_SET_CUR:
+			// Data stage received in EP0Buf, see audio_DataOut()
+			return (TRUE);
+		case AUDIO_REQUEST_GET_CUR:
+			buf[0] = audio->Mute;
+			data->Count = 1;
+			return (TRUE);
+		}
+		break;
+	case AUDIO_VOLUME_CONTROL:
+		switch (setup->bRequest) {
+		case AUDIO_REQUEST_SET_CUR:
+			return (TRUE);
+		case AUDIO_REQUEST_GET_CUR:
+			val = audio->VolCur;
+			break;
+		case AUDIO_REQUEST_GET_MIN:
+			val = audio->VolMin;
+			break;
+		case AUDIO_REQUEST_GET_MAX:
+			val = audio->VolMax;
+			break;
+		case AUDIO_REQUEST_GET_RES:
+			val = audio->VolRes;
+			break;
+		default:
+			return (FALSE);
+		}
+		buf[0] = val & 0xFF;
+		buf[1] = (val >> 8) & 0xFF;
+		data->Count = 2;
+		return (TRUE);
+	}
+	return (FALSE);
+}
+
+/*********************************************************************//**
+ * @brief		OUT data stage of audio class requests (SET_CUR of the
+ * 				feature unit master channel)
+ * @param[in]	arg		Point to USBDEV_AUDIO_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	buf		Point to received data
+ * @param[in]	len		Number of bytes received
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t audio_DataOut(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len)
+{
+	USBDEV_AUDIO_Type *audio = (USBDEV_AUDIO_Type *)arg;
+
+	switch (setup->wValue.WB.H) {
+	case AUDIO_MUTE_CONTROL:
+		if (len < 1) {
+			return (FALSE);
+		}
+		audio->Mute = buf[0];
+		break;
+	case AUDIO_VOLUME_CONTROL:
+		if (len < 2) {
+			return (FALSE);
+		}
+		audio->VolCur = buf[0] | (buf[1] << 8);
+		break;
+	default:
+		return (FALSE);
+	}
+	if (audio->ControlChange != NULL) {
+		audio->ControlChange(audio);
+	}
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Start the stream: empty ring, feedback at the nominal rate
+ * @param[in]	audio	Point to USBDEV_AUDIO_Type structure
+ * @return 		None
+ **********************************************************************/
+static void audio_StreamStart(USBDEV_AUDIO_Type *audio)
+{
+	USBDEV_AUDIO_STREAM_Type *s = audio->Stream;
+
+	// The player finds the ring empty and waits for Target bytes again
+	s->head = s->tail;
+	s->period = 0;
+	s->pos = (s->Position != NULL) ? s->Position(s->arg) : 0;
+	s->levelsum = 0;
+	s->rate = AUDIO_FEEDBACK_VALUE(s->Rate) << AUDIO_FEEDBACK_AVG;
+	audio_StreamFeedback(audio, s->Target);
+	s->Level = 0;
+	s->LevelMean = 0;
+	s->LevelMin = s->Size;
+	s->LevelMax = 0;
+	s->active = 1;
+}
+
+/*********************************************************************//**
+ * @brief		Compute the feedback value from the mean level of the
+ * 				period and the average output rate, and prepare the
+ * 				feedback packet
+ * @param[in]	audio	Point to USBDEV_AUDIO_Type structure
+ * @param[in]	level	Mean level of the period (bytes)
+ * @return 		None
+ **********************************************************************/
+static void audio_StreamFeedback(USBDEV_AUDIO_Type *audio, uint32_t level)
+{
+	USBDEV_AUDIO_STREAM_Type *s = audio->Stream;
+	uint32_t nominal;
+	int32_t val;
+
+	val = (int32_t)(s->rate >> AUDIO_FEEDBACK_AVG)
+		+ (((int32_t)s->Target - (int32_t)level) * AUDIO_FEEDBACK_GAIN) / s->SampleBytes;
+	nominal = AUDIO_FEEDBACK_VALUE(s->Rate);
+	if (val < (int32_t)(nominal - (nominal >> 5))) {
+		val = nominal - (nominal >> 5);
+	} else if (val > (int32_t)(nominal + (nominal >> 5))) {
+		val = nominal + (nominal >> 5);
+	}
+	s->Feedback = val;
+	s->fb[0] = val & 0xFF;
+	s->fb[1] = (val >> 8) & 0xFF;
+	s->fb[2] = (val >> 16) & 0xFF;
+}
+
+/*********************************************************************//**
+ * @brief		Start of frame of a running stream: read the packet of
+ * 				the frame into the ring, update level and feedback
+ * @param[in]	audio	Point to USBDEV_AUDIO_Type structure
+ * @return 		None
+ **********************************************************************/
+static void audio_StreamFrame(USBDEV_AUDIO_Type *audio)
+{
+	USBDEV_AUDIO_STREAM_Type *s = audio->Stream;
+	uint32_t level, ofs, cnt, i;
+
+	s->Frames++;
+	level = s->head - s->tail;
+	if ((s->Size - level) < s->MaxPacket) {
+		// No room for a packet: it goes to the slack area and is dropped
+		if (USB_ReadEP(audio->EP, s->Buf + s->Size) != 0) {
+			s->Overruns++;
+		}
+		cnt = 0;
+	} else {
+		ofs = s->head & (s->Size - 1);
+		cnt = USB_ReadEP(audio->EP, s->Buf + ofs);
+		cnt -= cnt % s->SampleBytes;
+		// Bytes written past the end of the ring belong to its start
+		for (i = s->Size; i < ofs + cnt; i++) {
+			s->Buf[i - s->Size] = s->Buf[i];
+		}
+		s->head += cnt;
+		level += cnt;
+	}
+	if (cnt != 0) {
+		s->Packets++;
+	} else {
+		s->Missed++;
+	}
+
+	s->Level = level;
+	if (s->primed) {
+		if (level < s->LevelMin) {
+			s->LevelMin = level;
+		}
+		if (level > s->LevelMax) {
+			s->LevelMax = level;
+		}
+	}
+
+	// Level and feedback are measured over 2^FeedbackShift frames: the
+	// level moves by whole packets and player blocks, and the host polls
+	// the feedback at that period, at a phase of its own
+	s->levelsum += level;
+	if (++s->period >= (1 << s->FeedbackShift)) {
+		s->period = 0;
+		s->LevelMean = s->levelsum >> s->FeedbackShift;
+		s->levelsum = 0;
+		if (s->FeedbackEP != 0) {
+			if (s->Position != NULL) {
+				// Samples played in the period, as samples per frame
+				cnt = s->Position(s->arg) - s->pos;
+				s->pos += cnt;
+				s->rate += (cnt << (14 - s->FeedbackShift))
+						- (s->rate >> AUDIO_FEEDBACK_AVG);
+			}
+			audio_StreamFeedback(audio, s->LevelMean);
+		}
+	}
+	if (s->FeedbackEP != 0) {
+		// Loaded on each SOF, sent on the next IN token
+		USB_WriteEP(s->FeedbackEP, s->fb, AUDIO_FEEDBACK_SIZE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Device events: start of frame, alternate setting of the
+ * 				streaming interfaces, reset and configuration (stop the
+ * 				stream)
+ * @param[in]	arg		Point to USBDEV_AUDIO_Type structure
+ * @param[in]	event	USBDEV_EVT_xxx
+ * @param[in]	param	Frame number, interface number | alternate
+ * 						setting << 8, or configuration value
+ * @return 		None
+ **********************************************************************/
+static void audio_Event(void *arg, uint32_t event, uint32_t param)
+{
+	USBDEV_AUDIO_Type *audio = (USBDEV_AUDIO_Type *)arg;
+
+	switch (event) {
+	case USBDEV_EVT_SOF:
+		if ((audio->Stream != NULL) && audio->Stream->active) {
+			audio_StreamFrame(audio);
+		}
+		if (audio->Frame != NULL) {
+			audio->Frame(audio, param);
+		}
+		break;
+	case USBDEV_EVT_INTERFACE:
+		if ((audio->Stream != NULL) && ((param & 0xFF) == audio->Stream->IF)) {
+			if (((param >> 8) & 0xFF) != 0) {
+				audio_StreamStart(audio);
+			} else {
+				audio->Stream->active = 0;
+			}
+		}
+		if ((audio->Streaming != NULL) && ((param & 0xFF) != audio->CIF)) {
+			audio->Streaming(audio, param & 0xFF, (param >> 8) & 0xFF);
+		}
+		break;
+	case USBDEV_EVT_RESET:
+	case USBDEV_EVT_CONFIGURE:
+		if (audio->Stream != NULL) {
+			audio->Stream->active = 0;
+		}
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Isochronous endpoint handler
+ * @param[in]	arg		Point to USBDEV_AUDIO_Type structure
+ * @param[in]	event	USB_EVT_xxx
+ * @return 		None
+ **********************************************************************/
+static void audio_EP(void *arg, uint32_t event)
+{
+	USBDEV_AUDIO_Type *audio = (USBDEV_AUDIO_Type *)arg;
+
+	audio->Endpoint(audio, event);
+}
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup USBDEV_AUDIO_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize audio class driver: register it with its
+ * 				interfaces (CIF to CIF + NumIF - 1) and its endpoints
+ * 				(EP, and FeedbackEP of the stream engine if any)
+ * @param[in]	audio	Point to USBDEV_AUDIO_Type structure, configuration
+ * 				fields and control values must be filled
+ * @return 		None
+ **********************************************************************/
+void USB_AudioInit(USBDEV_AUDIO_Type *audio)
+{
+	USBDEV_AUDIO_STREAM_Type *s = audio->Stream;
+
+	CHECK_PARAM(PARAM_USBDEV_EP(audio->EP));
+	CHECK_PARAM(PARAM_USBDEV_IF(audio->CIF, audio->NumIF));
+
+	audio->cls.FirstIF = audio->CIF;
+	audio->cls.NumIF = audio->NumIF;
+	audio->cls.EPMask = USBDEV_EP_BIT(audio->EP);
+	audio->cls.EventMask = USBDEV_EVT_INTERFACE;
+	if (audio->Frame != NULL) {
+		audio->cls.EventMask |= USBDEV_EVT_SOF;
+	}
+	if (s != NULL) {
+		CHECK_PARAM((s->Size & (s->Size - 1)) == 0);
+		CHECK_PARAM((2 * s->Target) <= s->Size);
+		CHECK_PARAM((s->SampleBytes > 0) && (s->MaxPacket >= s->SampleBytes));
+		CHECK_PARAM((s->FeedbackShift >= 1) && (s->FeedbackShift <= 9));
+
+		if (s->FeedbackEP != 0) {
+			CHECK_PARAM(PARAM_USBDEV_EP(s->FeedbackEP));
+			audio->cls.EPMask |= USBDEV_EP_BIT(s->FeedbackEP);
+		}
+		audio->cls.EventMask |= USBDEV_EVT_SOF | USBDEV_EVT_INTERFACE
+				| USBDEV_EVT_RESET | USBDEV_EVT_CONFIGURE;
+		s->head = 0;
+		s->tail = 0;
+		s->active = 0;
+		s->primed = 0;
+	}
+	audio->cls.Request = audio_Request;
+	audio->cls.DataOut = audio_DataOut;
+	audio->cls.Event = audio_Event;
+	audio->cls.arg = audio;
+	USB_RegisterClass(&audio->cls);
+
+	if (audio->Endpoint != NULL) {
+		USB_RegisterEP(audio->EP, audio_EP, audio);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Read samples of the stream, for the player. Nothing is
+ * 				read until Target bytes are buffered, then until the ring
+ * 				runs empty: the missing samples are an underrun and the
+ * 				player waits for Target bytes again.
+ * @param[in]	audio	Point to USBDEV_AUDIO_Type structure, Stream set
+ * @param[in]	dst		Point to destination
+ * @param[in]	len		Bytes to read, whole samples
+ * @return 		Bytes read, less than len (possibly 0) if the player
+ * 				must fill the rest with silence
+ **********************************************************************/
+uint32_t USB_AudioRead(USBDEV_AUDIO_Type *audio, uint8_t *dst, uint32_t len)
+{
+	USBDEV_AUDIO_STREAM_Type *s = audio->Stream;
+	uint32_t level, ofs, n, i;
+
+	level = s->head - s->tail;
+	if (!s->primed) {
+		if (!s->active || (level < s->Target)) {
+			return 0;
+		}
+		s->primed = 1;
+	}
+	if (len > level) {
+		len = level - (level % s->SampleBytes);
+		s->primed = 0;
+		// The end of a stream stopped by the host is not an underrun
+		if (s->active) {
+			s->Underruns++;
+		}
+	}
+
+	ofs = s->tail & (s->Size - 1);
+	n = s->Size - ofs;
+	if (n > len) {
+		n = len;
+	}
+	for (i = 0; i < n; i++) {
+		dst[i] = s->Buf[ofs + i];
+	}
+	for (; i < len; i++) {
+		dst[i] = s->Buf[i - n];
+	}
+	s->tail += len;
+	return len;
+}
+
+/*********************************************************************//**
+ * @brief		Get the number of bytes buffered in the stream
+ * @param[in]	audio	Point to USBDEV_AUDIO_Type structure, Stream set
+ * @return 		Bytes received and not yet read by USB_AudioRead()
+ **********************************************************************/
+uint32_t USB_AudioLevel(USBDEV_AUDIO_Type *audio)
+{
+	return (audio->Stream->head - audio->Stream->tail);
+}
+
+/**
+ * @}
+ */
+
+#endif /* _USBDEV_AUDIO */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,784 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_cdc.c			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_cdc.c
+* @brief	Contains all functions support for the USB CDC (communication
+* 			device class, abstract control model) class driver on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup USBDEV_CDC
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev_cdc.h"
+
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _USBDEV_CDC
+
+/* Private Macros ------------------------------------------------------------- */
+
+/* Longest GPDMA transfer to the UART (bytes) */
+#define CDC_BRIDGE_TX_MAX		4095
+
+/* Private Functions ---------------------------------------------------------- */
+
+static uint32_t cdc_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data);
+static uint32_t cdc_DataOut(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len);
+static void cdc_Event(void *arg, uint32_t event, uint32_t param);
+static void cdc_NotifyEP(void *arg, uint32_t event);
+static void cdc_DataEP(void *arg, uint32_t event);
+#ifdef _USB_DMA
+static void cdc_BridgeQueue(uint32_t EPNum, uint8_t *buf, uint32_t len);
+static void cdc_BridgeRxRun(USBDEV_CDC_BRIDGE_Type *b, uint32_t block);
+static uint32_t cdc_BridgeRx(USBDEV_CDC_BRIDGE_Type *b);
+static void cdc_BridgeIn(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeInDone(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeOut(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeOutDone(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeTx(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeDMA(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeSOF(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeStop(USBDEV_CDC_Type *cdc);
+static void cdc_BridgeStart(USBDEV_CDC_Type *cdc);
+#endif
+
+#ifdef _USB_DMA
+/*********************************************************************//**
+ * @brief		Queue a DMA transfer on a bulk data endpoint, replacing
+ * 				its previous descriptor
+ * @param[in]	EPNum	Endpoint address
+ * @param[in]	buf		Point to data, in AHB SRAM
+ * @param[in]	len		Number of bytes
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeQueue(uint32_t EPNum, uint8_t *buf, uint32_t len)
+{
+	USB_DMA_DESCRIPTOR DD;
+
+	DD.BufAdr = (uint32_t)buf;
+	DD.BufLen = len;
+	DD.MaxSize = CDC_MAX_PACKET;
+	DD.InfoAdr = 0;
+	DD.Cfg.Val = 0;
+	USB_DMA_Setup(EPNum, &DD);
+	USB_DMA_Enable(EPNum);
+}
+
+/*********************************************************************//**
+ * @brief		Run the UART receive chain from one of its blocks
+ * @param[in]	b		Point to USBDEV_CDC_BRIDGE_Type structure
+ * @param[in]	block	First block to fill
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeRxRun(USBDEV_CDC_BRIDGE_Type *b, uint32_t block)
+{
+	GPDMA_Channel_CFG_Type GPDMACfg;
+
+	GPDMACfg.ChannelNum = b->DMARx;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	GPDMACfg.SrcConn = b->connrx;
+	GPDMACfg.DstConn = 0;
+	GPDMACfg.DMALLI = (uint32_t)&b->RxLLI[block];
+	if (GPDMA_SetupLLI(&GPDMACfg) == SUCCESS) {
+		GPDMA_ChannelCmd(b->DMARx, ENABLE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		UART receive ring: end the GPDMA chain before the block
+ * 				holding the oldest unsent byte, and restart the channel
+ * 				if it stopped there and blocks were freed since.
+ * 				The block before the one of rxtail is never filled, so
+ * 				less than the ring size is pending and the ring is empty
+ * 				when the head equals rxtail
+ * @param[in]	b		Point to USBDEV_CDC_BRIDGE_Type structure
+ * @return 		Offset in RxBuf of the next byte to be received
+ **********************************************************************/
+static uint32_t cdc_BridgeRx(USBDEV_CDC_BRIDGE_Type *b)
+{
+	uint32_t size, head, last, cut, stopped;
+
+	size = b->RxBlocks * b->RxBlockSize;
+	/* Checked first: the head of a stopped channel does not move anymore */
+	stopped = (GPDMA_IntGetStatus(GPDMA_STAT_ENABLED_CH, b->DMARx) == RESET);
+	/* The destination address is kept when the channel stops, it is
+	 * RxBuf + size at the end of the last block */
+	head = GPDMA_GetDstAddr(b->DMARx) - (uint32_t)b->RxBuf;
+	if (head >= size) {
+		head = 0;
+	}
+
+	/* Block of the byte before rxtail: last one the channel may fill */
+	last = ((b->rxtail + size - 1) % size) / b->RxBlockSize;
+	cut = (last + b->RxBlocks - 1) % b->RxBlocks;
+	if (cut != b->rxcut) {
+		b->RxLLI[cut].NextLLI = 0;
+		b->RxLLI[b->rxcut].NextLLI = (uint32_t)&b->RxLLI[(b->rxcut + 1) % b->RxBlocks];
+		b->rxcut = cut;
+	}
+	/* Stopped at the end of the old cut: go on if its next block is free.
+	 * Not after a GPDMA error, the head is then within a block */
+	if (stopped && ((head % b->RxBlockSize) == 0) && ((head / b->RxBlockSize) != last)) {
+		cdc_BridgeRxRun(b, head / b->RxBlockSize);
+	}
+	return head;
+}
+
+/*********************************************************************//**
+ * @brief		Send the bytes received from the UART, in place, if no
+ * 				IN transfer is in flight. A transfer that takes all the
+ * 				pending bytes ends with a short packet, so the host
+ * 				completes it without a zero length packet
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeIn(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+	uint32_t size, head, pending, n;
+
+	if (!b->running || (b->inlen != 0)) {
+		return;
+	}
+	size = b->RxBlocks * b->RxBlockSize;
+	head = cdc_BridgeRx(b);
+	pending = (head + size - b->rxtail) % size;
+	if (pending == 0) {
+		return;
+	}
+	n = size - b->rxtail;					/* Contiguous up to the end of RxBuf */
+	if (n >= pending) {
+		n = pending;
+		if ((n % CDC_MAX_PACKET) == 0) {
+			n--;							/* Last byte sent in the next transfer */
+		}
+	}
+	b->inlen = n;
+	cdc_BridgeQueue(cdc->DEP_IN, b->RxBuf + b->rxtail, n);
+}
+
+/*********************************************************************//**
+ * @brief		End of a DMA transfer on the bulk IN endpoint: free its
+ * 				bytes in RxBuf and send the next ones
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeInDone(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+	uint32_t status;
+
+	status = USB_DMA_Status(cdc->DEP_IN);
+	if ((status == USB_DMA_IDLE) || (status == USB_DMA_BUSY) || (b->inlen == 0)) {
+		return;								/* Already replaced, nothing to do */
+	}
+	USB_DMA_Disable(cdc->DEP_IN);
+	if (status == USB_DMA_DONE) {
+		b->InBytes += b->inlen;
+	} else {
+		b->Errors++;						/* Bytes lost */
+	}
+	b->rxtail = (b->rxtail + b->inlen) % (b->RxBlocks * b->RxBlockSize);
+	b->inlen = 0;
+	cdc_BridgeIn(cdc);
+}
+
+/*********************************************************************//**
+ * @brief		Arm the bulk OUT endpoint with a DMA transfer into the
+ * 				free space of TxBuf, if no transfer is armed. Left
+ * 				unarmed (NAK) while less than a packet is free
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeOut(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+	uint32_t n;
+
+	if (!b->running || (b->outlen != 0)) {
+		return;
+	}
+	if ((b->txwrap == 0) && ((b->TxSize - b->txhead) < CDC_MAX_PACKET)) {
+		/* Not a packet left up to the end: go on at the start of TxBuf */
+		b->txwrap = b->txhead;
+		b->txhead = 0;
+	}
+	n = (b->txwrap != 0) ? (b->txtail - b->txhead) : (b->TxSize - b->txhead);
+	/* Half of TxBuf at most, the UART starts on the first half meanwhile */
+	if (n > (b->TxSize / 2)) {
+		n = b->TxSize / 2;
+	}
+	n -= n % CDC_MAX_PACKET;
+	if (n == 0) {
+		return;
+	}
+	b->outlen = n;
+	cdc_BridgeQueue(cdc->DEP_OUT, b->TxBuf + b->txhead, n);
+}
+
+/*********************************************************************//**
+ * @brief		End of a DMA transfer on the bulk OUT endpoint: the host
+ * 				sent the armed length, or less ending with a short packet
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeOutDone(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+	uint32_t status, n;
+
+	status = USB_DMA_Status(cdc->DEP_OUT);
+	if ((status == USB_DMA_IDLE) || (status == USB_DMA_BUSY) || (b->outlen == 0)) {
+		return;								/* Already replaced, nothing to do */
+	}
+	n = 0;
+	if (status == USB_DMA_DONE) {
+		n = b->outlen;
+	} else if (status == USB_DMA_UNDER_RUN) {
+		n = USB_DMA_BufCnt(cdc->DEP_OUT);
+		if (n > b->outlen) {
+			n = b->outlen;
+		}
+	} else {
+		b->Errors++;
+	}
+	USB_DMA_Disable(cdc->DEP_OUT);
+	b->txhead += n;
+	b->OutBytes += n;
+	b->outlen = 0;
+	cdc_BridgeTx(cdc);
+	cdc_BridgeOut(cdc);
+}
+
+/*********************************************************************//**
+ * @brief		Start a GPDMA transfer of the contiguous bytes of TxBuf
+ * 				to the UART, if none is in flight
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeTx(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+	GPDMA_Channel_CFG_Type GPDMACfg;
+	uint32_t n;
+
+	if (!b->running || (b->txlen != 0)) {
+		return;
+	}
+	if ((b->txwrap != 0) && (b->txtail == b->txwrap)) {
+		b->txtail = 0;
+		b->txwrap = 0;
+	}
+	n = ((b->txwrap != 0) ? b->txwrap : b->txhead) - b->txtail;
+	if (n == 0) {
+		return;
+	}
+	if (n > CDC_BRIDGE_TX_MAX) {
+		n = CDC_BRIDGE_TX_MAX;
+	}
+	GPDMACfg.ChannelNum = b->DMATx;
+	GPDMACfg.SrcMemAddr = (uint32_t)(b->TxBuf + b->txtail);
+	GPDMACfg.DstMemAddr = 0;
+	GPDMACfg.TransferSize = n;
+	GPDMACfg.TransferWidth = 0;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	GPDMACfg.SrcConn = 0;
+	GPDMACfg.DstConn = b->conntx;
+	GPDMACfg.DMALLI = 0;
+	if (GPDMA_Setup(&GPDMACfg) == SUCCESS) {
+		b->txlen = n;
+		GPDMA_ChannelCmd(b->DMATx, ENABLE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		GPDMA channels of the bridge: end of the UART transmit
+ * 				(free its bytes in TxBuf, start the next ones, arm the
+ * 				bulk OUT endpoint if it was NAKing) and errors
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeDMA(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+
+	if (GPDMA_IntGetStatus(GPDMA_STAT_RAWINTERR, b->DMARx)) {
+		/* Receive channel stopped within a block, until the next configuration */
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, b->DMARx);
+		b->Errors++;
+	}
+	if (b->txlen == 0) {
+		return;
+	}
+	if (GPDMA_IntGetStatus(GPDMA_STAT_RAWINTERR, b->DMATx)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, b->DMATx);
+		b->Errors++;						/* Bytes lost */
+	} else if (GPDMA_IntGetStatus(GPDMA_STAT_RAWINTTC, b->DMATx)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, b->DMATx);
+	} else {
+		return;								/* Still running */
+	}
+	b->txtail += b->txlen;
+	b->txlen = 0;
+	cdc_BridgeTx(cdc);
+	cdc_BridgeOut(cdc);
+}
+
+/*********************************************************************//**
+ * @brief		Start of frame (1ms): send what the UART received since
+ * 				the last IN transfer, poll the GPDMA channels in case
+ * 				USB_CdcBridgeDMAHandler() is not called, update the
+ * 				flow control statistics
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeSOF(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+
+	if (!b->running) {
+		return;
+	}
+	cdc_BridgeDMA(cdc);
+	cdc_BridgeIn(cdc);
+	if (GPDMA_IntGetStatus(GPDMA_STAT_ENABLED_CH, b->DMARx) == RESET) {
+		b->RxHolds++;
+	}
+	cdc_BridgeOut(cdc);
+	if (b->outlen == 0) {
+		b->OutHolds++;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Stop the bridge: USB DMA of the bulk data endpoints and
+ * 				both GPDMA channels
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeStop(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+
+	b->running = 0;
+	USB_DMA_Disable(cdc->DEP_IN);
+	USB_DMA_Disable(cdc->DEP_OUT);
+	GPDMA_ChannelCmd(b->DMARx, DISABLE);
+	GPDMA_ChannelCmd(b->DMATx, DISABLE);
+	GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, b->DMARx);
+	GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, b->DMARx);
+	GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, b->DMATx);
+	GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, b->DMATx);
+	b->inlen = 0;
+	b->outlen = 0;
+	b->txlen = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Start the bridge with empty rings: UART receive chain
+ * 				and bulk OUT endpoint
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void cdc_BridgeStart(USBDEV_CDC_Type *cdc)
+{
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+	uint32_t i;
+
+	cdc_BridgeStop(cdc);
+
+	/* One LLI per block, no terminal count interrupt: the head is read
+	 * from the channel. Ring empty, rxtail at 0: cut before the last block */
+	for (i = 0; i < b->RxBlocks; i++) {
+		b->RxLLI[i].SrcAddr = (uint32_t)&b->UARTx->RBR;
+		b->RxLLI[i].DstAddr = (uint32_t)(b->RxBuf + i * b->RxBlockSize);
+		b->RxLLI[i].NextLLI = (uint32_t)&b->RxLLI[(i + 1) % b->RxBlocks];
+		b->RxLLI[i].Control = GPDMA_DMACCxControl_TransferSize((uint32_t)b->RxBlockSize) \
+						| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) \
+						| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) \
+						| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_BYTE) \
+						| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_BYTE) \
+						| GPDMA_DMACCxControl_DI;
+	}
+	b->rxtail = 0;
+	b->rxcut = b->RxBlocks - 2;
+	b->RxLLI[b->rxcut].NextLLI = 0;
+	b->txhead = 0;
+	b->txtail = 0;
+	b->txwrap = 0;
+	b->running = 1;
+	cdc_BridgeRxRun(b, 0);
+	cdc_BridgeOut(cdc);
+}
+#endif /* _USB_DMA */
+
+
+/*********************************************************************//**
+ * @brief		Setup stage of CDC class requests
+ * @param[in]	arg		Point to USBDEV_CDC_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	data	Point to data stage, pData is EP0Buf
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t cdc_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data)
+{
+	USBDEV_CDC_Type *cdc = (USBDEV_CDC_Type *)arg;
+	uint8_t *buf = data->pData;
+
+	if (setup->bmRequestType.BM.Type != REQUEST_CLASS) {
+		return (FALSE);
+	}
+	switch (setup->bRequest) {
+	case CDC_SEND_ENCAPSULATED_COMMAND:
+	case CDC_SET_COMM_FEATURE:
+	case CDC_SET_LINE_CODING:
+		// Data stage received in EP0Buf, see cdc_DataOut()
+		return (TRUE);
+	case CDC_GET_ENCAPSULATED_RESPONSE:
+		data->Count = 0;
+		return (TRUE);
+	case CDC_GET_COMM_FEATURE:
+		buf[0] = 0;
+		buf[1] = 0;
+		data->Count = 2;
+		return (TRUE);
+	case CDC_CLEAR_COMM_FEATURE:
+		return (TRUE);
+	case CDC_GET_LINE_CODING:
+		buf[0] = (cdc->LineCoding.dwDTERate >>  0) & 0xFF;
+		buf[1] = (cdc->LineCoding.dwDTERate >>  8) & 0xFF;
+		buf[2] = (cdc->LineCoding.dwDTERate >> 16) & 0xFF;
+		buf[3] = (cdc->LineCoding.dwDTERate >> 24) & 0xFF;
+		buf[4] =  cdc->LineCoding.bCharFormat;
+		buf[5] =  cdc->LineCoding.bParityType;
+		buf[6] =  cdc->LineCoding.bDataBits;
+		data->Count = 7;
+		return (TRUE);
+	case CDC_SET_CONTROL_LINE_STATE:
+		if (cdc->SetControlLineState != NULL) {
+			return (cdc->SetControlLineState(cdc, setup->wValue.W));
+		}
+		return (TRUE);
+	case CDC_SEND_BREAK:
+		if (cdc->SendBreak != NULL) {
+			return (cdc->SendBreak(cdc, setup->wValue.W));
+		}
+		return (TRUE);
+	}
+	return (FALSE);
+}
+
+/*********************************************************************//**
+ * @brief		OUT data stage of CDC class requests
+ * @param[in]	arg		Point to USBDEV_CDC_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	buf		Point to received data
+ * @param[in]	len		Number of bytes received
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t cdc_DataOut(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len)
+{
+	USBDEV_CDC_Type *cdc = (USBDEV_CDC_Type *)arg;
+	CDC_LINE_CODING old;
+
+	switch (setup->bRequest) {
+	case CDC_SEND_ENCAPSULATED_COMMAND:
+	case CDC_SET_COMM_FEATURE:
+		return (TRUE);
+	case CDC_SET_LINE_CODING:
+		if (len < 7) {
+			return (FALSE);
+		}
+		old = cdc->LineCoding;
+		cdc->LineCoding.dwDTERate   =   (buf[0] <<  0)
+									  | (buf[1] <<  8)
+									  | (buf[2] << 16)
+									  | (buf[3] << 24);
+		cdc->LineCoding.bCharFormat =  buf[4];
+		cdc->LineCoding.bParityType =  buf[5];
+		cdc->LineCoding.bDataBits   =  buf[6];
+		if ((cdc->SetLineCoding != NULL) && !cdc->SetLineCoding(cdc)) {
+			cdc->LineCoding = old;
+			return (FALSE);
+		}
+		return (TRUE);
+	}
+	return (FALSE);
+}
+
+/*********************************************************************//**
+ * @brief		Device events: endpoints are empty after reset and
+ * 				configuration, the bridge runs while the device is
+ * 				configured and is served on each start of frame
+ * @param[in]	arg		Point to USBDEV_CDC_Type structure
+ * @param[in]	event	USBDEV_EVT_RESET, USBDEV_EVT_CONFIGURE or
+ * 				USBDEV_EVT_SOF
+ * @param[in]	param	Configuration value for USBDEV_EVT_CONFIGURE
+ * @return 		None
+ **********************************************************************/
+static void cdc_Event(void *arg, uint32_t event, uint32_t param)
+{
+	USBDEV_CDC_Type *cdc = (USBDEV_CDC_Type *)arg;
+
+	switch (event) {
+	case USBDEV_EVT_RESET:
+	case USBDEV_EVT_CONFIGURE:
+		cdc->InBusy = 0;
+		cdc->NotifyBusy = 0;
+#ifdef _USB_DMA
+		if (cdc->Bridge != NULL) {
+			if ((event == USBDEV_EVT_CONFIGURE) && (param != 0)) {
+				cdc_BridgeStart(cdc);
+			} else {
+				cdc_BridgeStop(cdc);
+			}
+		}
+#endif
+		break;
+#ifdef _USB_DMA
+	case USBDEV_EVT_SOF:
+		cdc_BridgeSOF(cdc);
+		break;
+#endif
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Notification endpoint handler
+ * @param[in]	arg		Point to USBDEV_CDC_Type structure
+ * @param[in]	event	USB_EVT_IN
+ * @return 		None
+ **********************************************************************/
+static void cdc_NotifyEP(void *arg, uint32_t event)
+{
+	USBDEV_CDC_Type *cdc = (USBDEV_CDC_Type *)arg;
+
+	(void)event;
+	cdc->NotifyBusy = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Bulk data endpoints handler
+ * @param[in]	arg		Point to USBDEV_CDC_Type structure
+ * @param[in]	event	USB_EVT_OUT or USB_EVT_IN, with the bridge the
+ * 				USB_EVT_xxx_DMA_EOT and USB_EVT_xxx_DMA_ERR events
+ * @return 		None
+ **********************************************************************/
+static void cdc_DataEP(void *arg, uint32_t event)
+{
+	USBDEV_CDC_Type *cdc = (USBDEV_CDC_Type *)arg;
+
+	switch (event) {
+	case USB_EVT_OUT:
+		if (cdc->BulkOut != NULL) {
+			cdc->BulkOut(cdc);
+		} else {
+			USB_ClearEPBuf(cdc->DEP_OUT);
+		}
+		break;
+	case USB_EVT_IN:
+		cdc->InBusy = 0;
+		if (cdc->BulkIn != NULL) {
+			cdc->BulkIn(cdc);
+		}
+		break;
+#ifdef _USB_DMA
+	/* System errors end the transfer too, with USB_DMA_ERROR status */
+	case USB_EVT_OUT_DMA_EOT:
+	case USB_EVT_OUT_DMA_ERR:
+		cdc_BridgeOutDone(cdc);
+		break;
+	case USB_EVT_IN_DMA_EOT:
+	case USB_EVT_IN_DMA_ERR:
+		cdc_BridgeInDone(cdc);
+		break;
+#endif
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup USBDEV_CDC_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize CDC class driver: register it with its
+ * 				interfaces (CIF and CIF + 1) and its endpoints. With a
+ * 				bridge, GPDMA_Init() must have been called: the bridge
+ * 				starts when the host configures the device
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure, configuration
+ * 				fields and LineCoding must be filled
+ * @return 		None
+ **********************************************************************/
+void USB_CdcInit(USBDEV_CDC_Type *cdc)
+{
+#ifdef _USB_DMA
+	USBDEV_CDC_BRIDGE_Type *b = cdc->Bridge;
+#endif
+
+	CHECK_PARAM(PARAM_USBDEV_EP(cdc->CEP_IN) && PARAM_USBDEV_EP(cdc->DEP_IN)
+				&& PARAM_USBDEV_EP(cdc->DEP_OUT));
+
+	cdc->SerialState = 0;
+	cdc->InBusy = 0;
+	cdc->NotifyBusy = 0;
+
+	cdc->cls.FirstIF = cdc->CIF;
+	cdc->cls.NumIF = 2;
+	cdc->cls.EPMask = USBDEV_EP_BIT(cdc->CEP_IN) | USBDEV_EP_BIT(cdc->DEP_IN)
+					| USBDEV_EP_BIT(cdc->DEP_OUT);
+	cdc->cls.EventMask = USBDEV_EVT_RESET | USBDEV_EVT_CONFIGURE;
+#ifdef _USB_DMA
+	if (b != NULL) {
+		CHECK_PARAM((b->RxBlocks >= 3) && (b->RxBlockSize >= 1) && (b->RxBlockSize <= 4095)
+					&& ((b->RxBlocks * b->RxBlockSize) <= 0xFFFF));
+		CHECK_PARAM((b->TxSize >= CDC_MAX_PACKET) && ((b->TxSize % CDC_MAX_PACKET) == 0));
+		CHECK_PARAM((b->DMARx <= 7) && (b->DMATx <= 7) && (b->DMARx != b->DMATx));
+
+		if (b->UARTx == LPC_UART0) {
+			b->connrx = GPDMA_CONN_UART0_Rx;
+			b->conntx = GPDMA_CONN_UART0_Tx;
+		} else if (b->UARTx == (LPC_UART_TypeDef *)LPC_UART1) {
+			b->connrx = GPDMA_CONN_UART1_Rx;
+			b->conntx = GPDMA_CONN_UART1_Tx;
+		} else if (b->UARTx == LPC_UART2) {
+			b->connrx = GPDMA_CONN_UART2_Rx;
+			b->conntx = GPDMA_CONN_UART2_Tx;
+		} else {
+			CHECK_PARAM(b->UARTx == LPC_UART3);
+			b->connrx = GPDMA_CONN_UART3_Rx;
+			b->conntx = GPDMA_CONN_UART3_Tx;
+		}
+		b->running = 0;
+		b->inlen = 0;
+		b->outlen = 0;
+		b->txlen = 0;
+		b->InBytes = 0;
+		b->OutBytes = 0;
+		b->RxHolds = 0;
+		b->OutHolds = 0;
+		b->Errors = 0;
+		/* Received bytes are sent once per frame at least */
+		cdc->cls.EventMask |= USBDEV_EVT_SOF;
+	}
+#endif
+	cdc->cls.Request = cdc_Request;
+	cdc->cls.DataOut = cdc_DataOut;
+	cdc->cls.Event = cdc_Event;
+	cdc->cls.arg = cdc;
+	USB_RegisterClass(&cdc->cls);
+
+	USB_RegisterEP(cdc->CEP_IN, cdc_NotifyEP, cdc);
+	USB_RegisterEP(cdc->DEP_IN, cdc_DataEP, cdc);
+	USB_RegisterEP(cdc->DEP_OUT, cdc_DataEP, cdc);
+}
+
+/*********************************************************************//**
+ * @brief		Write a packet to the bulk data IN endpoint, if it is
+ * 				empty
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @param[in]	buf		Point to data
+ * @param[in]	len		Number of bytes, max packet size of DEP_IN at most
+ * @return 		Number of bytes written, 0 if the endpoint is busy, the
+ * 				device is not configured or a bridge serves the endpoint
+ **********************************************************************/
+uint32_t USB_CdcWrite(USBDEV_CDC_Type *cdc, uint8_t *buf, uint32_t len)
+{
+	if ((USB_Configuration == 0) || cdc->InBusy || (len == 0) || (cdc->Bridge != NULL)) {
+		return 0;
+	}
+	cdc->InBusy = 1;
+	return (USB_WriteEP(cdc->DEP_IN, buf, len));
+}
+
+/*********************************************************************//**
+ * @brief		Send the SERIAL_STATE notification (usbcdc11.pdf, 6.3.5)
+ * 				if the UART state changed since the last one sent
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @param[in]	state	UART state bitmap, CDC_SERIAL_STATE_xxx bits
+ * @return 		ERROR if the notification endpoint is busy or the device
+ * 				is not configured, otherwise SUCCESS
+ **********************************************************************/
+Status USB_CdcNotify(USBDEV_CDC_Type *cdc, uint16_t state)
+{
+	if (state == cdc->SerialState) {
+		return SUCCESS;
+	}
+	if ((USB_Configuration == 0) || cdc->NotifyBusy) {
+		return ERROR;
+	}
+	cdc->SerialState = state;
+	cdc->NotifyBuf[0] = 0xA1;							// bmRequestType
+	cdc->NotifyBuf[1] = CDC_NOTIFICATION_SERIAL_STATE;	// bNotification (SERIAL_STATE)
+	cdc->NotifyBuf[2] = 0x00;							// wValue
+	cdc->NotifyBuf[3] = 0x00;
+	cdc->NotifyBuf[4] = cdc->CIF;						// wIndex (Interface #, LSB first)
+	cdc->NotifyBuf[5] = 0x00;
+	cdc->NotifyBuf[6] = 0x02;							// wLength (Data length = 2 bytes, LSB first)
+	cdc->NotifyBuf[7] = 0x00;
+	cdc->NotifyBuf[8] = (state >>  0) & 0xFF;			// UART State Bitmap (16bits, LSB first)
+	cdc->NotifyBuf[9] = (state >>  8) & 0xFF;
+	cdc->NotifyBusy = 1;
+	USB_WriteEP(cdc->CEP_IN, cdc->NotifyBuf, CDC_NOTIFICATION_SIZE);
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		GPDMA interrupt handler of the bridge, to be called from
+ * 				DMA_IRQHandler() at the priority of the USB interrupt.
+ * 				Without it, the UART transmit is resumed on the next
+ * 				start of frame only (gaps of up to 1ms)
+ * @param[in]	cdc		Point to USBDEV_CDC_Type structure
+ * @return 		None
+ **********************************************************************/
+void USB_CdcBridgeDMAHandler(USBDEV_CDC_Type *cdc)
+{
+#ifdef _USB_DMA
+	if ((cdc->Bridge != NULL) && cdc->Bridge->running) {
+		cdc_BridgeDMA(cdc);
+	}
+#endif
+}
+
+/**
+ * @}
+ */
+
+#endif /* _USBDEV_CDC */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
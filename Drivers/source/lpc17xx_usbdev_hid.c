@@ -0,0 +1,614 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_hid.c			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_hid.c
+* @brief	Contains all functions support for the USB HID (human interface
+* 			device) class driver on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup USBDEV_HID
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev_hid.h"
+
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _USBDEV_HID
+
+/* Private Functions ---------------------------------------------------------- */
+
+static uint32_t hid_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data);
+static uint32_t hid_DataOut(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len);
+static void hid_Event(void *arg, uint32_t event, uint32_t param);
+static void hid_EP(void *arg, uint32_t event);
+#ifdef _USB_DMA
+static void hid_QueueDMA(uint32_t EPNum, uint8_t *buf, uint32_t len, uint32_t size);
+static void hid_QueueIn(USBDEV_HID_Type *hid);
+static void hid_QueueInDone(USBDEV_HID_Type *hid);
+static void hid_QueueOut(USBDEV_HID_Type *hid);
+static void hid_QueueOutDone(USBDEV_HID_Type *hid);
+static void hid_QueueSOF(USBDEV_HID_Type *hid);
+static void hid_QueueStop(USBDEV_HID_Type *hid);
+static void hid_QueueStart(USBDEV_HID_Type *hid);
+
+/*********************************************************************//**
+ * @brief		Queue a DMA transfer on an interrupt endpoint, replacing
+ * 				its previous descriptor
+ * @param[in]	EPNum	Endpoint address
+ * @param[in]	buf		Point to reports, in AHB SRAM
+ * @param[in]	len		Number of bytes, whole reports
+ * @param[in]	size	Report size: one packet per report
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueDMA(uint32_t EPNum, uint8_t *buf, uint32_t len, uint32_t size)
+{
+	USB_DMA_DESCRIPTOR DD;
+
+	DD.BufAdr = (uint32_t)buf;
+	DD.BufLen = len;
+	DD.MaxSize = size;
+	DD.InfoAdr = 0;
+	DD.Cfg.Val = 0;
+	USB_DMA_Setup(EPNum, &DD);
+	USB_DMA_Enable(EPNum);
+}
+
+/*********************************************************************//**
+ * @brief		Send the posted reports contiguous in InBuf, half of
+ * 				InBuf at most, in one DMA transfer if none is in flight
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueIn(USBDEV_HID_Type *hid)
+{
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+	uint32_t idx, n;
+
+	if (!q->running || (q->inlen != 0)) {
+		return;
+	}
+	n = q->inhead - q->intail;
+	if (n == 0) {
+		return;
+	}
+	idx = q->intail & (q->InSlots - 1);
+	if (n > (q->InSlots - idx)) {
+		n = q->InSlots - idx;			/* Contiguous up to the end of InBuf */
+	}
+	/* Slots freed by half of InBuf at a time at least */
+	if (n > (q->InSlots / 2)) {
+		n = q->InSlots / 2;
+	}
+	q->inlen = n;
+	hid_QueueDMA(hid->EP_IN, q->InBuf + idx * q->ReportSize, n * q->ReportSize,
+				q->ReportSize);
+}
+
+/*********************************************************************//**
+ * @brief		End of a DMA transfer on EP_IN: its last report is in the
+ * 				endpoint buffer, free its slots and send the next reports
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueInDone(USBDEV_HID_Type *hid)
+{
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+	uint32_t status;
+
+	status = USB_DMA_Status(hid->EP_IN);
+	if ((status == USB_DMA_IDLE) || (status == USB_DMA_BUSY) || (q->inlen == 0)) {
+		return;							/* Already replaced, nothing to do */
+	}
+	USB_DMA_Disable(hid->EP_IN);
+	if (status == USB_DMA_DONE) {
+		q->InCount += q->inlen;
+	} else {
+		q->Errors++;					/* Reports lost */
+	}
+	q->intail += q->inlen;
+	q->inlen = 0;
+	hid_QueueIn(hid);
+}
+
+/*********************************************************************//**
+ * @brief		Arm EP_OUT with a DMA transfer of one report into the next
+ * 				slot of OutBuf, if it is free and no transfer is armed
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueOut(USBDEV_HID_Type *hid)
+{
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	if (!q->running || (hid->EP_OUT == 0) || (q->outlen != 0)
+		|| ((q->outhead - q->outtail) == q->OutSlots)) {
+		return;
+	}
+	q->outlen = q->ReportSize;
+	hid_QueueDMA(hid->EP_OUT, q->OutBuf + (q->outhead & (q->OutSlots - 1)) * q->ReportSize,
+				q->ReportSize, q->ReportSize);
+}
+
+/*********************************************************************//**
+ * @brief		End of a DMA transfer on EP_OUT: the host sent a report,
+ * 				or a shorter packet
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueOutDone(USBDEV_HID_Type *hid)
+{
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+	uint32_t status, n;
+	uint8_t *buf;
+
+	status = USB_DMA_Status(hid->EP_OUT);
+	if ((status == USB_DMA_IDLE) || (status == USB_DMA_BUSY) || (q->outlen == 0)) {
+		return;							/* Already replaced, nothing to do */
+	}
+	n = 0;
+	if (status == USB_DMA_DONE) {
+		n = q->outlen;
+	} else if (status == USB_DMA_UNDER_RUN) {
+		n = USB_DMA_BufCnt(hid->EP_OUT);
+		if (n > q->outlen) {
+			n = q->outlen;
+		}
+	} else {
+		q->Errors++;
+	}
+	USB_DMA_Disable(hid->EP_OUT);
+	if (n != 0) {
+		buf = q->OutBuf + (q->outhead & (q->OutSlots - 1)) * q->ReportSize;
+		for (; n < q->ReportSize; n++) {
+			buf[n] = 0;
+		}
+		q->outhead++;
+		q->OutCount++;
+	}
+	q->outlen = 0;
+	hid_QueueOut(hid);
+}
+
+/*********************************************************************//**
+ * @brief		Start of frame (1ms): send the reports posted since the
+ * 				queue ran empty, arm EP_OUT if a slot was released,
+ * 				update the statistics
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueSOF(USBDEV_HID_Type *hid)
+{
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	if (!q->running) {
+		return;
+	}
+	hid_QueueIn(hid);
+	if (q->inlen == 0) {
+		q->InIdle++;
+	}
+	if (hid->EP_OUT != 0) {
+		hid_QueueOut(hid);
+		if (q->outlen == 0) {
+			q->OutHolds++;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Stop the queue: USB DMA of the interrupt endpoints, the
+ * 				reports not sent are dropped, the reports received are
+ * 				kept for the application
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueStop(USBDEV_HID_Type *hid)
+{
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	q->running = 0;
+	USB_DMA_Disable(hid->EP_IN);
+	if (hid->EP_OUT != 0) {
+		USB_DMA_Disable(hid->EP_OUT);
+	}
+	q->intail = q->inhead;
+	q->inlen = 0;
+	q->outlen = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Start the queue: empty IN queue, EP_OUT armed
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+static void hid_QueueStart(USBDEV_HID_Type *hid)
+{
+	hid_QueueStop(hid);
+	hid->Queue->running = 1;
+	hid_QueueOut(hid);
+}
+#endif /* _USB_DMA */
+
+/*********************************************************************//**
+ * @brief		Setup stage of HID requests: class descriptors
+ * 				(GET_DESCRIPTOR to the interface) and class requests
+ * @param[in]	arg		Point to USBDEV_HID_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	data	Point to data stage, pData is EP0Buf
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t hid_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data)
+{
+	USBDEV_HID_Type *hid = (USBDEV_HID_Type *)arg;
+	uint32_t len, n;
+
+	if (setup->bmRequestType.BM.Type == REQUEST_STANDARD) {
+		if (setup->bRequest != USB_REQUEST_GET_DESCRIPTOR) {
+			return (FALSE);
+		}
+		switch (setup->wValue.WB.H) {
+		case HID_HID_DESCRIPTOR_TYPE:
+			data->pData = (uint8_t *)hid->HidDescriptor;
+			data->Count = hid->HidDescriptor[0];
+			return (TRUE);
+		case HID_REPORT_DESCRIPTOR_TYPE:
+			data->pData = (uint8_t *)hid->ReportDescriptor;
+			data->Count = hid->ReportDescSize;
+			return (TRUE);
+		}
+		return (FALSE);
+	}
+	if (setup->bmRequestType.BM.Type != REQUEST_CLASS) {
+		return (FALSE);
+	}
+	switch (setup->bRequest) {
+	case HID_REQUEST_GET_REPORT:
+		if (hid->GetReport == NULL) {
+			return (FALSE);
+		}
+		len = (setup->wLength < USB_EP0_BUF_SIZE) ? setup->wLength : USB_EP0_BUF_SIZE;
+		if (!hid->GetReport(hid, setup->wValue.WB.H, setup->wValue.WB.L, data->pData, &len)) {
+			return (FALSE);
+		}
+		data->Count = len;
+		return (TRUE);
+	case HID_REQUEST_SET_REPORT:
+		// Data stage received in EP0Buf, see hid_DataOut()
+		return (hid->SetReport != NULL);
+	case HID_REQUEST_GET_IDLE:
+		if (setup->wValue.WB.L >= hid->NumReports) {
+			return (FALSE);
+		}
+		data->pData[0] = hid->IdleTime[setup->wValue.WB.L];
+		data->Count = 1;
+		return (TRUE);
+	case HID_REQUEST_SET_IDLE:
+		if (setup->wValue.WB.L >= hid->NumReports) {
+			return (FALSE);
+		}
+		if (setup->wValue.WB.L == 0) {
+			// Report ID 0: all reports
+			for (n = 0; n < hid->NumReports; n++) {
+				hid->IdleTime[n] = setup->wValue.WB.H;
+			}
+		} else {
+			hid->IdleTime[setup->wValue.WB.L] = setup->wValue.WB.H;
+		}
+		return (TRUE);
+	case HID_REQUEST_GET_PROTOCOL:
+		data->pData[0] = hid->Protocol;
+		data->Count = 1;
+		return (TRUE);
+	case HID_REQUEST_SET_PROTOCOL:
+		hid->Protocol = setup->wValue.WB.L;
+		return (TRUE);
+	}
+	return (FALSE);
+}
+
+/*********************************************************************//**
+ * @brief		OUT data stage of HID class requests (SET_REPORT)
+ * @param[in]	arg		Point to USBDEV_HID_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	buf		Point to received data
+ * @param[in]	len		Number of bytes received
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t hid_DataOut(void *arg, USB_SETUP_PACKET *setup, uint8_t *buf, uint32_t len)
+{
+	USBDEV_HID_Type *hid = (USBDEV_HID_Type *)arg;
+
+	if (setup->bRequest != HID_REQUEST_SET_REPORT) {
+		return (FALSE);
+	}
+	return (hid->SetReport(hid, setup->wValue.WB.H, setup->wValue.WB.L, buf, len));
+}
+
+/*********************************************************************//**
+ * @brief		Device events: default idle rate and protocol after
+ * 				reset, first report written when configured. The report
+ * 				queue runs while the device is configured and is served
+ * 				on each start of frame
+ * @param[in]	arg		Point to USBDEV_HID_Type structure
+ * @param[in]	event	USBDEV_EVT_RESET, USBDEV_EVT_CONFIGURE or
+ * 				USBDEV_EVT_SOF
+ * @param[in]	param	Configuration value for USBDEV_EVT_CONFIGURE
+ * @return 		None
+ **********************************************************************/
+static void hid_Event(void *arg, uint32_t event, uint32_t param)
+{
+	USBDEV_HID_Type *hid = (USBDEV_HID_Type *)arg;
+	uint32_t n;
+
+	switch (event) {
+	case USBDEV_EVT_RESET:
+		hid->Protocol = HID_PROTOCOL_REPORT;
+		for (n = 0; n < HID_REPORT_NUM_MAX; n++) {
+			hid->IdleTime[n] = 0;
+		}
+#ifdef _USB_DMA
+		if (hid->Queue != NULL) {
+			hid_QueueStop(hid);
+		}
+#endif
+		break;
+	case USBDEV_EVT_CONFIGURE:
+#ifdef _USB_DMA
+		if (hid->Queue != NULL) {
+			if (param != 0) {
+				hid_QueueStart(hid);
+			} else {
+				hid_QueueStop(hid);
+			}
+			break;
+		}
+#endif
+		if (USB_Configuration && (hid->InReady != NULL)) {
+			hid->InReady(hid);
+		}
+		break;
+#ifdef _USB_DMA
+	case USBDEV_EVT_SOF:
+		hid_QueueSOF(hid);
+		break;
+#endif
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Interrupt endpoints handler
+ * @param[in]	arg		Point to USBDEV_HID_Type structure
+ * @param[in]	event	USB_EVT_IN or USB_EVT_OUT, with the report queue
+ * 				the USB_EVT_xxx_DMA_EOT and USB_EVT_xxx_DMA_ERR events
+ * @return 		None
+ **********************************************************************/
+static void hid_EP(void *arg, uint32_t event)
+{
+	USBDEV_HID_Type *hid = (USBDEV_HID_Type *)arg;
+
+	switch (event) {
+	case USB_EVT_IN:
+		if (hid->InReady != NULL) {
+			hid->InReady(hid);
+		}
+		break;
+	case USB_EVT_OUT:
+		if (hid->OutReport != NULL) {
+			hid->OutReport(hid);
+		} else {
+			USB_ClearEPBuf(hid->EP_OUT);
+		}
+		break;
+#ifdef _USB_DMA
+	/* System errors end the transfer too, with USB_DMA_ERROR status */
+	case USB_EVT_OUT_DMA_EOT:
+	case USB_EVT_OUT_DMA_ERR:
+		hid_QueueOutDone(hid);
+		break;
+	case USB_EVT_IN_DMA_EOT:
+	case USB_EVT_IN_DMA_ERR:
+		hid_QueueInDone(hid);
+		break;
+#endif
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup USBDEV_HID_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize HID class driver: register it with its
+ * 				interface and its endpoints. With a report queue, the
+ * 				queue starts when the host configures the device
+ * @param[in]	hid		Point to USBDEV_HID_Type structure, configuration
+ * 				fields must be filled
+ * @return 		None
+ **********************************************************************/
+void USB_HidInit(USBDEV_HID_Type *hid)
+{
+	uint32_t n;
+#ifdef _USB_DMA
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+#endif
+
+	CHECK_PARAM(PARAM_USBDEV_EP(hid->EP_IN));
+	CHECK_PARAM((hid->NumReports >= 1) && (hid->NumReports <= HID_REPORT_NUM_MAX));
+
+	hid->Protocol = HID_PROTOCOL_REPORT;
+	for (n = 0; n < HID_REPORT_NUM_MAX; n++) {
+		hid->IdleTime[n] = 0;
+	}
+
+	hid->cls.FirstIF = hid->IF;
+	hid->cls.NumIF = 1;
+	hid->cls.EPMask = USBDEV_EP_BIT(hid->EP_IN);
+	if (hid->EP_OUT != 0) {
+		hid->cls.EPMask |= USBDEV_EP_BIT(hid->EP_OUT);
+	}
+	hid->cls.EventMask = USBDEV_EVT_RESET | USBDEV_EVT_CONFIGURE;
+#ifdef _USB_DMA
+	if (q != NULL) {
+		CHECK_PARAM((q->ReportSize >= 1) && (q->ReportSize <= HID_QUEUE_REPORT_MAX));
+		CHECK_PARAM((q->InSlots >= 2) && ((q->InSlots & (q->InSlots - 1)) == 0)
+					&& ((q->InSlots * q->ReportSize) <= 0xFFFF));
+		CHECK_PARAM((hid->EP_OUT == 0) || ((q->OutBuf != NULL) && (q->OutSlots >= 2)
+					&& ((q->OutSlots & (q->OutSlots - 1)) == 0)));
+
+		q->running = 0;
+		q->inhead = 0;
+		q->intail = 0;
+		q->inlen = 0;
+		q->outhead = 0;
+		q->outtail = 0;
+		q->outlen = 0;
+		q->InCount = 0;
+		q->OutCount = 0;
+		q->InIdle = 0;
+		q->OutHolds = 0;
+		q->Errors = 0;
+		/* Reports posted while the queue was empty are sent once per frame */
+		hid->cls.EventMask |= USBDEV_EVT_SOF;
+	}
+#endif
+	hid->cls.Request = hid_Request;
+	hid->cls.DataOut = hid_DataOut;
+	hid->cls.Event = hid_Event;
+	hid->cls.arg = hid;
+	USB_RegisterClass(&hid->cls);
+
+	USB_RegisterEP(hid->EP_IN, hid_EP, hid);
+	if (hid->EP_OUT != 0) {
+		USB_RegisterEP(hid->EP_OUT, hid_EP, hid);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Get the next free slot of the IN report queue, to be
+ * 				filled then posted by USB_HidInPost()
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		Point to ReportSize bytes, NULL if the queue is full, the
+ * 				device is not configured or there is no report queue
+ **********************************************************************/
+uint8_t *USB_HidInSlot(USBDEV_HID_Type *hid)
+{
+#ifdef _USB_DMA
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	if ((q == NULL) || !q->running || ((q->inhead - q->intail) >= q->InSlots)) {
+		return NULL;
+	}
+	return (q->InBuf + (q->inhead & (q->InSlots - 1)) * q->ReportSize);
+#else
+	return NULL;
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Post the slot returned by USB_HidInSlot(): it is sent
+ * 				after the reports posted before it, within a frame when
+ * 				the queue was empty
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		ERROR if the queue is full, the device is not configured
+ * 				(the slot is dropped) or there is no report queue,
+ * 				otherwise SUCCESS
+ **********************************************************************/
+Status USB_HidInPost(USBDEV_HID_Type *hid)
+{
+#ifdef _USB_DMA
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	if ((q == NULL) || !q->running || ((q->inhead - q->intail) >= q->InSlots)) {
+		return ERROR;
+	}
+	// Report contents before the index read by the interrupt
+	__DMB();
+	q->inhead++;
+	return SUCCESS;
+#else
+	(void)hid;
+	return ERROR;
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Get the oldest report received on EP_OUT, to be freed by
+ * 				USB_HidOutRelease()
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		Point to ReportSize bytes, NULL if no report was received
+ * 				or there is no report queue
+ **********************************************************************/
+uint8_t *USB_HidOutReport(USBDEV_HID_Type *hid)
+{
+#ifdef _USB_DMA
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	if ((q == NULL) || (hid->EP_OUT == 0) || (q->outhead == q->outtail)) {
+		return NULL;
+	}
+	return (q->OutBuf + (q->outtail & (q->OutSlots - 1)) * q->ReportSize);
+#else
+	return NULL;
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Free the report returned by USB_HidOutReport(): EP_OUT is
+ * 				armed again within a frame if the queue was full
+ * @param[in]	hid		Point to USBDEV_HID_Type structure
+ * @return 		None
+ **********************************************************************/
+void USB_HidOutRelease(USBDEV_HID_Type *hid)
+{
+#ifdef _USB_DMA
+	USBDEV_HID_QUEUE_Type *q = hid->Queue;
+
+	if ((q != NULL) && (q->outhead != q->outtail)) {
+		q->outtail++;
+	}
+#endif
+}
+
+/**
+ * @}
+ */
+
+#endif /* _USBDEV_HID */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,1034 @@
+/**********************************************************************
+* $Id$		lpc17xx_usbdev_msc.c			2011-03-09
+*//**
+* @file		lpc17xx_usbdev_msc.c
+* @brief	Contains all functions support for the USB MSC (mass storage
+* 			class, bulk-only transport, SCSI transparent command set) class
+* 			driver on LPC17xx
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @addtogroup USBDEV_MSC
+ * @{
+ */
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc17xx_usbdev_msc.h"
+
+
+/* If this source file built with example, the LPC17xx FW library configuration
+ * file in each example directory ("lpc17xx_libcfg.h") must be included,
+ * otherwise the default FW library configuration file must be included instead
+ */
+#ifdef __BUILD_WITH_EXAMPLE__
+#include "lpc17xx_libcfg.h"
+#else
+#include "lpc17xx_libcfg_default.h"
+#endif /* __BUILD_WITH_EXAMPLE__ */
+
+
+#ifdef _USBDEV_MSC
+
+/* Private Macros ------------------------------------------------------------- */
+/** Largest DMA chunk: BufLen field of a DMA descriptor */
+#define MSC_DMA_MAX_LEN		0xFFFF
+
+/* Private Variables ---------------------------------------------------------- */
+/** Default vendor, product and revision of INQUIRY data */
+static const uint8_t msc_DefaultID[MSC_INQUIRY_ID_SIZE] = {
+	'K','e','i','l',' ',' ',' ',' ',
+	'L','P','C','1','7','x','x',' ','D','i','s','k',' ',' ',' ',' ',
+	'1','.','0',' '
+};
+
+/* Private Functions ---------------------------------------------------------- */
+
+static void msc_WriteIn(USBDEV_MSC_Type *msc, uint8_t *buf, uint32_t len);
+static void msc_SetCSW(USBDEV_MSC_Type *msc);
+static void msc_MemoryRead(USBDEV_MSC_Type *msc);
+static void msc_MemoryReadSend(USBDEV_MSC_Type *msc, uint8_t *buf, uint32_t n);
+static void msc_MemoryWrite(USBDEV_MSC_Type *msc);
+static void msc_MemoryVerify(USBDEV_MSC_Type *msc);
+static uint32_t msc_RWSetup(USBDEV_MSC_Type *msc);
+static uint32_t msc_DataInFormat(USBDEV_MSC_Type *msc);
+static void msc_DataInTransfer(USBDEV_MSC_Type *msc);
+static void msc_GetCBW(USBDEV_MSC_Type *msc);
+static void msc_BulkIn(USBDEV_MSC_Type *msc);
+static void msc_BulkOut(USBDEV_MSC_Type *msc);
+static uint32_t msc_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data);
+static void msc_Event(void *arg, uint32_t event, uint32_t param);
+static void msc_EP(void *arg, uint32_t event);
+#ifdef _USB_DMA
+static void msc_DMAQueue(uint32_t EPNum, uint8_t *buf, uint32_t len);
+static uint32_t msc_DMAMaxLen(USBDEV_MSC_Type *msc, uint32_t mapped);
+static void msc_DMAOutStart(USBDEV_MSC_Type *msc);
+static void msc_DMAOutNext(USBDEV_MSC_Type *msc, uint32_t n);
+static void msc_DMAOut(USBDEV_MSC_Type *msc);
+static void msc_DMAError(USBDEV_MSC_Type *msc);
+static uint32_t msc_DevClip(USBDEV_MSC_Type *msc, uint32_t n);
+static void msc_DevDone(void *arg, Status status);
+#endif
+
+#ifdef _USB_DMA
+/*********************************************************************//**
+ * @brief		Queue a DMA transfer of len bytes on a bulk endpoint,
+ * 				replacing the finished descriptor of the endpoint
+ * @param[in]	EPNum	Endpoint number, bit 0..3: address, bit 7: direction
+ * @param[in]	buf		Point to data, reachable by the USB DMA
+ * @param[in]	len		Number of bytes (MSC_DMA_MAX_LEN at most)
+ * @return 		None
+ **********************************************************************/
+static void msc_DMAQueue(uint32_t EPNum, uint8_t *buf, uint32_t len)
+{
+	USB_DMA_DESCRIPTOR DD;
+
+	DD.BufAdr = (uint32_t)buf;
+	DD.BufLen = len;
+	DD.MaxSize = MSC_MAX_PACKET;
+	DD.InfoAdr = 0;
+	DD.Cfg.Val = 0;
+	USB_DMA_Setup(EPNum, &DD);
+	USB_DMA_Enable(EPNum);
+}
+
+/*********************************************************************//**
+ * @brief		Largest DMA data chunk, a multiple of BlockSize
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @param[in]	mapped	TRUE - straight from/to the medium through Map(),
+ * 				FALSE - through DMABuf
+ * @return 		Chunk length (bytes)
+ **********************************************************************/
+static uint32_t msc_DMAMaxLen(USBDEV_MSC_Type *msc, uint32_t mapped)
+{
+	uint32_t n;
+
+	if (mapped) {
+		n = MSC_DMA_MAX_LEN;
+	} else {
+		n = msc->DMABufSize - MSC_DMA_CBW_SIZE;
+	}
+	return (n - (n % msc->BlockSize));
+}
+
+/*********************************************************************//**
+ * @brief		Queue the next DMA chunk of a WRITE10/VERIFY10 data
+ * 				stage, or send the CSW when there is none left
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_DMAOutStart(USBDEV_MSC_Type *msc)
+{
+	uint8_t *buf = msc->DMABuf;
+	uint32_t n, size;
+
+	msc->DMAMapped = (msc->Map != NULL) && (msc->Dev == NULL)
+			&& (msc->CBW.CB[0] == SCSI_WRITE10);
+	n = msc_DMAMaxLen(msc, msc->DMAMapped);
+	if (msc->Length < n) {
+		n = msc->Length;
+	}
+	if (msc->Dev != NULL) {
+		n = msc_DevClip(msc, n);
+	} else {
+		size = msc->BlockSize * msc->BlockCount;
+		if (msc->Offset >= size) {
+			n = 0;
+		} else if ((msc->Offset + n) > size) {
+			n = size - msc->Offset;
+		}
+	}
+	if (n == 0) {
+		if (msc->Length != 0) {				/* Beyond the medium */
+			USB_SetStallEP(msc->EP_OUT);
+			msc->MemOK = FALSE;
+		}
+		msc->CSW.bStatus = (msc->MemOK) ? CSW_CMD_PASSED : CSW_CMD_FAILED;
+		msc_SetCSW(msc);
+		return;
+	}
+	if (msc->DMAMapped) {
+		buf = msc->Map(msc, msc->Offset, n);
+	}
+	msc->DMALen = n;
+	msc_DMAQueue(msc->EP_OUT, buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Account for a stored WRITE10/VERIFY10 chunk, then queue
+ * 				the next one
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @param[in]	n		Chunk length (bytes)
+ * @return 		None
+ **********************************************************************/
+static void msc_DMAOutNext(USBDEV_MSC_Type *msc, uint32_t n)
+{
+	msc->Offset += n;
+	msc->Length -= n;
+	msc->CSW.dDataResidue -= n;
+	msc->LBA += n / msc->BlockSize;
+	msc_DMAOutStart(msc);
+}
+
+/*********************************************************************//**
+ * @brief		End of a DMA transfer on the bulk OUT endpoint: a CBW,
+ * 				or a chunk of a WRITE10/VERIFY10 data stage
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_DMAOut(USBDEV_MSC_Type *msc)
+{
+	uint8_t *buf = (uint8_t *)msc->BulkBuf;
+	uint8_t *src;
+	uint32_t status, n, i, j, len;
+
+	status = USB_DMA_Status(msc->EP_OUT);
+	if ((status == USB_DMA_IDLE) || (status == USB_DMA_BUSY)) {
+		return;								/* Already replaced, nothing to do */
+	}
+	USB_DMA_Disable(msc->EP_OUT);
+
+	if (msc->BulkStage != MSC_BS_DATA_OUT) {
+		/* CBW of exactly sizeof(MSC_CBW) bytes, others are refused by msc_GetCBW */
+		src = msc->DMABuf + msc->DMABufSize - MSC_DMA_CBW_SIZE;
+		msc->BulkLen = (status == USB_DMA_DONE) ? sizeof(MSC_CBW) : 0;
+		for (i = 0; i < msc->BulkLen; i++) {
+			buf[i] = src[i];
+		}
+		msc_GetCBW(msc);
+		return;
+	}
+
+	if (status != USB_DMA_DONE) {
+		/* Short packet or bus error: data stage broken off */
+		USB_SetStallEP(msc->EP_OUT);
+		msc->CSW.bStatus = CSW_PHASE_ERROR;
+		msc_SetCSW(msc);
+		return;
+	}
+	n = msc->DMALen;
+	if (msc->CBW.CB[0] == SCSI_WRITE10) {
+		if (msc->Dev != NULL) {
+			/* Resumed by msc_DevDone() */
+			msc->DevStage = msc->BulkStage;
+			msc->BulkStage = MSC_BS_DEV;
+			if (msc->Dev->Write(msc->Dev, msc->LBA, msc->DMABuf, n / msc->BlockSize) != SUCCESS) {
+				msc_DevDone(msc, ERROR);
+			}
+			return;
+		}
+		if (!msc->DMAMapped && !msc->Write(msc, msc->Offset, msc->DMABuf, n)) {
+			msc->MemOK = FALSE;
+		}
+	} else if (msc->Dev == NULL) {
+		/* VERIFY10: compare packet by packet. Not with a block device,
+		 * the data is accepted as is */
+		for (i = 0; (i < n) && msc->MemOK; i += len) {
+			len = ((n - i) > MSC_MAX_PACKET) ? MSC_MAX_PACKET : (n - i);
+			if (!msc->Read(msc, msc->Offset + i, buf, len)) {
+				msc->MemOK = FALSE;
+				break;
+			}
+			for (j = 0; j < len; j++) {
+				if (buf[j] != msc->DMABuf[i + j]) {
+					msc->MemOK = FALSE;
+					break;
+				}
+			}
+		}
+	}
+	msc_DMAOutNext(msc, n);
+}
+
+/*********************************************************************//**
+ * @brief		System error of the USB DMA: stall both bulk endpoints,
+ * 				the host recovers by Bulk-Only Mass Storage Reset
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_DMAError(USBDEV_MSC_Type *msc)
+{
+	USB_DMA_Disable(msc->EP_IN);
+	USB_DMA_Disable(msc->EP_OUT);
+	USB_SetStallEP(msc->EP_IN);
+	USB_SetStallEP(msc->EP_OUT);
+	msc->BulkStage = MSC_BS_ERROR;
+}
+
+/*********************************************************************//**
+ * @brief		Clip a data chunk to the end of the block device
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @param[in]	n		Chunk length (bytes), a multiple of BlockSize
+ * @return 		Clipped length (bytes), 0 if LBA is beyond the medium
+ **********************************************************************/
+static uint32_t msc_DevClip(USBDEV_MSC_Type *msc, uint32_t n)
+{
+	uint32_t left;
+
+	left = (msc->LBA < msc->BlockCount) ? (msc->BlockCount - msc->LBA) : 0;
+	if ((n / msc->BlockSize) > left) {
+		n = left * msc->BlockSize;
+	}
+	return n;
+}
+
+/*********************************************************************//**
+ * @brief		Completion callback of the block device: resume the
+ * 				bulk-only transport where it waited (send the READ10
+ * 				chunk, queue the next WRITE10 chunk, or send the CSW of
+ * 				SYNCHRONIZE CACHE)
+ * @param[in]	arg		Point to USBDEV_MSC_Type structure
+ * @param[in]	status	SUCCESS or ERROR
+ * @return 		None
+ **********************************************************************/
+static void msc_DevDone(void *arg, Status status)
+{
+	USBDEV_MSC_Type *msc = (USBDEV_MSC_Type *)arg;
+
+	if (msc->BulkStage != MSC_BS_DEV) {
+		return;								/* Transport was reset meanwhile */
+	}
+	msc->BulkStage = msc->DevStage;
+	if (status != SUCCESS) {
+		msc->MemOK = FALSE;
+	}
+	switch (msc->CBW.CB[0]) {
+	case SCSI_READ10:
+		msc_MemoryReadSend(msc, msc->DMABuf, msc->DMALen);
+		break;
+	case SCSI_WRITE10:
+		msc_DMAOutNext(msc, msc->DMALen);
+		break;
+	default:
+		msc->CSW.bStatus = (msc->MemOK) ? CSW_CMD_PASSED : CSW_CMD_FAILED;
+		msc_SetCSW(msc);
+		break;
+	}
+}
+#endif /* _USB_DMA */
+
+/*********************************************************************//**
+ * @brief		Write a short response (data IN or CSW) to the bulk IN
+ * 				endpoint, through DMABuf in DMA mode
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @param[in]	buf		Point to data
+ * @param[in]	len		Number of bytes (MSC_MAX_PACKET at most)
+ * @return 		None
+ **********************************************************************/
+static void msc_WriteIn(USBDEV_MSC_Type *msc, uint8_t *buf, uint32_t len)
+{
+#ifdef _USB_DMA
+	uint32_t n;
+
+	if (msc->DMABuf != NULL) {
+		for (n = 0; n < len; n++) {
+			msc->DMABuf[n] = buf[n];
+		}
+		msc_DMAQueue(msc->EP_IN, msc->DMABuf, len);
+		return;
+	}
+#endif
+	USB_WriteEP(msc->EP_IN, buf, len);
+}
+
+/*********************************************************************//**
+ * @brief		Send the Command Status Wrapper
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_SetCSW(USBDEV_MSC_Type *msc)
+{
+	msc->CSW.dSignature = MSC_CSW_Signature;
+	msc_WriteIn(msc, (uint8_t *)&msc->CSW, sizeof(MSC_CSW));
+	msc->BulkStage = MSC_BS_CSW;
+#ifdef _USB_DMA
+	if (msc->DMABuf != NULL) {
+		/* Receive the next CBW */
+		msc_DMAQueue(msc->EP_OUT, msc->DMABuf + msc->DMABufSize - MSC_DMA_CBW_SIZE,
+				sizeof(MSC_CBW));
+	}
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Send the next packet of a READ10 data stage, in DMA mode
+ * 				the next chunk (straight from the medium if it is mapped,
+ * 				once the block device has read it if there is one)
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_MemoryRead(USBDEV_MSC_Type *msc)
+{
+	uint8_t *buf = (uint8_t *)msc->BulkBuf;
+	uint32_t n, size, max = MSC_MAX_PACKET;
+
+#ifdef _USB_DMA
+	if (msc->DMABuf != NULL) {
+		buf = msc->DMABuf;
+		msc->DMAMapped = (msc->Map != NULL) && (msc->Dev == NULL);
+		max = msc_DMAMaxLen(msc, msc->DMAMapped);
+	}
+#endif
+	if (msc->Length > max) {
+		n = max;
+	} else {
+		n = msc->Length;
+	}
+#ifdef _USB_DMA
+	if (msc->Dev != NULL) {
+		size = msc_DevClip(msc, n);
+		if (size != n) {
+			n = size;
+			msc->BulkStage = MSC_BS_DATA_IN_LAST_STALL;
+		}
+		if (n != 0) {
+			/* Resumed by msc_DevDone() */
+			msc->DMALen = n;
+			msc->DevStage = msc->BulkStage;
+			msc->BulkStage = MSC_BS_DEV;
+			if (msc->Dev->Read(msc->Dev, msc->LBA, buf, n / msc->BlockSize) != SUCCESS) {
+				msc_DevDone(msc, ERROR);
+			}
+			return;
+		}
+		msc_MemoryReadSend(msc, buf, 0);
+		return;
+	}
+#endif
+	size = msc->BlockSize * msc->BlockCount;
+	if ((msc->Offset + n) > size) {
+		n = size - msc->Offset;
+		msc->BulkStage = MSC_BS_DATA_IN_LAST_STALL;
+	}
+#ifdef _USB_DMA
+	if (msc->DMAMapped) {
+		buf = msc->Map(msc, msc->Offset, n);
+	}
+#endif
+	if (!msc->DMAMapped && !msc->Read(msc, msc->Offset, buf, n)) {
+		msc->MemOK = FALSE;
+	}
+	msc_MemoryReadSend(msc, buf, n);
+}
+
+/*********************************************************************//**
+ * @brief		Send a READ10 packet or DMA chunk and account for it
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @param[in]	buf		Point to data, reachable by the USB DMA in DMA mode
+ * @param[in]	n		Number of bytes, 0 when beyond the medium
+ * @return 		None
+ **********************************************************************/
+static void msc_MemoryReadSend(USBDEV_MSC_Type *msc, uint8_t *buf, uint32_t n)
+{
+#ifdef _USB_DMA
+	if (msc->DMABuf != NULL) {
+		if (n != 0) {
+			msc_DMAQueue(msc->EP_IN, buf, n);
+		}
+	} else {
+		USB_WriteEP(msc->EP_IN, buf, n);
+	}
+#else
+	USB_WriteEP(msc->EP_IN, buf, n);
+#endif
+	msc->Offset += n;
+	msc->Length -= n;
+	msc->CSW.dDataResidue -= n;
+	msc->LBA += n / msc->BlockSize;
+	if (msc->Length == 0) {
+		msc->BulkStage = MSC_BS_DATA_IN_LAST;
+	}
+	if (msc->BulkStage != MSC_BS_DATA_IN) {
+		msc->CSW.bStatus = (msc->MemOK) ? CSW_CMD_PASSED : CSW_CMD_FAILED;
+	}
+#ifdef _USB_DMA
+	if ((msc->DMABuf != NULL) && (n == 0)) {
+		msc_BulkIn(msc);					/* No data queued: CSW now */
+	}
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		Store a packet of a WRITE10 data stage
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_MemoryWrite(USBDEV_MSC_Type *msc)
+{
+	uint32_t size;
+
+	size = msc->BlockSize * msc->BlockCount;
+	if ((msc->Offset + msc->BulkLen) > size) {
+		msc->BulkLen = size - msc->Offset;
+		msc->BulkStage = MSC_BS_CSW;
+		USB_SetStallEP(msc->EP_OUT);
+	}
+	if (!msc->Write(msc, msc->Offset, (uint8_t *)msc->BulkBuf, msc->BulkLen)) {
+		msc->MemOK = FALSE;
+	}
+	msc->Offset += msc->BulkLen;
+	msc->Length -= msc->BulkLen;
+	msc->CSW.dDataResidue -= msc->BulkLen;
+	if ((msc->Length == 0) || (msc->BulkStage == MSC_BS_CSW)) {
+		msc->CSW.bStatus = (msc->MemOK) ? CSW_CMD_PASSED : CSW_CMD_FAILED;
+		msc_SetCSW(msc);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Compare a packet of a VERIFY10 data stage to the medium
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_MemoryVerify(USBDEV_MSC_Type *msc)
+{
+	uint32_t buf[MSC_MAX_PACKET / 4];
+	uint32_t n, size;
+
+	size = msc->BlockSize * msc->BlockCount;
+	if ((msc->Offset + msc->BulkLen) > size) {
+		msc->BulkLen = size - msc->Offset;
+		msc->BulkStage = MSC_BS_CSW;
+		USB_SetStallEP(msc->EP_OUT);
+	}
+	if (!msc->Read(msc, msc->Offset, (uint8_t *)buf, msc->BulkLen)) {
+		msc->MemOK = FALSE;
+	}
+	for (n = 0; n < msc->BulkLen; n++) {
+		if (((uint8_t *)buf)[n] != ((uint8_t *)msc->BulkBuf)[n]) {
+			msc->MemOK = FALSE;
+			break;
+		}
+	}
+	msc->Offset += msc->BulkLen;
+	msc->Length -= msc->BulkLen;
+	msc->CSW.dDataResidue -= msc->BulkLen;
+	if ((msc->Length == 0) || (msc->BulkStage == MSC_BS_CSW)) {
+		msc->CSW.bStatus = (msc->MemOK) ? CSW_CMD_PASSED : CSW_CMD_FAILED;
+		msc_SetCSW(msc);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		SCSI read/write setup: offset and length of the transfer
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t msc_RWSetup(USBDEV_MSC_Type *msc)
+{
+	uint32_t n;
+
+	/* Logical Block Address of First Block */
+	n = (msc->CBW.CB[2] << 24) |
+		(msc->CBW.CB[3] << 16) |
+		(msc->CBW.CB[4] <<  8) |
+		(msc->CBW.CB[5] <<  0);
+
+	msc->LBA = n;
+	msc->Offset = n * msc->BlockSize;
+
+	/* Number of Blocks to transfer */
+	n = (msc->CBW.CB[7] <<  8) |
+		(msc->CBW.CB[8] <<  0);
+
+	msc->Length = n * msc->BlockSize;
+	msc->MemOK = TRUE;
+
+	if (msc->CBW.dDataLength != msc->Length) {
+		USB_SetStallEP(msc->EP_IN);
+		USB_SetStallEP(msc->EP_OUT);
+		msc->CSW.bStatus = CSW_PHASE_ERROR;
+		msc_SetCSW(msc);
+		return (FALSE);
+	}
+
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Check data IN format
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t msc_DataInFormat(USBDEV_MSC_Type *msc)
+{
+	if (msc->CBW.dDataLength == 0) {
+		msc->CSW.bStatus = CSW_PHASE_ERROR;
+		msc_SetCSW(msc);
+		return (FALSE);
+	}
+	if ((msc->CBW.bmFlags & 0x80) == 0) {
+		USB_SetStallEP(msc->EP_OUT);
+		msc->CSW.bStatus = CSW_PHASE_ERROR;
+		msc_SetCSW(msc);
+		return (FALSE);
+	}
+	return (TRUE);
+}
+
+/*********************************************************************//**
+ * @brief		Send the data IN prepared in BulkBuf
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_DataInTransfer(USBDEV_MSC_Type *msc)
+{
+	if (msc->BulkLen > msc->CBW.dDataLength) {
+		msc->BulkLen = msc->CBW.dDataLength;
+	}
+	msc_WriteIn(msc, (uint8_t *)msc->BulkBuf, msc->BulkLen);
+	msc->BulkStage = MSC_BS_DATA_IN_LAST;
+	msc->CSW.dDataResidue -= msc->BulkLen;
+	msc->CSW.bStatus = CSW_CMD_PASSED;
+}
+
+/*********************************************************************//**
+ * @brief		Decode a Command Block Wrapper and run its SCSI command
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_GetCBW(USBDEV_MSC_Type *msc)
+{
+	uint8_t *buf = (uint8_t *)msc->BulkBuf;
+	const uint8_t *id;
+	uint32_t n, last;
+
+	for (n = 0; n < msc->BulkLen; n++) {
+		*((uint8_t *)&msc->CBW + n) = buf[n];
+	}
+	if ((msc->BulkLen != sizeof(MSC_CBW)) || (msc->CBW.dSignature != MSC_CBW_Signature)) {
+		/* Invalid CBW */
+		USB_SetStallEP(msc->EP_IN);
+		USB_SetStallEP(msc->EP_OUT);
+		msc->BulkStage = MSC_BS_ERROR;
+		return;
+	}
+
+	/* Valid CBW */
+	msc->CSW.dTag = msc->CBW.dTag;
+	msc->CSW.dDataResidue = msc->CBW.dDataLength;
+	if ((msc->CBW.bLUN != 0) || (msc->CBW.bCBLength < 1) || (msc->CBW.bCBLength > 16)) {
+		goto fail;
+	}
+
+	switch (msc->CBW.CB[0]) {
+	case SCSI_TEST_UNIT_READY:
+		if (msc->CBW.dDataLength != 0) {
+			if ((msc->CBW.bmFlags & 0x80) != 0) {
+				USB_SetStallEP(msc->EP_IN);
+			} else {
+				USB_SetStallEP(msc->EP_OUT);
+			}
+		}
+		msc->CSW.bStatus = CSW_CMD_PASSED;
+		msc_SetCSW(msc);
+		break;
+
+	case SCSI_REQUEST_SENSE:
+		if (!msc_DataInFormat(msc)) {
+			return;
+		}
+		for (n = 0; n < 18; n++) {
+			buf[n] = 0;
+		}
+		buf[ 0] = 0x70;						/* Response Code */
+		buf[ 2] = 0x02;						/* Sense Key */
+		buf[ 7] = 0x0A;						/* Additional Length */
+		buf[12] = 0x30;						/* ASC */
+		buf[13] = 0x01;						/* ASCQ */
+		msc->BulkLen = 18;
+		msc_DataInTransfer(msc);
+		break;
+
+	case SCSI_INQUIRY:
+		if (!msc_DataInFormat(msc)) {
+			return;
+		}
+		buf[ 0] = 0x00;						/* Direct Access Device */
+		buf[ 1] = 0x80;						/* RMB = 1: Removable Medium */
+		buf[ 2] = 0x00;						/* Version: No conformance claim to standard */
+		buf[ 3] = 0x01;
+		buf[ 4] = 36-4;						/* Additional Length */
+		buf[ 5] = 0x80;						/* SCCS = 1: Storage Controller Component */
+		buf[ 6] = 0x00;
+		buf[ 7] = 0x00;
+		/* Vendor, Product Identification and Revision Level */
+		id = (msc->InquiryID != NULL) ? msc->InquiryID : msc_DefaultID;
+		for (n = 0; n < MSC_INQUIRY_ID_SIZE; n++) {
+			buf[8 + n] = id[n];
+		}
+		msc->BulkLen = 36;
+		msc_DataInTransfer(msc);
+		break;
+
+	case SCSI_MODE_SENSE6:
+		if (!msc_DataInFormat(msc)) {
+			return;
+		}
+		buf[ 0] = 0x03;
+		buf[ 1] = 0x00;
+		buf[ 2] = 0x00;
+		buf[ 3] = 0x00;
+		msc->BulkLen = 4;
+		msc_DataInTransfer(msc);
+		break;
+
+	case SCSI_MODE_SENSE10:
+		if (!msc_DataInFormat(msc)) {
+			return;
+		}
+		for (n = 0; n < 8; n++) {
+			buf[n] = 0;
+		}
+		buf[ 1] = 0x06;
+		msc->BulkLen = 8;
+		msc_DataInTransfer(msc);
+		break;
+
+	case SCSI_READ_FORMAT_CAPACITIES:
+		if (!msc_DataInFormat(msc)) {
+			return;
+		}
+		buf[ 0] = 0x00;
+		buf[ 1] = 0x00;
+		buf[ 2] = 0x00;
+		buf[ 3] = 0x08;						/* Capacity List Length */
+		/* Block Count */
+		buf[ 4] = (msc->BlockCount >> 24) & 0xFF;
+		buf[ 5] = (msc->BlockCount >> 16) & 0xFF;
+		buf[ 6] = (msc->BlockCount >>  8) & 0xFF;
+		buf[ 7] = (msc->BlockCount >>  0) & 0xFF;
+		/* Block Length */
+		buf[ 8] = 0x02;						/* Descriptor Code: Formatted Media */
+		buf[ 9] = (msc->BlockSize >> 16) & 0xFF;
+		buf[10] = (msc->BlockSize >>  8) & 0xFF;
+		buf[11] = (msc->BlockSize >>  0) & 0xFF;
+		msc->BulkLen = 12;
+		msc_DataInTransfer(msc);
+		break;
+
+	case SCSI_READ_CAPACITY:
+		if (!msc_DataInFormat(msc)) {
+			return;
+		}
+		/* Last Logical Block */
+		last = msc->BlockCount - 1;
+		buf[ 0] = (last >> 24) & 0xFF;
+		buf[ 1] = (last >> 16) & 0xFF;
+		buf[ 2] = (last >>  8) & 0xFF;
+		buf[ 3] = (last >>  0) & 0xFF;
+		/* Block Length */
+		buf[ 4] = (msc->BlockSize >> 24) & 0xFF;
+		buf[ 5] = (msc->BlockSize >> 16) & 0xFF;
+		buf[ 6] = (msc->BlockSize >>  8) & 0xFF;
+		buf[ 7] = (msc->BlockSize >>  0) & 0xFF;
+		msc->BulkLen = 8;
+		msc_DataInTransfer(msc);
+		break;
+
+	case SCSI_READ10:
+		if (!msc_RWSetup(msc)) {
+			return;
+		}
+		if ((msc->CBW.bmFlags & 0x80) != 0) {
+			msc->BulkStage = MSC_BS_DATA_IN;
+			msc_MemoryRead(msc);
+		} else {
+			USB_SetStallEP(msc->EP_OUT);
+			msc->CSW.bStatus = CSW_PHASE_ERROR;
+			msc_SetCSW(msc);
+		}
+		break;
+
+	case SCSI_SYNCHRONIZE_CACHE10:
+		if (msc->CBW.dDataLength != 0) {
+			goto fail;
+		}
+		msc->CSW.bStatus = CSW_CMD_PASSED;
+#ifdef _USB_DMA
+		if ((msc->Dev != NULL) && (msc->Dev->Sync != NULL)) {
+			/* CSW sent by msc_DevDone() */
+			msc->MemOK = TRUE;
+			msc->DevStage = MSC_BS_CSW;
+			msc->BulkStage = MSC_BS_DEV;
+			if (msc->Dev->Sync(msc->Dev) != SUCCESS) {
+				msc_DevDone(msc, ERROR);
+			}
+			break;
+		}
+#endif
+		msc_SetCSW(msc);
+		break;
+
+	case SCSI_WRITE10:
+	case SCSI_VERIFY10:
+		if (!msc_RWSetup(msc)) {
+			return;
+		}
+		if ((msc->CBW.bmFlags & 0x80) == 0) {
+			msc->BulkStage = MSC_BS_DATA_OUT;
+#ifdef _USB_DMA
+			if (msc->DMABuf != NULL) {
+				msc_DMAOutStart(msc);
+			}
+#endif
+		} else {
+			USB_SetStallEP(msc->EP_IN);
+			msc->CSW.bStatus = CSW_PHASE_ERROR;
+			msc_SetCSW(msc);
+		}
+		break;
+
+	default:
+		goto fail;
+	}
+	return;
+
+fail:
+	msc->CSW.bStatus = CSW_CMD_FAILED;
+	msc_SetCSW(msc);
+}
+
+/*********************************************************************//**
+ * @brief		Bulk IN endpoint is empty
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_BulkIn(USBDEV_MSC_Type *msc)
+{
+	switch (msc->BulkStage) {
+	case MSC_BS_DATA_IN:
+		if (msc->CBW.CB[0] == SCSI_READ10) {
+			msc_MemoryRead(msc);
+		}
+		break;
+	case MSC_BS_DATA_IN_LAST:
+		msc_SetCSW(msc);
+		break;
+	case MSC_BS_DATA_IN_LAST_STALL:
+		USB_SetStallEP(msc->EP_IN);
+		msc_SetCSW(msc);
+		break;
+	case MSC_BS_CSW:
+		msc->BulkStage = MSC_BS_CBW;
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Bulk OUT endpoint received a packet
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure
+ * @return 		None
+ **********************************************************************/
+static void msc_BulkOut(USBDEV_MSC_Type *msc)
+{
+	msc->BulkLen = (uint8_t)USB_ReadEP(msc->EP_OUT, (uint8_t *)msc->BulkBuf);
+	switch (msc->BulkStage) {
+	case MSC_BS_CBW:
+		msc_GetCBW(msc);
+		break;
+	case MSC_BS_DATA_OUT:
+		if (msc->CBW.CB[0] == SCSI_WRITE10) {
+			msc_MemoryWrite(msc);
+		} else {
+			msc_MemoryVerify(msc);
+		}
+		break;
+	default:
+		USB_SetStallEP(msc->EP_OUT);
+		msc->CSW.bStatus = CSW_PHASE_ERROR;
+		msc_SetCSW(msc);
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Setup stage of MSC class requests: Bulk-Only Mass
+ * 				Storage Reset and Get Max LUN
+ * @param[in]	arg		Point to USBDEV_MSC_Type structure
+ * @param[in]	setup	Point to setup packet
+ * @param[in]	data	Point to data stage, pData is EP0Buf
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t msc_Request(void *arg, USB_SETUP_PACKET *setup, USB_EP_DATA *data)
+{
+	USBDEV_MSC_Type *msc = (USBDEV_MSC_Type *)arg;
+
+	if ((setup->bmRequestType.BM.Type != REQUEST_CLASS) || (setup->wValue.W != 0)) {
+		return (FALSE);
+	}
+	switch (setup->bRequest) {
+	case MSC_REQUEST_RESET:
+		if (setup->wLength != 0) {
+			return (FALSE);
+		}
+		msc->BulkStage = MSC_BS_CBW;
+#ifdef _USB_DMA
+		if (msc->DMABuf != NULL) {
+			USB_DMA_Disable(msc->EP_IN);
+			msc_DMAQueue(msc->EP_OUT, msc->DMABuf + msc->DMABufSize - MSC_DMA_CBW_SIZE,
+					sizeof(MSC_CBW));
+		}
+#endif
+		return (TRUE);
+	case MSC_REQUEST_GET_MAX_LUN:
+		if (setup->wLength != 1) {
+			return (FALSE);
+		}
+		data->pData[0] = 0;					/* No LUN associated with this device */
+		data->Count = 1;
+		return (TRUE);
+	}
+	return (FALSE);
+}
+
+/*********************************************************************//**
+ * @brief		Device events: bulk-only transport waits for a CBW after
+ * 				reset and configuration; the CSW is sent again when the
+ * 				host clears the halt of the bulk IN endpoint
+ * @param[in]	arg		Point to USBDEV_MSC_Type structure
+ * @param[in]	event	USBDEV_EVT_xxx
+ * @param[in]	param	Endpoint address for USBDEV_EVT_CLEAR_HALT
+ * @return 		None
+ **********************************************************************/
+static void msc_Event(void *arg, uint32_t event, uint32_t param)
+{
+	USBDEV_MSC_Type *msc = (USBDEV_MSC_Type *)arg;
+
+	switch (event) {
+	case USBDEV_EVT_RESET:
+	case USBDEV_EVT_CONFIGURE:
+		msc->BulkStage = MSC_BS_CBW;
+		msc->CSW.dSignature = 0;
+#ifdef _USB_DMA
+		/* Receive the first CBW */
+		if ((event == USBDEV_EVT_CONFIGURE) && (param != 0) && (msc->DMABuf != NULL)) {
+			msc_DMAQueue(msc->EP_OUT, msc->DMABuf + msc->DMABufSize - MSC_DMA_CBW_SIZE,
+					sizeof(MSC_CBW));
+		}
+#endif
+		break;
+	case USBDEV_EVT_CLEAR_HALT:
+		/* Compliance Test: rewrite CSW after unstall */
+		if ((param == msc->EP_IN) && (msc->CSW.dSignature == MSC_CSW_Signature)) {
+			msc_WriteIn(msc, (uint8_t *)&msc->CSW, sizeof(MSC_CSW));
+		}
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Bulk endpoints handler
+ * @param[in]	arg		Point to USBDEV_MSC_Type structure
+ * @param[in]	event	USB_EVT_OUT or USB_EVT_IN, in DMA mode the
+ * 				USB_EVT_xxx_DMA_EOT and USB_EVT_xxx_DMA_ERR events
+ * @return 		None
+ **********************************************************************/
+static void msc_EP(void *arg, uint32_t event)
+{
+	USBDEV_MSC_Type *msc = (USBDEV_MSC_Type *)arg;
+
+	switch (event) {
+	case USB_EVT_OUT:
+		msc_BulkOut(msc);
+		break;
+	case USB_EVT_IN:
+		msc_BulkIn(msc);
+		break;
+#ifdef _USB_DMA
+	case USB_EVT_OUT_DMA_EOT:
+		msc_DMAOut(msc);
+		break;
+	case USB_EVT_IN_DMA_EOT:
+		/* The descriptor is replaced as soon as the next one is queued */
+		if (USB_DMA_Status(msc->EP_IN) == USB_DMA_DONE) {
+			USB_DMA_Disable(msc->EP_IN);
+			msc_BulkIn(msc);
+		}
+		break;
+	case USB_EVT_OUT_DMA_ERR:
+	case USB_EVT_IN_DMA_ERR:
+		msc_DMAError(msc);
+		break;
+#endif
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+/** @addtogroup USBDEV_MSC_Public_Functions
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize MSC class driver: register it with its
+ * 				interface and its bulk endpoints
+ * @param[in]	msc		Point to USBDEV_MSC_Type structure, configuration
+ * 				fields must be filled
+ * @return 		None
+ **********************************************************************/
+void USB_MscInit(USBDEV_MSC_Type *msc)
+{
+	CHECK_PARAM(PARAM_USBDEV_EP(msc->EP_IN) && PARAM_USBDEV_EP(msc->EP_OUT));
+#ifdef _USB_DMA
+	CHECK_PARAM((msc->Dev == NULL) || (msc->DMABuf != NULL));
+	if (msc->Dev != NULL) {
+		msc->BlockSize = msc->Dev->BlockSize;
+		msc->BlockCount = msc->Dev->BlockCount;
+		msc->Dev->Done = msc_DevDone;
+		msc->Dev->arg = msc;
+	}
+	CHECK_PARAM(((msc->Read != NULL) && (msc->Write != NULL)) || (msc->Dev != NULL));
+#else
+	CHECK_PARAM((msc->Read != NULL) && (msc->Write != NULL));
+#endif
+	CHECK_PARAM((msc->DMABuf == NULL) || (msc->DMABufSize >= (msc->BlockSize + MSC_DMA_CBW_SIZE)));
+
+	msc->BulkStage = MSC_BS_CBW;
+	msc->DevStage = MSC_BS_CBW;
+	msc->CSW.dSignature = 0;
+	msc->DMAMapped = FALSE;
+	msc->DMALen = 0;
+	msc->LBA = 0;
+
+	msc->cls.FirstIF = msc->IF;
+	msc->cls.NumIF = 1;
+	msc->cls.EPMask = USBDEV_EP_BIT(msc->EP_IN) | USBDEV_EP_BIT(msc->EP_OUT);
+	msc->cls.EventMask = USBDEV_EVT_RESET | USBDEV_EVT_CONFIGURE;
+	msc->cls.Request = msc_Request;
+	msc->cls.DataOut = NULL;
+	msc->cls.Event = msc_Event;
+	msc->cls.arg = msc;
+	USB_RegisterClass(&msc->cls);
+
+	USB_RegisterEP(msc->EP_IN, msc_EP, msc);
+	USB_RegisterEP(msc->EP_OUT, msc_EP, msc);
+}
+
+/**
+ * @}
+ */
+
+#endif /* _USBDEV_MSC */
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
@@ -0,0 +1,285 @@
+/**********************************************************************
+* $Id$		adc_acquisition.c			2011-03-09
+*//**
+* @file		adc_acquisition.c
+* @brief	This example describes how to use the ADC acquisition engine:
+* 			burst mode (or timer triggered) conversions of several
+* 			channels moved by GPDMA into a circular buffer, then split
+* 			per channel into q15 samples
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_adc.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_timer.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+#include "debug_frmwrk.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup ADC_Acquisition	Acquisition
+ * @ingroup ADC_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINITIONS *************************/
+/** Un-comment to convert channel 2 only, one conversion per MAT0.1 edge,
+ * instead of burst mode on channels 0 to 3 */
+//#define TIMER_TRIGGER
+
+#ifdef TIMER_TRIGGER
+#define ACQ_CHANNELS	(1 << 2)
+/** Conversion rate, one rising edge of MAT0.1 per conversion */
+#define ACQ_RATE		50000
+#else
+#define ACQ_CHANNELS	0x0F
+/** Aggregate conversion rate, shared by all channels */
+#define ACQ_RATE		200000
+#endif
+
+/** GPDMA channel */
+#define ACQ_DMA_CH		0
+/** Conversions per block: 5ms at 200KHz */
+#define BLOCK_SIZE		1000
+/** Blocks in circular buffer */
+#define NUM_BLOCKS		4
+
+/************************** PRIVATE VARIABLES *************************/
+uint8_t menu[]=
+	"********************************************************************************\n\r"
+	"Hello NXP Semiconductors \n\r"
+	" ADC acquisition engine demo \n\r"
+	"\t - MCU: LPC17xx \n\r"
+	"\t - Core: ARM CORTEX-M3 \n\r"
+	"\t - Communicate via: UART0 - 115200bps \n\r"
+	" ADC conversions moved by GPDMA into a circular buffer, split per channel\n\r"
+	" Mean value of each channel is displayed every 100 blocks\n\r"
+	"********************************************************************************\n\r";
+
+/** Acquisition engine */
+ADC_ACQ_Type acq;
+uint32_t acqbuf[BLOCK_SIZE * NUM_BLOCKS];
+GPDMA_LLI_Type acqlli[NUM_BLOCKS];
+
+/** Per channel q15 samples of one block */
+int16_t samples[4][BLOCK_SIZE];
+
+/************************** PRIVATE FUNCTION *************************/
+void DMA_IRQHandler (void);
+
+void print_menu(void);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		GPDMA interrupt handler sub-routine
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void DMA_IRQHandler (void)
+{
+	ADC_AcqDMAHandler(&acq);
+}
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+/*********************************************************************//**
+ * @brief		Print menu
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void print_menu(void)
+{
+	_DBG(menu);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main ADC program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	PINSEL_CFG_Type PinCfg;
+#ifdef TIMER_TRIGGER
+	TIM_TIMERCFG_Type TIM_ConfigStruct;
+	TIM_MATCHCFG_Type TIM_MatchConfigStruct;
+#endif
+	int16_t *dst[8];
+	uint32_t num[8];
+	int32_t sum[4];
+	uint32_t cnt[4];
+	uint32_t i, ch, status, blocks;
+
+	/* Select P0.23 to P0.26 as AD0.0 to AD0.3 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Portnum = 0;
+	for (i = 23; i <= 26; i++) {
+		PinCfg.Pinnum = i;
+		PINSEL_ConfigPin(&PinCfg);
+	}
+
+	/* Initialize debug via UART0
+	 * - 115200bps
+	 * - 8 data bit
+	 * - No parity
+	 * - 1 stop bit
+	 * - No flow control
+	 */
+	debug_frmwrk_init();
+
+	// print welcome screen
+	print_menu();
+
+	/* ADC clock = 200KHz * 65 = 13MHz, the maximum */
+	ADC_Init(LPC_ADC, 200000);
+
+	/* GPDMA block section -------------------------------------------- */
+	/* Disable GPDMA interrupt */
+	NVIC_DisableIRQ(DMA_IRQn);
+	/* preemption = 1, sub-priority = 1 */
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+
+	/* Initialize GPDMA controller */
+	GPDMA_Init();
+
+	acq.ChannelMask = ACQ_CHANNELS;
+	acq.DMAChannel = ACQ_DMA_CH;
+#ifdef TIMER_TRIGGER
+	acq.StartMode = ADC_START_ON_MAT01;
+#else
+	acq.StartMode = ADC_START_CONTINUOUS;
+#endif
+	acq.EdgeOption = ADC_START_ON_RISING;
+	acq.BlockSize = BLOCK_SIZE;
+	acq.NumBlocks = NUM_BLOCKS;
+	acq.buf = acqbuf;
+	acq.lli = acqlli;
+	if (ADC_AcqInit(LPC_ADC, &acq) != SUCCESS) {
+		_DBG_("GPDMA channel is busy");
+		while (1);
+	}
+
+	/* Enable GPDMA interrupt */
+	NVIC_EnableIRQ(DMA_IRQn);
+
+#ifdef TIMER_TRIGGER
+	/* TIMER0 at 1us, MAT0.1 toggles every half conversion period */
+	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_USVAL;
+	TIM_ConfigStruct.PrescaleValue	= 1;
+	TIM_Init(LPC_TIM0, TIM_TIMER_MODE, &TIM_ConfigStruct);
+	TIM_MatchConfigStruct.MatchChannel = 1;
+	TIM_MatchConfigStruct.IntOnMatch = FALSE;
+	TIM_MatchConfigStruct.ResetOnMatch = TRUE;
+	TIM_MatchConfigStruct.StopOnMatch = FALSE;
+	TIM_MatchConfigStruct.ExtMatchOutputType = TIM_EXTMATCH_TOGGLE;
+	TIM_MatchConfigStruct.MatchValue = (1000000 / ACQ_RATE / 2) - 1;
+	TIM_ConfigMatch(LPC_TIM0, &TIM_MatchConfigStruct);
+	ADC_AcqStart(LPC_ADC, &acq);
+	TIM_Cmd(LPC_TIM0, ENABLE);
+#else
+	ADC_AcqStart(LPC_ADC, &acq);
+#endif
+
+	for (ch = 0; ch < 8; ch++) {
+		dst[ch] = (ch < 4) ? samples[ch] : NULL;
+	}
+	for (ch = 0; ch < 4; ch++) {
+		sum[ch] = 0;
+		cnt[ch] = 0;
+	}
+	blocks = 0;
+
+	while (1) {
+		status = ADC_AcqGetStatus(&acq);
+		if (status & ADC_ACQ_ERROR) {
+			_DBG_("GPDMA error, acquisition stopped");
+			while (1);
+		}
+		if (status & ADC_ACQ_OVERRUN) {
+			_DBG_("Overrun: blocks lost");
+		}
+		if (status & ADC_ACQ_HW_OVERRUN) {
+			_DBG_("Overrun: conversions lost in ADC");
+		}
+		if (!(status & ADC_ACQ_DONE)) {
+			continue;
+		}
+		if (ADC_AcqRead(&acq, dst, BLOCK_SIZE, num) == 0) {
+			continue;
+		}
+		for (ch = 0; ch < 4; ch++) {
+			for (i = 0; i < num[ch]; i++) {
+				sum[ch] += samples[ch][i];
+			}
+			cnt[ch] += num[ch];
+		}
+		if (++blocks < 100) {
+			continue;
+		}
+		// Mean value of each channel, back to 12-bit
+		for (ch = 0; ch < 4; ch++) {
+			if (cnt[ch] == 0) {
+				continue;
+			}
+			_DBG("AD0.");
+			_DBD(ch);
+			_DBG(": ");
+			_DBD32(((sum[ch] / (int32_t)cnt[ch]) + 0x8000) >> 4);
+			_DBG(" (");
+			_DBD32(cnt[ch]);
+			_DBG(" samples) ");
+			sum[ch] = 0;
+			cnt[ch] = 0;
+		}
+		_DBG_("");
+		blocks = 0;
+	}
+	ADC_DeInit(LPC_ADC);
+	return 1;
+}
+
+/* Support required entry point for other toolchain */
+int main (void)
+{
+	return c_entry();
+}
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
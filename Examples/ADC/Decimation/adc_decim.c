@@ -0,0 +1,121 @@
+/**********************************************************************
+* $Id$		adc_decim.c			2011-03-09
+*//**
+* @file		adc_decim.c
+* @brief	Decimating oversampling front end: ADC acquisition engine
+* 			blocks filtered and decimated per channel by the CMSIS DSP
+* 			Q15 FIR decimator
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "adc_decim.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @addtogroup ADC_Decimation
+ * @{
+ */
+
+/*********************************************************************//**
+ * @brief		Initialize decimating front end: one FIR decimator per
+ * 				channel in ChannelMask. The acquisition engine must be
+ * 				initialized before (BlockSize is used to size the filter
+ * 				blocks).
+ * @param[in]	decim	point to ADC_DECIM_Type structure, configuration
+ * 				fields and channel buffers must be filled
+ * @return 		ERROR if decimation factor does not fit, otherwise SUCCESS
+ **********************************************************************/
+Status ADC_DecimInit(ADC_DECIM_Type *decim)
+{
+	ADC_DECIM_CH_Type *c;
+	uint32_t ch, blocksize;
+
+	if ((decim->M == 0) || (decim->M > decim->acq->BlockSize)) {
+		return ERROR;
+	}
+	/* Largest filter block: a multiple of M */
+	blocksize = ADC_DECIM_IN_SIZE(decim->acq->BlockSize, decim->M);
+	blocksize -= blocksize % decim->M;
+
+	for (ch = 0; ch < 8; ch++) {
+		if (!(decim->ChannelMask & (1 << ch))) {
+			continue;
+		}
+		c = &decim->ch[ch];
+		c->fill = 0;
+		if (arm_fir_decimate_init_q15(&c->fir, decim->NumTaps, decim->M,
+				decim->Coeffs, c->state, blocksize) != ARM_MATH_SUCCESS) {
+			return ERROR;
+		}
+	}
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Process one acquisition block: split it per channel
+ * 				straight into the filter input buffers, then filter and
+ * 				decimate all whole groups of M samples of each channel in
+ * 				one call. Remaining samples (less than M) are kept for
+ * 				the next block. Output() is called per channel.
+ * @param[in]	decim	point to ADC_DECIM_Type structure
+ * @return 		Number of decimated samples (all channels), 0 if no block
+ * 				was ready
+ **********************************************************************/
+uint32_t ADC_DecimProcess(ADC_DECIM_Type *decim)
+{
+	ADC_DECIM_CH_Type *c;
+	int16_t *dst[8];
+	uint32_t num[8];
+	uint32_t ch, i, n, rem, total;
+
+	for (ch = 0; ch < 8; ch++) {
+		c = &decim->ch[ch];
+		dst[ch] = (decim->ChannelMask & (1 << ch)) ? (c->in + c->fill) : NULL;
+	}
+	if (ADC_AcqRead(decim->acq, dst, decim->acq->BlockSize, num) == 0) {
+		return 0;
+	}
+
+	total = 0;
+	for (ch = 0; ch < 8; ch++) {
+		if (dst[ch] == NULL) {
+			continue;
+		}
+		c = &decim->ch[ch];
+		c->fill += num[ch];
+		n = c->fill - (c->fill % decim->M);
+		if (n == 0) {
+			continue;
+		}
+		arm_fir_decimate_fast_q15(&c->fir, c->in, c->out, n);
+		rem = c->fill - n;
+		for (i = 0; i < rem; i++) {
+			c->in[i] = c->in[n + i];
+		}
+		c->fill = rem;
+		if (decim->Output != NULL) {
+			decim->Output(ch, c->out, n / decim->M);
+		}
+		total += n / decim->M;
+	}
+	return total;
+}
+
+/**
+ * @}
+ */
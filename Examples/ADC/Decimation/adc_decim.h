@@ -0,0 +1,74 @@
+/**********************************************************************
+* $Id$		adc_decim.h			2011-03-09
+*//**
+* @file		adc_decim.h
+* @brief	Decimating oversampling front end: ADC acquisition engine
+* 			blocks filtered and decimated per channel by the CMSIS DSP
+* 			Q15 FIR decimator
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef ADC_DECIM_H_
+#define ADC_DECIM_H_
+
+#include "lpc17xx_adc.h"
+#include "arm_math.h"
+
+/** Size of per channel input buffer (samples) for an acquisition block
+ * size b and a decimation factor m */
+#define ADC_DECIM_IN_SIZE(b, m)		((b) + (m) - 1)
+/** Size of per channel state buffer (samples) */
+#define ADC_DECIM_STATE_SIZE(b, m, taps)	((taps) + ADC_DECIM_IN_SIZE(b, m) - 1)
+/** Size of per channel output buffer (samples) */
+#define ADC_DECIM_OUT_SIZE(b, m)	(ADC_DECIM_IN_SIZE(b, m) / (m))
+
+/**
+ * @brief Per channel buffers of decimating front end, sizes given by
+ * ADC_DECIM_xxx_SIZE() macros
+ */
+typedef struct {
+	q15_t* in;				/**< Input samples not yet filtered */
+	q15_t* state;			/**< FIR decimator state */
+	q15_t* out;				/**< Decimated samples */
+	uint32_t fill;			/**< Number of samples in input buffer */
+	arm_fir_decimate_instance_q15 fir;	/**< FIR decimator instance */
+} ADC_DECIM_CH_Type;
+
+/**
+ * @brief Decimating front end. The application fills the configuration
+ * fields and the buffers of each channel in ChannelMask.
+ */
+typedef struct {
+	ADC_ACQ_Type* acq;		/**< Configuration: ADC acquisition engine */
+	uint8_t ChannelMask;	/**< Configuration: channels to filter, subset of
+								 acq->ChannelMask */
+	uint8_t M;				/**< Configuration: decimation factor */
+	uint16_t NumTaps;		/**< Configuration: number of FIR taps */
+	q15_t* Coeffs;			/**< Configuration: FIR coefficients, time reversed.
+								 Sum of absolute values must be less than 2
+								 (fast decimator accumulator guard bit) */
+	void (*Output)(uint32_t ch, q15_t* out, uint32_t n);	/**< Configuration:
+								 called with the decimated samples of channel ch */
+	ADC_DECIM_CH_Type ch[8];	/**< Per channel buffers */
+} ADC_DECIM_Type;
+
+Status ADC_DecimInit(ADC_DECIM_Type *decim);
+uint32_t ADC_DecimProcess(ADC_DECIM_Type *decim);
+
+#endif /* ADC_DECIM_H_ */
@@ -0,0 +1,277 @@
+/**********************************************************************
+* $Id$		adc_decimation.c			2011-03-09
+*//**
+* @file		adc_decimation.c
+* @brief	This example describes how to oversample ADC channels and
+* 			get extra effective bits: acquisition engine blocks are
+* 			filtered and decimated per channel by the CMSIS DSP Q15 FIR
+* 			decimator
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_adc.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+#include "debug_frmwrk.h"
+#include "adc_decim.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup ADC_Decimation	Decimation
+ * @ingroup ADC_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINITIONS *************************/
+/** Channels AD0.0 to AD0.3, burst mode at 200KHz: 50KHz per channel */
+#define ACQ_CHANNELS	0x0F
+/** GPDMA channel */
+#define ACQ_DMA_CH		0
+/** Conversions per block: 5ms at 200KHz */
+#define BLOCK_SIZE		1000
+/** Blocks in circular buffer */
+#define NUM_BLOCKS		4
+
+/** Decimation factor: 50KHz to 6.25KHz per channel */
+#define DECIM_M			8
+/** FIR taps */
+#define NUM_TAPS		32
+
+#define IN_SIZE			ADC_DECIM_IN_SIZE(BLOCK_SIZE, DECIM_M)
+#define STATE_SIZE		ADC_DECIM_STATE_SIZE(BLOCK_SIZE, DECIM_M, NUM_TAPS)
+#define OUT_SIZE		ADC_DECIM_OUT_SIZE(BLOCK_SIZE, DECIM_M)
+
+/************************** PRIVATE VARIABLES *************************/
+uint8_t menu[]=
+	"********************************************************************************\n\r"
+	"Hello NXP Semiconductors \n\r"
+	" ADC oversampling and decimation demo \n\r"
+	"\t - MCU: LPC17xx \n\r"
+	"\t - Core: ARM CORTEX-M3 \n\r"
+	"\t - Communicate via: UART0 - 115200bps \n\r"
+	" 4 channels sampled at 50KHz, low-pass filtered and decimated by 8\n\r"
+	" Last filtered value of each channel (16-bit) is displayed every 100 blocks\n\r"
+	"********************************************************************************\n\r";
+
+/** Low-pass FIR, Hamming window, cut-off 2.5KHz at 50KHz (0.05 fs), unity gain */
+q15_t coeffs[NUM_TAPS] = {
+	   -54,    -64,    -82,    -97,    -93,    -47,     66,    266,
+	   562,    951,   1412,   1909,   2396,   2821,   3136,   3302,
+	  3302,   3136,   2821,   2396,   1909,   1412,    951,    562,
+	   266,     66,    -47,    -93,    -97,    -82,    -64,    -54
+};
+
+/** Acquisition engine */
+ADC_ACQ_Type acq;
+uint32_t acqbuf[BLOCK_SIZE * NUM_BLOCKS];
+GPDMA_LLI_Type acqlli[NUM_BLOCKS];
+
+/** Decimating front end */
+ADC_DECIM_Type decim;
+q15_t decim_in[4][IN_SIZE];
+q15_t decim_state[4][STATE_SIZE];
+q15_t decim_out[4][OUT_SIZE];
+
+/** Last decimated value and number of decimated samples per channel */
+q15_t last[4];
+uint32_t count[4];
+
+/************************** PRIVATE FUNCTION *************************/
+void DMA_IRQHandler (void);
+
+void print_menu(void);
+void decim_output(uint32_t ch, q15_t *out, uint32_t n);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		GPDMA interrupt handler sub-routine
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void DMA_IRQHandler (void)
+{
+	ADC_AcqDMAHandler(&acq);
+}
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+/*********************************************************************//**
+ * @brief		Print menu
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void print_menu(void)
+{
+	_DBG(menu);
+}
+
+/*********************************************************************//**
+ * @brief		Decimated samples of one channel
+ * @param[in]	ch		channel number
+ * @param[in]	out		decimated samples
+ * @param[in]	n		number of samples
+ * @return 		None
+ **********************************************************************/
+void decim_output(uint32_t ch, q15_t *out, uint32_t n)
+{
+	last[ch] = out[n - 1];
+	count[ch] += n;
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main ADC program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	PINSEL_CFG_Type PinCfg;
+	uint32_t i, ch, status, blocks;
+
+	/* Select P0.23 to P0.26 as AD0.0 to AD0.3 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Portnum = 0;
+	for (i = 23; i <= 26; i++) {
+		PinCfg.Pinnum = i;
+		PINSEL_ConfigPin(&PinCfg);
+	}
+
+	/* Initialize debug via UART0
+	 * - 115200bps
+	 * - 8 data bit
+	 * - No parity
+	 * - 1 stop bit
+	 * - No flow control
+	 */
+	debug_frmwrk_init();
+
+	// print welcome screen
+	print_menu();
+
+	/* ADC clock = 200KHz * 65 = 13MHz, the maximum */
+	ADC_Init(LPC_ADC, 200000);
+
+	/* GPDMA block section -------------------------------------------- */
+	/* Disable GPDMA interrupt */
+	NVIC_DisableIRQ(DMA_IRQn);
+	/* preemption = 1, sub-priority = 1 */
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+
+	/* Initialize GPDMA controller */
+	GPDMA_Init();
+
+	acq.ChannelMask = ACQ_CHANNELS;
+	acq.DMAChannel = ACQ_DMA_CH;
+	acq.StartMode = ADC_START_CONTINUOUS;
+	acq.EdgeOption = ADC_START_ON_RISING;
+	acq.BlockSize = BLOCK_SIZE;
+	acq.NumBlocks = NUM_BLOCKS;
+	acq.buf = acqbuf;
+	acq.lli = acqlli;
+	if (ADC_AcqInit(LPC_ADC, &acq) != SUCCESS) {
+		_DBG_("GPDMA channel is busy");
+		while (1);
+	}
+
+	/* Decimating front end ------------------------------------------- */
+	decim.acq = &acq;
+	decim.ChannelMask = ACQ_CHANNELS;
+	decim.M = DECIM_M;
+	decim.NumTaps = NUM_TAPS;
+	decim.Coeffs = coeffs;
+	decim.Output = decim_output;
+	for (ch = 0; ch < 4; ch++) {
+		decim.ch[ch].in = decim_in[ch];
+		decim.ch[ch].state = decim_state[ch];
+		decim.ch[ch].out = decim_out[ch];
+		count[ch] = 0;
+	}
+	if (ADC_DecimInit(&decim) != SUCCESS) {
+		_DBG_("Decimator configuration error");
+		while (1);
+	}
+
+	/* Enable GPDMA interrupt */
+	NVIC_EnableIRQ(DMA_IRQn);
+	ADC_AcqStart(LPC_ADC, &acq);
+
+	blocks = 0;
+	while (1) {
+		status = ADC_AcqGetStatus(&acq);
+		if (status & ADC_ACQ_ERROR) {
+			_DBG_("GPDMA error, acquisition stopped");
+			while (1);
+		}
+		if (status & ADC_ACQ_OVERRUN) {
+			_DBG_("Overrun: blocks lost");
+		}
+		if (!(status & ADC_ACQ_DONE)) {
+			continue;
+		}
+		ADC_DecimProcess(&decim);
+		if (++blocks < 100) {
+			continue;
+		}
+		// Last filtered value of each channel, unsigned 16-bit
+		for (ch = 0; ch < 4; ch++) {
+			_DBG("AD0.");
+			_DBD(ch);
+			_DBG(": ");
+			_DBD16((uint16_t)(last[ch] + 0x8000));
+			_DBG(" (");
+			_DBD32(count[ch]);
+			_DBG(" samples) ");
+			count[ch] = 0;
+		}
+		_DBG_("");
+		blocks = 0;
+	}
+	ADC_DeInit(LPC_ADC);
+	return 1;
+}
+
+/* Support required entry point for other toolchain */
+int main (void)
+{
+	return c_entry();
+}
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
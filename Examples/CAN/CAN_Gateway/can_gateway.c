@@ -0,0 +1,921 @@
+/**********************************************************************
+* $Id$		can_gateway.c			2011-03-09
+*//**
+* @file		can_gateway.c
+* @brief	This example used to bridge CAN1 and CAN2 to Ethernet and USB:
+* 			received CAN frames are packed straight into EMAC transmit
+* 			buffers as UDP datagrams, or into USB CDC batches while a
+* 			host has the virtual COM port open, and batches of frames
+* 			sent by the host on either link are queued for transmission
+* 			on CAN
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_can.h"
+#include "lpc17xx_emac.h"
+#include "lpc17xx_timer.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+#ifdef _USBDEV
+#include "lpc17xx_usbdev_cdc.h"
+#include "usbdesc.h"
+#endif
+#include "string.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup CAN_Gateway	CAN_Gateway
+ * @ingroup CAN_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINTIONS*************************/
+#define CAN_BITRATE			500000
+
+/** Board MAC and IP address */
+#define GW_MAC				{0x1E, 0x30, 0x6C, 0xA2, 0x45, 0x5E}
+#define GW_IP				{192, 168, 0, 200}
+/** Host MAC and IP address, the host needs a static ARP entry for GW_IP */
+#define HOST_MAC			{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
+#define HOST_IP				{192, 168, 0, 1}
+/** UDP port, used as source and destination in both directions */
+#define GW_UDP_PORT			20100
+
+/** Datagram layout: Ethernet (14), IPv4 (20), UDP (8), gateway header (10),
+ * then records, 16 bytes CAN_RXFRAME_Type each, little endian. Records
+ * start at a word aligned offset, so they are written in place. */
+#define GW_ETH_OFFSET		0
+#define GW_IP_OFFSET		14
+#define GW_UDP_OFFSET		34
+#define GW_HDR_OFFSET		42
+#define GW_REC_OFFSET		52
+/** Gateway header size */
+#define GW_HDR_LEN			(GW_REC_OFFSET - GW_HDR_OFFSET)
+/** Max records per datagram, frame stays within 1514 bytes */
+#define GW_MAX_RECORDS		((1514 - GW_REC_OFFSET) / sizeof(CAN_RXFRAME_Type))
+
+/** Flush thresholds: datagram is sent when full or when its first
+ * record is older than GW_FLUSH_AGE microseconds */
+#define GW_FLUSH_RECORDS	GW_MAX_RECORDS
+#define GW_FLUSH_AGE		1000
+
+/** Gateway header: magic 'C' 'G', version, record count, sequence (16 bits),
+ * frames dropped since previous datagram (16 bits, saturated), reserved */
+#define GW_MAGIC0			'C'
+#define GW_MAGIC1			'G'
+#define GW_VERSION			1
+
+/** Bit 29 of CAN_RXFRAME_Type id (unused by the driver) selects CAN2 */
+#define GW_REC_CAN2			(1UL << 29)
+
+/** Uplink of a batch of records */
+#define GW_UPLINK_ETH		0
+#define GW_UPLINK_USB		1
+
+#ifdef _USBDEV
+/** USB batch: gateway header and records only, one bulk transfer. The
+ * header is at offset 2 of the batch buffer so that records are word
+ * aligned. 10 + 16 * n bytes is never a multiple of the packet size:
+ * the transfer always ends with a short packet */
+#define GW_USB_HDR_OFFSET	2
+/** Largest batch */
+#define GW_USB_BATCH_MAX	(GW_HDR_LEN + GW_MAX_RECORDS * sizeof(CAN_RXFRAME_Type))
+/** Batch buffer, words: a received packet still fits after GW_USB_BATCH_MAX */
+#define GW_USB_BUF_WORDS	((GW_USB_HDR_OFFSET + GW_USB_BATCH_MAX + CDC_MAX_PACKET + 3) / 4)
+#endif
+
+/** Receive ring size per controller (frames), must be a power of 2 */
+#define RX_RING_SIZE		256
+/** Transmit queue size per controller (frames) */
+#define TX_QUEUE_SIZE		64
+
+/************************** PRIVATE VARIABLES *************************/
+const uint8_t GwMac[6] = GW_MAC;
+const uint8_t GwIp[4] = GW_IP;
+const uint8_t HostMac[6] = HOST_MAC;
+const uint8_t HostIp[4] = HOST_IP;
+
+/** CAN receive rings and transmit schedulers */
+CAN_RXRING_Type RxRing[2];
+CAN_RXFRAME_Type RxRingBuf[2][RX_RING_SIZE];
+CAN_TXSCHED_Type TxSched[2];
+CAN_TXQ_ENTRY_Type TxQueue[2][TX_QUEUE_SIZE];
+
+/** Datagram header template, fixed fields only */
+uint8_t GwHeader[GW_REC_OFFSET];
+
+/** Gateway header of the open batch, its records follow; NULL if none */
+uint8_t *GwBatch = NULL;
+/** Uplink of the open batch, GW_UPLINK_xxx */
+uint32_t GwBatchUplink;
+/** Number of records in open batch */
+uint32_t GwCount = 0;
+/** Time the open batch got its first record */
+uint32_t GwOpenTime;
+/** Batch sequence number, on both uplinks */
+uint16_t GwSeq = 0;
+/** Drop counters already reported */
+uint32_t GwDropReported = 0;
+
+#ifdef _USBDEV
+/** CDC class driver instance, plain bulk endpoints */
+USBDEV_CDC_Type GwCdc;
+/** Host has the port open (DTE present): batches go to USB */
+__IO uint32_t GwUsbOpen = 0;
+
+/** Uplink batch buffers: one is filled while the other is sent */
+uint32_t GwUsbBuf[2][GW_USB_BUF_WORDS];
+/** Batch length of each buffer, 0 if the buffer is free */
+__IO uint32_t GwUsbLen[2] = {0, 0};
+/** Buffer filled by the main loop, buffer sent and bytes written of it */
+uint32_t GwUsbFill = 0;
+uint32_t GwUsbSend = 0;
+uint32_t GwUsbPos = 0;
+
+/** Downlink batch buffer, bytes received */
+uint32_t GwUsbRx[GW_USB_BUF_WORDS];
+uint32_t GwUsbRxLen = 0;
+/** Complete batch waiting for the main loop */
+__IO uint8_t GwUsbRxReady = 0;
+/** Packet left in DEP_OUT while a batch waits: the host is NAKed */
+__IO uint8_t GwUsbRxHeld = 0;
+/** Batch longer than GW_USB_BATCH_MAX: skipped up to its short packet */
+uint8_t GwUsbRxSkip = 0;
+#endif
+
+/** Statistics */
+__IO uint32_t GwTxDatagrams = 0;
+__IO uint32_t GwRxDatagrams = 0;
+__IO uint32_t GwRxBadDatagrams = 0;
+__IO uint32_t GwCanTxDropped = 0;
+
+/************************** PRIVATE FUNCTIONS *************************/
+/* CAN interrupt service routine */
+void CAN_IRQHandler(void);
+
+void GW_Put16(uint8_t *p, uint32_t val);
+uint32_t GW_Get16(uint8_t *p);
+uint32_t GW_IpChecksum(uint8_t *p);
+void GW_Init(void);
+uint32_t GW_Dropped(void);
+uint8_t *GW_OpenBatch(void);
+void GW_Flush(void);
+int32_t GW_CheckBatch(uint8_t *p, uint32_t len);
+void GW_SubmitRecords(CAN_RXFRAME_Type *rec, uint32_t num);
+void GW_CanToEth(void);
+void GW_EthToCan(void);
+void GW_Setup(void);
+void GW_Poll(void);
+void Usr_Init_Emac(void);
+#ifdef _USBDEV
+/* USB interrupt service routine */
+void USB_IRQHandler(void);
+
+void GW_UsbEvent(uint32_t event, uint32_t param);
+uint32_t GW_UsbLineState(USBDEV_CDC_Type *cdc, uint16_t state);
+void GW_UsbBulkIn(USBDEV_CDC_Type *cdc);
+void GW_UsbBulkOut(USBDEV_CDC_Type *cdc);
+void GW_UsbSend(uint32_t len);
+void GW_UsbRead(void);
+void GW_UsbToCan(void);
+void Usr_Init_Usb(void);
+
+/* USB device configuration */
+const USBDEV_CFG_Type USB_Cfg = {
+	USB_DeviceDescriptor,
+	USB_ConfigDescriptor,
+	USB_StringDescriptor,
+	USBDEV_EVT_RESET | USBDEV_EVT_CONFIGURE,	/* EventMask */
+	GW_UsbEvent,								/* Event */
+	0,											/* DMAEndpoints */
+	0											/* DeferMask */
+};
+#endif
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		CAN IRQ Handler: drain receive buffers into rings and
+ * 				refill transmit buffers from the schedulers
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void CAN_IRQHandler(void)
+{
+	uint32_t IntStatus1, IntStatus2;
+
+	/* Interrupt register CANICR is reset after read, it is read once
+	 * by CAN_RxRingHandler() */
+	IntStatus1 = CAN_RxRingHandler(LPC_CAN1);
+	IntStatus2 = CAN_RxRingHandler(LPC_CAN2);
+	CAN_TxSchedHandler(LPC_CAN1, IntStatus1);
+	CAN_TxSchedHandler(LPC_CAN2, IntStatus2);
+}
+
+#ifdef _USBDEV
+/*********************************************************************//**
+ * @brief		USB IRQ Handler
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void USB_IRQHandler(void)
+{
+	USB_IntHandler();
+}
+#endif
+
+/*-------------------------PRIVATE FUNCTIONS----------------------------*/
+/*********************************************************************//**
+ * @brief		Write a 16 bit value in network byte order
+ * @param[in]	p		point to destination
+ * @param[in]	val		value
+ * @return 		none
+ **********************************************************************/
+void GW_Put16(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t)(val >> 8);
+	p[1] = (uint8_t)val;
+}
+
+/*********************************************************************//**
+ * @brief		Read a 16 bit value in network byte order
+ * @param[in]	p		point to source
+ * @return 		value
+ **********************************************************************/
+uint32_t GW_Get16(uint8_t *p)
+{
+	return ((uint32_t)p[0] << 8) | p[1];
+}
+
+/*********************************************************************//**
+ * @brief		Compute IPv4 header checksum (20 bytes header, no option)
+ * @param[in]	p		point to IPv4 header, checksum field must be 0
+ * @return 		checksum
+ **********************************************************************/
+uint32_t GW_IpChecksum(uint8_t *p)
+{
+	uint32_t i, sum = 0;
+
+	for (i = 0; i < 20; i += 2) {
+		sum += GW_Get16(p + i);
+	}
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	return (~sum) & 0xFFFF;
+}
+
+/*********************************************************************//**
+ * @brief		Build datagram header template
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_Init(void)
+{
+	uint8_t *p = GwHeader;
+
+	memset(p, 0, GW_REC_OFFSET);
+	/* Ethernet */
+	memcpy(p + GW_ETH_OFFSET, HostMac, 6);
+	memcpy(p + GW_ETH_OFFSET + 6, GwMac, 6);
+	GW_Put16(p + GW_ETH_OFFSET + 12, 0x0800);
+	/* IPv4: no option, don't fragment, TTL 64, UDP */
+	p[GW_IP_OFFSET + 0] = 0x45;
+	GW_Put16(p + GW_IP_OFFSET + 6, 0x4000);
+	p[GW_IP_OFFSET + 8] = 64;
+	p[GW_IP_OFFSET + 9] = 17;
+	memcpy(p + GW_IP_OFFSET + 12, GwIp, 4);
+	memcpy(p + GW_IP_OFFSET + 16, HostIp, 4);
+	/* UDP, checksum 0: not used */
+	GW_Put16(p + GW_UDP_OFFSET + 0, GW_UDP_PORT);
+	GW_Put16(p + GW_UDP_OFFSET + 2, GW_UDP_PORT);
+	/* Gateway header */
+	p[GW_HDR_OFFSET + 0] = GW_MAGIC0;
+	p[GW_HDR_OFFSET + 1] = GW_MAGIC1;
+	p[GW_HDR_OFFSET + 2] = GW_VERSION;
+}
+
+/*********************************************************************//**
+ * @brief		Get number of CAN frames dropped since last call, in
+ * 				receive rings or in hardware
+ * @param[in]	none
+ * @return 		number of dropped frames
+ **********************************************************************/
+uint32_t GW_Dropped(void)
+{
+	uint32_t total, dropped;
+
+	total = RxRing[0].overrun + RxRing[0].hw_overrun
+			+ RxRing[1].overrun + RxRing[1].hw_overrun;
+	dropped = total - GwDropReported;
+	GwDropReported = total;
+	return dropped;
+}
+
+/*********************************************************************//**
+ * @brief		Open a batch on the current uplink: the free USB batch
+ * 				buffer while the host has the port open, otherwise the
+ * 				free EMAC transmit buffer
+ * @param[in]	none
+ * @return 		gateway header of the batch, NULL if no buffer is free
+ **********************************************************************/
+uint8_t *GW_OpenBatch(void)
+{
+	uint8_t *p;
+
+#ifdef _USBDEV
+	if (GwUsbOpen) {
+		if (GwUsbLen[GwUsbFill] != 0) {
+			return NULL;
+		}
+		GwBatchUplink = GW_UPLINK_USB;
+		return (uint8_t *)GwUsbBuf[GwUsbFill] + GW_USB_HDR_OFFSET;
+	}
+#endif
+	p = (uint8_t *)EMAC_GetTxPacketBuffer();
+	if (p == NULL) {
+		return NULL;
+	}
+	GwBatchUplink = GW_UPLINK_ETH;
+	return p + GW_HDR_OFFSET;
+}
+
+/*********************************************************************//**
+ * @brief		Complete headers of open batch and send it
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_Flush(void)
+{
+	uint8_t *p;
+	uint32_t len, dropped;
+
+	dropped = GW_Dropped();
+
+	p = GwBatch;
+	p[0] = GW_MAGIC0;
+	p[1] = GW_MAGIC1;
+	p[2] = GW_VERSION;
+	p[3] = (uint8_t)GwCount;
+	GW_Put16(p + 4, GwSeq);
+	GW_Put16(p + 6, (dropped > 0xFFFF) ? 0xFFFF : dropped);
+	p[8] = 0;
+	p[9] = 0;
+	len = GW_HDR_LEN + GwCount * sizeof(CAN_RXFRAME_Type);
+
+#ifdef _USBDEV
+	if (GwBatchUplink == GW_UPLINK_USB) {
+		GW_UsbSend(len);
+	} else
+#endif
+	{
+		p -= GW_HDR_OFFSET;
+		len += GW_HDR_OFFSET;
+		memcpy(p, GwHeader, GW_HDR_OFFSET);
+		GW_Put16(p + GW_IP_OFFSET + 2, len - GW_IP_OFFSET);
+		GW_Put16(p + GW_IP_OFFSET + 4, GwSeq);
+		GW_Put16(p + GW_IP_OFFSET + 10, GW_IpChecksum(p + GW_IP_OFFSET));
+		GW_Put16(p + GW_UDP_OFFSET + 4, len - GW_UDP_OFFSET);
+		EMAC_SendTxPacketBuffer(len);
+	}
+	GwSeq++;
+	GwTxDatagrams++;
+	GwBatch = NULL;
+	GwCount = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Check gateway header of a batch received from the host
+ * @param[in]	p		point to gateway header
+ * @param[in]	len		bytes from the header to the end of the batch
+ * @return 		number of records, -1 if the batch is bad
+ **********************************************************************/
+int32_t GW_CheckBatch(uint8_t *p, uint32_t len)
+{
+	uint32_t num;
+
+	if (len < GW_HDR_LEN) {
+		return -1;
+	}
+	num = p[3];
+	if ((p[0] != GW_MAGIC0) || (p[1] != GW_MAGIC1) || (p[2] != GW_VERSION)
+		|| (len < GW_HDR_LEN + num * sizeof(CAN_RXFRAME_Type))) {
+		return -1;
+	}
+	return (int32_t)num;
+}
+
+/*********************************************************************//**
+ * @brief		Queue records of a host batch for transmission on CAN,
+ * 				bit 29 of id selects the controller
+ * @param[in]	rec		point to records, in place in the receive buffer
+ * @param[in]	num		number of records
+ * @return 		none
+ **********************************************************************/
+void GW_SubmitRecords(CAN_RXFRAME_Type *rec, uint32_t num)
+{
+	CAN_MSG_Type msg;
+	uint32_t i;
+
+	for (i = 0; i < num; i++, rec++) {
+		msg.id = CAN_RXFRAME_ID(rec);
+		msg.format = CAN_RXFRAME_IS_EXT(rec) ? EXT_ID_FORMAT : STD_ID_FORMAT;
+		msg.type = CAN_RXFRAME_IS_RTR(rec) ? REMOTE_FRAME : DATA_FRAME;
+		msg.len = CAN_RXFRAME_DLC(rec);
+		memcpy(msg.dataA, &rec->dataA, 4);
+		memcpy(msg.dataB, &rec->dataB, 4);
+		if (CAN_TxSchedSubmit((rec->id & GW_REC_CAN2) ? LPC_CAN2 : LPC_CAN1, &msg) == ERROR) {
+			GwCanTxDropped++;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		CAN to host: read received CAN frames straight into the
+ * 				open batch, flush it when full or old. If no batch
+ * 				buffer is free, frames wait in the rings.
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_CanToEth(void)
+{
+	CAN_RXFRAME_Type *rec;
+	uint32_t ch, i, n;
+
+	for (ch = 0; ch < 2; ch++) {
+		while (1) {
+			if (GwBatch == NULL) {
+				GwBatch = GW_OpenBatch();
+				if (GwBatch == NULL) {
+					return;
+				}
+				GwCount = 0;
+			}
+			rec = (CAN_RXFRAME_Type *)(GwBatch + GW_HDR_LEN) + GwCount;
+			n = CAN_ReadFrames((ch == 0) ? LPC_CAN1 : LPC_CAN2, rec, GW_FLUSH_RECORDS - GwCount);
+			if (n == 0) {
+				break;
+			}
+			if (ch != 0) {
+				for (i = 0; i < n; i++) {
+					rec[i].id |= GW_REC_CAN2;
+				}
+			}
+			if (GwCount == 0) {
+				GwOpenTime = LPC_TIM0->TC;
+			}
+			GwCount += n;
+			if (GwCount >= GW_FLUSH_RECORDS) {
+				GW_Flush();
+			}
+		}
+	}
+	if ((GwCount != 0) && ((LPC_TIM0->TC - GwOpenTime) >= GW_FLUSH_AGE)) {
+		GW_Flush();
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Ethernet to CAN: parse received datagrams in place in
+ * 				EMAC receive buffers and queue their records for
+ * 				transmission, bit 29 of id selects the controller
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_EthToCan(void)
+{
+	uint8_t *p;
+	uint32_t len;
+	int32_t num;
+
+	while (EMAC_CheckReceiveIndex()) {
+		p = (uint8_t *)EMAC_GetRxPacketBuffer();
+		// Get data size, trip out 4-bytes CRC field, note that length in (-1) style format
+		len = EMAC_GetReceiveDataSize() - 3;
+		if ((!EMAC_CheckReceiveDataStatus(EMAC_RINFO_LAST_FLAG))
+			|| (EMAC_CheckReceiveDataStatus(EMAC_RINFO_ERR_MASK))
+			|| (len < GW_REC_OFFSET)
+			|| (GW_Get16(p + GW_ETH_OFFSET + 12) != 0x0800)
+			|| (p[GW_IP_OFFSET + 0] != 0x45)
+			|| (p[GW_IP_OFFSET + 9] != 17)
+			|| (GW_Get16(p + GW_UDP_OFFSET + 2) != GW_UDP_PORT)) {
+			/* Not for the gateway, ignore it and free buffer */
+			EMAC_UpdateRxConsumeIndex();
+			continue;
+		}
+		num = GW_CheckBatch(p + GW_HDR_OFFSET, len - GW_HDR_OFFSET);
+		if (num < 0) {
+			GwRxBadDatagrams++;
+			EMAC_UpdateRxConsumeIndex();
+			continue;
+		}
+		GW_SubmitRecords((CAN_RXFRAME_Type *)(p + GW_REC_OFFSET), num);
+		GwRxDatagrams++;
+		EMAC_UpdateRxConsumeIndex();
+	}
+}
+
+#ifdef _USBDEV
+/*********************************************************************//**
+ * @brief		USB device events: bus reset and (de)configuration
+ * 				close the port and drop the batches in progress
+ * @param[in]	event	USBDEV_EVT_RESET or USBDEV_EVT_CONFIGURE
+ * @param[in]	param	not used
+ * @return 		none
+ **********************************************************************/
+void GW_UsbEvent(uint32_t event, uint32_t param)
+{
+	(void)event;
+	(void)param;
+	GwUsbOpen = 0;
+	GwUsbLen[0] = 0;
+	GwUsbLen[1] = 0;
+	GwUsbSend = GwUsbFill;
+	GwUsbPos = 0;
+	GwUsbRxLen = 0;
+	GwUsbRxReady = 0;
+	GwUsbRxHeld = 0;
+	GwUsbRxSkip = 0;
+}
+
+/*********************************************************************//**
+ * @brief		SET_CONTROL_LINE_STATE: batches go to USB while DTE is
+ * 				present. A batch already open is still sent on its uplink
+ * @param[in]	cdc		point to CDC class driver instance
+ * @param[in]	state	CDC_DTE_PRESENT and CDC_ACTIVATE_CARRIER bits
+ * @return 		TRUE
+ **********************************************************************/
+uint32_t GW_UsbLineState(USBDEV_CDC_Type *cdc, uint16_t state)
+{
+	(void)cdc;
+	GwUsbOpen = (state & CDC_DTE_PRESENT) ? 1 : 0;
+	return TRUE;
+}
+
+/*********************************************************************//**
+ * @brief		DEP_IN empty: write next packet of the batch being sent.
+ * 				When the batch is done, its buffer is freed and the other
+ * 				one is sent if it is queued
+ * @param[in]	cdc		point to CDC class driver instance
+ * @return 		none
+ **********************************************************************/
+void GW_UsbBulkIn(USBDEV_CDC_Type *cdc)
+{
+	uint32_t len, n;
+
+	len = GwUsbLen[GwUsbSend];
+	if (len == 0) {
+		return;
+	}
+	if (GwUsbPos >= len) {
+		GwUsbLen[GwUsbSend] = 0;
+		GwUsbSend ^= 1;
+		GwUsbPos = 0;
+		len = GwUsbLen[GwUsbSend];
+		if (len == 0) {
+			return;
+		}
+	}
+	n = len - GwUsbPos;
+	if (n > CDC_MAX_PACKET) {
+		n = CDC_MAX_PACKET;
+	}
+	if (USB_CdcWrite(cdc, (uint8_t *)GwUsbBuf[GwUsbSend] + GW_USB_HDR_OFFSET + GwUsbPos, n) == 0) {
+		/* Not configured: batch is lost */
+		GwUsbLen[GwUsbSend] = 0;
+		GwUsbPos = 0;
+		return;
+	}
+	GwUsbPos += n;
+}
+
+/*********************************************************************//**
+ * @brief		DEP_OUT holds a packet: append it to the downlink batch,
+ * 				or leave it there while a complete batch waits for the
+ * 				main loop, which NAKs the host
+ * @param[in]	cdc		point to CDC class driver instance
+ * @return 		none
+ **********************************************************************/
+void GW_UsbBulkOut(USBDEV_CDC_Type *cdc)
+{
+	(void)cdc;
+	if (GwUsbRxReady) {
+		GwUsbRxHeld = 1;
+		return;
+	}
+	GW_UsbRead();
+}
+
+/*********************************************************************//**
+ * @brief		Queue the open USB batch, send it now if no batch is in
+ * 				flight. Called from the main loop
+ * @param[in]	len		batch length
+ * @return 		none
+ **********************************************************************/
+void GW_UsbSend(uint32_t len)
+{
+	NVIC_DisableIRQ(USB_IRQn);
+	GwUsbLen[GwUsbFill] = len;
+	if (GwUsbLen[GwUsbFill ^ 1] == 0) {
+		GwUsbSend = GwUsbFill;
+		GwUsbPos = 0;
+		GW_UsbBulkIn(&GwCdc);
+	}
+	GwUsbFill ^= 1;
+	NVIC_EnableIRQ(USB_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		Read the packet of DEP_OUT into the downlink batch, a
+ * 				short packet ends the batch. Called from the USB
+ * 				interrupt, or with it disabled
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_UsbRead(void)
+{
+	uint32_t n;
+
+	if (GwUsbRxLen > GW_USB_BATCH_MAX) {
+		/* Too long: skip to the end of the batch */
+		GwUsbRxLen = 0;
+		GwUsbRxSkip = 1;
+	}
+	n = USB_ReadEP(GwCdc.DEP_OUT, (uint8_t *)GwUsbRx + GW_USB_HDR_OFFSET + GwUsbRxLen);
+	GwUsbRxLen += n;
+	if (n < CDC_MAX_PACKET) {
+		if (GwUsbRxSkip) {
+			GwUsbRxSkip = 0;
+			GwUsbRxLen = 0;
+			GwRxBadDatagrams++;
+		} else {
+			GwUsbRxReady = 1;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		USB to CAN: queue the records of the downlink batch for
+ * 				transmission, then take the packet held in DEP_OUT
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_UsbToCan(void)
+{
+	uint8_t *p;
+	int32_t num;
+
+	if (!GwUsbRxReady) {
+		return;
+	}
+	p = (uint8_t *)GwUsbRx + GW_USB_HDR_OFFSET;
+	num = GW_CheckBatch(p, GwUsbRxLen);
+	if (num < 0) {
+		GwRxBadDatagrams++;
+	} else {
+		GW_SubmitRecords((CAN_RXFRAME_Type *)(p + GW_HDR_LEN), num);
+		GwRxDatagrams++;
+	}
+
+	NVIC_DisableIRQ(USB_IRQn);
+	GwUsbRxLen = 0;
+	GwUsbRxReady = 0;
+	if (GwUsbRxHeld) {
+		GwUsbRxHeld = 0;
+		GW_UsbRead();
+	}
+	NVIC_EnableIRQ(USB_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		Initialize the USB device: CDC class in plain mode, the
+ * 				bulk endpoints are served by the callbacks above
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void Usr_Init_Usb(void)
+{
+	GwCdc.CIF = USB_CDC_CIF_NUM;
+	GwCdc.CEP_IN = CDC_CEP_IN;
+	GwCdc.DEP_IN = CDC_DEP_IN;
+	GwCdc.DEP_OUT = CDC_DEP_OUT;
+	GwCdc.SetLineCoding = NULL;
+	GwCdc.SetControlLineState = GW_UsbLineState;
+	GwCdc.SendBreak = NULL;
+	GwCdc.BulkOut = GW_UsbBulkOut;
+	GwCdc.BulkIn = GW_UsbBulkIn;
+	GwCdc.Bridge = NULL;
+	GwCdc.LineCoding.dwDTERate = 115200;
+	GwCdc.LineCoding.bCharFormat = 0;
+	GwCdc.LineCoding.bParityType = 0;
+	GwCdc.LineCoding.bDataBits = 8;
+	USB_CdcInit(&GwCdc);
+
+	USB_Init(&USB_Cfg);
+	USB_Connect(TRUE);
+}
+#endif
+
+/*********************************************************************//**
+ * @brief		Initialize EMAC, polled mode
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void Usr_Init_Emac(void)
+{
+	EMAC_CFG_Type Emac_Config;
+	PINSEL_CFG_Type PinCfg;
+	uint8_t EMACAddr[6];
+	uint32_t i;
+
+	/*
+	 * Enable P1 Ethernet Pins:
+	 * P1.0 - ENET_TXD0
+	 * P1.1 - ENET_TXD1
+	 * P1.4 - ENET_TX_EN
+	 * P1.8 - ENET_CRS
+	 * P1.9 - ENET_RXD0
+	 * P1.10 - ENET_RXD1
+	 * P1.14 - ENET_RX_ER
+	 * P1.15 - ENET_REF_CLK
+	 * P1.16 - ENET_MDC
+	 * P1.17 - ENET_MDIO
+	 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Portnum = 1;
+
+	PinCfg.Pinnum = 0;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 1;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 4;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 8;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 9;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 10;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 14;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 15;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 16;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 17;
+	PINSEL_ConfigPin(&PinCfg);
+
+	/* EMAC station address registers take the address in reverse order */
+	for (i = 0; i < 6; i++) {
+		EMACAddr[i] = GwMac[5 - i];
+	}
+	Emac_Config.Mode = EMAC_MODE_AUTO;
+	Emac_Config.pbEMAC_Addr = EMACAddr;
+	// Initialize EMAC module with given parameter
+	while (EMAC_Init(&Emac_Config) == ERROR){
+		// Delay for a while then continue initializing EMAC module
+		for (i = 0x100000; i; i--);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Initialize timer, CAN, Ethernet and USB
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_Setup(void)
+{
+	PINSEL_CFG_Type PinCfg;
+	TIM_TIMERCFG_Type TIM_ConfigStruct;
+	uint32_t i;
+
+	/* Time stamp: TIMER0 free running at 1us */
+	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_USVAL;
+	TIM_ConfigStruct.PrescaleValue	= 1;
+	TIM_Init(LPC_TIM0, TIM_TIMER_MODE, &TIM_ConfigStruct);
+	TIM_Cmd(LPC_TIM0, ENABLE);
+
+	/* Pin configuration
+	 * CAN1: select P0.0 as RD1. P0.1 as TD1
+	 * CAN2: select P2.7 as RD2, P2.8 as RD2
+	 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Pinnum = 0;
+	PinCfg.Portnum = 0;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 1;
+	PINSEL_ConfigPin(&PinCfg);
+
+	PinCfg.Pinnum = 7;
+	PinCfg.Portnum = 2;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 8;
+	PINSEL_ConfigPin(&PinCfg);
+
+	//Initialize CAN1 & CAN2, receive all messages
+	CAN_Init(LPC_CAN1, CAN_BITRATE);
+	CAN_Init(LPC_CAN2, CAN_BITRATE);
+	CAN_SetAFMode(LPC_CANAF, CAN_AccBP);
+
+	//Attach receive rings and transmit schedulers
+	for (i = 0; i < 2; i++) {
+		TxSched[i].heap = TxQueue[i];
+		TxSched[i].size = TX_QUEUE_SIZE;
+		TxSched[i].stat_num = 0;
+		TxSched[i].stat = NULL;
+		TxSched[i].timer = &LPC_TIM0->TC;
+	}
+	CAN_RxRingInit(LPC_CAN1, &RxRing[0], RxRingBuf[0], RX_RING_SIZE, &LPC_TIM0->TC);
+	CAN_RxRingInit(LPC_CAN2, &RxRing[1], RxRingBuf[1], RX_RING_SIZE, &LPC_TIM0->TC);
+	CAN_TxSchedInit(LPC_CAN1, &TxSched[0]);
+	CAN_TxSchedInit(LPC_CAN2, &TxSched[1]);
+
+	//Enable CAN Interrupt
+	NVIC_EnableIRQ(CAN_IRQn);
+
+	GW_Init();
+	Usr_Init_Emac();
+#ifdef _USBDEV
+	Usr_Init_Usb();
+#endif
+}
+
+/*********************************************************************//**
+ * @brief		One pass of the gateway main loop
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void GW_Poll(void)
+{
+	GW_CanToEth();
+	GW_EthToCan();
+#ifdef _USBDEV
+	GW_UsbToCan();
+	USB_Task();
+#endif
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main CAN program body
+ * @param[in]	none
+ * @return 		int
+ **********************************************************************/
+int c_entry(void) { /* Main Program */
+	GW_Setup();
+
+	while (1) {
+		GW_Poll();
+	}
+	return 1;
+}
+
+/* With ARM and GHS toolsets, the entry point is main() - this will
+   allow the linker to generate wrapper code to setup stacks, allocate
+   heap area, and initialize and copy code and data segments. For GNU
+   toolsets, the entry point is through __start() in the crt0_gnu.asm
+   file, and that startup code will setup stacks and data */
+int main(void)
+{
+    return c_entry();
+}
+
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
@@ -0,0 +1,848 @@
+/**********************************************************************
+* $Id$		gw_host.c			2011-03-09
+*//**
+* @file		gw_host.c
+* @brief	Host simulation of the CAN gateway: the example, the CAN,
+* 			EMAC, timer and USB drivers run unmodified against gwsim.c
+* 			and usbsim.c. An external node loads each CAN bus, the host
+* 			takes the batches from the Ethernet wire or from the CDC
+* 			bulk IN endpoint, checks every record against the frames
+* 			sent and measures the latency from the end of a CAN frame
+* 			to the end of the datagram or USB transfer carrying it.
+* 			Downlink batches are sent to the gateway on either link and
+* 			checked on the CAN buses. Prints frames per second and the
+* 			average and worst-case latencies of each scenario.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_can.h"
+#include "lpc17xx_usbdev_cdc.h"
+#include "usbdesc.h"
+#include "usbsim.h"
+#include "gwsim.h"
+
+/* Test parameters */
+#define HOST_RUN_MS			200		/* CAN traffic of a scenario */
+#define HOST_DRAIN_MS		20		/* Then everything is delivered */
+#define HOST_ADDR			5		/* Address given to the device */
+#define HOST_IRQ_MAX		64		/* Interrupt entries for one event */
+#define HOST_RETRY_MAX		100		/* NAKs of one control stage */
+#define HOST_TOKEN_CYCLES	(GWSIM_CCLK / 20000)	/* Bulk tokens, 50us */
+#define HOST_SOF_CYCLES		(GWSIM_CCLK / 1000)		/* Frames, 1ms */
+#define HOST_DL_CYCLES		(GWSIM_CCLK / 500)		/* Downlink batches, 2ms */
+#define HOST_DL_RECORDS		2		/* Downlink records per bus and batch */
+#define HOST_DL_ID			0x200	/* Downlink identifier */
+#define HOST_DL_NUM			1024	/* Downlink send times kept per bus */
+#define HOST_LAT_MAX		(GW_FLUSH_AGE + 500)	/* Uplink latency, us */
+#define HOST_US				(GWSIM_CCLK / 1000000)	/* Cycles per us */
+
+/* Datagram layout and addresses of the example */
+#define GW_IP_OFFSET		14
+#define GW_UDP_OFFSET		34
+#define GW_HDR_OFFSET		42
+#define GW_HDR_LEN			10
+#define GW_MAX_FRAME		1514
+#define GW_UDP_PORT			20100
+#define GW_FLUSH_AGE		1000
+#define GW_REC_CAN2			(1UL << 29)
+
+/* Uplinks and downlinks of a scenario */
+#define HOST_NONE			0
+#define HOST_ETH			1
+#define HOST_USB			2
+
+/* From the example */
+extern const USBDEV_CFG_Type USB_Cfg;
+extern const uint8_t GwMac[6];
+extern const uint8_t GwIp[4];
+extern const uint8_t HostIp[4];
+extern uint32_t GwCount;
+extern uint32_t GwOpenTime;
+extern __IO uint8_t GwUsbRxReady;
+extern __IO uint32_t GwRxBadDatagrams;
+extern __IO uint32_t GwCanTxDropped;
+void CAN_IRQHandler(void);
+void USB_IRQHandler(void);
+void GW_Setup(void);
+void GW_Poll(void);
+
+uint32_t SystemCoreClock = GWSIM_CCLK;
+
+/**
+ * @brief Test scenario
+ */
+typedef struct {
+	const char *name;
+	uint32_t uplink;		/* HOST_ETH or HOST_USB */
+	uint32_t load;			/* External node load of each bus, percent */
+	uint32_t downlink;		/* HOST_NONE, HOST_ETH or HOST_USB */
+} HOST_SCENARIO_Type;
+
+static const HOST_SCENARIO_Type host_scenario[] = {
+	{"eth 25%",			HOST_ETH,	25,		HOST_NONE},
+	{"eth 50%",			HOST_ETH,	50,		HOST_NONE},
+	{"eth 90%",			HOST_ETH,	90,		HOST_NONE},
+	{"eth 100%",		HOST_ETH,	100,	HOST_NONE},
+	{"eth 50% + down",	HOST_ETH,	50,		HOST_ETH},
+	{"usb 50%",			HOST_USB,	50,		HOST_NONE},
+	{"usb 100%",		HOST_USB,	100,	HOST_NONE},
+	{"usb 50% + down",	HOST_USB,	50,		HOST_USB},
+};
+
+/* Host side state */
+static uint8_t host_addr;
+static const uint8_t host_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static uint32_t host_rxseq[2];		/* Next external frame expected */
+static uint16_t host_batchseq;		/* Next batch sequence expected */
+static uint32_t host_dltx[2];		/* Downlink records sent */
+static uint32_t host_dlrx[2];		/* Downlink frames seen on the bus */
+static uint64_t host_dltime[2][HOST_DL_NUM];
+static uint64_t host_busy;			/* Cycles in the example */
+
+/* USB bulk transfers in progress */
+static uint8_t host_usbin[GW_MAX_FRAME + CDC_MAX_PACKET];
+static uint32_t host_usbinlen;
+static uint8_t host_usbout[GW_MAX_FRAME];
+static uint32_t host_usboutlen;
+static uint32_t host_usboutpos;
+
+/* Scenario results */
+static struct {
+	uint32_t Records;
+	uint32_t Batches;
+	uint64_t LatSum;
+	uint64_t LatMax;
+	uint32_t DlRecords;
+	uint64_t DlLatSum;
+	uint64_t DlLatMax;
+	uint32_t OutNak;
+} host;
+
+/*********************************************************************//**
+ * @brief		Stub: the peripheral power is not modelled
+ **********************************************************************/
+void CLKPWR_ConfigPPWR(uint32_t PPType, FunctionalState NewState)
+{
+	(void)PPType;
+	(void)NewState;
+}
+
+/*********************************************************************//**
+ * @brief		Stub: the dividers the drivers select are built in
+ **********************************************************************/
+void CLKPWR_SetPCLKDiv(uint32_t ClkType, uint32_t DivVal)
+{
+	(void)ClkType;
+	(void)DivVal;
+}
+
+/*********************************************************************//**
+ * @brief		Stub: peripheral clock of the model
+ * @param[in]	ClkType	Peripheral
+ * @return		Clock, Hz
+ **********************************************************************/
+uint32_t CLKPWR_GetPCLK(uint32_t ClkType)
+{
+	if ((ClkType == CLKPWR_PCLKSEL_CAN1) || (ClkType == CLKPWR_PCLKSEL_CAN2) ||
+			(ClkType == CLKPWR_PCLKSEL_ACF)) {
+		return GWSIM_CAN_PCLK;
+	}
+	return GWSIM_TIM_PCLK;
+}
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Stop the test
+ * @param[in]	msg		Reason
+ * @return		None
+ **********************************************************************/
+static void host_Fail(const char *msg)
+{
+	fprintf(stderr, "FAIL: %s (%.3f ms)\n", msg,
+			(double)GWSIM_Now() / (GWSIM_CCLK / 1000));
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Run a function of the example with its instructions
+ * 				traced and counted as processor time
+ * @param[in]	func	Function
+ * @return		None
+ **********************************************************************/
+static void host_Traced(void (*func)(void))
+{
+	uint64_t start;
+
+	start = GWSIM_Now();
+	GWSIM_Start();
+	func();
+	GWSIM_Stop();
+	host_busy += GWSIM_Now() - start;
+}
+
+/*********************************************************************//**
+ * @brief		Service the USB interrupt while it is requested
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Irq(void)
+{
+	uint32_t n;
+
+	for (n = 0; USBSIM_IrqPending() && GWSIM_IrqEnabled(USB_IRQn); n++) {
+		if (n == HOST_IRQ_MAX) {
+			host_Fail("USB interrupt request not cleared");
+		}
+		host_Traced(USB_IRQHandler);
+	}
+	USBSIM_Check();
+}
+
+/*********************************************************************//**
+ * @brief		Service the CAN and USB interrupts while requested
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Service(void)
+{
+	uint32_t n;
+
+	for (n = 0; GWSIM_CanIrqPending() && GWSIM_IrqEnabled(CAN_IRQn); n++) {
+		if (n == HOST_IRQ_MAX) {
+			host_Fail("CAN interrupt request not cleared");
+		}
+		host_Traced(CAN_IRQHandler);
+	}
+	host_Irq();
+}
+
+/*********************************************************************//**
+ * @brief		Control transfer to endpoint 0, stage by stage with the
+ * 				interrupt serviced after each token
+ * @param[in]	setup	Setup packet
+ * @param[in,out]	data	Data stage, wLength bytes plus a packet
+ * @return		Data stage length, -1 on error
+ **********************************************************************/
+static int host_Control(const uint8_t *setup, uint8_t *data)
+{
+	uint32_t len, done, n, tries;
+	int in, r;
+	uint8_t zlp[USB_MAX_PACKET0];
+
+	len = setup[6] | (setup[7] << 8);
+	in = (setup[0] & 0x80) != 0;
+	if (USBSIM_Setup(host_addr, setup) != USBSIM_ACK) {
+		return -1;
+	}
+	host_Irq();
+
+	for (done = 0; done < len; ) {
+		n = len - done;
+		if (n > USB_MAX_PACKET0) {
+			n = USB_MAX_PACKET0;
+		}
+		for (tries = 0; ; tries++) {
+			r = in ? USBSIM_In(host_addr, 0, data + done) :
+					USBSIM_Out(host_addr, 0, data + done, n);
+			host_Irq();
+			if ((r != USBSIM_NAK) || (tries == HOST_RETRY_MAX)) {
+				break;
+			}
+		}
+		if (r < 0) {
+			return -1;
+		}
+		if (in) {
+			done += r;
+			if (r < USB_MAX_PACKET0) {
+				break;							/* Short packet */
+			}
+		} else {
+			done += n;
+		}
+	}
+
+	for (tries = 0; ; tries++) {
+		r = in ? USBSIM_Out(host_addr, 0, NULL, 0) : USBSIM_In(host_addr, 0, zlp);
+		host_Irq();
+		if ((r != USBSIM_NAK) || (tries == HOST_RETRY_MAX)) {
+			break;
+		}
+	}
+	return (r == 0) ? (int)done : -1;
+}
+
+/*********************************************************************//**
+ * @brief		Build a setup packet
+ **********************************************************************/
+static void host_SetupPacket(uint8_t *s, uint8_t type, uint8_t req,
+							uint16_t value, uint16_t index, uint16_t len)
+{
+	s[0] = type;
+	s[1] = req;
+	s[2] = (uint8_t)value;
+	s[3] = (uint8_t)(value >> 8);
+	s[4] = (uint8_t)index;
+	s[5] = (uint8_t)(index >> 8);
+	s[6] = (uint8_t)len;
+	s[7] = (uint8_t)(len >> 8);
+}
+
+/*********************************************************************//**
+ * @brief		Bus reset and enumeration: descriptors checked against
+ * 				the example, address, configuration
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Enumerate(void)
+{
+	uint8_t setup[8];
+	uint8_t buf[512];
+	int n, total;
+
+	host_addr = 0;
+	USBSIM_BusReset();
+	host_Irq();
+
+	host_SetupPacket(setup, 0x80, 6, 0x0100, 0, 64);
+	n = host_Control(setup, buf);
+	if ((n != 18) || (memcmp(buf, USB_DeviceDescriptor, 18) != 0)) {
+		host_Fail("device descriptor");
+	}
+	host_SetupPacket(setup, 0x00, 5, HOST_ADDR, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_ADDRESS");
+	}
+	host_addr = HOST_ADDR;
+
+	host_SetupPacket(setup, 0x80, 6, 0x0200, 0, 9);
+	if (host_Control(setup, buf) != 9) {
+		host_Fail("configuration descriptor header");
+	}
+	total = buf[2] | (buf[3] << 8);
+	host_SetupPacket(setup, 0x80, 6, 0x0200, 0, total);
+	n = host_Control(setup, buf);
+	if ((n != total) || (memcmp(buf, USB_ConfigDescriptor, total) != 0)) {
+		host_Fail("configuration descriptor");
+	}
+
+	host_SetupPacket(setup, 0x00, 9, 1, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_CONFIGURATION");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Open or close the virtual COM port: batches go to USB
+ * 				while DTE is present
+ * @param[in]	open	DTE present
+ * @return		None
+ **********************************************************************/
+static void host_LineState(uint32_t open)
+{
+	uint8_t setup[8];
+	uint8_t buf[USB_MAX_PACKET0];
+
+	host_SetupPacket(setup, 0x21, CDC_SET_CONTROL_LINE_STATE,
+			open ? CDC_DTE_PRESENT : 0, USB_CDC_CIF_NUM, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_CONTROL_LINE_STATE");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Read and write network byte order
+ **********************************************************************/
+static uint32_t host_Get16(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 8) | p[1];
+}
+
+static void host_Put16(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t)(val >> 8);
+	p[1] = (uint8_t)val;
+}
+
+/*********************************************************************//**
+ * @brief		Sum of an IPv4 header, 0xFFFF if its checksum is right
+ * @param[in]	p		IPv4 header, 20 bytes
+ * @return		Folded sum
+ **********************************************************************/
+static uint32_t host_IpSum(const uint8_t *p)
+{
+	uint32_t i, sum = 0;
+
+	for (i = 0; i < 20; i += 2) {
+		sum += host_Get16(p + i);
+	}
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	return sum;
+}
+
+/*********************************************************************//**
+ * @brief		Uplink batch delivered to the host: header, then every
+ * 				record against the frames of the external nodes in bus
+ * 				order, time stamp and latency
+ * @param[in]	p		Gateway header
+ * @param[in]	len		Bytes from the header to the end of the batch
+ * @param[in]	time	Time the batch was delivered
+ * @return		None
+ **********************************************************************/
+static void host_Batch(const uint8_t *p, uint32_t len, uint64_t time)
+{
+	CAN_RXFRAME_Type rec;
+	GWSIM_FRAME_Type f;
+	uint32_t num, i, bus, seq, tc_rx, tc;
+	uint64_t rx, lat;
+
+	if ((len < GW_HDR_LEN) || (p[0] != 'C') || (p[1] != 'G') || (p[2] != 1)) {
+		host_Fail("batch header");
+	}
+	num = p[3];
+	if ((num == 0) || (len != GW_HDR_LEN + num * sizeof(CAN_RXFRAME_Type))) {
+		host_Fail("batch length");
+	}
+	if (host_Get16(p + 4) != host_batchseq) {
+		host_Fail("batch sequence");
+	}
+	if (host_Get16(p + 6) != 0) {
+		host_Fail("frames dropped by the gateway");
+	}
+	host_batchseq++;
+	host.Batches++;
+
+	for (i = 0; i < num; i++) {
+		memcpy(&rec, p + GW_HDR_LEN + i * sizeof(rec), sizeof(rec));
+		bus = (rec.id & GW_REC_CAN2) ? 1 : 0;
+		seq = host_rxseq[bus]++;
+		GWSIM_ExtFrame(seq, &f);
+		if ((CAN_RXFRAME_ID(&rec) != f.id) || (CAN_RXFRAME_IS_EXT(&rec) != f.ext) ||
+				(CAN_RXFRAME_IS_RTR(&rec) != f.rtr) || (CAN_RXFRAME_DLC(&rec) != f.dlc) ||
+				(rec.dataA != f.dataA) || (rec.dataB != f.dataB)) {
+			host_Fail("record does not match the next frame of its bus");
+		}
+		/* Stamped between reception and delivery */
+		rx = GWSIM_CanRxTime(bus, seq);
+		tc_rx = GWSIM_TimerValue(rx);
+		tc = GWSIM_TimerValue(time);
+		if (((CAN_RXFRAME_TIME(&rec) - tc_rx) & 0x0FFFFFFF) > ((tc - tc_rx) & 0x0FFFFFFF)) {
+			host_Fail("record time stamp");
+		}
+		lat = time - rx;
+		host.LatSum += lat;
+		if (lat > host.LatMax) {
+			host.LatMax = lat;
+		}
+		host.Records++;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Frame sent by the EMAC: Ethernet, IPv4 and UDP headers
+ * 				of the example, then the batch
+ * @param[in]	frame	Frame without FCS
+ * @param[in]	len		Frame length
+ * @param[in]	time	End of the frame on the wire
+ * @return		None
+ **********************************************************************/
+static void host_EthTx(const uint8_t *frame, uint32_t len, uint64_t time)
+{
+	static const uint8_t bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	const uint8_t *ip = frame + GW_IP_OFFSET;
+	const uint8_t *udp = frame + GW_UDP_OFFSET;
+
+	if ((len < GW_HDR_OFFSET) || (len > GW_MAX_FRAME) ||
+			(memcmp(frame, bcast, 6) != 0) || (memcmp(frame + 6, GwMac, 6) != 0) ||
+			(host_Get16(frame + 12) != 0x0800)) {
+		host_Fail("Ethernet header");
+	}
+	if ((ip[0] != 0x45) || (ip[9] != 17) || (host_Get16(ip + 2) != len - GW_IP_OFFSET) ||
+			(host_IpSum(ip) != 0xFFFF) || (memcmp(ip + 12, GwIp, 4) != 0) ||
+			(memcmp(ip + 16, HostIp, 4) != 0)) {
+		host_Fail("IPv4 header");
+	}
+	if ((host_Get16(udp) != GW_UDP_PORT) || (host_Get16(udp + 2) != GW_UDP_PORT) ||
+			(host_Get16(udp + 4) != len - GW_UDP_OFFSET)) {
+		host_Fail("UDP header");
+	}
+	host_Batch(frame + GW_HDR_OFFSET, len - GW_HDR_OFFSET, time);
+}
+
+/*********************************************************************//**
+ * @brief		Frame sent by a CAN controller: the next downlink record
+ * 				of the bus, in order
+ * @param[in]	bus		Bus number
+ * @param[in]	frame	Frame
+ * @param[in]	time	End of the frame on the bus
+ * @return		None
+ **********************************************************************/
+static void host_CanTx(uint32_t bus, const GWSIM_FRAME_Type *frame, uint64_t time)
+{
+	uint32_t seq;
+	uint64_t lat;
+
+	seq = host_dlrx[bus];
+	if ((seq == host_dltx[bus]) || (frame->id != HOST_DL_ID) || frame->ext ||
+			frame->rtr || (frame->dlc != 8) || (frame->dataA != seq) ||
+			(frame->dataB != ~seq)) {
+		host_Fail("CAN frame is not the next downlink record of its bus");
+	}
+	host_dlrx[bus]++;
+	lat = time - host_dltime[bus][seq % HOST_DL_NUM];
+	host.DlLatSum += lat;
+	if (lat > host.DlLatMax) {
+		host.DlLatMax = lat;
+	}
+	host.DlRecords++;
+}
+
+/*********************************************************************//**
+ * @brief		Build a downlink batch: HOST_DL_RECORDS records for each
+ * 				bus, data bytes are the record number of the bus
+ * @param[out]	p		Gateway header, records follow
+ * @return		Batch length
+ **********************************************************************/
+static uint32_t host_DlBatch(uint8_t *p)
+{
+	CAN_RXFRAME_Type rec;
+	uint32_t i, bus, seq, num = 0;
+
+	p[0] = 'C';
+	p[1] = 'G';
+	p[2] = 1;
+	p[3] = 2 * HOST_DL_RECORDS;
+	memset(p + 4, 0, GW_HDR_LEN - 4);
+	for (i = 0; i < HOST_DL_RECORDS; i++) {
+		for (bus = 0; bus < 2; bus++) {
+			seq = host_dltx[bus]++;
+			host_dltime[bus][seq % HOST_DL_NUM] = GWSIM_Now();
+			rec.stamp = 8;
+			rec.id = HOST_DL_ID | (bus ? GW_REC_CAN2 : 0);
+			rec.dataA = seq;
+			rec.dataB = ~seq;
+			memcpy(p + GW_HDR_LEN + num * sizeof(rec), &rec, sizeof(rec));
+			num++;
+		}
+	}
+	return GW_HDR_LEN + num * sizeof(rec);
+}
+
+/*********************************************************************//**
+ * @brief		Send a downlink datagram to the EMAC
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_EthDownlink(void)
+{
+	uint8_t frame[GW_MAX_FRAME];
+	uint8_t *ip = frame + GW_IP_OFFSET;
+	uint8_t *udp = frame + GW_UDP_OFFSET;
+	uint32_t len;
+
+	memset(frame, 0, GW_HDR_OFFSET);
+	memcpy(frame, GwMac, 6);
+	memcpy(frame + 6, host_mac, 6);
+	host_Put16(frame + 12, 0x0800);
+	len = GW_HDR_OFFSET + host_DlBatch(frame + GW_HDR_OFFSET);
+	ip[0] = 0x45;
+	host_Put16(ip + 2, len - GW_IP_OFFSET);
+	ip[8] = 64;
+	ip[9] = 17;
+	memcpy(ip + 12, HostIp, 4);
+	memcpy(ip + 16, GwIp, 4);
+	host_Put16(ip + 10, ~host_IpSum(ip) & 0xFFFF);
+	host_Put16(udp, GW_UDP_PORT);
+	host_Put16(udp + 2, GW_UDP_PORT);
+	host_Put16(udp + 4, len - GW_UDP_OFFSET);
+	if (!GWSIM_EthRx(frame, len)) {
+		host_Fail("downlink datagram dropped by the EMAC");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Bulk tokens of a 50us slot: one IN token collecting the
+ * 				uplink batch, one OUT token of the downlink batch if one
+ * 				is in progress
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_UsbTokens(void)
+{
+	uint32_t n;
+	int r;
+
+	r = USBSIM_In(host_addr, CDC_DEP_IN & 0x0F, host_usbin + host_usbinlen);
+	host_Irq();
+	if (r >= 0) {
+		host_usbinlen += r;
+		if (r < CDC_MAX_PACKET) {
+			host_Batch(host_usbin, host_usbinlen, GWSIM_Now());
+			host_usbinlen = 0;
+		} else if (host_usbinlen > GW_MAX_FRAME) {
+			host_Fail("USB batch too long");
+		}
+	} else if (r != USBSIM_NAK) {
+		host_Fail("bulk IN token");
+	}
+
+	if (host_usboutpos == host_usboutlen) {
+		return;
+	}
+	n = host_usboutlen - host_usboutpos;
+	if (n > CDC_MAX_PACKET) {
+		n = CDC_MAX_PACKET;
+	}
+	r = USBSIM_Out(host_addr, CDC_DEP_OUT, host_usbout + host_usboutpos, n);
+	host_Irq();
+	if (r == USBSIM_ACK) {
+		host_usboutpos += n;
+	} else if (r == USBSIM_NAK) {
+		host.OutNak++;
+	} else {
+		host_Fail("bulk OUT token");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Traffic period of an external node for a bus load: mean
+ * 				bus time of the frame pattern over the load
+ * @param[in]	load	Percent
+ * @return		Cycles between frames
+ **********************************************************************/
+static uint32_t host_Period(uint32_t load)
+{
+	GWSIM_FRAME_Type f;
+	uint64_t sum = 0;
+	uint32_t seq;
+
+	for (seq = 0; seq < 144; seq++) {			/* Pattern repeats */
+		GWSIM_ExtFrame(seq, &f);
+		sum += GWSIM_FrameCycles(0, &f);
+	}
+	return (uint32_t)(sum * 100 / (144 * load));
+}
+
+/*********************************************************************//**
+ * @brief		All uplink frames and downlink records delivered
+ * @param[in]	None
+ * @return		Non zero if drained
+ **********************************************************************/
+static int host_Drained(void)
+{
+	GWSIM_STATS_Type st;
+
+	GWSIM_GetStats(&st);
+	return (host_rxseq[0] == st.CanRx[0]) && (host_rxseq[1] == st.CanRx[1]) &&
+			(host_dlrx[0] == host_dltx[0]) && (host_dlrx[1] == host_dltx[1]) &&
+			(host_usboutpos == host_usboutlen) && (GwCount == 0) && GWSIM_EthIdle();
+}
+
+/*********************************************************************//**
+ * @brief		Run a scenario: traffic, then drain, then report
+ * @param[in]	sc		Scenario
+ * @return		None
+ **********************************************************************/
+static void host_Run(const HOST_SCENARIO_Type *sc)
+{
+	GWSIM_STATS_Type st0, st1;
+	uint64_t start, stop, end, now, t, next_token, next_sof, next_dl, busy0;
+	uint32_t period, traffic;
+	double ms;
+
+	memset(&host, 0, sizeof(host));
+	if (sc->uplink == HOST_USB) {
+		host_LineState(1);
+	}
+	GWSIM_GetStats(&st0);
+	busy0 = host_busy;
+	start = GWSIM_Now();
+	stop = start + (uint64_t)HOST_RUN_MS * (GWSIM_CCLK / 1000);
+	end = stop + (uint64_t)HOST_DRAIN_MS * (GWSIM_CCLK / 1000);
+	period = host_Period(sc->load);
+	GWSIM_CanTraffic(0, period);
+	GWSIM_CanTraffic(1, period);
+	traffic = 1;
+	next_token = start;
+	next_sof = start;
+	next_dl = (sc->downlink != HOST_NONE) ? start : ~(uint64_t)0;
+
+	for (;;) {
+		now = GWSIM_Now();
+		if (traffic && (now >= stop)) {
+			GWSIM_CanTraffic(0, 0);
+			GWSIM_CanTraffic(1, 0);
+			next_dl = ~(uint64_t)0;
+			traffic = 0;
+		}
+		if (!traffic && host_Drained()) {
+			break;
+		}
+		if (now >= end) {
+			host_Fail("frames not delivered after the traffic stopped");
+		}
+
+		/* Host events due */
+		if (now >= next_sof) {
+			USBSIM_Frame();
+			host_Irq();
+			next_sof += HOST_SOF_CYCLES;
+		}
+		if (now >= next_dl) {
+			if (sc->downlink == HOST_ETH) {
+				host_EthDownlink();
+			} else if (host_usboutpos == host_usboutlen) {
+				host_usboutlen = host_DlBatch(host_usbout);
+				host_usboutpos = 0;
+			}
+			next_dl += HOST_DL_CYCLES;
+		}
+		if ((sc->uplink == HOST_USB) || (sc->downlink == HOST_USB)) {
+			if (now >= next_token) {
+				host_UsbTokens();
+				next_token += HOST_TOKEN_CYCLES;
+				if (next_token <= now) {
+					next_token = now + HOST_TOKEN_CYCLES;
+				}
+			}
+		} else {
+			next_token = ~(uint64_t)0;
+		}
+
+		/* Interrupts, then one pass of the main loop */
+		host_Service();
+		host_Traced(GW_Poll);
+		host_Service();
+
+		/* Nothing to do until the next event: skip the idle loop */
+		if (!GwUsbRxReady && !GWSIM_CanIrqPending() && !USBSIM_IrqPending()) {
+			t = GWSIM_NextEvent();
+			if (next_sof < t) {
+				t = next_sof;
+			}
+			if (next_dl < t) {
+				t = next_dl;
+			}
+			if (next_token < t) {
+				t = next_token;
+			}
+			if (traffic && (stop < t)) {
+				t = stop;
+			}
+			if (end < t) {
+				t = end;
+			}
+			if (GwCount != 0) {
+				now = GWSIM_TimerCycle(GwOpenTime + GW_FLUSH_AGE);
+				if (now < t) {
+					t = now;
+				}
+			}
+			GWSIM_Advance(t);
+		}
+	}
+
+	if (sc->uplink == HOST_USB) {
+		host_LineState(0);
+	}
+	GWSIM_GetStats(&st1);
+	if (st1.CanOverrun[0] + st1.CanOverrun[1] != st0.CanOverrun[0] + st0.CanOverrun[1]) {
+		host_Fail("CAN receive overrun");
+	}
+	if (st1.EthRxDrop != st0.EthRxDrop) {
+		host_Fail("downlink datagram dropped");
+	}
+	if ((GwRxBadDatagrams != 0) || (GwCanTxDropped != 0)) {
+		host_Fail("downlink batch rejected by the gateway");
+	}
+	if (st1.Violations != 0) {
+		fprintf(stderr, "FAIL: %s\n", GWSIM_Violation());
+		exit(1);
+	}
+	if (host.LatMax > (uint64_t)HOST_LAT_MAX * HOST_US) {
+		host_Fail("uplink latency above the flush age");
+	}
+
+	ms = (double)HOST_RUN_MS;
+	printf("%-15s %3.0f%%  %6.0f fr/s  %5.0f batch/s  %4.1f rec/batch"
+			"  lat %4.0f/%4.0f us",
+			sc->name, 50.0 * (double)(st1.CanBusy[0] + st1.CanBusy[1] - st0.CanBusy[0] - st0.CanBusy[1]) /
+				(double)(stop - start),
+			host.Records * 1000.0 / ms, host.Batches * 1000.0 / ms,
+			host.Batches ? (double)host.Records / host.Batches : 0.0,
+			host.Records ? (double)host.LatSum / host.Records / HOST_US : 0.0,
+			(double)host.LatMax / HOST_US);
+	if (sc->downlink != HOST_NONE) {
+		printf("  down %4.0f/%4.0f us",
+				host.DlRecords ? (double)host.DlLatSum / host.DlRecords / HOST_US : 0.0,
+				(double)host.DlLatMax / HOST_US);
+	}
+	printf("  cpu %4.1f%%\n", 100.0 * (double)(host_busy - busy0) / (double)(GWSIM_Now() - start));
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+int main(void)
+{
+	USBSIM_STATS_Type ust;
+	GWSIM_STATS_Type st;
+	uint32_t i;
+
+	USBSIM_Init();
+	GWSIM_Init();
+	GWSIM_OnEthTx(host_EthTx);
+	GWSIM_OnCanTx(host_CanTx);
+	GW_Setup();
+	host_Enumerate();
+
+	printf("scenario        bus   uplink frames, batches    latency avg/max"
+			"  (downlink)  processor\n");
+	for (i = 0; i < sizeof(host_scenario) / sizeof(host_scenario[0]); i++) {
+		host_Run(&host_scenario[i]);
+	}
+
+	USBSIM_GetStats(&ust);
+	GWSIM_GetStats(&st);
+	if (ust.Violations != 0) {
+		fprintf(stderr, "FAIL: %s\n", USBSIM_Violation());
+		return 1;
+	}
+	printf("%u register accesses, %u instructions\n",
+			(unsigned)st.Accesses, (unsigned)st.Instructions);
+	printf("PASS\n");
+	return 0;
+}
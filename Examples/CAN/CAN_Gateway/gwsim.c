@@ -0,0 +1,1247 @@
+/**********************************************************************
+* $Id$		gwsim.c				2011-03-09
+*//**
+* @file		gwsim.c
+* @brief	Host model of the CAN gateway hardware. The register pages of
+* 			CAN1, CAN2, TIMER0, the EMAC and the NVIC are mapped without
+* 			access rights: each access of the drivers faults, is
+* 			prepared by the model, single-stepped and applied, as in
+* 			usbsim.c whose traps are chained behind these ones. Time is
+* 			counted in core clock cycles: one per instruction traced
+* 			between GWSIM_Start() and GWSIM_Stop(), GWSIM_APB_WAIT more
+* 			per register access, and the idle time the test loop skips
+* 			with GWSIM_Advance(). Each CAN bus carries the frames of a
+* 			periodic external node and of its controller, arbitrated by
+* 			identifier; bit stuffing is not modelled. The EMAC sends
+* 			its frames on a 100 Mbps wire. x86-64 Linux only.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "LPC17xx.h"
+#include "lpc17xx_can.h"
+#include "lpc17xx_emac.h"
+#include "gwsim.h"
+
+/* Model parameters */
+#define SIM_PAGE_SZ			0x00001000UL
+#define SIM_NVIC_ADR		0xE000E000UL	/* NVIC and SCB page, trapped */
+#define SIM_USB_ADR			LPC_USB_BASE	/* Trapped by usbsim.c */
+#define SIM_CAN_NUM			2
+#define SIM_RXTIME_NUM		8192			/* Receive times kept per bus */
+#define SIM_CAN_RATIO		(GWSIM_CCLK / GWSIM_CAN_PCLK)
+#define SIM_TIM_RATIO		(GWSIM_CCLK / GWSIM_TIM_PCLK)
+#define SIM_NEVER			(~(uint64_t)0)
+
+/* Trapped pages */
+#define SIM_PG_CAN1			0
+#define SIM_PG_CAN2			1
+#define SIM_PG_TIM0			2
+#define SIM_PG_EMAC			3
+#define SIM_PG_NVIC			4
+#define SIM_PAGE_NUM		5
+
+/* Register offsets */
+#define SIM_CAN(reg)		offsetof(LPC_CAN_TypeDef, reg)
+#define SIM_TIM(reg)		offsetof(LPC_TIM_TypeDef, reg)
+#define SIM_EMAC(reg)		offsetof(LPC_EMAC_TypeDef, reg)
+#define SIM_NVIC_ISER		0x100
+#define SIM_NVIC_ICER		0x180
+
+/* x86-64 trap flag and page fault error code */
+#define SIM_EFL_TF			0x00000100
+#define SIM_ERR_WRITE		0x00000002
+
+/* CAN frame bits: SOF to intermission, without data and stuff bits */
+#define SIM_STD_BITS		47
+#define SIM_EXT_BITS		67
+#define SIM_IFS_BITS		3
+
+/* Ethernet: preamble, FCS and inter packet gap bytes; minimum frame
+ * without FCS; core clock cycles per bit at 100 Mbps */
+#define SIM_ETH_OVERHEAD	24
+#define SIM_ETH_MIN			60
+#define SIM_ETH_BIT			(GWSIM_CCLK / 100000000UL)
+
+/* PHY registers after reset: 100 Mbps full duplex, link up */
+#define SIM_PHY_BMCR		0x3100
+#define SIM_PHY_BMSR		0x782D
+#define SIM_PHY_STS			0x0015
+
+/* Frame on a bus */
+#define SIM_WIRE_NONE		(-1)
+#define SIM_WIRE_EXT		3
+
+/** CAN controller, its bus and the external node */
+typedef struct {
+	/* Controller */
+	uint32_t mod;
+	uint32_t ier;
+	uint32_t icr;			/* Latched interrupts, RI follows the buffer */
+	uint32_t btr;
+	uint32_t ewl;
+	uint32_t rxnum;			/* Frames in the double receive buffer */
+	GWSIM_FRAME_Type rx[2];
+	uint32_t dos;
+	uint32_t tx[3][4];		/* TFI, TID, TDA, TDB */
+	uint32_t tbs;			/* Transmit buffers released, one bit each */
+	uint32_t tcs;			/* Last transmission of the buffer completed */
+	uint32_t treq;			/* Transmission requested */
+	uint64_t treqtime[3];
+	/* Bus */
+	int32_t wire;			/* Frame on the bus: SIM_WIRE_xxx or buffer */
+	GWSIM_FRAME_Type frame;
+	uint64_t start;
+	uint64_t end;
+	uint64_t idle;			/* Bus idle from */
+	/* External node */
+	uint32_t period;		/* Cycles between frames, 0: silent */
+	uint32_t extseq;		/* Next frame */
+	uint64_t extready;		/* Time the next frame is due */
+	uint64_t rxtime[SIM_RXTIME_NUM];
+} SIM_CAN_Type;
+
+static const uintptr_t sim_base[SIM_PAGE_NUM] = {
+	LPC_CAN1_BASE, LPC_CAN2_BASE, LPC_TIM0_BASE, LPC_EMAC_BASE, SIM_NVIC_ADR
+};
+
+static SIM_CAN_Type sim_can[SIM_CAN_NUM];
+
+/* TIMER0: TC counts from tc at cycle base */
+static struct {
+	uint32_t reg[SIM_PAGE_SZ / 4];
+	uint32_t tcr;
+	uint32_t pr;
+	uint32_t tc;
+	uint64_t base;
+} sim_tim;
+
+/* EMAC: registers, PHY, frame on the wire */
+static uint32_t sim_emac[SIM_PAGE_SZ / 4];
+static uint16_t sim_phy[32];
+static uint32_t sim_mrdd;
+static uint32_t sim_txbusy;
+static uint64_t sim_txend;
+
+static uint32_t sim_iser;
+static uint32_t sim_nvic[SIM_PAGE_SZ / 4];
+
+/* Access being single-stepped */
+static volatile int sim_inhandler;
+static volatile int sim_chained;
+static volatile int sim_trace;
+static uint32_t sim_page;
+static uint32_t sim_ofs;
+static uint32_t sim_write;
+static uint32_t sim_before;
+
+/* Time, core clock cycles */
+static uint64_t sim_cycle;
+
+static struct sigaction sim_oldsegv;
+static struct sigaction sim_oldtrap;
+static GWSIM_CANTX_FUNC sim_cantx;
+static GWSIM_ETHTX_FUNC sim_ethtx;
+static GWSIM_STATS_Type sim_stats;
+static char sim_violation[160];
+
+#define SIM_E(reg)			sim_emac[SIM_EMAC(reg) / 4]
+
+/* Private Functions ---------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Count a programming error of the drivers, keep the first
+ * @param[in]	msg		Description
+ * @return 		None
+ **********************************************************************/
+static void sim_Violation(const char *msg)
+{
+	if (sim_stats.Violations++ == 0) {
+		snprintf(sim_violation, sizeof(sim_violation),
+				"%s (register 0x%08lX, cycle %llu)", msg,
+				(unsigned long)(sim_base[sim_page] + sim_ofs),
+				(unsigned long long)sim_cycle);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register of a trapped page
+ * @param[in]	page	Page index
+ * @param[in]	ofs		Register offset
+ * @return 		Register
+ **********************************************************************/
+static volatile uint32_t *sim_Reg(uint32_t page, uint32_t ofs)
+{
+	return (volatile uint32_t *)(sim_base[page] + ofs);
+}
+
+/*********************************************************************//**
+ * @brief		Bit time of a CAN bus, core clock cycles
+ * @param[in]	c		Controller
+ * @return 		Cycles
+ **********************************************************************/
+static uint32_t sim_BitCycles(SIM_CAN_Type *c)
+{
+	return ((c->btr & 0x3FF) + 1) * (((c->btr >> 16) & 0x0F) +
+			((c->btr >> 20) & 0x07) + 3) * SIM_CAN_RATIO;
+}
+
+/*********************************************************************//**
+ * @brief		Length of a frame, intermission excluded
+ * @param[in]	f		Frame
+ * @return 		Bits
+ **********************************************************************/
+static uint32_t sim_FrameBits(const GWSIM_FRAME_Type *f)
+{
+	uint32_t bits;
+
+	bits = f->ext ? SIM_EXT_BITS : SIM_STD_BITS;
+	if (!f->rtr) {
+		bits += 8 * f->dlc;
+	}
+	return bits;
+}
+
+/*********************************************************************//**
+ * @brief		Arbitration field of a frame as a number: the lowest
+ * 				one wins the bus
+ * @param[in]	f		Frame
+ * @return 		Key
+ **********************************************************************/
+static uint32_t sim_Key(const GWSIM_FRAME_Type *f)
+{
+	if (f->ext) {
+		/* Base ID, SRR, IDE, extended ID, RTR */
+		return ((f->id >> 18) << 21) | (3UL << 19) | ((f->id & 0x3FFFF) << 1) | f->rtr;
+	}
+	/* Base ID, RTR, IDE */
+	return (f->id << 21) | ((uint32_t)f->rtr << 20);
+}
+
+/*********************************************************************//**
+ * @brief		Frame held in a transmit buffer
+ * @param[in]	c		Controller
+ * @param[in]	n		Buffer
+ * @param[out]	f		Frame
+ * @return 		None
+ **********************************************************************/
+static void sim_TxFrame(SIM_CAN_Type *c, uint32_t n, GWSIM_FRAME_Type *f)
+{
+	uint32_t tfi = c->tx[n][0];
+
+	f->ext = (tfi & CAN_TFI_FF) ? 1 : 0;
+	f->rtr = (tfi & CAN_TFI_RTR) ? 1 : 0;
+	f->dlc = (tfi >> 16) & 0x0F;
+	if (f->dlc > 8) {
+		f->dlc = 8;
+	}
+	f->id = c->tx[n][1] & (f->ext ? 0x1FFFFFFF : 0x7FF);
+	f->dataA = c->tx[n][2];
+	f->dataB = c->tx[n][3];
+}
+
+/*********************************************************************//**
+ * @brief		Transmit buffer that contends for the bus: lowest TFI
+ * 				priority in transmit priority mode, lowest identifier
+ * 				otherwise, the lowest buffer on ties
+ * @param[in]	c		Controller
+ * @param[in]	t		Time of the arbitration
+ * @return 		Buffer, -1 if none is requested
+ **********************************************************************/
+static int32_t sim_TxSelect(SIM_CAN_Type *c, uint64_t t)
+{
+	GWSIM_FRAME_Type f;
+	uint32_t n, prio, best;
+	int32_t sel = -1;
+
+	if (c->mod & CAN_MOD_RM) {
+		return -1;
+	}
+	best = 0;
+	for (n = 0; n < 3; n++) {
+		if (((c->treq & (1UL << n)) == 0) || (c->treqtime[n] > t)) {
+			continue;
+		}
+		if (c->mod & CAN_MOD_TPM) {
+			prio = c->tx[n][0] & 0xFF;
+		} else {
+			sim_TxFrame(c, n, &f);
+			prio = sim_Key(&f);
+		}
+		if ((sel < 0) || (prio < best)) {
+			sel = (int32_t)n;
+			best = prio;
+		}
+	}
+	return sel;
+}
+
+/*********************************************************************//**
+ * @brief		Time of the next event of a bus: end of the frame on it,
+ * 				or start of the next frame
+ * @param[in]	c		Controller
+ * @return 		Time, SIM_NEVER if none
+ **********************************************************************/
+static uint64_t sim_CanNext(SIM_CAN_Type *c)
+{
+	uint64_t t = SIM_NEVER;
+	uint32_t n;
+
+	if (c->wire != SIM_WIRE_NONE) {
+		return c->end;
+	}
+	if (c->period != 0) {
+		t = c->extready;
+	}
+	if ((c->mod & CAN_MOD_RM) == 0) {
+		for (n = 0; n < 3; n++) {
+			if ((c->treq & (1UL << n)) && (c->treqtime[n] < t)) {
+				t = c->treqtime[n];
+			}
+		}
+	}
+	if ((t != SIM_NEVER) && (t < c->idle)) {
+		t = c->idle;
+	}
+	return t;
+}
+
+/*********************************************************************//**
+ * @brief		Bus event: arbitrate the next frame, or complete the
+ * 				frame on the bus
+ * @param[in]	bus		Bus number
+ * @return 		None
+ **********************************************************************/
+static void sim_CanEvent(uint32_t bus)
+{
+	SIM_CAN_Type *c = &sim_can[bus];
+	GWSIM_FRAME_Type own;
+	uint64_t t;
+	uint32_t bit;
+	int32_t n;
+
+	if (c->wire == SIM_WIRE_NONE) {
+		/* Arbitration: the external node and the selected buffer */
+		t = sim_CanNext(c);
+		n = sim_TxSelect(c, t);
+		if (n >= 0) {
+			sim_TxFrame(c, (uint32_t)n, &own);
+		}
+		if ((c->period != 0) && (c->extready <= t)) {
+			GWSIM_ExtFrame(c->extseq, &c->frame);
+			if ((n < 0) || (sim_Key(&c->frame) < sim_Key(&own))) {
+				n = SIM_WIRE_EXT;
+			}
+		}
+		if (n != SIM_WIRE_EXT) {
+			c->frame = own;
+		}
+		c->wire = n;
+		c->start = t;
+		c->end = t + sim_FrameBits(&c->frame) * sim_BitCycles(c);
+		return;
+	}
+
+	/* End of frame */
+	c->idle = c->end + SIM_IFS_BITS * sim_BitCycles(c);
+	sim_stats.CanBusy[bus] += c->idle - c->start;
+	if (c->wire == SIM_WIRE_EXT) {
+		c->rxtime[c->extseq & (SIM_RXTIME_NUM - 1)] = c->end;
+		c->extseq++;
+		c->extready += c->period;
+		sim_stats.CanRx[bus]++;
+		if (c->mod & CAN_MOD_RM) {
+			sim_stats.CanOverrun[bus]++;
+		} else if (c->rxnum < 2) {
+			c->rx[c->rxnum++] = c->frame;
+		} else {
+			c->dos = 1;
+			if (c->ier & CAN_IER_DOIE) {
+				c->icr |= CAN_ICR_DOI;
+			}
+			sim_stats.CanOverrun[bus]++;
+		}
+	} else {
+		bit = 1UL << c->wire;
+		c->treq &= ~bit;
+		c->tbs |= bit;
+		c->tcs |= bit;
+		if (c->wire == 0) {
+			c->icr |= c->ier & CAN_IER_TIE1;
+		} else {
+			c->icr |= c->ier & ((c->wire == 1) ? CAN_IER_TIE2 : CAN_IER_TIE3);
+		}
+		sim_stats.CanTx[bus]++;
+		if (sim_cantx != NULL) {
+			sim_cantx(bus, &c->frame, c->end);
+		}
+	}
+	c->wire = SIM_WIRE_NONE;
+}
+
+/*********************************************************************//**
+ * @brief		EMAC starts the frame of TxConsumeIndex if one is queued
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_EthStart(uint64_t t)
+{
+	volatile uint32_t *desc;
+	uint32_t len;
+
+	if (sim_txbusy || ((SIM_E(Command) & EMAC_CR_TX_EN) == 0) ||
+			(SIM_E(TxProduceIndex) == SIM_E(TxConsumeIndex))) {
+		return;
+	}
+	desc = (volatile uint32_t *)(uintptr_t)(SIM_E(TxDescriptor) + SIM_E(TxConsumeIndex) * 8);
+	len = (desc[1] & EMAC_TCTRL_SIZE) + 1;
+	if ((desc[1] & EMAC_TCTRL_LAST) == 0) {
+		sim_Violation("transmit fragment without LAST, not modelled");
+	}
+	if (len < SIM_ETH_MIN) {
+		len = SIM_ETH_MIN;
+	}
+	sim_txbusy = 1;
+	sim_txend = t + (uint64_t)(len + SIM_ETH_OVERHEAD) * 8 * SIM_ETH_BIT;
+}
+
+/*********************************************************************//**
+ * @brief		EMAC frame sent: report it, release its descriptor
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_EthEnd(void)
+{
+	volatile uint32_t *desc, *stat;
+	uint32_t idx;
+
+	idx = SIM_E(TxConsumeIndex);
+	desc = (volatile uint32_t *)(uintptr_t)(SIM_E(TxDescriptor) + idx * 8);
+	stat = (volatile uint32_t *)(uintptr_t)(SIM_E(TxStatus) + idx * 4);
+	sim_stats.EthTx++;
+	if (sim_ethtx != NULL) {
+		sim_ethtx((const uint8_t *)(uintptr_t)desc[0], (desc[1] & EMAC_TCTRL_SIZE) + 1, sim_txend);
+	}
+	stat[0] = 0;
+	if (desc[1] & EMAC_TCTRL_INT) {
+		SIM_E(IntStatus) |= EMAC_INT_TX_DONE;
+	}
+	SIM_E(TxConsumeIndex) = (idx >= SIM_E(TxDescriptorNumber)) ? 0 : idx + 1;
+	sim_txbusy = 0;
+	sim_EthStart(sim_txend);
+}
+
+/*********************************************************************//**
+ * @brief		Run the bus and wire events up to a time, in order
+ * @param[in]	to		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_Run(uint64_t to)
+{
+	uint64_t t, next;
+	uint32_t bus;
+	int32_t sel;
+
+	for (;;) {
+		next = sim_txbusy ? sim_txend : SIM_NEVER;
+		sel = -1;
+		for (bus = 0; bus < SIM_CAN_NUM; bus++) {
+			t = sim_CanNext(&sim_can[bus]);
+			if (t < next) {
+				next = t;
+				sel = (int32_t)bus;
+			}
+		}
+		if ((next == SIM_NEVER) || (next > to)) {
+			return;
+		}
+		if (sel < 0) {
+			sim_EthEnd();
+		} else {
+			sim_CanEvent((uint32_t)sel);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		TIMER0 counter at a time
+ * @param[in]	t		Time, not before the last timer write
+ * @return 		TC
+ **********************************************************************/
+static uint32_t sim_TimerTc(uint64_t t)
+{
+	if (((sim_tim.tcr & 3) != 1) || (t < sim_tim.base)) {
+		return sim_tim.tc;
+	}
+	return sim_tim.tc + (uint32_t)((t - sim_tim.base) / (SIM_TIM_RATIO * (sim_tim.pr + 1)));
+}
+
+/*********************************************************************//**
+ * @brief		CAN register read: side effect once the value is taken
+ * @param[in]	c		Controller
+ * @param[in]	ofs		Register offset
+ * @return 		None
+ **********************************************************************/
+static void sim_CanRead(SIM_CAN_Type *c, uint32_t ofs)
+{
+	if (ofs == SIM_CAN(ICR)) {
+		c->icr = 0;								/* RI follows RBS */
+	}
+}
+
+/*********************************************************************//**
+ * @brief		CAN command register written
+ * @param[in]	c		Controller
+ * @param[in]	val		Command
+ * @return 		None
+ **********************************************************************/
+static void sim_CanCommand(SIM_CAN_Type *c, uint32_t val)
+{
+	uint32_t stb, n, bit;
+
+	stb = (val >> 5) & 7;
+	if (val & CAN_CMR_RRB) {
+		if (c->rxnum != 0) {
+			c->rx[0] = c->rx[1];
+			c->rxnum--;
+		}
+	}
+	if (val & CAN_CMR_CDO) {
+		c->dos = 0;
+	}
+	if (val & CAN_CMR_AT) {
+		for (n = 0; n < 3; n++) {
+			bit = 1UL << n;
+			if (((stb == 0) || (stb & bit)) && (c->treq & bit) && (c->wire != (int32_t)n)) {
+				c->treq &= ~bit;
+				c->tbs |= bit;
+				c->tcs &= ~bit;
+				if (n == 0) {
+					c->icr |= c->ier & CAN_IER_TIE1;
+				} else {
+					c->icr |= c->ier & ((n == 1) ? CAN_IER_TIE2 : CAN_IER_TIE3);
+				}
+			}
+		}
+	}
+	if (val & CAN_CMR_TR) {
+		if (stb == 0) {
+			sim_Violation("transmission request without a buffer selected");
+		}
+		if (c->mod & CAN_MOD_RM) {
+			sim_Violation("transmission request in reset mode");
+		}
+		for (n = 0; n < 3; n++) {
+			bit = 1UL << n;
+			if ((stb & bit) == 0) {
+				continue;
+			}
+			if ((c->tbs & bit) == 0) {
+				sim_Violation("transmission request on a locked buffer");
+				continue;
+			}
+			c->tbs &= ~bit;
+			c->tcs &= ~bit;
+			c->treq |= bit;
+			c->treqtime[n] = sim_cycle;
+		}
+	}
+	if (val & CAN_CMR_SRR) {
+		sim_Violation("self reception request, not modelled");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		CAN register written
+ * @param[in]	c		Controller
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_CanWrite(SIM_CAN_Type *c, uint32_t ofs, uint32_t val)
+{
+	uint32_t n;
+
+	if (ofs >= SIM_CAN(TFI1)) {
+		n = (ofs - SIM_CAN(TFI1)) / 16;
+		if ((c->tbs & (1UL << n)) == 0) {
+			sim_Violation("transmit buffer written while locked");
+			return;
+		}
+		c->tx[n][(ofs / 4) & 3] = val;
+		return;
+	}
+	switch (ofs) {
+	case SIM_CAN(MOD):
+		c->mod = val & 0xBF;
+		if (c->mod & ~(CAN_MOD_RM | CAN_MOD_TPM)) {
+			sim_Violation("operating mode not modelled");
+		}
+		break;
+	case SIM_CAN(CMR):
+		sim_CanCommand(c, val);
+		break;
+	case SIM_CAN(GSR):
+		if ((c->mod & CAN_MOD_RM) == 0) {
+			sim_Violation("error counters written out of reset mode");
+		}
+		break;
+	case SIM_CAN(IER):
+		c->ier = val & 0x7FF;
+		break;
+	case SIM_CAN(BTR):
+		if ((c->mod & CAN_MOD_RM) == 0) {
+			sim_Violation("bus timing written out of reset mode");
+		}
+		c->btr = val & 0x00FFC3FF;
+		break;
+	case SIM_CAN(EWL):
+		c->ewl = val & 0xFF;
+		break;
+	default:
+		sim_Violation("write to a read only CAN register");
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		TIMER0 register written
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_TimWrite(uint32_t ofs, uint32_t val)
+{
+	switch (ofs) {
+	case SIM_TIM(IR):
+		sim_tim.reg[ofs / 4] &= ~val;
+		break;
+	case SIM_TIM(TCR):
+		sim_tim.tc = sim_TimerTc(sim_cycle);
+		sim_tim.base = sim_cycle;
+		sim_tim.tcr = val & 3;
+		if (val & 2) {
+			sim_tim.tc = 0;
+		}
+		break;
+	case SIM_TIM(TC):
+		sim_tim.tc = val;
+		sim_tim.base = sim_cycle;
+		break;
+	case SIM_TIM(PR):
+		sim_tim.tc = sim_TimerTc(sim_cycle);
+		sim_tim.base = sim_cycle;
+		sim_tim.pr = val;
+		break;
+	case SIM_TIM(CR0):
+	case SIM_TIM(CR1):
+		sim_Violation("write to a read only timer register");
+		break;
+	default:
+		sim_tim.reg[ofs / 4] = val;
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		EMAC register written
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_EmacWrite(uint32_t ofs, uint32_t val)
+{
+	uint32_t reg;
+
+	switch (ofs) {
+	case SIM_EMAC(MCMD):
+		SIM_E(MCMD) = val;
+		if (val & EMAC_MCMD_READ) {
+			sim_mrdd = sim_phy[SIM_E(MADR) & 0x1F];
+		}
+		break;
+	case SIM_EMAC(MWTD):
+		reg = SIM_E(MADR) & 0x1F;
+		if (reg == EMAC_PHY_REG_BMCR) {
+			sim_phy[reg] = (val & EMAC_PHY_BMCR_RESET) ? SIM_PHY_BMCR : (uint16_t)val;
+		} else if ((reg != EMAC_PHY_REG_BMSR) && (reg != EMAC_PHY_REG_IDR1) &&
+				(reg != EMAC_PHY_REG_IDR2) && (reg != EMAC_PHY_REG_STS)) {
+			sim_phy[reg] = (uint16_t)val;
+		}
+		break;
+	case SIM_EMAC(Command):
+		/* Reset bits clear themselves */
+		SIM_E(Command) = val & ~(EMAC_CR_REG_RES | EMAC_CR_TX_RES | EMAC_CR_RX_RES);
+		if (val & EMAC_CR_TX_RES) {
+			SIM_E(TxProduceIndex) = 0;
+			SIM_E(TxConsumeIndex) = 0;
+			sim_txbusy = 0;
+		}
+		if (val & EMAC_CR_RX_RES) {
+			SIM_E(RxProduceIndex) = 0;
+			SIM_E(RxConsumeIndex) = 0;
+		}
+		sim_EthStart(sim_cycle);
+		break;
+	case SIM_EMAC(RxConsumeIndex):
+		if (val > SIM_E(RxDescriptorNumber)) {
+			sim_Violation("receive consume index out of range");
+		}
+		SIM_E(RxConsumeIndex) = val;
+		break;
+	case SIM_EMAC(TxProduceIndex):
+		if (val > SIM_E(TxDescriptorNumber)) {
+			sim_Violation("transmit produce index out of range");
+		}
+		SIM_E(TxProduceIndex) = val;
+		sim_EthStart(sim_cycle);
+		break;
+	case SIM_EMAC(IntClear):
+		SIM_E(IntStatus) &= ~val;
+		break;
+	case SIM_EMAC(IntSet):
+		SIM_E(IntStatus) |= val;
+		break;
+	case SIM_EMAC(MRDD):
+	case SIM_EMAC(MIND):
+	case SIM_EMAC(Status):
+	case SIM_EMAC(RxProduceIndex):
+	case SIM_EMAC(TxConsumeIndex):
+	case SIM_EMAC(IntStatus):
+		sim_Violation("write to a read only EMAC register");
+		break;
+	default:
+		sim_emac[ofs / 4] = val;
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Refresh the readable values of a page
+ * @param[in]	page	Page index
+ * @return 		None
+ **********************************************************************/
+static void sim_Publish(uint32_t page)
+{
+	SIM_CAN_Type *c;
+	uint32_t n, sr, tbs, tcs, ts;
+
+	switch (page) {
+	case SIM_PG_TIM0:
+		memcpy((void *)sim_base[page], sim_tim.reg, SIM_PAGE_SZ);
+		*sim_Reg(page, SIM_TIM(TCR)) = sim_tim.tcr;
+		*sim_Reg(page, SIM_TIM(PR)) = sim_tim.pr;
+		*sim_Reg(page, SIM_TIM(TC)) = sim_TimerTc(sim_cycle);
+		return;
+	case SIM_PG_EMAC:
+		memcpy((void *)sim_base[page], sim_emac, SIM_PAGE_SZ);
+		*sim_Reg(page, SIM_EMAC(MRDD)) = sim_mrdd;
+		*sim_Reg(page, SIM_EMAC(MIND)) = 0;
+		*sim_Reg(page, SIM_EMAC(Status)) = ((SIM_E(Command) & EMAC_CR_RX_EN) ? 1 : 0) |
+				(sim_txbusy ? 2 : 0);
+		return;
+	case SIM_PG_NVIC:
+		memcpy((void *)sim_base[page], sim_nvic, SIM_PAGE_SZ);
+		*sim_Reg(page, SIM_NVIC_ISER) = sim_iser;
+		*sim_Reg(page, SIM_NVIC_ICER) = sim_iser;
+		return;
+	default:
+		break;
+	}
+
+	c = &sim_can[page];
+	memset((void *)sim_base[page], 0, SIM_PAGE_SZ);
+	ts = (c->wire >= 0) && (c->wire < SIM_WIRE_EXT) ? (1UL << c->wire) : 0;
+	sr = 0;
+	for (n = 0; n < 3; n++) {
+		sr |= (((c->rxnum != 0) ? CAN_SR_RBS : 0) | (c->dos ? CAN_SR_DOS : 0) |
+				((c->tbs & (1UL << n)) ? CAN_SR_TBS1 : 0) |
+				((c->tcs & (1UL << n)) ? CAN_SR_TCS1 : 0) |
+				((ts & (1UL << n)) ? CAN_SR_TS1 : 0)) << (n * 8);
+	}
+	tbs = (c->tbs == 7) ? CAN_GSR_TBS : 0;
+	tcs = (c->tcs == 7) ? CAN_GSR_TCS : 0;
+	*sim_Reg(page, SIM_CAN(MOD)) = c->mod;
+	*sim_Reg(page, SIM_CAN(GSR)) = ((c->rxnum != 0) ? CAN_GSR_RBS : 0) |
+			(c->dos ? CAN_GSR_DOS : 0) | tbs | tcs | (ts ? CAN_GSR_TS : 0);
+	*sim_Reg(page, SIM_CAN(ICR)) = c->icr |
+			(((c->rxnum != 0) && (c->ier & CAN_IER_RIE)) ? CAN_ICR_RI : 0);
+	*sim_Reg(page, SIM_CAN(IER)) = c->ier;
+	*sim_Reg(page, SIM_CAN(BTR)) = c->btr;
+	*sim_Reg(page, SIM_CAN(EWL)) = c->ewl;
+	*sim_Reg(page, SIM_CAN(SR)) = sr;
+	if (c->rxnum != 0) {
+		*sim_Reg(page, SIM_CAN(RFS)) = CAN_RFS_BP | ((uint32_t)c->rx[0].dlc << 16) |
+				(c->rx[0].rtr ? CAN_RFS_RTR : 0) | (c->rx[0].ext ? CAN_RFS_FF : 0);
+		*sim_Reg(page, SIM_CAN(RID)) = c->rx[0].id;
+		*sim_Reg(page, SIM_CAN(RDA)) = c->rx[0].dataA;
+		*sim_Reg(page, SIM_CAN(RDB)) = c->rx[0].dataB;
+	}
+	for (n = 0; n < 12; n++) {
+		*sim_Reg(page, SIM_CAN(TFI1) + n * 4) = c->tx[n / 4][n & 3];
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register page fault: bring the model to the time of the
+ * 				access, prepare it, single-step it. Accesses to the USB
+ * 				controller go on to usbsim.c
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Fault(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uintptr_t adr = (uintptr_t)si->si_addr;
+	uint32_t page;
+
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		if ((adr >= sim_base[page]) && (adr < sim_base[page] + SIM_PAGE_SZ)) {
+			break;
+		}
+	}
+	if (sim_inhandler || sim_chained) {
+		signal(SIGSEGV, SIG_DFL);				/* Real fault: faults again */
+		return;
+	}
+	sim_cycle += GWSIM_APB_WAIT;
+	sim_stats.Accesses++;
+	if (page == SIM_PAGE_NUM) {
+		if ((adr < SIM_USB_ADR) || (adr >= SIM_USB_ADR + SIM_PAGE_SZ)) {
+			signal(SIGSEGV, SIG_DFL);
+			return;
+		}
+		sim_chained = 1;
+		sim_oldsegv.sa_sigaction(sig, si, ctx);
+		return;
+	}
+	sim_inhandler = 1;
+	sim_page = page;
+	mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE);
+	sim_ofs = (uint32_t)(adr - sim_base[page]);
+	sim_write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_ERR_WRITE) != 0;
+	if ((sim_ofs & 3) && (page != SIM_PG_NVIC)) {
+		sim_Violation("unaligned register access");
+	}
+	sim_ofs &= ~3UL;
+	sim_Run(sim_cycle);
+	sim_Publish(page);
+	sim_before = *sim_Reg(page, sim_ofs);
+	if ((page < SIM_CAN_NUM) && !sim_write) {
+		sim_CanRead(&sim_can[page], sim_ofs);
+	}
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Single step: apply a register access that is done, count
+ * 				an instruction of the traced code
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Step(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uint32_t val, page;
+
+	if (sim_inhandler) {
+		page = sim_page;
+		val = *sim_Reg(page, sim_ofs);
+		/* Read-modify-write instructions may fault as a read */
+		if (page == SIM_PG_NVIC) {
+			if ((sim_ofs >= SIM_NVIC_ISER) && (sim_ofs < SIM_NVIC_ISER + 0x20)) {
+				if ((sim_ofs == SIM_NVIC_ISER) && (sim_write || (val != sim_before))) {
+					sim_iser |= val;
+				}
+			} else if ((sim_ofs >= SIM_NVIC_ICER) && (sim_ofs < SIM_NVIC_ICER + 0x20)) {
+				if ((sim_ofs == SIM_NVIC_ICER) && (sim_write || (val != sim_before))) {
+					sim_iser &= ~val;
+				}
+			} else {
+				memcpy(sim_nvic, (void *)sim_base[page], SIM_PAGE_SZ);
+			}
+		} else if (sim_write || (val != sim_before)) {
+			if (page < SIM_CAN_NUM) {
+				sim_CanWrite(&sim_can[page], sim_ofs, val);
+			} else if (page == SIM_PG_TIM0) {
+				sim_TimWrite(sim_ofs, val);
+			} else {
+				sim_EmacWrite(sim_ofs, val);
+			}
+		}
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+		sim_inhandler = 0;
+	} else if (sim_chained) {
+		sim_chained = 0;
+		sim_oldtrap.sa_sigaction(sig, si, ctx);
+	}
+	if (sim_trace) {
+		sim_stats.Instructions++;
+		sim_cycle++;
+		uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+	} else {
+		uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFL_TF;
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Map the register pages and install the access traps in
+ * 				front of the ones of usbsim.c, to be called after
+ * 				USBSIM_Init(). Controllers in reset mode with their
+ * 				transmit buffers released, buses idle and silent
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void GWSIM_Init(void)
+{
+	static const uintptr_t plain[3] = {
+		LPC_CANAF_RAM_BASE, LPC_CANAF_BASE, LPC_CANCR_BASE
+	};
+	struct sigaction sa;
+	uint32_t page, n;
+	void *p;
+
+	memset(sim_can, 0, sizeof(sim_can));
+	for (n = 0; n < SIM_CAN_NUM; n++) {
+		sim_can[n].mod = CAN_MOD_RM;
+		sim_can[n].btr = 0x001C0000;
+		sim_can[n].tbs = 7;
+		sim_can[n].tcs = 7;
+		sim_can[n].wire = SIM_WIRE_NONE;
+	}
+	memset(sim_phy, 0, sizeof(sim_phy));
+	sim_phy[EMAC_PHY_REG_BMCR] = SIM_PHY_BMCR;
+	sim_phy[EMAC_PHY_REG_BMSR] = SIM_PHY_BMSR;
+	sim_phy[EMAC_PHY_REG_IDR1] = EMAC_DP83848C_ID >> 16;
+	sim_phy[EMAC_PHY_REG_IDR2] = EMAC_DP83848C_ID & 0xFFFF;
+	sim_phy[EMAC_PHY_REG_STS] = SIM_PHY_STS;
+
+	/* Acceptance filter: memory only */
+	for (n = 0; n < 3; n++) {
+		p = mmap((void *)plain[n], SIM_PAGE_SZ, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (p != (void *)plain[n]) {
+			fprintf(stderr, "gwsim: cannot map 0x%08lX\n", (unsigned long)plain[n]);
+			exit(2);
+		}
+	}
+	/* Register pages; the NVIC page is mapped by usbsim.c */
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		if (page == SIM_PG_NVIC) {
+			memcpy(sim_nvic, (void *)sim_base[page], SIM_PAGE_SZ);
+		} else {
+			p = mmap((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+			if (p != (void *)sim_base[page]) {
+				fprintf(stderr, "gwsim: cannot map 0x%08lX\n", (unsigned long)sim_base[page]);
+				exit(2);
+			}
+		}
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sim_Fault;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, &sim_oldsegv);
+	sa.sa_sigaction = sim_Step;
+	sigaction(SIGTRAP, &sa, &sim_oldtrap);
+}
+
+/*********************************************************************//**
+ * @brief		Frame of the external node: standard identifiers 0x100
+ * 				to 0x17F, every 4th frame extended from 0x01000000,
+ * 				every 16th a remote frame, data length seq % 9, data
+ * 				bytes seq and ~seq
+ * @param[in]	seq		Frame number
+ * @param[out]	frame	Frame
+ * @return 		None
+ **********************************************************************/
+void GWSIM_ExtFrame(uint32_t seq, GWSIM_FRAME_Type *frame)
+{
+	static const uint32_t mask[5] = {0, 0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF};
+
+	frame->ext = ((seq & 3) == 3) ? 1 : 0;
+	frame->id = frame->ext ? (0x01000000 | (seq & 0xFFFF)) : (0x100 | (seq & 0x7F));
+	frame->rtr = ((seq & 15) == 14) ? 1 : 0;
+	frame->dlc = (uint8_t)(seq % 9);
+	if (frame->rtr) {
+		frame->dataA = 0;
+		frame->dataB = 0;
+	} else {
+		frame->dataA = seq & mask[(frame->dlc > 4) ? 4 : frame->dlc];
+		frame->dataB = ~seq & mask[(frame->dlc > 4) ? frame->dlc - 4 : 0];
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Bus time of a frame and its intermission, at the current
+ * 				bit timing of the bus
+ * @param[in]	bus		Bus number
+ * @param[in]	frame	Frame
+ * @return 		Core clock cycles
+ **********************************************************************/
+uint32_t GWSIM_FrameCycles(uint32_t bus, const GWSIM_FRAME_Type *frame)
+{
+	return (sim_FrameBits(frame) + SIM_IFS_BITS) * sim_BitCycles(&sim_can[bus]);
+}
+
+/*********************************************************************//**
+ * @brief		Start or stop the external node of a bus: a frame is
+ * 				due every period cycles from now, sent as soon as it
+ * 				wins the bus
+ * @param[in]	bus		Bus number
+ * @param[in]	period	Cycles between frames, 0 to stop
+ * @return 		None
+ **********************************************************************/
+void GWSIM_CanTraffic(uint32_t bus, uint32_t period)
+{
+	sim_can[bus].period = period;
+	sim_can[bus].extready = sim_cycle;
+}
+
+/*********************************************************************//**
+ * @brief		Time a frame of the external node was received: end of
+ * 				its last bit
+ * @param[in]	bus		Bus number
+ * @param[in]	seq		Frame number, one of the last SIM_RXTIME_NUM
+ * @return 		Time
+ **********************************************************************/
+uint64_t GWSIM_CanRxTime(uint32_t bus, uint32_t seq)
+{
+	return sim_can[bus].rxtime[seq & (SIM_RXTIME_NUM - 1)];
+}
+
+/*********************************************************************//**
+ * @brief		Set the function told of each frame a controller sends
+ * @param[in]	func	Function, NULL for none
+ * @return 		None
+ **********************************************************************/
+void GWSIM_OnCanTx(GWSIM_CANTX_FUNC func)
+{
+	sim_cantx = func;
+}
+
+/*********************************************************************//**
+ * @brief		Set the function told of each frame the EMAC sends
+ * @param[in]	func	Function, NULL for none
+ * @return 		None
+ **********************************************************************/
+void GWSIM_OnEthTx(GWSIM_ETHTX_FUNC func)
+{
+	sim_ethtx = func;
+}
+
+/*********************************************************************//**
+ * @brief		Frame received by the EMAC now, its last bit arrived:
+ * 				stored in the next receive descriptor with its FCS
+ * @param[in]	frame	Frame without FCS
+ * @param[in]	len		Frame length
+ * @return 		1 if stored, 0 if dropped for want of a descriptor or
+ * 				with receive disabled
+ **********************************************************************/
+uint32_t GWSIM_EthRx(const uint8_t *frame, uint32_t len)
+{
+	volatile uint32_t *desc, *stat;
+	uint32_t idx, next;
+
+	sim_stats.EthRx++;
+	idx = SIM_E(RxProduceIndex);
+	next = (idx >= SIM_E(RxDescriptorNumber)) ? 0 : idx + 1;
+	if (((SIM_E(Command) & EMAC_CR_RX_EN) == 0) || ((SIM_E(MAC1) & EMAC_MAC1_REC_EN) == 0) ||
+			(next == SIM_E(RxConsumeIndex))) {
+		sim_stats.EthRxDrop++;
+		return 0;
+	}
+	desc = (volatile uint32_t *)(uintptr_t)(SIM_E(RxDescriptor) + idx * 8);
+	stat = (volatile uint32_t *)(uintptr_t)(SIM_E(RxStatus) + idx * 8);
+	if (len + 4 > (desc[1] & EMAC_RCTRL_SIZE(0xFFFFFFFF)) + 1) {
+		sim_stats.EthRxDrop++;
+		return 0;
+	}
+	memcpy((void *)(uintptr_t)desc[0], frame, len);
+	memset((uint8_t *)(uintptr_t)desc[0] + len, 0, 4);
+	stat[0] = EMAC_RINFO_LAST_FLAG | (len + 4 - 1);
+	stat[1] = 0;
+	SIM_E(RxProduceIndex) = next;
+	if (desc[1] & EMAC_RCTRL_INT) {
+		SIM_E(IntStatus) |= EMAC_INT_RX_DONE;
+	}
+	return 1;
+}
+
+/*********************************************************************//**
+ * @brief		EMAC transmit side idle: no frame queued or on the wire
+ * @param[in]	None
+ * @return 		Non zero if idle
+ **********************************************************************/
+uint32_t GWSIM_EthIdle(void)
+{
+	return !sim_txbusy && (SIM_E(TxProduceIndex) == SIM_E(TxConsumeIndex));
+}
+
+/*********************************************************************//**
+ * @brief		Interrupt enabled in the NVIC
+ * @param[in]	irq		Interrupt number
+ * @return 		Non zero if enabled
+ **********************************************************************/
+uint32_t GWSIM_IrqEnabled(uint32_t irq)
+{
+	return sim_iser & (1UL << irq);
+}
+
+/*********************************************************************//**
+ * @brief		CAN interrupt request line, shared by both controllers
+ * @param[in]	None
+ * @return 		Non zero if the interrupt is requested
+ **********************************************************************/
+uint32_t GWSIM_CanIrqPending(void)
+{
+	SIM_CAN_Type *c;
+	uint32_t n;
+
+	for (n = 0; n < SIM_CAN_NUM; n++) {
+		c = &sim_can[n];
+		if ((c->icr != 0) || ((c->rxnum != 0) && (c->ier & CAN_IER_RIE))) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*********************************************************************//**
+ * @brief		TIMER0 counter at a time, with the current settings
+ * @param[in]	time	Time, not before the last timer write
+ * @return 		TC
+ **********************************************************************/
+uint32_t GWSIM_TimerValue(uint64_t time)
+{
+	return sim_TimerTc(time);
+}
+
+/*********************************************************************//**
+ * @brief		First time TIMER0 reaches a counter value
+ * @param[in]	tc		Counter value, ahead of the counter
+ * @return 		Time, never if the timer is stopped
+ **********************************************************************/
+uint64_t GWSIM_TimerCycle(uint32_t tc)
+{
+	if ((sim_tim.tcr & 3) != 1) {
+		return SIM_NEVER;
+	}
+	return sim_tim.base + (uint64_t)(uint32_t)(tc - sim_tim.tc) * SIM_TIM_RATIO * (sim_tim.pr + 1);
+}
+
+/*********************************************************************//**
+ * @brief		Current time
+ * @param[in]	None
+ * @return 		Core clock cycles
+ **********************************************************************/
+uint64_t GWSIM_Now(void)
+{
+	return sim_cycle;
+}
+
+/*********************************************************************//**
+ * @brief		Time of the next bus or wire event
+ * @param[in]	None
+ * @return 		Time, all ones if none
+ **********************************************************************/
+uint64_t GWSIM_NextEvent(void)
+{
+	uint64_t t, next;
+	uint32_t bus;
+
+	next = sim_txbusy ? sim_txend : SIM_NEVER;
+	for (bus = 0; bus < SIM_CAN_NUM; bus++) {
+		t = sim_CanNext(&sim_can[bus]);
+		if (t < next) {
+			next = t;
+		}
+	}
+	return next;
+}
+
+/*********************************************************************//**
+ * @brief		Let time pass with the processor idle, run the events
+ * @param[in]	time	Time to advance to, nothing if already past
+ * @return 		None
+ **********************************************************************/
+void GWSIM_Advance(uint64_t time)
+{
+	if (time > sim_cycle) {
+		sim_cycle = time;
+	}
+	sim_Run(sim_cycle);
+}
+
+/*********************************************************************//**
+ * @brief		Single-step and count the code that follows until
+ * 				GWSIM_Stop(), one cycle per instruction
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void GWSIM_Start(void)
+{
+	sim_trace = 1;
+	__asm__ volatile ("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+/*********************************************************************//**
+ * @brief		End of the counted code
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void GWSIM_Stop(void)
+{
+	sim_trace = 0;
+	__asm__ volatile ("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+/*********************************************************************//**
+ * @brief		Get the model counters
+ * @param[out]	stats	Counters
+ * @return 		None
+ **********************************************************************/
+void GWSIM_GetStats(GWSIM_STATS_Type *stats)
+{
+	*stats = sim_stats;
+}
+
+/*********************************************************************//**
+ * @brief		First programming error seen by the model
+ * @param[in]	None
+ * @return 		Description, empty if none
+ **********************************************************************/
+const char *GWSIM_Violation(void)
+{
+	return sim_violation;
+}
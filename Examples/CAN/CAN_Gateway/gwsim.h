@@ -0,0 +1,95 @@
+/**********************************************************************
+* $Id$		gwsim.h				2011-03-09
+*//**
+* @file		gwsim.h
+* @brief	Host model of the CAN gateway hardware: CAN1/CAN2 with their
+* 			buses and external nodes, TIMER0, the EMAC with its PHY and
+* 			a 100 Mbps wire, and the NVIC enable registers. Runs beside
+* 			the USB device controller model, time is counted in core
+* 			clock cycles
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __GWSIM_H
+#define __GWSIM_H
+
+#include <stdint.h>
+
+/** Clocks: core, and the PCLK dividers the drivers select */
+#define GWSIM_CCLK			100000000UL
+#define GWSIM_CAN_PCLK		(GWSIM_CCLK / 2)
+#define GWSIM_TIM_PCLK		(GWSIM_CCLK / 4)
+/** Wait states of a peripheral register access, core cycles */
+#define GWSIM_APB_WAIT		2
+
+/**
+ * @brief CAN frame on a bus
+ */
+typedef struct {
+	uint32_t id;			/**< Identifier, 11 or 29 bits */
+	uint8_t ext;			/**< Extended identifier */
+	uint8_t rtr;			/**< Remote frame */
+	uint8_t dlc;			/**< Data length code, 0 to 8 */
+	uint32_t dataA;			/**< Data bytes 1-4, 0 beyond dlc */
+	uint32_t dataB;			/**< Data bytes 5-8, 0 beyond dlc */
+} GWSIM_FRAME_Type;
+
+/** Frame sent by a CAN controller, at the end of its last bit */
+typedef void (*GWSIM_CANTX_FUNC)(uint32_t bus, const GWSIM_FRAME_Type *frame, uint64_t time);
+/** Frame sent by the EMAC, at the end of its last bit */
+typedef void (*GWSIM_ETHTX_FUNC)(const uint8_t *frame, uint32_t len, uint64_t time);
+
+/**
+ * @brief Model counters
+ */
+typedef struct {
+	uint32_t Accesses;		/**< Register accesses, USB controller included */
+	uint32_t Instructions;	/**< Instructions single-stepped */
+	uint32_t Violations;	/**< Programming errors seen by the model */
+	uint32_t CanRx[2];		/**< Frames of the external node received */
+	uint32_t CanOverrun[2];	/**< Of them lost, receive buffer full */
+	uint32_t CanTx[2];		/**< Frames sent by the controller */
+	uint64_t CanBusy[2];	/**< Cycles of frames and intermissions */
+	uint32_t EthTx;			/**< Frames sent by the EMAC */
+	uint32_t EthRx;			/**< Frames given to the EMAC */
+	uint32_t EthRxDrop;		/**< Of them dropped, no free descriptor */
+} GWSIM_STATS_Type;
+
+void GWSIM_Init(void);
+void GWSIM_ExtFrame(uint32_t seq, GWSIM_FRAME_Type *frame);
+uint32_t GWSIM_FrameCycles(uint32_t bus, const GWSIM_FRAME_Type *frame);
+void GWSIM_CanTraffic(uint32_t bus, uint32_t period);
+uint64_t GWSIM_CanRxTime(uint32_t bus, uint32_t seq);
+void GWSIM_OnCanTx(GWSIM_CANTX_FUNC func);
+void GWSIM_OnEthTx(GWSIM_ETHTX_FUNC func);
+uint32_t GWSIM_EthRx(const uint8_t *frame, uint32_t len);
+uint32_t GWSIM_EthIdle(void);
+uint32_t GWSIM_IrqEnabled(uint32_t irq);
+uint32_t GWSIM_CanIrqPending(void);
+uint32_t GWSIM_TimerValue(uint64_t time);
+uint64_t GWSIM_TimerCycle(uint32_t tc);
+uint64_t GWSIM_Now(void);
+uint64_t GWSIM_NextEvent(void);
+void GWSIM_Advance(uint64_t time);
+void GWSIM_Start(void);
+void GWSIM_Stop(void);
+void GWSIM_GetStats(GWSIM_STATS_Type *stats);
+const char *GWSIM_Violation(void);
+
+#endif /* __GWSIM_H */
@@ -1,8 +1,8 @@
 /*----------------------------------------------------------------------------
  *      U S B  -  K e r n e l
  *----------------------------------------------------------------------------
- * Name:    usbcore.h
- * Purpose: USB Core Definitions
+ * Name:    usbdesc.h
+ * Purpose: USB Descriptors Definitions
  * Version: V1.20
  *----------------------------------------------------------------------------
  *      This software is supplied "AS IS" without any warranties, express,
@@ -16,37 +16,30 @@
  * Copyright (c) 2009 Keil - An ARM Company. All rights reserved.
  *---------------------------------------------------------------------------*/
 
-#ifndef __USBCORE_H__
-#define __USBCORE_H__
+#ifndef __USBDESC_H__
+#define __USBDESC_H__
 
 
-/* USB Endpoint Data Structure */
-typedef struct _USB_EP_DATA {
-  uint8_t  *pData;
-  uint16_t Count;
-} USB_EP_DATA;
+#include "lpc17xx_usbdev.h"
 
-/* USB Core Global Variables */
-extern uint16_t USB_DeviceStatus;
-extern uint8_t  USB_DeviceAddress;
-extern uint8_t  USB_Configuration;
-extern uint32_t USB_EndPointMask;
-extern uint32_t USB_EndPointHalt;
-extern uint32_t USB_EndPointStall;
-extern uint8_t  USB_AltSetting[USB_IF_NUM];
+/* Max Packet Size of Endpoint 0 */
+#define USB_MAX_PACKET0     64
 
-/* USB Endpoint 0 Buffer */
-extern uint8_t  EP0Buf[USB_MAX_PACKET0];
+/* CDC Interfaces and Bulk Endpoint Max Packet Size */
+#define USB_CDC_CIF_NUM     0
+#define USB_CDC_DIF_NUM     1
+#define USB_CDC_BUFSIZE     64
 
-/* USB Endpoint 0 Data Info */
-extern USB_EP_DATA EP0Data;
+/* CDC Data In/Out Endpoint Address */
+#define CDC_DEP_IN          0x82
+#define CDC_DEP_OUT         0x02
 
-/* USB Setup Packet */
-extern USB_SETUP_PACKET SetupPacket;
+/* CDC Communication In Endpoint Address */
+#define CDC_CEP_IN          0x81
 
-/* USB Core Functions */
-extern void USB_ResetCore (void);
+extern const uint8_t USB_DeviceDescriptor[];
+extern const uint8_t USB_ConfigDescriptor[];
+extern const uint8_t USB_StringDescriptor[];
 
 
-
-#endif  /* __USBCORE_H__ */
+#endif  /* __USBDESC_H__ */
@@ -0,0 +1,81 @@
+/**********************************************************************
+* $Id$		aflut_gen.c				2011-03-09
+*//**
+* @file		aflut_gen.c
+* @brief	Host AFLUT generator: builds the acceptance filter Look-Up
+* 			Table of aflut_ids.h with CAN_BuildAFImage() and prints it as
+* 			a constant image (aflut_image.h) for CAN_LoadAFImage()
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "lpc17xx_can.h"
+#include "lpc17xx_clkpwr.h"
+#include "aflut_ids.h"
+
+/* Clock/power functions used by CAN_Init(), only needed to link the CAN
+ * driver on host, never called */
+void CLKPWR_ConfigPPWR (uint32_t PPType, FunctionalState NewState) {}
+void CLKPWR_SetPCLKDiv (uint32_t ClkType, uint32_t DivVal) {}
+uint32_t CLKPWR_GetPCLK (uint32_t ClkType) { return 1; }
+
+/* CHECK_PARAM failure in the driver (built in DEBUG mode) */
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "aflut_gen: check failed in %s line %u\n", (char *)file, line);
+	exit(1);
+}
+
+AF_ID_Entry IDs[AFLUT_NUM_IDS] = AFLUT_IDS;
+uint32_t lut[512];
+
+int main(void)
+{
+	AF_ImageDef img;
+	CAN_ERROR ret;
+	uint32_t i, words;
+
+	ret = CAN_BuildAFImage(IDs, AFLUT_NUM_IDS, lut, 512, &img);
+	if (ret != CAN_OK)
+	{
+		fprintf(stderr, "aflut_gen: CAN_BuildAFImage error %d\n", ret);
+		return 1;
+	}
+	words = img.ENDofTable >> 2;
+
+	printf("/* Generated by aflut_gen from aflut_ids.h, do not edit */\r\n");
+	printf("#ifndef AFLUT_IMAGE_H_\r\n#define AFLUT_IMAGE_H_\r\n\r\n");
+	printf("static const uint32_t aflut_lut[%u] = {\r\n", words ? words : 1);
+	for (i = 0; i < words; i++)
+	{
+		printf("\t0x%08X,%s", lut[i], ((i & 3) == 3) ? "\r\n" : "");
+	}
+	if (words == 0)
+		printf("\t0x00000000");
+	printf("\r\n};\r\n\r\n");
+	printf("static const AF_ImageDef aflut_image = {\r\n");
+	printf("\taflut_lut,\r\n");
+	printf("\t0x%03X, 0x%03X, 0x%03X, 0x%03X, 0x%03X,\r\n", img.SFF_sa,
+			img.SFF_GRP_sa, img.EFF_sa, img.EFF_GRP_sa, img.ENDofTable);
+	printf("\t%u, %u, %u, %u, %u\r\n", img.FC_NumEntry, img.SFF_NumEntry,
+			img.SFF_GPR_NumEntry, img.EFF_NumEntry, img.EFF_GPR_NumEntry);
+	printf("};\r\n\r\n#endif /* AFLUT_IMAGE_H_ */\r\n");
+	return 0;
+}
@@ -0,0 +1,54 @@
+/**********************************************************************
+* $Id$		aflut_ids.h				2011-03-09
+*//**
+* @file		aflut_ids.h
+* @brief	Acceptance filter ID set of CAN_aflut_image example, shared
+* 			by the host AFLUT generator (aflut_gen.c) and the target
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef AFLUT_IDS_H_
+#define AFLUT_IDS_H_
+
+/** Number of entries in AFLUT_IDS */
+#define AFLUT_NUM_IDS		16
+
+/** ID set: {controller, format, fullcan, reserved, lowerID, upperID}.
+ * Order does not matter, duplicate, overlapping and contiguous IDs are
+ * coalesced by CAN_BuildAFImage() */
+#define AFLUT_IDS	{ \
+	{CAN2_CTRL, STD_ID_FORMAT, 1, 0, 0x003, 0x003}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 1, 0, 0x001, 0x001}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 1, 0, 0x001, 0x001}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x008, 0x008}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x00A, 0x00A}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x0E0, 0x0E0}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x010, 0x010}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x011, 0x011}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x012, 0x020}, \
+	{CAN2_CTRL, STD_ID_FORMAT, 0, 0, 0x018, 0x025}, \
+	{CAN1_CTRL, STD_ID_FORMAT, 0, 0, 0x100, 0x100}, \
+	{CAN2_CTRL, EXT_ID_FORMAT, 0, 0, (3 << 11), (3 << 11)}, \
+	{CAN2_CTRL, EXT_ID_FORMAT, 0, 0, (1 << 11), (1 << 11)}, \
+	{CAN2_CTRL, EXT_ID_FORMAT, 0, 0, (9 << 11), (0x0A << 11)}, \
+	{CAN2_CTRL, EXT_ID_FORMAT, 0, 0, (0x0A << 11) + 1, (0x0C << 11)}, \
+	{CAN2_CTRL, EXT_ID_FORMAT, 0, 0, 0x1FFFFFFF, 0x1FFFFFFF}, \
+}
+
+#endif /* AFLUT_IDS_H_ */
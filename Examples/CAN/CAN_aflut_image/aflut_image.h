@@ -0,0 +1,17 @@
+/* Generated by aflut_gen from aflut_ids.h, do not edit */
+#ifndef AFLUT_IMAGE_H_
+#define AFLUT_IMAGE_H_
+
+static const uint32_t aflut_lut[9] = {
+	0x28012803,	0x01002008,	0x200A20E0,	0x20102025,
+	0x20000800,	0x20001800,	0x3FFFFFFF,	0x20004800,
+	0x20006000,
+};
+
+static const AF_ImageDef aflut_image = {
+	aflut_lut,
+	0x004, 0x00C, 0x010, 0x01C, 0x024,
+	2, 4, 1, 3, 1
+};
+
+#endif /* AFLUT_IMAGE_H_ */
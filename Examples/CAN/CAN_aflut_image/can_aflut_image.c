@@ -0,0 +1,282 @@
+/**********************************************************************
+* $Id$		can_aflut_image.c			2011-03-09
+*//**
+* @file		can_aflut_image.c
+* @brief	This example used to test loading a complete acceptance filter
+* 			Look-Up Table image, generated offline by the host AFLUT
+* 			generator or built at run time from an ID set
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_can.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+#include "debug_frmwrk.h"
+#include "aflut_ids.h"
+#include "aflut_image.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup CAN_aflut_image	CAN_aflut_image
+ * @ingroup CAN_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINTIONS*************************/
+#define CAN_TX_MSG_CNT		8
+
+/************************** PRIVATE VARIABLES *************************/
+uint8_t menu[]=
+	"********************************************************************************\n\r"
+	"Hello NXP Semiconductors \n\r"
+	"CAN demo \n\r"
+	"\t - MCU: LPC17xx \n\r"
+	"\t - Core: ARM CORTEX-M3 \n\r"
+	"\t - Communicate via: UART0 - 115200 bps \n\r"
+	"Use 2 CAN peripherals: CAN1&CAN2 to transfer data\n\r"
+	"This example tests loading a complete AF Look-up Table image \n\r"
+	"generated offline (aflut_image.h) or built at run time \n\r"
+	"********************************************************************************\n\r";
+
+/** Test messages: even ones are in ID set, odd ones are not */
+const uint32_t TxId[CAN_TX_MSG_CNT] = {
+	0x001, 0x002, 0x015, 0x026, (3 << 11), (3 << 11) + 1, (0x0B << 11), (0x0D << 11)
+};
+const uint8_t TxFormat[CAN_TX_MSG_CNT] = {
+	STD_ID_FORMAT, STD_ID_FORMAT, STD_ID_FORMAT, STD_ID_FORMAT,
+	EXT_ID_FORMAT, EXT_ID_FORMAT, EXT_ID_FORMAT, EXT_ID_FORMAT
+};
+
+CAN_MSG_Type TxMsg, RxMsg[CAN_TX_MSG_CNT];
+__IO uint32_t CANRxCount = 0;
+
+/** Run time image */
+AF_ID_Entry IDs[AFLUT_NUM_IDS] = AFLUT_IDS;
+uint32_t lut[64];
+AF_ImageDef RunTimeImage;
+
+/************************** PRIVATE FUNCTIONS *************************/
+/* CAN interrupt service routine */
+void CAN_IRQHandler(void);
+
+void PrintMessage(CAN_MSG_Type* msg);
+void SendTestMessages(void);
+void print_menu(void);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		CAN IRQ Handler
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void CAN_IRQHandler(void)
+{
+	uint8_t IntStatus;
+
+	if (CANRxCount >= CAN_TX_MSG_CNT)
+		CANRxCount = 0;
+	//check FullCAN interrupt enable or not
+	if(CAN_FullCANIntGetStatus(LPC_CANAF)== SET)
+	{	//check is FullCAN interrupt occurs or not
+		if ((CAN_FullCANPendGetStatus(LPC_CANAF,FULLCAN_IC0))
+				||(CAN_FullCANPendGetStatus(LPC_CANAF,FULLCAN_IC1)))
+		{
+			//read received FullCAN Object in Object Section
+			FCAN_ReadObj(LPC_CANAF, &RxMsg[CANRxCount]);
+			CANRxCount++;
+		}
+	}
+	/* get interrupt status
+	 * Note that: Interrupt register CANICR will be reset after read.
+	 * So function "CAN_IntGetStatus" should be call only one time
+	 */
+	IntStatus = CAN_IntGetStatus(LPC_CAN2);
+	//check receive interrupt
+	if((IntStatus>>0)&0x01)
+	{
+		CAN_ReceiveMsg(LPC_CAN2, &RxMsg[CANRxCount]);
+		CANRxCount++;
+	}
+}
+
+/*-------------------------PRIVATE FUNCTIONS----------------------------*/
+/*********************************************************************//**
+ * @brief		Print Message ID via COM1
+ * param[in]	msg: point to CAN_MSG_Type object that will be printed
+ * @return 		none
+ **********************************************************************/
+void PrintMessage(CAN_MSG_Type* CAN_Msg)
+{
+	_DBG("Message ID: ");
+	_DBH32(CAN_Msg->id);
+	if(CAN_Msg->format==STD_ID_FORMAT)
+	{
+		_DBG_(" (STANDARD)");
+	}
+	else
+		_DBG_(" (EXTENDED)");
+}
+
+/*********************************************************************//**
+ * @brief		Send test messages from CAN1 to CAN2, then print the
+ * 				messages that passed the acceptance filter
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void SendTestMessages(void)
+{
+	uint32_t i, cnt;
+
+	CANRxCount = 0;
+	TxMsg.len = 0x08;
+	TxMsg.type = DATA_FRAME;
+	TxMsg.dataA[0] = TxMsg.dataA[1] = TxMsg.dataA[2] = TxMsg.dataA[3] = 0x55;
+	TxMsg.dataB[0] = TxMsg.dataB[1] = TxMsg.dataB[2] = TxMsg.dataB[3] = 0xAA;
+	for (i = 0; i < CAN_TX_MSG_CNT; i++) {
+		TxMsg.id = TxId[i];
+		TxMsg.format = TxFormat[i];
+		CAN_SendMsg(LPC_CAN1, &TxMsg);
+		for(cnt=0;cnt<10000;cnt++); //transmit delay
+	}
+	_DBG_("Received messages (expected: 0x001, 0x015, 0x1800, 0x5800):");
+	for (i = 0; i < CANRxCount; i++) {
+		PrintMessage(&RxMsg[i]);
+	}
+	_DBG_("");
+}
+
+/*********************************************************************//**
+ * @brief		print menu
+ * @param[in]	none
+ * @return 		none
+ **********************************************************************/
+void print_menu()
+{
+	_DBG_(menu);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main CAN program body
+ * @param[in]	none
+ * @return 		int
+ **********************************************************************/
+int c_entry(void) { /* Main Program */
+	uint32_t i;
+	PINSEL_CFG_Type PinCfg;
+
+	/* Initialize debug via UART0
+	 * - 115200bps
+	 * - 8 data bit
+	 * - No parity
+	 * - 1 stop bit
+	 * - No flow control
+	 */
+	debug_frmwrk_init();
+	print_menu();
+
+	/* Pin configuration
+	 * CAN1: select P0.0 as RD1. P0.1 as TD1
+	 * CAN2: select P2.7 as RD2, P2.8 as RD2
+	 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Pinnum = 0;
+	PinCfg.Portnum = 0;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 1;
+	PINSEL_ConfigPin(&PinCfg);
+
+	PinCfg.Pinnum = 7;
+	PinCfg.Portnum = 2;
+	PINSEL_ConfigPin(&PinCfg);
+	PinCfg.Pinnum = 8;
+	PINSEL_ConfigPin(&PinCfg);
+
+	//Initialize CAN1 & CAN2
+	CAN_Init(LPC_CAN1, 125000);
+	CAN_Init(LPC_CAN2, 125000);
+
+	//Enable Receive Interrupt
+	CAN_IRQCmd(LPC_CAN2, CANINT_FCE, ENABLE);
+	CAN_IRQCmd(LPC_CAN2, CANINT_RIE, ENABLE);
+
+	//Enable CAN Interrupt
+	NVIC_EnableIRQ(CAN_IRQn);
+
+	/*-------------------------Offline generated image------------------------*/
+	_DBG_("Press '1' to load AF Look-up Table image generated offline...");_DBG_("");
+	while(_DG !='1');
+	CAN_LoadAFImage(LPC_CANAF, &aflut_image);
+	SendTestMessages();
+
+	/*-------------------------Run time built image---------------------------*/
+	_DBG_("Press '2' to build the same ID set at run time and load it...");_DBG_("");
+	while(_DG !='2');
+	if (CAN_BuildAFImage(IDs, AFLUT_NUM_IDS, lut, 64, &RunTimeImage) != CAN_OK) {
+		_DBG_("Build AF image: ERROR...");
+		while (1);
+	}
+	for (i = 0; i < (RunTimeImage.ENDofTable >> 2); i++) {
+		if ((RunTimeImage.ENDofTable != aflut_image.ENDofTable)
+			|| (RunTimeImage.lut[i] != aflut_image.lut[i])) {
+			_DBG_("Run time image differs from aflut_image.h, regenerate it!");
+			break;
+		}
+	}
+	CAN_LoadAFImage(LPC_CANAF, &RunTimeImage);
+	SendTestMessages();
+
+	_DBG_("Demo terminal !!!");
+	while (1);
+	return 1;
+}
+
+/* With ARM and GHS toolsets, the entry point is main() - this will
+   allow the linker to generate wrapper code to setup stacks, allocate
+   heap area, and initialize and copy code and data segments. For GNU
+   toolsets, the entry point is through __start() in the crt0_gnu.asm
+   file, and that startup code will setup stacks and data */
+int main(void)
+{
+    return c_entry();
+}
+
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
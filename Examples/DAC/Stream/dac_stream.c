@@ -0,0 +1,327 @@
+/**********************************************************************
+* $Id$		dac_stream.c			2011-03-09
+*//**
+* @file		dac_stream.c
+* @brief	This example describes how to use the DAC streaming player:
+* 			GPDMA plays two blocks in turn at the DAC timer rate while
+* 			a generator refills the finished one (DDS sine sweep or
+* 			sample playback)
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_dac.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+#include "debug_frmwrk.h"
+#include "arm_math.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup DAC_Stream	Stream
+ * @ingroup DAC_Examples
+ * @{
+ */
+
+/************************** PRIVATE MACROS *************************/
+/** DAC update rate: the maximum with 700uA bias */
+#define STREAM_RATE		1000000
+/** Samples per block: 0.5ms */
+#define BLOCK_SIZE		500
+/** GPDMA channel */
+#define STREAM_DMA_CH	0
+
+/** Sweep range (Hz) and step per block */
+#define SWEEP_START		100
+#define SWEEP_STOP		20000
+#define SWEEP_STEP		10
+
+/** Length of the sample table */
+#define PLAY_SIZE		64
+
+/** DDS phase increment for frequency f (Hz) */
+#define DDS_INC(f)		((uint32_t)(((uint64_t)(f) << 32) / STREAM_RATE))
+
+/************************** PRIVATE TYPES *************************/
+/** Direct digital synthesis generator */
+typedef struct {
+	uint32_t phase;			/**< Phase accumulator, 2^32 is one period */
+	uint32_t freq;			/**< Current frequency (Hz) */
+	int32_t step;			/**< Frequency change per block (Hz), 0 for a
+								 fixed frequency */
+} DDS_Type;
+
+/** Sample playback generator */
+typedef struct {
+	const int16_t* table;	/**< Samples, played in a loop */
+	uint32_t size;			/**< Number of samples */
+	uint32_t pos;			/**< Next sample */
+} PLAYBACK_Type;
+
+/************************** PRIVATE VARIABLES *************************/
+uint8_t menu[]=
+	"********************************************************************************\n\r"
+	"Hello NXP Semiconductors \n\r"
+	" DAC streaming player demo \n\r"
+	"\t - MCU: LPC17xx \n\r"
+	"\t - Core: ARM CORTEX-M3 \n\r"
+	"\t - Communicate via: UART0 - 115200bps \n\r"
+	" Two blocks played by GPDMA at 1MHz, refilled by a generator\n\r"
+	"\t - Press '1' for DDS sine sweep 100Hz to 20KHz\n\r"
+	"\t - Press '2' for sample table playback\n\r"
+	"********************************************************************************\n\r";
+
+/** Streaming player */
+DAC_STREAM_Type stream;
+uint32_t streambuf[2 * BLOCK_SIZE];
+GPDMA_LLI_Type streamlli[2];
+
+/** Generators */
+DDS_Type dds;
+PLAYBACK_Type playback;
+int16_t table[PLAY_SIZE];
+
+/************************** PRIVATE FUNCTION *************************/
+void DMA_IRQHandler (void);
+
+void DDS_Generator(void *arg, int16_t *dst, uint32_t n);
+void Playback_Generator(void *arg, int16_t *dst, uint32_t n);
+void SetGenerator(void (*gen)(void *arg, int16_t *dst, uint32_t n), void *arg);
+void print_menu(void);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		GPDMA interrupt handler sub-routine
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void DMA_IRQHandler (void)
+{
+	DAC_StreamDMAHandler(&stream);
+}
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+/*********************************************************************//**
+ * @brief		DDS generator: the phase accumulator runs on from block to
+ * 				block and the frequency only changes between blocks, so
+ * 				the sweep has no phase discontinuity
+ * @param[in]	arg		point to DDS_Type structure
+ * @param[in]	dst		q15 samples destination
+ * @param[in]	n		number of samples
+ * @return 		None
+ **********************************************************************/
+void DDS_Generator(void *arg, int16_t *dst, uint32_t n)
+{
+	DDS_Type *d = (DDS_Type *) arg;
+	uint32_t i, phase, inc;
+
+	phase = d->phase;
+	inc = DDS_INC(d->freq);
+	for (i = 0; i < n; i++) {
+		// arm_sin_q15 input: [0, 0x7FFF] is [0, 2*pi)
+		dst[i] = arm_sin_q15((q15_t)(phase >> 17));
+		phase += inc;
+	}
+	d->phase = phase;
+
+	if (d->step != 0) {
+		d->freq += d->step;
+		if (d->freq > SWEEP_STOP) {
+			d->freq = SWEEP_START;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Sample playback generator, loops over the table
+ * @param[in]	arg		point to PLAYBACK_Type structure
+ * @param[in]	dst		q15 samples destination
+ * @param[in]	n		number of samples
+ * @return 		None
+ **********************************************************************/
+void Playback_Generator(void *arg, int16_t *dst, uint32_t n)
+{
+	PLAYBACK_Type *p = (PLAYBACK_Type *) arg;
+	uint32_t i, pos;
+
+	pos = p->pos;
+	for (i = 0; i < n; i++) {
+		dst[i] = p->table[pos];
+		if (++pos == p->size) {
+			pos = 0;
+		}
+	}
+	p->pos = pos;
+}
+
+/*********************************************************************//**
+ * @brief		Change the generator, takes effect from the next refilled
+ * 				block
+ * @param[in]	gen		generator function
+ * @param[in]	arg		generator argument
+ * @return 		None
+ **********************************************************************/
+void SetGenerator(void (*gen)(void *arg, int16_t *dst, uint32_t n), void *arg)
+{
+	NVIC_DisableIRQ(DMA_IRQn);
+	stream.Generator = gen;
+	stream.arg = arg;
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		Print menu
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void print_menu(void)
+{
+	_DBG(menu);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main DAC program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	PINSEL_CFG_Type PinCfg;
+	uint32_t i;
+	uint8_t c;
+
+	/*
+	 * Init DAC pin connect
+	 * AOUT on P0.26
+	 */
+	PinCfg.Funcnum = 2;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Pinnum = 26;
+	PinCfg.Portnum = 0;
+	PINSEL_ConfigPin(&PinCfg);
+
+	/* Initialize debug via UART0
+	 * - 115200bps
+	 * - 8 data bit
+	 * - No parity
+	 * - 1 stop bit
+	 * - No flow control
+	 */
+	debug_frmwrk_init();
+
+	// print welcome screen
+	print_menu();
+
+	/* Sample table: one period of a triangle wave */
+	for (i = 0; i < PLAY_SIZE / 2; i++) {
+		table[i] = (int16_t)(-32768 + (i * 65535 / (PLAY_SIZE / 2)));
+		table[PLAY_SIZE - 1 - i] = table[i];
+	}
+	playback.table = table;
+	playback.size = PLAY_SIZE;
+	playback.pos = 0;
+
+	dds.phase = 0;
+	dds.freq = SWEEP_START;
+	dds.step = SWEEP_STEP;
+
+	/* Maximum current 700uA: 1MHz update rate */
+	DAC_Init(LPC_DAC);
+
+	/* GPDMA block section -------------------------------------------- */
+	/* Disable GPDMA interrupt */
+	NVIC_DisableIRQ(DMA_IRQn);
+	/* preemption = 1, sub-priority = 1 */
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+
+	/* Initialize GPDMA controller */
+	GPDMA_Init();
+
+	stream.DMAChannel = STREAM_DMA_CH;
+	stream.BlockSize = BLOCK_SIZE;
+	stream.Rate = STREAM_RATE;
+	stream.buf = streambuf;
+	stream.lli = streamlli;
+	stream.Generator = DDS_Generator;
+	stream.arg = &dds;
+	if (DAC_StreamInit(LPC_DAC, &stream) != SUCCESS) {
+		_DBG_("GPDMA channel is busy");
+		while (1);
+	}
+
+	/* Enable GPDMA interrupt */
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	DAC_StreamStart(LPC_DAC, &stream);
+
+	while (1) {
+		c = _DG;
+		if (c == '1') {
+			SetGenerator(DDS_Generator, &dds);
+			_DBG("DDS sweep");
+		} else if (c == '2') {
+			SetGenerator(Playback_Generator, &playback);
+			_DBG("Sample playback");
+		} else {
+			continue;
+		}
+		_DBG(" - blocks: ");
+		_DBD32(stream.blocks);
+		_DBG(" underruns: ");
+		_DBD32(stream.underrun);
+		_DBG(" errors: ");
+		_DBD32(stream.error);
+		_DBG_("");
+	}
+	DAC_StreamStop(LPC_DAC, &stream);
+	return 1;
+}
+
+/* With ARM and GHS toolsets, the entry point is main() - this will
+   allow the linker to generate wrapper code to setup stacks, allocate
+   heap area, and initialize and copy code and data segments. For GNU
+   toolsets, the entry point is through __start() in the crt0_gnu.asm
+   file, and that startup code will setup stacks and data */
+int main(void)
+{
+    return c_entry();
+}
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
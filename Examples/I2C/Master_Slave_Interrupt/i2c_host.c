@@ -0,0 +1,539 @@
+/**********************************************************************
+* $Id$		i2c_host.c			2011-03-09
+*//**
+* @file		i2c_host.c
+* @brief	Host replay test of the I2C state/action tables on the I2C
+* 			model: I2C_MasterTransferData() in interrupt mode and the
+* 			bus manager run on I2C2 against a memory device, the slave
+* 			runs on I2C0 against a scripted external master. Each
+* 			scenario checks the sequence of status codes, the data and
+* 			the result, then the instructions of the handler calls are
+* 			reported per table and status code.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_i2c.h"
+#include "i2csim.h"
+
+/* Test parameters */
+#define HOST_MASTER			2		/* I2C2: master */
+#define HOST_SLAVE			0		/* I2C0: slave */
+#define HOST_DEV_ADDR		0x50	/* Memory device on the master bus */
+#define HOST_NO_ADDR		0x51	/* Nobody answers */
+#define HOST_OWN_ADDR		0x48	/* Own slave address of I2C0 */
+#define HOST_GUARD			100000	/* Test loop turns of one scenario */
+#define HOST_SETTLE			1000	/* Ticks to finish the stop condition */
+#define HOST_SEQ_MAX		64
+#define HOST_SPURIOUS_MAX	4		/* 0xF8 interrupt spacings, in idle turns */
+
+/** Handler tables */
+#define HOST_TBL_XFER		0		/* I2C_MasterActTbl[], I2C_MasterTransferData() */
+#define HOST_TBL_BUS		1		/* I2C_MasterActTbl[], bus manager */
+#define HOST_TBL_SLAVE		2		/* I2C_SlaveActTbl[] */
+#define HOST_TBL_NUM		3
+
+/** Instructions of the handler calls of one status code */
+typedef struct {
+	uint32_t calls;
+	uint32_t sum;
+	uint32_t max;
+} HOST_CNT_Type;
+
+static const char * const host_tbl_name[HOST_TBL_NUM] = { "xfer", "bus", "slave" };
+static HOST_CNT_Type host_cnt[HOST_TBL_NUM][32];
+
+/* Status codes of the running scenario */
+static uint8_t host_seq[HOST_SEQ_MAX];
+static uint32_t host_seqnum;
+static uint32_t host_spurious;
+
+/* Transfer setups: the driver keeps them as 32-bit values, they must be
+ * static in a non position independent executable */
+static I2C_M_SETUP_Type host_mset;
+static I2C_S_SETUP_Type host_sset;
+static I2C_XFER_Type host_xfer[2];
+static I2C_SEG_Type host_seg[2][2];
+static uint32_t host_xdone;
+static uint32_t host_mdone;
+static uint32_t host_sdone;
+
+/* Buffers */
+static uint8_t host_mem[256];
+static uint8_t host_tx[16];
+static uint8_t host_rx[16];
+
+/*********************************************************************//**
+ * @brief		Stub: the peripheral power is not modelled
+ **********************************************************************/
+void CLKPWR_ConfigPPWR(uint32_t PPType, FunctionalState NewState)
+{
+	(void)PPType;
+	(void)NewState;
+}
+
+/*********************************************************************//**
+ * @brief		Stub: the peripheral clock is not modelled
+ **********************************************************************/
+void CLKPWR_SetPCLKDiv(uint32_t ClkType, uint32_t DivVal)
+{
+	(void)ClkType;
+	(void)DivVal;
+}
+
+/*********************************************************************//**
+ * @brief		Stub: PCLK of the I2C controllers
+ **********************************************************************/
+uint32_t CLKPWR_GetPCLK(uint32_t ClkType)
+{
+	(void)ClkType;
+	return 25000000;
+}
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Bus manager callback
+ * @param[in]	xfer	Finished transaction
+ * @return		None
+ **********************************************************************/
+static void host_XferDone(I2C_XFER_Type *xfer)
+{
+	(void)xfer;
+	host_xdone++;
+}
+
+/*********************************************************************//**
+ * @brief		Done conditions of the test loop
+ * @param[in]	None
+ * @return		Non zero when done
+ **********************************************************************/
+static uint32_t host_MasterDone(void)
+{
+	host_mdone |= I2C_MasterTransferComplete(LPC_I2C2);
+	return host_mdone;
+}
+
+static uint32_t host_BusDone(void)
+{
+	return I2C_BusIdle(LPC_I2C2) == SET;
+}
+
+static uint32_t host_SlaveDone(void)
+{
+	host_sdone |= I2C_SlaveTransferComplete(LPC_I2C0);
+	return host_sdone && I2CSIM_MasterDone(HOST_SLAVE);
+}
+
+/*********************************************************************//**
+ * @brief		Call the interrupt handler of a controller, count its
+ * 				instructions
+ * @param[in]	bus		Controller number
+ * @return		Status code dispatched by the handler
+ **********************************************************************/
+static uint32_t host_Call(uint32_t bus)
+{
+	HOST_CNT_Type *cnt;
+	uint32_t tbl, n, code;
+
+	if (bus == HOST_SLAVE) {
+		tbl = HOST_TBL_SLAVE;
+		I2CSIM_Start();
+		I2C_SlaveHandler(LPC_I2C0);
+		n = I2CSIM_Stop();
+	} else {
+		tbl = (I2C_BusIdle(LPC_I2C2) == SET) ? HOST_TBL_XFER : HOST_TBL_BUS;
+		I2CSIM_Start();
+		I2C_MasterHandler(LPC_I2C2);
+		n = I2CSIM_Stop();
+	}
+	code = I2CSIM_LastStatus(bus);
+	cnt = &host_cnt[tbl][code >> 3];
+	cnt->calls++;
+	cnt->sum += n;
+	if (n > cnt->max) {
+		cnt->max = n;
+	}
+	if ((code != 0xF8) && (host_seqnum < HOST_SEQ_MAX)) {
+		host_seq[host_seqnum++] = (uint8_t)code;
+	}
+	return code;
+}
+
+/*********************************************************************//**
+ * @brief		Test loop: deliver the interrupts of a controller until
+ * 				the scenario is done
+ * @param[in]	bus			Controller number
+ * @param[in]	done		Done condition
+ * @param[in]	spurious	Also call the handler while SI is clear, once
+ * 							in this number of idle turns, 0: never
+ * @return		Non zero if done, zero if stuck (e.g. SI set with the
+ * 				interrupt disabled)
+ **********************************************************************/
+static uint32_t host_Run(uint32_t bus, uint32_t (*done)(void), uint32_t spurious)
+{
+	uint32_t guard, idle, n;
+
+	host_seqnum = 0;
+	host_mdone = 0;
+	host_sdone = 0;
+	idle = 0;
+	for (guard = 0; guard < HOST_GUARD; guard++) {
+		if (done()) {
+			for (n = 0; (n < HOST_SETTLE) && I2CSIM_Busy(bus); n++) {
+				I2CSIM_Tick();
+			}
+			return 1;
+		}
+		if (I2CSIM_IrqPending(bus)) {
+			host_Call(bus);
+		} else {
+			if (spurious && (++idle % spurious == 0) && (I2C_BusIdle(LPC_I2C2) == RESET)) {
+				/* Re-entered or late interrupt: I2STAT reads 0xF8, unless
+				 * the next event comes in before the handler reads it */
+				host_spurious++;
+				host_Call(bus);
+			}
+			I2CSIM_Tick();
+		}
+	}
+	return 0;
+}
+
+/*********************************************************************//**
+ * @brief		Check and print the result of a scenario
+ * @param[in]	name	Scenario
+ * @param[in]	ok		Result and data of the scenario are right
+ * @param[in]	exp		Expected status codes
+ * @param[in]	num		Number of expected status codes
+ * @return		Number of failures
+ **********************************************************************/
+static uint32_t host_Check(const char *name, uint32_t ok, const uint8_t *exp, uint32_t num)
+{
+	uint32_t n, fail;
+
+	fail = !ok || (host_seqnum != num) || (memcmp(host_seq, exp, num) != 0);
+	printf("%-30s %-4s", name, fail ? "FAIL" : "ok");
+	for (n = 0; n < host_seqnum; n++) {
+		printf(" %02X", host_seq[n]);
+	}
+	printf("\n");
+	if (fail) {
+		printf("%-35s", "  expected");
+		for (n = 0; n < num; n++) {
+			printf(" %02X", exp[n]);
+		}
+		printf("\n");
+	}
+	return fail;
+}
+
+/*********************************************************************//**
+ * @brief		I2C_MasterTransferData() in interrupt mode on I2C2
+ * @param[in]	addr	Slave address
+ * @param[in]	txlen	Bytes of host_tx to write
+ * @param[in]	rxlen	Bytes to read to host_rx
+ * @param[in]	retry	Max re-transmissions
+ * @return		Non zero if done
+ **********************************************************************/
+static uint32_t host_Legacy(uint32_t addr, uint32_t txlen, uint32_t rxlen, uint32_t retry)
+{
+	memset(&host_mset, 0, sizeof(host_mset));
+	memset(host_rx, 0, sizeof(host_rx));
+	host_mset.sl_addr7bit = addr;
+	host_mset.tx_data = txlen ? host_tx : NULL;
+	host_mset.tx_length = txlen;
+	host_mset.rx_data = rxlen ? host_rx : NULL;
+	host_mset.rx_length = rxlen;
+	host_mset.retransmissions_max = retry;
+	I2C_MasterTransferData(LPC_I2C2, &host_mset, I2C_TRANSFER_INTERRUPT);
+	return host_Run(HOST_MASTER, host_MasterDone, 0);
+}
+
+/*********************************************************************//**
+ * @brief		Set up a bus manager transaction of one or two segments
+ * @param[in]	idx		host_xfer[] index
+ * @param[in]	addr	Slave address
+ * @param[in]	wdata	Data of the write segment
+ * @param[in]	wlen	Length of the write segment
+ * @param[in]	rlen	Length of the read segment, 0: none
+ * @param[in]	retry	Max re-transmissions
+ * @return		Transaction
+ **********************************************************************/
+static I2C_XFER_Type *host_Xfer(uint32_t idx, uint32_t addr, uint8_t *wdata, uint32_t wlen,
+								uint32_t rlen, uint32_t retry)
+{
+	I2C_XFER_Type *xfer = &host_xfer[idx];
+
+	memset(xfer, 0, sizeof(*xfer));
+	host_seg[idx][0].data = wdata;
+	host_seg[idx][0].length = wlen;
+	host_seg[idx][0].flags = I2C_SEG_WRITE;
+	host_seg[idx][1].data = host_rx;
+	host_seg[idx][1].length = rlen;
+	host_seg[idx][1].flags = I2C_SEG_READ;
+	xfer->sl_addr7bit = addr;
+	xfer->seg = host_seg[idx];
+	xfer->seg_num = rlen ? 2 : 1;
+	xfer->retransmissions_max = retry;
+	xfer->callback = host_XferDone;
+	return xfer;
+}
+
+/*********************************************************************//**
+ * @brief		Master scenarios on I2C2
+ * @param[in]	None
+ * @return		Number of failures
+ **********************************************************************/
+static uint32_t host_MasterTests(void)
+{
+	static const uint8_t wr[] = { 0x08, 0x18, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28 };
+	static const uint8_t wrrd[] = { 0x08, 0x18, 0x28, 0x10, 0x40, 0x50, 0x50, 0x50,
+									0x50, 0x50, 0x50, 0x50, 0x58 };
+	static const uint8_t nack[] = { 0x08, 0x20, 0x10, 0x20, 0x10, 0x20 };
+	static const uint8_t berr[] = { 0x08, 0x00, 0x08, 0x18, 0x28, 0x28 };
+	static const uint8_t queue[] = { 0x08, 0x18, 0x28, 0x28, 0x28, 0x28, 0x28,
+									 0x08, 0x18, 0x28, 0x10, 0x40, 0x50, 0x50, 0x50, 0x58 };
+	static const uint8_t arb[] = { 0x08, 0x38, 0x08, 0x18, 0x28, 0x28 };
+	static const uint8_t bnack[] = { 0x08, 0x20, 0x08, 0x18, 0x28, 0x28 };
+	static const uint8_t bberr[] = { 0x08, 0x00 };
+	static uint8_t w1[] = { 0x20, 0x01, 0x02, 0x03, 0x04 };
+	static uint8_t w2[] = { 0x20 };
+	static uint8_t w3[] = { 0x30, 0x5A };
+	static uint8_t w4[] = { 0x40, 0x77 };
+	static uint8_t w5[] = { 0x48, 0x66 };
+	static uint8_t w6[] = { 0x10 };
+	I2C_XFER_Type *x1, *x2;
+	char name[32];
+	uint32_t fail, ok, n;
+
+	I2C_Init(LPC_I2C2, 100000);
+	I2C_Cmd(LPC_I2C2, ENABLE);
+	fail = 0;
+
+	/* I2C_MasterTransferData() ----------------------------------------------- */
+	host_tx[0] = 0x10;
+	for (n = 1; n < 9; n++) {
+		host_tx[n] = (uint8_t)(n * 0x11);
+	}
+	ok = host_Legacy(HOST_DEV_ADDR, 9, 0, 3);
+	ok = ok && (host_mset.status & I2C_SETUP_STATUS_DONE)
+			&& (memcmp(&host_mem[0x10], &host_tx[1], 8) == 0);
+	fail += host_Check("xfer write 8", ok, wr, sizeof(wr));
+
+	ok = host_Legacy(HOST_DEV_ADDR, 1, 8, 3);
+	ok = ok && (host_mset.status & I2C_SETUP_STATUS_DONE)
+			&& (memcmp(host_rx, &host_mem[0x10], 8) == 0);
+	fail += host_Check("xfer write 1, read 8", ok, wrrd, sizeof(wrrd));
+
+	ok = host_Legacy(HOST_NO_ADDR, 1, 0, 2);
+	ok = ok && (host_mset.status & I2C_SETUP_STATUS_NOACKF)
+			&& !(host_mset.status & I2C_SETUP_STATUS_DONE);
+	fail += host_Check("xfer no slave, 2 retries", ok, nack, sizeof(nack));
+
+	host_tx[0] = 0x18;
+	host_tx[1] = 0xA5;
+	I2CSIM_Inject(HOST_MASTER, 0x00);
+	ok = host_Legacy(HOST_DEV_ADDR, 2, 0, 1);
+	ok = ok && (host_mset.status & I2C_SETUP_STATUS_DONE) && (host_mem[0x18] == 0xA5);
+	fail += host_Check("xfer bus error, retry", ok, berr, sizeof(berr));
+
+	/* Bus manager, the interrupt was left disabled by I2C_MasterTransferData() */
+	x1 = host_Xfer(0, HOST_DEV_ADDR, w1, sizeof(w1), 0, 0);
+	x2 = host_Xfer(1, HOST_DEV_ADDR, w2, sizeof(w2), 4, 0);
+	host_xdone = 0;
+	I2C_BusSubmit(LPC_I2C2, x1);
+	I2C_BusSubmit(LPC_I2C2, x2);
+	ok = host_Run(HOST_MASTER, host_BusDone, 0);
+	ok = ok && (host_xdone == 2) && (x1->status & I2C_SETUP_STATUS_DONE)
+			&& (x2->status & I2C_SETUP_STATUS_DONE) && (memcmp(host_rx, &w1[1], 4) == 0);
+	fail += host_Check("bus after xfer, 2 queued", ok, queue, sizeof(queue));
+
+	x1 = host_Xfer(0, HOST_DEV_ADDR, w3, sizeof(w3), 0, 1);
+	I2CSIM_Inject(HOST_MASTER, 0x38);
+	I2C_BusSubmit(LPC_I2C2, x1);
+	ok = host_Run(HOST_MASTER, host_BusDone, 0);
+	ok = ok && (x1->status & I2C_SETUP_STATUS_DONE) && (host_mem[0x30] == 0x5A);
+	fail += host_Check("bus arbitration lost, retry", ok, arb, sizeof(arb));
+
+	x1 = host_Xfer(0, HOST_NO_ADDR, w4, sizeof(w4), 0, 0);
+	x2 = host_Xfer(1, HOST_DEV_ADDR, w4, sizeof(w4), 0, 0);
+	I2C_BusSubmit(LPC_I2C2, x1);
+	I2C_BusSubmit(LPC_I2C2, x2);
+	ok = host_Run(HOST_MASTER, host_BusDone, 0);
+	ok = ok && (x1->status & I2C_SETUP_STATUS_NOACKF) && !(x1->status & I2C_SETUP_STATUS_DONE)
+			&& (x2->status & I2C_SETUP_STATUS_DONE) && (host_mem[0x40] == 0x77);
+	fail += host_Check("bus no slave, next queued", ok, bnack, sizeof(bnack));
+
+	x1 = host_Xfer(0, HOST_DEV_ADDR, w5, sizeof(w5), 0, 0);
+	I2CSIM_Inject(HOST_MASTER, 0x00);
+	I2C_BusSubmit(LPC_I2C2, x1);
+	ok = host_Run(HOST_MASTER, host_BusDone, 0);
+	ok = ok && (x1->status == 0x00) && (host_mem[0x48] == 0x00);
+	fail += host_Check("bus bus error", ok, bberr, sizeof(bberr));
+
+	/* The handler is entered at each phase of the bus events */
+	for (n = 1; n <= HOST_SPURIOUS_MAX; n++) {
+		x1 = host_Xfer(0, HOST_DEV_ADDR, w6, sizeof(w6), 8, 0);
+		host_spurious = 0;
+		I2C_BusSubmit(LPC_I2C2, x1);
+		ok = host_Run(HOST_MASTER, host_BusDone, n);
+		ok = ok && (x1->status & I2C_SETUP_STATUS_DONE) && (host_spurious != 0)
+				&& (memcmp(host_rx, &host_mem[0x10], 8) == 0);
+		sprintf(name, "bus 0xF8 interrupt every %u", (unsigned)n);
+		fail += host_Check(name, ok, wrrd, sizeof(wrrd));
+	}
+
+	return fail;
+}
+
+/*********************************************************************//**
+ * @brief		Slave scenarios on I2C0
+ * @param[in]	None
+ * @return		Number of failures
+ **********************************************************************/
+static uint32_t host_SlaveTests(void)
+{
+	static const uint8_t rec[] = { 0x60, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xA0 };
+	static const uint8_t rectrx[] = { 0x60, 0x80, 0x80, 0xA0, 0xA8, 0xB8, 0xB8, 0xB8, 0xC0 };
+	static I2CSIM_OP_Type ops[16];
+	I2C_OWNSLAVEADDR_CFG_Type own;
+	uint32_t fail, ok, n;
+
+	I2C_Init(LPC_I2C0, 100000);
+	own.SlaveAddrChannel = 0;
+	own.SlaveAddr_7bit = HOST_OWN_ADDR;
+	own.GeneralCallState = DISABLE;
+	own.SlaveAddrMaskValue = 0x00;
+	I2C_SetOwnSlaveAddr(LPC_I2C0, &own);
+	I2C_Cmd(LPC_I2C0, ENABLE);
+	fail = 0;
+
+	/* Write 8 bytes, stop: 0xA0 ends the transfer after the time out */
+	memset(&host_sset, 0, sizeof(host_sset));
+	memset(host_rx, 0, sizeof(host_rx));
+	host_sset.rx_data = host_rx;
+	host_sset.rx_length = 8;
+	ops[0].op = I2CSIM_OP_START;
+	ops[0].val = HOST_OWN_ADDR << 1;
+	for (n = 1; n <= 8; n++) {
+		ops[n].op = I2CSIM_OP_WRITE;
+		ops[n].val = (uint8_t)(0xC0 + n);
+	}
+	ops[9].op = I2CSIM_OP_STOP;
+	I2C_SlaveTransferData(LPC_I2C0, &host_sset, I2C_TRANSFER_INTERRUPT);
+	I2CSIM_Master(HOST_SLAVE, ops, 10);
+	ok = host_Run(HOST_SLAVE, host_SlaveDone, 0);
+	ok = ok && (host_sset.status & I2C_SETUP_STATUS_DONE) && (host_sset.rx_count == 8);
+	for (n = 0; ok && (n < 8); n++) {
+		ok = (host_rx[n] == ops[n + 1].val);
+	}
+	fail += host_Check("slave receive 8, stop", ok, rec, sizeof(rec));
+
+	/* Write 2 bytes, repeated start, read 4 bytes */
+	memset(&host_sset, 0, sizeof(host_sset));
+	memset(host_rx, 0, sizeof(host_rx));
+	for (n = 0; n < 4; n++) {
+		host_tx[n] = (uint8_t)(0xE0 + n);
+	}
+	host_sset.rx_data = host_rx;
+	host_sset.rx_length = 2;
+	host_sset.tx_data = host_tx;
+	host_sset.tx_length = 4;
+	ops[0].op = I2CSIM_OP_START;
+	ops[0].val = HOST_OWN_ADDR << 1;
+	ops[1].op = I2CSIM_OP_WRITE;
+	ops[1].val = 0x3C;
+	ops[2].op = I2CSIM_OP_WRITE;
+	ops[2].val = 0x3D;
+	ops[3].op = I2CSIM_OP_START;
+	ops[3].val = (HOST_OWN_ADDR << 1) | 1;
+	for (n = 4; n < 7; n++) {
+		ops[n].op = I2CSIM_OP_READ;
+	}
+	ops[7].op = I2CSIM_OP_READ_LAST;
+	ops[8].op = I2CSIM_OP_STOP;
+	I2C_SlaveTransferData(LPC_I2C0, &host_sset, I2C_TRANSFER_INTERRUPT);
+	I2CSIM_Master(HOST_SLAVE, ops, 9);
+	ok = host_Run(HOST_SLAVE, host_SlaveDone, 0);
+	ok = ok && (host_sset.status & I2C_SETUP_STATUS_DONE)
+			&& (host_rx[0] == 0x3C) && (host_rx[1] == 0x3D);
+	for (n = 0; ok && (n < 4); n++) {
+		ok = (ops[n + 4].val == host_tx[n]);
+	}
+	fail += host_Check("slave receive 2, read 4", ok, rectrx, sizeof(rectrx));
+
+	return fail;
+}
+
+/*********************************************************************//**
+ * @brief		Main program body
+ * @param[in]	None
+ * @return		0 if all scenarios pass
+ **********************************************************************/
+int main(void)
+{
+	I2CSIM_STATS_Type st;
+	HOST_CNT_Type *cnt;
+	uint32_t fail, tbl, code;
+
+	I2CSIM_Init();
+	I2CSIM_Device(HOST_MASTER, HOST_DEV_ADDR, host_mem, sizeof(host_mem));
+
+	printf("scenario                       res  status codes\n");
+	fail = host_MasterTests();
+	fail += host_SlaveTests();
+
+	printf("\ninstructions per handler call, from the handler entry to its return\n");
+	printf("table  code  calls      avg      max\n");
+	for (tbl = 0; tbl < HOST_TBL_NUM; tbl++) {
+		for (code = 0; code < 32; code++) {
+			cnt = &host_cnt[tbl][code];
+			if (cnt->calls != 0) {
+				printf("%-5s  0x%02X %6u %8u %8u\n", host_tbl_name[tbl], (unsigned)(code << 3),
+						(unsigned)cnt->calls, (unsigned)(cnt->sum / cnt->calls), (unsigned)cnt->max);
+			}
+		}
+	}
+
+	I2CSIM_GetStats(&st);
+	printf("\n%u register accesses, %u model violation(s)%s%s\n", (unsigned)st.Accesses,
+			(unsigned)st.Violations, st.Violations ? ": " : "", I2CSIM_Violation());
+	if (st.Violations) {
+		fail++;
+	}
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
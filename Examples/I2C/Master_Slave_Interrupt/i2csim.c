@@ -0,0 +1,730 @@
+/**********************************************************************
+* $Id$		i2csim.c			2011-03-09
+*//**
+* @file		i2csim.c
+* @brief	Host model of the LPC17xx I2C controllers. The register
+* 			pages of I2C0/1/2 and of the NVIC are mapped without access
+* 			rights: each access of the driver faults, is prepared by the
+* 			model, single-stepped and applied. A bus event (start,
+* 			address, data byte, stop) takes I2CSIM_BYTE_TICKS register
+* 			accesses or idle ticks after the driver clears SI. Between
+* 			I2CSIM_Start() and I2CSIM_Stop() every instruction is
+* 			single-stepped and counted.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "LPC17xx.h"
+#include "lpc17xx_i2c.h"
+#include "i2csim.h"
+
+/* Model parameters */
+#define SIM_PAGE_SZ			0x00001000UL
+#define SIM_NVIC_ADR		0xE000E000UL	/* NVIC and SCB page, trapped */
+#define SIM_BUS_NUM			3
+#define SIM_PAGE_NUM		(SIM_BUS_NUM + 1)
+#define SIM_DEV_NUM			2				/* Memory devices per bus */
+#define SIM_BYTE_TICKS		4				/* Ticks of one bus event */
+
+/* Register offsets */
+#define SIM_OFS(reg)		offsetof(LPC_I2C_TypeDef, reg)
+#define SIM_NVIC_ISER		0x100
+#define SIM_NVIC_ICER		0x180
+
+/* x86-64 trap flag and page fault error code */
+#define SIM_EFL_TF			0x00000100
+#define SIM_ERR_WRITE		0x00000002
+
+/* Slave state */
+#define SIM_SLV_NONE		0
+#define SIM_SLV_REC			1
+#define SIM_SLV_TRX			2
+
+/** Memory device: the first byte written sets the address */
+typedef struct {
+	uint8_t addr;
+	uint8_t *mem;
+	uint32_t size;
+	uint32_t ptr;
+} SIM_DEV_Type;
+
+/** Controller and its bus */
+typedef struct {
+	uint32_t con;
+	uint32_t stat;			/* Last status code, I2STAT reads 0xF8 while SI is clear */
+	uint32_t dat;
+	uint32_t adr[4];
+	uint32_t mask[4];
+	uint32_t sclh;
+	uint32_t scll;
+	uint32_t mmctrl;
+	uint32_t seen;			/* Last I2STAT value read by the driver */
+	/* Bus */
+	uint32_t pend;			/* Ticks to the next bus event, 0: none */
+	uint32_t owner;			/* Controller is bus master */
+	int32_t target;			/* Device addressed by the master, -1: none */
+	uint32_t first;			/* Next byte written is the device address */
+	int32_t inject;			/* Status of the next address phase, -1: none */
+	SIM_DEV_Type dev[SIM_DEV_NUM];
+	/* External master */
+	I2CSIM_OP_Type *ops;
+	uint32_t opnum;
+	uint32_t opidx;
+	uint32_t slave;			/* SIM_SLV_xxx */
+	uint32_t a0sent;		/* 0xA0 given for a repeated start */
+} SIM_CTL_Type;
+
+static const uintptr_t sim_base[SIM_PAGE_NUM] = {
+	LPC_I2C0_BASE, LPC_I2C1_BASE, LPC_I2C2_BASE, SIM_NVIC_ADR
+};
+
+static SIM_CTL_Type sim[SIM_BUS_NUM];
+static uint32_t sim_iser;
+static uint32_t sim_nvic[SIM_PAGE_SZ / 4];
+
+/* Access being single-stepped */
+static volatile int sim_inhandler;
+static volatile int sim_trace;
+static uint32_t sim_page;
+static uint32_t sim_ofs;
+static uint32_t sim_write;
+static uint32_t sim_before;
+
+static I2CSIM_STATS_Type sim_stats;
+static char sim_violation[160];
+
+/* Private Functions ---------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Count a programming error of the driver, keep the first
+ * @param[in]	msg		Description
+ * @param[in]	n		Controller number
+ * @param[in]	stat	Status code at the time of the error
+ * @return 		None
+ **********************************************************************/
+static void sim_Violation(const char *msg, uint32_t n, uint32_t stat)
+{
+	if (sim_stats.Violations++ == 0) {
+		snprintf(sim_violation, sizeof(sim_violation), "I2C%u: %s (status 0x%02X)",
+				(unsigned)n, msg, (unsigned)stat);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Word of a trapped page
+ * @param[in]	page	Page index
+ * @param[in]	ofs		Offset
+ * @return 		Pointer to the word
+ **********************************************************************/
+static volatile uint32_t *sim_Reg(uint32_t page, uint32_t ofs)
+{
+	return (volatile uint32_t *)(sim_base[page] + ofs);
+}
+
+/*********************************************************************//**
+ * @brief		Give an interrupt to the driver
+ * @param[in]	c		Controller
+ * @param[in]	stat	Status code
+ * @return 		None
+ **********************************************************************/
+static void sim_Interrupt(SIM_CTL_Type *c, uint32_t stat)
+{
+	c->stat = stat;
+	c->con |= I2C_I2CONSET_SI;
+}
+
+/*********************************************************************//**
+ * @brief		Master bus event: start, address, data or stop, from the
+ * 				control bits and the last status
+ * @param[in]	n		Controller number
+ * @return 		None
+ **********************************************************************/
+static void sim_MasterEvent(uint32_t n)
+{
+	SIM_CTL_Type *c = &sim[n];
+	SIM_DEV_Type *d;
+	uint32_t i;
+
+	if (!c->owner) {
+		/* Not addressed, bus free: a start is sent at once */
+		c->con &= ~I2C_I2CONSET_STO;
+		if (c->con & I2C_I2CONSET_STA) {
+			c->owner = 1;
+			sim_Interrupt(c, 0x08);
+		} else {
+			c->stat = 0xF8;
+		}
+		return;
+	}
+	if (c->con & I2C_I2CONSET_STO) {
+		c->con &= ~I2C_I2CONSET_STO;
+		c->owner = 0;
+		c->target = -1;
+		if (c->con & I2C_I2CONSET_STA) {
+			c->owner = 1;
+			sim_Interrupt(c, 0x08);
+		} else {
+			c->stat = 0xF8;
+		}
+		return;
+	}
+	if (c->con & I2C_I2CONSET_STA) {
+		c->target = -1;
+		sim_Interrupt(c, 0x10);
+		return;
+	}
+	switch (c->stat) {
+	case 0x08:
+	case 0x10:
+		/* SLA+R/W */
+		if (c->inject >= 0) {
+			c->owner = 0;
+			sim_Interrupt(c, (uint32_t)c->inject);
+			c->inject = -1;
+			return;
+		}
+		c->target = -1;
+		for (i = 0; i < SIM_DEV_NUM; i++) {
+			if ((c->dev[i].mem != NULL) && (c->dev[i].addr == (c->dat >> 1))) {
+				c->target = (int32_t)i;
+			}
+		}
+		c->first = 1;
+		if (c->dat & 1) {
+			sim_Interrupt(c, (c->target >= 0) ? 0x40 : 0x48);
+		} else {
+			sim_Interrupt(c, (c->target >= 0) ? 0x18 : 0x20);
+		}
+		break;
+	case 0x18:
+	case 0x28:
+		d = &c->dev[c->target];
+		if (c->first) {
+			d->ptr = c->dat;
+			c->first = 0;
+		} else {
+			d->mem[d->ptr++ % d->size] = (uint8_t)c->dat;
+		}
+		sim_Interrupt(c, 0x28);
+		break;
+	case 0x40:
+	case 0x50:
+		d = &c->dev[c->target];
+		c->dat = d->mem[d->ptr++ % d->size];
+		sim_Interrupt(c, (c->con & I2C_I2CONSET_AA) ? 0x50 : 0x58);
+		break;
+	default:
+		sim_Violation("SI cleared without STA or STO", n, c->stat);
+		c->stat = 0xF8;
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Next operation of the external master, the controller is
+ * 				the slave
+ * @param[in]	n		Controller number
+ * @return 		None
+ **********************************************************************/
+static void sim_ExtEvent(uint32_t n)
+{
+	SIM_CTL_Type *c = &sim[n];
+	I2CSIM_OP_Type *op = &c->ops[c->opidx];
+	uint32_t i, match;
+
+	switch (op->op) {
+	case I2CSIM_OP_START:
+		if ((c->slave != SIM_SLV_NONE) && !c->a0sent) {
+			/* Repeated start seen while addressed */
+			c->a0sent = 1;
+			c->slave = SIM_SLV_NONE;
+			sim_Interrupt(c, 0xA0);
+			c->pend = 0;
+			return;
+		}
+		c->a0sent = 0;
+		match = 0;
+		for (i = 0; i < 4; i++) {
+			if (((c->adr[i] >> 1) & ~(c->mask[i] >> 1) & 0x7F) == ((op->val >> 1) & ~(c->mask[i] >> 1) & 0x7F)
+					&& ((i == 0) || (c->adr[i] != 0))) {
+				match = 1;
+			}
+		}
+		if ((c->con & I2C_I2CONSET_I2EN) && (c->con & I2C_I2CONSET_AA) && match) {
+			c->slave = (op->val & 1) ? SIM_SLV_TRX : SIM_SLV_REC;
+			sim_Interrupt(c, (op->val & 1) ? 0xA8 : 0x60);
+		} else {
+			sim_stats.ExtNack++;
+			c->slave = SIM_SLV_NONE;
+			/* Not acknowledged: on to the stop */
+			while ((c->opidx + 1 < c->opnum) && (c->ops[c->opidx + 1].op != I2CSIM_OP_STOP)) {
+				c->opidx++;
+			}
+		}
+		break;
+	case I2CSIM_OP_WRITE:
+		if ((c->slave == SIM_SLV_REC) && (c->con & I2C_I2CONSET_AA)) {
+			c->dat = op->val;
+			sim_Interrupt(c, 0x80);
+		} else if (c->slave == SIM_SLV_REC) {
+			c->dat = op->val;
+			c->slave = SIM_SLV_NONE;
+			sim_stats.ExtNack++;
+			sim_Interrupt(c, 0x88);
+		} else {
+			sim_stats.ExtNack++;
+		}
+		break;
+	case I2CSIM_OP_READ:
+	case I2CSIM_OP_READ_LAST:
+		if (c->slave == SIM_SLV_TRX) {
+			op->val = (uint8_t)c->dat;
+			if (op->op == I2CSIM_OP_READ_LAST) {
+				c->slave = SIM_SLV_NONE;
+				sim_Interrupt(c, 0xC0);
+			} else if (c->con & I2C_I2CONSET_AA) {
+				sim_Interrupt(c, 0xB8);
+			} else {
+				c->slave = SIM_SLV_NONE;
+				sim_Interrupt(c, 0xC8);
+			}
+		} else {
+			op->val = 0xFF;
+		}
+		break;
+	default:
+		if (c->slave != SIM_SLV_NONE) {
+			c->slave = SIM_SLV_NONE;
+			sim_Interrupt(c, 0xA0);
+		}
+		break;
+	}
+	c->opidx++;
+	if (c->opidx >= c->opnum) {
+		c->ops = NULL;
+	}
+	/* No interrupt: next operation after one event time */
+	c->pend = (c->con & I2C_I2CONSET_SI) ? 0 : ((c->ops != NULL) ? SIM_BYTE_TICKS : 0);
+}
+
+/*********************************************************************//**
+ * @brief		One tick of the buses
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_Tick(void)
+{
+	SIM_CTL_Type *c;
+	uint32_t n;
+
+	for (n = 0; n < SIM_BUS_NUM; n++) {
+		c = &sim[n];
+		if ((c->pend == 0) || (--c->pend != 0) || (c->con & I2C_I2CONSET_SI)) {
+			continue;
+		}
+		if (!(c->con & I2C_I2CONSET_I2EN)) {
+			continue;
+		}
+		if (c->ops != NULL) {
+			sim_ExtEvent(n);
+		} else {
+			sim_MasterEvent(n);
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register write of a controller
+ * @param[in]	n		Controller number
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_Write(uint32_t n, uint32_t ofs, uint32_t val)
+{
+	SIM_CTL_Type *c = &sim[n];
+
+	if (ofs == SIM_OFS(I2CONSET)) {
+		c->con |= val & (I2C_I2CONSET_AA | I2C_I2CONSET_STO | I2C_I2CONSET_STA | I2C_I2CONSET_I2EN);
+		if ((val & (I2C_I2CONSET_STA | I2C_I2CONSET_STO)) && !(c->con & I2C_I2CONSET_SI)
+				&& (c->pend == 0) && (c->ops == NULL)) {
+			c->pend = SIM_BYTE_TICKS;
+		}
+	} else if (ofs == SIM_OFS(I2CONCLR)) {
+		if ((val & I2C_I2CONCLR_SIC) && (c->con & I2C_I2CONSET_SI)) {
+			c->pend = SIM_BYTE_TICKS;
+		}
+		c->con &= ~(val & (I2C_I2CONCLR_AAC | I2C_I2CONCLR_SIC | I2C_I2CONCLR_STAC | I2C_I2CONCLR_I2ENC));
+		if (val & I2C_I2CONCLR_I2ENC) {
+			c->owner = 0;
+			c->pend = 0;
+			c->stat = 0xF8;
+		}
+	} else if (ofs == SIM_OFS(I2DAT)) {
+		if (!(c->con & I2C_I2CONSET_SI)) {
+			sim_Violation("I2DAT written with SI clear", n, c->stat);
+		}
+		c->dat = val & 0xFF;
+	} else if (ofs == SIM_OFS(I2ADR0)) {
+		c->adr[0] = val & 0xFF;
+	} else if (ofs == SIM_OFS(I2ADR1)) {
+		c->adr[1] = val & 0xFF;
+	} else if (ofs == SIM_OFS(I2ADR2)) {
+		c->adr[2] = val & 0xFF;
+	} else if (ofs == SIM_OFS(I2ADR3)) {
+		c->adr[3] = val & 0xFF;
+	} else if ((ofs >= SIM_OFS(I2MASK0)) && (ofs <= SIM_OFS(I2MASK3))) {
+		c->mask[(ofs - SIM_OFS(I2MASK0)) / 4] = val & 0xFE;
+	} else if (ofs == SIM_OFS(I2SCLH)) {
+		c->sclh = val & 0xFFFF;
+	} else if (ofs == SIM_OFS(I2SCLL)) {
+		c->scll = val & 0xFFFF;
+	} else if (ofs == SIM_OFS(MMCTRL)) {
+		c->mmctrl = val & 0x0F;
+	} else {
+		sim_Violation("write to a read only register", n, c->stat);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Refresh the readable values of a page
+ * @param[in]	page	Page index
+ * @return 		None
+ **********************************************************************/
+static void sim_Publish(uint32_t page)
+{
+	SIM_CTL_Type *c;
+	uint32_t i;
+
+	if (page == SIM_BUS_NUM) {
+		memcpy((void *)sim_base[page], sim_nvic, SIM_PAGE_SZ);
+		*sim_Reg(page, SIM_NVIC_ISER) = sim_iser;
+		*sim_Reg(page, SIM_NVIC_ICER) = sim_iser;
+		return;
+	}
+	c = &sim[page];
+	memset((void *)sim_base[page], 0, SIM_PAGE_SZ);
+	*sim_Reg(page, SIM_OFS(I2CONSET)) = c->con;
+	*sim_Reg(page, SIM_OFS(I2STAT)) = (c->con & I2C_I2CONSET_SI) ? c->stat : 0xF8;
+	*sim_Reg(page, SIM_OFS(I2DAT)) = c->dat;
+	*sim_Reg(page, SIM_OFS(I2DATA_BUFFER)) = c->dat;
+	*sim_Reg(page, SIM_OFS(I2ADR0)) = c->adr[0];
+	*sim_Reg(page, SIM_OFS(I2ADR1)) = c->adr[1];
+	*sim_Reg(page, SIM_OFS(I2ADR2)) = c->adr[2];
+	*sim_Reg(page, SIM_OFS(I2ADR3)) = c->adr[3];
+	for (i = 0; i < 4; i++) {
+		*sim_Reg(page, SIM_OFS(I2MASK0) + i * 4) = c->mask[i];
+	}
+	*sim_Reg(page, SIM_OFS(I2SCLH)) = c->sclh;
+	*sim_Reg(page, SIM_OFS(I2SCLL)) = c->scll;
+	*sim_Reg(page, SIM_OFS(MMCTRL)) = c->mmctrl;
+}
+
+/*********************************************************************//**
+ * @brief		Register page fault: prepare the access, single-step it
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Fault(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uintptr_t adr = (uintptr_t)si->si_addr;
+	uint32_t page;
+
+	(void)sig;
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		if ((adr >= sim_base[page]) && (adr < sim_base[page] + SIM_PAGE_SZ)) {
+			break;
+		}
+	}
+	if ((page == SIM_PAGE_NUM) || sim_inhandler) {
+		signal(SIGSEGV, SIG_DFL);				/* Real fault: faults again */
+		return;
+	}
+	sim_inhandler = 1;
+	sim_page = page;
+	mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE);
+	sim_ofs = (uint32_t)(adr - sim_base[page]);
+	sim_write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_ERR_WRITE) != 0;
+	if ((sim_ofs & 3) && (page != SIM_BUS_NUM)) {
+		sim_Violation("unaligned register access", page, sim[page].stat);
+	}
+	sim_ofs &= ~3UL;
+	sim_stats.Accesses++;
+	sim_Tick();
+	sim_Publish(page);
+	sim_before = *sim_Reg(page, sim_ofs);
+	if ((page < SIM_BUS_NUM) && !sim_write && (sim_ofs == SIM_OFS(I2STAT))) {
+		sim[page].seen = sim_before;
+	}
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Single step: apply a register access that is done, count
+ * 				an instruction of the traced code
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Step(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uint32_t val, page;
+
+	(void)sig;
+	(void)si;
+	if (sim_inhandler) {
+		page = sim_page;
+		val = *sim_Reg(page, sim_ofs);
+		/* Read-modify-write instructions may fault as a read */
+		if (page == SIM_BUS_NUM) {
+			if ((sim_ofs >= SIM_NVIC_ISER) && (sim_ofs < SIM_NVIC_ISER + 0x20)) {
+				if ((sim_ofs == SIM_NVIC_ISER) && (sim_write || (val != sim_before))) {
+					sim_iser |= val;
+				}
+			} else if ((sim_ofs >= SIM_NVIC_ICER) && (sim_ofs < SIM_NVIC_ICER + 0x20)) {
+				if ((sim_ofs == SIM_NVIC_ICER) && (sim_write || (val != sim_before))) {
+					sim_iser &= ~val;
+				}
+			} else {
+				memcpy(sim_nvic, (void *)sim_base[page], SIM_PAGE_SZ);
+			}
+		} else if (sim_write || (val != sim_before)) {
+			sim_Write(page, sim_ofs, val);
+		}
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+		sim_inhandler = 0;
+	}
+	if (sim_trace) {
+		sim_stats.Instructions++;
+		uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+	} else {
+		uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFL_TF;
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Map the register pages and install the access traps.
+ * 				The controllers are disabled, the interrupts too
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_Init(void)
+{
+	struct sigaction sa;
+	uint32_t page;
+	void *p;
+
+	memset(sim, 0, sizeof(sim));
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		p = mmap((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (p != (void *)sim_base[page]) {
+			fprintf(stderr, "i2csim: cannot map 0x%08lX\n", (unsigned long)sim_base[page]);
+			exit(2);
+		}
+		if (page < SIM_BUS_NUM) {
+			sim[page].stat = 0xF8;
+			sim[page].target = -1;
+			sim[page].inject = -1;
+		}
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sim_Fault;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = sim_Step;
+	sigaction(SIGTRAP, &sa, NULL);
+}
+
+/*********************************************************************//**
+ * @brief		Attach a memory device to the bus of a controller
+ * @param[in]	bus		Controller number
+ * @param[in]	addr	7-bit slave address
+ * @param[in]	mem		Device memory
+ * @param[in]	size	Size of memory
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_Device(uint32_t bus, uint8_t addr, uint8_t *mem, uint32_t size)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_DEV_NUM; i++) {
+		if (sim[bus].dev[i].mem == NULL) {
+			sim[bus].dev[i].addr = addr;
+			sim[bus].dev[i].mem = mem;
+			sim[bus].dev[i].size = size;
+			sim[bus].dev[i].ptr = 0;
+			return;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Give a status instead of the next address phase of the
+ * 				master, e.g. 0x38 (arbitration lost) or 0x00 (bus error)
+ * @param[in]	bus		Controller number
+ * @param[in]	code	Status code
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_Inject(uint32_t bus, uint8_t code)
+{
+	sim[bus].inject = code;
+}
+
+/*********************************************************************//**
+ * @brief		Start an external master on the bus of a controller
+ * @param[in]	bus		Controller number
+ * @param[in]	ops		Operations, the bytes read are stored in them
+ * @param[in]	num		Number of operations
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_Master(uint32_t bus, I2CSIM_OP_Type *ops, uint32_t num)
+{
+	sim[bus].ops = ops;
+	sim[bus].opnum = num;
+	sim[bus].opidx = 0;
+	sim[bus].slave = SIM_SLV_NONE;
+	sim[bus].a0sent = 0;
+	sim[bus].pend = SIM_BYTE_TICKS;
+}
+
+/*********************************************************************//**
+ * @brief		External master done
+ * @param[in]	bus		Controller number
+ * @return 		Non zero when all operations are done
+ **********************************************************************/
+uint32_t I2CSIM_MasterDone(uint32_t bus)
+{
+	return sim[bus].ops == NULL;
+}
+
+/*********************************************************************//**
+ * @brief		Interrupt request of a controller: SI set and enabled
+ * 				in the NVIC
+ * @param[in]	bus		Controller number
+ * @return 		Non zero if the interrupt is requested
+ **********************************************************************/
+uint32_t I2CSIM_IrqPending(uint32_t bus)
+{
+	return (sim[bus].con & I2C_I2CONSET_SI)
+			&& ((sim_iser >> ((uint32_t)I2C0_IRQn + bus)) & 1);
+}
+
+/*********************************************************************//**
+ * @brief		Status code of a controller
+ * @param[in]	bus		Controller number
+ * @return 		I2STAT value, 0xF8 while SI is clear
+ **********************************************************************/
+uint32_t I2CSIM_Status(uint32_t bus)
+{
+	return (sim[bus].con & I2C_I2CONSET_SI) ? sim[bus].stat : 0xF8;
+}
+
+/*********************************************************************//**
+ * @brief		Status code the driver has read last, e.g. the one an
+ * 				interrupt handler has dispatched
+ * @param[in]	bus		Controller number
+ * @return 		I2STAT value
+ **********************************************************************/
+uint32_t I2CSIM_LastStatus(uint32_t bus)
+{
+	return sim[bus].seen;
+}
+
+/*********************************************************************//**
+ * @brief		Bus activity of a controller
+ * @param[in]	bus		Controller number
+ * @return 		Non zero while SI is set, a bus event is pending or the
+ * 				controller is bus master
+ **********************************************************************/
+uint32_t I2CSIM_Busy(uint32_t bus)
+{
+	return (sim[bus].con & I2C_I2CONSET_SI) || (sim[bus].pend != 0) || sim[bus].owner;
+}
+
+/*********************************************************************//**
+ * @brief		One bus tick while the processor does not access the
+ * 				registers
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_Tick(void)
+{
+	sim_Tick();
+}
+
+/*********************************************************************//**
+ * @brief		Single-step and count the code that follows until
+ * 				I2CSIM_Stop()
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_Start(void)
+{
+	sim_stats.Instructions = 0;
+	sim_trace = 1;
+	__asm__ volatile ("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+/*********************************************************************//**
+ * @brief		End of the counted code
+ * @param[in]	None
+ * @return 		Instructions since I2CSIM_Start()
+ **********************************************************************/
+uint32_t I2CSIM_Stop(void)
+{
+	sim_trace = 0;
+	__asm__ volatile ("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+	return sim_stats.Instructions;
+}
+
+/*********************************************************************//**
+ * @brief		Get the model counters
+ * @param[out]	stats	Counters
+ * @return 		None
+ **********************************************************************/
+void I2CSIM_GetStats(I2CSIM_STATS_Type *stats)
+{
+	*stats = sim_stats;
+}
+
+/*********************************************************************//**
+ * @brief		First programming error seen by the model
+ * @param[in]	None
+ * @return 		Description, empty if none
+ **********************************************************************/
+const char *I2CSIM_Violation(void)
+{
+	return sim_violation;
+}
@@ -0,0 +1,73 @@
+/**********************************************************************
+* $Id$		i2csim.h			2011-03-09
+*//**
+* @file		i2csim.h
+* @brief	Host model of the LPC17xx I2C controllers and of the NVIC
+* 			enable registers, driven by the unmodified I2C driver. Each
+* 			controller has its own bus, with memory devices for the
+* 			master and a scripted external master for the slave
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __I2CSIM_H
+#define __I2CSIM_H
+
+#include <stdint.h>
+
+/** External master operations, see I2CSIM_Master() */
+#define I2CSIM_OP_START		0		/**< (Repeated) start, val: SLA+R/W */
+#define I2CSIM_OP_WRITE		1		/**< Write val */
+#define I2CSIM_OP_READ		2		/**< Read a byte, ACK it */
+#define I2CSIM_OP_READ_LAST	3		/**< Read a byte, NACK it */
+#define I2CSIM_OP_STOP		4		/**< Stop */
+
+/**
+ * @brief External master operation, val of a read gets the byte
+ */
+typedef struct {
+	uint8_t op;
+	uint8_t val;
+} I2CSIM_OP_Type;
+
+/**
+ * @brief Model counters
+ */
+typedef struct {
+	uint32_t Accesses;		/**< Register accesses of the driver */
+	uint32_t Instructions;	/**< Instructions since I2CSIM_Start() */
+	uint32_t Violations;	/**< Programming errors seen by the model */
+	uint32_t ExtNack;		/**< Bytes of the external master not acknowledged */
+} I2CSIM_STATS_Type;
+
+void I2CSIM_Init(void);
+void I2CSIM_Device(uint32_t bus, uint8_t addr, uint8_t *mem, uint32_t size);
+void I2CSIM_Inject(uint32_t bus, uint8_t code);
+void I2CSIM_Master(uint32_t bus, I2CSIM_OP_Type *ops, uint32_t num);
+uint32_t I2CSIM_MasterDone(uint32_t bus);
+uint32_t I2CSIM_IrqPending(uint32_t bus);
+uint32_t I2CSIM_Status(uint32_t bus);
+uint32_t I2CSIM_LastStatus(uint32_t bus);
+uint32_t I2CSIM_Busy(uint32_t bus);
+void I2CSIM_Tick(void);
+void I2CSIM_Start(void);
+uint32_t I2CSIM_Stop(void);
+void I2CSIM_GetStats(I2CSIM_STATS_Type *stats);
+const char *I2CSIM_Violation(void);
+
+#endif /* __I2CSIM_H */
@@ -0,0 +1,193 @@
+/**********************************************************************
+* $Id$		i2c_monitor_stream.c  				2010-07-16
+*//**
+* @file		i2c_monitor_stream.c
+* @brief	This example describes how to use I2C peripheral on LPC1768
+* 			in monitor mode as a continuous bus sniffer, streaming time
+* 			stamped events to the host over UART0 in binary
+* @version	1.0
+* @date		16. July. 2010
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2010, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_i2c.h"
+#include "lpc17xx_uart.h"
+#include "lpc17xx_timer.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup I2C_Monitor_Stream	Monitor_Stream
+ * @ingroup I2C_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINITIONS *************************/
+#define I2CDEV 			LPC_I2C0
+#define STREAM_UART		LPC_UART0
+#define STREAM_BAUD		921600
+
+/** Capture ring size (events), must be a power of 2 */
+#define RING_SIZE		1024
+/** Max number of events sent in one packet */
+#define PACKET_EVENTS	32
+
+/** Packet sync bytes */
+#define SYNC0			0xA5
+#define SYNC1			0x5A
+
+/************************** PRIVATE VARIABLES *************************/
+/** Capture ring */
+I2C_MON_RING_Type ring;
+I2C_MON_EVENT_Type ringbuf[RING_SIZE];
+
+/** Packet header: SYNC0, SYNC1, event count, dropped count (saturated),
+ * followed by event count * 8 bytes I2C_MON_EVENT_Type (little endian) */
+uint8_t header[4];
+I2C_MON_EVENT_Type events[PACKET_EVENTS];
+
+/************************** PRIVATE FUNCTIONS *************************/
+void I2C0_IRQHandler(void);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief 		Main I2C0 interrupt handler sub-routine
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void I2C0_IRQHandler(void)
+{
+	I2C_MonitorRingHandler(I2CDEV);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	PINSEL_CFG_Type PinCfg;
+	UART_CFG_Type UARTConfigStruct;
+	UART_FIFO_CFG_Type UARTFIFOConfigStruct;
+	TIM_TIMERCFG_Type TIM_ConfigStruct;
+	uint32_t num, dropped, lastoverrun;
+
+	/* UART0 block ----------------------------------------------------------------- */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Pinnum = 2;
+	PinCfg.Portnum = 0;
+	PINSEL_ConfigPin(&PinCfg);//TXD0
+	PinCfg.Pinnum = 3;
+	PINSEL_ConfigPin(&PinCfg);//RXD0
+
+	UART_ConfigStructInit(&UARTConfigStruct);
+	UARTConfigStruct.Baud_rate = STREAM_BAUD;
+	UART_Init(STREAM_UART, &UARTConfigStruct);
+	UART_FIFOConfigStructInit(&UARTFIFOConfigStruct);
+	UART_FIFOConfig(STREAM_UART, &UARTFIFOConfigStruct);
+	UART_TxCmd(STREAM_UART, ENABLE);
+
+	/* Time stamp: TIMER0 free running at 1us ------------------------------------- */
+	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_USVAL;
+	TIM_ConfigStruct.PrescaleValue	= 1;
+	TIM_Init(LPC_TIM0, TIM_TIMER_MODE, &TIM_ConfigStruct);
+	TIM_Cmd(LPC_TIM0, ENABLE);
+
+	/* I2C block ------------------------------------------------------------------- */
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Funcnum = 1;
+	PinCfg.Pinnum = 27;
+	PinCfg.Portnum = 0;
+	PINSEL_ConfigPin(&PinCfg);//SDA0
+	PinCfg.Pinnum = 28;
+	PINSEL_ConfigPin(&PinCfg);//SCL0
+
+	// Initialize I2C peripheral
+	I2C_Init(I2CDEV, 100000);
+
+	/* Configure interrupt for I2C in NVIC of ARM core */
+    /* Disable I2C0 interrupt */
+    NVIC_DisableIRQ(I2C0_IRQn);
+    /* preemption = 0, highest priority: a late interrupt loses events */
+    NVIC_SetPriority(I2C0_IRQn, 0);
+
+	/* Enable I2C operation */
+	I2C_Cmd(I2CDEV, ENABLE);
+
+	// Attach capture ring, then start monitoring, never stop
+	I2C_MonitorRingInit(I2CDEV, &ring, ringbuf, RING_SIZE, &LPC_TIM0->TC);
+	I2C_MonitorModeConfig(I2CDEV,(uint32_t)I2C_MONITOR_CFG_MATCHALL, ENABLE);
+	I2C_MonitorModeCmd(I2CDEV, ENABLE);
+    I2C_IntCmd(I2CDEV, ENABLE);
+
+	lastoverrun = 0;
+	while(1)
+	{
+		num = I2C_MonitorRingRead(&ring, events, PACKET_EVENTS);
+		dropped = ring.overrun - lastoverrun;
+		if ((num == 0) && (dropped == 0)){
+			continue;
+		}
+		lastoverrun += dropped;
+
+		header[0] = SYNC0;
+		header[1] = SYNC1;
+		header[2] = (uint8_t) num;
+		header[3] = (uint8_t) ((dropped > 0xFF) ? 0xFF : dropped);
+		UART_Send(STREAM_UART, header, sizeof(header), BLOCKING);
+		UART_Send(STREAM_UART, (uint8_t *)events, num * sizeof(I2C_MON_EVENT_Type), BLOCKING);
+	}
+	return 1;
+}
+
+/* With ARM and GHS toolsets, the entry point is main() - this will
+   allow the linker to generate wrapper code to setup stacks, allocate
+   heap area, and initialize and copy code and data segments. For GNU
+   toolsets, the entry point is through __start() in the crt0_gnu.asm
+   file, and that startup code will setup stacks and data */
+int main(void)
+{
+    return c_entry();
+}
+
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
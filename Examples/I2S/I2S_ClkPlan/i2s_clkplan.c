@@ -0,0 +1,323 @@
+/**********************************************************************
+* $Id$		i2s_clkplan.c			2011-03-09
+*//**
+* @file		i2s_clkplan.c
+* @brief	This example describes how to use the I2S clock planner:
+* 			constant plans built offline, run time planning, and clock
+* 			tracking of an external reference measured by timer capture
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_i2s.h"
+#include "lpc17xx_timer.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_pinsel.h"
+#include "debug_frmwrk.h"
+#include "i2s_clkplan.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup I2S_ClkPlan	I2S_ClkPlan
+ * @ingroup I2S_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINITIONS *************************/
+/** Plan used for clock tracking: 48KHz */
+#define TRACK_PLAN		8
+/** Nominal reference frequency on CAP0.0 */
+#define REF_HZ			1000
+/** Reference periods per measurement: 1s */
+#define REF_PERIODS		1000
+
+/************************** PRIVATE VARIABLES ***********************/
+uint8_t menu[]=
+	"********************************************************************************\n\r"
+	"Hello NXP Semiconductors \n\r"
+	" I2S clock planner demo \n\r"
+	"\t - MCU: LPC17xx \n\r"
+	"\t - Core: ARM CORTEX-M3 \n\r"
+	"\t - Communicate via: UART0 - 115200 bps \n\r"
+	" Rate error of each sample rate, then I2S TX at 48KHz tracks a 1KHz\n\r"
+	" reference on CAP0.0 (P1.26)\n\r"
+	"********************************************************************************\n\r";
+
+/** Clock tracking */
+I2S_CLKTRACK_Type track;
+
+/** Reference captures */
+__IO uint32_t ref_count;
+__IO uint32_t ref_first;
+__IO uint32_t ref_ticks;
+__IO Bool ref_ready;
+
+/************************** PRIVATE FUNCTIONS *************************/
+void TIMER0_IRQHandler(void);
+
+void print_ppb(int32_t ppb);
+void print_plan(const I2S_CLKPLAN_Type *plan);
+void print_menu(void);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		TIMER0 interrupt handler sub-routine: measures the timer
+ * 				ticks over REF_PERIODS reference periods
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void TIMER0_IRQHandler(void)
+{
+	uint32_t cap;
+
+	if (TIM_GetIntCaptureStatus(LPC_TIM0,0))
+	{
+		TIM_ClearIntCapturePending(LPC_TIM0,0);
+		cap = TIM_GetCaptureValue(LPC_TIM0,0);
+		if (ref_count == 0) {
+			ref_first = cap;
+		}
+		if (++ref_count > REF_PERIODS) {
+			ref_ticks = cap - ref_first;
+			ref_ready = TRUE;
+			ref_first = cap;
+			ref_count = 1;
+		}
+	}
+}
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+/*********************************************************************//**
+ * @brief		Print an error in ppm with 3 decimals
+ * @param[in]	ppb		error in parts per billion
+ * @return 		None
+ **********************************************************************/
+void print_ppb(int32_t ppb)
+{
+	uint32_t frac;
+
+	if (ppb < 0) {
+		_DBC('-');
+		ppb = -ppb;
+	} else {
+		_DBC('+');
+	}
+	_DBD32(ppb / 1000);
+	_DBC('.');
+	frac = ppb % 1000;
+	_DBC('0' + (frac / 100));
+	_DBC('0' + ((frac / 10) % 10));
+	_DBC('0' + (frac % 10));
+	_DBG(" ppm");
+}
+
+/*********************************************************************//**
+ * @brief		Print one plan
+ * @param[in]	plan	point to I2S_CLKPLAN_Type structure
+ * @return 		None
+ **********************************************************************/
+void print_plan(const I2S_CLKPLAN_Type *plan)
+{
+	_DBD32(plan->Freq);
+	_DBG("Hz: X/Y ");
+	_DBD32(plan->X);
+	_DBC('/');
+	_DBD32(plan->Y);
+	_DBG(" bitrate ");
+	_DBD32(plan->BitRate);
+	_DBG(" error ");
+	print_ppb(plan->Ppb);
+}
+
+/*********************************************************************//**
+ * @brief		Print menu screen
+ * @param[in]	none
+ * @return 		None
+ **********************************************************************/
+void print_menu(void)
+{
+	_DBG_(menu);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	I2S_CLKPLAN_Type plan;
+	I2S_MODEConf_Type I2S_ClkConfig;
+	I2S_CFG_Type I2S_ConfigStruct;
+	TIM_TIMERCFG_Type TIM_ConfigStruct;
+	TIM_CAPTURECFG_Type TIM_CaptureConfigStruct;
+	PINSEL_CFG_Type PinCfg;
+	uint32_t i;
+
+	/* Initialize debug via UART0
+	 * - 115200bps
+	 * - 8 data bit
+	 * - No parity
+	 * - 1 stop bit
+	 * - No flow control
+	 */
+	debug_frmwrk_init();
+
+	//print menu screen
+	print_menu();
+
+	/* Constant plans are only valid at the CPU clock they were built for */
+	if (SystemCoreClock != i2s_plans[0].Cclk) {
+		_DBG_("CPU clock differs from i2s_clkplan.h, regenerate it!");
+	}
+
+	/* Offline plans against run time plans */
+	for (i = 0; i < I2S_NUM_PLANS; i++) {
+		print_plan(&i2s_plans[i]);
+		plan = i2s_plans[i];
+		plan.PclkDiv = I2S_CLKPLAN_ANY_PCLK;
+		plan.Cclk = SystemCoreClock;
+		if ((I2S_ClkPlan(&plan) != SUCCESS) || (plan.X != i2s_plans[i].X)
+				|| (plan.Y != i2s_plans[i].Y) || (plan.BitRate != i2s_plans[i].BitRate)) {
+			_DBG(" (run time plan differs)");
+		}
+		_DBG_("");
+	}
+	_DBG_("MCLK = 256 * Freq:");
+	for (i = 0; i < I2S_NUM_PLANS; i++) {
+		print_plan(&i2s_plans_mclk[i]);
+		_DBG_("");
+	}
+
+	/* Pin configuration:
+	 * Assign: 	- P0.7 as I2STX_CLK
+	 * 			- P0.8 as I2STX_WS
+	 * 			- P0.9 as I2STX_SDA
+	 * 			- P1.26 as CAP0.0
+	 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Portnum = 0;
+	for (i = 7; i <= 9; i++) {
+		PinCfg.Pinnum = i;
+		PINSEL_ConfigPin(&PinCfg);
+	}
+	PinCfg.Funcnum = 3;
+	PinCfg.Portnum = 1;
+	PinCfg.Pinnum = 26;
+	PINSEL_ConfigPin(&PinCfg);
+
+	/* I2S TX master, 16-bit stereo, 48KHz from the constant plan */
+	I2S_Init(LPC_I2S);
+	I2S_ConfigStruct.wordwidth = I2S_WORDWIDTH_16;
+	I2S_ConfigStruct.mono = I2S_STEREO;
+	I2S_ConfigStruct.stop = I2S_STOP_ENABLE;
+	I2S_ConfigStruct.reset = I2S_RESET_ENABLE;
+	I2S_ConfigStruct.ws_sel = I2S_MASTER_MODE;
+	I2S_ConfigStruct.mute = I2S_MUTE_DISABLE;
+	I2S_Config(LPC_I2S,I2S_TX_MODE,&I2S_ConfigStruct);
+
+	I2S_ClkConfig.clksel = I2S_CLKSEL_FRDCLK;
+	I2S_ClkConfig.fpin = I2S_4PIN_DISABLE;
+	I2S_ClkConfig.mcena = I2S_MCLK_DISABLE;
+	I2S_ModeConfig(LPC_I2S,&I2S_ClkConfig,I2S_TX_MODE);
+
+	I2S_ClkPlanApply(LPC_I2S, &i2s_plans[TRACK_PLAN], I2S_TX_MODE);
+	I2S_Start(LPC_I2S);
+
+	/* Clock tracking */
+	track.RefHz = REF_HZ;
+	track.TimerHz = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_TIMER0);
+	track.TRMode = I2S_TX_MODE;
+	track.Shift = 3;
+	I2S_ClkTrackInit(&track, &i2s_plans[TRACK_PLAN]);
+
+	/* TIMER0 counts PCLK, captures rising edges of CAP0.0 */
+	ref_count = 0;
+	ref_ready = FALSE;
+	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_TICKVAL;
+	TIM_ConfigStruct.PrescaleValue	= 1;
+	TIM_CaptureConfigStruct.CaptureChannel = 0;
+	TIM_CaptureConfigStruct.RisingEdge = ENABLE;
+	TIM_CaptureConfigStruct.FallingEdge = DISABLE;
+	TIM_CaptureConfigStruct.IntOnCaption = ENABLE;
+	TIM_Init(LPC_TIM0, TIM_TIMER_MODE,&TIM_ConfigStruct);
+	TIM_ConfigCapture(LPC_TIM0, &TIM_CaptureConfigStruct);
+	TIM_ResetCounter(LPC_TIM0);
+	/* preemption = 1, sub-priority = 1 */
+	NVIC_SetPriority(TIMER0_IRQn, ((0x01<<3)|0x01));
+	NVIC_EnableIRQ(TIMER0_IRQn);
+	TIM_Cmd(LPC_TIM0,ENABLE);
+
+	_DBG_("Tracking the reference on CAP0.0...");
+	while (1) {
+		if (ref_ready == FALSE) {
+			continue;
+		}
+		ref_ready = FALSE;
+		I2S_ClkTrackUpdate(LPC_I2S, &track, REF_PERIODS, ref_ticks);
+		_DBG("Correction ");
+		print_ppb(track.Ppb);
+		_DBG(" X/Y ");
+		_DBD32(track.lo_x);
+		_DBC('/');
+		_DBD32(track.lo_y);
+		_DBG(" - ");
+		_DBD32(track.hi_x);
+		_DBC('/');
+		_DBD32(track.hi_y);
+		_DBG(" rejected ");
+		_DBD32(track.rejected);
+		_DBG_("");
+	}
+	return 1;
+}
+
+/* With ARM and GHS toolsets, the entry point is main() - this will
+   allow the linker to generate wrapper code to setup stacks, allocate
+   heap area, and initialize and copy code and data segments. For GNU
+   toolsets, the entry point is through __start() in the crt0_gnu.asm
+   file, and that startup code will setup stacks and data */
+int main(void)
+{
+    return c_entry();
+}
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
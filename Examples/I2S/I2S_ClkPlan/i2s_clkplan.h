@@ -0,0 +1,63 @@
+/* Generated by i2s_clkplan_gen, do not edit */
+#ifndef I2S_CLKPLAN_H_
+#define I2S_CLKPLAN_H_
+
+#define I2S_NUM_PLANS	11
+
+/* i2s_plans: MCLK not used, CCLK 100000000Hz
+ *  Freq  PCLK   X   Y  BR  error(ppm) | best PLL0 (12MHz):   M  N CFG      CCLK  error(ppm)
+ *  8000  /4   64 125  24      +0.000 |                    12  1  2  96000000      +0.000
+ * 11025  /1   65 196  46      +1.969 |                    12  1  2  96000000      +0.000
+ * 12000  /4   96 125  24      +0.000 |                    12  1  2  96000000      +0.000
+ * 16000  /1   32 125  24      +0.000 |                    12  1  2  96000000      +0.000
+ * 22050  /1   65  98  46      +1.969 |                    12  1  2  96000000      +0.000
+ * 24000  /1   48 125  24      +0.000 |                    12  1  2  96000000      +0.000
+ * 32000  /1   64 125  24      +0.000 |                    12  1  2  96000000      +0.000
+ * 44100  /1   58 137  14      -5.517 |                    12  1  2  96000000      +0.000
+ * 48000  /1   96 125  24      +0.000 |                    12  1  2  96000000      +0.000
+ * 88200  /1  116 137  14      -5.517 |                    12  1  2  96000000      +0.000
+ * 96000  /4   29 118   0     +11.034 |                    12  1  2  96000000      +0.000
+ */
+static const I2S_CLKPLAN_Type i2s_plans[11] = {
+	{100000000, 8000, 0, 16, 0, 64, 125, 24, 0, 0},
+	{100000000, 11025, 0, 16, 1, 65, 196, 46, 0, 1969},
+	{100000000, 12000, 0, 16, 0, 96, 125, 24, 0, 0},
+	{100000000, 16000, 0, 16, 1, 32, 125, 24, 0, 0},
+	{100000000, 22050, 0, 16, 1, 65, 98, 46, 0, 1969},
+	{100000000, 24000, 0, 16, 1, 48, 125, 24, 0, 0},
+	{100000000, 32000, 0, 16, 1, 64, 125, 24, 0, 0},
+	{100000000, 44100, 0, 16, 1, 58, 137, 14, 0, -5517},
+	{100000000, 48000, 0, 16, 1, 96, 125, 24, 0, 0},
+	{100000000, 88200, 0, 16, 1, 116, 137, 14, 0, -5517},
+	{100000000, 96000, 0, 16, 0, 29, 118, 0, 0, 11034},
+};
+
+/* i2s_plans_mclk: MCLK = 256 * Freq, CCLK 100000000Hz
+ *  Freq  PCLK   X   Y  BR  error(ppm) | best PLL0 (12MHz):   M  N CFG      CCLK  error(ppm)
+ *  8000  /4   29 177   7     +11.034 |                    16  1  4  76800000      +0.000
+ * 11025  /4    7  31   7     +64.004 |                    14  1  4  67200000      +0.000
+ * 12000  /4   29 118   7     +11.034 |                    12  1  2  96000000      +0.000
+ * 16000  /4   58 177   7     +11.034 |                    16  1  4  76800000      +0.000
+ * 22050  /4   14  31   7     +64.004 |                    14  1  4  67200000      +0.000
+ * 24000  /4   29  59   7     +11.034 |                    12  1  2  96000000      +0.000
+ * 32000  /4  116 177   7     +11.034 |                    16  1  4  76800000      +0.000
+ * 44100  /4   28  31   7     +64.004 |                    14  1  4  67200000      +0.000
+ * 48000  /4   58  59   7     +11.034 |                    12  1  2  96000000      +0.000
+ * 88200  /1   14  31   7     +64.004 |                    14  1  4  67200000      +0.000
+ * 96000  /1   29  59   7     +11.034 |                    12  1  2  96000000      +0.000
+ */
+static const I2S_CLKPLAN_Type i2s_plans_mclk[11] = {
+	{100000000, 8000, 256, 16, 0, 29, 177, 7, 0, 11034},
+	{100000000, 11025, 256, 16, 0, 7, 31, 7, 0, 64004},
+	{100000000, 12000, 256, 16, 0, 29, 118, 7, 0, 11034},
+	{100000000, 16000, 256, 16, 0, 58, 177, 7, 0, 11034},
+	{100000000, 22050, 256, 16, 0, 14, 31, 7, 0, 64004},
+	{100000000, 24000, 256, 16, 0, 29, 59, 7, 0, 11034},
+	{100000000, 32000, 256, 16, 0, 116, 177, 7, 0, 11034},
+	{100000000, 44100, 256, 16, 0, 28, 31, 7, 0, 64004},
+	{100000000, 48000, 256, 16, 0, 58, 59, 7, 0, 11034},
+	{100000000, 88200, 256, 16, 1, 14, 31, 7, 0, 64004},
+	{100000000, 96000, 256, 16, 1, 29, 59, 7, 0, 11034},
+};
+
+#endif /* I2S_CLKPLAN_H_ */
@@ -0,0 +1,149 @@
+/**********************************************************************
+* $Id$		i2s_clkplan_gen.c			2011-03-09
+*//**
+* @file		i2s_clkplan_gen.c
+* @brief	Host I2S clock planner: plans all standard sample rates with
+* 			I2S_ClkPlan() at the default CPU clock and over all PLL0
+* 			settings, and prints them as constant plans with their rate
+* 			error (i2s_clkplan.h)
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "lpc17xx_i2s.h"
+#include "lpc17xx_clkpwr.h"
+
+/** Default CPU clock (system_LPC17xx.c: 12MHz, PLL0 M=100 N=6, /4) */
+#define PLAN_CCLK		100000000
+/** Main oscillator */
+#define PLAN_FIN		12000000
+/** Word width (bits) */
+#define PLAN_WIDTH		16
+/** MCLK / Freq for the codec plans */
+#define PLAN_MCLK_RATIO	256
+
+/* Functions and variables used by I2S driver functions that are never
+ * called on host, only needed to link */
+uint32_t SystemCoreClock = PLAN_CCLK;
+void CLKPWR_ConfigPPWR (uint32_t PPType, FunctionalState NewState) {}
+void CLKPWR_SetPCLKDiv (uint32_t ClkType, uint32_t DivVal) {}
+uint32_t CLKPWR_GetPCLKSEL (uint32_t ClkType) { return 0; }
+uint32_t CLKPWR_GetPCLK (uint32_t ClkType) { return 1; }
+
+/* CHECK_PARAM failure in the driver (built in DEBUG mode) */
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "i2s_clkplan_gen: check failed in %s line %u\n", (char *)file, line);
+	exit(1);
+}
+
+const uint32_t rates[] = {
+	8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000, 88200, 96000
+};
+#define NUM_RATES	(sizeof(rates) / sizeof(rates[0]))
+
+const uint8_t pclkdiv[4] = {4, 1, 2, 8};
+
+/* Plan one rate, return 0 if no setting exists */
+static int plan_rate(uint32_t cclk, uint32_t freq, uint16_t mclk, I2S_CLKPLAN_Type *plan)
+{
+	plan->Cclk = cclk;
+	plan->Freq = freq;
+	plan->MclkRatio = mclk;
+	plan->WordWidth = PLAN_WIDTH;
+	plan->PclkDiv = I2S_CLKPLAN_ANY_PCLK;
+	return (I2S_ClkPlan(plan) == SUCCESS);
+}
+
+/* Best PLL0 setting for one rate: FCCO 275 to 550MHz, CCLK 60 to 100MHz
+ * (CCLKCFG >= 2) */
+static void plan_pll(uint32_t freq, uint16_t mclk)
+{
+	I2S_CLKPLAN_Type plan;
+	uint32_t m, n, d, fcco, cclk, best_m = 0, best_n = 0, best_d = 0;
+	int32_t best = 0x7FFFFFFF;
+
+	for (n = 1; n <= 4; n++) {
+		for (m = 6; m <= 512; m++) {
+			fcco = (uint32_t)((2ULL * m * PLAN_FIN) / n);
+			if ((fcco < 275000000) || (fcco > 550000000)) {
+				continue;
+			}
+			for (d = 3; d <= 9; d++) {
+				cclk = fcco / d;
+				if ((cclk < 60000000) || (cclk > 100000000) || ((fcco % d) != 0)) {
+					continue;
+				}
+				if (plan_rate(cclk, freq, mclk, &plan)
+						&& (abs(plan.Ppb) < abs(best))) {
+					best = plan.Ppb;
+					best_m = m; best_n = n; best_d = d;
+				}
+			}
+		}
+	}
+	if (best_m == 0) {
+		printf(" *   no PLL0 setting\r\n");
+		return;
+	}
+	printf("%3u %2u %2u %9u %+11.3f\r\n", best_m, best_n, best_d - 1,
+			(uint32_t)((2ULL * best_m * PLAN_FIN) / best_n / best_d), best / 1000.0);
+}
+
+/* Print the report and constant plans of one MCLK ratio */
+static void print_plans(const char *name, uint16_t mclk)
+{
+	I2S_CLKPLAN_Type plan[NUM_RATES];
+	uint32_t i;
+
+	printf("/* %s: MCLK %s, CCLK %uHz\r\n", name,
+			mclk ? "= 256 * Freq" : "not used", PLAN_CCLK);
+	printf(" *  Freq  PCLK   X   Y  BR  error(ppm) | best PLL0 (12MHz):"
+			"   M  N CFG      CCLK  error(ppm)\r\n");
+	for (i = 0; i < NUM_RATES; i++) {
+		if (!plan_rate(PLAN_CCLK, rates[i], mclk, &plan[i])) {
+			fprintf(stderr, "i2s_clkplan_gen: no plan for %u\n", rates[i]);
+			exit(1);
+		}
+		printf(" * %5u  /%u  %3u %3u  %2u %+11.3f |                   ", rates[i],
+				pclkdiv[plan[i].PclkDiv], plan[i].X, plan[i].Y, plan[i].BitRate,
+				plan[i].Ppb / 1000.0);
+		plan_pll(rates[i], mclk);
+	}
+	printf(" */\r\n");
+	printf("static const I2S_CLKPLAN_Type %s[%u] = {\r\n", name, (uint32_t)NUM_RATES);
+	for (i = 0; i < NUM_RATES; i++) {
+		printf("\t{%u, %u, %u, %u, %u, %u, %u, %u, 0, %d},\r\n", PLAN_CCLK, rates[i],
+				mclk, PLAN_WIDTH, plan[i].PclkDiv, plan[i].X, plan[i].Y,
+				plan[i].BitRate, plan[i].Ppb);
+	}
+	printf("};\r\n\r\n");
+}
+
+int main(void)
+{
+	printf("/* Generated by i2s_clkplan_gen, do not edit */\r\n");
+	printf("#ifndef I2S_CLKPLAN_H_\r\n#define I2S_CLKPLAN_H_\r\n\r\n");
+	printf("#define I2S_NUM_PLANS\t%u\r\n\r\n", (uint32_t)NUM_RATES);
+	print_plans("i2s_plans", 0);
+	print_plans("i2s_plans_mclk", PLAN_MCLK_RATIO);
+	printf("#endif /* I2S_CLKPLAN_H_ */\r\n");
+	return 0;
+}
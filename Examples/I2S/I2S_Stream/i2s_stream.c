@@ -0,0 +1,293 @@
+/**********************************************************************
+* $Id$		i2s_stream.c			2011-03-09
+*//**
+* @file		i2s_stream.c
+* @brief	This example describes how to use the I2S full-duplex stream:
+* 			TX and RX rings moved by GPDMA, each received period processed
+* 			into one period of output
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_i2s.h"
+#include "lpc17xx_libcfg.h"
+#include "lpc17xx_gpdma.h"
+#include "debug_frmwrk.h"
+#include "lpc17xx_pinsel.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup I2S_Stream	I2S_Stream
+ * @ingroup I2S_Examples
+ * @{
+ */
+
+/************************** PRIVATE DEFINITIONS *************************/
+/** Un-comment to process periods in the GPDMA interrupt (lowest latency)
+ * instead of the main loop */
+//#define PROCESS_IN_IRQ
+
+/** Sample rate */
+#define STREAM_RATE		48000
+/** Frames per period: 1ms */
+#define PERIOD_SIZE		48
+/** Periods per ring */
+#define NUM_PERIODS		4
+/** Periods of silence before the first processed period */
+#define STREAM_LEAD		2
+/** GPDMA channels */
+#define TX_DMA_CH		0
+#define RX_DMA_CH		1
+
+/** Ramp step per frame of the left output channel (q31) */
+#define RAMP_STEP		(1 << 24)
+
+/************************** PRIVATE VARIABLES ***********************/
+uint8_t menu[]=
+	"********************************************************************************\n\r"
+	"Hello NXP Semiconductors \n\r"
+	" I2S full-duplex stream demo \n\r"
+	"\t - MCU: LPC17xx \n\r"
+	"\t - Core: ARM CORTEX-M3 \n\r"
+	"\t - Communicate via: UART0 - 115200 bps \n\r"
+	" I2S TX is looped back to I2S RX, 48KHz 16-bit stereo, 1ms periods\n\r"
+	" Left output: ramp, right output: left input (loop back delay)\n\r"
+	"********************************************************************************\n\r";
+
+/** Full-duplex stream */
+I2S_STREAM_Type stream;
+uint32_t txbuf[NUM_PERIODS * PERIOD_SIZE];
+uint32_t rxbuf[NUM_PERIODS * PERIOD_SIZE];
+GPDMA_LLI_Type txlli[NUM_PERIODS];
+GPDMA_LLI_Type rxlli[NUM_PERIODS];
+int32_t work_in[2 * PERIOD_SIZE];
+int32_t work_out[2 * PERIOD_SIZE];
+
+/** Left output ramp */
+int32_t ramp;
+
+/************************** PRIVATE FUNCTIONS *************************/
+void DMA_IRQHandler (void);
+
+void Process(void *arg, const void *in, void *out, uint32_t frames);
+void print_menu(void);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		GPDMA interrupt handler sub-routine
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void DMA_IRQHandler (void)
+{
+	I2S_StreamDMAHandler(&stream);
+#ifdef PROCESS_IN_IRQ
+	I2S_StreamProcess(&stream);
+#endif
+}
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+/*********************************************************************//**
+ * @brief		Process one period of q31 samples: a ramp is sent on the
+ * 				left channel and the left input is sent back on the right
+ * 				channel
+ * @param[in]	arg		unused
+ * @param[in]	in		input samples L, R...
+ * @param[out]	out		output samples L, R...
+ * @param[in]	frames	number of frames
+ * @return 		None
+ **********************************************************************/
+void Process(void *arg, const void *in, void *out, uint32_t frames)
+{
+	const int32_t *src = (const int32_t *) in;
+	int32_t *dst = (int32_t *) out;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		dst[2 * i] = ramp;
+		dst[(2 * i) + 1] = src[2 * i];
+		ramp += RAMP_STEP;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Print menu screen
+ * @param[in]	none
+ * @return 		None
+ **********************************************************************/
+void print_menu(void)
+{
+	_DBG_(menu);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	I2S_MODEConf_Type I2S_ClkConfig;
+	I2S_CFG_Type I2S_ConfigStruct;
+	PINSEL_CFG_Type PinCfg;
+	uint32_t i, last;
+
+	/* Initialize debug via UART0
+	 * - 115200bps
+	 * - 8 data bit
+	 * - No parity
+	 * - 1 stop bit
+	 * - No flow control
+	 */
+	debug_frmwrk_init();
+
+	//print menu screen
+	print_menu();
+
+	/* Pin configuration:
+	 * Assign: 	- P0.4 as I2SRX_CLK
+	 * 			- P0.5 as I2SRX_WS
+	 * 			- P0.6 as I2SRX_SDA
+	 * 			- P0.7 as I2STX_CLK
+	 * 			- P0.8 as I2STX_WS
+	 * 			- P0.9 as I2STX_SDA
+	 */
+	PinCfg.Funcnum = 1;
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Portnum = 0;
+	for (i = 4; i <= 9; i++) {
+		PinCfg.Pinnum = i;
+		PINSEL_ConfigPin(&PinCfg);
+	}
+
+	/* Initialize I2S */
+	I2S_Init(LPC_I2S);
+
+	/* 16-bit stereo, master TX, slave RX clocked by TX */
+	I2S_ConfigStruct.wordwidth = I2S_WORDWIDTH_16;
+	I2S_ConfigStruct.mono = I2S_STEREO;
+	I2S_ConfigStruct.stop = I2S_STOP_ENABLE;
+	I2S_ConfigStruct.reset = I2S_RESET_ENABLE;
+	I2S_ConfigStruct.ws_sel = I2S_MASTER_MODE;
+	I2S_ConfigStruct.mute = I2S_MUTE_DISABLE;
+	I2S_Config(LPC_I2S,I2S_TX_MODE,&I2S_ConfigStruct);
+
+	I2S_ConfigStruct.ws_sel = I2S_SLAVE_MODE;
+	I2S_Config(LPC_I2S,I2S_RX_MODE,&I2S_ConfigStruct);
+
+	I2S_ClkConfig.clksel = I2S_CLKSEL_FRDCLK;
+	I2S_ClkConfig.fpin = I2S_4PIN_DISABLE;
+	I2S_ClkConfig.mcena = I2S_MCLK_DISABLE;
+	I2S_ModeConfig(LPC_I2S,&I2S_ClkConfig,I2S_TX_MODE);
+	I2S_ModeConfig(LPC_I2S,&I2S_ClkConfig,I2S_RX_MODE);
+
+	I2S_FreqConfig(LPC_I2S, STREAM_RATE, I2S_TX_MODE);
+	I2S_SetBitRate(LPC_I2S, 0, I2S_RX_MODE);
+
+	/* GPDMA block section -------------------------------------------- */
+	/* Disable GPDMA interrupt */
+	NVIC_DisableIRQ(DMA_IRQn);
+	/* preemption = 1, sub-priority = 1 */
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+
+	/* Initialize GPDMA controller */
+	GPDMA_Init();
+
+	stream.TxDMAChannel = TX_DMA_CH;
+	stream.RxDMAChannel = RX_DMA_CH;
+	stream.Format = I2S_STREAM_Q31;
+	stream.Lead = STREAM_LEAD;
+	stream.PeriodSize = PERIOD_SIZE;
+	stream.NumPeriods = NUM_PERIODS;
+	stream.txbuf = txbuf;
+	stream.rxbuf = rxbuf;
+	stream.txlli = txlli;
+	stream.rxlli = rxlli;
+	stream.work_in = work_in;
+	stream.work_out = work_out;
+	stream.Process = Process;
+	stream.arg = NULL;
+	if (I2S_StreamInit(LPC_I2S, &stream) != SUCCESS) {
+		_DBG_("GPDMA channel is busy");
+		while (1);
+	}
+
+	/* Enable GPDMA interrupt */
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	I2S_StreamStart(LPC_I2S, &stream);
+
+	last = 0;
+	while (1) {
+#ifndef PROCESS_IN_IRQ
+		I2S_StreamProcess(&stream);
+#endif
+		// Statistics every second
+		if ((stream.rx_read - last) < (STREAM_RATE / PERIOD_SIZE)) {
+			continue;
+		}
+		last = stream.rx_read;
+		_DBG("Periods: ");
+		_DBD32(stream.rx_read);
+		_DBG(" underruns: ");
+		_DBD32(stream.underrun);
+		_DBG(" overruns: ");
+		_DBD32(stream.overrun);
+		_DBG(" errors: ");
+		_DBD32(stream.error);
+		_DBG(" latency (us): ");
+		_DBD32((stream.latency * 1000) / (STREAM_RATE / 1000));
+		_DBG_("");
+	}
+	I2S_StreamStop(LPC_I2S, &stream);
+	I2S_DeInit(LPC_I2S);
+	return 1;
+}
+
+/* With ARM and GHS toolsets, the entry point is main() - this will
+   allow the linker to generate wrapper code to setup stacks, allocate
+   heap area, and initialize and copy code and data segments. For GNU
+   toolsets, the entry point is through __start() in the crt0_gnu.asm
+   file, and that startup code will setup stacks and data */
+int main(void)
+{
+    return c_entry();
+}
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
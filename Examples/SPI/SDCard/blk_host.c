@@ -0,0 +1,775 @@
+/**********************************************************************
+* $Id$		blk_host.c			2011-03-09
+*//**
+* @file		blk_host.c
+* @brief	Host test of the block device layer: the synchronous helpers
+* 			and the sector cache in front of a RAM disk whose requests
+* 			complete some Poll() calls later. Checks the cache against a
+* 			reference copy of the disk under random requests, its
+* 			read-ahead, write coalescing, idle write-back and error
+* 			handling
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lpc17xx_blkdev.h"
+
+/* RAM disk */
+#define RAM_BLOCK			512
+#define RAM_BLOCKS			2048
+
+/* Lower device operations */
+#define RAM_OP_NONE			0
+#define RAM_OP_READ			1
+#define RAM_OP_WRITE		2
+#define RAM_OP_SYNC			3
+
+/* Test parameters */
+#define HOST_MAX_BLOCKS		64			/* Largest random request */
+#define HOST_RANDOM_OPS		4000		/* Random requests per configuration */
+#define HOST_MAX_POLLS		100000		/* Poll() calls before a request hangs */
+#define HOST_SEQ_BLOCKS		1024		/* Sequential read and write runs */
+#define HOST_SEQ_CHUNK		4			/* Blocks per sequential read */
+
+/* Test failure: print the failed condition and stop */
+#define HOST_ASSERT(x)	do { if (!(x)) { \
+		fprintf(stderr, "blk_host: %s line %d: %s\n", __FILE__, __LINE__, #x); \
+		exit(1); } } while (0)
+
+/**
+ * @brief RAM disk: a block device whose requests complete Delay Poll()
+ * calls after they are started, at once when Delay is 0
+ */
+typedef struct {
+	BLKDEV_Type dev;
+	uint32_t Delay;			/**< Poll() calls before completion */
+	uint32_t FailOp;		/**< Operation completed with ERROR, 0 none */
+	uint32_t RefuseOp;		/**< Operation refused at start, 0 none */
+	uint32_t wait;			/**< Poll() calls left */
+	uint32_t op, lba, n;	/**< Operation in progress */
+	uint8_t *buf;
+	uint32_t ops;			/**< Operations started */
+	uint32_t reads, writes, syncs;
+	uint32_t rblocks, wblocks;
+	uint32_t rmin, rmax;	/**< Blocks per read, smallest and largest */
+	uint32_t wmin, wmax;	/**< Blocks per write, smallest and largest */
+	uint32_t violations;	/**< Requests while busy or out of range */
+} RAM_DEV_Type;
+
+/**
+ * @brief Cache configuration of a random test
+ */
+typedef struct {
+	uint8_t NumLines;
+	uint8_t LineBlocks;
+	uint8_t ReadAhead;
+	uint32_t FlushDelay;
+	uint32_t Delay;			/**< RAM disk completion delay */
+	uint32_t Blocks;		/**< RAM disk size */
+} HOST_CFG_Type;
+
+static const HOST_CFG_Type host_cfg[] = {
+	{ 1,  1,  0,  0,   0, RAM_BLOCKS },
+	{ 4,  8,  2,  500, 0, RAM_BLOCKS },
+	{ 4,  8,  2,  500, 1, RAM_BLOCKS },
+	{ 8,  4,  3,  20,  3, RAM_BLOCKS },
+	{ 3,  5,  1,  7,   1, RAM_BLOCKS - 3 },
+	{ 32, 32, 31, 5,   2, RAM_BLOCKS - 1 }
+};
+
+static RAM_DEV_Type ram;
+static BLK_CACHE_Type cache;
+static uint8_t ram_data[RAM_BLOCKS * RAM_BLOCK];
+static uint8_t host_ref[RAM_BLOCKS * RAM_BLOCK];
+static uint8_t host_buf[BLK_CACHE_LINE_MAX * BLK_CACHE_BLOCKS_MAX * RAM_BLOCK];
+static uint8_t host_wr[HOST_MAX_BLOCKS * RAM_BLOCK];
+static uint8_t host_rd[HOST_MAX_BLOCKS * RAM_BLOCK];
+static uint32_t host_seed = 1;
+static uint32_t host_done;
+static Status host_status;
+static uint32_t host_chain_lba, host_chain_end;
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Pseudo random numbers
+ * @param[in]	None
+ * @return		Next value
+ **********************************************************************/
+static uint32_t host_Rand(void)
+{
+	host_seed = host_seed * 1103515245UL + 12345;
+	return host_seed >> 8;
+}
+
+/*********************************************************************//**
+ * @brief		Fill a buffer with random bytes
+ * @param[out]	buf		Buffer
+ * @param[in]	len		Number of bytes
+ * @return		None
+ **********************************************************************/
+static void host_Fill(uint8_t *buf, uint32_t len)
+{
+	while (len--) {
+		*buf++ = (uint8_t)host_Rand();
+	}
+}
+
+
+/*-------------------------------- RAM disk -----------------------------------*/
+
+/*********************************************************************//**
+ * @brief		End the operation in progress: move the data, then call
+ * 				the completion callback. A failed read returns garbage, a
+ * 				failed write leaves the disk unchanged.
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void ram_Complete(void)
+{
+	Status status = (ram.ops == ram.FailOp) ? ERROR : SUCCESS;
+
+	if (ram.op == RAM_OP_READ) {
+		if (status == SUCCESS) {
+			memcpy(ram.buf, &ram_data[ram.lba * RAM_BLOCK], ram.n * RAM_BLOCK);
+		} else {
+			memset(ram.buf, 0xEE, ram.n * RAM_BLOCK);
+		}
+	} else if ((ram.op == RAM_OP_WRITE) && (status == SUCCESS)) {
+		memcpy(&ram_data[ram.lba * RAM_BLOCK], ram.buf, ram.n * RAM_BLOCK);
+	}
+	ram.op = RAM_OP_NONE;
+	ram.dev.Busy = FALSE;
+	ram.dev.Done(ram.dev.arg, status);
+}
+
+/*********************************************************************//**
+ * @brief		Start an operation, see BLKDEV_Type
+ * @param[in]	op		RAM_OP_READ, RAM_OP_WRITE or RAM_OP_SYNC
+ * @param[in]	lba		First block
+ * @param[in]	buf		Data buffer
+ * @param[in]	n		Number of blocks
+ * @return		ERROR if refused, otherwise SUCCESS
+ **********************************************************************/
+static Status ram_Start(uint32_t op, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	if (ram.dev.Busy || ((op != RAM_OP_SYNC) && ((n == 0)
+			|| (lba >= ram.dev.BlockCount) || (n > (ram.dev.BlockCount - lba))))) {
+		ram.violations++;
+		return ERROR;
+	}
+	if (++ram.ops == ram.RefuseOp) {
+		return ERROR;
+	}
+
+	if (op == RAM_OP_READ) {
+		ram.reads++;
+		ram.rblocks += n;
+		if ((ram.rmin == 0) || (n < ram.rmin)) {
+			ram.rmin = n;
+		}
+		if (n > ram.rmax) {
+			ram.rmax = n;
+		}
+	} else if (op == RAM_OP_WRITE) {
+		ram.writes++;
+		ram.wblocks += n;
+		if ((ram.wmin == 0) || (n < ram.wmin)) {
+			ram.wmin = n;
+		}
+		if (n > ram.wmax) {
+			ram.wmax = n;
+		}
+	} else {
+		ram.syncs++;
+	}
+	ram.op = op;
+	ram.lba = lba;
+	ram.buf = buf;
+	ram.n = n;
+	ram.dev.Busy = TRUE;
+	ram.wait = ram.Delay;
+	if (ram.wait == 0) {
+		ram_Complete();
+	}
+	return SUCCESS;
+}
+
+static Status ram_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	return ram_Start(RAM_OP_READ, lba, buf, n);
+}
+
+static Status ram_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *buf, uint32_t n)
+{
+	return ram_Start(RAM_OP_WRITE, lba, (uint8_t *)buf, n);
+}
+
+static Status ram_Sync(BLKDEV_Type *dev)
+{
+	return ram_Start(RAM_OP_SYNC, 0, NULL, 0);
+}
+
+static void ram_Poll(BLKDEV_Type *dev)
+{
+	if ((ram.op != RAM_OP_NONE) && (--ram.wait == 0)) {
+		ram_Complete();
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Set up the RAM disk with random content, clear its
+ * 				counters
+ * @param[in]	blocks	Size
+ * @param[in]	delay	Completion delay, Poll() calls
+ * @return		None
+ **********************************************************************/
+static void ram_Init(uint32_t blocks, uint32_t delay)
+{
+	memset(&ram, 0, sizeof(ram));
+	ram.dev.BlockSize = RAM_BLOCK;
+	ram.dev.BlockCount = blocks;
+	ram.dev.Read = ram_Read;
+	ram.dev.Write = ram_Write;
+	ram.dev.Sync = ram_Sync;
+	ram.dev.Poll = ram_Poll;
+	ram.Delay = delay;
+	host_Fill(ram_data, sizeof(ram_data));
+	memcpy(host_ref, ram_data, sizeof(ram_data));
+}
+
+
+/*------------------------------- Requests ------------------------------------*/
+
+/*********************************************************************//**
+ * @brief		Completion callback of the cache. In a chained read, the
+ * 				callback starts the next request, as the MSC transport does.
+ * @param[in]	arg		Not used
+ * @param[in]	status	Request status
+ * @return		None
+ **********************************************************************/
+static void host_Done(void *arg, Status status)
+{
+	uint32_t n;
+
+	host_done++;
+	host_status = status;
+	if ((status == SUCCESS) && (host_chain_lba < host_chain_end)) {
+		n = HOST_SEQ_CHUNK;
+		HOST_ASSERT(cache.dev.Read(&cache.dev, host_chain_lba,
+				&host_rd[(host_chain_lba % HOST_MAX_BLOCKS) * RAM_BLOCK], n) == SUCCESS);
+		host_chain_lba += n;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Run a request on the cache and poll it to completion.
+ * 				Checks that a second request is refused while it runs and
+ * 				that the completion callback is called exactly once.
+ * @param[in]	op		RAM_OP_READ, RAM_OP_WRITE or RAM_OP_SYNC
+ * @param[in]	lba		First block
+ * @param[in]	buf		Data buffer
+ * @param[in]	n		Number of blocks
+ * @return		Request status
+ **********************************************************************/
+static Status host_Request(uint32_t op, uint32_t lba, uint8_t *buf, uint32_t n)
+{
+	BLKDEV_Type *dev = &cache.dev;
+	uint32_t done = host_done, polls;
+	Status ret;
+
+	if (op == RAM_OP_READ) {
+		ret = dev->Read(dev, lba, buf, n);
+	} else if (op == RAM_OP_WRITE) {
+		ret = dev->Write(dev, lba, buf, n);
+	} else {
+		ret = dev->Sync(dev);
+	}
+	HOST_ASSERT(ret == SUCCESS);
+	if (dev->Busy) {
+		HOST_ASSERT(dev->Read(dev, 0, host_buf, 1) == ERROR);
+		HOST_ASSERT(dev->Sync(dev) == ERROR);
+		HOST_ASSERT(BLK_Read(dev, 0, host_buf, 1) == ERROR);
+	}
+	for (polls = 0; host_done == done; polls++) {
+		HOST_ASSERT(polls < HOST_MAX_POLLS);
+		BLK_Poll(dev);
+	}
+	// A chained request may have started, and ended, from the callback
+	HOST_ASSERT((host_done == done + 1) || (host_chain_end != 0));
+	HOST_ASSERT(!dev->Busy || (host_chain_end != 0));
+	return host_status;
+}
+
+/*********************************************************************//**
+ * @brief		Poll the cache
+ * @param[in]	n		Number of Poll() calls
+ * @return		None
+ **********************************************************************/
+static void host_Poll(uint32_t n)
+{
+	while (n--) {
+		BLK_Poll(&cache.dev);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Poll the cache until background work is over
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Quiesce(void)
+{
+	uint32_t polls;
+
+	for (polls = 0; ram.dev.Busy; polls++) {
+		HOST_ASSERT(polls < HOST_MAX_POLLS);
+		BLK_Poll(&cache.dev);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Set up the cache in front of the RAM disk
+ * @param[in]	cfg		Configuration
+ * @return		None
+ **********************************************************************/
+static void host_Setup(const HOST_CFG_Type *cfg)
+{
+	ram_Init(cfg->Blocks, cfg->Delay);
+	memset(&cache, 0, sizeof(cache));
+	cache.Lower = &ram.dev;
+	cache.Buf = host_buf;
+	cache.NumLines = cfg->NumLines;
+	cache.LineBlocks = cfg->LineBlocks;
+	cache.ReadAhead = cfg->ReadAhead;
+	cache.FlushDelay = cfg->FlushDelay;
+	HOST_ASSERT(BLK_CacheInit(&cache) == SUCCESS);
+	HOST_ASSERT(cache.dev.BlockSize == RAM_BLOCK);
+	HOST_ASSERT(cache.dev.BlockCount == cfg->Blocks);
+	cache.dev.Done = host_Done;
+	cache.dev.arg = NULL;
+	host_chain_lba = host_chain_end = 0;
+	host_done = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Check the cache state against the reference copy of the
+ * 				disk, the cache being idle: tags distinct and aligned,
+ * 				valid blocks equal to the reference, blocks not dirty in
+ * 				any line already on the disk
+ * @param[in]	None
+ * @return		Number of dirty blocks
+ **********************************************************************/
+static uint32_t host_Coherent(void)
+{
+	BLK_CACHE_LINE_Type *line;
+	uint32_t i, j, b, span, dirty = 0;
+	uint8_t *data;
+
+	HOST_ASSERT(!cache.dev.Busy && !ram.dev.Busy);
+	for (i = 0; i < cache.NumLines; i++) {
+		line = &cache.line[i];
+		if (line->Tag == BLK_CACHE_NO_TAG) {
+			HOST_ASSERT(line->Dirty == 0);
+			continue;
+		}
+		HOST_ASSERT((line->Tag % cache.LineBlocks) == 0);
+		HOST_ASSERT(line->Tag < cache.dev.BlockCount);
+		for (j = i + 1; j < cache.NumLines; j++) {
+			HOST_ASSERT(cache.line[j].Tag != line->Tag);
+		}
+		span = cache.dev.BlockCount - line->Tag;
+		if (span > cache.LineBlocks) {
+			span = cache.LineBlocks;
+		}
+		HOST_ASSERT((line->Dirty & ~line->Valid) == 0);
+		for (b = 0; b < cache.LineBlocks; b++) {
+			if (!(line->Valid & (1UL << b))) {
+				continue;
+			}
+			HOST_ASSERT(b < span);
+			data = &host_buf[(i * cache.LineBlocks + b) * RAM_BLOCK];
+			HOST_ASSERT(memcmp(data, &host_ref[(line->Tag + b) * RAM_BLOCK], RAM_BLOCK) == 0);
+			if (line->Dirty & (1UL << b)) {
+				dirty++;
+			} else {
+				HOST_ASSERT(memcmp(&ram_data[(line->Tag + b) * RAM_BLOCK],
+						&host_ref[(line->Tag + b) * RAM_BLOCK], RAM_BLOCK) == 0);
+			}
+		}
+	}
+	return dirty;
+}
+
+/*********************************************************************//**
+ * @brief		Check that the disk holds the reference content, blocks
+ * 				dirty in the cache excepted
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_DiskCheck(void)
+{
+	BLK_CACHE_LINE_Type *line;
+	uint32_t lba, i;
+	uint32_t dirty;
+
+	for (lba = 0; lba < cache.dev.BlockCount; lba++) {
+		dirty = 0;
+		for (i = 0; i < cache.NumLines; i++) {
+			line = &cache.line[i];
+			if ((line->Tag != BLK_CACHE_NO_TAG) && (lba >= line->Tag)
+					&& (lba < line->Tag + cache.LineBlocks)
+					&& (line->Dirty & (1UL << (lba - line->Tag)))) {
+				dirty = 1;
+			}
+		}
+		if (!dirty) {
+			HOST_ASSERT(memcmp(&ram_data[lba * RAM_BLOCK], &host_ref[lba * RAM_BLOCK],
+					RAM_BLOCK) == 0);
+		}
+	}
+}
+
+
+/*--------------------------------- Tests -------------------------------------*/
+
+/*********************************************************************//**
+ * @brief		Synchronous helpers on the RAM disk, and the cache
+ * 				configuration checks
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_SyncTests(void)
+{
+	static const uint8_t bad[][3] = {
+		{ 0, 8, 0 }, { BLK_CACHE_LINE_MAX + 1, 8, 0 }, { 4, 0, 0 },
+		{ 4, BLK_CACHE_BLOCKS_MAX + 1, 0 }, { 4, 8, 4 }
+	};
+	uint32_t delay, i;
+
+	for (delay = 0; delay < 3; delay++) {
+		ram_Init(RAM_BLOCKS, delay);
+		ram.dev.Done = host_Done;
+		host_Fill(host_wr, sizeof(host_wr));
+		HOST_ASSERT(BLK_Write(&ram.dev, 10, host_wr, HOST_MAX_BLOCKS) == SUCCESS);
+		HOST_ASSERT(memcmp(&ram_data[10 * RAM_BLOCK], host_wr, sizeof(host_wr)) == 0);
+		HOST_ASSERT(BLK_Read(&ram.dev, 10, host_rd, HOST_MAX_BLOCKS) == SUCCESS);
+		HOST_ASSERT(memcmp(host_rd, host_wr, sizeof(host_wr)) == 0);
+		HOST_ASSERT(BLK_Sync(&ram.dev) == SUCCESS);
+		HOST_ASSERT(ram.syncs == 1);
+
+		// Errors reach the caller, the user callback is restored
+		ram.FailOp = ram.ops + 1;
+		HOST_ASSERT(BLK_Read(&ram.dev, 0, host_rd, 1) == ERROR);
+		ram.RefuseOp = ram.ops + 1;
+		HOST_ASSERT(BLK_Write(&ram.dev, 0, host_wr, 1) == ERROR);
+		HOST_ASSERT(!ram.dev.Busy);
+		HOST_ASSERT(ram.dev.Done == host_Done);
+		HOST_ASSERT(BLK_Read(&ram.dev, RAM_BLOCKS - 1, host_rd, 2) == ERROR);
+		HOST_ASSERT(ram.violations == 1);
+
+		// Busy device
+		if (delay != 0) {
+			HOST_ASSERT(ram.dev.Read(&ram.dev, 0, host_rd, 1) == SUCCESS);
+			HOST_ASSERT(BLK_Read(&ram.dev, 0, host_rd, 1) == ERROR);
+			HOST_ASSERT(BLK_Sync(&ram.dev) == ERROR);
+			while (ram.dev.Busy) {
+				BLK_Poll(&ram.dev);
+			}
+		}
+	}
+
+	// Devices without Sync and Poll
+	ram.dev.Sync = NULL;
+	ram.dev.Poll = NULL;
+	ram.Delay = 0;
+	HOST_ASSERT(BLK_Sync(&ram.dev) == SUCCESS);
+	BLK_Poll(&ram.dev);
+
+	// Cache configurations out of range
+	ram_Init(RAM_BLOCKS, 0);
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+		memset(&cache, 0, sizeof(cache));
+		cache.Lower = &ram.dev;
+		cache.Buf = host_buf;
+		cache.NumLines = bad[i][0];
+		cache.LineBlocks = bad[i][1];
+		cache.ReadAhead = bad[i][2];
+		HOST_ASSERT(BLK_CacheInit(&cache) == ERROR);
+	}
+	printf("synchronous helpers and cache configuration ok\n");
+}
+
+/*********************************************************************//**
+ * @brief		Random reads, writes, syncs and idle time through the
+ * 				cache, checked against the reference copy of the disk
+ * @param[in]	cfg		Configuration
+ * @return		None
+ **********************************************************************/
+static void host_RandomTest(const HOST_CFG_Type *cfg)
+{
+	uint32_t i, r, lba, n, next = 0, dirty;
+
+	host_Setup(cfg);
+	for (i = 0; i < HOST_RANDOM_OPS; i++) {
+		r = host_Rand() % 100;
+		if (r < 4) {
+			HOST_ASSERT(host_Request(RAM_OP_SYNC, 0, NULL, 0) == SUCCESS);
+			host_Quiesce();
+			HOST_ASSERT(host_Coherent() == 0);
+			HOST_ASSERT(memcmp(ram_data, host_ref, cfg->Blocks * RAM_BLOCK) == 0);
+		} else if (r < 8) {
+			host_Poll(host_Rand() % (2 * cfg->FlushDelay + 2));
+		} else {
+			lba = (host_Rand() & 1) ? next : (host_Rand() % cfg->Blocks);
+			n = 1 + host_Rand() % ((host_Rand() & 1) ? 8 : HOST_MAX_BLOCKS);
+			if (lba >= cfg->Blocks) {
+				lba = 0;
+			}
+			if (n > cfg->Blocks - lba) {
+				n = cfg->Blocks - lba;
+			}
+			if (r < 54) {
+				memset(host_rd, 0x5A, n * RAM_BLOCK);
+				HOST_ASSERT(host_Request(RAM_OP_READ, lba, host_rd, n) == SUCCESS);
+				HOST_ASSERT(memcmp(host_rd, &host_ref[lba * RAM_BLOCK], n * RAM_BLOCK) == 0);
+			} else {
+				host_Fill(host_wr, n * RAM_BLOCK);
+				HOST_ASSERT(host_Request(RAM_OP_WRITE, lba, host_wr, n) == SUCCESS);
+				memcpy(&host_ref[lba * RAM_BLOCK], host_wr, n * RAM_BLOCK);
+			}
+			next = lba + n;
+			host_Poll(host_Rand() % 4);
+		}
+		if ((i % 64) == 63) {
+			host_Quiesce();
+			host_Coherent();
+			host_DiskCheck();
+		}
+	}
+
+	// Requests out of range are refused without callback
+	r = host_done;
+	HOST_ASSERT(cache.dev.Read(&cache.dev, cfg->Blocks, host_rd, 1) == ERROR);
+	HOST_ASSERT(cache.dev.Write(&cache.dev, cfg->Blocks - 1, host_wr, 2) == ERROR);
+	HOST_ASSERT(cache.dev.Read(&cache.dev, 0, host_rd, 0) == ERROR);
+	HOST_ASSERT(host_done == r);
+
+	HOST_ASSERT(BLK_Sync(&cache.dev) == SUCCESS);
+	HOST_ASSERT(cache.dev.Done == host_Done);
+	host_Quiesce();
+	dirty = host_Coherent();
+	HOST_ASSERT(dirty == 0);
+	HOST_ASSERT(memcmp(ram_data, host_ref, cfg->Blocks * RAM_BLOCK) == 0);
+	HOST_ASSERT(ram.violations == 0);
+	printf("random %2u x %2u blocks, ahead %2u, flush %3u, delay %u, %4u blocks: "
+			"%4u reads %4u misses, %5u fills %5u write-backs ok\n",
+			cfg->NumLines, cfg->LineBlocks, cfg->ReadAhead, (unsigned)cfg->FlushDelay,
+			(unsigned)cfg->Delay, (unsigned)cfg->Blocks, (unsigned)cache.reads,
+			(unsigned)cache.misses, (unsigned)cache.fills, (unsigned)cache.writebacks);
+}
+
+/*********************************************************************//**
+ * @brief		Sequential reads of HOST_SEQ_CHUNK blocks: with
+ * 				read-ahead only the first request waits for the disk and
+ * 				the disk is read by whole lines; without it every line
+ * 				is a miss. Then a chained read, each request started by
+ * 				the completion callback of the previous one.
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_ReadAheadTest(void)
+{
+	static const HOST_CFG_Type cfg = { 4, 8, 2, 500, 2, RAM_BLOCKS };
+	HOST_CFG_Type c = cfg;
+	uint32_t ahead, lba, lines = HOST_SEQ_BLOCKS / cfg.LineBlocks;
+
+	for (ahead = 0; ahead <= 2; ahead += 2) {
+		c.ReadAhead = (uint8_t)ahead;
+		host_Setup(&c);
+		for (lba = 0; lba < HOST_SEQ_BLOCKS; lba += HOST_SEQ_CHUNK) {
+			HOST_ASSERT(host_Request(RAM_OP_READ, lba, host_rd, HOST_SEQ_CHUNK) == SUCCESS);
+			HOST_ASSERT(memcmp(host_rd, &host_ref[lba * RAM_BLOCK], HOST_SEQ_CHUNK * RAM_BLOCK) == 0);
+			// Time to move the data to the host
+			host_Poll(4 * c.Delay);
+		}
+		HOST_ASSERT(cache.reads == HOST_SEQ_BLOCKS / HOST_SEQ_CHUNK);
+		HOST_ASSERT(ram.rmin == c.LineBlocks && ram.rmax == c.LineBlocks);
+		if (ahead != 0) {
+			HOST_ASSERT(cache.misses == 1);
+			HOST_ASSERT(ram.reads == lines + ahead);
+		} else {
+			HOST_ASSERT(cache.misses == lines);
+			HOST_ASSERT(ram.reads == lines);
+		}
+		printf("sequential read %u blocks by %u, read-ahead %u: %3u misses, "
+				"%3u disk reads of %u blocks ok\n", HOST_SEQ_BLOCKS, HOST_SEQ_CHUNK,
+				(unsigned)ahead, (unsigned)cache.misses, (unsigned)ram.reads,
+				(unsigned)ram.rmax);
+	}
+
+	// Chained requests, no Poll() between them
+	host_Setup(&cfg);
+	host_chain_lba = HOST_SEQ_CHUNK;
+	host_chain_end = HOST_MAX_BLOCKS;
+	HOST_ASSERT(host_Request(RAM_OP_READ, 0, host_rd, HOST_SEQ_CHUNK) == SUCCESS);
+	while (host_done < HOST_MAX_BLOCKS / HOST_SEQ_CHUNK) {
+		HOST_ASSERT(host_status == SUCCESS);
+		host_Poll(1);
+	}
+	HOST_ASSERT(host_status == SUCCESS);
+	HOST_ASSERT(memcmp(host_rd, host_ref, HOST_MAX_BLOCKS * RAM_BLOCK) == 0);
+	HOST_ASSERT(ram.violations == 0);
+	printf("chained read of %u blocks from the completion callback: %u misses ok\n",
+			HOST_MAX_BLOCKS, (unsigned)cache.misses);
+}
+
+/*********************************************************************//**
+ * @brief		Write coalescing: single block sequential writes reach the
+ * 				disk as whole line writes as soon as each line is full; a
+ * 				partial line is written back after FlushDelay idle polls
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_WriteTest(void)
+{
+	static const HOST_CFG_Type cfg = { 4, 8, 2, 50, 1, RAM_BLOCKS };
+	uint32_t lba, writes;
+
+	host_Setup(&cfg);
+	for (lba = 0; lba < HOST_SEQ_BLOCKS; lba++) {
+		host_Fill(host_wr, RAM_BLOCK);
+		HOST_ASSERT(host_Request(RAM_OP_WRITE, lba, host_wr, 1) == SUCCESS);
+		memcpy(&host_ref[lba * RAM_BLOCK], host_wr, RAM_BLOCK);
+	}
+	host_Quiesce();
+	HOST_ASSERT(host_Coherent() == 0);
+	HOST_ASSERT(ram.writes == HOST_SEQ_BLOCKS / cfg.LineBlocks);
+	HOST_ASSERT(ram.wmin == cfg.LineBlocks && ram.wmax == cfg.LineBlocks);
+	HOST_ASSERT(ram.reads == 0);
+	HOST_ASSERT(memcmp(ram_data, host_ref, sizeof(ram_data)) == 0);
+
+	// Partial line: kept until the cache has been idle for FlushDelay polls
+	writes = ram.writes;
+	host_Fill(host_wr, 3 * RAM_BLOCK);
+	HOST_ASSERT(host_Request(RAM_OP_WRITE, HOST_SEQ_BLOCKS + 2, host_wr, 3) == SUCCESS);
+	memcpy(&host_ref[(HOST_SEQ_BLOCKS + 2) * RAM_BLOCK], host_wr, 3 * RAM_BLOCK);
+	host_Poll(cfg.FlushDelay - 1);
+	HOST_ASSERT(ram.writes == writes);
+	HOST_ASSERT(host_Coherent() == 3);
+	host_Poll(1 + cfg.Delay + 1);
+	HOST_ASSERT(ram.writes == writes + 1 && ram.wmin == 3);
+	host_Quiesce();
+	HOST_ASSERT(host_Coherent() == 0);
+	HOST_ASSERT(memcmp(ram_data, host_ref, sizeof(ram_data)) == 0);
+	HOST_ASSERT(ram.violations == 0);
+	printf("sequential write %u blocks by 1: %u disk writes of %u blocks, "
+			"idle write-back ok\n", HOST_SEQ_BLOCKS, (unsigned)writes,
+			(unsigned)cfg.LineBlocks);
+}
+
+/*********************************************************************//**
+ * @brief		Disk errors: a failed fill fails the read request, a
+ * 				failed background write-back keeps the data dirty and is
+ * 				retried by Sync, a failed Sync is reported
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_ErrorTest(void)
+{
+	static const HOST_CFG_Type cfg = { 4, 8, 0, 0, 1, RAM_BLOCKS };
+	uint32_t refuse;
+
+	for (refuse = 0; refuse <= 1; refuse++) {
+		host_Setup(&cfg);
+
+		// Read: the request fails, the line is not valid, a retry succeeds
+		if (refuse) {
+			ram.RefuseOp = ram.ops + 1;
+		} else {
+			ram.FailOp = ram.ops + 1;
+		}
+		HOST_ASSERT(host_Request(RAM_OP_READ, 16, host_rd, 4) == ERROR);
+		host_Coherent();
+		HOST_ASSERT(host_Request(RAM_OP_READ, 16, host_rd, 4) == SUCCESS);
+		HOST_ASSERT(memcmp(host_rd, &host_ref[16 * RAM_BLOCK], 4 * RAM_BLOCK) == 0);
+
+		// Write-behind of a full line fails: the request succeeded, the
+		// data stays dirty in the cache and Sync writes it
+		host_Fill(host_wr, 8 * RAM_BLOCK);
+		if (refuse) {
+			ram.RefuseOp = ram.ops + 1;
+		} else {
+			ram.FailOp = ram.ops + 1;
+		}
+		HOST_ASSERT(host_Request(RAM_OP_WRITE, 64, host_wr, 8) == SUCCESS);
+		memcpy(&host_ref[64 * RAM_BLOCK], host_wr, 8 * RAM_BLOCK);
+		host_Quiesce();
+		HOST_ASSERT(cache.bgerr);
+		HOST_ASSERT(host_Coherent() == 8);
+		HOST_ASSERT(host_Request(RAM_OP_SYNC, 0, NULL, 0) == SUCCESS);
+		HOST_ASSERT(host_Coherent() == 0);
+		HOST_ASSERT(host_Request(RAM_OP_READ, 64, host_rd, 8) == SUCCESS);
+		HOST_ASSERT(memcmp(host_rd, host_wr, 8 * RAM_BLOCK) == 0);
+
+		// Sync: the write-back succeeds, the disk Sync fails, then succeeds
+		host_Fill(host_wr, 3 * RAM_BLOCK);
+		HOST_ASSERT(host_Request(RAM_OP_WRITE, 130, host_wr, 3) == SUCCESS);
+		memcpy(&host_ref[130 * RAM_BLOCK], host_wr, 3 * RAM_BLOCK);
+		if (refuse) {
+			ram.RefuseOp = ram.ops + 2;
+		} else {
+			ram.FailOp = ram.ops + 2;
+		}
+		HOST_ASSERT(host_Request(RAM_OP_SYNC, 0, NULL, 0) == ERROR);
+		HOST_ASSERT(host_Coherent() == 0);
+		HOST_ASSERT(host_Request(RAM_OP_SYNC, 0, NULL, 0) == SUCCESS);
+		HOST_ASSERT(memcmp(ram_data, host_ref, sizeof(ram_data)) == 0);
+		HOST_ASSERT(ram.violations == 0);
+	}
+	printf("disk errors: failed and refused reads, write-backs and syncs ok\n");
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	host_SyncTests();
+	for (i = 0; i < sizeof(host_cfg) / sizeof(host_cfg[0]); i++) {
+		host_RandomTest(&host_cfg[i]);
+	}
+	host_ReadAheadTest();
+	host_WriteTest();
+	host_ErrorTest();
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,594 @@
+/**********************************************************************
+* $Id$		fat_host.c			2011-03-09
+*//**
+* @file		fat_host.c
+* @brief	Host test and benchmark of the FAT driver on a disk image
+* 			file: formats FAT16/FAT32 images, runs the file operations of
+* 			the example, checks the image consistency independently of
+* 			the driver and measures the append rate against raw writes
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "lpc17xx_fat.h"
+
+/** Block size of the image file */
+#define IMG_BLOCK		512
+/** Largest write of the tests and of the benchmark (bytes) */
+#define HOST_BUF_SIZE	(1 << 20)
+/** Benchmark runs, the best one is reported */
+#define BENCH_RUNS		5
+
+/* Test failure: print the failed condition and stop */
+#define HOST_ASSERT(x)	do { if (!(x)) { \
+		fprintf(stderr, "fat_host: %s line %d: %s\n", __FILE__, __LINE__, #x); \
+		exit(1); } } while (0)
+
+/* CHECK_PARAM failure in the driver (built in DEBUG mode) */
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "fat_host: check failed in %s line %u\n", (char *)file, line);
+	exit(1);
+}
+
+static int img_fd = -1;
+static uint32_t img_requests, img_blocks;
+static uint8_t buf[HOST_BUF_SIZE], rbuf[HOST_BUF_SIZE];
+
+
+/*-------------------------- Image file block device --------------------------*/
+
+/* Read blocks from the image file, the request is over on return */
+static Status img_Read(BLKDEV_Type *dev, uint32_t lba, uint8_t *data, uint32_t n)
+{
+	if ((lba >= dev->BlockCount) || (n > (dev->BlockCount - lba))) {
+		return ERROR;
+	}
+	img_requests++;
+	if (pread(img_fd, data, (size_t)n * IMG_BLOCK, (off_t)lba * IMG_BLOCK)
+			!= (ssize_t)n * IMG_BLOCK) {
+		return ERROR;
+	}
+	dev->Done(dev->arg, SUCCESS);
+	return SUCCESS;
+}
+
+/* Write blocks to the image file, the request is over on return */
+static Status img_Write(BLKDEV_Type *dev, uint32_t lba, const uint8_t *data, uint32_t n)
+{
+	if ((lba >= dev->BlockCount) || (n > (dev->BlockCount - lba))) {
+		return ERROR;
+	}
+	img_requests++;
+	img_blocks += n;
+	if (pwrite(img_fd, data, (size_t)n * IMG_BLOCK, (off_t)lba * IMG_BLOCK)
+			!= (ssize_t)n * IMG_BLOCK) {
+		return ERROR;
+	}
+	dev->Done(dev->arg, SUCCESS);
+	return SUCCESS;
+}
+
+/* Open the image file as block device */
+static void img_Open(const char *path, BLKDEV_Type *dev)
+{
+	off_t size;
+
+	if (img_fd >= 0) {
+		close(img_fd);
+	}
+	img_fd = open(path, O_RDWR);
+	HOST_ASSERT(img_fd >= 0);
+	size = lseek(img_fd, 0, SEEK_END);
+	memset(dev, 0, sizeof(*dev));
+	dev->BlockSize = IMG_BLOCK;
+	dev->BlockCount = (uint32_t)(size / IMG_BLOCK);
+	dev->Read = img_Read;
+	dev->Write = img_Write;
+}
+
+static uint16_t get16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get32(const uint8_t *p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+static void put16(uint8_t *p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+static void img_Sector(uint32_t sec, uint8_t *data, int write)
+{
+	ssize_t n;
+
+	if (write) {
+		n = pwrite(img_fd, data, IMG_BLOCK, (off_t)sec * IMG_BLOCK);
+	} else {
+		n = pread(img_fd, data, IMG_BLOCK, (off_t)sec * IMG_BLOCK);
+	}
+	HOST_ASSERT(n == IMG_BLOCK);
+}
+
+
+/*-------------------------------- Formatter ----------------------------------*/
+
+/* Create a FAT16/FAT32 image of total blocks, 2 FAT copies, the volume at
+ * block 0 or in the first MBR partition at block 2048 */
+static void img_Format(const char *path, uint32_t total, uint32_t spc, int fat32, int mbr)
+{
+	uint8_t sec[IMG_BLOCK];
+	uint32_t base, n, rsvd, rootent, rootsec, fatsz, need, cc, c;
+
+	base = mbr ? 2048 : 0;
+	n = total - base;
+	rsvd = fat32 ? 32 : 4;
+	rootent = fat32 ? 0 : 512;
+	rootsec = rootent * 32 / IMG_BLOCK;
+	for (fatsz = 1; ; fatsz = need) {
+		cc = (n - rsvd - 2 * fatsz - rootsec) / spc;
+		need = ((cc + 2) * (fat32 ? 4 : 2) + IMG_BLOCK - 1) / IMG_BLOCK;
+		if (need <= fatsz) {
+			break;
+		}
+	}
+
+	img_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	HOST_ASSERT(img_fd >= 0);
+	HOST_ASSERT(ftruncate(img_fd, (off_t)total * IMG_BLOCK) == 0);
+
+	// Boot sector
+	memset(sec, 0, sizeof(sec));
+	memcpy(sec, "\xEB\x58\x90MSWIN4.1", 11);
+	put16(&sec[11], IMG_BLOCK);
+	sec[13] = (uint8_t)spc;
+	put16(&sec[14], rsvd);
+	sec[16] = 2;
+	put16(&sec[17], rootent);
+	if (!fat32 && (n < 65536)) {
+		put16(&sec[19], n);
+	} else {
+		put32(&sec[32], n);
+	}
+	sec[21] = 0xF8;
+	put16(&sec[24], 63);
+	put16(&sec[26], 255);
+	put32(&sec[28], base);
+	if (fat32) {
+		put32(&sec[36], fatsz);
+		put32(&sec[44], 2);
+		put16(&sec[48], 1);
+		put16(&sec[50], 6);
+		sec[66] = 0x29;
+		memcpy(&sec[71], "NO NAME    FAT32   ", 19);
+	} else {
+		put16(&sec[22], fatsz);
+		sec[38] = 0x29;
+		memcpy(&sec[43], "NO NAME    FAT16   ", 19);
+	}
+	sec[510] = 0x55;
+	sec[511] = 0xAA;
+	img_Sector(base, sec, 1);
+
+	// FSInfo, the root directory cluster is used
+	if (fat32) {
+		memset(sec, 0, sizeof(sec));
+		put32(&sec[0], 0x41615252);
+		put32(&sec[484], 0x61417272);
+		put32(&sec[488], cc - 1);
+		put32(&sec[492], 3);
+		sec[510] = 0x55;
+		sec[511] = 0xAA;
+		img_Sector(base + 1, sec, 1);
+	}
+
+	// First sector of each FAT: media, reserved and root directory entries
+	memset(sec, 0, sizeof(sec));
+	if (fat32) {
+		put32(&sec[0], 0x0FFFFFF8);
+		put32(&sec[4], 0x0FFFFFFF);
+		put32(&sec[8], 0x0FFFFFFF);
+	} else {
+		put16(&sec[0], 0xFFF8);
+		put16(&sec[2], 0xFFFF);
+	}
+	for (c = 0; c < 2; c++) {
+		img_Sector(base + rsvd + c * fatsz, sec, 1);
+	}
+
+	// MBR with one partition
+	if (mbr) {
+		memset(sec, 0, sizeof(sec));
+		sec[446 + 4] = fat32 ? 0x0C : 0x06;
+		put32(&sec[446 + 8], base);
+		put32(&sec[446 + 12], n);
+		sec[510] = 0x55;
+		sec[511] = 0xAA;
+		img_Sector(0, sec, 1);
+	}
+	close(img_fd);
+	img_fd = -1;
+	printf("%s: FAT%d, %u clusters of %u sectors, FAT %u sectors%s\n", path,
+			fat32 ? 32 : 16, cc, spc, fatsz, mbr ? ", MBR" : "");
+}
+
+
+/*---------------------------------- Checker ----------------------------------*/
+
+/* Layout of the volume, read from the boot sector */
+static uint32_t chk_base, chk_spc, chk_fatstart, chk_fatsz, chk_nf;
+static uint32_t chk_rootstart, chk_rootsec, chk_datastart, chk_cc;
+static int chk_fat32;
+static uint8_t *chk_fat;		/* First FAT copy */
+static uint8_t *chk_owner;		/* Cluster reached by a chain */
+
+static uint32_t chk_Get(uint32_t cl)
+{
+	return chk_fat32 ? (get32(&chk_fat[cl * 4]) & 0x0FFFFFFF) : get16(&chk_fat[cl * 2]);
+}
+
+/* Walk a chain, mark its clusters, return the number of clusters or -1 */
+static long chk_Chain(uint32_t cl, const char *name)
+{
+	uint32_t eoc = chk_fat32 ? 0x0FFFFFF8 : 0xFFF8;
+	long n = 0;
+
+	while ((cl != 0) && (cl < eoc)) {
+		if ((cl < 2) || (cl >= chk_cc + 2)) {
+			printf("check: %s: bad cluster 0x%X\n", name, cl);
+			return -1;
+		}
+		if (chk_owner[cl]) {
+			printf("check: %s: cluster 0x%X cross-linked\n", name, cl);
+			return -1;
+		}
+		chk_owner[cl] = 1;
+		n++;
+		cl = chk_Get(cl);
+	}
+	return n;
+}
+
+/* Check the image: FAT copies equal, valid chains without cross links,
+ * chain length matching each file size, no lost cluster, FSInfo free
+ * count. Return the number of free clusters, or -1 */
+static long img_Check(const char *path)
+{
+	BLKDEV_Type dev;
+	uint8_t sec[IMG_BLOCK], dir[IMG_BLOCK];
+	uint32_t total, c, s, i, cl, size, nfree, dirsec, dircl, csize;
+	long n, files = 0;
+	int end = 0;
+	char name[13];
+
+	img_Open(path, &dev);
+	img_Sector(0, sec, 0);
+	chk_base = 0;
+	if ((sec[0] != 0xEB) && (sec[0] != 0xE9)) {
+		chk_base = get32(&sec[446 + 8]);
+		img_Sector(chk_base, sec, 0);
+	}
+	chk_spc = sec[13];
+	chk_nf = sec[16];
+	chk_fatsz = get16(&sec[22]);
+	chk_fat32 = (chk_fatsz == 0);
+	if (chk_fat32) {
+		chk_fatsz = get32(&sec[36]);
+	}
+	total = get16(&sec[19]) ? get16(&sec[19]) : get32(&sec[32]);
+	chk_fatstart = chk_base + get16(&sec[14]);
+	chk_rootsec = get16(&sec[17]) * 32 / IMG_BLOCK;
+	chk_rootstart = chk_fatstart + chk_nf * chk_fatsz;
+	chk_datastart = chk_rootstart + chk_rootsec;
+	chk_cc = (total - (chk_datastart - chk_base)) / chk_spc;
+	csize = chk_spc * IMG_BLOCK;
+	dircl = chk_fat32 ? get32(&sec[44]) : 0;
+
+	chk_fat = malloc((size_t)chk_fatsz * IMG_BLOCK * 2);
+	chk_owner = calloc(chk_cc + 2, 1);
+	HOST_ASSERT((chk_fat != NULL) && (chk_owner != NULL));
+	HOST_ASSERT(pread(img_fd, chk_fat, (size_t)chk_fatsz * IMG_BLOCK,
+			(off_t)chk_fatstart * IMG_BLOCK) == (ssize_t)chk_fatsz * IMG_BLOCK);
+	for (c = 1; c < chk_nf; c++) {
+		HOST_ASSERT(pread(img_fd, chk_fat + (size_t)chk_fatsz * IMG_BLOCK,
+				(size_t)chk_fatsz * IMG_BLOCK, (off_t)(chk_fatstart + c * chk_fatsz) * IMG_BLOCK)
+				== (ssize_t)chk_fatsz * IMG_BLOCK);
+		if (memcmp(chk_fat, chk_fat + (size_t)chk_fatsz * IMG_BLOCK,
+				(size_t)chk_fatsz * IMG_BLOCK) != 0) {
+			printf("check: FAT copy %u differs\n", c);
+			return -1;
+		}
+	}
+
+	// Root directory: FAT16 fixed area, FAT32 cluster chain
+	if (chk_fat32 && (chk_Chain(dircl, "root directory") < 0)) {
+		return -1;
+	}
+	for (s = 0; !end; s++) {
+		if (chk_fat32) {
+			if ((s != 0) && ((s % chk_spc) == 0)) {
+				dircl = chk_Get(dircl);
+				if (dircl >= 0x0FFFFFF8) {
+					break;
+				}
+			}
+			dirsec = chk_datastart + (dircl - 2) * chk_spc + (s % chk_spc);
+		} else {
+			if (s == chk_rootsec) {
+				break;
+			}
+			dirsec = chk_rootstart + s;
+		}
+		img_Sector(dirsec, dir, 0);
+		for (i = 0; i < IMG_BLOCK; i += 32) {
+			if (dir[i] == 0) {
+				end = 1;
+				break;
+			}
+			if ((dir[i] == 0xE5) || (dir[i + 11] & 0x18)) {
+				continue;
+			}
+			memcpy(name, &dir[i], 11);
+			name[11] = 0;
+			cl = get16(&dir[i + 26]) | (chk_fat32 ? ((uint32_t)get16(&dir[i + 20]) << 16) : 0);
+			size = get32(&dir[i + 28]);
+			n = chk_Chain(cl, name);
+			if (n < 0) {
+				return -1;
+			}
+			if ((uint32_t)n != (size + csize - 1) / csize) {
+				printf("check: %s: %ld clusters for %u bytes\n", name, n, size);
+				return -1;
+			}
+			files++;
+		}
+	}
+
+	nfree = 0;
+	for (cl = 2; cl < chk_cc + 2; cl++) {
+		if (chk_Get(cl) == 0) {
+			nfree++;
+		} else if (!chk_owner[cl]) {
+			printf("check: cluster 0x%X lost\n", cl);
+			return -1;
+		}
+	}
+	if (chk_fat32) {
+		img_Sector(chk_base + 1, sec, 0);
+		if ((get32(&sec[488]) != 0xFFFFFFFF) && (get32(&sec[488]) != nfree)) {
+			printf("check: FSInfo free count %u, %u free clusters\n", get32(&sec[488]), nfree);
+			return -1;
+		}
+	}
+	free(chk_fat);
+	free(chk_owner);
+	printf("check: %ld files, %u free clusters, ok\n", files, nfree);
+	return (long)nfree;
+}
+
+
+/*------------------------------- File tests ----------------------------------*/
+
+static uint8_t pattern(uint32_t i, uint32_t seed)
+{
+	return (uint8_t)(i * 31 + seed + (i >> 9));
+}
+
+/* Interleaved appends of odd sizes to two files, overwrite, truncate,
+ * append mode, invalid names, directory growth, then a contiguous
+ * preallocated log as in the example; everything is read back after
+ * remount and the image is checked */
+static void img_Test(const char *path)
+{
+	static BLKDEV_Type dev;
+	static FAT_VOLUME_Type vol;
+	static FAT_FILE_Type f, g;
+	uint32_t i, k, n, pa = 0, pg = 0, p;
+	long free0, free1;
+	char nm[16];
+
+	img_Open(path, &dev);
+	vol.Dev = &dev;
+	HOST_ASSERT(FAT_Mount(&vol) == SUCCESS);
+	HOST_ASSERT(FAT_Open(&vol, &f, "a.txt", FAT_MODE_WRITE | FAT_MODE_CREATE) == SUCCESS);
+	HOST_ASSERT(FAT_Open(&vol, &g, "LOG.BIN", FAT_MODE_WRITE | FAT_MODE_CREATE | FAT_MODE_READ) == SUCCESS);
+	srand(1);
+	for (k = 0; k < 300; k++) {
+		n = rand() % 5000 + 1;
+		for (i = 0; i < n; i++) buf[i] = pattern(pa + i, 1);
+		HOST_ASSERT(FAT_Write(&f, buf, n) == n);
+		pa += n;
+		n = rand() % 3000 + 1;
+		for (i = 0; i < n; i++) buf[i] = pattern(pg + i, 2);
+		HOST_ASSERT(FAT_Write(&g, buf, n) == n);
+		pg += n;
+		if ((k % 50) == 0) {
+			HOST_ASSERT(FAT_Sync(&f) == SUCCESS);
+		}
+	}
+	HOST_ASSERT(FAT_Seek(&g, 1000) == SUCCESS);
+	for (i = 0; i < 7000; i++) buf[i] = pattern(1000 + i, 2);
+	HOST_ASSERT(FAT_Write(&g, buf, 7000) == 7000);
+	HOST_ASSERT(FAT_Seek(&g, 0) == SUCCESS);
+	HOST_ASSERT(FAT_Read(&g, rbuf, pg + 10) == pg);
+	for (i = 0; i < pg; i++) HOST_ASSERT(rbuf[i] == pattern(i, 2));
+	HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+	HOST_ASSERT(FAT_Close(&g) == SUCCESS);
+
+	HOST_ASSERT(FAT_Open(&vol, &f, "EMPTY", FAT_MODE_WRITE | FAT_MODE_CREATE) == SUCCESS);
+	HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+	HOST_ASSERT(FAT_Open(&vol, &f, "T.DAT", FAT_MODE_WRITE | FAT_MODE_CREATE) == SUCCESS);
+	HOST_ASSERT(FAT_Write(&f, buf, 100000) == 100000);
+	HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+	HOST_ASSERT(FAT_Open(&vol, &f, "T.DAT", FAT_MODE_WRITE | FAT_MODE_TRUNC) == SUCCESS);
+	HOST_ASSERT(FAT_Write(&f, (const uint8_t *)"xxxxxxxxxx", 10) == 10);
+	HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+
+	HOST_ASSERT(FAT_Open(&vol, &f, "A.TXT", FAT_MODE_WRITE | FAT_MODE_APPEND) == SUCCESS);
+	HOST_ASSERT(f.Pos == pa);
+	for (i = 0; i < 777; i++) buf[i] = pattern(pa + i, 1);
+	HOST_ASSERT(FAT_Write(&f, buf, 777) == 777);
+	pa += 777;
+	HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+
+	HOST_ASSERT(FAT_Open(&vol, &f, "nope", FAT_MODE_READ) == ERROR);
+	HOST_ASSERT(FAT_Open(&vol, &f, "bad*name", FAT_MODE_READ | FAT_MODE_CREATE) == ERROR);
+	HOST_ASSERT(FAT_Open(&vol, &f, "toolongname.txt", FAT_MODE_READ | FAT_MODE_CREATE) == ERROR);
+
+	// FAT32: the root directory grows past one cluster
+	for (k = 0; k < 40; k++) {
+		sprintf(nm, "F%u.X", k);
+		HOST_ASSERT(FAT_Open(&vol, &f, nm, FAT_MODE_WRITE | FAT_MODE_CREATE) == SUCCESS);
+		HOST_ASSERT(FAT_Write(&f, (const uint8_t *)nm, strlen(nm)) == strlen(nm));
+		HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+	}
+	printf("test: A.TXT %u bytes, LOG.BIN %u bytes, FAT window reads %u writes %u\n",
+			pa, pg, vol.fatreads, vol.fatwrites);
+	free0 = img_Check(path);
+	HOST_ASSERT(free0 >= 0);
+
+	// Remount, read back
+	img_Open(path, &dev);
+	memset(&vol, 0, sizeof(vol));
+	vol.Dev = &dev;
+	HOST_ASSERT(FAT_Mount(&vol) == SUCCESS);
+	HOST_ASSERT(FAT_Open(&vol, &f, "A.TXT", FAT_MODE_READ) == SUCCESS);
+	HOST_ASSERT(f.Size == pa);
+	for (p = 0; p < pa; p += n) {
+		n = FAT_Read(&f, rbuf, 70000);
+		HOST_ASSERT(n != 0);
+		for (i = 0; i < n; i++) HOST_ASSERT(rbuf[i] == pattern(p + i, 1));
+	}
+	HOST_ASSERT(FAT_Open(&vol, &f, "T.DAT", FAT_MODE_READ) == SUCCESS);
+	HOST_ASSERT((FAT_Read(&f, rbuf, 100) == 10) && (memcmp(rbuf, "xxxxxxxxxx", 10) == 0));
+	for (k = 0; k < 40; k++) {
+		sprintf(nm, "F%u.X", k);
+		HOST_ASSERT(FAT_Open(&vol, &f, nm, FAT_MODE_READ) == SUCCESS);
+		HOST_ASSERT((FAT_Read(&f, rbuf, 16) == strlen(nm)) && (memcmp(rbuf, nm, strlen(nm)) == 0));
+	}
+
+	// Example log: one contiguous run, written once, trimmed by FAT_Close()
+	HOST_ASSERT(FAT_Open(&vol, &f, "SDLOG.TXT", FAT_MODE_WRITE | FAT_MODE_CREATE | FAT_MODE_APPEND) == SUCCESS);
+	HOST_ASSERT(FAT_Preallocate(&f, 1 << 20) == SUCCESS);
+	HOST_ASSERT(f.numext == 1);
+	img_requests = img_blocks = 0;
+	for (p = 0; p < (1 << 20); p += 4096) {
+		for (i = 0; i < 4096; i++) buf[i] = pattern(p + i, 3);
+		HOST_ASSERT(FAT_Write(&f, buf, 4096) == 4096);
+	}
+	printf("test: 1MB log in 4KB appends: %u requests, %u blocks\n", img_requests, img_blocks);
+	HOST_ASSERT(FAT_Write(&f, buf, 123) == 123);
+	HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+	free1 = img_Check(path);
+	HOST_ASSERT(free1 >= 0);
+	HOST_ASSERT((uint32_t)(free0 - free1) == ((1 << 20) + 123 + (vol.SecPerClus * IMG_BLOCK) - 1)
+			/ (vol.SecPerClus * IMG_BLOCK));
+	printf("test: ok\n");
+}
+
+
+/*--------------------------------- Benchmark ---------------------------------*/
+
+static double now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* Append total bytes by chunk to BENCH.BIN, preallocated or growing,
+ * then write the same chunks raw at the end of the image; both include
+ * the final fsync(). Best of BENCH_RUNS alternating runs, ratio = raw
+ * time / FAT time */
+static void img_Bench(const char *path, uint32_t chunk, uint32_t total, int prealloc)
+{
+	static BLKDEV_Type dev;
+	static FAT_VOLUME_Type vol;
+	static FAT_FILE_Type f;
+	uint32_t i, p, r, lba, freq = 0, fblk = 0, rreq = 0;
+	double t, tfat = 1e9, traw = 1e9;
+
+	HOST_ASSERT((chunk != 0) && (chunk <= HOST_BUF_SIZE) && ((chunk % IMG_BLOCK) == 0));
+	img_Open(path, &dev);
+	vol.Dev = &dev;
+	HOST_ASSERT(FAT_Mount(&vol) == SUCCESS);
+	for (i = 0; i < chunk; i++) buf[i] = (uint8_t)i;
+
+	for (r = 0; r < BENCH_RUNS; r++) {
+		HOST_ASSERT(FAT_Open(&vol, &f, "BENCH.BIN", FAT_MODE_WRITE | FAT_MODE_CREATE | FAT_MODE_TRUNC) == SUCCESS);
+		img_requests = img_blocks = 0;
+		t = now();
+		if (prealloc) {
+			HOST_ASSERT(FAT_Preallocate(&f, total) == SUCCESS);
+		}
+		for (p = 0; p < total; p += chunk) {
+			HOST_ASSERT(FAT_Write(&f, buf, chunk) == chunk);
+		}
+		HOST_ASSERT(FAT_Close(&f) == SUCCESS);
+		fsync(img_fd);
+		t = now() - t;
+		if (t < tfat) {
+			tfat = t;
+		}
+		freq = img_requests;
+		fblk = img_blocks;
+
+		lba = dev.BlockCount - total / IMG_BLOCK;
+		img_requests = 0;
+		t = now();
+		for (p = 0; p < total; p += chunk) {
+			HOST_ASSERT(BLK_Write(&dev, lba, buf, chunk / IMG_BLOCK) == SUCCESS);
+			lba += chunk / IMG_BLOCK;
+		}
+		fsync(img_fd);
+		t = now() - t;
+		if (t < traw) {
+			traw = t;
+		}
+		rreq = img_requests;
+	}
+
+	printf("%s chunk %7u: FAT %8.1f MB/s (%u requests, %u blocks), "
+			"raw %8.1f MB/s (%u requests), ratio %.2f\n",
+			prealloc ? "prealloc" : "grow    ", chunk, total / tfat / 1e6, freq, fblk,
+			total / traw / 1e6, rreq, traw / tfat);
+}
+
+
+int main(int argc, char **argv)
+{
+	if ((argc >= 6) && (strcmp(argv[1], "format") == 0)) {
+		img_Format(argv[2], strtoul(argv[3], NULL, 0), strtoul(argv[4], NULL, 0),
+				strcmp(argv[5], "32") == 0, (argc >= 7) && (strcmp(argv[6], "mbr") == 0));
+	} else if ((argc == 3) && (strcmp(argv[1], "test") == 0)) {
+		img_Test(argv[2]);
+	} else if ((argc == 3) && (strcmp(argv[1], "check") == 0)) {
+		return (img_Check(argv[2]) < 0);
+	} else if ((argc >= 5) && (strcmp(argv[1], "bench") == 0)) {
+		img_Bench(argv[2], strtoul(argv[3], NULL, 0), strtoul(argv[4], NULL, 0),
+				(argc >= 6) && (strcmp(argv[5], "prealloc") == 0));
+	} else {
+		fprintf(stderr, "usage: fat_host format <image> <blocks> <sectors/cluster> 16|32 [mbr]\n"
+				"       fat_host test <image>\n"
+				"       fat_host check <image>\n"
+				"       fat_host bench <image> <chunk> <total> [prealloc]\n");
+		return 2;
+	}
+	return 0;
+}
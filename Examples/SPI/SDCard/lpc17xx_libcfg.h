@@ -57,11 +57,11 @@
 //#define _UART3
 
 /* SPI ------------------------------- */
-#define _SPI
+//#define _SPI
 
 /* SSP ------------------------------- */
-//#define _SSP
-//#define _SSP0
+#define _SSP
+#define _SSP0
 //#define _SSP1
 
 /* SYSTICK --------------------------- */
@@ -81,7 +81,7 @@
 
 
 /* GPDMA ------------------------------- */
-//#define _GPDMA
+#define _GPDMA
 
 
 /* DAC ------------------------------- */
@@ -105,6 +105,13 @@
 //#define _USBDEV
 //#define _USB_DMA
 
+/* Block devices ------------------------------- */
+#define _BLKDEV
+#define _SDCARD
+
+/* File system ------------------------------- */
+#define _FAT
+
 /* QEI ------------------------------- */
 //#define _QEI
 
@@ -0,0 +1,489 @@
+/**********************************************************************
+* $Id$		sd_host.c			2011-03-09
+*//**
+* @file		sd_host.c
+* @brief	Host test of the SD card driver on the SD card model: the
+* 			driver, the block device layer and the SSP, GPDMA, GPIO and
+* 			clock drivers run unmodified, configured as in spi_sdcard.c.
+* 			Checks the CRC7/CRC16 tables against bit by bit references,
+* 			initializes SD 1.x, SD 2.0 and SDHC cards with the CRC check
+* 			off and on, reads and writes single blocks (CMD17/CMD24) and
+* 			32 blocks (CMD18/CMD25, ACMD23 with PreErase), recovers from
+* 			injected CRC errors, then measures the throughput of each
+* 			request size on the SDHC card.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_blkdev.h"
+#include "lpc17xx_sdcard.h"
+#include "sdsim.h"
+
+/* Card connection, as in spi_sdcard.c */
+#define CS_PORT_NUM			0
+#define CS_PIN_NUM			16
+#define SD_CLOCK_RATE		25000000
+#define SD_DMA_TX			0
+#define SD_DMA_RX			1
+
+/* Test parameters */
+#define HOST_REQ_BLOCKS		32			/* Multiple block requests */
+#define HOST_LBA_SINGLE		100			/* Block of the single block tests */
+#define HOST_LBA_MULTI		1000		/* First block of the multiple block tests */
+#define HOST_LBA_BENCH		4096		/* First block of the throughput runs */
+#define HOST_BENCH_BYTES	(128 * 1024)
+#define HOST_MIN_RATE		2000		/* Multiple block throughput (KB/s), at least */
+#define HOST_CRC_VECTORS	2000
+
+/** Cards: type, TRAN_SPEED, ACMD41 retries, blocks, then the latencies and
+ * busy times (us): read, read gap, CMD24, CMD25, CMD25 pre-erased, stop */
+static const SDSIM_CARD_Type host_card[] = {
+	{ SDSIM_SDV1, 0x2A, 20,  524288,   150, 20, 500, 200, 60, 100 },
+	{ SDSIM_SDV2, 0x32, 50,  2097152,  100, 10, 400, 150, 20, 100 },
+	{ SDSIM_SDHC, 0x32, 100, 16777216, 100, 10, 400, 150, 20, 100 }
+};
+static const char * const host_card_name[] = { "SDv1", "SDv2", "SDHC" };
+
+uint32_t SystemCoreClock = SDSIM_CCLK;
+
+/* The GPDMA channels keep the buffer addresses as 32-bit values, the
+ * buffers must be static in a non position independent executable */
+static SDC_Type host_sd;
+static uint8_t host_wr[HOST_REQ_BLOCKS * SDC_BLOCK_SIZE];
+static uint8_t host_rd[HOST_REQ_BLOCKS * SDC_BLOCK_SIZE];
+static uint8_t host_ref[SDC_BLOCK_SIZE];
+static uint32_t host_seed = 1;
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Pseudo random numbers
+ * @param[in]	None
+ * @return		Next value
+ **********************************************************************/
+static uint32_t host_Rand(void)
+{
+	host_seed = host_seed * 1103515245UL + 12345;
+	return host_seed >> 8;
+}
+
+/*********************************************************************//**
+ * @brief		Fill a buffer with random bytes
+ * @param[out]	buf		Buffer
+ * @param[in]	len		Number of bytes
+ * @return		None
+ **********************************************************************/
+static void host_Fill(uint8_t *buf, uint32_t len)
+{
+	while (len--) {
+		*buf++ = (uint8_t)host_Rand();
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Report a failed check
+ * @param[in]	name	Scenario
+ * @param[in]	msg		Check
+ * @return		1
+ **********************************************************************/
+static uint32_t host_Fail(const char *name, const char *msg)
+{
+	printf("%s: %s\n", name, msg);
+	return 1;
+}
+
+/*********************************************************************//**
+ * @brief		Compare blocks with the card content
+ * @param[in]	lba		First block
+ * @param[in]	buf		Expected data
+ * @param[in]	n		Number of blocks
+ * @return		Non zero if they differ
+ **********************************************************************/
+static uint32_t host_CardDiffers(uint32_t lba, const uint8_t *buf, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		SDSIM_Block(lba + i, host_ref);
+		if (memcmp(host_ref, buf + i * SDC_BLOCK_SIZE, SDC_BLOCK_SIZE) != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*********************************************************************//**
+ * @brief		CRC7 reference, bit by bit
+ **********************************************************************/
+static uint8_t host_Crc7(const uint8_t *data, uint32_t len)
+{
+	uint32_t i;
+	uint8_t crc = 0;
+
+	while (len--) {
+		for (i = 0x80; i != 0; i >>= 1) {
+			crc = (uint8_t)(((crc << 1) | ((*data & i) ? 1 : 0)));
+			if (crc & 0x80) {
+				crc ^= 0x89;
+			}
+		}
+		data++;
+	}
+	for (i = 0; i < 7; i++) {
+		crc = (uint8_t)(crc << 1);
+		if (crc & 0x80) {
+			crc ^= 0x89;
+		}
+	}
+	return crc;
+}
+
+/*********************************************************************//**
+ * @brief		CRC16 reference, bit by bit
+ **********************************************************************/
+static uint16_t host_Crc16(const uint8_t *data, uint32_t len)
+{
+	uint32_t i, crc = 0;
+
+	while (len--) {
+		for (i = 0x80; i != 0; i >>= 1) {
+			crc = (crc << 1) | ((*data & i) ? 1 : 0);
+			if (crc & 0x10000) {
+				crc ^= 0x11021;
+			}
+		}
+		data++;
+	}
+	for (i = 0; i < 16; i++) {
+		crc <<= 1;
+		if (crc & 0x10000) {
+			crc ^= 0x11021;
+		}
+	}
+	return (uint16_t)crc;
+}
+
+/*********************************************************************//**
+ * @brief		CRC tables of the driver against the references (as
+ * 				polynomial divisions, unlike the model) and known values
+ * @param[in]	None
+ * @return		Number of failed checks
+ **********************************************************************/
+static uint32_t host_CrcTests(void)
+{
+	static const uint8_t cmd0[5] = { 0x40, 0x00, 0x00, 0x00, 0x00 };
+	static const uint8_t cmd8[5] = { 0x48, 0x00, 0x00, 0x01, 0xAA };
+	static const uint8_t cmd17[5] = { 0x51, 0x00, 0x00, 0x00, 0x00 };
+	uint32_t i, len, split, fail = 0;
+
+	if ((SDC_Crc7(cmd0, 5) != 0x4A) || (SDC_Crc7(cmd8, 5) != 0x43) || (SDC_Crc7(cmd17, 5) != 0x2A)) {
+		fail += host_Fail("crc", "CRC7 of CMD0/CMD8/CMD17 frames");
+	}
+	memset(host_wr, 0xFF, SDC_BLOCK_SIZE);
+	if (SDC_Crc16(0, host_wr, SDC_BLOCK_SIZE) != 0x7FA1) {
+		fail += host_Fail("crc", "CRC16 of a 0xFF block");
+	}
+	for (i = 0; i < 256; i++) {
+		host_wr[0] = (uint8_t)i;
+		if ((SDC_Crc7(host_wr, 1) != host_Crc7(host_wr, 1)) || (SDC_Crc16(0, host_wr, 1) != host_Crc16(host_wr, 1))) {
+			fail += host_Fail("crc", "CRC of a single byte");
+			break;
+		}
+	}
+	for (i = 0; i < HOST_CRC_VECTORS; i++) {
+		len = 1 + host_Rand() % 16;
+		host_Fill(host_wr, len);
+		if (SDC_Crc7(host_wr, len) != host_Crc7(host_wr, len)) {
+			fail += host_Fail("crc", "CRC7 of a random frame");
+			break;
+		}
+		len = 1 + host_Rand() % SDC_BLOCK_SIZE;
+		split = host_Rand() % len;
+		host_Fill(host_wr, len);
+		if ((SDC_Crc16(0, host_wr, len) != host_Crc16(host_wr, len))
+				|| (SDC_Crc16(SDC_Crc16(0, host_wr, split), host_wr + split, len - split) != host_Crc16(host_wr, len))) {
+			fail += host_Fail("crc", "CRC16 of a random block");
+			break;
+		}
+	}
+	printf("CRC7/CRC16 tables: %u random vectors %s\n", HOST_CRC_VECTORS, fail ? "FAIL" : "ok");
+	return fail;
+}
+
+/*********************************************************************//**
+ * @brief		Power up a card and initialize the driver for it
+ * @param[in]	card	Card parameters
+ * @param[in]	crc		CRCCheck and PreErase
+ * @return		SDC_Init() result
+ **********************************************************************/
+static Status host_Init(const SDSIM_CARD_Type *card, uint8_t crc)
+{
+	SDSIM_Card(card, CS_PORT_NUM, CS_PIN_NUM);
+	memset(&host_sd, 0, sizeof(host_sd));
+	host_sd.SSPx = LPC_SSP0;
+	host_sd.CSPort = CS_PORT_NUM;
+	host_sd.CSPin = CS_PIN_NUM;
+	host_sd.DMATx = SD_DMA_TX;
+	host_sd.DMARx = SD_DMA_RX;
+	host_sd.ClockRate = SD_CLOCK_RATE;
+	host_sd.CRCCheck = crc;
+	host_sd.PreErase = crc;
+	GPDMA_Init();
+	return SDC_Init(&host_sd);
+}
+
+/*********************************************************************//**
+ * @brief		Initialization, single and multiple block transfers and,
+ * 				with the CRC check, CRC error recovery on one card
+ * @param[in]	idx		Card index
+ * @param[in]	crc		CRCCheck and PreErase
+ * @return		Number of failed checks
+ **********************************************************************/
+static uint32_t host_CardTests(uint32_t idx, uint8_t crc)
+{
+	const SDSIM_CARD_Type *card = &host_card[idx];
+	SDSIM_STATS_Type s0, s1;
+	BLKDEV_Type *dev = &host_sd.dev;
+	char name[32];
+	uint32_t fail = 0, errors = 0, rate;
+	uint64_t t0;
+
+	snprintf(name, sizeof(name), "%s crc %s", host_card_name[idx], crc ? "on " : "off");
+	t0 = SDSIM_Now();
+	if (host_Init(card, crc) != SUCCESS) {
+		printf("%s: SDC_Init failed, %s\n", name, SDSIM_Violation());
+		return 1;
+	}
+	t0 = SDSIM_Now() - t0;
+	rate = (card->TranSpeed == 0x2A) ? 20000000 : SD_CLOCK_RATE;
+	if (host_sd.Type != card->Type) {
+		fail += host_Fail(name, "card type");
+	}
+	if (host_sd.dev.BlockCount != card->Blocks) {
+		fail += host_Fail(name, "block count from the CSD");
+	}
+	if (memcmp(host_sd.CID, SDSIM_Cid(), 16) != 0) {
+		fail += host_Fail(name, "CID");
+	}
+	if (SDSIM_CrcOn() != crc) {
+		fail += host_Fail(name, "card CRC check (CMD59)");
+	}
+	if ((host_sd.ClockRate != rate) || (SDSIM_SckRate() > rate) || (SDSIM_SckRate() < rate / 2)) {
+		fail += host_Fail(name, "clock rate after the identification");
+	}
+
+	// Single and multiple block writes and reads
+	SDSIM_GetStats(&s0);
+	host_Fill(host_wr, sizeof(host_wr));
+	if ((BLK_Write(dev, HOST_LBA_SINGLE, host_wr, 1) != SUCCESS)
+			|| (BLK_Write(dev, HOST_LBA_MULTI, host_wr + SDC_BLOCK_SIZE, HOST_REQ_BLOCKS - 1) != SUCCESS)) {
+		fail += host_Fail(name, "write");
+	}
+	if (host_CardDiffers(HOST_LBA_SINGLE, host_wr, 1)
+			|| host_CardDiffers(HOST_LBA_MULTI, host_wr + SDC_BLOCK_SIZE, HOST_REQ_BLOCKS - 1)) {
+		fail += host_Fail(name, "data on the card");
+	}
+	memset(host_rd, 0, sizeof(host_rd));
+	if ((BLK_Read(dev, HOST_LBA_SINGLE, host_rd, 1) != SUCCESS)
+			|| (BLK_Read(dev, HOST_LBA_MULTI, host_rd + SDC_BLOCK_SIZE, HOST_REQ_BLOCKS - 1) != SUCCESS)
+			|| (memcmp(host_rd, host_wr, sizeof(host_rd)) != 0)) {
+		fail += host_Fail(name, "read back");
+	}
+	// Last blocks of the card, never written, then beyond its end
+	if ((BLK_Read(dev, dev->BlockCount - 8, host_rd, 8) != SUCCESS)
+			|| host_CardDiffers(dev->BlockCount - 8, host_rd, 8)) {
+		fail += host_Fail(name, "read of the last blocks");
+	}
+	if (BLK_Read(dev, dev->BlockCount - 1, host_rd, 2) != ERROR) {
+		fail += host_Fail(name, "read beyond the last block accepted");
+	}
+	SDSIM_GetStats(&s1);
+	if ((s1.Cmd[24] - s0.Cmd[24] != 1) || (s1.Cmd[25] - s0.Cmd[25] != 1)
+			|| (s1.Cmd[17] - s0.Cmd[17] != 1) || (s1.Cmd[18] - s0.Cmd[18] != 2)
+			|| (s1.Cmd[12] - s0.Cmd[12] != 2) || (s1.StopTokens - s0.StopTokens != 1)) {
+		fail += host_Fail(name, "commands of the transfers");
+	}
+	if ((s1.Acmd[23] - s0.Acmd[23] != (crc ? 1u : 0u))
+			|| (s1.PreErased - s0.PreErased != (crc ? HOST_REQ_BLOCKS - 1u : 0u))) {
+		fail += host_Fail(name, "ACMD23 pre-erase");
+	}
+	if ((s1.BlocksWritten - s0.BlocksWritten != HOST_REQ_BLOCKS)
+			|| (s1.DmaBlocks - s0.DmaBlocks != 2 * HOST_REQ_BLOCKS + 8)) {
+		fail += host_Fail(name, "blocks moved by GPDMA");
+	}
+
+	// Injected CRC errors: detected, the card is stopped, the next request works
+	if (crc) {
+		SDSIM_Inject(SDSIM_INJECT_READ_CRC);
+		if ((BLK_Read(dev, HOST_LBA_MULTI, host_rd, HOST_REQ_BLOCKS - 1) != ERROR) || (host_sd.crcerrors != 1)) {
+			fail += host_Fail(name, "CRC error of a multiple block read");
+		}
+		SDSIM_Inject(SDSIM_INJECT_READ_CRC);
+		if ((BLK_Read(dev, HOST_LBA_SINGLE, host_rd, 1) != ERROR) || (host_sd.crcerrors != 2)) {
+			fail += host_Fail(name, "CRC error of a single block read");
+		}
+		host_Fill(host_wr, sizeof(host_wr));
+		SDSIM_Inject(SDSIM_INJECT_WRITE_CRC);
+		if ((BLK_Write(dev, HOST_LBA_MULTI, host_wr, HOST_REQ_BLOCKS) != ERROR) || (host_sd.crcerrors != 3)) {
+			fail += host_Fail(name, "CRC error of a multiple block write");
+		}
+		SDSIM_Inject(SDSIM_INJECT_WRITE_CRC);
+		if ((BLK_Write(dev, HOST_LBA_SINGLE, host_wr, 1) != ERROR) || (host_sd.crcerrors != 4)) {
+			fail += host_Fail(name, "CRC error of a single block write");
+		}
+		errors = 4;
+		if ((BLK_Write(dev, HOST_LBA_MULTI, host_wr, HOST_REQ_BLOCKS) != SUCCESS)
+				|| (BLK_Read(dev, HOST_LBA_MULTI, host_rd, HOST_REQ_BLOCKS) != SUCCESS)
+				|| (memcmp(host_rd, host_wr, sizeof(host_rd)) != 0)) {
+			fail += host_Fail(name, "transfer after the CRC errors");
+		}
+	}
+
+	SDSIM_GetStats(&s1);
+	if ((s1.CmdCrcErrors != 0) || (s1.DataCrcErrors != 0)) {
+		fail += host_Fail(name, "CRC7 or CRC16 rejected by the card");
+	}
+	if ((host_sd.errors != errors) || (host_sd.timeouts != 0)) {
+		fail += host_Fail(name, "driver error counters");
+	}
+	if (s1.Violations != 0) {
+		printf("%s: %s\n", name, SDSIM_Violation());
+		fail++;
+	}
+	printf("%s: init %5.1f ms, SCK %5u KHz, %3u data commands, %3u blocks %s\n", name,
+			(double)t0 * 1000.0 / SDSIM_CCLK, (unsigned)(SDSIM_SckRate() / 1000),
+			(unsigned)(s1.Cmd[17] + s1.Cmd[18] + s1.Cmd[24] + s1.Cmd[25]),
+			(unsigned)(s1.BlocksRead + s1.BlocksWritten), fail ? "FAIL" : "ok");
+	return fail;
+}
+
+/*********************************************************************//**
+ * @brief		Throughput of one request size, sequential
+ * @param[in]	write	TRUE to write
+ * @param[in]	n		Blocks per request
+ * @param[in]	pre		PreErase
+ * @return		Throughput (KB/s), 0 on error
+ **********************************************************************/
+static uint32_t host_Bench(uint8_t write, uint32_t n, uint8_t pre)
+{
+	SDSIM_STATS_Type s0, s1;
+	uint32_t lba, done;
+	uint64_t t0;
+	Status ret;
+
+	host_sd.PreErase = pre;
+	SDSIM_GetStats(&s0);
+	t0 = SDSIM_Now();
+	lba = HOST_LBA_BENCH;
+	for (done = 0; done < HOST_BENCH_BYTES; done += n * SDC_BLOCK_SIZE) {
+		if (write) {
+			ret = BLK_Write(&host_sd.dev, lba, host_wr, n);
+		} else {
+			ret = BLK_Read(&host_sd.dev, lba, host_rd, n);
+		}
+		if (ret != SUCCESS) {
+			return 0;
+		}
+		lba += n;
+	}
+	t0 = SDSIM_Now() - t0;
+	SDSIM_GetStats(&s1);
+	printf("%-5s %2u block(s)/request%s: %4u.%02u MB/s, %4u commands, %4u pre-erased, %.1f us/block\n",
+			write ? "write" : "read", (unsigned)n, pre ? " pre-erased" : "           ",
+			(unsigned)((uint64_t)HOST_BENCH_BYTES * SDSIM_CCLK / t0 / 1000000),
+			(unsigned)((uint64_t)HOST_BENCH_BYTES * SDSIM_CCLK / t0 / 10000 % 100),
+			(unsigned)(s1.Cmd[17] + s1.Cmd[18] + s1.Cmd[24] + s1.Cmd[25] - s0.Cmd[17] - s0.Cmd[18] - s0.Cmd[24] - s0.Cmd[25]),
+			(unsigned)(s1.PreErased - s0.PreErased),
+			(double)t0 * 1e6 / SDSIM_CCLK / (HOST_BENCH_BYTES / SDC_BLOCK_SIZE));
+	return (uint32_t)((uint64_t)HOST_BENCH_BYTES * SDSIM_CCLK / t0 / 1000);
+}
+
+/*********************************************************************//**
+ * @brief		Throughput on the SDHC card, CRC check on, as in
+ * 				spi_sdcard.c
+ * @param[in]	None
+ * @return		Number of failed checks
+ **********************************************************************/
+static uint32_t host_BenchTests(void)
+{
+	SDSIM_STATS_Type st;
+	uint32_t rd1, rd, wr1, wr, wrpre, fail = 0;
+
+	if (host_Init(&host_card[2], TRUE) != SUCCESS) {
+		return host_Fail("bench", "SDC_Init failed");
+	}
+	printf("\nthroughput, SDHC card, SCK %u KHz, CRC check on, %u KB per run\n",
+			(unsigned)(SDSIM_SckRate() / 1000), HOST_BENCH_BYTES / 1024);
+	host_Fill(host_wr, sizeof(host_wr));
+	rd1 = host_Bench(FALSE, 1, FALSE);
+	rd = host_Bench(FALSE, HOST_REQ_BLOCKS, FALSE);
+	wr1 = host_Bench(TRUE, 1, FALSE);
+	wr = host_Bench(TRUE, HOST_REQ_BLOCKS, FALSE);
+	wrpre = host_Bench(TRUE, HOST_REQ_BLOCKS, TRUE);
+	if ((rd1 == 0) || (rd == 0) || (wr1 == 0) || (wr == 0) || (wrpre == 0)) {
+		fail += host_Fail("bench", "request failed");
+	}
+	if ((rd < HOST_MIN_RATE) || (wrpre < HOST_MIN_RATE)) {
+		fail += host_Fail("bench", "multiple block throughput below 2MB/s");
+	}
+	if ((rd <= rd1) || (wr <= wr1) || (wrpre <= wr)) {
+		fail += host_Fail("bench", "CMD18/CMD25 or ACMD23 do not pay off");
+	}
+	if (host_CardDiffers(HOST_LBA_BENCH + HOST_BENCH_BYTES / SDC_BLOCK_SIZE - HOST_REQ_BLOCKS, host_wr, HOST_REQ_BLOCKS)) {
+		fail += host_Fail("bench", "data on the card");
+	}
+	SDSIM_GetStats(&st);
+	if ((st.Violations != 0) || (host_sd.errors != 0) || (host_sd.timeouts != 0)) {
+		printf("bench: %u error(s) %s\n", (unsigned)(st.Violations + host_sd.errors + host_sd.timeouts),
+				SDSIM_Violation());
+		fail++;
+	}
+	return fail;
+}
+
+int main(void)
+{
+	uint32_t fail, idx;
+
+	SDSIM_Init();
+	fail = host_CrcTests();
+	for (idx = 0; idx < sizeof(host_card) / sizeof(host_card[0]); idx++) {
+		fail += host_CardTests(idx, FALSE);
+		fail += host_CardTests(idx, TRUE);
+	}
+	fail += host_BenchTests();
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
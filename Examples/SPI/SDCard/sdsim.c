@@ -0,0 +1,1454 @@
+/**********************************************************************
+* $Id$		sdsim.c				2011-03-09
+*//**
+* @file		sdsim.c
+* @brief	Host model of an SD card on SSP0 in SPI mode. The register
+* 			pages of SSP0, of the GPDMA controller and of the GPIO ports
+* 			are mapped without access rights: each access of the driver
+* 			faults, is prepared by the model, single-stepped and applied.
+* 			The system control page is plain memory, so that the clock
+* 			driver runs unmodified and the model reads the SSP0
+* 			peripheral clock from it.
+*
+* 			A byte written to DR is exchanged with the card 8 SCK periods
+* 			after the previous one ends; a status read that would spin
+* 			until a byte or a GPDMA transfer is done advances the time to
+* 			it. Two enabled GPDMA channels serving SSP0 (receive and
+* 			transmit) move their whole transfer at once, the bytes back to
+* 			back on the bus, and raise terminal count at its end. A
+* 			register access costs SDSIM_ACCESS_CYCLES; with the card CRC
+* 			on (CMD59) the driver table CRC16 of a block costs
+* 			SIM_CRC16_CYCLES per byte, after a block is received and
+* 			while one is transmitted.
+*
+* 			The card follows the SPI mode protocol: CMD0 after 74 clocks,
+* 			CMD8, ACMD41 (idle for a number of retries), CMD58, CMD59,
+* 			CMD16, CMD9/CMD10 register blocks, CMD17/CMD18 data blocks
+* 			after a read latency, CMD12 with its stuff byte, CMD24/CMD25
+* 			data tokens, data responses and busy, the CMD25 stop token
+* 			and the ACMD23 pre-erase count. It checks the CRC7 of every
+* 			command and, with CRC on, the CRC16 of every block written,
+* 			both bit by bit, independently of the driver tables.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "LPC17xx.h"
+#include "lpc17xx_ssp.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_clkpwr.h"
+#include "sdsim.h"
+
+/* Model parameters */
+#define SIM_PAGE_SZ			0x00001000UL
+#define SIM_PAGE_SSP		0
+#define SIM_PAGE_DMA		1
+#define SIM_PAGE_GPIO		2
+#define SIM_PAGE_NUM		3				/* Trapped pages, the system control page follows */
+#define SIM_FIFO_SZ			8				/* SSP receive FIFO */
+#define SIM_DMA_CH			8
+#define SIM_GPIO_PORTS		5
+#define SIM_QUEUE_SZ		1024			/* Card output bytes */
+#define SIM_STORE_NUM		16384			/* Blocks written the store can hold */
+#define SIM_CRC16_CYCLES	8				/* Driver table CRC16, per byte */
+#define SIM_ID_CLOCK		400000			/* Identification clock limit (Hz) */
+#define SIM_US(us)			((uint64_t)(us) * (SDSIM_CCLK / 1000000))
+
+/* Register offsets */
+#define SIM_SSP(reg)		offsetof(LPC_SSP_TypeDef, reg)
+#define SIM_DMA(reg)		offsetof(LPC_GPDMA_TypeDef, reg)
+#define SIM_DMACH(n, reg)	((LPC_GPDMACH0_BASE - LPC_GPDMA_BASE) + (n) * 0x20 + offsetof(LPC_GPDMACH_TypeDef, reg))
+#define SIM_GPIO(n, reg)	((n) * sizeof(LPC_GPIO_TypeDef) + offsetof(LPC_GPIO_TypeDef, reg))
+
+/* GPDMA channel configuration fields */
+#define SIM_CFG_SRCPER(cfg)	(((cfg) >> 1) & 0x1F)
+#define SIM_CFG_TYPE(cfg)	(((cfg) >> 11) & 0x07)
+#define SIM_CTRL_SIZE(ctrl)	((ctrl) & 0xFFF)
+#define SIM_CTRL_WIDTH(ctrl) (((ctrl) >> 18) & 0x3F)
+
+/* x86-64 trap flag and page fault error code */
+#define SIM_EFL_TF			0x00000100
+#define SIM_ERR_WRITE		0x00000002
+
+/* R1 bits */
+#define SIM_R1_IDLE			0x01
+#define SIM_R1_ILLEGAL		0x04
+#define SIM_R1_CRC			0x08
+#define SIM_R1_ADDRESS		0x20
+#define SIM_R1_PARAM		0x40
+
+/* Card states */
+#define SIM_MODE_CMD		0		/* Between commands */
+#define SIM_MODE_READ		1		/* CMD17/CMD18 data blocks */
+#define SIM_MODE_WR_TOKEN	2		/* CMD24/CMD25, wait for a data token */
+#define SIM_MODE_WR_DATA	3		/* Receive a block and its CRC16 */
+
+/** SSP0 */
+typedef struct {
+	uint32_t cr0;
+	uint32_t cr1;
+	uint32_t cpsr;
+	uint32_t imsc;
+	uint32_t dmacr;
+	uint32_t dr;			/* Last byte read */
+	uint8_t rx[SIM_FIFO_SZ];
+	uint64_t rxdone[SIM_FIFO_SZ];	/* End of the byte on the bus */
+	uint32_t rxhead;
+	uint32_t rxnum;
+	uint64_t txfree;		/* End of the last byte on the bus */
+} SIM_SSP_Type;
+
+/** GPDMA channel */
+typedef struct {
+	uint32_t src;
+	uint32_t dst;
+	uint32_t lli;
+	uint32_t ctrl;
+	uint32_t cfg;
+} SIM_CH_Type;
+
+/** GPIO port */
+typedef struct {
+	uint32_t dir;
+	uint32_t mask;
+	uint32_t pin;
+} SIM_PORT_Type;
+
+/** Card */
+typedef struct {
+	SDSIM_CARD_Type cfg;
+	uint8_t port;
+	uint8_t pin;
+	uint8_t csd[16];
+	uint8_t cid[16];
+	uint32_t selected;
+	uint32_t spi;			/* SPI mode, entered by CMD0 */
+	uint32_t idle;
+	uint32_t app;			/* CMD55 seen, next command is an ACMD */
+	uint32_t crcon;
+	uint32_t retries;		/* ACMD41 still answered idle */
+	uint32_t clocks;		/* Clocks before the first CMD0 */
+	uint32_t maxrate;		/* TRAN_SPEED (bit/s) */
+	uint8_t frame[6];
+	uint32_t flen;
+	uint32_t mode;			/* SIM_MODE_xxx */
+	uint32_t multi;			/* CMD18/CMD25 */
+	uint32_t lba;
+	uint64_t ready;			/* Read: next data token */
+	uint32_t queued;		/* Read: a block is in the output queue */
+	uint8_t blk[SDSIM_BLOCK_BYTES + 2];
+	uint32_t blen;
+	uint32_t erase;			/* ACMD23 count, for the next CMD25 */
+	uint32_t written;		/* Blocks of the running CMD25 */
+	uint64_t busy;			/* Programming until */
+	uint32_t inject;
+	uint8_t q[SIM_QUEUE_SZ];
+	uint32_t qhead;
+	uint32_t qnum;
+} SIM_CARD_Type;
+
+static const uintptr_t sim_base[SIM_PAGE_NUM + 1] = {
+	LPC_SSP0_BASE, LPC_GPDMA_BASE, LPC_GPIO0_BASE, LPC_SC_BASE
+};
+
+/** CSD TRAN_SPEED time value, times 10 */
+static const uint8_t sim_TranValue[16] = {
+	0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80
+};
+
+static SIM_SSP_Type sim_ssp;
+static SIM_CH_Type sim_ch[SIM_DMA_CH];
+static uint32_t sim_dmacfg;
+static uint32_t sim_tcstat;
+static uint32_t sim_errstat;
+static uint32_t sim_dmabusy;		/* Channels of the transfer in flight */
+static uint64_t sim_dmadone;
+static SIM_PORT_Type sim_port[SIM_GPIO_PORTS];
+static SIM_CARD_Type sim_card;
+static uint32_t *sim_tag;			/* lba + 1 of a stored block, 0: free */
+static uint8_t *sim_data;
+static uint64_t sim_now;
+static uint64_t sim_debt;			/* Processor cycles charged at the next access */
+
+/* Access being single-stepped */
+static volatile int sim_inhandler;
+static uint32_t sim_page;
+static uint32_t sim_ofs;
+static uint32_t sim_write;
+static uint32_t sim_before;
+
+static SDSIM_STATS_Type sim_stats;
+static char sim_violation[160];
+
+/* Private Functions ---------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Count a programming or protocol error, keep the first
+ * @param[in]	msg		Description
+ * @return 		None
+ **********************************************************************/
+static void sim_Violation(const char *msg)
+{
+	if (sim_stats.Violations++ == 0) {
+		snprintf(sim_violation, sizeof(sim_violation), "%s (CMD%u, %.1f us)", msg,
+				(unsigned)(sim_card.frame[0] & 0x3F), (double)sim_now * 1e6 / SDSIM_CCLK);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Word of a trapped page
+ * @param[in]	page	Page index
+ * @param[in]	ofs		Offset
+ * @return 		Pointer to the word
+ **********************************************************************/
+static volatile uint32_t *sim_Reg(uint32_t page, uint32_t ofs)
+{
+	return (volatile uint32_t *)(sim_base[page] + ofs);
+}
+
+/*********************************************************************//**
+ * @brief		CRC7 of a command or register, bit by bit
+ * @param[in]	data	Bytes
+ * @param[in]	len		Number of bytes
+ * @return 		CRC7
+ **********************************************************************/
+static uint8_t sim_Crc7(const uint8_t *data, uint32_t len)
+{
+	uint32_t i, bit;
+	uint8_t crc = 0;
+
+	while (len--) {
+		for (i = 0; i < 8; i++) {
+			bit = ((crc >> 6) ^ (*data >> (7 - i))) & 1;
+			crc = (uint8_t)((crc << 1) & 0x7F);
+			if (bit) {
+				crc ^= 0x09;
+			}
+		}
+		data++;
+	}
+	return crc;
+}
+
+/*********************************************************************//**
+ * @brief		CRC16 of a data block, bit by bit
+ * @param[in]	data	Bytes
+ * @param[in]	len		Number of bytes
+ * @return 		CRC16
+ **********************************************************************/
+static uint16_t sim_Crc16(const uint8_t *data, uint32_t len)
+{
+	uint32_t i, bit;
+	uint16_t crc = 0;
+
+	while (len--) {
+		for (i = 0; i < 8; i++) {
+			bit = ((crc >> 15) ^ (*data >> (7 - i))) & 1;
+			crc = (uint16_t)(crc << 1);
+			if (bit) {
+				crc ^= 0x1021;
+			}
+		}
+		data++;
+	}
+	return crc;
+}
+
+/*********************************************************************//**
+ * @brief		Stored block of the card, or the pattern of a block never
+ * 				written
+ * @param[in]	lba		Block
+ * @param[in]	alloc	Make room for it
+ * @return 		Stored block, NULL if not stored
+ **********************************************************************/
+static uint8_t *sim_Store(uint32_t lba, uint32_t alloc)
+{
+	uint32_t i, n;
+
+	i = (lba * 2654435761UL) & (SIM_STORE_NUM - 1);
+	for (n = 0; n < SIM_STORE_NUM; n++) {
+		if (sim_tag[i] == lba + 1) {
+			return &sim_data[i * SDSIM_BLOCK_BYTES];
+		}
+		if (sim_tag[i] == 0) {
+			if (!alloc) {
+				return NULL;
+			}
+			sim_tag[i] = lba + 1;
+			return &sim_data[i * SDSIM_BLOCK_BYTES];
+		}
+		i = (i + 1) & (SIM_STORE_NUM - 1);
+	}
+	fprintf(stderr, "sdsim: block store full\n");
+	exit(2);
+}
+
+/*********************************************************************//**
+ * @brief		Content of a block
+ * @param[in]	lba		Block
+ * @param[out]	data	SDSIM_BLOCK_BYTES bytes
+ * @return 		None
+ **********************************************************************/
+static void sim_BlockData(uint32_t lba, uint8_t *data)
+{
+	const uint8_t *p = sim_Store(lba, 0);
+	uint32_t i;
+
+	if (p != NULL) {
+		memcpy(data, p, SDSIM_BLOCK_BYTES);
+		return;
+	}
+	for (i = 0; i < SDSIM_BLOCK_BYTES; i++) {
+		data[i] = (uint8_t)((lba >> ((i & 3) * 8)) ^ (i >> 2) ^ 0xA5);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		SCK period of SSP0
+ * @param[in]	None
+ * @return 		Core cycles per bit, 0 if the clock is not set
+ **********************************************************************/
+static uint32_t sim_BitCycles(void)
+{
+	uint32_t pclk;
+
+	pclk = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_SSP0);
+	if ((pclk == 0) || (sim_ssp.cpsr < 2)) {
+		return 0;
+	}
+	return (SDSIM_CCLK / pclk) * sim_ssp.cpsr * (((sim_ssp.cr0 >> 8) & 0xFF) + 1);
+}
+
+/*********************************************************************//**
+ * @brief		Queue a byte of the card output
+ * @param[in]	c		Card
+ * @param[in]	data	Byte
+ * @return 		None
+ **********************************************************************/
+static void sim_Push(SIM_CARD_Type *c, uint8_t data)
+{
+	if (c->qnum == SIM_QUEUE_SZ) {
+		fprintf(stderr, "sdsim: card output queue full\n");
+		exit(2);
+	}
+	c->q[(c->qhead + c->qnum++) % SIM_QUEUE_SZ] = data;
+}
+
+/*********************************************************************//**
+ * @brief		Queue an R1 response after one byte (Ncr)
+ * @param[in]	c		Card
+ * @param[in]	r1		Error bits, the idle bit is added
+ * @return 		None
+ **********************************************************************/
+static void sim_R1(SIM_CARD_Type *c, uint8_t r1)
+{
+	sim_Push(c, 0xFF);
+	sim_Push(c, r1 | (c->idle ? SIM_R1_IDLE : 0));
+}
+
+/*********************************************************************//**
+ * @brief		Queue a data block: start token, data and CRC16
+ * @param[in]	c		Card
+ * @param[in]	data	Bytes
+ * @param[in]	len		Number of bytes
+ * @param[in]	crc		CRC16 to send
+ * @return 		None
+ **********************************************************************/
+static void sim_PushBlock(SIM_CARD_Type *c, const uint8_t *data, uint32_t len, uint16_t crc)
+{
+	uint32_t i;
+
+	sim_Push(c, 0xFE);
+	for (i = 0; i < len; i++) {
+		sim_Push(c, data[i]);
+	}
+	sim_Push(c, (uint8_t)(crc >> 8));
+	sim_Push(c, (uint8_t)crc);
+}
+
+/*********************************************************************//**
+ * @brief		Queue the next block of a read command
+ * @param[in]	c		Card
+ * @return 		None
+ **********************************************************************/
+static void sim_ReadBlock(SIM_CARD_Type *c)
+{
+	uint8_t data[SDSIM_BLOCK_BYTES];
+	uint16_t crc;
+
+	if (c->lba >= c->cfg.Blocks) {
+		// Error token: out of range
+		sim_Push(c, 0x08);
+		c->mode = SIM_MODE_CMD;
+		return;
+	}
+	sim_BlockData(c->lba, data);
+	crc = sim_Crc16(data, SDSIM_BLOCK_BYTES);
+	if (c->inject == SDSIM_INJECT_READ_CRC) {
+		c->inject = 0;
+		crc ^= 0x0001;
+	}
+	sim_PushBlock(c, data, SDSIM_BLOCK_BYTES, crc);
+	c->queued = 1;
+	sim_stats.BlocksRead++;
+}
+
+/*********************************************************************//**
+ * @brief		The last byte of a read block is out: next block after
+ * 				the gap, or end of CMD17. With CRC on, the driver checks
+ * 				the block now.
+ * @param[in]	c		Card
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_ReadDone(SIM_CARD_Type *c, uint64_t t)
+{
+	c->queued = 0;
+	if (c->crcon) {
+		sim_debt += SDSIM_BLOCK_BYTES * SIM_CRC16_CYCLES;
+	}
+	if (c->multi) {
+		c->lba++;
+		c->ready = t + SIM_US(c->cfg.ReadGap);
+	} else {
+		c->mode = SIM_MODE_CMD;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		A block and its CRC16 are received: data response, then
+ * 				busy while the block is programmed
+ * @param[in]	c		Card
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_WriteBlock(SIM_CARD_Type *c, uint64_t t)
+{
+	uint16_t crc;
+	uint32_t ok, us;
+
+	crc = ((uint16_t)c->blk[SDSIM_BLOCK_BYTES] << 8) | c->blk[SDSIM_BLOCK_BYTES + 1];
+	ok = !c->crcon || (crc == sim_Crc16(c->blk, SDSIM_BLOCK_BYTES));
+	if (!ok) {
+		sim_stats.DataCrcErrors++;
+	}
+	if (c->inject == SDSIM_INJECT_WRITE_CRC) {
+		c->inject = 0;
+		ok = 0;
+	}
+	c->mode = c->multi ? SIM_MODE_WR_TOKEN : SIM_MODE_CMD;
+	if (!ok) {
+		// Data rejected, CRC error; upper bits undefined
+		sim_Push(c, 0xEB);
+		return;
+	}
+	if (c->lba >= c->cfg.Blocks) {
+		// Write error
+		sim_Push(c, 0xED);
+		return;
+	}
+	memcpy(sim_Store(c->lba, 1), c->blk, SDSIM_BLOCK_BYTES);
+	sim_stats.BlocksWritten++;
+	if (!c->multi) {
+		us = c->cfg.WriteBusy;
+	} else if (c->written < c->erase) {
+		us = c->cfg.ErasedBusy;
+		sim_stats.PreErased++;
+	} else {
+		us = c->cfg.MultiBusy;
+	}
+	c->written++;
+	c->lba++;
+	sim_Push(c, 0xE5);
+	c->busy = t + SIM_US(us);
+}
+
+/*********************************************************************//**
+ * @brief		Block address of a data command
+ * @param[in]	c		Card
+ * @param[in]	arg		Command argument
+ * @param[out]	lba		Block
+ * @return 		R1 error bits, 0 if the address is valid
+ **********************************************************************/
+static uint8_t sim_Address(SIM_CARD_Type *c, uint32_t arg, uint32_t *lba)
+{
+	if (c->cfg.Type == SDSIM_SDHC) {
+		*lba = arg;
+	} else if (arg % SDSIM_BLOCK_BYTES) {
+		sim_Violation("misaligned byte address");
+		return SIM_R1_ADDRESS;
+	} else {
+		*lba = arg / SDSIM_BLOCK_BYTES;
+	}
+	if (*lba >= c->cfg.Blocks) {
+		sim_Violation("address out of range");
+		return SIM_R1_PARAM;
+	}
+	return 0;
+}
+
+/*********************************************************************//**
+ * @brief		Execute a received command frame
+ * @param[in]	c		Card
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_Command(SIM_CARD_Type *c, uint64_t t)
+{
+	uint32_t cmd, arg, app, crcok, ocr;
+	uint8_t r1;
+
+	cmd = c->frame[0] & 0x3F;
+	arg = ((uint32_t)c->frame[1] << 24) | ((uint32_t)c->frame[2] << 16)
+			| ((uint32_t)c->frame[3] << 8) | c->frame[4];
+	if (!(c->frame[5] & 1)) {
+		sim_Violation("command without end bit");
+	}
+	crcok = (c->frame[5] >> 1) == sim_Crc7(c->frame, 5);
+	if (!crcok) {
+		sim_stats.CmdCrcErrors++;
+	}
+	app = c->app;
+	c->app = 0;
+	if (app) {
+		sim_stats.Acmd[cmd]++;
+	} else {
+		sim_stats.Cmd[cmd]++;
+	}
+	c->qnum = 0;
+
+	if (!c->spi) {
+		// SD mode: only CMD0 with chip select low enters SPI mode
+		if ((cmd != 0) || !crcok) {
+			return;
+		}
+		if (c->clocks < 74) {
+			sim_Violation("fewer than 74 clocks before CMD0");
+		}
+		c->spi = 1;
+		c->idle = 1;
+		c->crcon = 0;
+		c->retries = c->cfg.InitRetries;
+		sim_R1(c, 0);
+		return;
+	}
+	if (!crcok && (c->crcon || (cmd == 0) || (cmd == 8))) {
+		sim_R1(c, SIM_R1_CRC);
+		return;
+	}
+	if (c->mode == SIM_MODE_READ) {
+		if (app || (cmd != 12)) {
+			sim_Violation("command other than CMD12 while reading");
+		}
+		// Stop: R1 after the stuff byte, then busy
+		c->mode = SIM_MODE_CMD;
+		c->queued = 0;
+		sim_Push(c, 0xFF);
+		sim_R1(c, 0);
+		c->busy = t + SIM_US(c->cfg.StopBusy);
+		return;
+	}
+
+	if (app) {
+		switch (cmd) {
+		case 41:
+			if (c->idle && ((c->cfg.Type != SDSIM_SDHC) || (arg & (1UL << 30)))) {
+				if (c->retries != 0) {
+					c->retries--;
+				} else {
+					c->idle = 0;
+				}
+			}
+			sim_R1(c, 0);
+			break;
+		case 23:
+			if (c->idle) {
+				sim_R1(c, SIM_R1_ILLEGAL);
+				break;
+			}
+			c->erase = arg & 0x7FFFFF;
+			sim_R1(c, 0);
+			break;
+		default:
+			sim_R1(c, SIM_R1_ILLEGAL);
+			break;
+		}
+		return;
+	}
+
+	switch (cmd) {
+	case 0:
+		c->idle = 1;
+		c->crcon = 0;
+		c->retries = c->cfg.InitRetries;
+		c->mode = SIM_MODE_CMD;
+		sim_R1(c, 0);
+		return;
+	case 8:
+		if (c->cfg.Type == SDSIM_SDV1) {
+			sim_R1(c, SIM_R1_ILLEGAL);
+			return;
+		}
+		sim_R1(c, 0);
+		sim_Push(c, 0x00);
+		sim_Push(c, 0x00);
+		sim_Push(c, (uint8_t)((arg >> 8) & 0x0F));
+		sim_Push(c, (uint8_t)arg);
+		return;
+	case 55:
+		c->app = 1;
+		sim_R1(c, 0);
+		return;
+	case 58:
+		ocr = 0x00FF8000;
+		if (!c->idle) {
+			ocr |= 0x80000000;
+			if (c->cfg.Type == SDSIM_SDHC) {
+				ocr |= 0x40000000;
+			}
+		}
+		sim_R1(c, 0);
+		sim_Push(c, (uint8_t)(ocr >> 24));
+		sim_Push(c, (uint8_t)(ocr >> 16));
+		sim_Push(c, (uint8_t)(ocr >> 8));
+		sim_Push(c, (uint8_t)ocr);
+		return;
+	case 59:
+		c->crcon = arg & 1;
+		sim_R1(c, 0);
+		return;
+	default:
+		break;
+	}
+	if (c->idle) {
+		sim_R1(c, SIM_R1_ILLEGAL);
+		return;
+	}
+
+	switch (cmd) {
+	case 9:
+	case 10:
+		sim_R1(c, 0);
+		sim_Push(c, 0xFF);
+		sim_PushBlock(c, (cmd == 9) ? c->csd : c->cid, 16, sim_Crc16((cmd == 9) ? c->csd : c->cid, 16));
+		break;
+	case 12:
+		sim_R1(c, 0);
+		break;
+	case 16:
+		sim_R1(c, ((c->cfg.Type != SDSIM_SDHC) && (arg != SDSIM_BLOCK_BYTES)) ? SIM_R1_PARAM : 0);
+		break;
+	case 17:
+	case 18:
+		r1 = sim_Address(c, arg, &c->lba);
+		sim_R1(c, r1);
+		if (r1 == 0) {
+			c->mode = SIM_MODE_READ;
+			c->multi = (cmd == 18);
+			c->queued = 0;
+			c->ready = t + SIM_US(c->cfg.ReadLatency);
+		}
+		break;
+	case 24:
+	case 25:
+		r1 = sim_Address(c, arg, &c->lba);
+		sim_R1(c, r1);
+		if (r1 == 0) {
+			c->mode = SIM_MODE_WR_TOKEN;
+			c->multi = (cmd == 25);
+			c->written = 0;
+			if (!c->multi) {
+				c->erase = 0;
+			}
+		}
+		break;
+	default:
+		sim_R1(c, SIM_R1_ILLEGAL);
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Byte received by the selected card
+ * @param[in]	c		Card
+ * @param[in]	in		Byte
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_CardInput(SIM_CARD_Type *c, uint8_t in, uint64_t t)
+{
+	if (c->mode == SIM_MODE_WR_DATA) {
+		c->blk[c->blen++] = in;
+		if (c->blen == sizeof(c->blk)) {
+			sim_WriteBlock(c, t);
+		}
+		return;
+	}
+	if ((t < c->busy) && (c->qnum == 0)) {
+		if (in != 0xFF) {
+			sim_Violation("byte other than 0xFF while the card is busy");
+		}
+		return;
+	}
+	if (c->mode == SIM_MODE_WR_TOKEN) {
+		if (in == 0xFF) {
+			return;
+		}
+		if (in == (c->multi ? 0xFC : 0xFE)) {
+			c->mode = SIM_MODE_WR_DATA;
+			c->blen = 0;
+		} else if (c->multi && (in == 0xFD)) {
+			// Stop token: one byte, then busy
+			sim_stats.StopTokens++;
+			c->mode = SIM_MODE_CMD;
+			c->erase = 0;
+			sim_Push(c, 0xFF);
+			c->busy = t + SIM_US(c->cfg.StopBusy);
+		} else {
+			sim_Violation("wrong data token");
+		}
+		return;
+	}
+	if (c->flen == 0) {
+		if (in == 0xFF) {
+			return;
+		}
+		if ((in & 0xC0) != 0x40) {
+			sim_Violation("byte other than 0xFF between commands");
+			return;
+		}
+	}
+	c->frame[c->flen++] = in;
+	if (c->flen == sizeof(c->frame)) {
+		c->flen = 0;
+		sim_Command(c, t);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Exchange one byte with the card
+ * @param[in]	in		Byte sent by SSP0
+ * @param[in]	t		Start of the byte on the bus
+ * @return 		Byte sent by the card
+ **********************************************************************/
+static uint8_t sim_CardByte(uint8_t in, uint64_t t)
+{
+	SIM_CARD_Type *c = &sim_card;
+	uint32_t bit;
+	uint8_t out;
+
+	sim_stats.SpiBytes++;
+	if (!c->spi) {
+		c->clocks += 8;
+	}
+	if ((sim_ssp.cr0 & 0xFF) != 0x07) {
+		sim_Violation("SSP0 not in 8-bit SPI mode 0");
+	}
+	if (!c->selected) {
+		return 0xFF;
+	}
+	bit = sim_BitCycles();
+	if (c->spi && c->idle && (bit != 0) && (SDSIM_CCLK / bit > SIM_ID_CLOCK)) {
+		sim_Violation("clock above 400KHz during identification");
+	}
+	if ((bit != 0) && (SDSIM_CCLK / bit > c->maxrate)) {
+		sim_Violation("clock above the card transfer rate");
+	}
+
+	if ((c->mode == SIM_MODE_READ) && !c->queued && (c->qnum == 0) && (t >= c->ready)) {
+		sim_ReadBlock(c);
+	}
+	out = 0xFF;
+	if (c->qnum != 0) {
+		out = c->q[c->qhead];
+		c->qhead = (c->qhead + 1) % SIM_QUEUE_SZ;
+		c->qnum--;
+		if ((c->qnum == 0) && c->queued) {
+			sim_ReadDone(c, t);
+		}
+	} else if (t < c->busy) {
+		out = 0x00;
+	}
+	sim_CardInput(c, in, t);
+	return out;
+}
+
+/*********************************************************************//**
+ * @brief		Chip select of the card changed
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_CardSelect(void)
+{
+	SIM_CARD_Type *c = &sim_card;
+	SIM_PORT_Type *p = &sim_port[c->port];
+	uint32_t sel;
+
+	sel = ((p->dir >> c->pin) & 1) && !((p->pin >> c->pin) & 1);
+	if (sel == c->selected) {
+		return;
+	}
+	c->selected = sel;
+	if (sel) {
+		return;
+	}
+	if (c->flen != 0) {
+		sim_Violation("chip select released within a command");
+	}
+	if ((c->mode == SIM_MODE_WR_DATA) || (c->mode == SIM_MODE_READ)
+			|| ((c->mode == SIM_MODE_WR_TOKEN) && c->multi)) {
+		sim_Violation("chip select released during a data transfer");
+	}
+	c->flen = 0;
+	c->qnum = 0;
+	c->queued = 0;
+	c->mode = SIM_MODE_CMD;
+}
+
+/*********************************************************************//**
+ * @brief		Byte written to DR: exchanged when the previous one ends
+ * @param[in]	val		Byte
+ * @return 		None
+ **********************************************************************/
+static void sim_SspSend(uint32_t val)
+{
+	uint64_t start;
+	uint32_t bit;
+
+	if (!(sim_ssp.cr1 & SSP_CR1_SSP_EN)) {
+		sim_Violation("DR written with SSP0 disabled");
+		return;
+	}
+	if (sim_ssp.cr1 & SSP_CR1_SLAVE_EN) {
+		sim_Violation("SSP0 in slave mode");
+	}
+	bit = sim_BitCycles();
+	if (bit == 0) {
+		sim_Violation("SSP0 clock not set");
+		bit = 2;
+	}
+	if (sim_ssp.rxnum == SIM_FIFO_SZ) {
+		sim_Violation("SSP0 receive FIFO overrun");
+		return;
+	}
+	start = (sim_ssp.txfree > sim_now) ? sim_ssp.txfree : sim_now;
+	sim_ssp.txfree = start + 8 * bit;
+	sim_ssp.rx[(sim_ssp.rxhead + sim_ssp.rxnum) % SIM_FIFO_SZ] = sim_CardByte((uint8_t)val, start);
+	sim_ssp.rxdone[(sim_ssp.rxhead + sim_ssp.rxnum) % SIM_FIFO_SZ] = sim_ssp.txfree;
+	sim_ssp.rxnum++;
+}
+
+/*********************************************************************//**
+ * @brief		SR read: the processor would spin until the first byte
+ * 				received is done, or the bus is idle
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_SspWait(void)
+{
+	if (sim_ssp.rxnum != 0) {
+		if (sim_ssp.rxdone[sim_ssp.rxhead] > sim_now) {
+			sim_now = sim_ssp.rxdone[sim_ssp.rxhead];
+		}
+	} else if (sim_ssp.txfree > sim_now) {
+		sim_now = sim_ssp.txfree;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		SR value
+ * @param[in]	None
+ * @return 		SR
+ **********************************************************************/
+static uint32_t sim_SspStatus(void)
+{
+	uint32_t sr = SSP_SR_TNF;
+
+	if (sim_ssp.txfree <= sim_now) {
+		sr |= SSP_SR_TFE;
+	} else {
+		sr |= SSP_SR_BSY;
+	}
+	if ((sim_ssp.rxnum != 0) && (sim_ssp.rxdone[sim_ssp.rxhead] <= sim_now)) {
+		sr |= SSP_SR_RNE;
+	}
+	if (sim_ssp.rxnum == SIM_FIFO_SZ) {
+		sr |= SSP_SR_RFF;
+	}
+	return sr;
+}
+
+/*********************************************************************//**
+ * @brief		End of the GPDMA transfer in flight, once its time has
+ * 				come: channels disabled, terminal count raised
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_DmaUpdate(void)
+{
+	uint32_t n;
+
+	if ((sim_dmabusy == 0) || (sim_now < sim_dmadone)) {
+		return;
+	}
+	for (n = 0; n < SIM_DMA_CH; n++) {
+		if (!(sim_dmabusy & (1UL << n))) {
+			continue;
+		}
+		sim_ch[n].ctrl &= ~0xFFFUL;
+		sim_ch[n].cfg &= ~GPDMA_DMACCxConfig_E;
+		if (sim_ch[n].ctrl & GPDMA_DMACCxControl_I) {
+			sim_tcstat |= 1UL << n;
+		}
+	}
+	sim_dmabusy = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Start a transfer when the SSP0 receive and transmit
+ * 				channels and the SSP0 DMA requests are all enabled
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_DmaCheck(void)
+{
+	SIM_CH_Type *rx = NULL, *tx = NULL;
+	uint32_t n, i, size, bit, mask = 0;
+	uint64_t start;
+	uint8_t *dst;
+	const uint8_t *src;
+
+	if ((sim_dmabusy != 0) || ((sim_ssp.dmacr & SSP_DMA_BITMASK) != SSP_DMA_BITMASK)) {
+		return;
+	}
+	for (n = 0; n < SIM_DMA_CH; n++) {
+		if (!(sim_ch[n].cfg & GPDMA_DMACCxConfig_E)) {
+			continue;
+		}
+		if ((SIM_CFG_TYPE(sim_ch[n].cfg) == GPDMA_TRANSFERTYPE_P2M)
+				&& (SIM_CFG_SRCPER(sim_ch[n].cfg) == GPDMA_CONN_SSP0_Rx)) {
+			rx = &sim_ch[n];
+			mask |= 1UL << n;
+		} else if ((SIM_CFG_TYPE(sim_ch[n].cfg) == GPDMA_TRANSFERTYPE_M2P)
+				&& (((sim_ch[n].cfg >> 6) & 0x1F) == GPDMA_CONN_SSP0_Tx)) {
+			tx = &sim_ch[n];
+			mask |= 1UL << n;
+		}
+	}
+	if ((rx == NULL) || (tx == NULL)) {
+		return;
+	}
+	if (!(sim_dmacfg & GPDMA_DMACConfig_E)) {
+		sim_Violation("GPDMA controller disabled");
+		return;
+	}
+	if ((rx->src != (uint32_t)(uintptr_t)&LPC_SSP0->DR) || (tx->dst != (uint32_t)(uintptr_t)&LPC_SSP0->DR)) {
+		sim_Violation("GPDMA channel not addressing SSP0 DR");
+		return;
+	}
+	if ((rx->lli != 0) || (tx->lli != 0)) {
+		sim_Violation("GPDMA linked transfer to SSP0 not modelled");
+	}
+	size = SIM_CTRL_SIZE(rx->ctrl);
+	if ((size == 0) || (size != SIM_CTRL_SIZE(tx->ctrl))) {
+		sim_Violation("GPDMA receive and transmit sizes differ");
+		return;
+	}
+	if ((SIM_CTRL_WIDTH(rx->ctrl) != 0) || (SIM_CTRL_WIDTH(tx->ctrl) != 0)) {
+		sim_Violation("GPDMA transfer width not byte");
+	}
+	if (sim_ssp.rxnum != 0) {
+		sim_Violation("SSP0 receive FIFO not empty at GPDMA start");
+	}
+	bit = sim_BitCycles();
+	if (bit == 0) {
+		sim_Violation("SSP0 clock not set");
+		bit = 2;
+	}
+
+	// Bytes back to back on the bus
+	start = (sim_ssp.txfree > sim_now) ? sim_ssp.txfree : sim_now;
+	src = (const uint8_t *)(uintptr_t)tx->src;
+	dst = (uint8_t *)(uintptr_t)rx->dst;
+	for (i = 0; i < size; i++) {
+		*dst = sim_CardByte(*src, start + (uint64_t)i * 8 * bit);
+		if (tx->ctrl & GPDMA_DMACCxControl_SI) {
+			src++;
+		}
+		if (rx->ctrl & GPDMA_DMACCxControl_DI) {
+			dst++;
+		}
+	}
+	sim_dmadone = start + (uint64_t)size * 8 * bit;
+	sim_ssp.txfree = sim_dmadone;
+	sim_dmabusy = mask;
+	sim_stats.DmaBlocks++;
+	if (sim_card.crcon && (tx->ctrl & GPDMA_DMACCxControl_SI)) {
+		// CRC16 of the block transmitted, computed meanwhile
+		sim_debt += size * SIM_CRC16_CYCLES;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		GPDMA status read: the processor would spin until the
+ * 				transfer in flight is done
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_DmaWait(void)
+{
+	if ((sim_dmabusy != 0) && (sim_now < sim_dmadone)) {
+		sim_now = sim_dmadone;
+	}
+	sim_DmaUpdate();
+}
+
+/*********************************************************************//**
+ * @brief		Register write
+ * @param[in]	page	Page index
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_Write(uint32_t page, uint32_t ofs, uint32_t val)
+{
+	SIM_CH_Type *ch;
+	uint32_t n, reg;
+
+	if (page == SIM_PAGE_SSP) {
+		if (ofs == SIM_SSP(CR0)) {
+			sim_ssp.cr0 = val & SSP_CR0_BITMASK;
+		} else if (ofs == SIM_SSP(CR1)) {
+			sim_ssp.cr1 = val & SSP_CR1_BITMASK;
+		} else if (ofs == SIM_SSP(DR)) {
+			sim_SspSend(val & 0xFF);
+		} else if (ofs == SIM_SSP(CPSR)) {
+			sim_ssp.cpsr = val & 0xFE;
+		} else if (ofs == SIM_SSP(IMSC)) {
+			sim_ssp.imsc = val & 0x0F;
+		} else if (ofs == SIM_SSP(ICR)) {
+			// No interrupts are raised
+		} else if (ofs == SIM_SSP(DMACR)) {
+			sim_ssp.dmacr = val & SSP_DMA_BITMASK;
+			sim_DmaCheck();
+		} else {
+			sim_Violation("write to a read only SSP0 register");
+		}
+		return;
+	}
+	if (page == SIM_PAGE_GPIO) {
+		n = ofs / sizeof(LPC_GPIO_TypeDef);
+		reg = ofs % sizeof(LPC_GPIO_TypeDef);
+		if (n >= SIM_GPIO_PORTS) {
+			sim_Violation("write to a reserved GPIO address");
+			return;
+		}
+		if (reg == SIM_GPIO(0, FIODIR)) {
+			sim_port[n].dir = val;
+		} else if (reg == SIM_GPIO(0, FIOMASK)) {
+			sim_port[n].mask = val;
+		} else if (reg == SIM_GPIO(0, FIOPIN)) {
+			sim_port[n].pin = (sim_port[n].pin & sim_port[n].mask) | (val & ~sim_port[n].mask);
+		} else if (reg == SIM_GPIO(0, FIOSET)) {
+			sim_port[n].pin |= val & ~sim_port[n].mask;
+		} else if (reg == SIM_GPIO(0, FIOCLR)) {
+			sim_port[n].pin &= ~(val & ~sim_port[n].mask);
+		}
+		sim_CardSelect();
+		return;
+	}
+
+	if (ofs == SIM_DMA(DMACIntTCClear)) {
+		sim_tcstat &= ~(val & 0xFF);
+	} else if (ofs == SIM_DMA(DMACIntErrClr)) {
+		sim_errstat &= ~(val & 0xFF);
+	} else if (ofs == SIM_DMA(DMACConfig)) {
+		sim_dmacfg = val & 0x03;
+	} else if ((ofs == SIM_DMA(DMACSync)) || ((ofs >= SIM_DMA(DMACSoftBReq)) && (ofs <= SIM_DMA(DMACSoftLSReq)))) {
+		// No software requests to SSP0
+	} else if ((ofs >= SIM_DMACH(0, DMACCSrcAddr)) && (ofs < SIM_DMACH(SIM_DMA_CH, DMACCSrcAddr))) {
+		n = (ofs - SIM_DMACH(0, DMACCSrcAddr)) / 0x20;
+		reg = ofs - SIM_DMACH(n, DMACCSrcAddr);
+		ch = &sim_ch[n];
+		if ((reg != offsetof(LPC_GPDMACH_TypeDef, DMACCConfig)) && (ch->cfg & GPDMA_DMACCxConfig_E)) {
+			sim_Violation("GPDMA channel written while enabled");
+		}
+		if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCSrcAddr)) {
+			ch->src = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCDestAddr)) {
+			ch->dst = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCLLI)) {
+			ch->lli = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCControl)) {
+			ch->ctrl = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCConfig)) {
+			ch->cfg = (val & GPDMA_DMACCxConfig_BITMASK) & ~GPDMA_DMACCxConfig_A;
+			if (!(ch->cfg & GPDMA_DMACCxConfig_E)) {
+				// Disabled in flight: the transfer is over for it
+				sim_dmabusy &= ~(1UL << n);
+			}
+			sim_DmaCheck();
+		}
+	} else {
+		sim_Violation("write to a read only GPDMA register");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Refresh the readable values of a page
+ * @param[in]	page	Page index
+ * @return 		None
+ **********************************************************************/
+static void sim_Publish(uint32_t page)
+{
+	uint32_t n, enabled;
+
+	memset((void *)sim_base[page], 0, SIM_PAGE_SZ);
+	if (page == SIM_PAGE_SSP) {
+		*sim_Reg(page, SIM_SSP(CR0)) = sim_ssp.cr0;
+		*sim_Reg(page, SIM_SSP(CR1)) = sim_ssp.cr1;
+		*sim_Reg(page, SIM_SSP(DR)) = sim_ssp.dr;
+		*sim_Reg(page, SIM_SSP(SR)) = sim_SspStatus();
+		*sim_Reg(page, SIM_SSP(CPSR)) = sim_ssp.cpsr;
+		*sim_Reg(page, SIM_SSP(IMSC)) = sim_ssp.imsc;
+		*sim_Reg(page, SIM_SSP(DMACR)) = sim_ssp.dmacr;
+	} else if (page == SIM_PAGE_GPIO) {
+		for (n = 0; n < SIM_GPIO_PORTS; n++) {
+			*sim_Reg(page, SIM_GPIO(n, FIODIR)) = sim_port[n].dir;
+			*sim_Reg(page, SIM_GPIO(n, FIOMASK)) = sim_port[n].mask;
+			*sim_Reg(page, SIM_GPIO(n, FIOPIN)) = sim_port[n].pin & ~sim_port[n].mask;
+			*sim_Reg(page, SIM_GPIO(n, FIOSET)) = sim_port[n].pin & ~sim_port[n].mask;
+		}
+	} else {
+		enabled = 0;
+		for (n = 0; n < SIM_DMA_CH; n++) {
+			if (sim_ch[n].cfg & GPDMA_DMACCxConfig_E) {
+				enabled |= 1UL << n;
+			}
+			*sim_Reg(page, SIM_DMACH(n, DMACCSrcAddr)) = sim_ch[n].src;
+			*sim_Reg(page, SIM_DMACH(n, DMACCDestAddr)) = sim_ch[n].dst;
+			*sim_Reg(page, SIM_DMACH(n, DMACCLLI)) = sim_ch[n].lli;
+			*sim_Reg(page, SIM_DMACH(n, DMACCControl)) = sim_ch[n].ctrl;
+			*sim_Reg(page, SIM_DMACH(n, DMACCConfig)) = sim_ch[n].cfg
+					| (((sim_dmabusy >> n) & 1) ? GPDMA_DMACCxConfig_A : 0);
+		}
+		*sim_Reg(page, SIM_DMA(DMACIntStat)) = sim_tcstat | sim_errstat;
+		*sim_Reg(page, SIM_DMA(DMACIntTCStat)) = sim_tcstat;
+		*sim_Reg(page, SIM_DMA(DMACIntErrStat)) = sim_errstat;
+		*sim_Reg(page, SIM_DMA(DMACRawIntTCStat)) = sim_tcstat;
+		*sim_Reg(page, SIM_DMA(DMACRawIntErrStat)) = sim_errstat;
+		*sim_Reg(page, SIM_DMA(DMACEnbldChns)) = enabled;
+		*sim_Reg(page, SIM_DMA(DMACConfig)) = sim_dmacfg;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register page fault: prepare the access, single-step it
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Fault(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uintptr_t adr = (uintptr_t)si->si_addr;
+	uint32_t page;
+
+	(void)sig;
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		if ((adr >= sim_base[page]) && (adr < sim_base[page] + SIM_PAGE_SZ)) {
+			break;
+		}
+	}
+	if ((page == SIM_PAGE_NUM) || sim_inhandler) {
+		signal(SIGSEGV, SIG_DFL);				/* Real fault: faults again */
+		return;
+	}
+	sim_inhandler = 1;
+	sim_page = page;
+	mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE);
+	sim_ofs = (uint32_t)(adr - sim_base[page]);
+	sim_write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_ERR_WRITE) != 0;
+	if (sim_ofs & 3) {
+		sim_Violation("unaligned register access");
+	}
+	sim_ofs &= ~3UL;
+	sim_stats.Accesses++;
+	sim_now += SDSIM_ACCESS_CYCLES + sim_debt;
+	sim_debt = 0;
+	sim_DmaUpdate();
+	if (!sim_write && (page == SIM_PAGE_SSP)) {
+		if (sim_ofs == SIM_SSP(SR)) {
+			sim_SspWait();
+		} else if (sim_ofs == SIM_SSP(DR)) {
+			if ((sim_ssp.rxnum != 0) && (sim_ssp.rxdone[sim_ssp.rxhead] <= sim_now)) {
+				sim_ssp.dr = sim_ssp.rx[sim_ssp.rxhead];
+				sim_ssp.rxhead = (sim_ssp.rxhead + 1) % SIM_FIFO_SZ;
+				sim_ssp.rxnum--;
+			} else {
+				sim_Violation("DR read with the receive FIFO empty");
+			}
+		}
+	} else if (!sim_write && (page == SIM_PAGE_DMA) && (sim_ofs <= SIM_DMA(DMACEnbldChns))) {
+		sim_DmaWait();
+	}
+	sim_Publish(page);
+	sim_before = *sim_Reg(page, sim_ofs);
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Single step: apply a register access that is done
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Step(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uint32_t val, page;
+
+	(void)sig;
+	(void)si;
+	if (sim_inhandler) {
+		page = sim_page;
+		val = *sim_Reg(page, sim_ofs);
+		/* Read-modify-write instructions may fault as a read */
+		if (sim_write || (val != sim_before)) {
+			sim_Write(page, sim_ofs, val);
+		}
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+		sim_inhandler = 0;
+	}
+	uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Build the CSD and CID registers of the card
+ * @param[in]	c		Card
+ * @return 		None
+ **********************************************************************/
+static void sim_Registers(SIM_CARD_Type *c)
+{
+	static const uint8_t cid[15] = {
+		0x1B, 'S', 'M', 'L', 'P', 'C', 'S', 'D', 0x10, 0x12, 0x34, 0x56, 0x78, 0x00, 0xB3
+	};
+	uint32_t csize, unit;
+
+	memset(c->csd, 0, sizeof(c->csd));
+	c->csd[1] = 0x0E;						// TAAC 1ms
+	c->csd[3] = c->cfg.TranSpeed;
+	c->csd[4] = 0x5B;						// CCC
+	c->csd[5] = 0x59;						// CCC, READ_BL_LEN 512
+	if (c->cfg.Type == SDSIM_SDHC) {
+		csize = c->cfg.Blocks / 1024 - 1;
+		c->csd[0] = 0x40;
+		c->csd[7] = (uint8_t)((csize >> 16) & 0x3F);
+		c->csd[8] = (uint8_t)(csize >> 8);
+		c->csd[9] = (uint8_t)csize;
+		c->csd[10] = 0x7F;
+		c->csd[11] = 0x80;
+	} else {
+		// C_SIZE_MULT 7: (C_SIZE + 1) * 512 blocks
+		csize = c->cfg.Blocks / 512 - 1;
+		c->csd[6] = 0x80 | (uint8_t)((csize >> 10) & 0x03);
+		c->csd[7] = (uint8_t)(csize >> 2);
+		c->csd[8] = (uint8_t)((csize & 0x03) << 6) | 0x2D;
+		c->csd[9] = 0xB7;
+		c->csd[10] = 0xBF;
+		c->csd[11] = 0x80;
+	}
+	c->csd[12] = 0x0A;
+	c->csd[13] = 0x40;
+	c->csd[15] = (uint8_t)((sim_Crc7(c->csd, 15) << 1) | 1);
+	memcpy(c->cid, cid, sizeof(cid));
+	c->cid[15] = (uint8_t)((sim_Crc7(c->cid, 15) << 1) | 1);
+
+	unit = 100000;
+	for (csize = c->cfg.TranSpeed & 0x07; csize != 0; csize--) {
+		unit *= 10;
+	}
+	c->maxrate = sim_TranValue[(c->cfg.TranSpeed >> 3) & 0x0F] * (unit / 10);
+}
+
+/* Public Functions ----------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Map the register pages and install the access traps
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SDSIM_Init(void)
+{
+	struct sigaction sa;
+	uint32_t page;
+	void *p;
+
+	for (page = 0; page <= SIM_PAGE_NUM; page++) {
+		p = mmap((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (p != (void *)sim_base[page]) {
+			fprintf(stderr, "sdsim: cannot map 0x%08lX\n", (unsigned long)sim_base[page]);
+			exit(2);
+		}
+		if (page < SIM_PAGE_NUM) {
+			sim_Publish(page);
+			mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+		}
+	}
+	sim_tag = calloc(SIM_STORE_NUM, sizeof(uint32_t));
+	sim_data = malloc((size_t)SIM_STORE_NUM * SDSIM_BLOCK_BYTES);
+	if ((sim_tag == NULL) || (sim_data == NULL)) {
+		fprintf(stderr, "sdsim: out of memory\n");
+		exit(2);
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sim_Fault;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = sim_Step;
+	sigaction(SIGTRAP, &sa, NULL);
+}
+
+/*********************************************************************//**
+ * @brief		Power up a card: SSP0, GPDMA and GPIO are reset, the
+ * 				card is in SD mode with the given content cleared, the
+ * 				counters restart. The time goes on.
+ * @param[in]	card	Card parameters
+ * @param[in]	port	GPIO port of chip select
+ * @param[in]	pin		GPIO pin of chip select
+ * @return 		None
+ **********************************************************************/
+void SDSIM_Card(const SDSIM_CARD_Type *card, uint8_t port, uint8_t pin)
+{
+	uint32_t page;
+
+	memset(&sim_ssp, 0, sizeof(sim_ssp));
+	memset(sim_ch, 0, sizeof(sim_ch));
+	memset(sim_port, 0, sizeof(sim_port));
+	memset(&sim_card, 0, sizeof(sim_card));
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	memset(sim_tag, 0, SIM_STORE_NUM * sizeof(uint32_t));
+	sim_violation[0] = '\0';
+	sim_dmacfg = 0;
+	sim_tcstat = 0;
+	sim_errstat = 0;
+	sim_dmabusy = 0;
+	sim_debt = 0;
+	sim_card.cfg = *card;
+	sim_card.port = port;
+	sim_card.pin = pin;
+	sim_Registers(&sim_card);
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE);
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Inject an error into the next data block
+ * @param[in]	error	SDSIM_INJECT_READ_CRC or SDSIM_INJECT_WRITE_CRC
+ * @return 		None
+ **********************************************************************/
+void SDSIM_Inject(uint32_t error)
+{
+	sim_card.inject = error;
+}
+
+/*********************************************************************//**
+ * @brief		Content of a card block, as the card holds it
+ * @param[in]	lba		Block
+ * @param[out]	data	SDSIM_BLOCK_BYTES bytes
+ * @return 		None
+ **********************************************************************/
+void SDSIM_Block(uint32_t lba, uint8_t *data)
+{
+	sim_BlockData(lba, data);
+}
+
+/*********************************************************************//**
+ * @brief		Card identification register
+ * @param[in]	None
+ * @return 		16 bytes, the CRC7 included
+ **********************************************************************/
+const uint8_t *SDSIM_Cid(void)
+{
+	return sim_card.cid;
+}
+
+/*********************************************************************//**
+ * @brief		CRC checking of the card, set by CMD59
+ * @param[in]	None
+ * @return 		Non zero if on
+ **********************************************************************/
+uint32_t SDSIM_CrcOn(void)
+{
+	return sim_card.crcon;
+}
+
+/*********************************************************************//**
+ * @brief		SCK rate of SSP0
+ * @param[in]	None
+ * @return 		Rate (Hz), 0 if the clock is not set
+ **********************************************************************/
+uint32_t SDSIM_SckRate(void)
+{
+	uint32_t bit = sim_BitCycles();
+
+	return (bit != 0) ? (SDSIM_CCLK / bit) : 0;
+}
+
+/*********************************************************************//**
+ * @brief		Current time
+ * @param[in]	None
+ * @return 		Core cycles
+ **********************************************************************/
+uint64_t SDSIM_Now(void)
+{
+	return sim_now;
+}
+
+/*********************************************************************//**
+ * @brief		Get the model counters
+ * @param[out]	stats	Counters
+ * @return 		None
+ **********************************************************************/
+void SDSIM_GetStats(SDSIM_STATS_Type *stats)
+{
+	*stats = sim_stats;
+}
+
+/*********************************************************************//**
+ * @brief		First programming or protocol error seen by the model
+ * @param[in]	None
+ * @return 		Description, empty if none
+ **********************************************************************/
+const char *SDSIM_Violation(void)
+{
+	return sim_violation;
+}
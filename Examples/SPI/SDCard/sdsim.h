@@ -0,0 +1,94 @@
+/**********************************************************************
+* $Id$		sdsim.h				2011-03-09
+*//**
+* @file		sdsim.h
+* @brief	Host model of an SD card on SSP0 in SPI mode: the SSP0
+* 			controller, the GPDMA channels that serve it, the GPIO chip
+* 			select and the card command, token and busy protocol. Time
+* 			is counted in core clock cycles
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __SDSIM_H
+#define __SDSIM_H
+
+#include <stdint.h>
+
+/** Core clock */
+#define SDSIM_CCLK			100000000UL
+/** Processor cycles of a register access and of the code around it */
+#define SDSIM_ACCESS_CYCLES	10
+/** Data block size (bytes) */
+#define SDSIM_BLOCK_BYTES	512
+
+/** Card types */
+#define SDSIM_SDV1			1		/**< SD 1.x, no CMD8, byte addressing */
+#define SDSIM_SDV2			2		/**< SD 2.0 standard capacity */
+#define SDSIM_SDHC			3		/**< SDHC, CSD 2.0, block addressing */
+
+/** Injected errors, see SDSIM_Inject() */
+#define SDSIM_INJECT_READ_CRC	1	/**< Wrong CRC16 after the next block read */
+#define SDSIM_INJECT_WRITE_CRC	2	/**< Next block written is answered with a CRC error */
+
+/**
+ * @brief Card parameters, times in microseconds
+ */
+typedef struct {
+	uint8_t Type;			/**< SDSIM_SDV1, SDSIM_SDV2 or SDSIM_SDHC */
+	uint8_t TranSpeed;		/**< CSD TRAN_SPEED, e.g. 0x32: 25Mbit/s */
+	uint16_t InitRetries;	/**< ACMD41 answered idle before ready */
+	uint32_t Blocks;		/**< Capacity, multiple of 512 (1024 for SDHC) */
+	uint32_t ReadLatency;	/**< CMD17/CMD18 to the first data token */
+	uint32_t ReadGap;		/**< CMD18: end of a block to the next token */
+	uint32_t WriteBusy;		/**< CMD24 block programming */
+	uint32_t MultiBusy;		/**< CMD25 block programming */
+	uint32_t ErasedBusy;	/**< CMD25 block programming, pre-erased by ACMD23 */
+	uint32_t StopBusy;		/**< After the stop token or CMD12 */
+} SDSIM_CARD_Type;
+
+/**
+ * @brief Model counters
+ */
+typedef struct {
+	uint32_t Accesses;		/**< Register accesses of the driver */
+	uint32_t Violations;	/**< Programming or protocol errors seen by the model */
+	uint32_t Cmd[64];		/**< Commands received, by index */
+	uint32_t Acmd[64];		/**< Application commands received, by index */
+	uint32_t CmdCrcErrors;	/**< Commands with a wrong CRC7 */
+	uint32_t DataCrcErrors;	/**< Blocks written with a wrong CRC16, CRC on */
+	uint32_t BlocksRead;	/**< Data blocks sent by the card */
+	uint32_t BlocksWritten;	/**< Data blocks programmed */
+	uint32_t PreErased;		/**< Of them pre-erased by ACMD23 */
+	uint32_t StopTokens;	/**< CMD25 ended by the stop token */
+	uint32_t DmaBlocks;		/**< Transfers moved by GPDMA */
+	uint64_t SpiBytes;		/**< Bytes exchanged on the bus */
+} SDSIM_STATS_Type;
+
+void SDSIM_Init(void);
+void SDSIM_Card(const SDSIM_CARD_Type *card, uint8_t port, uint8_t pin);
+void SDSIM_Inject(uint32_t error);
+void SDSIM_Block(uint32_t lba, uint8_t *data);
+const uint8_t *SDSIM_Cid(void);
+uint32_t SDSIM_CrcOn(void);
+uint32_t SDSIM_SckRate(void);
+uint64_t SDSIM_Now(void);
+void SDSIM_GetStats(SDSIM_STATS_Type *stats);
+const char *SDSIM_Violation(void);
+
+#endif /* __SDSIM_H */
@@ -2,7 +2,9 @@
 * $Id$		spi_sdcard.c					2010-07-16
 *//**
 * @file		spi_sdcard.c
-* @brief	This example describes how to use SPI to read SD card's CID register
+* @brief	This example describes how to use the SD card driver on SSP0
+* 			(multiple block GPDMA transfers) to read the card's CID register
+* 			and measure its throughput
 * @version	1.0
 * @date		16. July. 2010
 * @author	NXP MCU SW Application Team
@@ -22,7 +24,9 @@
 * warranty that such application will be suitable for the specified
 * use without further testing or modification.
 **********************************************************************/
-#include "lpc17xx_spi.h"
+#include "lpc17xx_sdcard.h"
+#include "lpc17xx_fat.h"
+#include "lpc17xx_gpdma.h"
 #include "lpc17xx_libcfg.h"
 #include "lpc17xx_pinsel.h"
 #include "debug_frmwrk.h"
@@ -42,139 +46,73 @@
 
 #define SD_DETECT_PORTNUM	4
 #define SD_DETECT_PINNUM	29
-typedef enum _sd_connect_status
-{
-	SD_CONNECTED,
-	SD_DISCONNECTED
-}sd_connect_status;
-typedef enum _sd_error
-{
-	SD_OK,
-	SD_NG,
-	SD_CMD_BAD_PARAMETER,
-	SD_ERROR_TOKEN,
-	SD_ERROR_TIMEOUT,
-	SD_ERROR_BUS_NOT_IDLE,
-	SD_ERROR_CMD0,
-	SD_ERROR_CMD55,
-	SD_ERROR_ACMD41,
-	SD_ERROR_CMD59
-}sd_error;
 
-//SD command code
-#define 	CMD0_GO_IDLE_STATE            0x00
-#define		CMD1_SEND_OPCOND              0x01
-#define 	CMD9_SEND_CSD                 0x09
-#define 	CMD10_SEND_CID                0x0a
-#define  	CMD12_STOP_TRANSMISSION       0x0b
-#define 	CMD13_SEND_STATUS             0x0c
-#define 	CMD16_SET_BLOCKLEN            0x10
-#define 	CMD17_READ_SINGLE_BLOCK       0x11
-#define 	CMD18_READ_MULTIPLE_BLOCK     0x12
-#define 	CMD24_WRITE_BLOCK             0x18
-#define 	CMD25_WRITE_MULTIPLE_BLOCK    0x19
-#define 	CMD27_PROGRAM_CSD             0x1b
-#define 	CMD28_SET_WRITE_PROT          0x1c
-#define 	CMD29_CLR_WRITE_PROT          0x1d
-#define 	CMD30_SEND_WRITE_PROT         0x1e
-#define 	CMD32_ERASE_WR_BLK_START_ADDR 0x20
-#define 	CMD33_ERASE_WR_BLK_END_ADDR   0x21
-#define 	CMD38_ERASE                   0x26
-#define 	CMD55_APP_CMD                 0x37
-#define 	CMD56_GEN_CMD                 0x38
-#define 	CMD58_READ_OCR                0x3a
-#define 	CMD59_CRC_ON_OFF              0x3b
-/* Application-specific commands (always prefixed with CMD55_APP_CMD) */
-#define	 	ACMD13_SD_STATUS              0x0d
-#define 	ACMD22_SEND_NUM_WR_BLOCKS     0x16
-#define 	ACMD23_SET_WR_BLK_ERASE_COUNT 0x17
-#define 	ACMD41_SEND_OP_COND           0x29
-#define 	ACMD42_SET_CLR_CARD_DETECT    0x2a
-#define 	ACMD51_SEND_SCR               0x33
-/* R1 format responses (ORed together as a bit-field) */
-#define 	R1_NOERROR   				  0x00
-#define 	R1_IDLE      				  0x01
-#define 	R1_ERASE     				  0x02
-#define 	R1_ILLEGAL   				  0x04
-#define 	R1_CRC_ERR   				  0x08
-#define 	R1_ERASE_SEQ 				  0x10
-#define 	R1_ADDR_ERR  				  0x20
-#define 	R1_PARAM_ERR 				  0x40
-/* R2 format responses - second byte only, first is identical to R1 */
-#define 	R2_LOCKED      				  0x01
-#define 	R2_WP_FAILED   				  0x02
-#define 	R2_ERROR       				  0x04
-#define 	R2_CTRL_ERR    				  0x08
-#define 	R2_ECC_FAIL    				  0x10
-#define 	R2_WP_VIOL     				  0x20
-#define 	R2_ERASE_PARAM 				  0x40
-#define 	R2_RANGE_ERR   				  0x80
+/* SPI clock after initialization, lowered to the card transfer rate */
+#define SD_CLOCK_RATE		25000000
+/* GPDMA channels to and from SSP0 */
+#define SD_DMA_TX			0
+#define SD_DMA_RX			1
+
+/* Blocks per request and blocks per throughput test (1MB) */
+#define TEST_REQ_BLOCKS		32
+#define TEST_BLOCKS			2048
+/* Set to 1 to run the write test: it OVERWRITES the last TEST_BLOCKS
+ * blocks of the card */
+#define TEST_WRITE			0
+/* Set to 1 to run the logging test: SDLOG.TXT is created (or truncated) in
+ * the root directory of the FAT16/FAT32 volume of the card */
+#define TEST_FAT			1
+/* Size of the log written by the logging test, preallocated (1MB) */
+#define TEST_LOG_SIZE		(TEST_BLOCKS * SDC_BLOCK_SIZE)
 
-#define GETBIT(in, bit) ((in & (1<<bit)) >> bit)
-#define SD_CMD_BLOCK_LENGTH		6
-#define SD_DATA_BLOCK_LENGTH	515
-#define SD_WAIT_R1_TIMEOUT		100000
 /************************** PRIVATE VARIABLES *************************/
 uint8_t menu1[] =
 "********************************************************************************\n\r"
 "Hello NXP Semiconductors \n\r"
-"SPI communicate with SD card demo \n\r"
+"SD card streaming demo \n\r"
 "\t - MCU: LPC17xx \n\r"
 "\t - Core: ARM Cortex-M3 \n\r"
 "\t - Communicate via: UART0 - 115200bps \n\r"
-" Demo SPI module, read SD card's CID register and display via UART0\n\r"
+" Initialize the SD card on SSP0, display its CID register and measure\n\r"
+" the multiple block read (and write) throughput and the rate of appends\n\r"
+" to a log file via UART0\n\r"
 "********************************************************************************\n\r";
-// SPI Configuration structure variable
-SPI_CFG_Type SPI_ConfigStruct;
-// SPI Data Setup structure variable
-SPI_DATA_SETUP_Type xferConfig;
 
-uint8_t sd_cmd_buf[SD_CMD_BLOCK_LENGTH];
-uint8_t sd_data_buf[SD_DATA_BLOCK_LENGTH];
+/* SD card on SSP0 with GPDMA */
+SDC_Type SD_Card;
+#if TEST_FAT
+/* File system of the card and log file */
+FAT_VOLUME_Type SD_Volume;
+FAT_FILE_Type SD_Log;
+#endif
+/* Test buffer, one request */
+uint8_t sd_data_buf[TEST_REQ_BLOCKS * SDC_BLOCK_SIZE];
+/* SysTick Counter (ms) */
+volatile uint32_t SysTickCnt;
+
 /************************** PRIVATE FUNCTIONS *************************/
-void CS_Init(void);
-void CS_Force(int32_t state);
+void SysTick_Handler(void);
 void print_menu(void);
-sd_connect_status SD_GetCardConnectStatus(void);
-uint8_t crc_7(uint8_t old_crc, uint8_t data);
-uint8_t crc_7final(uint8_t old_crc);
-uint32_t SD_SendReceiveData_Polling(void* tx_buf, void* rx_buf, uint32_t length);
-void SD_SendCommand(uint8_t cmd, uint8_t *arg);
-sd_error SD_WaitR1(uint8_t *buffer, uint32_t length, uint32_t timeout);
-sd_error SD_WaitDeviceIdle(uint32_t num_char);
-sd_error SD_Init(uint8_t retries);
-sd_error SD_GetCID(void);
-/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
-
-/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+void print_rate(uint32_t blocks, uint32_t ms);
+void print_cid(void);
+Bool SD_CardConnected(void);
+Status SD_Throughput(Bool write, uint32_t lba);
+#if TEST_FAT
+Status SD_LogThroughput(void);
+#endif
 
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
 /*********************************************************************//**
- * @brief 		Initialize CS pin as GPIO function to drive /CS pin
- * 				due to definition of CS_PORT_NUM and CS_PORT_NUM
- * @param		None
- * @return		None
- ***********************************************************************/
-void CS_Init(void)
-{
-	GPIO_SetDir(CS_PORT_NUM, (1<<CS_PIN_NUM), 1);
-	GPIO_SetValue(CS_PORT_NUM, (1<<CS_PIN_NUM));
-}
-/*********************************************************************//**
- * @brief 		Drive CS output pin to low/high level to select slave device
- * 				via /CS pin state
- * @param[in]	state State of CS output pin that will be driven:
- * 				- 0: Drive CS pin to low level
- * 				- 1: Drive CS pin to high level
- * @return		None
- ***********************************************************************/
-void CS_Force(int32_t state)
+ * @brief		SysTick handler sub-routine (1ms)
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SysTick_Handler(void)
 {
-	if (state){
-		GPIO_SetValue(CS_PORT_NUM, (1<<CS_PIN_NUM));
-	}else{
-		GPIO_ClearValue(CS_PORT_NUM, (1<<CS_PIN_NUM));
-	}
+	SysTickCnt++;
 }
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
 /*********************************************************************//**
  * @brief		Print Welcome menu
  * @param[in]	none
@@ -185,279 +123,137 @@ void print_menu(void)
 	_DBG(menu1);
 }
 /*********************************************************************//**
- * @brief		check if SD card is inserted or not
- * @param[in]	none
- * @return 		SD_CONNECTED or SD_DISCONNECTED
- **********************************************************************/
-sd_connect_status SD_GetCardConnectStatus(void)
-{
-	sd_connect_status ret=SD_DISCONNECTED;
-
-	if((GPIO_ReadValue(SD_DETECT_PORTNUM)&(1<<SD_DETECT_PINNUM))== 0)
-		ret = SD_CONNECTED;
-
-	return ret;
-}
-/*********************************************************************//**
- * @brief		Calculate CRC-7 as required by SD specification
- * @param[in]	- old_crc: 0x00 to start new CRC
- * 			    or value from previous call to continue.
- * 				- data: data byte to add to CRC computation
- * @return 		CRC-7 checksum which MUST be augmented by crc_7augment() before used
- **********************************************************************/
-uint8_t crc_7(uint8_t old_crc, uint8_t data)
-{
-  uint8_t new_crc,x;
-
-  new_crc = old_crc;
-  for (x = 7; x >= 0; x--) {
-    new_crc <<= 1;
-    new_crc |= GETBIT(data,x);
-    if (GETBIT(new_crc, 7) == 1) {
-      new_crc ^= 0x89; /*CRC-7's polynomial is x^7 + x^3 + 1*/
-    }
-    if(x==0) break;
-  }
-  return new_crc;
-}
-/*********************************************************************//**
- * @brief		Provides the zero-padding final step to CRC-7
- * @param[in]	- old_crc: value from last crc_7()call
- * @return 		Finalized CRC-7 checksum
+ * @brief		Print a transfer rate
+ * @param[in]	blocks	Number of blocks transferred
+ * @param[in]	ms		Duration (ms)
+ * @return 		None
  **********************************************************************/
-uint8_t crc_7final(uint8_t old_crc)
+void print_rate(uint32_t blocks, uint32_t ms)
 {
-  uint8_t new_crc,x;
-
-  new_crc = old_crc;
-  for (x = 0; x < 7; x++) {
-    new_crc <<= 1;
-    if (GETBIT(new_crc, 7) == 1) {
-      new_crc ^= 0x89; /*CRC-7's polynomial is x^7 + x^3 + 1*/
-    }
-  }
-  return new_crc;
+	if (ms == 0) ms = 1;
+	_DBD32(blocks / 2); _DBG("KB in "); _DBD32(ms); _DBG("ms: ");
+	// 512 bytes per block: bytes / ms = KB/s (1000 bytes)
+	_DBD32((blocks * SDC_BLOCK_SIZE) / ms); _DBG("KB/s\n\r");
 }
 /*********************************************************************//**
- * @brief		Send/receive data over SPI bus
- * @param[in]	- tx_buf: pointer to transmit buffer.
- * 					      NULL if send 0xFF.
- * 				- rx_buf: pointer to receive buffer
- * 						  NULL if nothing to receive.
- * 			    - length: number of data to send or receive
- * @return 		the actual data sent or received.
+ * @brief		Decode and print the CID register read by SDC_Init()
+ * @param[in]	none
+ * @return 		None
  **********************************************************************/
-uint32_t SD_SendReceiveData_Polling(void* tx_buf, void* rx_buf, uint32_t length)
+void print_cid(void)
 {
-	//uint16_t i;
-
-	CS_Force(0);
-	//for(i=0;i<1000;i++);
-
-	xferConfig.tx_data = tx_buf;
-	xferConfig.rx_data = rx_buf;
-	xferConfig.length = length;
-	SPI_ReadWrite(LPC_SPI, &xferConfig, SPI_TRANSFER_POLLING);
-
-	//for(i=0;i<1000;i++);
-	CS_Force(1);
-	return xferConfig.counter;
+	uint8_t i;
+	uint8_t *cid = SD_Card.CID;
+
+	_DBG("\n\rManufacture ID: ");_DBH(cid[0]);
+	_DBG("\n\rApplication ID: ");_DBC(cid[1]);_DBC(cid[2]);
+	_DBG("\n\rProduct name: ");
+		for(i=3;i<8;i++) _DBC(cid[i]);
+	_DBG("\n\rProduct revision: ");
+		_DBD(cid[8] >> 4);
+		_DBG(".");
+		_DBD(cid[8] & 0x0F);
+	_DBG("\n\rProduct serial number: ");
+		_DBH32(((uint32_t)cid[9] << 24) | ((uint32_t)cid[10] << 16)
+				| ((uint32_t)cid[11] << 8) | cid[12]);
+	_DBG("\n\rManufacturing date: ");
+		_DBD(cid[14] & 0x0F);
+		_DBG("/");
+		_DBD32(2000 + (((cid[13] & 0x0F) << 4) | (cid[14] >> 4)));
+	_DBG("\n\r");
 }
 /*********************************************************************//**
- * @brief		Send command to SD card
- * @param[in]	- cmd: SD command code
- * 			    - arg: pointer to array of 4x8 bytes, argument of command
- * @return 		n/a
+ * @brief		check if SD card is inserted or not
+ * @param[in]	none
+ * @return 		TRUE if a card is inserted
  **********************************************************************/
-void SD_SendCommand(uint8_t cmd, uint8_t *arg)
+Bool SD_CardConnected(void)
 {
-	uint8_t crc = 0x00;
-
-	/* First byte has framing bits and command */
-	sd_cmd_buf[0] = 0x40 | (cmd & 0x3f);
-	sd_cmd_buf[1] = arg[0];
-	sd_cmd_buf[2] = arg[1];
-	sd_cmd_buf[3] = arg[2];
-	sd_cmd_buf[4] = arg[3];
-	//calculate CRC
-	crc = crc_7(crc, sd_cmd_buf[0]);//start new crc-7
-	crc = crc_7(crc, sd_cmd_buf[1]);
-	crc = crc_7(crc, sd_cmd_buf[2]);
-	crc = crc_7(crc, sd_cmd_buf[3]);
-	crc = crc_7(crc, sd_cmd_buf[4]);
-	crc = crc_7final(crc);
-	sd_cmd_buf[5] = (crc << 1) | 0x01;//stop bit
-
-	SD_SendReceiveData_Polling(sd_cmd_buf,NULL,SD_CMD_BLOCK_LENGTH);
+	return ((GPIO_ReadValue(SD_DETECT_PORTNUM) & (1<<SD_DETECT_PINNUM)) == 0) ? TRUE : FALSE;
 }
 /*********************************************************************//**
- * @brief		Wait for SD card R1 response
- * @param[in]	- buffer: pointer to receive buffer
- * 			    - length: length of receive data, must equal 1+actual length of data
- * 					      length = 0 if receive R1 only
- * 				- timeout: timeout for retry
- * @return 		error code
+ * @brief		Read or write TEST_BLOCKS blocks from lba, TEST_REQ_BLOCKS
+ * 				blocks per request, and print the throughput. The GPDMA
+ * 				interrupt is not used: the synchronous BLK_Read()/
+ * 				BLK_Write() poll the driver.
+ * @param[in]	write	TRUE to write (test pattern), FALSE to read
+ * @param[in]	lba		First block
+ * @return 		SUCCESS or ERROR
  **********************************************************************/
-sd_error SD_WaitR1(uint8_t *buffer, uint32_t length, uint32_t timeout)
+Status SD_Throughput(Bool write, uint32_t lba)
 {
-    uint32_t j;
-	uint8_t dummy[2];
-	uint8_t wait_idle;
-
-	/* No null pointers allowed */
-	if (buffer == NULL)	return SD_CMD_BAD_PARAMETER;
-
-	/* Wait for start bit on R1 */
-	j=0;dummy[0]=0xFF;
-	while (GETBIT(dummy[0],7) == 1)
-	{
-		if (j>timeout)return SD_ERROR_TIMEOUT;
-		dummy[0]=0x00;
-		SD_SendReceiveData_Polling(NULL,dummy,1);
-		j++;
-	}
-	*buffer=dummy[0];//store R1
-	if (length > 0)//read followed data
-	{
-		/* Wait for start token on data portion, if any */
-		dummy[0] = 0xff;j = 0;
-		while (dummy[0] != 0xfe)
-		{
-			if (j > timeout)return SD_ERROR_TIMEOUT;
-			dummy[0]=0x00;
-			SD_SendReceiveData_Polling(NULL,dummy,1);
-			if ((dummy[0] != 0xff) && (dummy[0] != 0xfe)) // not idle or start token?
-			{
-				return SD_ERROR_TOKEN;
+	uint32_t i, n, start;
+	Status status = SUCCESS;
+
+	start = SysTickCnt;
+	for (n = 0; (n < TEST_BLOCKS) && (status == SUCCESS); n += TEST_REQ_BLOCKS) {
+		if (write) {
+			for (i = 0; i < sizeof(sd_data_buf); i++) {
+				sd_data_buf[i] = (uint8_t)(lba + n + i);
 			}
-			j++;
+			status = BLK_Write(&SD_Card.dev, lba + n, sd_data_buf, TEST_REQ_BLOCKS);
+		} else {
+			status = BLK_Read(&SD_Card.dev, lba + n, sd_data_buf, TEST_REQ_BLOCKS);
 		}
-		/* Read all bytes */
-		SD_SendReceiveData_Polling(NULL,(buffer+1),(length - 1));
 	}
-	/* Some more bit clocks to finish internal SD operations */
-	dummy[0]=0x00;wait_idle=0;
-	while((dummy[0]!=0xff)&&(wait_idle<20))
-	{
-		dummy[0]=0x00;
-		SD_SendReceiveData_Polling(NULL,dummy,1);
-		for(j=0;j<1000;j++);
-		wait_idle++;
+	if (status == SUCCESS) {
+		print_rate(TEST_BLOCKS, SysTickCnt - start);
 	}
-	if(wait_idle>=20) return SD_ERROR_BUS_NOT_IDLE;
-	return SD_OK;
+	return status;
 }
+#if TEST_FAT
 /*********************************************************************//**
- * @brief		Wait for SD card idle
- * @param[in]	- num_char: number characters (8 bits clock) to wait
- * @return 		device already in idle state or need more time
+ * @brief		Append TEST_LOG_SIZE bytes of text lines to SDLOG.TXT,
+ * 				TEST_REQ_BLOCKS blocks per write, and print the rate. The
+ * 				log is preallocated as contiguous clusters: the appends go
+ * 				to the card as multiple block writes, the FAT and the
+ * 				directory entry are only written by FAT_Close().
+ * @param[in]	None
+ * @return 		SUCCESS or ERROR
  **********************************************************************/
-sd_error SD_WaitDeviceIdle(uint32_t num_char)
+Status SD_LogThroughput(void)
 {
-	uint8_t dummy[2]={0,0};
-	uint32_t i=0;
+	uint32_t i, d, n, line, start;
 
-	while ((i < num_char) && (dummy[0] != 0xff))
-	{
-		dummy[0]=0x00;
-		SD_SendReceiveData_Polling(NULL,dummy,1);
-		if (dummy[0] == 0xff)
-		{
-			dummy[0]= 0x00;
-			SD_SendReceiveData_Polling(NULL,dummy,1);
-			if (dummy[0] == 0xff)
-			{
-				dummy[0]= 0x00;
-				SD_SendReceiveData_Polling(NULL,dummy,1);
-			}
-		}
-		i++;
+	SD_Volume.Dev = &SD_Card.dev;
+	SD_Volume.GetTime = NULL;
+	if (FAT_Mount(&SD_Volume) != SUCCESS) {
+		return ERROR;
+	}
+	_DBG((SD_Volume.Type == FAT_TYPE_FAT32) ? "FAT32, " : "FAT16, ");
+	_DBD32((1UL << SD_Volume.clshift) / 1024); _DBG("KB clusters\n\r");
+	if ((FAT_Open(&SD_Volume, &SD_Log, "SDLOG.TXT",
+			FAT_MODE_WRITE | FAT_MODE_CREATE | FAT_MODE_TRUNC) != SUCCESS)
+			|| (FAT_Preallocate(&SD_Log, TEST_LOG_SIZE) != SUCCESS)) {
+		return ERROR;
 	}
-	if (dummy[0] != 0xff)return SD_ERROR_TIMEOUT;
-
-	return SD_OK;
-}
-/*********************************************************************//**
- * @brief		Initialize SD card in SPI mode
- * @param[in]	- retries: number retry time
- * @return 		initialization successful or terminated with specific error code
- **********************************************************************/
-sd_error SD_Init(uint8_t retries)
-{
-	uint8_t rxdata,errors;
-	uint8_t SD_arg[4]={0,0,0,0};
-	uint16_t i;
-
-	// initialize SPI configuration structure to default
-	SPI_ConfigStructInit(&SPI_ConfigStruct);
-	// Initialize SPI peripheral with parameter given in structure above
-	SPI_Init(LPC_SPI, &SPI_ConfigStruct);
-	// Initialize /CS pin to GPIO function
-	CS_Init();
-	// check for SD card insertion
-	_DBG("\n\rPlease plug-in SD card!");
-	while(SD_GetCardConnectStatus()==SD_DISCONNECTED);
-	_DBG("...Connected!\n\r");
-	// Wait for bus idle
-	if(SD_WaitDeviceIdle(160) != SD_OK) return SD_ERROR_BUS_NOT_IDLE;
-	_DBG("Initialize SD card in SPI mode...");
 
-	errors = 0;
-	/* Send the CMD0_GO_IDLE_STATE while CS is asserted */
-	/* This signals the SD card to fall back to SPI mode */
-	while(errors < retries)
-	{
-		SD_SendCommand(CMD0_GO_IDLE_STATE, SD_arg);
-		if(SD_WaitR1(&rxdata,0,1000)!= SD_OK)
-		{
-			errors++;
-			continue;
+	start = SysTickCnt;
+	line = 0;
+	for (n = 0; n < TEST_LOG_SIZE; n += sizeof(sd_data_buf)) {
+		// 16 byte lines: "LOG 00000000\r\n" with a hexadecimal line number
+		for (i = 0; i < sizeof(sd_data_buf); i += 16, line++) {
+			sd_data_buf[i] = 'L'; sd_data_buf[i + 1] = 'O';
+			sd_data_buf[i + 2] = 'G'; sd_data_buf[i + 3] = ' ';
+			for (d = 0; d < 8; d++) {
+				sd_data_buf[i + 4 + d] = "0123456789ABCDEF"[(line >> (28 - (4 * d))) & 0x0F];
+			}
+			sd_data_buf[i + 12] = ' '; sd_data_buf[i + 13] = ' ';
+			sd_data_buf[i + 14] = '\r'; sd_data_buf[i + 15] = '\n';
 		}
-		if(rxdata != R1_IDLE)
-		{
-			errors++;
-			continue;
+		if (FAT_Write(&SD_Log, sd_data_buf, sizeof(sd_data_buf)) != sizeof(sd_data_buf)) {
+			FAT_Close(&SD_Log);
+			return ERROR;
 		}
-		else break;
 	}
-	if(errors >= retries)return SD_ERROR_CMD0;
-
-	/* Check if the card is not MMC */
-	/* Start its internal initialization process */
-	while(1)
-	{
-		SD_SendCommand(CMD55_APP_CMD, SD_arg);
-		if(SD_WaitR1(&rxdata,0,1000)!= SD_OK) return SD_ERROR_CMD55;
-
-		SD_SendCommand(ACMD41_SEND_OP_COND, SD_arg);
-		SD_WaitR1(&rxdata,0,1000);
-		if (rxdata & R1_IDLE) //in_idle_state = 1
-			for (i = 0; i < 1000; i++); /* wait for a while */
-		else break; //in_idle_state=0 --> ready
+	if (FAT_Close(&SD_Log) != SUCCESS) {
+		return ERROR;
 	}
-	/* Enable CRC */
-	SD_arg[3] = 0x01;
-	SD_SendCommand(CMD59_CRC_ON_OFF, SD_arg);
-	if(SD_WaitR1(&rxdata,0,1000)!= SD_OK) return SD_ERROR_CMD59;
-	if(rxdata != R1_NOERROR) return SD_ERROR_CMD59;
-
-	return SD_OK;
+	print_rate(TEST_LOG_SIZE / SDC_BLOCK_SIZE, SysTickCnt - start);
+	return SUCCESS;
 }
-/*********************************************************************//**
- * @brief		Get SD card's CID register
- * @param[in]	none
- * @return 		OK or NG
- * 				OK: the returned data from SD card is stored in sd_data_buf
- **********************************************************************/
-sd_error SD_GetCID(void)
-{
-	uint8_t SD_arg[4]={0,0,0,0};
+#endif
 
-	SD_SendCommand(CMD10_SEND_CID, SD_arg);
-	if(SD_WaitR1(sd_data_buf,18,1000)!= SD_OK) return SD_NG;
-	if(sd_data_buf[0]!= R1_NOERROR) return SD_NG;
-	return SD_OK;
-}
 /*-------------------------MAIN FUNCTION------------------------------*/
 /*********************************************************************//**
  * @brief		c_entry: Main SPI program body
@@ -467,18 +263,14 @@ sd_error SD_GetCID(void)
 int c_entry(void)
 {
 	PINSEL_CFG_Type PinCfg;
-	sd_error sd_status;
-	uint8_t i;
-	uint8_t tem8;
-	uint32_t tem32;
 	/*
-	 * Initialize SPI pin connect
-	 * P0.15 - SCK;
-	 * P0.16 - SSEL - used as GPIO
-	 * P0.17 - MISO
-	 * P0.18 - MOSI
+	 * Initialize SSP0 pin connect
+	 * P0.15 - SCK0;
+	 * P0.16 - SSEL0 - used as GPIO
+	 * P0.17 - MISO0
+	 * P0.18 - MOSI0
 	 */
-	PinCfg.Funcnum = 3;
+	PinCfg.Funcnum = 2;
 	PinCfg.OpenDrain = 0;
 	PinCfg.Pinmode = 0;
 	PinCfg.Portnum = 0;
@@ -510,68 +302,59 @@ int c_entry(void)
 	// print welcome screen
 	print_menu();
 
-	//initialize SD card
-	sd_status = SD_Init(10);
-	switch(sd_status)
+	// 1ms time base for the throughput measurement
+	SysTick_Config(SystemCoreClock/1000 - 1);
+	GPDMA_Init();
+
+	// check for SD card insertion
+	_DBG("\n\rPlease plug-in SD card!");
+	while(SD_CardConnected() == FALSE);
+	_DBG("...Connected!\n\r");
+
+	_DBG("Initialize SD card in SPI mode...");
+	SD_Card.SSPx = LPC_SSP0;
+	SD_Card.CSPort = CS_PORT_NUM;
+	SD_Card.CSPin = CS_PIN_NUM;
+	SD_Card.DMATx = SD_DMA_TX;
+	SD_Card.DMARx = SD_DMA_RX;
+	SD_Card.ClockRate = SD_CLOCK_RATE;
+	SD_Card.CRCCheck = TRUE;
+	SD_Card.PreErase = TRUE;
+	if (SDC_Init(&SD_Card) != SUCCESS)
 	{
-	case SD_ERROR_CMD0:
-		_DBG("Fail CMD0\n\r");
-		break;
-	case SD_ERROR_CMD55:
-		_DBG("Fail CMD55\n\r");
-		break;
-	case SD_ERROR_ACMD41:
-		_DBG("Fail ACMD41\n\r");
-		break;
-	case SD_ERROR_CMD59:
-		_DBG("Fail CMD59\n\r");
-		break;
-	case SD_ERROR_BUS_NOT_IDLE:
-		_DBG("Fail...Device is not in idle state.\n\r");
-		break;
-	case SD_OK:
-		_DBG("Done!\n\r");
-		break;
-	default:
 		_DBG("Fail\n\r");
-		break;
+		while(1);
 	}
-	if(sd_status == SD_OK)
+	_DBG("Done!");
+	_DBG("\n\rCard type: ");
+	_DBG((SD_Card.Type == SDC_TYPE_SDHC) ? "SDHC" : ((SD_Card.Type == SDC_TYPE_SDV2) ? "SD 2.0" : "SD 1.x"));
+	_DBG("\n\rCapacity: "); _DBD32(SD_Card.dev.BlockCount / 2048); _DBG("MB");
+	_DBG("\n\rSPI clock: "); _DBD32(SD_Card.ClockRate / 1000); _DBG("KHz");
+	print_cid();
+
+	_DBG("Read throughput: ");
+	if (SD_Throughput(FALSE, 0) != SUCCESS)
 	{
-		//Clear receive buffer
-		for(i=1;i<18;i++)sd_data_buf[i]=0;
-
-		_DBG("Reading SD card's CID register...");
-		if(SD_GetCID()!= SD_OK)
-		{
-			_DBG("Fail\n\r");
-			SPI_DeInit(LPC_SPI);
-		}
-		else
-		{
-			_DBG("Done!");
-			_DBG("\n\rManufacture ID: ");_DBH(sd_data_buf[1]);
-			_DBG("\n\rApplication ID: ");_DBC(sd_data_buf[2]);_DBC(sd_data_buf[3]);
-			_DBG("\n\rProduct name: ");
-				for(i=4;i<9;i++) _DBC(sd_data_buf[i]);
-			_DBG("\n\rProduct revision: ");
-				tem8 = (sd_data_buf[9]&0xF0)>>4;_DBD(tem8);
-				_DBG(".");
-				tem8 = (sd_data_buf[9]&0x0F);_DBD(tem8);
-			_DBG("\n\rProduct serial number: ");
-				tem32= (sd_data_buf[13]<<24)|(sd_data_buf[12]<<16)|
-						(sd_data_buf[11]<<8)|(sd_data_buf[10]<<0);
-				_DBH32(tem32);
-			_DBG("\n\rManufacturing date: ");
-				tem8 = (sd_data_buf[15]&0x0F);_DBD(tem8);
-				_DBG("/");
-				tem8 = ((sd_data_buf[14]&0x0F)<<4) | ((sd_data_buf[15]&0xF0)>>4);
-				_DBG("2");_DBD(tem8);
-		}
+		_DBG("Fail\n\r");
+	}
+#if TEST_WRITE
+	_DBG("Write throughput: ");
+	if (SD_Throughput(TRUE, SD_Card.dev.BlockCount - TEST_BLOCKS) != SUCCESS)
+	{
+		_DBG("Fail\n\r");
 	}
-	else
-    // DeInitialize SPI peripheral
-		SPI_DeInit(LPC_SPI);
+#endif
+#if TEST_FAT
+	_DBG("Log file: ");
+	if (SD_LogThroughput() != SUCCESS)
+	{
+		_DBG("Fail\n\r");
+	}
+#endif
+	_DBG("CRC errors: "); _DBD32(SD_Card.crcerrors);
+	_DBG(", timeouts: "); _DBD32(SD_Card.timeouts);
+	_DBG("\n\r");
+
     /* Loop forever */
     while(1);
     return 1;
@@ -0,0 +1,75 @@
+/**********************************************************************
+* $Id$		host_cm3.h				2011-03-09
+*//**
+* @file		host_cm3.h
+* @brief	Cortex-M3 core intrinsics for the host build of the SSP
+* 			benchmark: included before every source file, it stands in
+* 			for core_cmInstr.h and core_cmFunc.h
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __HOST_CM3_H
+#define __HOST_CM3_H
+
+#include <stdint.h>
+
+/* The CMSIS headers are skipped, their guards are taken here */
+#define __CORE_CMINSTR_H__
+#define __CORE_CMFUNC_H__
+
+/* Barriers: the model runs in the same thread, only the compiler
+ * must not move accesses across them */
+static inline void __NOP(void) { }
+static inline void __WFI(void) { }
+static inline void __WFE(void) { }
+static inline void __SEV(void) { }
+static inline void __ISB(void) { __asm__ volatile ("" ::: "memory"); }
+static inline void __DSB(void) { __asm__ volatile ("" ::: "memory"); }
+static inline void __DMB(void) { __asm__ volatile ("" ::: "memory"); }
+
+static inline uint32_t __REV(uint32_t value)
+{
+	return __builtin_bswap32(value);
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+	uint32_t result;
+	int n;
+
+	result = 0;
+	for (n = 0; n < 32; n++) {
+		result = (result << 1) | (value & 1);
+		value >>= 1;
+	}
+	return result;
+}
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+	return (value == 0) ? 32 : (uint8_t)__builtin_clz(value);
+}
+
+/* No interrupts on the host */
+static inline void __enable_irq(void) { }
+static inline void __disable_irq(void) { }
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t priMask) { (void)priMask; }
+
+#endif /* __HOST_CM3_H */
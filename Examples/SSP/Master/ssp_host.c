@@ -0,0 +1,184 @@
+/**********************************************************************
+* $Id$		ssp_host.c			2011-03-09
+*//**
+* @file		ssp_host.c
+* @brief	Host benchmark of the polled SSP transfers on the SSP0
+* 			model: SSP_ReadWrite() in polling mode and
+* 			SSP_ReadWriteBurst() move 1 KB in each direction and data
+* 			width at several SCK rates. Reports the bit times the bus
+* 			stays idle between two frames, per KB.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_ssp.h"
+#include "sspsim.h"
+
+/* Test parameters */
+#define HOST_LEN			1024	/* Bytes of one transfer */
+#define HOST_BURST_MIN_DIV	4		/* SCK = PCLK / n and slower: the burst
+									   path must not leave the bus idle */
+
+/** Transfer directions */
+#define HOST_TX				0x01
+#define HOST_RX				0x02
+
+/** SCK rates, PCLK divider */
+static const uint32_t host_div[] = { 2, 4, 8, 16 };
+
+/* Buffers */
+static uint8_t host_tx[HOST_LEN];
+static uint8_t host_rx[HOST_LEN];
+
+/*********************************************************************//**
+ * @brief		Stub: the peripheral power is not modelled
+ **********************************************************************/
+void CLKPWR_ConfigPPWR(uint32_t PPType, FunctionalState NewState)
+{
+	(void)PPType;
+	(void)NewState;
+}
+
+/*********************************************************************//**
+ * @brief		Stub: PCLK of the SSP model
+ **********************************************************************/
+uint32_t CLKPWR_GetPCLK(uint32_t ClkType)
+{
+	(void)ClkType;
+	return SSPSIM_PCLK;
+}
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Run one transfer and print its line
+ * @param[in]	burst	TRUE: SSP_ReadWriteBurst(), FALSE: SSP_ReadWrite()
+ * @param[in]	dir		HOST_TX and/or HOST_RX
+ * @param[in]	bits	Data width, 8 or 16
+ * @param[in]	div		SCK = PCLK / div
+ * @return		Number of failures
+ **********************************************************************/
+static uint32_t host_Run(int burst, uint32_t dir, uint32_t bits, uint32_t div)
+{
+	SSP_CFG_Type cfg;
+	SSP_DATA_SETUP_Type xfer;
+	SSPSIM_STATS_Type st;
+	uint32_t n, fail, expect;
+	int32_t ret;
+
+	SSP_ConfigStructInit(&cfg);
+	cfg.ClockRate = SSPSIM_PCLK / div;
+	cfg.Databit = (bits == 16) ? SSP_DATABIT_16 : SSP_DATABIT_8;
+	SSP_Init(LPC_SSP0, &cfg);
+	SSP_Cmd(LPC_SSP0, ENABLE);
+
+	for (n = 0; n < HOST_LEN; n++) {
+		host_tx[n] = (uint8_t)(n * 7 + 3);
+	}
+	memset(host_rx, 0, sizeof(host_rx));
+	xfer.tx_data = (dir & HOST_TX) ? host_tx : NULL;
+	xfer.rx_data = (dir & HOST_RX) ? host_rx : NULL;
+	xfer.length = HOST_LEN;
+
+	SSPSIM_Start();
+	if (burst) {
+		ret = SSP_ReadWriteBurst(LPC_SSP0, &xfer);
+	} else {
+		ret = SSP_ReadWrite(LPC_SSP0, &xfer, SSP_TRANSFER_POLLING);
+	}
+	SSPSIM_Stop();
+	SSPSIM_GetStats(&st);
+	SSP_Cmd(LPC_SSP0, DISABLE);
+
+	fail = 0;
+	if ((ret != HOST_LEN) || (st.Frames != HOST_LEN * 8 / bits)
+			|| st.Overruns || st.Violations) {
+		fail = 1;
+	}
+	/* The slave answers each frame with its complement */
+	for (n = 0; (dir & HOST_RX) && (n < HOST_LEN); n++) {
+		expect = (dir & HOST_TX) ? (uint8_t)~host_tx[n] : 0x00;
+		if (host_rx[n] != expect) {
+			fail = 1;
+			break;
+		}
+	}
+	if (burst && (div >= HOST_BURST_MIN_DIV) && (st.IdlePrimed != 0)) {
+		fail = 1;
+	}
+
+	printf("%-6s %-5s %2u  PCLK/%-3u %6u %8u %8u %8u %6.1f%%  %s%s%s\n",
+			burst ? "burst" : "poll",
+			(dir == (HOST_TX | HOST_RX)) ? "txrx" : ((dir == HOST_TX) ? "tx" : "rx"),
+			(unsigned)bits, (unsigned)div,
+			(unsigned)(st.Instructions * 1024UL / HOST_LEN),
+			(unsigned)st.Cycles, (unsigned)st.IdleBits, (unsigned)st.IdlePrimed,
+			100.0 * st.Frames * bits * st.BitTime / st.Cycles,
+			fail ? "FAIL" : "ok", st.Violations ? ": " : "", SSPSIM_Violation());
+	return fail;
+}
+
+/*********************************************************************//**
+ * @brief		Main program body
+ * @param[in]	None
+ * @return		0 if all transfers pass
+ **********************************************************************/
+int main(void)
+{
+	static const uint32_t dirs[] = { HOST_TX | HOST_RX, HOST_TX, HOST_RX };
+	uint32_t fail, d, w, r;
+	int burst;
+
+	SSPSIM_Init();
+
+	printf("1 KB transfers, PCLK %u MHz, %u cycle(s) APB wait per register access\n",
+			(unsigned)(SSPSIM_PCLK / 1000000), (unsigned)SSPSIM_APB_WAIT);
+	printf("instr: instructions per KB, polling included; idle: bit times per KB\n"
+			"between two frames, primed: same after the first %u frames\n",
+			(unsigned)SSP_FIFO_DEPTH);
+	printf("func   dir   w   SCK      instr   cycles     idle  primed    bus\n");
+	fail = 0;
+	for (d = 0; d < sizeof(dirs) / sizeof(dirs[0]); d++) {
+		for (w = 8; w <= 16; w += 8) {
+			for (r = 0; r < sizeof(host_div) / sizeof(host_div[0]); r++) {
+				for (burst = 0; burst <= 1; burst++) {
+					fail += host_Run(burst, dirs[d], w, host_div[r]);
+				}
+			}
+		}
+	}
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
@@ -0,0 +1,424 @@
+/**********************************************************************
+* $Id$		sspsim.c			2011-03-09
+*//**
+* @file		sspsim.c
+* @brief	Host model of the LPC17xx SSP0 controller. The register
+* 			page is mapped without access rights: each access of the
+* 			driver faults, is prepared by the model, single-stepped and
+* 			applied. Between SSPSIM_Start() and SSPSIM_Stop() every
+* 			instruction is single-stepped too and counted as one
+* 			processor cycle, so the shifter runs against the real
+* 			instruction stream of the driver.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "LPC17xx.h"
+#include "lpc17xx_ssp.h"
+#include "sspsim.h"
+
+/* Model parameters */
+#define SIM_REG_SZ			0x00001000UL	/* SSP0 registers, trapped */
+
+/* Register offsets */
+#define SIM_OFS(reg)		offsetof(LPC_SSP_TypeDef, reg)
+#define SIM_REG(ofs)		(*((volatile uint32_t *)(LPC_SSP0_BASE + (ofs))))
+
+/* x86-64 trap flag and page fault error code */
+#define SIM_EFL_TF			0x00000100
+#define SIM_ERR_WRITE		0x00000002
+
+/** FIFO entry: frame and processor cycle it was written at */
+typedef struct {
+	uint32_t val;
+	uint64_t time;
+} SIM_FRAME_Type;
+
+/** Controller state */
+static struct {
+	uint32_t cr0;
+	uint32_t cr1;
+	uint32_t cpsr;
+	uint32_t imsc;
+	uint32_t ris;
+	uint32_t dmacr;
+	SIM_FRAME_Type tx[SSP_FIFO_DEPTH];
+	uint32_t txhead;
+	uint32_t txcount;
+	uint32_t rx[SSP_FIFO_DEPTH];
+	uint32_t rxhead;
+	uint32_t rxcount;
+	/* Shifter */
+	uint32_t busy;
+	uint32_t cur;
+	uint64_t done;
+	uint64_t last;
+	uint32_t haslast;
+} sim;
+
+/* Processor time, cycles */
+static uint64_t sim_cycle;
+static uint64_t sim_start;
+static volatile int sim_trace;
+
+/* Access being single-stepped */
+static volatile int sim_inhandler;
+static uint32_t sim_ofs;
+static uint32_t sim_write;
+static uint32_t sim_before;
+
+static SSPSIM_STATS_Type sim_stats;
+static char sim_violation[160];
+
+/* Private Functions ---------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Count a programming error of the driver, keep the first
+ * @param[in]	msg		Description
+ * @return 		None
+ **********************************************************************/
+static void sim_Violation(const char *msg)
+{
+	if (sim_stats.Violations++ == 0) {
+		snprintf(sim_violation, sizeof(sim_violation), "%s", msg);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		PCLK cycles of one bit, from CPSR and CR0 SCR
+ * @param[in]	None
+ * @return 		Bit time
+ **********************************************************************/
+static uint32_t sim_BitTime(void)
+{
+	return sim.cpsr * (((sim.cr0 >> 8) & 0xFF) + 1);
+}
+
+/*********************************************************************//**
+ * @brief		Run the shifter up to a processor cycle: frames end into
+ * 				the RX FIFO, the next one starts as soon as the shifter
+ * 				is free and a frame is in the TX FIFO. The slave answers
+ * 				each frame with its complement.
+ * @param[in]	now		Processor cycle
+ * @return 		None
+ **********************************************************************/
+static void sim_Advance(uint64_t now)
+{
+	SIM_FRAME_Type *f;
+	uint64_t start, idle;
+	uint32_t bits, mask;
+
+	bits = (sim.cr0 & 0xF) + 1;
+	mask = (1UL << bits) - 1;
+	for (;;) {
+		if (sim.busy && (sim.done <= now)) {
+			if (sim.rxcount < SSP_FIFO_DEPTH) {
+				sim.rx[(sim.rxhead + sim.rxcount) & (SSP_FIFO_DEPTH - 1)] = ~sim.cur & mask;
+				sim.rxcount++;
+			} else {
+				sim.ris |= SSP_RIS_ROR;
+				sim_stats.Overruns++;
+			}
+			sim.busy = 0;
+			sim.last = sim.done;
+			sim.haslast = 1;
+			sim_stats.Frames++;
+		} else if (!sim.busy && (sim.txcount != 0) && (sim.cr1 & SSP_CR1_SSP_EN)
+					&& !(sim.cr1 & SSP_CR1_SLAVE_EN)) {
+			f = &sim.tx[sim.txhead];
+			start = f->time;
+			if (sim.haslast && (start > sim.last)) {
+				idle = (start - sim.last + sim_BitTime() - 1) / sim_BitTime();
+				sim_stats.IdleBits += (uint32_t)idle;
+				if (sim_stats.Frames >= SSP_FIFO_DEPTH) {
+					sim_stats.IdlePrimed += (uint32_t)idle;
+				}
+				sim_stats.Gaps++;
+			} else if (sim.haslast) {
+				start = sim.last;
+			}
+			sim.busy = 1;
+			sim.cur = f->val & mask;
+			sim.done = start + (uint64_t)bits * sim_BitTime();
+			sim.txhead = (sim.txhead + 1) & (SSP_FIFO_DEPTH - 1);
+			sim.txcount--;
+		} else {
+			break;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Side effect of a register read
+ * @param[in]	ofs		Register offset
+ * @return 		None
+ **********************************************************************/
+static void sim_Read(uint32_t ofs)
+{
+	if (ofs == SIM_OFS(DR)) {
+		if (sim.rxcount == 0) {
+			sim_Violation("DR read with RX FIFO empty");
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register write
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_Write(uint32_t ofs, uint32_t val)
+{
+	if (ofs == SIM_OFS(CR0)) {
+		sim.cr0 = val & 0xFFFF;
+	} else if (ofs == SIM_OFS(CR1)) {
+		sim.cr1 = val & SSP_CR1_BITMASK;
+	} else if (ofs == SIM_OFS(DR)) {
+		if (!(sim.cr1 & SSP_CR1_SSP_EN)) {
+			sim_Violation("DR written with SSP disabled");
+		}
+		if (sim.txcount == SSP_FIFO_DEPTH) {
+			sim_Violation("DR written with TX FIFO full");
+			return;
+		}
+		sim.tx[(sim.txhead + sim.txcount) & (SSP_FIFO_DEPTH - 1)].val = val & 0xFFFF;
+		sim.tx[(sim.txhead + sim.txcount) & (SSP_FIFO_DEPTH - 1)].time = sim_cycle;
+		sim.txcount++;
+		sim_Advance(sim_cycle);
+	} else if (ofs == SIM_OFS(CPSR)) {
+		sim.cpsr = val & SSP_CPSR_BITMASK;
+		if ((sim.cpsr < 2) || (sim.cpsr & 1)) {
+			sim_Violation("CPSR not an even value from 2 to 254");
+		}
+	} else if (ofs == SIM_OFS(IMSC)) {
+		sim.imsc = val & 0x0F;
+	} else if (ofs == SIM_OFS(ICR)) {
+		sim.ris &= ~(val & (SSP_RIS_ROR | SSP_RIS_RT));
+	} else if (ofs == SIM_OFS(DMACR)) {
+		sim.dmacr = val & 0x03;
+	} else {
+		sim_Violation("write to a read only register");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Refresh the readable register values
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_Publish(void)
+{
+	uint32_t sr, ris;
+
+	sr = 0;
+	if (sim.txcount == 0) {
+		sr |= SSP_SR_TFE;
+	}
+	if (sim.txcount < SSP_FIFO_DEPTH) {
+		sr |= SSP_SR_TNF;
+	}
+	if (sim.rxcount != 0) {
+		sr |= SSP_SR_RNE;
+	}
+	if (sim.rxcount == SSP_FIFO_DEPTH) {
+		sr |= SSP_SR_RFF;
+	}
+	if (sim.busy || (sim.txcount != 0)) {
+		sr |= SSP_SR_BSY;
+	}
+	ris = sim.ris;
+	if (sim.rxcount >= SSP_FIFO_DEPTH / 2) {
+		ris |= SSP_RIS_RX;
+	}
+	if (sim.txcount <= SSP_FIFO_DEPTH / 2) {
+		ris |= SSP_RIS_TX;
+	}
+
+	memset((void *)LPC_SSP0_BASE, 0, SIM_REG_SZ);
+	SIM_REG(SIM_OFS(CR0)) = sim.cr0;
+	SIM_REG(SIM_OFS(CR1)) = sim.cr1;
+	SIM_REG(SIM_OFS(DR)) = (sim.rxcount != 0) ? sim.rx[sim.rxhead] : 0;
+	SIM_REG(SIM_OFS(SR)) = sr;
+	SIM_REG(SIM_OFS(CPSR)) = sim.cpsr;
+	SIM_REG(SIM_OFS(IMSC)) = sim.imsc;
+	SIM_REG(SIM_OFS(RIS)) = ris;
+	SIM_REG(SIM_OFS(MIS)) = ris & sim.imsc;
+	SIM_REG(SIM_OFS(DMACR)) = sim.dmacr;
+}
+
+/*********************************************************************//**
+ * @brief		Register page fault: prepare the access, single-step it
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Fault(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uintptr_t adr = (uintptr_t)si->si_addr;
+
+	(void)sig;
+	if ((adr < LPC_SSP0_BASE) || (adr >= LPC_SSP0_BASE + SIM_REG_SZ) || sim_inhandler) {
+		signal(SIGSEGV, SIG_DFL);				/* Real fault: faults again */
+		return;
+	}
+	sim_inhandler = 1;
+	mprotect((void *)LPC_SSP0_BASE, SIM_REG_SZ, PROT_READ | PROT_WRITE);
+	sim_ofs = (uint32_t)(adr - LPC_SSP0_BASE);
+	sim_write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_ERR_WRITE) != 0;
+	if (sim_ofs & 3) {
+		sim_Violation("unaligned register access");
+	}
+	sim_ofs &= ~3UL;
+	sim_stats.Accesses++;
+	sim_cycle += SSPSIM_APB_WAIT;
+	sim_Advance(sim_cycle);
+	if (!sim_write) {
+		sim_Read(sim_ofs);
+	}
+	sim_Publish();
+	sim_before = SIM_REG(sim_ofs);
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Single step: apply a register access that is done, count
+ * 				an instruction of the traced code
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Step(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uint32_t val;
+
+	(void)sig;
+	(void)si;
+	if (sim_inhandler) {
+		val = SIM_REG(sim_ofs);
+		/* Read-modify-write instructions may fault as a read */
+		if (sim_write || (val != sim_before)) {
+			sim_Write(sim_ofs, val);
+		} else if (sim_ofs == SIM_OFS(DR) && (sim.rxcount != 0)) {
+			/* Frame read: leaves the RX FIFO */
+			sim.rxhead = (sim.rxhead + 1) & (SSP_FIFO_DEPTH - 1);
+			sim.rxcount--;
+		}
+		sim_Publish();
+		mprotect((void *)LPC_SSP0_BASE, SIM_REG_SZ, PROT_NONE);
+		sim_inhandler = 0;
+	}
+	if (sim_trace) {
+		sim_stats.Instructions++;
+		sim_cycle++;
+		uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+	} else {
+		uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFL_TF;
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Map the SSP0 registers and install the access traps.
+ * 				The controller is disabled, as after reset
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SSPSIM_Init(void)
+{
+	struct sigaction sa;
+	void *p;
+
+	p = mmap((void *)LPC_SSP0_BASE, SIM_REG_SZ, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if (p != (void *)LPC_SSP0_BASE) {
+		fprintf(stderr, "sspsim: cannot map 0x%08lX\n", (unsigned long)LPC_SSP0_BASE);
+		exit(2);
+	}
+	memset(&sim, 0, sizeof(sim));
+	sim_Publish();
+	mprotect((void *)LPC_SSP0_BASE, SIM_REG_SZ, PROT_NONE);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sim_Fault;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = sim_Step;
+	sigaction(SIGTRAP, &sa, NULL);
+}
+
+/*********************************************************************//**
+ * @brief		Clear the counters and single-step the code that follows
+ * 				until SSPSIM_Stop()
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SSPSIM_Start(void)
+{
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	sim_violation[0] = 0;
+	sim.haslast = 0;
+	sim_start = sim_cycle;
+	sim_trace = 1;
+	__asm__ volatile ("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+/*********************************************************************//**
+ * @brief		End of the traced code: the next trap clears the trap
+ * 				flag
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void SSPSIM_Stop(void)
+{
+	sim_trace = 0;
+	__asm__ volatile ("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+	sim_Advance(sim_cycle);
+}
+
+/*********************************************************************//**
+ * @brief		Get the model counters
+ * @param[out]	stats	Counters
+ * @return 		None
+ **********************************************************************/
+void SSPSIM_GetStats(SSPSIM_STATS_Type *stats)
+{
+	*stats = sim_stats;
+	stats->Cycles = (uint32_t)(sim_cycle - sim_start);
+	stats->BitTime = sim_BitTime();
+}
+
+/*********************************************************************//**
+ * @brief		First programming error seen by the model
+ * @param[in]	None
+ * @return 		Description, empty if none
+ **********************************************************************/
+const char *SSPSIM_Violation(void)
+{
+	return sim_violation;
+}
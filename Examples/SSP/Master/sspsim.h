@@ -0,0 +1,61 @@
+/**********************************************************************
+* $Id$		sspsim.h			2011-03-09
+*//**
+* @file		sspsim.h
+* @brief	Host model of the LPC17xx SSP0 controller: FIFOs, shifter
+* 			and bit clock, driven by the unmodified SSP driver. The
+* 			processor time is the instruction count of the driver,
+* 			each instruction single-stepped, plus the APB wait states
+* 			of the register accesses
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __SSPSIM_H
+#define __SSPSIM_H
+
+#include <stdint.h>
+
+/** PCLK of the model, also the processor clock */
+#define SSPSIM_PCLK			100000000UL
+/** Processor cycles added by an APB register access */
+#define SSPSIM_APB_WAIT		2
+
+/**
+ * @brief Model counters, since SSPSIM_Start()
+ */
+typedef struct {
+	uint32_t Instructions;	/**< Instructions run by the driver */
+	uint32_t Accesses;		/**< Register accesses of the driver */
+	uint32_t Cycles;		/**< Processor cycles */
+	uint32_t Frames;		/**< Frames shifted on the bus */
+	uint32_t BitTime;		/**< PCLK cycles per bit */
+	uint32_t IdleBits;		/**< Bit times between two frames */
+	uint32_t IdlePrimed;	/**< Same, after the first SSP_FIFO_DEPTH frames */
+	uint32_t Gaps;			/**< Frames started late */
+	uint32_t Overruns;		/**< Frames lost on a full RX FIFO */
+	uint32_t Violations;	/**< Programming errors seen by the model */
+} SSPSIM_STATS_Type;
+
+void SSPSIM_Init(void);
+void SSPSIM_Start(void);
+void SSPSIM_Stop(void);
+void SSPSIM_GetStats(SSPSIM_STATS_Type *stats);
+const char *SSPSIM_Violation(void);
+
+#endif /* __SSPSIM_H */
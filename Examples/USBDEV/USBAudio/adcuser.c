@@ -18,147 +18,59 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "audio.h"
-#include "usbcfg.h"
-#include "usbcore.h"
+#include "lpc17xx_usbdev_audio.h"
 #include "adcuser.h"
 
 #include "usbaudio.h"
 
-      uint16_t VolCur = 0x0100;     /* Volume Current Value */
-const uint16_t VolMin = 0x0000;     /* Volume Minimum Value */
-const uint16_t VolMax = 0x0100;     /* Volume Maximum Value */
-const uint16_t VolRes = 0x0004;     /* Volume Resolution */
 
-/*
- *  Audio Device Class Interface Get Request Callback
- *   Called automatically on ADC Interface Get Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
+/* Audio class driver instance */
+USBDEV_AUDIO_Type ADC_Dev;
 
-uint32_t ADC_IF_GetRequest (void) {
-
-/*
-  Interface = SetupPacket.wIndex.WB.L;
-  EntityID  = SetupPacket.wIndex.WB.H;
-  Request   = SetupPacket.bRequest;
-  Value     = SetupPacket.wValue.W;
-  ...
-*/
-
-  if (SetupPacket.wIndex.W == 0x0200) {
-    /* Feature Unit: Interface = 0, ID = 2 */
-    if (SetupPacket.wValue.WB.L == 0) {
-      /* Master Channel */
-      switch (SetupPacket.wValue.WB.H) {
-        case AUDIO_MUTE_CONTROL:
-          switch (SetupPacket.bRequest) {
-            case AUDIO_REQUEST_GET_CUR:
-              EP0Buf[0] = Mute;
-              return (TRUE);
-          }
-          break;
-        case AUDIO_VOLUME_CONTROL:
-          switch (SetupPacket.bRequest) {
-            case AUDIO_REQUEST_GET_CUR:
-              *((__packed uint16_t *)EP0Buf) = VolCur;
-              return (TRUE);
-            case AUDIO_REQUEST_GET_MIN:
-              *((__packed uint16_t *)EP0Buf) = VolMin;
-              return (TRUE);
-            case AUDIO_REQUEST_GET_MAX:
-              *((__packed uint16_t *)EP0Buf) = VolMax;
-              return (TRUE);
-            case AUDIO_REQUEST_GET_RES:
-              *((__packed uint16_t *)EP0Buf) = VolRes;
-              return (TRUE);
-          }
-          break;
-      }
-    }
-  }
-  return (FALSE);  /* Not Supported */
-}
+/* Isochronous OUT stream with feedback, ring buffer with the slack of
+   one packet */
+USBDEV_AUDIO_STREAM_Type ADC_Stream;
+static uint32_t ADC_StreamBuf[(S_S + P_MAX + 3) / 4];
 
 
 /*
- *  Audio Device Class Interface Set Request Callback
- *   Called automatically on ADC Interface Set Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
+ *  Audio Device Class Initialization
+ *   Registers the audio class driver: feature unit 2 (mute, volume) of
+ *   interface 0, isochronous OUT endpoint 3 of interface 1 streamed by
+ *   the driver, with its feedback endpoint 3 IN
+ *    Parameters:      position: samples played by the output, free
+ *                               running (feedback measure)
+ *                     arg:      position argument
+ *    Return Value:    None
  */
 
-uint32_t ADC_IF_SetRequest (void) {
-
-/*
-  Interface = SetupPacket.wIndex.WB.L;
-  EntityID  = SetupPacket.wIndex.WB.H;
-  Request   = SetupPacket.bRequest;
-  Value     = SetupPacket.wValue.W;
-  ...
-*/
-
-  if (SetupPacket.wIndex.W == 0x0200) {
-    /* Feature Unit: Interface = 0, ID = 2 */
-    if (SetupPacket.wValue.WB.L == 0) {
-      /* Master Channel */
-      switch (SetupPacket.wValue.WB.H) {
-        case AUDIO_MUTE_CONTROL:
-          switch (SetupPacket.bRequest) {
-            case AUDIO_REQUEST_SET_CUR:
-              Mute = EP0Buf[0];
-              return (TRUE);
-          }
-          break;
-        case AUDIO_VOLUME_CONTROL:
-          switch (SetupPacket.bRequest) {
-            case AUDIO_REQUEST_SET_CUR:
-              VolCur = *((__packed uint16_t *)EP0Buf);
-              return (TRUE);
-          }
-          break;
-      }
-    }
-  }
-  return (FALSE);  /* Not Supported */
-}
-
-
-/*
- *  Audio Device Class EndPoint Get Request Callback
- *   Called automatically on ADC EndPoint Get Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t ADC_EP_GetRequest (void) {
-
-/*
-  EndPoint = SetupPacket.wIndex.WB.L;
-  Request  = SetupPacket.bRequest;
-  Value    = SetupPacket.wValue.W;
-  ...
-*/
-  return (FALSE);  /* Not Supported */
-}
-
-
-/*
- *  Audio Device Class EndPoint Set Request Callback
- *   Called automatically on ADC EndPoint Set Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t ADC_EP_SetRequest (void) {
-
-/*
-  EndPoint = SetupPacket.wIndex.WB.L;
-  Request  = SetupPacket.bRequest;
-  Value    = SetupPacket.wValue.W;
-  ...
-*/
-  return (FALSE);  /* Not Supported */
+void ADC_Init (uint32_t (*position)(void *arg), void *arg) {
+
+  ADC_Stream.IF = 1;
+  ADC_Stream.FeedbackEP = ADC_EP_FB;
+  ADC_Stream.FeedbackShift = FB_SHIFT;
+  ADC_Stream.SampleBytes = 2;               /* Mono, 16 bit */
+  ADC_Stream.MaxPacket = P_MAX;
+  ADC_Stream.Rate = DATA_FREQ;
+  ADC_Stream.Buf = (uint8_t *)ADC_StreamBuf;
+  ADC_Stream.Size = S_S;
+  ADC_Stream.Target = S_T;
+  ADC_Stream.Position = position;
+  ADC_Stream.arg = arg;
+
+  ADC_Dev.CIF = 0;
+  ADC_Dev.NumIF = 2;
+  ADC_Dev.FeatureUnit = 2;
+  ADC_Dev.EP = ADC_EP_OUT;
+  ADC_Dev.ControlChange = NULL;
+  ADC_Dev.Streaming = NULL;
+  ADC_Dev.Frame = NULL;
+  ADC_Dev.Endpoint = NULL;
+  ADC_Dev.Stream = &ADC_Stream;
+  ADC_Dev.VolCur = 0x0100;                  /* Volume Current Value */
+  ADC_Dev.VolMin = 0x0000;                  /* Volume Minimum Value */
+  ADC_Dev.VolMax = 0x0100;                  /* Volume Maximum Value */
+  ADC_Dev.VolRes = 0x0004;                  /* Volume Resolution */
+  ADC_Dev.Mute = 0;
+  USB_AudioInit(&ADC_Dev);
 }
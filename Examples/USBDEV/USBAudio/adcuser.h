@@ -20,11 +20,17 @@
 #define __ADCUSER_H__
 
 
-/* Audio Device Class Requests Callback Functions */
-extern uint32_t ADC_IF_GetRequest (void);
-extern uint32_t ADC_IF_SetRequest (void);
-extern uint32_t ADC_EP_GetRequest (void);
-extern uint32_t ADC_EP_SetRequest (void);
+/* Audio Isochronous Out Endpoint Address */
+#define ADC_EP_OUT       0x03
+/* Audio Isochronous In Feedback Endpoint Address */
+#define ADC_EP_FB        0x83
+
+/* Audio Device Class Driver Instance and its Stream */
+extern USBDEV_AUDIO_Type ADC_Dev;
+extern USBDEV_AUDIO_STREAM_Type ADC_Stream;
+
+/* Audio Device Class Initialization Function */
+extern void ADC_Init (uint32_t (*position)(void *arg), void *arg);
 
 
 #endif  /* __ADCUSER_H__ */
@@ -0,0 +1,435 @@
+/**********************************************************************
+* $Id$		audio_host.c			2011-03-09
+*//**
+* @file		audio_host.c
+* @brief	Host check of the asynchronous audio stream: the audio class
+* 			driver, the resampler and the CMSIS DSP FIR interpolator run
+* 			against a model of the USB host and of the DAC player, their
+* 			clocks apart by a fixed drift. One simulated hour per
+* 			scenario, with a host that follows the feedback endpoint and
+* 			with one that ignores it
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "lpc17xx_usbdev_audio.h"
+#include "adcuser.h"
+#include "usbaudio.h"
+#include "audio_resample.h"
+
+/* Test parameters */
+#define HOST_SECONDS		3600		/* Simulated time per scenario */
+#define HOST_SETTLE			1800		/* Averages taken over the last seconds */
+#define HOST_WARMUP			1000		/* Frames before the output is checked */
+#define HOST_FB_PHASE		13			/* Frame of the feedback period polled by the host */
+#define HOST_TONE_STEP		37			/* Test tone: HOST_TONE_STEP / HOST_TONE_SIZE of
+										   the stream rate, 1156.25Hz */
+#define HOST_TONE_SIZE		1024
+#define HOST_TONE_AMPL		16000.0
+#define HOST_MAX_FIR_ERR	2			/* Interpolated samples against the reference (LSB) */
+#define HOST_MAX_RESIDUAL	64			/* Second difference residual of the output (LSB) */
+#define HOST_MAX_FB_PPM		15.0		/* Feedback average against the DAC rate */
+#define HOST_MAX_RATIO_PPM	8.0			/* Resampler ratio against the drift */
+
+/**
+ * @brief Scenario: drift of the DAC clock against the USB frames, and
+ * whether the host follows the feedback endpoint
+ */
+typedef struct {
+	const char *Name;
+	int32_t Drift;			/**< DAC rate error, ppm */
+	uint8_t Follow;			/**< Host sends at the feedback rate */
+} HOST_SCENARIO_Type;
+
+static const HOST_SCENARIO_Type host_scenario[] = {
+	{ "follow, DAC fast",  500, 1 },
+	{ "follow, DAC slow", -500, 1 },
+	{ "ignore, DAC fast",  500, 0 },
+	{ "ignore, DAC slow", -500, 0 }
+};
+
+static RESAMPLE_Type Resampler;
+static USBDEV_CLASS_Type *host_cls;
+static q15_t host_tone[HOST_TONE_SIZE];
+static double host_coeffs[RESAMPLE_TAPS];
+static uint8_t host_pkt[P_MAX];			/* Packet sent in the current frame */
+static uint32_t host_pktlen;
+static uint8_t host_fb[AUDIO_FEEDBACK_SIZE];	/* Feedback loaded on SOF */
+static uint32_t host_fbwrites;
+static uint32_t host_sent;				/* Stream samples sent by the host */
+static uint32_t host_frame;
+static double host_dacrate;				/* DAC samples per frame */
+static q15_t host_out[PLAY_BLOCK];
+static int32_t host_y1, host_y2;		/* Last two output samples */
+static uint32_t host_checked;			/* Output samples checked */
+static uint32_t host_silent;			/* Silent input blocks when checks began */
+static int32_t host_residual;			/* Largest second difference residual */
+static int32_t host_firerr;				/* Largest interpolation error */
+
+/*********************************************************************//**
+ * @brief		Scenario failure: print the reason and stop
+ * @param[in]	msg		Reason
+ * @return		None
+ **********************************************************************/
+static void host_Fail(const char *msg)
+{
+	fprintf(stderr, "FAIL: %s (%.3f s)\n", msg, host_frame / 1000.0);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		USB device core: register a class driver, only the audio
+ * 				class here
+ * @param[in]	cls		Class driver
+ * @return		None
+ **********************************************************************/
+void USB_RegisterClass(USBDEV_CLASS_Type *cls)
+{
+	host_cls = cls;
+}
+
+/*********************************************************************//**
+ * @brief		USB device core: endpoint handlers are not used by the
+ * 				stream engine
+ * @param[in]	EPNum	Endpoint
+ * @param[in]	handler	Handler
+ * @param[in]	arg		Handler argument
+ * @return		None
+ **********************************************************************/
+void USB_RegisterEP(uint32_t EPNum, USBDEV_EP_HANDLER handler, void *arg)
+{
+	host_Fail("endpoint handler registered");
+}
+
+/*********************************************************************//**
+ * @brief		USB device core: read the isochronous packet received in
+ * 				the last frame
+ * @param[in]	EPNum	Endpoint, ADC_EP_OUT
+ * @param[out]	pData	Destination, P_MAX bytes
+ * @return		Packet length, 0 if the host sent none
+ **********************************************************************/
+uint32_t USB_ReadEP(uint32_t EPNum, uint8_t *pData)
+{
+	uint32_t len;
+
+	if (EPNum != ADC_EP_OUT) {
+		host_Fail("read of a wrong endpoint");
+	}
+	len = host_pktlen;
+	memcpy(pData, host_pkt, len);
+	host_pktlen = 0;
+	return len;
+}
+
+/*********************************************************************//**
+ * @brief		USB device core: load the feedback packet, sent on the
+ * 				next IN token
+ * @param[in]	EPNum	Endpoint, ADC_EP_FB
+ * @param[in]	pData	Packet
+ * @param[in]	cnt		Packet length, AUDIO_FEEDBACK_SIZE
+ * @return		Bytes written
+ **********************************************************************/
+uint32_t USB_WriteEP(uint32_t EPNum, uint8_t *pData, uint32_t cnt)
+{
+	if ((EPNum != ADC_EP_FB) || (cnt != AUDIO_FEEDBACK_SIZE)) {
+		host_Fail("wrong feedback write");
+	}
+	memcpy(host_fb, pData, cnt);
+	host_fbwrites++;
+	return cnt;
+}
+
+/*********************************************************************//**
+ * @brief		Sample of the test tone sent by the host
+ * @param[in]	idx		Stream sample index
+ * @return		Sample
+ **********************************************************************/
+static int32_t host_Tone(uint32_t idx)
+{
+	return host_tone[(idx * HOST_TONE_STEP) & (HOST_TONE_SIZE - 1)];
+}
+
+/*********************************************************************//**
+ * @brief		DAC samples played at the start of a frame
+ * @param[in]	frame	Frame number
+ * @return		Samples
+ **********************************************************************/
+static uint32_t host_Played(uint32_t frame)
+{
+	return (uint32_t)floor(frame * host_dacrate);
+}
+
+/*********************************************************************//**
+ * @brief		Player position for the feedback measure: samples played
+ * 				by the DAC at the current frame
+ * @param[in]	arg		Not used
+ * @return		Samples
+ **********************************************************************/
+static uint32_t host_Position(void *arg)
+{
+	return host_Played(host_frame);
+}
+
+/*********************************************************************//**
+ * @brief		Check the samples interpolated from the last input block
+ * 				against a double precision polyphase FIR on the tone
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_CheckFir(void)
+{
+	uint32_t end, n, k, t;
+	double acc;
+	int32_t err;
+
+	// The last block read ends at the read position of the ring
+	end = ADC_Stream.tail / 2;
+	for (n = 0; n < RESAMPLE_BLOCK; n++) {
+		for (k = 0; k < RESAMPLE_L; k++) {
+			acc = 0;
+			for (t = 0; t < RESAMPLE_TAPS / RESAMPLE_L; t++) {
+				acc += host_coeffs[k + t * RESAMPLE_L]
+					* host_Tone(end - RESAMPLE_BLOCK + n - t);
+			}
+			err = Resampler.up[1 + n * RESAMPLE_L + k] - (int32_t)floor(acc);
+			if (err < 0) {
+				err = -err;
+			}
+			if (err > host_firerr) {
+				host_firerr = err;
+			}
+		}
+	}
+	if (host_firerr > HOST_MAX_FIR_ERR) {
+		host_Fail("interpolated samples differ from the reference FIR");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Player refill of one block: resampler output, then checks
+ * 				of the interpolator and of the continuity of the tone
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Block(void)
+{
+	uint32_t i;
+	int32_t y, r;
+	double c;
+
+	Resample_Process(&Resampler, host_out, PLAY_BLOCK);
+	if (host_frame < HOST_WARMUP) {
+		host_silent = Resampler.Silent;
+		host_y2 = host_out[PLAY_BLOCK - 2];
+		host_y1 = host_out[PLAY_BLOCK - 1];
+		return;
+	}
+	if (Resampler.Silent != host_silent) {
+		host_Fail("silence in the output");
+	}
+	host_CheckFir();
+
+	// A tone resampled without a gap: y[m+1] + y[m-1] = 2cos(w) y[m]
+	c = 2.0 * cos(2.0 * M_PI * HOST_TONE_STEP / HOST_TONE_SIZE
+			* Resampler.step / RESAMPLE_STEP);
+	for (i = 0; i < PLAY_BLOCK; i++) {
+		y = host_out[i];
+		r = (int32_t)fabs(y + host_y2 - c * host_y1);
+		if (r > host_residual) {
+			host_residual = r;
+		}
+		host_y2 = host_y1;
+		host_y1 = y;
+	}
+	host_checked += PLAY_BLOCK;
+	if (host_residual > HOST_MAX_RESIDUAL) {
+		host_Fail("output discontinuity");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Host side of a frame: poll the feedback endpoint in its
+ * 				own phase, then send the packet of the frame
+ * @param[in]	follow	Send at the feedback rate, else at the nominal one
+ * @param[in,out]	fb	Feedback value in use (10.14)
+ * @param[in,out]	acc	Fraction of a sample carried over (.14)
+ * @return		None
+ **********************************************************************/
+static void host_Send(uint32_t follow, uint32_t *fb, uint32_t *acc)
+{
+	uint32_t n, i;
+	int32_t v;
+
+	if ((host_frame & ((1 << FB_SHIFT) - 1)) == HOST_FB_PHASE) {
+		if (follow) {
+			*fb = host_fb[0] | (host_fb[1] << 8) | (host_fb[2] << 16);
+		}
+	}
+	*acc += *fb;
+	n = *acc >> 14;
+	*acc -= n << 14;
+	if ((n * 2) > P_MAX) {
+		host_Fail("feedback beyond the packet size");
+	}
+	for (i = 0; i < n; i++) {
+		v = host_Tone(host_sent++);
+		host_pkt[2 * i] = v & 0xFF;
+		host_pkt[2 * i + 1] = (v >> 8) & 0xFF;
+	}
+	host_pktlen = n * 2;
+}
+
+/*********************************************************************//**
+ * @brief		Run one scenario: stream start, then frames for
+ * 				HOST_SECONDS, the player refilled at the DAC rate
+ * @param[in]	sc		Scenario
+ * @return		None
+ **********************************************************************/
+static void host_Run(const HOST_SCENARIO_Type *sc)
+{
+	uint32_t frames, block, fb, acc, settle;
+	double fbsum, devsum, fbppm, ratioppm, expect;
+
+	host_dacrate = P_S * (1.0 + sc->Drift * 1e-6);
+	host_frame = 0;
+	host_sent = 0;
+	host_pktlen = 0;
+	host_fbwrites = 0;
+	host_checked = 0;
+	host_residual = 0;
+	host_firerr = 0;
+	host_cls = NULL;
+	memset(&ADC_Stream, 0, sizeof(ADC_Stream));
+	ADC_Init(host_Position, NULL);
+	if (host_cls == NULL) {
+		host_Fail("class not registered");
+	}
+	Resampler.audio = &ADC_Dev;
+	if (Resample_Init(&Resampler) != SUCCESS) {
+		host_Fail("Resample_Init");
+	}
+
+	// Player started with its two blocks, the stream by the host
+	Resample_Process(&Resampler, host_out, PLAY_BLOCK);
+	Resample_Process(&Resampler, host_out, PLAY_BLOCK);
+	block = 1;
+	host_cls->Event(host_cls->arg, USBDEV_EVT_CONFIGURE, 1);
+	host_cls->Event(host_cls->arg, USBDEV_EVT_INTERFACE, ADC_Stream.IF | (1 << 8));
+	fb = AUDIO_FEEDBACK_VALUE(DATA_FREQ);
+	acc = 0;
+
+	frames = HOST_SECONDS * 1000;
+	settle = frames - HOST_SETTLE * 1000;
+	fbsum = 0;
+	devsum = 0;
+	for (host_frame = 0; host_frame < frames; host_frame++) {
+		// Blocks whose refill is due before this SOF: the other block ends
+		while ((block * PLAY_BLOCK) <= host_Played(host_frame)) {
+			host_Block();
+			block++;
+		}
+		host_cls->Event(host_cls->arg, USBDEV_EVT_SOF, host_frame & 0x7FF);
+		host_Send(sc->Follow, &fb, &acc);
+		if (host_frame >= settle) {
+			fbsum += ADC_Stream.Feedback;
+			devsum += Resampler.Deviation;
+		}
+	}
+
+	if (host_fbwrites != frames) {
+		host_Fail("feedback not loaded on each SOF");
+	}
+	if (ADC_Stream.Underruns != 0) {
+		host_Fail("underrun");
+	}
+	if (ADC_Stream.Overruns != 0) {
+		host_Fail("overrun");
+	}
+	if (ADC_Stream.Missed > 1) {
+		// Only the first SOF, before the first packet
+		host_Fail("packets missed");
+	}
+	if (host_checked < (uint32_t)((frames - HOST_WARMUP) * host_dacrate) - 2 * PLAY_BLOCK) {
+		host_Fail("output not checked");
+	}
+	fbppm = (fbsum / HOST_SETTLE / 1000 / (1 << 14) / host_dacrate - 1.0) * 1e6;
+	ratioppm = devsum / HOST_SETTLE / 1000 / RESAMPLE_STEP * 1e6;
+	if (sc->Follow) {
+		// Both controls agree on Target: the ratio stays at 1
+		if (fabs(fbppm) > HOST_MAX_FB_PPM) {
+			host_Fail("feedback away from the DAC rate");
+		}
+		expect = 0;
+	} else {
+		// Input per output sample: nominal rate / DAC rate
+		expect = (1.0 / (1.0 + sc->Drift * 1e-6) - 1.0) * 1e6;
+	}
+	if (fabs(ratioppm - expect) > HOST_MAX_RATIO_PPM) {
+		host_Fail("resampler ratio away from the drift");
+	}
+	printf("%-17s %+5d %+9.2f %+9.2f %6u %6u %6u %4u %4u %5u\n",
+			sc->Name, (int)sc->Drift, fbppm, ratioppm,
+			(unsigned)ADC_Stream.LevelMin, (unsigned)ADC_Stream.LevelMax,
+			(unsigned)host_residual, (unsigned)host_firerr,
+			(unsigned)ADC_Stream.Underruns, (unsigned)ADC_Stream.Overruns);
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < HOST_TONE_SIZE; i++) {
+		host_tone[i] = (q15_t)floor(HOST_TONE_AMPL * sin(2.0 * M_PI * i / HOST_TONE_SIZE) + 0.5);
+	}
+	// Q15 coefficients read back from the resampler's FIR instance
+	Resampler.audio = &ADC_Dev;
+	ADC_Stream.Target = S_T;
+	ADC_Dev.Stream = &ADC_Stream;
+	if (Resample_Init(&Resampler) != SUCCESS) {
+		host_Fail("Resample_Init");
+	}
+	for (i = 0; i < RESAMPLE_TAPS; i++) {
+		host_coeffs[i] = Resampler.fir.pCoeffs[i] / 32768.0;
+	}
+
+	printf("audio_host: %u s per scenario, feedback every %u frames\n",
+			HOST_SECONDS, 1 << FB_SHIFT);
+	printf("scenario          drift  fb (ppm) ratio ppm lvlmin lvlmax resid  fir undr ovrun\n");
+	for (i = 0; i < sizeof(host_scenario) / sizeof(host_scenario[0]); i++) {
+		host_Run(&host_scenario[i]);
+	}
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,155 @@
+/**********************************************************************
+* $Id$		audio_resample.c			2011-03-09
+*//**
+* @file		audio_resample.c
+* @brief	Fractional resampler between the USB audio stream and the
+* 			player: CMSIS DSP Q15 FIR interpolator then linear
+* 			interpolation, ratio controlled by the stream level
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "audio_resample.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @addtogroup USBDEV_USBAudio
+ * @{
+ */
+
+/** Level average: weight of a new level 1/2^n (64 blocks: 32ms), kept
+ * with n more fraction bits so that it has no dead band */
+#define RESAMPLE_LEVEL_AVG	6
+/** Proportional term: step per sample of level error is 2^(8-n), about
+ * 4ppm: a larger gain would be heard as flutter */
+#define RESAMPLE_KP_SHIFT	8
+/** Integral term: step per sample of level error per block is 2^(4-n) */
+#define RESAMPLE_KI_SHIFT	19
+
+/** Low pass at 0.45 of the input rate, gain RESAMPLE_L: Blackman
+ * windowed sinc, symmetric (time reversed order is the same) */
+static const q15_t resample_coeffs[RESAMPLE_TAPS] = {
+	0, -8, -6, 69, 250, 434, 341, -357,
+	-1692, -3030, -3044, -257, 5989, 14723, 23363, 28760,
+	28760, 23363, 14723, 5989, -257, -3044, -3030, -1692,
+	-357, 341, 434, 250, 69, -6, -8, 0
+};
+
+static void resample_Refill(RESAMPLE_Type *rs);
+
+/*********************************************************************//**
+ * @brief		Read the next input block from the stream (completed with
+ * 				silence if the stream does not have it), interpolate it,
+ * 				then update the step from the stream level
+ * @param[in]	rs		point to RESAMPLE_Type structure
+ * @return 		None
+ **********************************************************************/
+static void resample_Refill(RESAMPLE_Type *rs)
+{
+	USBDEV_AUDIO_STREAM_Type *s = rs->audio->Stream;
+	uint32_t i, n;
+	int32_t err, dev;
+
+	rs->up[0] = rs->up[RESAMPLE_L * RESAMPLE_BLOCK];
+	n = USB_AudioRead(rs->audio, (uint8_t *)rs->in, sizeof(rs->in)) / 2;
+	for (i = n; i < RESAMPLE_BLOCK; i++) {
+		rs->in[i] = 0;
+	}
+	arm_fir_interpolate_q15(&rs->fir, rs->in, rs->up + 1, RESAMPLE_BLOCK);
+	if (n < RESAMPLE_BLOCK) {
+		// Not playing: the step is kept for the next start
+		rs->Silent++;
+		return;
+	}
+
+	// Same level as the feedback: both controls agree on Target
+	rs->level += (int32_t)((s->LevelMean << 8) / 2) - (rs->level >> RESAMPLE_LEVEL_AVG);
+	err = (rs->level >> RESAMPLE_LEVEL_AVG) - (int32_t)((s->Target << 8) / 2);
+	rs->integral += (err + 8) >> 4;
+	if (rs->integral > (RESAMPLE_MAX_DEV << RESAMPLE_KI_SHIFT)) {
+		rs->integral = RESAMPLE_MAX_DEV << RESAMPLE_KI_SHIFT;
+	} else if (rs->integral < -(RESAMPLE_MAX_DEV << RESAMPLE_KI_SHIFT)) {
+		rs->integral = -(RESAMPLE_MAX_DEV << RESAMPLE_KI_SHIFT);
+	}
+	dev = (err >> RESAMPLE_KP_SHIFT) + (rs->integral >> RESAMPLE_KI_SHIFT);
+	if (dev > RESAMPLE_MAX_DEV) {
+		dev = RESAMPLE_MAX_DEV;
+	} else if (dev < -RESAMPLE_MAX_DEV) {
+		dev = -RESAMPLE_MAX_DEV;
+	}
+	rs->Deviation = dev;
+	rs->step = RESAMPLE_STEP + dev;
+}
+
+/*********************************************************************//**
+ * @brief		Initialize resampler: ratio 1, empty input
+ * @param[in]	rs		point to RESAMPLE_Type structure, configuration
+ * 				fields must be filled
+ * @return 		ERROR if the FIR interpolator parameters do not fit,
+ * 				otherwise SUCCESS
+ **********************************************************************/
+Status Resample_Init(RESAMPLE_Type *rs)
+{
+	uint32_t i;
+
+	if (arm_fir_interpolate_init_q15(&rs->fir, RESAMPLE_L, RESAMPLE_TAPS,
+			(q15_t *)resample_coeffs, rs->state, RESAMPLE_BLOCK) != ARM_MATH_SUCCESS) {
+		return ERROR;
+	}
+	for (i = 0; i <= RESAMPLE_L * RESAMPLE_BLOCK; i++) {
+		rs->up[i] = 0;
+	}
+	// First output sample reads the first block
+	rs->phase = (RESAMPLE_L * RESAMPLE_BLOCK) << 16;
+	rs->step = RESAMPLE_STEP;
+	rs->level = (int32_t)((rs->audio->Stream->Target << 8) / 2) << RESAMPLE_LEVEL_AVG;
+	rs->integral = 0;
+	rs->Deviation = 0;
+	rs->Silent = 0;
+	return SUCCESS;
+}
+
+/*********************************************************************//**
+ * @brief		Produce output samples, linear interpolation between the
+ * 				interpolated samples around the current position
+ * @param[in]	rs		point to RESAMPLE_Type structure
+ * @param[in]	dst		q15 samples destination
+ * @param[in]	n		number of samples
+ * @return 		None
+ **********************************************************************/
+void Resample_Process(RESAMPLE_Type *rs, q15_t *dst, uint32_t n)
+{
+	uint32_t i, idx;
+	int32_t a, b;
+
+	for (i = 0; i < n; i++) {
+		idx = rs->phase >> 16;
+		if (idx >= RESAMPLE_L * RESAMPLE_BLOCK) {
+			resample_Refill(rs);
+			rs->phase -= (RESAMPLE_L * RESAMPLE_BLOCK) << 16;
+			idx -= RESAMPLE_L * RESAMPLE_BLOCK;
+		}
+		a = rs->up[idx];
+		b = rs->up[idx + 1];
+		dst[i] = (q15_t)(a + (((b - a) * (int32_t)((rs->phase >> 1) & 0x7FFF)) >> 15));
+		rs->phase += rs->step;
+	}
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,77 @@
+/**********************************************************************
+* $Id$		audio_resample.h			2011-03-09
+*//**
+* @file		audio_resample.h
+* @brief	Fractional resampler between the USB audio stream and the
+* 			player: CMSIS DSP Q15 FIR interpolator then linear
+* 			interpolation, ratio controlled by the stream level
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef AUDIO_RESAMPLE_H_
+#define AUDIO_RESAMPLE_H_
+
+#include "lpc17xx_usbdev_audio.h"
+#include "arm_math.h"
+
+/** Interpolation factor of the FIR interpolator */
+#define RESAMPLE_L			4
+/** FIR interpolator taps, a multiple of RESAMPLE_L */
+#define RESAMPLE_TAPS		32
+/** Input samples per FIR interpolator call */
+#define RESAMPLE_BLOCK		16
+/** Nominal step in the interpolated samples (16.16): ratio 1 */
+#define RESAMPLE_STEP		((uint32_t)RESAMPLE_L << 16)
+/** Largest deviation of the step from RESAMPLE_STEP: 1% */
+#define RESAMPLE_MAX_DEV	((int32_t)(RESAMPLE_STEP / 100))
+
+/**
+ * @brief Fractional resampler, mono 16 bit. Input blocks read from the
+ * stream are interpolated by RESAMPLE_L (polyphase FIR), the output
+ * samples are taken between the interpolated ones at a fractional step.
+ *
+ * The step follows the level of the stream (PI control): when the host
+ * does not follow the feedback endpoint, the ratio absorbs the drift
+ * between its clock and the output clock instead of samples being
+ * dropped or repeated. When it does, the level stays at Target and the
+ * ratio at 1.
+ */
+typedef struct {
+	USBDEV_AUDIO_Type* audio;	/**< Configuration: audio class driver, Stream
+								 set, SampleBytes 2 */
+	q15_t in[RESAMPLE_BLOCK];	/**< Input block */
+	q15_t state[RESAMPLE_TAPS / RESAMPLE_L + RESAMPLE_BLOCK - 1];	/**< FIR
+								 interpolator state */
+	q15_t up[RESAMPLE_L * RESAMPLE_BLOCK + 1];	/**< Interpolated samples,
+								 up[0] is the last one of the previous block */
+	uint32_t phase;				/**< Position in up[] (16.16) */
+	uint32_t step;				/**< Step in up[] per output sample (16.16) */
+	int32_t level;				/**< Average stream level (samples, 24.8,
+								 times 2^RESAMPLE_LEVEL_AVG) */
+	int32_t integral;			/**< Integral of the level error (samples, 28.4) */
+	int32_t Deviation;			/**< Step - RESAMPLE_STEP: the ratio is
+								 1 + Deviation / RESAMPLE_STEP */
+	uint32_t Silent;			/**< Input blocks completed with silence */
+	arm_fir_interpolate_instance_q15 fir;	/**< FIR interpolator instance */
+} RESAMPLE_Type;
+
+Status Resample_Init(RESAMPLE_Type *rs);
+void Resample_Process(RESAMPLE_Type *rs, q15_t *dst, uint32_t n);
+
+#endif /* AUDIO_RESAMPLE_H_ */
@@ -82,11 +82,11 @@
 
 
 /* GPDMA ------------------------------- */
-//#define _GPDMA
+#define _GPDMA
 
 
 /* DAC ------------------------------- */
-//#define _DAC
+#define _DAC
 
 /* DAC ------------------------------- */
 //#define _ADC
@@ -103,8 +103,9 @@
 //#define _I2S
 
 /* USB device ------------------------------- */
-//#define _USBDEV
+#define _USBDEV
 //#define _USB_DMA
+#define _USBDEV_AUDIO
 
 /* QEI ------------------------------- */
 //#define _QEI
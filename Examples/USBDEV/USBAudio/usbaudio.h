@@ -16,13 +16,13 @@
 
 /* Audio Definitions */
 #define DATA_FREQ 32000                 /* Audio Data Frequency */
-#define P_S       32                    /* Packet Size */
-#if USB_DMA
-#define P_C       4                     /* Packet Count */
-#else
-#define P_C       1                     /* Packet Count */
-#endif
-#define B_S       (8*P_C*P_S)           /* Buffer Size */
+#define P_S       32                    /* Packet Size (Samples per Frame) */
+#define P_MAX     (2*(P_S+1))           /* Max Packet Size (Bytes): one more
+                                           Sample when the Host catches up */
+#define FB_SHIFT  5                     /* Feedback Period: 2^FB_SHIFT Frames */
+#define S_S       2048                  /* Stream Ring Size (Bytes): 32ms */
+#define S_T       768                   /* Stream Target Level (Bytes): 12ms */
+#define PLAY_BLOCK 64                   /* Player Block Size (Samples): 2ms */
 
 /* Push Button Definitions */
 // #define PBINT     0x00004000            /* P0.14 */
@@ -31,16 +31,4 @@
 #define LEDMSK    0x000000FF            /* P2.0..7 */
 
 /* Audio Demo Variables */
-extern uint8_t  Mute;                      /* Mute State */
 extern uint32_t Volume;                    /* Volume Level */
-extern uint16_t  VolCur;                    /* Volume Current Value */
-#if !USB_DMA
-extern uint32_t InfoBuf[P_C];              /* Packet Info Buffer */
-extern short DataBuf[B_S];              /* Data Buffer */
-#else
-extern uint32_t *InfoBuf;
-extern short *DataBuf;
-#endif
-extern uint16_t  DataOut;                   /* Data Out Index */
-extern uint16_t  DataIn;                    /* Data In Index */
-extern uint8_t   DataRun;                   /* Data Stream Run State */
@@ -21,10 +21,10 @@
  *----------------------------------------------------------------------------*/
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "audio.h"
-#include "usbcfg.h"
+#include "lpc17xx_usbdev_audio.h"
 #include "usbdesc.h"
+#include "adcuser.h"
+#include "usbaudio.h"
 
 
 /* USB Standard Device Descriptor */
@@ -63,7 +63,8 @@ const uint8_t USB_ConfigDescriptor[] = {
     AUDIO_STREAMING_INTERFACE_DESC_SIZE +
     AUDIO_FORMAT_TYPE_I_DESC_SZ(1)      +
     AUDIO_STANDARD_ENDPOINT_DESC_SIZE   +
-    AUDIO_STREAMING_ENDPOINT_DESC_SIZE
+    AUDIO_STREAMING_ENDPOINT_DESC_SIZE  +
+    AUDIO_STANDARD_ENDPOINT_DESC_SIZE
   ),
   0x02,                                 /* bNumInterfaces */
   0x01,                                 /* bConfigurationValue */
@@ -139,7 +140,7 @@ const uint8_t USB_ConfigDescriptor[] = {
   USB_INTERFACE_DESCRIPTOR_TYPE,        /* bDescriptorType */
   0x01,                                 /* bInterfaceNumber */
   0x01,                                 /* bAlternateSetting */
-  0x01,                                 /* bNumEndpoints */
+  0x02,                                 /* bNumEndpoints */
   USB_DEVICE_CLASS_AUDIO,               /* bInterfaceClass */
   AUDIO_SUBCLASS_AUDIOSTREAMING,        /* bInterfaceSubClass */
   AUDIO_PROTOCOL_UNDEFINED,             /* bInterfaceProtocol */
@@ -160,16 +161,17 @@ const uint8_t USB_ConfigDescriptor[] = {
   0x02,                                 /* bSubFrameSize */
   16,                                   /* bBitResolution */
   0x01,                                 /* bSamFreqType */
-  B3VAL(32000),                         /* tSamFreq */
+  B3VAL(DATA_FREQ),                     /* tSamFreq */
 /* Endpoint - Standard Descriptor */
   AUDIO_STANDARD_ENDPOINT_DESC_SIZE,    /* bLength */
   USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */
-  USB_ENDPOINT_OUT(3),                  /* bEndpointAddress */
-  USB_ENDPOINT_TYPE_ISOCHRONOUS,        /* bmAttributes */
-  WBVAL(64),                            /* wMaxPacketSize */
+  ADC_EP_OUT,                           /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_ISOCHRONOUS |
+  USB_ENDPOINT_SYNC_ASYNCHRONOUS,       /* bmAttributes */
+  WBVAL(P_MAX),                         /* wMaxPacketSize */
   0x01,                                 /* bInterval */
   0x00,                                 /* bRefresh */
-  0x00,                                 /* bSynchAddress */
+  ADC_EP_FB,                            /* bSynchAddress */
 /* Endpoint - Audio Streaming */
   AUDIO_STREAMING_ENDPOINT_DESC_SIZE,   /* bLength */
   AUDIO_ENDPOINT_DESCRIPTOR_TYPE,       /* bDescriptorType */
@@ -177,6 +179,15 @@ const uint8_t USB_ConfigDescriptor[] = {
   0x00,                                 /* bmAttributes */
   0x00,                                 /* bLockDelayUnits */
   WBVAL(0x0000),                        /* wLockDelay */
+/* Endpoint - Standard Descriptor, Feedback */
+  AUDIO_STANDARD_ENDPOINT_DESC_SIZE,    /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */
+  ADC_EP_FB,                            /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_ISOCHRONOUS,        /* bmAttributes */
+  WBVAL(AUDIO_FEEDBACK_SIZE),           /* wMaxPacketSize */
+  0x01,                                 /* bInterval */
+  FB_SHIFT,                             /* bRefresh */
+  0x00,                                 /* bSynchAddress */
 /* Terminator */
   0                                     /* bLength */
 };
@@ -241,4 +252,6 @@ const uint8_t USB_StringDescriptor[] = {
   '0',0,
   '0',0,
   '0',0,
+/* Terminator */
+  0                                  /* bLength */
 };
@@ -17,35 +17,62 @@
 #include "LPC17xx.h"                        /* LPC17xx definitions */
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "usbcfg.h"
-#include "usbhw.h"
-#include "usbcore.h"
+#include "lpc17xx_usbdev_audio.h"
+#include "lpc17xx_dac.h"
+#include "lpc17xx_gpdma.h"
+#include "usbdesc.h"
+#include "adcuser.h"
 #include "usbaudio.h"
+#include "audio_resample.h"
 
 /* Example group ----------------------------------------------------------- */
 /** @defgroup USBDEV_USBAudio	USBAudio
  * @ingroup USBDEV_Examples
  * @{
  */
-uint8_t  Mute;                                 /* Mute State */
+#define PLAY_DMA_CH  0                          /* Player GPDMA Channel */
+
 uint32_t Volume;                               /* Volume Level */
+uint16_t  PotVal;                               /* Potenciometer Value */
 
-#if USB_DMA
-uint32_t *InfoBuf = (uint32_t *)(DMA_BUF_ADR);
-short *DataBuf = (short *)(DMA_BUF_ADR + 4*P_C);
-#else
-uint32_t InfoBuf[P_C];
-short DataBuf[B_S];                         /* Data Buffer */
-#endif
+/* DAC player: GPDMA plays two blocks of PLAY_BLOCK samples in turn */
+DAC_STREAM_Type Player;
+uint32_t PlayerBuf[2*PLAY_BLOCK];
+GPDMA_LLI_Type PlayerLLI[2];
 
-uint16_t  DataOut;                              /* Data Out Index */
-uint16_t  DataIn;                               /* Data In Index */
+/* Resampler between the USB stream and the player */
+RESAMPLE_Type Resampler;
+
+/* USB device configuration */
+const USBDEV_CFG_Type USB_Cfg = {
+  USB_DeviceDescriptor,
+  USB_ConfigDescriptor,
+  USB_StringDescriptor,
+  0,                                            /* EventMask */
+  NULL,                                         /* Event */
+  0,                                            /* DMAEndpoints */
+  0                                             /* DeferMask */
+};
+
+
+/*
+ * USB Interrupt Handler
+ */
+
+void USB_IRQHandler (void)
+{
+  USB_IntHandler();
+}
 
-uint8_t   DataRun;                              /* Data Stream Run State */
-uint16_t  PotVal;                               /* Potenciometer Value */
-uint32_t  VUM;                                  /* VU Meter */
-uint32_t  Tick;                                 /* Time Tick */
+
+/*
+ * GPDMA Interrupt Handler: refill of the DAC player
+ */
+
+void DMA_IRQHandler (void)
+{
+  DAC_StreamDMAHandler(&Player);
+}
 
 
 /*
@@ -66,65 +93,59 @@ void get_potval (void) {
 
 
 /*
- * Timer Counter 0 Interrupt Service Routine
- *   executed each 31.25us (32kHz frequency)
+ * Player Generator
+ *   Called by the DAC player for each block (GPDMA interrupt): samples
+ *   of the USB stream through the resampler, volume and mute applied
  */
 
-void TIMER0_IRQHandler(void)
-{
+void Player_Generator (void *arg, int16_t *dst, uint32_t n) {
+  uint32_t i;
   long  val;
-  uint32_t cnt;
 
-  if (DataRun) {                            /* Data Stream is running */
-    val = DataBuf[DataOut];                 /* Get Audio Sample */
-    cnt = (DataIn - DataOut) & (B_S - 1);   /* Buffer Data Count */
-    if (cnt == (B_S - P_C*P_S)) {           /* Too much Data in Buffer */
-      DataOut++;                            /* Skip one Sample */
-    }
-    if (cnt > (P_C*P_S)) {                  /* Still enough Data in Buffer */
-      DataOut++;                            /* Update Data Out Index */
-    }
-    DataOut &= B_S - 1;                     /* Adjust Buffer Out Index */
-    if (val < 0) VUM -= val;                /* Accumulate Neg Value */
-    else         VUM += val;                /* Accumulate Pos Value */
-    val  *= Volume;                         /* Apply Volume Level */
+  Resample_Process(&Resampler, dst, n);
+  for (i = 0; i < n; i++) {
+    val  = dst[i];
+    val *= Volume;                          /* Apply Volume Level */
     val >>= 16;                             /* Adjust Value */
-    val  += 0x8000;                         /* Add Bias */
-    val  &= 0xFFFF;                         /* Mask Value */
-  } else {
-    val = 0x8000;                           /* DAC Middle Point */
+    if (ADC_Dev.Mute) {
+      val = 0;                              /* DAC Middle Point */
+    }
+    dst[i] = (int16_t)val;
   }
+}
 
-  if (Mute) {
-    val = 0x8000;                           /* DAC Middle Point */
-  }
 
-  LPC_DAC->DACR = val & 0xFFC0;             /* Set Speaker Output */
+/*
+ * Player Position
+ *   Samples played by the DAC since the start of the player, for the
+ *   feedback measure (USB interrupt). The block being played (GPDMA
+ *   source address) tells whether the refill of the other block is
+ *   still pending.
+ */
 
-  if ((Tick++ & 0x03FF) == 0) {             /* On every 1024th Tick */
-    get_potval();                           /* Get Potenciometer Value */
-    if (VolCur == 0x8000) {                 /* Check for Minimum Level */
-      Volume = 0;                           /* No Sound */
-    } else {
-      Volume = VolCur * PotVal;             /* Chained Volume Level */
-    }
-    val = VUM >> 20;                        /* Scale Accumulated Value */
-    VUM = 0;                                /* Clear VUM */
-    if (val > 7) val = 7;                   /* Limit Value */
-  }
+uint32_t Player_Position (void *arg) {
+  DAC_STREAM_Type *p = (DAC_STREAM_Type *)arg;
+  uint32_t idx, pos;
 
-  LPC_TIM0->IR = 1;                         /* Clear Interrupt Flag */
+  NVIC_DisableIRQ(DMA_IRQn);
+  idx = (GPDMA_GetSrcAddr(p->DMAChannel) - (uint32_t)p->buf) / 4;
+  if (idx >= 2*PLAY_BLOCK) {
+    idx = 0;                                /* End of block 1, LLI not reloaded */
+  }
+  pos = (p->blocks - 2) * PLAY_BLOCK + (idx % PLAY_BLOCK);
+  if ((idx / PLAY_BLOCK) == p->last) {
+    pos += PLAY_BLOCK;                      /* Terminal count not served yet */
+  }
+  NVIC_EnableIRQ(DMA_IRQn);
+  return (pos);
 }
 
 
-
 /*****************************************************************************
 **   Main Function  main()
 ******************************************************************************/
 int main (void)
 {
-  volatile uint32_t pclkdiv, pclk;
-
 //  SystemInit();
 
   LPC_PINCON->PINSEL1 &=~((0x03<<18)|(0x03<<20));
@@ -136,38 +157,38 @@ int main (void)
 
   LPC_ADC->ADCR = 0x00200E04;		/* ADC: 10-bit AIN2 @ 4MHz */
   LPC_DAC->DACR = 0x00008000;		/* DAC Output set to Middle Point */
-
-  /* By default, the PCLKSELx value is zero, thus, the PCLK for
-  all the peripherals is 1/4 of the SystemFrequency. */
-  /* Bit 2~3 is for TIMER0 */
-  pclkdiv = (LPC_SC->PCLKSEL0 >> 2) & 0x03;
-  switch ( pclkdiv )
-  {
-	case 0x00:
-	default:
-	  pclk = SystemCoreClock/4;
-	break;
-	case 0x01:
-	  pclk = SystemCoreClock;
-	break;
-	case 0x02:
-	  pclk = SystemCoreClock/2;
-	break;
-	case 0x03:
-	  pclk = SystemCoreClock/8;
-	break;
-  }
-
-  LPC_TIM0->MR0 = pclk/DATA_FREQ - 1;	/* TC0 Match Value 0 */
-  LPC_TIM0->MCR = 3;					/* TCO Interrupt and Reset on MR0 */
-  LPC_TIM0->TCR = 1;					/* TC0 Enable */
-  NVIC_EnableIRQ(TIMER0_IRQn);
-
-  USB_Init();				/* USB Initialization */
+  DAC_Init(LPC_DAC);
+
+  ADC_Init(Player_Position, &Player);	/* Audio Device Class Initialization */
+  Resampler.audio = &ADC_Dev;
+  Resample_Init(&Resampler);
+
+  /* DAC player at DATA_FREQ, fed by the resampler */
+  NVIC_DisableIRQ(DMA_IRQn);
+  GPDMA_Init();
+  Player.DMAChannel = PLAY_DMA_CH;
+  Player.BlockSize = PLAY_BLOCK;
+  Player.Rate = DATA_FREQ;
+  Player.buf = PlayerBuf;
+  Player.lli = PlayerLLI;
+  Player.Generator = Player_Generator;
+  Player.arg = NULL;
+  DAC_StreamInit(LPC_DAC, &Player);
+  NVIC_EnableIRQ(DMA_IRQn);
+  DAC_StreamStart(LPC_DAC, &Player);
+
+  USB_Init(&USB_Cfg);		/* USB Initialization */
   USB_Connect(TRUE);		/* USB Connect */
 
   /********* The main Function is an endless loop ***********/
-  while( 1 );
+  while (1) {
+    get_potval();                           /* Get Potenciometer Value */
+    if (ADC_Dev.VolCur == 0x8000) {         /* Check for Minimum Level */
+      Volume = 0;                           /* No Sound */
+    } else {
+      Volume = ADC_Dev.VolCur * PotVal;     /* Chained Volume Level */
+    }
+  }
 }
 
 /******************************************************************************
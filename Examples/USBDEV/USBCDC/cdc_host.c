@@ -0,0 +1,611 @@
+/**********************************************************************
+* $Id$		cdc_host.c			2011-03-09
+*//**
+* @file		cdc_host.c
+* @brief	Host simulation of the USB to UART bridge of the USBCDC
+* 			example: the example, the USB, CDC and GPDMA drivers run
+* 			unmodified against cdcsim.c and usbsim.c. An external device
+* 			sends to UART1 back to back while the host sends bulk OUT
+* 			packets faster than the UART can transmit them, with some
+* 			short packets. The host stops taking the bulk IN data for a
+* 			while in some scenarios, the device pauses in others. Both
+* 			byte streams are checked in order; prints the line loads and
+* 			the flow control counters of each scenario.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_usbdev_cdc.h"
+#include "usbdesc.h"
+#include "cdcuser.h"
+#include "usbsim.h"
+#include "cdcsim.h"
+
+/* Test parameters */
+#define HOST_RUN_MS			300		/* Traffic of a scenario */
+#define HOST_DRAIN_MS		200		/* Then everything is delivered, TxBuf at 115200 */
+#define HOST_ADDR			5		/* Address given to the device */
+#define HOST_IRQ_MAX		64		/* Interrupt entries for one event */
+#define HOST_RETRY_MAX		100		/* NAKs of one control stage */
+#define HOST_TOKEN_CYCLES	(CDCSIM_CCLK / 20000)	/* Bulk tokens, 50us */
+#define HOST_SOF_CYCLES		(CDCSIM_CCLK / 1000)	/* Frames, 1ms */
+#define HOST_SHORT_EVERY	29		/* OUT packets between short ones */
+#define HOST_LOAD_MIN		99.0	/* Line load without stalls or pauses, % */
+
+/* From the example */
+extern const USBDEV_CFG_Type USB_Cfg;
+void USB_IRQHandler(void);
+void DMA_IRQHandler(void);
+void UART1_IRQHandler(void);
+void VCOM_Init(void);
+void VCOM_CheckSerialState(void);
+
+uint32_t SystemCoreClock = CDCSIM_CCLK;
+
+/**
+ * @brief Test scenario, times in ms
+ */
+typedef struct {
+	const char *name;
+	uint32_t baud;			/* Line coding sent to the device */
+	uint32_t skid;			/* Characters the device sends after RTS goes inactive */
+	uint32_t stall;			/* Host takes no bulk IN data for this time... */
+	uint32_t pause;			/* ...or the device sends nothing for this time... */
+	uint32_t period;		/* ...every period */
+} HOST_SCENARIO_Type;
+
+static const HOST_SCENARIO_Type host_scenario[] = {
+	{"115200",			115200,	0,	0,	0,	0},
+	{"460800",			460800,	0,	0,	0,	0},
+	{"921600",			921600,	0,	0,	0,	0},
+	{"921600 pauses",	921600,	0,	0,	3,	40},
+	{"921600 stalls",	921600,	4,	20,	0,	100},
+	{"921600 stalls 15",921600,	15,	20,	0,	100},
+};
+
+/* Host side state */
+static uint8_t host_addr;
+static uint32_t host_rxseq;			/* Next device character expected on bulk IN */
+static uint32_t host_outseq;		/* Next byte sent on bulk OUT */
+static uint32_t host_txseq;			/* Next byte expected from UART1 */
+static uint32_t host_outpkt;		/* OUT packets sent */
+static uint32_t host_outopen;		/* Last OUT packet full: transfer not ended */
+
+/* Scenario results */
+static struct {
+	uint32_t OutNak;
+	uint32_t ShortOut;
+} host;
+
+/*********************************************************************//**
+ * @brief		Stub: the peripheral power is not modelled
+ **********************************************************************/
+void CLKPWR_ConfigPPWR(uint32_t PPType, FunctionalState NewState)
+{
+	(void)PPType;
+	(void)NewState;
+}
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Stop the test
+ * @param[in]	msg		Reason
+ * @return		None
+ **********************************************************************/
+static void host_Fail(const char *msg)
+{
+	fprintf(stderr, "FAIL: %s (%.3f ms)\n", msg,
+			(double)CDCSIM_Now() / (CDCSIM_CCLK / 1000));
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Byte number seq of the host bulk OUT stream
+ * @param[in]	seq		Byte number
+ * @return		Byte
+ **********************************************************************/
+static uint8_t host_OutByte(uint32_t seq)
+{
+	return (uint8_t)((seq * 7) + (seq >> 8) + 0x5A);
+}
+
+/*********************************************************************//**
+ * @brief		Service the USB interrupt while it is requested
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Irq(void)
+{
+	uint32_t n;
+
+	for (n = 0; USBSIM_IrqPending(); n++) {
+		if (n == HOST_IRQ_MAX) {
+			host_Fail("USB interrupt request not cleared");
+		}
+		USB_IRQHandler();
+	}
+	USBSIM_Check();
+}
+
+/*********************************************************************//**
+ * @brief		Service the GPDMA, UART1 and USB interrupts while they
+ * 				are requested
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Service(void)
+{
+	uint32_t n;
+
+	for (n = 0; CDCSIM_DmaIrqPending(); n++) {
+		if (n == HOST_IRQ_MAX) {
+			host_Fail("GPDMA interrupt request not cleared");
+		}
+		DMA_IRQHandler();
+	}
+	for (n = 0; CDCSIM_UartIrqPending(); n++) {
+		if (n == HOST_IRQ_MAX) {
+			host_Fail("UART1 interrupt request not cleared");
+		}
+		UART1_IRQHandler();
+	}
+	host_Irq();
+}
+
+/*********************************************************************//**
+ * @brief		Control transfer to endpoint 0, stage by stage with the
+ * 				interrupt serviced after each token
+ * @param[in]	setup	Setup packet
+ * @param[in,out]	data	Data stage, wLength bytes plus a packet
+ * @return		Data stage length, -1 on error
+ **********************************************************************/
+static int host_Control(const uint8_t *setup, uint8_t *data)
+{
+	uint32_t len, done, n, tries;
+	int in, r;
+	uint8_t zlp[USB_MAX_PACKET0];
+
+	len = setup[6] | (setup[7] << 8);
+	in = (setup[0] & 0x80) != 0;
+	if (USBSIM_Setup(host_addr, setup) != USBSIM_ACK) {
+		return -1;
+	}
+	host_Irq();
+
+	for (done = 0; done < len; ) {
+		n = len - done;
+		if (n > USB_MAX_PACKET0) {
+			n = USB_MAX_PACKET0;
+		}
+		for (tries = 0; ; tries++) {
+			r = in ? USBSIM_In(host_addr, 0, data + done) :
+					USBSIM_Out(host_addr, 0, data + done, n);
+			host_Irq();
+			if ((r != USBSIM_NAK) || (tries == HOST_RETRY_MAX)) {
+				break;
+			}
+		}
+		if (r < 0) {
+			return -1;
+		}
+		if (in) {
+			done += r;
+			if (r < USB_MAX_PACKET0) {
+				break;							/* Short packet */
+			}
+		} else {
+			done += n;
+		}
+	}
+
+	for (tries = 0; ; tries++) {
+		r = in ? USBSIM_Out(host_addr, 0, NULL, 0) : USBSIM_In(host_addr, 0, zlp);
+		host_Irq();
+		if ((r != USBSIM_NAK) || (tries == HOST_RETRY_MAX)) {
+			break;
+		}
+	}
+	return (r == 0) ? (int)done : -1;
+}
+
+/*********************************************************************//**
+ * @brief		Build a setup packet
+ **********************************************************************/
+static void host_SetupPacket(uint8_t *s, uint8_t type, uint8_t req,
+							uint16_t value, uint16_t index, uint16_t len)
+{
+	s[0] = type;
+	s[1] = req;
+	s[2] = (uint8_t)value;
+	s[3] = (uint8_t)(value >> 8);
+	s[4] = (uint8_t)index;
+	s[5] = (uint8_t)(index >> 8);
+	s[6] = (uint8_t)len;
+	s[7] = (uint8_t)(len >> 8);
+}
+
+/*********************************************************************//**
+ * @brief		Bus reset and enumeration: descriptors checked against
+ * 				the example, address, configuration
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Enumerate(void)
+{
+	uint8_t setup[8];
+	uint8_t buf[512];
+	int n, total;
+
+	host_addr = 0;
+	USBSIM_BusReset();
+	host_Irq();
+
+	host_SetupPacket(setup, 0x80, 6, 0x0100, 0, 64);
+	n = host_Control(setup, buf);
+	if ((n != 18) || (memcmp(buf, USB_DeviceDescriptor, 18) != 0)) {
+		host_Fail("device descriptor");
+	}
+	host_SetupPacket(setup, 0x00, 5, HOST_ADDR, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_ADDRESS");
+	}
+	host_addr = HOST_ADDR;
+
+	host_SetupPacket(setup, 0x80, 6, 0x0200, 0, 9);
+	if (host_Control(setup, buf) != 9) {
+		host_Fail("configuration descriptor header");
+	}
+	total = buf[2] | (buf[3] << 8);
+	host_SetupPacket(setup, 0x80, 6, 0x0200, 0, total);
+	n = host_Control(setup, buf);
+	if ((n != total) || (memcmp(buf, USB_ConfigDescriptor, total) != 0)) {
+		host_Fail("configuration descriptor");
+	}
+
+	host_SetupPacket(setup, 0x00, 9, 1, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_CONFIGURATION");
+	}
+	if (!USB_Configuration) {
+		host_Fail("device not configured");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		SET_LINE_CODING, 8 data bits, no parity, 1 stop bit; the
+ * 				example reopens UART1 from its main loop
+ * @param[in]	baud	Rate
+ * @return		None
+ **********************************************************************/
+static void host_LineCoding(uint32_t baud)
+{
+	uint8_t setup[8];
+	uint8_t buf[USB_MAX_PACKET0];
+
+	buf[0] = (uint8_t)baud;
+	buf[1] = (uint8_t)(baud >> 8);
+	buf[2] = (uint8_t)(baud >> 16);
+	buf[3] = (uint8_t)(baud >> 24);
+	buf[4] = 0;
+	buf[5] = 0;
+	buf[6] = 8;
+	host_SetupPacket(setup, 0x21, CDC_SET_LINE_CODING, 0, USB_CDC_CIF_NUM, 7);
+	if (host_Control(setup, buf) != 7) {
+		host_Fail("SET_LINE_CODING");
+	}
+	if (USB_Task() != 1) {
+		host_Fail("line coding not applied by the main loop");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Character sent by UART1: the next byte of the bulk OUT
+ * 				stream
+ * @param[in]	byte	Character
+ * @param[in]	time	End of its stop bit
+ * @return		None
+ **********************************************************************/
+static void host_UartTx(uint8_t byte, uint64_t time)
+{
+	(void)time;
+	if ((host_txseq == host_outseq) || (byte != host_OutByte(host_txseq))) {
+		host_Fail("UART1 byte is not the next byte of the bulk OUT stream");
+	}
+	host_txseq++;
+}
+
+/*********************************************************************//**
+ * @brief		Start of frame, then the SERIAL_STATE notifications
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Frame(void)
+{
+	uint8_t buf[USB_MAX_PACKET0];
+	int r;
+
+	USBSIM_Frame();
+	host_Irq();
+	r = USBSIM_In(host_addr, CDC_CEP_IN & 0x0F, buf);
+	host_Irq();
+	if ((r == CDC_NOTIFICATION_SIZE) && ((buf[8] | (buf[9] << 8)) & CDC_SERIAL_STATE_OVERRUN)) {
+		host_Fail("UART1 overrun notified");
+	} else if ((r >= 0) && (r != CDC_NOTIFICATION_SIZE)) {
+		host_Fail("SERIAL_STATE notification length");
+	} else if ((r < 0) && (r != USBSIM_NAK)) {
+		host_Fail("interrupt IN token");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Bulk tokens of a 50us slot: one IN token unless stalled,
+ * 				one OUT token with the next packet of the stream if the
+ * 				host is sending, else with a zero length packet ending
+ * 				the transfer if its last packet was full
+ * @param[in]	in		Take the bulk IN data
+ * @param[in]	out		Send bulk OUT data
+ * @return		None
+ **********************************************************************/
+static void host_Tokens(uint32_t in, uint32_t out)
+{
+	uint8_t buf[CDC_MAX_PACKET];
+	uint32_t i, n;
+	int r;
+
+	if (in) {
+		r = USBSIM_In(host_addr, CDC_DEP_IN & 0x0F, buf);
+		host_Irq();
+		if (r >= 0) {
+			for (i = 0; i < (uint32_t)r; i++) {
+				if (buf[i] != CDCSIM_RxByte(host_rxseq)) {
+					host_Fail("bulk IN byte is not the next character of the device");
+				}
+				host_rxseq++;
+			}
+		} else if (r != USBSIM_NAK) {
+			host_Fail("bulk IN token");
+		}
+	}
+
+	if (!out && !host_outopen) {
+		return;
+	}
+	n = out ? CDC_MAX_PACKET : 0;			/* Else end the transfer */
+	if (out && ((host_outpkt % HOST_SHORT_EVERY) == HOST_SHORT_EVERY - 1)) {
+		n = 1 + (host_outpkt / HOST_SHORT_EVERY) % (CDC_MAX_PACKET - 1);
+	}
+	for (i = 0; i < n; i++) {
+		buf[i] = host_OutByte(host_outseq + i);
+	}
+	r = USBSIM_Out(host_addr, CDC_DEP_OUT, buf, n);
+	host_Irq();
+	if (r == USBSIM_ACK) {
+		host_outseq += n;
+		host_outpkt++;
+		host_outopen = (n == CDC_MAX_PACKET);
+		if (n < CDC_MAX_PACKET) {
+			host.ShortOut++;
+		}
+	} else if (r == USBSIM_NAK) {
+		host.OutNak++;
+	} else {
+		host_Fail("bulk OUT token");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		All device characters taken by the host and all bulk OUT
+ * 				bytes sent by UART1, both lines idle
+ * @param[in]	None
+ * @return		Non zero if drained
+ **********************************************************************/
+static int host_Drained(void)
+{
+	CDCSIM_STATS_Type st;
+
+	CDCSIM_GetStats(&st);
+	return (host_rxseq == st.RxChars - st.RxOverruns) && (host_txseq == host_outseq) &&
+			(CDCSIM_NextEvent() == ~(uint64_t)0);
+}
+
+/*********************************************************************//**
+ * @brief		Run a scenario: traffic, then drain, then report
+ * @param[in]	sc		Scenario
+ * @return		None
+ **********************************************************************/
+static void host_Run(const HOST_SCENARIO_Type *sc)
+{
+	CDCSIM_STATS_Type st0, stm, st1;
+	USBDEV_CDC_BRIDGE_Type br0;
+	uint64_t start, stop, end, now, t, ms, next_token, next_sof, next_phase;
+	uint32_t traffic, off, rx0, out0;
+	double window, rxload, txload;
+
+	memset(&host, 0, sizeof(host));
+	host_LineCoding(sc->baud);
+	CDCSIM_GetStats(&st0);
+	br0 = CDC_Bridge;
+	rx0 = host_rxseq;
+	out0 = host_outseq;
+	start = CDCSIM_Now();
+	ms = CDCSIM_CCLK / 1000;
+	stop = start + HOST_RUN_MS * ms;
+	end = stop + HOST_DRAIN_MS * ms;
+	CDCSIM_Sender(1, sc->skid);
+	traffic = 1;
+	off = 0;
+	next_token = start;
+	next_sof = start;
+	next_phase = (sc->period != 0) ? start + (sc->period - sc->stall - sc->pause) * ms : ~(uint64_t)0;
+
+	for (;;) {
+		now = CDCSIM_Now();
+		if (traffic && (now >= stop)) {
+			CDCSIM_GetStats(&stm);
+			CDCSIM_Sender(0, 0);
+			traffic = 0;
+			off = 0;
+			next_phase = ~(uint64_t)0;
+		}
+		if (!traffic && host_Drained()) {
+			break;
+		}
+		if (now >= end) {
+			host_Fail("bytes not delivered after the traffic stopped");
+		}
+
+		/* Host events due */
+		if (now >= next_phase) {
+			off = !off;
+			if (sc->pause != 0) {
+				CDCSIM_Sender(!off, sc->skid);
+			}
+			next_phase += (off ? (sc->stall + sc->pause) : (sc->period - sc->stall - sc->pause)) * ms;
+		}
+		if (now >= next_sof) {
+			host_Frame();
+			next_sof += HOST_SOF_CYCLES;
+		}
+		if (now >= next_token) {
+			host_Tokens(!(off && (sc->stall != 0)), traffic);
+			next_token += HOST_TOKEN_CYCLES;
+			if (next_token <= now) {
+				next_token = now + HOST_TOKEN_CYCLES;
+			}
+		}
+
+		/* Interrupts, then one pass of the main loop */
+		host_Service();
+		USB_Task();
+		VCOM_CheckSerialState();
+		host_Service();
+
+		/* Nothing to do until the next event: skip the idle loop */
+		if (!CDCSIM_DmaIrqPending() && !CDCSIM_UartIrqPending() && !USBSIM_IrqPending()) {
+			t = CDCSIM_NextEvent();
+			if (next_sof < t) {
+				t = next_sof;
+			}
+			if (next_token < t) {
+				t = next_token;
+			}
+			if (next_phase < t) {
+				t = next_phase;
+			}
+			if (traffic && (stop < t)) {
+				t = stop;
+			}
+			if (end < t) {
+				t = end;
+			}
+			CDCSIM_Advance(t);
+		}
+	}
+
+	CDCSIM_GetStats(&st1);
+	if (st1.Violations != 0) {
+		fprintf(stderr, "FAIL: %s\n", CDCSIM_Violation());
+		exit(1);
+	}
+	if (st1.RxOverruns != st0.RxOverruns) {
+		host_Fail("UART1 receive overrun");
+	}
+	if (CDC_Bridge.Errors != br0.Errors) {
+		host_Fail("bridge DMA errors");
+	}
+	if ((CDC_Bridge.InBytes - br0.InBytes != host_rxseq - rx0) ||
+			(CDC_Bridge.OutBytes - br0.OutBytes != host_outseq - out0)) {
+		host_Fail("bridge byte counters");
+	}
+
+	/* Loads over the traffic time, the drain excluded */
+	window = (double)(stop - start);
+	rxload = 100.0 * (double)(stm.RxBusy - st0.RxBusy) / window;
+	txload = 100.0 * (double)(stm.TxBusy - st0.TxBusy) / window;
+	if (txload < HOST_LOAD_MIN) {
+		host_Fail("UART1 transmit line not kept busy");
+	}
+	if ((CDC_Bridge.OutHolds == br0.OutHolds) || (host.OutNak == 0) || (host.ShortOut == 0)) {
+		host_Fail("bulk OUT flow control not exercised");
+	}
+	if (sc->stall != 0) {
+		if ((CDC_Bridge.RxHolds == br0.RxHolds) || (st1.RxWaits == st0.RxWaits)) {
+			host_Fail("UART receive flow control not exercised");
+		}
+	} else if ((sc->pause == 0) && (rxload < HOST_LOAD_MIN)) {
+		host_Fail("UART1 receive line not kept busy");
+	}
+
+	printf("%-17s %7u  %5.1f%%  %5.1f%%  %7u  %7u  %4u  %4u  %5u  %6u\n",
+			sc->name, (unsigned)CDCSIM_BitRate(), rxload, txload,
+			(unsigned)(host_rxseq - rx0), (unsigned)(host_outseq - out0),
+			(unsigned)(CDC_Bridge.RxHolds - br0.RxHolds),
+			(unsigned)(st1.RxWaits - st0.RxWaits),
+			(unsigned)(CDC_Bridge.OutHolds - br0.OutHolds), (unsigned)host.OutNak);
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+int main(void)
+{
+	USBSIM_STATS_Type ust;
+	CDCSIM_STATS_Type st;
+	uint32_t i;
+
+	USBSIM_Init();
+	CDCSIM_Init();
+	CDCSIM_OnTx(host_UartTx);
+	VCOM_Init();
+	USB_Init(&USB_Cfg);
+	USB_Connect(TRUE);
+	host_Enumerate();
+
+	printf("scenario              bit/s   rx line tx line  in bytes out bytes"
+			"  rx holds/waits  out holds/NAKs\n");
+	for (i = 0; i < sizeof(host_scenario) / sizeof(host_scenario[0]); i++) {
+		host_Run(&host_scenario[i]);
+	}
+
+	USBSIM_GetStats(&ust);
+	CDCSIM_GetStats(&st);
+	if (ust.Violations != 0) {
+		fprintf(stderr, "FAIL: %s\n", USBSIM_Violation());
+		return 1;
+	}
+	printf("%u register accesses, %u GPDMA bytes, %u linked list items\n",
+			(unsigned)st.Accesses, (unsigned)st.DmaBytes, (unsigned)st.DmaLinks);
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,981 @@
+/**********************************************************************
+* $Id$		cdcsim.c				2011-03-09
+*//**
+* @file		cdcsim.c
+* @brief	Host model of the UART side of the CDC bridge. The register
+* 			pages of UART1 and of the GPDMA controller are mapped without
+* 			access rights: each access of the drivers faults, is prepared
+* 			by the model, single-stepped and applied, as in usbsim.c whose
+* 			traps are chained behind these ones. The system control page
+* 			(PCLKSEL0 at its reset value) and the UART0 page (DMAREQSEL at
+* 			the address LPC17xx.h gives it) are plain memory.
+*
+* 			Time is counted in core clock cycles: CDCSIM_APB_WAIT per
+* 			register access, and the idle time the test loop skips with
+* 			CDCSIM_Advance(). UART1 has 16 byte receive and transmit
+* 			FIFOs and sends and receives characters of the length set
+* 			in LCR at the rate set by DLL/DLM and FDR. In DMA mode
+* 			(FCR bit 3) the receive FIFO requests GPDMA while it is not
+* 			empty, the transmit FIFO while it is not full; an enabled
+* 			channel serving the request moves the bytes at once. A
+* 			channel loads its next linked list item at the end of a
+* 			transfer, or is disabled with its addresses kept.
+*
+* 			The external device sends CDCSIM_RxByte() characters back
+* 			to back while it is on. It looks at RTS before each one: with
+* 			auto-RTS (MCR bit 6) RTS goes inactive once the receive FIFO
+* 			holds the trigger level, and the device still sends a number
+* 			of characters (skid) before it waits for RTS. A character
+* 			received with the FIFO full is lost and sets OE in LSR.
+* 			x86-64 Linux only.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "LPC17xx.h"
+#include "lpc17xx_gpdma.h"
+#include "cdcsim.h"
+
+/* Model parameters */
+#define SIM_PAGE_SZ			0x00001000UL
+#define SIM_USB_ADR			LPC_USB_BASE	/* Trapped by usbsim.c */
+#define SIM_PG_UART			0
+#define SIM_PG_DMA			1
+#define SIM_PAGE_NUM		2				/* Trapped pages, plain ones follow */
+#define SIM_PLAIN_NUM		2
+#define SIM_FIFO_SZ			16
+#define SIM_DMA_CH			8
+#define SIM_NEVER			(~(uint64_t)0)
+
+/* Register offsets */
+#define SIM_UART(reg)		offsetof(LPC_UART1_TypeDef, reg)
+#define SIM_DMA(reg)		offsetof(LPC_GPDMA_TypeDef, reg)
+#define SIM_DMACH(n, reg)	((LPC_GPDMACH0_BASE - LPC_GPDMA_BASE) + (n) * 0x20 + offsetof(LPC_GPDMACH_TypeDef, reg))
+
+/* UART1 register bits */
+#define SIM_LCR_DLAB		0x80
+#define SIM_LSR_RDR			0x01
+#define SIM_LSR_OE			0x02
+#define SIM_LSR_ERRORS		0x9E
+#define SIM_LSR_THRE		0x20
+#define SIM_LSR_TEMT		0x40
+#define SIM_FCR_EN			0x01
+#define SIM_FCR_RXRESET		0x02
+#define SIM_FCR_TXRESET		0x04
+#define SIM_FCR_DMA			0x08
+#define SIM_MCR_RTS			0x02
+#define SIM_MCR_AUTORTS		0x40
+#define SIM_MCR_AUTOCTS		0x80
+#define SIM_IER_THRE		0x02
+#define SIM_IER_RLS			0x04
+#define SIM_IER_RBR			0x01
+#define SIM_TER_TXEN		0x80
+
+/* GPDMA channel configuration fields */
+#define SIM_CFG_SRCPER(cfg)	(((cfg) >> 1) & 0x1F)
+#define SIM_CFG_DSTPER(cfg)	(((cfg) >> 6) & 0x1F)
+#define SIM_CFG_TYPE(cfg)	(((cfg) >> 11) & 0x07)
+#define SIM_CTRL_SIZE(ctrl)	((ctrl) & 0xFFF)
+#define SIM_CTRL_WIDTH(ctrl) (((ctrl) >> 18) & 0x3F)
+
+/* x86-64 trap flag and page fault error code */
+#define SIM_EFL_TF			0x00000100
+#define SIM_ERR_WRITE		0x00000002
+
+/** UART1 */
+typedef struct {
+	uint32_t lcr;
+	uint32_t ier;
+	uint32_t fcr;
+	uint32_t mcr;
+	uint32_t scr;
+	uint32_t acr;
+	uint32_t fdr;
+	uint32_t ter;
+	uint32_t dll;
+	uint32_t dlm;
+	uint32_t lsr;			/* Latched line status errors */
+	uint8_t rx[SIM_FIFO_SZ];
+	uint32_t rxhead;
+	uint32_t rxnum;
+	uint8_t tx[SIM_FIFO_SZ];
+	uint32_t txhead;
+	uint32_t txnum;
+	uint32_t shifting;		/* A character is on the transmit line */
+	uint8_t txbyte;
+	uint32_t txcycles;
+	uint64_t txend;
+} SIM_UART_Type;
+
+/** External device on the UART1 lines */
+typedef struct {
+	uint32_t on;
+	uint32_t skid;			/* Characters still sent with RTS inactive */
+	uint32_t left;
+	uint32_t waiting;		/* Waits for RTS */
+	uint32_t seq;			/* Next character */
+	uint32_t cycles;		/* Length of the character on the line */
+	uint64_t end;			/* Its end, SIM_NEVER if none */
+} SIM_DEV_Type;
+
+/** GPDMA channel */
+typedef struct {
+	uint32_t src;
+	uint32_t dst;
+	uint32_t lli;
+	uint32_t ctrl;
+	uint32_t cfg;
+} SIM_CH_Type;
+
+static const uintptr_t sim_base[SIM_PAGE_NUM + SIM_PLAIN_NUM] = {
+	LPC_UART1_BASE, LPC_GPDMA_BASE, LPC_SC_BASE, LPC_UART0_BASE
+};
+
+/** Receive trigger levels, FCR bits 7:6 */
+static const uint8_t sim_trigger[4] = {1, 4, 8, 14};
+
+static SIM_UART_Type sim_uart;
+static SIM_DEV_Type sim_dev;
+static SIM_CH_Type sim_ch[SIM_DMA_CH];
+static uint32_t sim_dmacfg;
+static uint32_t sim_rawtc;
+static uint32_t sim_rawerr;
+
+/* Access being single-stepped */
+static volatile int sim_inhandler;
+static volatile int sim_chained;
+static uint32_t sim_page;
+static uint32_t sim_ofs;
+static uint32_t sim_write;
+static uint32_t sim_before;
+
+/* Time, core clock cycles */
+static uint64_t sim_cycle;
+
+static struct sigaction sim_oldsegv;
+static struct sigaction sim_oldtrap;
+static CDCSIM_TX_FUNC sim_txfunc;
+static CDCSIM_STATS_Type sim_stats;
+static char sim_violation[160];
+
+static void sim_Dma(uint64_t t);
+
+/* Private Functions ---------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Count a programming error of the drivers, keep the first
+ * @param[in]	msg		Description
+ * @return 		None
+ **********************************************************************/
+static void sim_Violation(const char *msg)
+{
+	if (sim_stats.Violations++ == 0) {
+		snprintf(sim_violation, sizeof(sim_violation),
+				"%s (register 0x%08lX, cycle %llu)", msg,
+				(unsigned long)(sim_base[sim_page] + sim_ofs),
+				(unsigned long long)sim_cycle);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register of a trapped page
+ * @param[in]	page	Page index
+ * @param[in]	ofs		Register offset
+ * @return 		Register
+ **********************************************************************/
+static volatile uint32_t *sim_Reg(uint32_t page, uint32_t ofs)
+{
+	return (volatile uint32_t *)(sim_base[page] + ofs);
+}
+
+/*********************************************************************//**
+ * @brief		Character time of UART1: start bit, data bits, parity
+ * 				and stop bits at the rate of DLL/DLM and FDR
+ * @param[in]	None
+ * @return 		Core clock cycles
+ **********************************************************************/
+static uint32_t sim_CharCycles(void)
+{
+	uint32_t div, bits, mul, add, bit;
+
+	div = (sim_uart.dlm << 8) | sim_uart.dll;
+	if (div == 0) {
+		div = 1;
+	}
+	bit = 16 * div * (CDCSIM_CCLK / CDCSIM_UART_PCLK);
+	mul = (sim_uart.fdr >> 4) & 0x0F;
+	add = sim_uart.fdr & 0x0F;
+	if ((add != 0) && (mul != 0)) {
+		bit = bit * (mul + add) / mul;
+	}
+	bits = 1 + 5 + (sim_uart.lcr & 0x03) + ((sim_uart.lcr & 0x08) ? 1 : 0) +
+			((sim_uart.lcr & 0x04) ? 2 : 1);
+	return bits * bit;
+}
+
+/*********************************************************************//**
+ * @brief		RTS seen by the external device
+ * @param[in]	None
+ * @return 		Non zero if active
+ **********************************************************************/
+static uint32_t sim_RtsActive(void)
+{
+	if (sim_uart.mcr & SIM_MCR_AUTORTS) {
+		return sim_uart.rxnum < sim_trigger[(sim_uart.fcr >> 6) & 3];
+	}
+	return (sim_uart.mcr & SIM_MCR_RTS) != 0;
+}
+
+/*********************************************************************//**
+ * @brief		External device: start its next character, or wait for
+ * 				RTS, or stop
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_DevNext(uint64_t t)
+{
+	if (!sim_dev.on) {
+		sim_dev.waiting = 0;
+		sim_dev.end = SIM_NEVER;
+		return;
+	}
+	if (sim_RtsActive()) {
+		sim_dev.left = sim_dev.skid;
+	} else if (sim_dev.left != 0) {
+		sim_dev.left--;
+	} else {
+		if (!sim_dev.waiting) {
+			sim_stats.RxWaits++;
+		}
+		sim_dev.waiting = 1;
+		sim_dev.end = SIM_NEVER;
+		return;
+	}
+	sim_dev.waiting = 0;
+	sim_dev.cycles = sim_CharCycles();
+	sim_dev.end = t + sim_dev.cycles;
+}
+
+/*********************************************************************//**
+ * @brief		Bytes taken from the receive FIFO: the external device
+ * 				goes on if it waits and RTS is active again
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_RxTaken(uint64_t t)
+{
+	if (sim_dev.waiting && sim_RtsActive()) {
+		sim_DevNext(t);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		End of a character of the external device
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_RxEnd(uint64_t t)
+{
+	uint8_t byte;
+
+	byte = CDCSIM_RxByte(sim_dev.seq++);
+	sim_stats.RxChars++;
+	sim_stats.RxBusy += sim_dev.cycles;
+	sim_dev.end = SIM_NEVER;
+	if (sim_uart.rxnum == SIM_FIFO_SZ) {
+		sim_uart.lsr |= SIM_LSR_OE;
+		sim_stats.RxOverruns++;
+	} else {
+		sim_uart.rx[(sim_uart.rxhead + sim_uart.rxnum) % SIM_FIFO_SZ] = byte;
+		sim_uart.rxnum++;
+	}
+	sim_Dma(t);
+	sim_DevNext(t);
+}
+
+/*********************************************************************//**
+ * @brief		Move the next byte of the transmit FIFO to the line, if
+ * 				the line is free
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_TxStart(uint64_t t)
+{
+	if (sim_uart.shifting || (sim_uart.txnum == 0) || !(sim_uart.ter & SIM_TER_TXEN)) {
+		return;
+	}
+	sim_uart.txbyte = sim_uart.tx[sim_uart.txhead];
+	sim_uart.txhead = (sim_uart.txhead + 1) % SIM_FIFO_SZ;
+	sim_uart.txnum--;
+	sim_uart.shifting = 1;
+	sim_uart.txcycles = sim_CharCycles();
+	sim_uart.txend = t + sim_uart.txcycles;
+	sim_Dma(t);
+}
+
+/*********************************************************************//**
+ * @brief		End of a character sent by UART1
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_TxEnd(uint64_t t)
+{
+	sim_uart.shifting = 0;
+	sim_stats.TxChars++;
+	sim_stats.TxBusy += sim_uart.txcycles;
+	if (sim_txfunc != NULL) {
+		sim_txfunc(sim_uart.txbyte, t);
+	}
+	sim_TxStart(t);
+}
+
+/*********************************************************************//**
+ * @brief		Check a GPDMA transfer loaded in a channel: UART1 and
+ * 				memory, byte wide, not empty
+ * @param[in]	n		Channel
+ * @return 		None
+ **********************************************************************/
+static void sim_DmaCheck(uint32_t n)
+{
+	SIM_CH_Type *ch = &sim_ch[n];
+	uint32_t type = SIM_CFG_TYPE(ch->cfg);
+
+	if (!(sim_dmacfg & GPDMA_DMACConfig_E)) {
+		sim_Violation("GPDMA controller disabled");
+	}
+	if (type == GPDMA_TRANSFERTYPE_P2M) {
+		if ((SIM_CFG_SRCPER(ch->cfg) != GPDMA_CONN_UART1_Rx) || (ch->src != LPC_UART1_BASE)
+				|| (ch->ctrl & GPDMA_DMACCxControl_SI)) {
+			sim_Violation("GPDMA channel not reading UART1 RBR");
+		}
+	} else if (type == GPDMA_TRANSFERTYPE_M2P) {
+		if ((SIM_CFG_DSTPER(ch->cfg) != GPDMA_CONN_UART1_Tx) || (ch->dst != LPC_UART1_BASE)
+				|| (ch->ctrl & GPDMA_DMACCxControl_DI)) {
+			sim_Violation("GPDMA channel not writing UART1 THR");
+		}
+	} else {
+		sim_Violation("GPDMA transfer type not modelled");
+	}
+	if (SIM_CTRL_WIDTH(ch->ctrl) != 0) {
+		sim_Violation("GPDMA transfer width not byte");
+	}
+	if (SIM_CTRL_SIZE(ch->ctrl) == 0) {
+		sim_Violation("GPDMA transfer of zero bytes");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		End of the transfer of a channel: terminal count, then
+ * 				the next linked list item or the channel disabled
+ * @param[in]	n		Channel
+ * @return 		None
+ **********************************************************************/
+static void sim_DmaEnd(uint32_t n)
+{
+	SIM_CH_Type *ch = &sim_ch[n];
+	volatile uint32_t *lli;
+
+	if (ch->ctrl & GPDMA_DMACCxControl_I) {
+		sim_rawtc |= 1UL << n;
+	}
+	if (ch->lli == 0) {
+		ch->cfg &= ~GPDMA_DMACCxConfig_E;
+		return;
+	}
+	lli = (volatile uint32_t *)(uintptr_t)(ch->lli & GPDMA_DMACCxLLI_BITMASK);
+	ch->src = lli[0];
+	ch->dst = lli[1];
+	ch->lli = lli[2];
+	ch->ctrl = lli[3];
+	sim_stats.DmaLinks++;
+	sim_DmaCheck(n);
+}
+
+/*********************************************************************//**
+ * @brief		Serve the UART1 DMA requests with the enabled channels
+ * @param[in]	t		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_Dma(uint64_t t)
+{
+	SIM_CH_Type *ch;
+	uint32_t n, type, taken, given;
+	uint8_t *p;
+
+	if (!(sim_dmacfg & GPDMA_DMACConfig_E) || !(sim_uart.fcr & SIM_FCR_DMA)) {
+		return;
+	}
+	taken = 0;
+	given = 0;
+	for (n = 0; n < SIM_DMA_CH; n++) {
+		ch = &sim_ch[n];
+		while ((ch->cfg & GPDMA_DMACCxConfig_E) && (SIM_CTRL_SIZE(ch->ctrl) != 0)) {
+			type = SIM_CFG_TYPE(ch->cfg);
+			if ((type == GPDMA_TRANSFERTYPE_P2M) && (sim_uart.rxnum != 0)) {
+				p = (uint8_t *)(uintptr_t)ch->dst;
+				*p = sim_uart.rx[sim_uart.rxhead];
+				sim_uart.rxhead = (sim_uart.rxhead + 1) % SIM_FIFO_SZ;
+				sim_uart.rxnum--;
+				if (ch->ctrl & GPDMA_DMACCxControl_DI) {
+					ch->dst++;
+				}
+				taken++;
+			} else if ((type == GPDMA_TRANSFERTYPE_M2P) && (sim_uart.txnum < SIM_FIFO_SZ)) {
+				p = (uint8_t *)(uintptr_t)ch->src;
+				sim_uart.tx[(sim_uart.txhead + sim_uart.txnum) % SIM_FIFO_SZ] = *p;
+				sim_uart.txnum++;
+				if (ch->ctrl & GPDMA_DMACCxControl_SI) {
+					ch->src++;
+				}
+				given++;
+			} else {
+				break;
+			}
+			sim_stats.DmaBytes++;
+			ch->ctrl--;
+			if (SIM_CTRL_SIZE(ch->ctrl) == 0) {
+				sim_DmaEnd(n);
+			}
+		}
+	}
+	if (taken != 0) {
+		sim_RxTaken(t);
+	}
+	if (given != 0) {
+		sim_TxStart(t);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Run the line events up to a time
+ * @param[in]	to		Time
+ * @return 		None
+ **********************************************************************/
+static void sim_Run(uint64_t to)
+{
+	uint64_t tx;
+
+	for (;;) {
+		tx = sim_uart.shifting ? sim_uart.txend : SIM_NEVER;
+		if ((sim_dev.end <= tx) && (sim_dev.end <= to)) {
+			sim_RxEnd(sim_dev.end);
+		} else if (tx <= to) {
+			sim_TxEnd(tx);
+		} else {
+			return;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Interrupt identification of UART1: line status and
+ * 				receive data; FIFOs enabled bits
+ * @param[in]	None
+ * @return 		IIR value
+ **********************************************************************/
+static uint32_t sim_UartIir(void)
+{
+	uint32_t fifo;
+
+	fifo = (sim_uart.fcr & SIM_FCR_EN) ? 0xC0 : 0;
+	if ((sim_uart.ier & SIM_IER_RLS) && (sim_uart.lsr & SIM_LSR_ERRORS)) {
+		return fifo | 0x06;
+	}
+	if ((sim_uart.ier & SIM_IER_RBR) && (sim_uart.rxnum >= sim_trigger[(sim_uart.fcr >> 6) & 3])) {
+		return fifo | 0x04;
+	}
+	return fifo | 0x01;
+}
+
+/*********************************************************************//**
+ * @brief		Side effects of a UART1 register read
+ * @param[in]	ofs		Register offset
+ * @return 		None
+ **********************************************************************/
+static void sim_UartRead(uint32_t ofs)
+{
+	if ((ofs == SIM_UART(RBR)) && !(sim_uart.lcr & SIM_LCR_DLAB) && (sim_uart.rxnum != 0)) {
+		sim_uart.rxhead = (sim_uart.rxhead + 1) % SIM_FIFO_SZ;
+		sim_uart.rxnum--;
+		sim_RxTaken(sim_cycle);
+	} else if (ofs == SIM_UART(LSR)) {
+		sim_uart.lsr &= ~SIM_LSR_ERRORS;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		UART1 register written
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value
+ * @return 		None
+ **********************************************************************/
+static void sim_UartWrite(uint32_t ofs, uint32_t val)
+{
+	if (ofs == SIM_UART(THR)) {
+		if (sim_uart.lcr & SIM_LCR_DLAB) {
+			sim_uart.dll = val & 0xFF;
+		} else if (sim_uart.txnum == SIM_FIFO_SZ) {
+			sim_Violation("THR written with the transmit FIFO full");
+		} else {
+			sim_uart.tx[(sim_uart.txhead + sim_uart.txnum) % SIM_FIFO_SZ] = (uint8_t)val;
+			sim_uart.txnum++;
+			sim_TxStart(sim_cycle);
+		}
+	} else if (ofs == SIM_UART(IER)) {
+		if (sim_uart.lcr & SIM_LCR_DLAB) {
+			sim_uart.dlm = val & 0xFF;
+		} else {
+			sim_uart.ier = val & 0x38F;
+			if (sim_uart.ier & SIM_IER_THRE) {
+				sim_Violation("THRE interrupt not modelled");
+			}
+		}
+	} else if (ofs == SIM_UART(FCR)) {
+		if (val & SIM_FCR_RXRESET) {
+			sim_uart.rxhead = 0;
+			sim_uart.rxnum = 0;
+		}
+		if (val & SIM_FCR_TXRESET) {
+			sim_uart.txhead = 0;
+			sim_uart.txnum = 0;
+		}
+		sim_uart.fcr = val & 0xC9;
+		sim_RxTaken(sim_cycle);
+		sim_Dma(sim_cycle);
+	} else if (ofs == SIM_UART(LCR)) {
+		sim_uart.lcr = val & 0xFF;
+	} else if (ofs == SIM_UART(MCR)) {
+		sim_uart.mcr = val & 0xD3;
+		if (sim_uart.mcr & SIM_MCR_AUTOCTS) {
+			sim_Violation("auto-CTS not modelled");
+		}
+		sim_RxTaken(sim_cycle);
+	} else if (ofs == SIM_UART(SCR)) {
+		sim_uart.scr = val & 0xFF;
+	} else if (ofs == SIM_UART(ACR)) {
+		sim_uart.acr = val & 0x307;
+		if (sim_uart.acr & 0x01) {
+			sim_Violation("auto-baud not modelled");
+		}
+	} else if (ofs == SIM_UART(FDR)) {
+		sim_uart.fdr = val & 0xFF;
+	} else if (ofs == SIM_UART(TER)) {
+		sim_uart.ter = val & SIM_TER_TXEN;
+		sim_TxStart(sim_cycle);
+	} else if ((ofs == SIM_UART(LSR)) || (ofs == SIM_UART(MSR)) || (ofs == SIM_UART(FIFOLVL))) {
+		sim_Violation("write to a read only UART1 register");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		GPDMA register written
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value
+ * @return 		None
+ **********************************************************************/
+static void sim_DmaWrite(uint32_t ofs, uint32_t val)
+{
+	SIM_CH_Type *ch;
+	uint32_t n, reg, was;
+
+	if (ofs == SIM_DMA(DMACIntTCClear)) {
+		sim_rawtc &= ~(val & 0xFF);
+	} else if (ofs == SIM_DMA(DMACIntErrClr)) {
+		sim_rawerr &= ~(val & 0xFF);
+	} else if (ofs == SIM_DMA(DMACConfig)) {
+		sim_dmacfg = val & GPDMA_DMACConfig_BITMASK;
+	} else if ((ofs == SIM_DMA(DMACSync)) || ((ofs >= SIM_DMA(DMACSoftBReq)) && (ofs <= SIM_DMA(DMACSoftLSReq)))) {
+		// No software requests to UART1
+	} else if ((ofs >= SIM_DMACH(0, DMACCSrcAddr)) && (ofs < SIM_DMACH(SIM_DMA_CH, DMACCSrcAddr))) {
+		n = (ofs - SIM_DMACH(0, DMACCSrcAddr)) / 0x20;
+		reg = ofs - SIM_DMACH(n, DMACCSrcAddr);
+		ch = &sim_ch[n];
+		if ((reg != offsetof(LPC_GPDMACH_TypeDef, DMACCConfig)) && (ch->cfg & GPDMA_DMACCxConfig_E)) {
+			sim_Violation("GPDMA channel written while enabled");
+		}
+		if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCSrcAddr)) {
+			ch->src = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCDestAddr)) {
+			ch->dst = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCLLI)) {
+			ch->lli = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCControl)) {
+			ch->ctrl = val;
+		} else if (reg == offsetof(LPC_GPDMACH_TypeDef, DMACCConfig)) {
+			was = ch->cfg & GPDMA_DMACCxConfig_E;
+			ch->cfg = (val & GPDMA_DMACCxConfig_BITMASK) & ~GPDMA_DMACCxConfig_A;
+			if (!was && (ch->cfg & GPDMA_DMACCxConfig_E)) {
+				sim_DmaCheck(n);
+				sim_Dma(sim_cycle);
+			}
+		}
+	} else {
+		sim_Violation("write to a read only GPDMA register");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Refresh the readable values of a page
+ * @param[in]	page	Page index
+ * @return 		None
+ **********************************************************************/
+static void sim_Publish(uint32_t page)
+{
+	uint32_t n, enabled, itc, ie;
+
+	memset((void *)sim_base[page], 0, SIM_PAGE_SZ);
+	if (page == SIM_PG_UART) {
+		if (sim_uart.lcr & SIM_LCR_DLAB) {
+			*sim_Reg(page, SIM_UART(DLL)) = sim_uart.dll;
+			*sim_Reg(page, SIM_UART(DLM)) = sim_uart.dlm;
+		} else {
+			*sim_Reg(page, SIM_UART(RBR)) = (sim_uart.rxnum != 0) ? sim_uart.rx[sim_uart.rxhead] : 0;
+			*sim_Reg(page, SIM_UART(IER)) = sim_uart.ier;
+		}
+		*sim_Reg(page, SIM_UART(IIR)) = sim_UartIir();
+		*sim_Reg(page, SIM_UART(LCR)) = sim_uart.lcr;
+		*sim_Reg(page, SIM_UART(MCR)) = sim_uart.mcr;
+		*sim_Reg(page, SIM_UART(LSR)) = sim_uart.lsr | ((sim_uart.rxnum != 0) ? SIM_LSR_RDR : 0) |
+				((sim_uart.txnum == 0) ? SIM_LSR_THRE : 0) |
+				(((sim_uart.txnum == 0) && !sim_uart.shifting) ? SIM_LSR_TEMT : 0);
+		*sim_Reg(page, SIM_UART(SCR)) = sim_uart.scr;
+		*sim_Reg(page, SIM_UART(ACR)) = sim_uart.acr;
+		*sim_Reg(page, SIM_UART(FDR)) = sim_uart.fdr;
+		*sim_Reg(page, SIM_UART(TER)) = sim_uart.ter;
+		*sim_Reg(page, SIM_UART(FIFOLVL)) = sim_uart.rxnum | (sim_uart.txnum << 8);
+		return;
+	}
+
+	enabled = 0;
+	itc = 0;
+	ie = 0;
+	for (n = 0; n < SIM_DMA_CH; n++) {
+		if (sim_ch[n].cfg & GPDMA_DMACCxConfig_E) {
+			enabled |= 1UL << n;
+		}
+		if (sim_ch[n].cfg & GPDMA_DMACCxConfig_ITC) {
+			itc |= 1UL << n;
+		}
+		if (sim_ch[n].cfg & GPDMA_DMACCxConfig_IE) {
+			ie |= 1UL << n;
+		}
+		*sim_Reg(page, SIM_DMACH(n, DMACCSrcAddr)) = sim_ch[n].src;
+		*sim_Reg(page, SIM_DMACH(n, DMACCDestAddr)) = sim_ch[n].dst;
+		*sim_Reg(page, SIM_DMACH(n, DMACCLLI)) = sim_ch[n].lli;
+		*sim_Reg(page, SIM_DMACH(n, DMACCControl)) = sim_ch[n].ctrl;
+		*sim_Reg(page, SIM_DMACH(n, DMACCConfig)) = sim_ch[n].cfg;
+	}
+	*sim_Reg(page, SIM_DMA(DMACIntStat)) = (sim_rawtc & itc) | (sim_rawerr & ie);
+	*sim_Reg(page, SIM_DMA(DMACIntTCStat)) = sim_rawtc & itc;
+	*sim_Reg(page, SIM_DMA(DMACIntErrStat)) = sim_rawerr & ie;
+	*sim_Reg(page, SIM_DMA(DMACRawIntTCStat)) = sim_rawtc;
+	*sim_Reg(page, SIM_DMA(DMACRawIntErrStat)) = sim_rawerr;
+	*sim_Reg(page, SIM_DMA(DMACEnbldChns)) = enabled;
+	*sim_Reg(page, SIM_DMA(DMACConfig)) = sim_dmacfg;
+}
+
+/*********************************************************************//**
+ * @brief		Register page fault: bring the model to the time of the
+ * 				access, prepare it, single-step it. Accesses to the USB
+ * 				controller go on to usbsim.c
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Fault(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uintptr_t adr = (uintptr_t)si->si_addr;
+	uint32_t page;
+
+	for (page = 0; page < SIM_PAGE_NUM; page++) {
+		if ((adr >= sim_base[page]) && (adr < sim_base[page] + SIM_PAGE_SZ)) {
+			break;
+		}
+	}
+	if (sim_inhandler || sim_chained) {
+		signal(SIGSEGV, SIG_DFL);				/* Real fault: faults again */
+		return;
+	}
+	sim_cycle += CDCSIM_APB_WAIT;
+	sim_stats.Accesses++;
+	if (page == SIM_PAGE_NUM) {
+		if ((adr < SIM_USB_ADR) || (adr >= SIM_USB_ADR + SIM_PAGE_SZ)) {
+			signal(SIGSEGV, SIG_DFL);
+			return;
+		}
+		sim_chained = 1;
+		sim_oldsegv.sa_sigaction(sig, si, ctx);
+		return;
+	}
+	sim_inhandler = 1;
+	sim_page = page;
+	mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE);
+	sim_ofs = (uint32_t)(adr - sim_base[page]);
+	sim_write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_ERR_WRITE) != 0;
+	if (sim_ofs & 3) {
+		sim_Violation("unaligned register access");
+	}
+	sim_ofs &= ~3UL;
+	sim_Run(sim_cycle);
+	sim_Publish(page);
+	sim_before = *sim_Reg(page, sim_ofs);
+	if ((page == SIM_PG_UART) && !sim_write) {
+		sim_UartRead(sim_ofs);
+	}
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Single step: apply a register access that is done
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Step(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uint32_t val, page;
+
+	if (sim_inhandler) {
+		uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFL_TF;
+		page = sim_page;
+		val = *sim_Reg(page, sim_ofs);
+		/* Read-modify-write instructions may fault as a read */
+		if (sim_write || (val != sim_before)) {
+			if (page == SIM_PG_UART) {
+				sim_UartWrite(sim_ofs, val);
+			} else {
+				sim_DmaWrite(sim_ofs, val);
+			}
+		}
+		sim_Publish(page);
+		mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+		sim_inhandler = 0;
+	} else if (sim_chained) {
+		sim_chained = 0;
+		sim_oldtrap.sa_sigaction(sig, si, ctx);
+	} else {
+		signal(SIGTRAP, SIG_DFL);
+		raise(SIGTRAP);
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Map the register pages and install the access traps in
+ * 				front of the ones of usbsim.c, to be called after
+ * 				USBSIM_Init(). UART1 and GPDMA at their reset values,
+ * 				external device off
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void CDCSIM_Init(void)
+{
+	struct sigaction sa;
+	uint32_t page;
+	void *p;
+
+	memset(&sim_uart, 0, sizeof(sim_uart));
+	sim_uart.dll = 1;
+	sim_uart.fdr = 0x10;
+	sim_uart.ter = SIM_TER_TXEN;
+	memset(&sim_dev, 0, sizeof(sim_dev));
+	sim_dev.end = SIM_NEVER;
+	memset(sim_ch, 0, sizeof(sim_ch));
+
+	for (page = 0; page < SIM_PAGE_NUM + SIM_PLAIN_NUM; page++) {
+		p = mmap((void *)sim_base[page], SIM_PAGE_SZ, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (p != (void *)sim_base[page]) {
+			fprintf(stderr, "cdcsim: cannot map 0x%08lX\n", (unsigned long)sim_base[page]);
+			exit(2);
+		}
+		if (page < SIM_PAGE_NUM) {
+			sim_Publish(page);
+			mprotect((void *)sim_base[page], SIM_PAGE_SZ, PROT_NONE);
+		}
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sim_Fault;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, &sim_oldsegv);
+	sa.sa_sigaction = sim_Step;
+	sigaction(SIGTRAP, &sa, &sim_oldtrap);
+}
+
+/*********************************************************************//**
+ * @brief		Character sent by the external device: the pattern does
+ * 				not repeat with the ring and block sizes of the bridge
+ * @param[in]	seq		Character number
+ * @return 		Byte
+ **********************************************************************/
+uint8_t CDCSIM_RxByte(uint32_t seq)
+{
+	return (uint8_t)((seq * 131) ^ (seq >> 9));
+}
+
+/*********************************************************************//**
+ * @brief		Start or stop the external device. Stopped, it ends the
+ * 				character on the line
+ * @param[in]	on		Non zero to send
+ * @param[in]	skid	Characters sent after RTS goes inactive
+ * @return 		None
+ **********************************************************************/
+void CDCSIM_Sender(uint32_t on, uint32_t skid)
+{
+	sim_Run(sim_cycle);
+	sim_dev.on = on;
+	sim_dev.skid = skid;
+	sim_dev.left = skid;
+	if (!on) {
+		sim_dev.waiting = 0;
+	} else if (sim_dev.end == SIM_NEVER) {
+		sim_DevNext(sim_cycle);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Set the receiver of the characters sent by UART1
+ * @param[in]	func	Function, NULL for none
+ * @return 		None
+ **********************************************************************/
+void CDCSIM_OnTx(CDCSIM_TX_FUNC func)
+{
+	sim_txfunc = func;
+}
+
+/*********************************************************************//**
+ * @brief		Bit rate of UART1
+ * @param[in]	None
+ * @return 		Bits per second
+ **********************************************************************/
+uint32_t CDCSIM_BitRate(void)
+{
+	uint32_t bits;
+
+	bits = 1 + 5 + (sim_uart.lcr & 0x03) + ((sim_uart.lcr & 0x08) ? 1 : 0) +
+			((sim_uart.lcr & 0x04) ? 2 : 1);
+	return (uint32_t)((uint64_t)CDCSIM_CCLK * bits / sim_CharCycles());
+}
+
+/*********************************************************************//**
+ * @brief		Character time of UART1
+ * @param[in]	None
+ * @return 		Core clock cycles
+ **********************************************************************/
+uint32_t CDCSIM_CharCycles(void)
+{
+	return sim_CharCycles();
+}
+
+/*********************************************************************//**
+ * @brief		UART1 interrupt request line
+ * @param[in]	None
+ * @return 		Non zero if the interrupt is requested
+ **********************************************************************/
+uint32_t CDCSIM_UartIrqPending(void)
+{
+	return (sim_UartIir() & 0x01) == 0;
+}
+
+/*********************************************************************//**
+ * @brief		GPDMA interrupt request line
+ * @param[in]	None
+ * @return 		Non zero if the interrupt is requested
+ **********************************************************************/
+uint32_t CDCSIM_DmaIrqPending(void)
+{
+	uint32_t n, mask;
+
+	mask = 0;
+	for (n = 0; n < SIM_DMA_CH; n++) {
+		if ((sim_rawtc & (1UL << n)) && (sim_ch[n].cfg & GPDMA_DMACCxConfig_ITC)) {
+			mask |= 1UL << n;
+		}
+		if ((sim_rawerr & (1UL << n)) && (sim_ch[n].cfg & GPDMA_DMACCxConfig_IE)) {
+			mask |= 1UL << n;
+		}
+	}
+	return mask;
+}
+
+/*********************************************************************//**
+ * @brief		Current time
+ * @param[in]	None
+ * @return 		Core clock cycles
+ **********************************************************************/
+uint64_t CDCSIM_Now(void)
+{
+	return sim_cycle;
+}
+
+/*********************************************************************//**
+ * @brief		Time of the next character end on either line
+ * @param[in]	None
+ * @return 		Time, all ones if none
+ **********************************************************************/
+uint64_t CDCSIM_NextEvent(void)
+{
+	if (sim_uart.shifting && (sim_uart.txend < sim_dev.end)) {
+		return sim_uart.txend;
+	}
+	return sim_dev.end;
+}
+
+/*********************************************************************//**
+ * @brief		Let time pass with the processor idle, run the events
+ * @param[in]	time	Time to advance to, nothing if already past
+ * @return 		None
+ **********************************************************************/
+void CDCSIM_Advance(uint64_t time)
+{
+	if (time > sim_cycle) {
+		sim_cycle = time;
+	}
+	sim_Run(sim_cycle);
+}
+
+/*********************************************************************//**
+ * @brief		Get the model counters
+ * @param[out]	stats	Counters
+ * @return 		None
+ **********************************************************************/
+void CDCSIM_GetStats(CDCSIM_STATS_Type *stats)
+{
+	*stats = sim_stats;
+}
+
+/*********************************************************************//**
+ * @brief		First programming error seen by the model
+ * @param[in]	None
+ * @return 		Description, empty if none
+ **********************************************************************/
+const char *CDCSIM_Violation(void)
+{
+	return sim_violation;
+}
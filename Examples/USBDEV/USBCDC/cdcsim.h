@@ -0,0 +1,72 @@
+/**********************************************************************
+* $Id$		cdcsim.h				2011-03-09
+*//**
+* @file		cdcsim.h
+* @brief	Host model of the UART side of the CDC bridge: UART1 with its
+* 			FIFOs, auto-RTS and the external device on its lines, and the
+* 			GPDMA channels serving it. Time is counted in core clock
+* 			cycles
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __CDCSIM_H
+#define __CDCSIM_H
+
+#include <stdint.h>
+
+/** Clocks: core, and UART1 PCLK (PCLKSEL0 reset value, CCLK/4) */
+#define CDCSIM_CCLK			100000000UL
+#define CDCSIM_UART_PCLK	(CDCSIM_CCLK / 4)
+/** Wait states of a peripheral register access, core cycles */
+#define CDCSIM_APB_WAIT		2
+
+/** Byte received by the external device from UART1, at the end of its stop bit */
+typedef void (*CDCSIM_TX_FUNC)(uint8_t byte, uint64_t time);
+
+/**
+ * @brief Model counters
+ */
+typedef struct {
+	uint32_t Accesses;		/**< Register accesses, USB controller included */
+	uint32_t Violations;	/**< Programming errors seen by the model */
+	uint32_t RxChars;		/**< Characters sent by the external device */
+	uint32_t RxOverruns;	/**< Of them lost, receive FIFO full */
+	uint32_t RxWaits;		/**< Times the external device waited for RTS */
+	uint64_t RxBusy;		/**< Cycles of characters on the receive line */
+	uint32_t TxChars;		/**< Characters sent by UART1 */
+	uint64_t TxBusy;		/**< Cycles of characters on the transmit line */
+	uint32_t DmaBytes;		/**< Bytes moved by GPDMA to and from UART1 */
+	uint32_t DmaLinks;		/**< Linked list items loaded */
+} CDCSIM_STATS_Type;
+
+void CDCSIM_Init(void);
+uint8_t CDCSIM_RxByte(uint32_t seq);
+void CDCSIM_Sender(uint32_t on, uint32_t skid);
+void CDCSIM_OnTx(CDCSIM_TX_FUNC func);
+uint32_t CDCSIM_BitRate(void);
+uint32_t CDCSIM_CharCycles(void);
+uint32_t CDCSIM_UartIrqPending(void);
+uint32_t CDCSIM_DmaIrqPending(void);
+uint64_t CDCSIM_Now(void);
+uint64_t CDCSIM_NextEvent(void);
+void CDCSIM_Advance(uint64_t time);
+void CDCSIM_GetStats(CDCSIM_STATS_Type *stats);
+const char *CDCSIM_Violation(void);
+
+#endif /* __CDCSIM_H */
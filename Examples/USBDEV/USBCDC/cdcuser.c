@@ -18,321 +18,128 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "usbhw.h"
-#include "usbcfg.h"
-#include "usbcore.h"
-#include "cdc.h"
+#include "lpc17xx_usbdev_cdc.h"
+#include "usbdesc.h"
 #include "cdcuser.h"
 #include "serial.h"
 
 
-unsigned char BulkBufIn  [USB_CDC_BUFSIZE];            // Buffer to store USB IN  packet
-unsigned char BulkBufOut [USB_CDC_BUFSIZE];            // Buffer to store USB OUT packet
-unsigned char NotificationBuf [10];
-
-CDC_LINE_CODING CDC_LineCoding  = {9600, 0, 0, 8};
-unsigned short  CDC_SerialState = 0x0000;
-unsigned short  CDC_DepInEmpty  = 1;                   // Data IN EP is empty
-
-/*----------------------------------------------------------------------------
-  We need a buffer for incomming data on USB port because USB receives
-  much faster than  UART transmits
- *---------------------------------------------------------------------------*/
-/* Buffer masks */
-#define CDC_BUF_SIZE               (64)               // Output buffer in bytes (power 2)
-                                                       // large enough for file transfer
-#define CDC_BUF_MASK               (CDC_BUF_SIZE-1ul)
-
-/* Buffer read / write macros */
-#define CDC_BUF_RESET(cdcBuf)      (cdcBuf.rdIdx = cdcBuf.wrIdx = 0)
-#define CDC_BUF_WR(cdcBuf, dataIn) (cdcBuf.data[CDC_BUF_MASK & cdcBuf.wrIdx++] = (dataIn))
-#define CDC_BUF_RD(cdcBuf)         (cdcBuf.data[CDC_BUF_MASK & cdcBuf.rdIdx++])
-#define CDC_BUF_EMPTY(cdcBuf)      (cdcBuf.rdIdx == cdcBuf.wrIdx)
-#define CDC_BUF_FULL(cdcBuf)       (cdcBuf.rdIdx == cdcBuf.wrIdx+1)
-#define CDC_BUF_COUNT(cdcBuf)      (CDC_BUF_MASK & (cdcBuf.wrIdx - cdcBuf.rdIdx))
-
-
-// CDC output buffer
-typedef struct __CDC_BUF_T {
-  unsigned char data[CDC_BUF_SIZE];
-  unsigned int wrIdx;
-  unsigned int rdIdx;
-} CDC_BUF_T;
-
-CDC_BUF_T  CDC_OutBuf;                                 // buffer for all CDC Out data
-
-/*----------------------------------------------------------------------------
-  read data from CDC_OutBuf
- *---------------------------------------------------------------------------*/
-int CDC_RdOutBuf (char *buffer, const int *length) {
-  int bytesToRead, bytesRead;
-
-  /* Read *length bytes, block if *bytes are not avaialable	*/
-  bytesToRead = *length;
-  bytesToRead = (bytesToRead < (*length)) ? bytesToRead : (*length);
-  bytesRead = bytesToRead;
-
-
-  // ... add code to check for underrun
-
-  while (bytesToRead--) {
-    *buffer++ = CDC_BUF_RD(CDC_OutBuf);
-  }
-  return (bytesRead);
-}
-
-/*----------------------------------------------------------------------------
-  write data to CDC_OutBuf
- *---------------------------------------------------------------------------*/
-int CDC_WrOutBuf (const char *buffer, int *length) {
-  int bytesToWrite, bytesWritten;
-
-  // Write *length bytes
-  bytesToWrite = *length;
-  bytesWritten = bytesToWrite;
-
-
-  // ... add code to check for overwrite
-
-  while (bytesToWrite) {
-      CDC_BUF_WR(CDC_OutBuf, *buffer++);           // Copy Data to buffer
-      bytesToWrite--;
-  }
-
-  return (bytesWritten);
-}
+/* CDC class driver instance */
+USBDEV_CDC_Type CDC_Vcom;
 
 /*----------------------------------------------------------------------------
-  check if character(s) are available at CDC_OutBuf
+  UART bridge: the bulk data endpoints are served by USB DMA straight from
+  and into the UART rings, filled and drained by GPDMA. The rings are in
+  the USB RAM (AHB SRAM), after the USB DMA descriptors.
+  UART receive: CDC_RX_BLOCKS blocks, 20ms at 921600 bps
+  UART transmit: host NAKed while less than a packet is free
  *---------------------------------------------------------------------------*/
-int CDC_OutBufAvailChar (int *availChar) {
+#define CDC_RX_BLOCKS              (4)
+#define CDC_RX_BLOCK_SIZE          (512)
+#define CDC_TX_SIZE                (1024)              // multiple of USB_CDC_BUFSIZE
 
-  *availChar = CDC_BUF_COUNT(CDC_OutBuf);
+/* GPDMA channels */
+#define CDC_DMA_RX                 (0)
+#define CDC_DMA_TX                 (1)
 
-  return (0);
-}
-/* end Buffer handling */
+USBDEV_CDC_BRIDGE_Type CDC_Bridge;
+GPDMA_LLI_Type CDC_RxLLI[CDC_RX_BLOCKS];              // UART receive chain
 
 
 /*----------------------------------------------------------------------------
-  CDC Initialisation
-  Initializes the data structures and serial port
-  Parameters:   None
+  CDC Apply Line Coding
+  Reopens the serial port with cdc->LineCoding, called from USB_Task()
+  Parameters:   arg: CDC class driver instance
+                event, param: not used
   Return Value: None
  *---------------------------------------------------------------------------*/
-void CDC_Init (char portNum ) {
-
-  if ( portNum == 0 )
-  {
-	ser_OpenPort (0);
-	ser_InitPort0 (CDC_LineCoding.dwDTERate,
-                CDC_LineCoding.bDataBits,
-                CDC_LineCoding.bParityType,
-                CDC_LineCoding.bCharFormat);
-  }
-  else
-  {
-	ser_OpenPort (1);
-	ser_InitPort1 (CDC_LineCoding.dwDTERate,
-                CDC_LineCoding.bDataBits,
-                CDC_LineCoding.bParityType,
-                CDC_LineCoding.bCharFormat);
-  }
-  CDC_DepInEmpty  = 1;
-  CDC_SerialState = CDC_GetSerialState();
-
-  CDC_BUF_RESET(CDC_OutBuf);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC SendEncapsulatedCommand Request Callback
-  Called automatically on CDC SEND_ENCAPSULATED_COMMAND Request
-  Parameters:   None                          (global SetupPacket and EP0Buf)
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_SendEncapsulatedCommand (void) {
-
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC GetEncapsulatedResponse Request Callback
-  Called automatically on CDC Get_ENCAPSULATED_RESPONSE Request
-  Parameters:   None                          (global SetupPacket and EP0Buf)
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_GetEncapsulatedResponse (void) {
-
-  /* ... add code to handle request */
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC SetCommFeature Request Callback
-  Called automatically on CDC Set_COMM_FATURE Request
-  Parameters:   FeatureSelector
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_SetCommFeature (unsigned short wFeatureSelector) {
-
-  /* ... add code to handle request */
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC GetCommFeature Request Callback
-  Called automatically on CDC Get_COMM_FATURE Request
-  Parameters:   FeatureSelector
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_GetCommFeature (unsigned short wFeatureSelector) {
-
-  /* ... add code to handle request */
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC ClearCommFeature Request Callback
-  Called automatically on CDC CLEAR_COMM_FATURE Request
-  Parameters:   FeatureSelector
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_ClearCommFeature (unsigned short wFeatureSelector) {
-
-  /* ... add code to handle request */
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC SetLineCoding Request Callback
-  Called automatically on CDC SET_LINE_CODING Request
-  Parameters:   none                    (global SetupPacket and EP0Buf)
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_SetLineCoding (void) {
-
-  CDC_LineCoding.dwDTERate   =   (EP0Buf[0] <<  0)
-                               | (EP0Buf[1] <<  8)
-                               | (EP0Buf[2] << 16)
-                               | (EP0Buf[3] << 24);
-  CDC_LineCoding.bCharFormat =  EP0Buf[4];
-  CDC_LineCoding.bParityType =  EP0Buf[5];
-  CDC_LineCoding.bDataBits   =  EP0Buf[6];
+static void CDC_ApplyLineCoding (void *arg, uint32_t event, uint32_t param) {
+  USBDEV_CDC_Type *cdc = (USBDEV_CDC_Type *)arg;
 
 #if PORT_NUM
   ser_ClosePort(1);
   ser_OpenPort (1);
-  ser_InitPort1 (CDC_LineCoding.dwDTERate,
-                CDC_LineCoding.bDataBits,
-                CDC_LineCoding.bParityType,
-                CDC_LineCoding.bCharFormat);
+  ser_InitPort1 (cdc->LineCoding.dwDTERate,
+                cdc->LineCoding.bDataBits,
+                cdc->LineCoding.bParityType,
+                cdc->LineCoding.bCharFormat);
 #else
   ser_ClosePort(0);
   ser_OpenPort (0);
-  ser_InitPort0 (CDC_LineCoding.dwDTERate,
-                CDC_LineCoding.bDataBits,
-                CDC_LineCoding.bParityType,
-                CDC_LineCoding.bCharFormat);
+  ser_InitPort0 (cdc->LineCoding.dwDTERate,
+                cdc->LineCoding.bDataBits,
+                cdc->LineCoding.bParityType,
+                cdc->LineCoding.bCharFormat);
 #endif
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC GetLineCoding Request Callback
-  Called automatically on CDC GET_LINE_CODING Request
-  Parameters:   None                         (global SetupPacket and EP0Buf)
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_GetLineCoding (void) {
-
-  EP0Buf[0] = (CDC_LineCoding.dwDTERate >>  0) & 0xFF;
-  EP0Buf[1] = (CDC_LineCoding.dwDTERate >>  8) & 0xFF;
-  EP0Buf[2] = (CDC_LineCoding.dwDTERate >> 16) & 0xFF;
-  EP0Buf[3] = (CDC_LineCoding.dwDTERate >> 24) & 0xFF;
-  EP0Buf[4] =  CDC_LineCoding.bCharFormat;
-  EP0Buf[5] =  CDC_LineCoding.bParityType;
-  EP0Buf[6] =  CDC_LineCoding.bDataBits;
-
-  return (TRUE);
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC SetControlLineState Request Callback
-  Called automatically on CDC SET_CONTROL_LINE_STATE Request
-  Parameters:   ControlSignalBitmap
-  Return Value: TRUE - Success, FALSE - Error
- *---------------------------------------------------------------------------*/
-uint32_t CDC_SetControlLineState (unsigned short wControlSignalBitmap) {
-
-  /* ... add code to handle request */
-  return (TRUE);
 }
 
 
 /*----------------------------------------------------------------------------
-  CDC SendBreak Request Callback
-  Called automatically on CDC Set_COMM_FATURE Request
-  Parameters:   0xFFFF  start of Break
-                0x0000  stop  of Break
-                0x####  Duration of Break
+  CDC SetLineCoding Callback
+  Called by the CDC class driver on SET_LINE_CODING request,
+  cdc->LineCoding holds the new line coding. The serial port is reopened
+  later by USB_Task(): the request is not held in the USB interrupt
+  Parameters:   cdc: CDC class driver instance
   Return Value: TRUE - Success, FALSE - Error
  *---------------------------------------------------------------------------*/
-uint32_t CDC_SendBreak (unsigned short wDurationOfBreak) {
+static uint32_t CDC_SetLineCoding (USBDEV_CDC_Type *cdc) {
 
-  /* ... add code to handle request */
-  return (TRUE);
+  return (USB_Defer(CDC_ApplyLineCoding, cdc, 0, 0) == SUCCESS);
 }
 
 
 /*----------------------------------------------------------------------------
-  CDC_BulkIn call on DataIn Request
-  Parameters:   none
-  Return Value: none
+  CDC Initialisation
+  Initializes the data structures and serial port, registers the CDC
+  class driver with its UART bridge. GPDMA_Init() must have been called
+  Parameters:   portNum: serial port
+  Return Value: None
  *---------------------------------------------------------------------------*/
-void CDC_BulkIn(void) {
-  int numBytesRead, numBytesAvail;
-
-  ser_AvailChar (&numBytesAvail);
-
-  // ... add code to check for overwrite
+void CDC_Init (char portNum ) {
 
-  numBytesRead = ser_Read ((char *)&BulkBufIn[0], &numBytesAvail);
+  CDC_Vcom.CIF = USB_CDC_CIF_NUM;
+  CDC_Vcom.CEP_IN = CDC_CEP_IN;
+  CDC_Vcom.DEP_IN = CDC_DEP_IN;
+  CDC_Vcom.DEP_OUT = CDC_DEP_OUT;
+  CDC_Vcom.SetLineCoding = CDC_SetLineCoding;
+  CDC_Vcom.SetControlLineState = NULL;
+  CDC_Vcom.SendBreak = NULL;
+  CDC_Vcom.BulkOut = NULL;
+  CDC_Vcom.BulkIn = NULL;
+  CDC_Vcom.Bridge = &CDC_Bridge;
+  CDC_Vcom.LineCoding.dwDTERate = 9600;
+  CDC_Vcom.LineCoding.bCharFormat = 0;
+  CDC_Vcom.LineCoding.bParityType = 0;
+  CDC_Vcom.LineCoding.bDataBits = 8;
+
+  CDC_Bridge.UARTx = (portNum == 0) ? LPC_UART0 : (LPC_UART_TypeDef *)LPC_UART1;
+  CDC_Bridge.DMARx = CDC_DMA_RX;
+  CDC_Bridge.DMATx = CDC_DMA_TX;
+  CDC_Bridge.RxBlocks = CDC_RX_BLOCKS;
+  CDC_Bridge.RxBlockSize = CDC_RX_BLOCK_SIZE;
+  CDC_Bridge.TxSize = CDC_TX_SIZE;
+  CDC_Bridge.RxBuf = (uint8_t *)DMA_BUF_ADR;
+  CDC_Bridge.TxBuf = (uint8_t *)DMA_BUF_ADR + CDC_RX_BLOCKS * CDC_RX_BLOCK_SIZE;
+  CDC_Bridge.RxLLI = CDC_RxLLI;
 
-  // send over USB
-  if (numBytesRead > 0) {
-	USB_WriteEP (CDC_DEP_IN, &BulkBufIn[0], numBytesRead);
+  if ( portNum == 0 )
+  {
+	ser_OpenPort (0);
+	ser_InitPort0 (CDC_Vcom.LineCoding.dwDTERate,
+                CDC_Vcom.LineCoding.bDataBits,
+                CDC_Vcom.LineCoding.bParityType,
+                CDC_Vcom.LineCoding.bCharFormat);
   }
-  else {
-    CDC_DepInEmpty = 1;
+  else
+  {
+	ser_OpenPort (1);
+	ser_InitPort1 (CDC_Vcom.LineCoding.dwDTERate,
+                CDC_Vcom.LineCoding.bDataBits,
+                CDC_Vcom.LineCoding.bParityType,
+                CDC_Vcom.LineCoding.bCharFormat);
   }
-}
-
-
-/*----------------------------------------------------------------------------
-  CDC_BulkOut call on DataOut Request
-  Parameters:   none
-  Return Value: none
- *---------------------------------------------------------------------------*/
-void CDC_BulkOut(void) {
-  int numBytesRead;
-
-  // get data from USB into intermediate buffer
-  numBytesRead = USB_ReadEP(CDC_DEP_OUT, &BulkBufOut[0]);
-
-  // ... add code to check for overwrite
-
-  // store data in a buffer to transmit it over serial interface
-  CDC_WrOutBuf ((char *)&BulkBufOut[0], &numBytesRead);
 
+  USB_CdcInit (&CDC_Vcom);
 }
 
 
@@ -342,38 +149,18 @@ void CDC_BulkOut(void) {
   Return Value: SerialState as defined in usbcdc11.pdf
  *---------------------------------------------------------------------------*/
 unsigned short CDC_GetSerialState (void) {
-  unsigned short temp;
+  unsigned short temp, serialState;
 
-  CDC_SerialState = 0;
+  serialState = 0;
   ser_LineState (&temp);
 
-  if (temp & 0x8000)  CDC_SerialState |= CDC_SERIAL_STATE_RX_CARRIER;
-  if (temp & 0x2000)  CDC_SerialState |= CDC_SERIAL_STATE_TX_CARRIER;
-  if (temp & 0x0010)  CDC_SerialState |= CDC_SERIAL_STATE_BREAK;
-  if (temp & 0x4000)  CDC_SerialState |= CDC_SERIAL_STATE_RING;
-  if (temp & 0x0008)  CDC_SerialState |= CDC_SERIAL_STATE_FRAMING;
-  if (temp & 0x0004)  CDC_SerialState |= CDC_SERIAL_STATE_PARITY;
-  if (temp & 0x0002)  CDC_SerialState |= CDC_SERIAL_STATE_OVERRUN;
-
-  return (CDC_SerialState);
-}
-
-
-/*----------------------------------------------------------------------------
-  Send the SERIAL_STATE notification as defined in usbcdc11.pdf, 6.3.5.
- *---------------------------------------------------------------------------*/
-void CDC_NotificationIn (void) {
-
-  NotificationBuf[0] = 0xA1;                           // bmRequestType
-  NotificationBuf[1] = CDC_NOTIFICATION_SERIAL_STATE;  // bNotification (SERIAL_STATE)
-  NotificationBuf[2] = 0x00;                           // wValue
-  NotificationBuf[3] = 0x00;
-  NotificationBuf[4] = 0x00;                           // wIndex (Interface #, LSB first)
-  NotificationBuf[5] = 0x00;
-  NotificationBuf[6] = 0x02;                           // wLength (Data length = 2 bytes, LSB first)
-  NotificationBuf[7] = 0x00;
-  NotificationBuf[8] = (CDC_SerialState >>  0) & 0xFF; // UART State Bitmap (16bits, LSB first)
-  NotificationBuf[9] = (CDC_SerialState >>  8) & 0xFF;
+  if (temp & 0x8000)  serialState |= CDC_SERIAL_STATE_RX_CARRIER;
+  if (temp & 0x2000)  serialState |= CDC_SERIAL_STATE_TX_CARRIER;
+  if (temp & 0x0010)  serialState |= CDC_SERIAL_STATE_BREAK;
+  if (temp & 0x4000)  serialState |= CDC_SERIAL_STATE_RING;
+  if (temp & 0x0008)  serialState |= CDC_SERIAL_STATE_FRAMING;
+  if (temp & 0x0004)  serialState |= CDC_SERIAL_STATE_PARITY;
+  if (temp & 0x0002)  serialState |= CDC_SERIAL_STATE_OVERRUN;
 
-  USB_WriteEP (CDC_CEP_IN, &NotificationBuf[0], 10);   // send notification
+  return (serialState);
 }
@@ -19,11 +19,7 @@
 #ifndef __CDCUSER_H__
 #define __CDCUSER_H__
 
-/* CDC buffer handling */
-extern int CDC_RdOutBuf        (char *buffer, const int *length);
-extern int CDC_WrOutBuf        (const char *buffer, int *length);
-extern int CDC_OutBufAvailChar (int *availChar);
-
+#include "lpc17xx_usbdev_cdc.h"
 
 /* CDC Data In/Out Endpoint Address */
 #define CDC_DEP_IN       0x82
@@ -32,23 +28,9 @@ extern int CDC_OutBufAvailChar (int *availChar);
 /* CDC Communication In Endpoint Address */
 #define CDC_CEP_IN       0x81
 
-/* CDC Requests Callback Functions */
-extern uint32_t CDC_SendEncapsulatedCommand  (void);
-extern uint32_t CDC_GetEncapsulatedResponse  (void);
-extern uint32_t CDC_SetCommFeature           (unsigned short wFeatureSelector);
-extern uint32_t CDC_GetCommFeature           (unsigned short wFeatureSelector);
-extern uint32_t CDC_ClearCommFeature         (unsigned short wFeatureSelector);
-extern uint32_t CDC_GetLineCoding            (void);
-extern uint32_t CDC_SetLineCoding            (void);
-extern uint32_t CDC_SetControlLineState      (unsigned short wControlSignalBitmap);
-extern uint32_t CDC_SendBreak                (unsigned short wDurationOfBreak);
-
-/* CDC Bulk Callback Functions */
-extern void CDC_BulkIn                   (void);
-extern void CDC_BulkOut                  (void);
-
-/* CDC Notification Callback Function */
-extern void CDC_NotificationIn           (void);
+/* CDC class driver instance and its UART bridge */
+extern USBDEV_CDC_Type CDC_Vcom;
+extern USBDEV_CDC_BRIDGE_Type CDC_Bridge;
 
 /* CDC Initializtion Function */
 extern void CDC_Init (char portNum);
@@ -56,8 +38,4 @@ extern void CDC_Init (char portNum);
 /* CDC prepare the SERAIAL_STATE */
 extern unsigned short CDC_GetSerialState (void);
 
-/* flow control */
-extern unsigned short CDC_DepInEmpty;         // DataEndPoint IN empty
-
 #endif  /* __CDCUSER_H__ */
-
@@ -82,7 +82,7 @@
 
 
 /* GPDMA ------------------------------- */
-//#define _GPDMA
+#define _GPDMA
 
 
 /* DAC ------------------------------- */
@@ -103,8 +103,9 @@
 //#define _I2S
 
 /* USB device ------------------------------- */
-//#define _USBDEV
-//#define _USB_DMA
+#define _USBDEV
+#define _USB_DMA
+#define _USBDEV_CDC
 
 /* QEI ------------------------------- */
 //#define _QEI
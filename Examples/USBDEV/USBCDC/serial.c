@@ -19,30 +19,10 @@
 
 
 /*----------------------------------------------------------------------------
-  Defines for ring buffers
+  The data is moved by GPDMA between the UART FIFOs and the rings of the
+  CDC bridge (see cdcuser.c), only the line state is handled here
  *---------------------------------------------------------------------------*/
-#define SER_BUF_SIZE               (128)               // serial buffer in bytes (power 2)
-#define SER_BUF_MASK               (SER_BUF_SIZE-1ul)  // buffer size mask
-
-/* Buffer read / write macros */
-#define SER_BUF_RESET(serBuf)      (serBuf.rdIdx = serBuf.wrIdx = 0)
-#define SER_BUF_WR(serBuf, dataIn) (serBuf.data[SER_BUF_MASK & serBuf.wrIdx++] = (dataIn))
-#define SER_BUF_RD(serBuf)         (serBuf.data[SER_BUF_MASK & serBuf.rdIdx++])
-#define SER_BUF_EMPTY(serBuf)      (serBuf.rdIdx == serBuf.wrIdx)
-#define SER_BUF_FULL(serBuf)       (serBuf.rdIdx == serBuf.wrIdx+1)
-#define SER_BUF_COUNT(serBuf)      (SER_BUF_MASK & (serBuf.wrIdx - serBuf.rdIdx))
-
-// buffer type
-typedef struct __SER_BUF_T {
-  unsigned char data[SER_BUF_SIZE];
-  unsigned int wrIdx;
-  unsigned int rdIdx;
-} SER_BUF_T;
-
-unsigned long          ser_txRestart;                  // NZ if TX restart is required
 unsigned short         ser_lineState;                  // ((msr << 8) | (lsr))
-SER_BUF_T              ser_out;                        // Serial data buffers
-SER_BUF_T              ser_in;
 
 /*----------------------------------------------------------------------------
   open the serial port
@@ -60,8 +40,8 @@ void ser_OpenPort (char portNum) {
   {
 	/* Port 1 */
 	NVIC_DisableIRQ(UART1_IRQn);
-	LPC_PINCON->PINSEL4 &= ~0x0000000F;
-	LPC_PINCON->PINSEL4 |= 0x0000000A;    /* Enable RxD1 P2.1, TxD1 P2.0 */
+	LPC_PINCON->PINSEL4 &= ~0x0000C00F;
+	LPC_PINCON->PINSEL4 |= 0x0000800A;    /* Enable RxD1 P2.1, TxD1 P2.0, RTS1 P2.7 */
   }
   return;
 }
@@ -81,7 +61,7 @@ void ser_ClosePort (char portNum ) {
   else
   {
 	/* Port 1 */
-	LPC_PINCON->PINSEL4 &= ~0x0000000F;
+	LPC_PINCON->PINSEL4 &= ~0x0000C00F;
 	/* Disable the interrupt in the VIC and UART controllers */
 	LPC_UART1->IER = 0;
 	NVIC_DisableIRQ(UART1_IRQn);
@@ -145,9 +125,6 @@ void ser_InitPort0 (unsigned long baudrate, unsigned int  databits,
     break;
   }
 
-  SER_BUF_RESET(ser_out);                              // reset out buffer
-  SER_BUF_RESET(ser_in);                               // reset in buffer
-
   /* Bit 6~7 is for UART0 */
   pclkdiv = (LPC_SC->PCLKSEL0 >> 6) & 0x03;
 
@@ -174,10 +151,10 @@ void ser_InitPort0 (unsigned long baudrate, unsigned int  databits,
   LPC_UART0->DLL = dll;                           // Baud Rate depending on PCLK
   LPC_UART0->DLM = (dll >> 8);                    // High divisor latch
   LPC_UART0->LCR = 0x00 | lcr_d | lcr_p | lcr_s;  // DLAB = 0
-  LPC_UART0->IER = 0x03;                          // Enable TX/RX interrupts
+  LPC_UART0->IER = 0x04;                          // Enable RX line status interrupt
 
-  LPC_UART0->FCR = 0x07;				/* Enable and reset TX and RX FIFO. */
-  ser_txRestart = 1;                                   // TX fifo is empty
+  LPC_UART0->FCR = 0x0F;				/* Enable and reset TX and RX FIFO, DMA mode,
+										   RX DMA request for each byte */
 
   /* Enable the UART Interrupt */
   NVIC_EnableIRQ(UART0_IRQn);
@@ -240,9 +217,6 @@ void ser_InitPort1 (unsigned long baudrate, unsigned int  databits,
     break;
   }
 
-  SER_BUF_RESET(ser_out);                              // reset out buffer
-  SER_BUF_RESET(ser_in);                               // reset in buffer
-
   /* Bit 8,9 are for UART1 */
   pclkdiv = (LPC_SC->PCLKSEL0 >> 8) & 0x03;
 
@@ -269,74 +243,17 @@ void ser_InitPort1 (unsigned long baudrate, unsigned int  databits,
   LPC_UART1->DLL = dll;                           // Baud Rate depending on PCLK
   LPC_UART1->DLM = (dll >> 8);                    // High divisor latch
   LPC_UART1->LCR = 0x00 | lcr_d | lcr_p | lcr_s;  // DLAB = 0
-  LPC_UART1->IER = 0x03;                          // Enable TX/RX interrupts
+  LPC_UART1->IER = 0x0C;                          // Enable RX line status and modem status interrupts
+  LPC_UART1->MCR = 0x40;                          // Auto-RTS: the sender is held while the RX FIFO is full
 
-  LPC_UART1->FCR = 0x07;				/* Enable and reset TX and RX FIFO. */
-  ser_txRestart = 1;                                   // TX fifo is empty
+  LPC_UART1->FCR = 0x0F;				/* Enable and reset TX and RX FIFO, DMA mode,
+										   RX DMA request for each byte */
 
   /* Enable the UART Interrupt */
   NVIC_EnableIRQ(UART1_IRQn);
   return;
 }
 
-/*----------------------------------------------------------------------------
-  read data from serial port
- *---------------------------------------------------------------------------*/
-int ser_Read (char *buffer, const int *length) {
-  int bytesToRead, bytesRead;
-
-  /* Read *length bytes, block if *bytes are not avaialable	*/
-  bytesToRead = *length;
-  bytesToRead = (bytesToRead < (*length)) ? bytesToRead : (*length);
-  bytesRead = bytesToRead;
-
-  while (bytesToRead--) {
-    while (SER_BUF_EMPTY(ser_in));                     // Block until data is available if none
-    *buffer++ = SER_BUF_RD(ser_in);
-  }
-  return (bytesRead);
-}
-
-/*----------------------------------------------------------------------------
-  write data to the serial port
- *---------------------------------------------------------------------------*/
-int ser_Write (char portNum, const char *buffer, int *length) {
-  int  bytesToWrite, bytesWritten;
-
-  // Write *length bytes
-  bytesToWrite = *length;
-  bytesWritten = bytesToWrite;
-
-  while (!SER_BUF_EMPTY(ser_out));               // Block until space is available if none
-  while (bytesToWrite) {
-      SER_BUF_WR(ser_out, *buffer++);            // Read Rx FIFO to buffer
-      bytesToWrite--;
-  }
-
-  if (ser_txRestart) {
-    ser_txRestart = 0;
-	if ( portNum == 0 )
-	{
-	  LPC_UART0->THR = SER_BUF_RD(ser_out);             // Write to the Tx Register
-    }
-	else
-	{
-      LPC_UART1->THR = SER_BUF_RD(ser_out);             // Write to the Tx Register
-	}
-  }
-
-  return (bytesWritten);
-}
-
-/*----------------------------------------------------------------------------
-  check if character(s) are available at the serial interface
- *---------------------------------------------------------------------------*/
-void ser_AvailChar (int *availChar) {
-
-  *availChar = SER_BUF_COUNT(ser_in);
-
-}
-
 /*----------------------------------------------------------------------------
   read the line state of the serial port
  *---------------------------------------------------------------------------*/
@@ -354,23 +271,9 @@ void UART0_IRQHandler(void)
 {
   volatile unsigned long iir;
 
-  iir = LPC_UART0->IIR;
+  iir = LPC_UART0->IIR;                             // RLS pending
 
-  if ((iir & 0x4) || (iir & 0xC)) {            // RDA or CTI pending
-    while (LPC_UART0->LSR & 0x01) {                 // Rx FIFO is not empty
-      SER_BUF_WR(ser_in, LPC_UART0->RBR);           // Read Rx FIFO to buffer
-    }
-  }
-  if ((iir & 0x2)) {                           // TXMIS pending
-	if (SER_BUF_COUNT(ser_out) != 0) {
-      LPC_UART0->THR = SER_BUF_RD(ser_out);         // Write to the Tx FIFO
-      ser_txRestart = 0;
-    }
-	else {
-      ser_txRestart = 1;
-	}
-  }
-  ser_lineState = LPC_UART0->LSR & 0x1E;            // update linestate
+  ser_lineState |= LPC_UART0->LSR & 0x1E;           // update linestate
   return;
 }
 
@@ -381,23 +284,9 @@ void UART1_IRQHandler(void)
 {
   volatile unsigned long iir;
 
-  iir = LPC_UART1->IIR;
+  iir = LPC_UART1->IIR;                             // RLS or modem status pending
 
-  if ((iir & 0x4) || (iir & 0xC)) {            // RDA or CTI pending
-    while (LPC_UART1->LSR & 0x01) {                 // Rx FIFO is not empty
-      SER_BUF_WR(ser_in, LPC_UART1->RBR);           // Read Rx FIFO to buffer
-    }
-  }
-  if ((iir & 0x2)) {                           // TXMIS pending
-	if (SER_BUF_COUNT(ser_out) != 0) {
-      LPC_UART1->THR = SER_BUF_RD(ser_out);         // Write to the Tx FIFO
-      ser_txRestart = 0;
-    }
-	else {
-      ser_txRestart = 1;
-	}
-  }
-  ser_lineState = ((LPC_UART1->MSR<<8)|LPC_UART1->LSR) & 0xE01E;    // update linestate
+  ser_lineState |= ((LPC_UART1->MSR<<8)|LPC_UART1->LSR) & 0xE01E;    // update linestate
   return;
 }
 
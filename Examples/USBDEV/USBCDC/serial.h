@@ -23,8 +23,5 @@ extern void  ser_OpenPort  (char portNum);
 extern void  ser_ClosePort (char portNum);
 extern void  ser_InitPort0  (unsigned long baudrate, unsigned int databits, unsigned int parity, unsigned int stopbits);
 extern void  ser_InitPort1  (unsigned long baudrate, unsigned int databits, unsigned int parity, unsigned int stopbits);
-extern void  ser_AvailChar (int *availChar);
-extern int   ser_Write     (char portNum, const char *buffer, int *length);
-extern int   ser_Read      (char *buffer, const int *length);
 extern void  ser_LineState (unsigned short *lineState);
 
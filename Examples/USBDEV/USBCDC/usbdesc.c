@@ -20,9 +20,7 @@
  *          V1.00 Initial Version
  *---------------------------------------------------------------------------*/
 #include "lpc_types.h"
-#include "usb.h"
-#include "cdc.h"
-#include "usbcfg.h"
+#include "lpc17xx_usbdev_cdc.h"
 #include "usbdesc.h"
 
 
@@ -73,7 +71,7 @@ const uint8_t USB_ConfigDescriptor[] = {
   CDC_COMMUNICATION_INTERFACE_CLASS, /* bInterfaceClass: Communication Interface Class */
   CDC_ABSTRACT_CONTROL_MODEL,        /* bInterfaceSubClass: Abstract Control Model */
   0x00,                              /* bInterfaceProtocol: no protocol used */
-  0x5E,                              /* iInterface: */
+  0x04,                              /* iInterface: */
 /*Header Functional Descriptor*/
   0x05,                              /* bLength: Endpoint Descriptor size */
   CDC_CS_INTERFACE,                  /* bDescriptorType: CS_INTERFACE */
@@ -112,7 +110,7 @@ const uint8_t USB_ConfigDescriptor[] = {
   CDC_DATA_INTERFACE_CLASS,          /* bInterfaceClass: Data Interface Class */
   0x00,                              /* bInterfaceSubClass: no subclass available */
   0x00,                              /* bInterfaceProtocol: no protocol used */
-  0x5E,                              /* iInterface: */
+  0x04,                              /* iInterface: */
 /* Endpoint, EP2 Bulk Out */
   USB_ENDPOINT_DESC_SIZE,            /* bLength */
   USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
@@ -198,4 +196,6 @@ const uint8_t USB_StringDescriptor[] = {
   'C',0,
   'O',0,
   'M',0,
+/* Terminator */
+  0                                  /* bLength */
 };
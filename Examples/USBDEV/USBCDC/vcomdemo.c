@@ -17,11 +17,9 @@
 #include "LPC17xx.h"
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "usbcfg.h"
-#include "usbhw.h"
-#include "usbcore.h"
-#include "cdc.h"
+#include "lpc17xx_usbdev_cdc.h"
+#include "lpc17xx_gpdma.h"
+#include "usbdesc.h"
 #include "cdcuser.h"
 #include "serial.h"
 #include "vcomdemo.h"
@@ -32,56 +30,47 @@
  * @{
  */
 
+/* USB device configuration */
+const USBDEV_CFG_Type USB_Cfg = {
+  USB_DeviceDescriptor,
+  USB_ConfigDescriptor,
+  USB_StringDescriptor,
+  0,                                        /* EventMask */
+  NULL,                                     /* Event */
+  USBDEV_EP_BIT(CDC_DEP_IN) | USBDEV_EP_BIT(CDC_DEP_OUT), /* DMAEndpoints */
+  0                                         /* DeferMask */
+};
+
 /*----------------------------------------------------------------------------
- Initialises the VCOM port.
- Call this function before using VCOM_putchar or VCOM_getchar
+  USB interrupt handler
  *---------------------------------------------------------------------------*/
-void VCOM_Init(void) {
-#if PORT_NUM
-  CDC_Init (1);
-#else
-  CDC_Init (0);
-#endif
+void USB_IRQHandler (void) {
+  USB_IntHandler();
 }
 
-
 /*----------------------------------------------------------------------------
-  Reads character from serial port buffer and writes to USB buffer
+  GPDMA interrupt handler: UART transmit of the CDC bridge
  *---------------------------------------------------------------------------*/
-void VCOM_Serial2Usb(void) {
-  static char serBuf [USB_CDC_BUFSIZE];
-         int  numBytesRead, numAvailByte;
-
-  ser_AvailChar (&numAvailByte);
-  if (numAvailByte > 0) {
-    if (CDC_DepInEmpty) {
-      numBytesRead = ser_Read (&serBuf[0], &numAvailByte);
-
-      CDC_DepInEmpty = 0;
-	  USB_WriteEP (CDC_DEP_IN, (unsigned char *)&serBuf[0], numBytesRead);
-    }
-  }
-
+void DMA_IRQHandler (void) {
+  USB_CdcBridgeDMAHandler(&CDC_Vcom);
 }
 
 /*----------------------------------------------------------------------------
-  Reads character from USB buffer and writes to serial port buffer
+ Initialises the VCOM port: the UART data flows through the CDC bridge,
+ the GPDMA interrupt shares the priority of the USB interrupt
  *---------------------------------------------------------------------------*/
-void VCOM_Usb2Serial(void) {
-  static char serBuf [32];
-         int  numBytesToRead, numBytesRead, numAvailByte;
-
-  CDC_OutBufAvailChar (&numAvailByte);
-  if (numAvailByte > 0) {
-      numBytesToRead = numAvailByte > 32 ? 32 : numAvailByte;
-      numBytesRead = CDC_RdOutBuf (&serBuf[0], &numBytesToRead);
+void VCOM_Init(void) {
+
+  GPDMA_Init();
+  NVIC_SetPriority(USB_IRQn, ((0x01<<3)|0x01));
+  NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+  NVIC_EnableIRQ(DMA_IRQn);
+
 #if PORT_NUM
-      ser_Write (1, &serBuf[0], &numBytesRead);
+  CDC_Init (1);
 #else
-      ser_Write (0, &serBuf[0], &numBytesRead);
+  CDC_Init (0);
 #endif
-  }
-
 }
 
 
@@ -89,14 +78,8 @@ void VCOM_Usb2Serial(void) {
   checks the serial state and initiates notification
  *---------------------------------------------------------------------------*/
 void VCOM_CheckSerialState (void) {
-         unsigned short temp;
-  static unsigned short serialState;
-
-  temp = CDC_GetSerialState();
-  if (serialState != temp) {
-     serialState = temp;
-     CDC_NotificationIn();                  // send SERIAL_STATE notification
-  }
+
+  USB_CdcNotify (&CDC_Vcom, CDC_GetSerialState());   // send SERIAL_STATE notification on change
 }
 
 /*----------------------------------------------------------------------------
@@ -106,15 +89,14 @@ int main (void) {
 
   VCOM_Init();                              // VCOM Initialization
 
-  USB_Init();                               // USB Initialization
+  USB_Init(&USB_Cfg);                       // USB Initialization
   USB_Connect(TRUE);                        // USB Connect
 
   while (!USB_Configuration) ;              // wait until USB is configured
 
-  while (1) {                               // Loop forever
-    VCOM_Serial2Usb();                      // read serial port and initiate USB event
+  while (1) {                               // Loop forever, data moved by DMA
+    USB_Task();                             // run the deferred requests
     VCOM_CheckSerialState();
-	VCOM_Usb2Serial();
   } // end while
 } // end main ()
 
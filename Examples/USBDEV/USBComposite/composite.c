@@ -0,0 +1,233 @@
+/**********************************************************************
+* $Id$		composite.c			2011-03-09
+*//**
+* @file		composite.c
+* @brief	This example describes how to run two USB class drivers in
+* 			one composite device: a CDC virtual COM port echoing the
+* 			data it receives and a MSC RAM disk
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_usbdev_cdc.h"
+#include "lpc17xx_usbdev_msc.h"
+#include "lpc17xx_libcfg.h"
+#include "usbdesc.h"
+#include "composite.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @defgroup USBDEV_USBComposite	USBComposite
+ * @ingroup USBDEV_Examples
+ * @{
+ */
+
+/************************** PRIVATE VARIABLES *************************/
+/** USB device configuration */
+const USBDEV_CFG_Type USB_Cfg = {
+	USB_DeviceDescriptor,
+	USB_ConfigDescriptor,
+	USB_StringDescriptor,
+	0,							/* EventMask */
+	NULL,						/* Event */
+	0,							/* DMAEndpoints */
+	0							/* DeferMask */
+};
+
+/** CDC class driver */
+USBDEV_CDC_Type Cdc;
+/** Echo buffer */
+uint8_t EchoBuf[CDC_BUFSIZE];
+/** OUT packets waiting for the IN endpoint */
+volatile uint32_t EchoPending;
+
+/** MSC class driver */
+USBDEV_MSC_Type Msc;
+/** RAM disk */
+uint8_t Memory[MSC_MemorySize];
+
+/************************** PRIVATE FUNCTION *************************/
+void USB_IRQHandler(void);
+
+static void Cdc_BulkOut(USBDEV_CDC_Type *cdc);
+static void Cdc_BulkIn(USBDEV_CDC_Type *cdc);
+static uint32_t Msc_Read(USBDEV_MSC_Type *msc, uint32_t offset, uint8_t *buf, uint32_t len);
+static uint32_t Msc_Write(USBDEV_MSC_Type *msc, uint32_t offset, uint8_t *buf, uint32_t len);
+
+/*----------------- INTERRUPT SERVICE ROUTINES --------------------------*/
+/*********************************************************************//**
+ * @brief		USB interrupt handler sub-routine
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USB_IRQHandler(void)
+{
+	USB_IntHandler();
+}
+
+/*-------------------------PRIVATE FUNCTIONS------------------------------*/
+/*********************************************************************//**
+ * @brief		CDC bulk OUT packet received: echo it, or leave it in the
+ * 				endpoint (the host is NAKed) until the IN endpoint is
+ * 				empty
+ * @param[in]	cdc		CDC class driver
+ * @return 		None
+ **********************************************************************/
+static void Cdc_BulkOut(USBDEV_CDC_Type *cdc)
+{
+	uint32_t n;
+
+	if (cdc->InBusy) {
+		EchoPending++;
+		return;
+	}
+	n = USB_ReadEP(cdc->DEP_OUT, EchoBuf);
+	USB_CdcWrite(cdc, EchoBuf, n);
+}
+
+/*********************************************************************//**
+ * @brief		CDC bulk IN packet sent: echo the next OUT packet waiting
+ * @param[in]	cdc		CDC class driver
+ * @return 		None
+ **********************************************************************/
+static void Cdc_BulkIn(USBDEV_CDC_Type *cdc)
+{
+	if (EchoPending) {
+		EchoPending--;
+		Cdc_BulkOut(cdc);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		MSC read callback: RAM disk
+ * @param[in]	msc		MSC class driver
+ * @param[in]	offset	Byte offset
+ * @param[in]	buf		Destination
+ * @param[in]	len		Number of bytes
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t Msc_Read(USBDEV_MSC_Type *msc, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+	uint32_t n;
+
+	if ((offset + len) > MSC_MemorySize) {
+		return FALSE;
+	}
+	for (n = 0; n < len; n++) {
+		buf[n] = Memory[offset + n];
+	}
+	return TRUE;
+}
+
+/*********************************************************************//**
+ * @brief		MSC write callback: RAM disk
+ * @param[in]	msc		MSC class driver
+ * @param[in]	offset	Byte offset
+ * @param[in]	buf		Source
+ * @param[in]	len		Number of bytes
+ * @return 		TRUE - Success, FALSE - Error
+ **********************************************************************/
+static uint32_t Msc_Write(USBDEV_MSC_Type *msc, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+	uint32_t n;
+
+	if ((offset + len) > MSC_MemorySize) {
+		return FALSE;
+	}
+	for (n = 0; n < len; n++) {
+		Memory[offset + n] = buf[n];
+	}
+	return TRUE;
+}
+
+/*-------------------------MAIN FUNCTION------------------------------*/
+/*********************************************************************//**
+ * @brief		c_entry: Main USB composite program body
+ * @param[in]	None
+ * @return 		int
+ **********************************************************************/
+int c_entry(void)
+{
+	uint32_t n;
+
+	for (n = 0; n < MSC_ImageSize; n++) {	/* Copy Initial Disk Image */
+		Memory[n] = DiskImage[n];			/*   from Flash to RAM     */
+	}
+
+	/* CDC on interfaces 0 and 1 */
+	Cdc.CIF = CDC_CIF_NUM;
+	Cdc.CEP_IN = CDC_CEP_IN;
+	Cdc.DEP_IN = CDC_DEP_IN;
+	Cdc.DEP_OUT = CDC_DEP_OUT;
+	Cdc.SetLineCoding = NULL;
+	Cdc.SetControlLineState = NULL;
+	Cdc.SendBreak = NULL;
+	Cdc.BulkOut = Cdc_BulkOut;
+	Cdc.BulkIn = Cdc_BulkIn;
+	Cdc.LineCoding.dwDTERate = 115200;
+	Cdc.LineCoding.bCharFormat = 0;
+	Cdc.LineCoding.bParityType = 0;
+	Cdc.LineCoding.bDataBits = 8;
+	USB_CdcInit(&Cdc);
+
+	/* MSC on interface 2 */
+	Msc.IF = MSC_IF_NUM;
+	Msc.EP_IN = MSC_EP_IN;
+	Msc.EP_OUT = MSC_EP_OUT;
+	Msc.BlockSize = MSC_BlockSize;
+	Msc.BlockCount = MSC_BlockCount;
+	Msc.InquiryID = NULL;
+	Msc.Read = Msc_Read;
+	Msc.Write = Msc_Write;
+	Msc.DMABuf = NULL;						/* Slave mode */
+	USB_MscInit(&Msc);
+
+	EchoPending = 0;
+	USB_Init(&USB_Cfg);
+	USB_Connect(TRUE);
+
+	while (1);
+	return 1;
+}
+
+/* Support required entry point for other toolchain */
+int main (void)
+{
+	return c_entry();
+}
+
+#ifdef  DEBUG
+/*******************************************************************************
+* @brief		Reports the name of the source file and the source line number
+* 				where the CHECK_PARAM error has occurred.
+* @param[in]	file Pointer to the source file name
+* @param[in]    line assert_param error line source number
+* @return		None
+*******************************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	/* User can add his own implementation to report the file name and line number,
+	 ex: printf("Wrong parameters value: file %s on line %d\r\n", file, line) */
+
+	/* Infinite loop */
+	while(1);
+}
+#endif
+
+/*
+ * @}
+ */
@@ -0,0 +1,53 @@
+/**********************************************************************
+* $Id$		composite.h			2011-03-09
+*//**
+* @file		composite.h
+* @brief	USB composite device demo (CDC + MSC) definitions
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef COMPOSITE_H_
+#define COMPOSITE_H_
+
+#include "lpc_types.h"
+
+/* CDC Interfaces and Endpoints */
+#define CDC_CIF_NUM		0
+#define CDC_DIF_NUM		1
+#define CDC_CEP_IN		0x81
+#define CDC_DEP_IN		0x82
+#define CDC_DEP_OUT		0x02
+#define CDC_BUFSIZE		64
+
+/* MSC Interface and Endpoints */
+#define MSC_IF_NUM		2
+#define MSC_EP_IN		0x85
+#define MSC_EP_OUT		0x05
+
+/* RAM disk */
+#define MSC_MemorySize	8192
+#define MSC_BlockSize	512
+#define MSC_BlockCount	(MSC_MemorySize / MSC_BlockSize)
+
+/* MSC Disk Image Definitions */
+#define MSC_ImageSize	0x00001000
+
+extern const unsigned char DiskImage[MSC_ImageSize];	/* Disk Image */
+
+#endif /* COMPOSITE_H_ */
@@ -0,0 +1,265 @@
+/**********************************************************************
+* $Id$		usbdesc.c			2011-03-09
+*//**
+* @file		usbdesc.c
+* @brief	USB descriptors of the composite device demo: CDC
+* 			virtual COM port (interfaces 0 and 1, grouped by an interface
+* 			association descriptor) and MSC RAM disk (interface 2)
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include "lpc17xx_usbdev_cdc.h"
+#include "lpc17xx_usbdev_msc.h"
+#include "usbdesc.h"
+#include "composite.h"
+
+/* Example group ----------------------------------------------------------- */
+/** @addtogroup USBDEV_USBComposite
+ * @{
+ */
+
+/* USB Standard Device Descriptor */
+const uint8_t USB_DeviceDescriptor[] = {
+  USB_DEVICE_DESC_SIZE,              /* bLength */
+  USB_DEVICE_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  WBVAL(0x0200), /* 2.00 */          /* bcdUSB */
+  USB_DEVICE_CLASS_MISCELLANEOUS,    /* bDeviceClass: IAD */
+  0x02,                              /* bDeviceSubClass: common class */
+  0x01,                              /* bDeviceProtocol: IAD */
+  USB_MAX_PACKET0,                   /* bMaxPacketSize0 */
+  WBVAL(0x1FC9),                     /* idVendor */
+  WBVAL(0x2004),                     /* idProduct */
+  WBVAL(0x0100), /* 1.00 */          /* bcdDevice */
+  0x01,                              /* iManufacturer */
+  0x02,                              /* iProduct */
+  0x03,                              /* iSerialNumber */
+  0x01                               /* bNumConfigurations */
+};
+
+/* USB Configuration Descriptor */
+/*   All Descriptors (Configuration, Interface, Endpoint, Class, Vendor */
+const uint8_t USB_ConfigDescriptor[] = {
+/* Configuration 1 */
+  USB_CONFIGUARTION_DESC_SIZE,       /* bLength */
+  USB_CONFIGURATION_DESCRIPTOR_TYPE, /* bDescriptorType */
+  WBVAL(                             /* wTotalLength */
+    1*USB_CONFIGUARTION_DESC_SIZE +
+    1*USB_IAD_DESC_SIZE           +  /* CDC interface association */
+    1*USB_INTERFACE_DESC_SIZE     +  /* communication interface */
+    0x0013                        +  /* CDC functions */
+    1*USB_ENDPOINT_DESC_SIZE      +  /* interrupt endpoint */
+    1*USB_INTERFACE_DESC_SIZE     +  /* data interface */
+    2*USB_ENDPOINT_DESC_SIZE      +  /* bulk endpoints */
+    1*USB_INTERFACE_DESC_SIZE     +  /* MSC interface */
+    2*USB_ENDPOINT_DESC_SIZE         /* bulk endpoints */
+      ),
+  0x03,                              /* bNumInterfaces */
+  0x01,                              /* bConfigurationValue */
+  0x00,                              /* iConfiguration */
+  USB_CONFIG_BUS_POWERED,            /* bmAttributes */
+  USB_CONFIG_POWER_MA(100),          /* bMaxPower */
+/* Interface Association: CDC interfaces 0 and 1 */
+  USB_IAD_DESC_SIZE,                 /* bLength */
+  USB_INTERFACE_ASSOCIATION_DESCRIPTOR_TYPE, /* bDescriptorType */
+  CDC_CIF_NUM,                       /* bFirstInterface */
+  0x02,                              /* bInterfaceCount */
+  CDC_COMMUNICATION_INTERFACE_CLASS, /* bFunctionClass */
+  CDC_ABSTRACT_CONTROL_MODEL,        /* bFunctionSubClass */
+  0x00,                              /* bFunctionProtocol */
+  0x04,                              /* iFunction */
+/* Interface 0, Alternate Setting 0, Communication class interface descriptor */
+  USB_INTERFACE_DESC_SIZE,           /* bLength */
+  USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
+  CDC_CIF_NUM,                       /* bInterfaceNumber */
+  0x00,                              /* bAlternateSetting */
+  0x01,                              /* bNumEndpoints */
+  CDC_COMMUNICATION_INTERFACE_CLASS, /* bInterfaceClass */
+  CDC_ABSTRACT_CONTROL_MODEL,        /* bInterfaceSubClass */
+  0x00,                              /* bInterfaceProtocol */
+  0x04,                              /* iInterface */
+/*Header Functional Descriptor*/
+  0x05,                              /* bLength */
+  CDC_CS_INTERFACE,                  /* bDescriptorType: CS_INTERFACE */
+  CDC_HEADER,                        /* bDescriptorSubtype: Header Func Desc */
+  WBVAL(CDC_V1_10), /* 1.10 */       /* bcdCDC */
+/*Call Management Functional Descriptor*/
+  0x05,                              /* bFunctionLength */
+  CDC_CS_INTERFACE,                  /* bDescriptorType: CS_INTERFACE */
+  CDC_CALL_MANAGEMENT,               /* bDescriptorSubtype: Call Management Func Desc */
+  0x01,                              /* bmCapabilities: device handles call management */
+  CDC_DIF_NUM,                       /* bDataInterface: CDC data IF ID */
+/*Abstract Control Management Functional Descriptor*/
+  0x04,                              /* bFunctionLength */
+  CDC_CS_INTERFACE,                  /* bDescriptorType: CS_INTERFACE */
+  CDC_ABSTRACT_CONTROL_MANAGEMENT,   /* bDescriptorSubtype: Abstract Control Management desc */
+  0x02,                              /* bmCapabilities: SET_LINE_CODING, GET_LINE_CODING, SET_CONTROL_LINE_STATE supported */
+/*Union Functional Descriptor*/
+  0x05,                              /* bFunctionLength */
+  CDC_CS_INTERFACE,                  /* bDescriptorType: CS_INTERFACE */
+  CDC_UNION,                         /* bDescriptorSubtype: Union func desc */
+  CDC_CIF_NUM,                       /* bMasterInterface: Communication class interface is master */
+  CDC_DIF_NUM,                       /* bSlaveInterface0: Data class interface is slave 0 */
+/*Endpoint 1 Descriptor*/            /* event notification */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  CDC_CEP_IN,                        /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_INTERRUPT,       /* bmAttributes */
+  WBVAL(0x0010),                     /* wMaxPacketSize */
+  0x02,          /* 2ms */           /* bInterval */
+/* Interface 1, Alternate Setting 0, Data class interface descriptor*/
+  USB_INTERFACE_DESC_SIZE,           /* bLength */
+  USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
+  CDC_DIF_NUM,                       /* bInterfaceNumber */
+  0x00,                              /* bAlternateSetting */
+  0x02,                              /* bNumEndpoints */
+  CDC_DATA_INTERFACE_CLASS,          /* bInterfaceClass */
+  0x00,                              /* bInterfaceSubClass */
+  0x00,                              /* bInterfaceProtocol */
+  0x04,                              /* iInterface */
+/* Endpoint, EP2 Bulk Out */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  CDC_DEP_OUT,                       /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(CDC_BUFSIZE),                /* wMaxPacketSize */
+  0x00,                              /* bInterval */
+/* Endpoint, EP2 Bulk In */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  CDC_DEP_IN,                        /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(CDC_BUFSIZE),                /* wMaxPacketSize */
+  0x00,                              /* bInterval */
+/* Interface 2, Alternate Setting 0, MSC Class */
+  USB_INTERFACE_DESC_SIZE,           /* bLength */
+  USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
+  MSC_IF_NUM,                        /* bInterfaceNumber */
+  0x00,                              /* bAlternateSetting */
+  0x02,                              /* bNumEndpoints */
+  USB_DEVICE_CLASS_STORAGE,          /* bInterfaceClass */
+  MSC_SUBCLASS_SCSI,                 /* bInterfaceSubClass */
+  MSC_PROTOCOL_BULK_ONLY,            /* bInterfaceProtocol */
+  0x05,                              /* iInterface */
+/* Endpoint, EP5 Bulk In */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  MSC_EP_IN,                         /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(MSC_MAX_PACKET),             /* wMaxPacketSize */
+  0,                                 /* bInterval */
+/* Endpoint, EP5 Bulk Out */
+  USB_ENDPOINT_DESC_SIZE,            /* bLength */
+  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
+  MSC_EP_OUT,                        /* bEndpointAddress */
+  USB_ENDPOINT_TYPE_BULK,            /* bmAttributes */
+  WBVAL(MSC_MAX_PACKET),             /* wMaxPacketSize */
+  0,                                 /* bInterval */
+/* Terminator */
+  0                                  /* bLength */
+};
+
+/* USB String Descriptor */
+const uint8_t USB_StringDescriptor[] = {
+/* Index 0x00: LANGID Codes */
+  0x04,                              /* bLength */
+  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  WBVAL(0x0409), /* US English */    /* wLANGID */
+/* Index 0x01: Manufacturer */
+  (13*2 + 2),                        /* bLength (13 Char + Type + length) */
+  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  'N',0,
+  'X',0,
+  'P',0,
+  ' ',0,
+  'S',0,
+  'E',0,
+  'M',0,
+  'I',0,
+  'C',0,
+  'O',0,
+  'N',0,
+  'D',0,
+  ' ',0,
+/* Index 0x02: Product */
+  (26*2 + 2),                        /* bLength (26 Char + Type + length) */
+  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  'N',0,
+  'X',0,
+  'P',0,
+  ' ',0,
+  'L',0,
+  'P',0,
+  'C',0,
+  '1',0,
+  '7',0,
+  'x',0,
+  'x',0,
+  ' ',0,
+  'V',0,
+  'C',0,
+  'O',0,
+  'M',0,
+  ' ',0,
+  '+',0,
+  ' ',0,
+  'M',0,
+  'e',0,
+  'm',0,
+  'o',0,
+  'r',0,
+  'y',0,
+  ' ',0,
+/* Index 0x03: Serial Number */
+  (12*2 + 2),                        /* bLength (12 Char + Type + length) */
+  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  'D',0,
+  'E',0,
+  'M',0,
+  'O',0,
+  '0',0,
+  '0',0,
+  '0',0,
+  '0',0,
+  '0',0,
+  '0',0,
+  '0',0,
+  '0',0,
+/* Index 0x04: Interface 0, Alternate Setting 0 */
+  (4*2 + 2),                         /* bLength (4 Char + Type + length) */
+  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  'V',0,
+  'C',0,
+  'O',0,
+  'M',0,
+/* Index 0x05: Interface 2, Alternate Setting 0 */
+  (6*2 + 2),                         /* bLength (6 Char + Type + length) */
+  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
+  'M',0,
+  'e',0,
+  'm',0,
+  'o',0,
+  'r',0,
+  'y',0,
+/* Terminator */
+  0                                  /* bLength */
+};
+
+/**
+ * @}
+ */
@@ -18,12 +18,11 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "usbcfg.h"
-#include "usbhw.h"
+#include "lpc17xx_usbdev_hid.h"
+#include "usbdesc.h"
+#include "hiduser.h"
 
 #include "demo.h"
-#include "hid.h"
 
 #include "lpc17xx_libcfg.h"
 #include "lpc17xx_nvic.h"
@@ -42,6 +41,29 @@ uint8_t InReport;                              /* HID Input Report    */
 uint8_t OutReport;                             /* HID Out Report      */
                                             /*   Bit0..7: LEDs     */
 
+uint32_t InSequence;                        /* Input Reports Posted */
+
+
+/* USB device configuration */
+const USBDEV_CFG_Type USB_Cfg = {
+  USB_DeviceDescriptor,
+  USB_ConfigDescriptor,
+  USB_StringDescriptor,
+  0,                                        /* EventMask */
+  NULL,                                     /* Event */
+  USBDEV_EP_BIT(HID_EP_IN) | USBDEV_EP_BIT(HID_EP_OUT), /* DMAEndpoints */
+  0                                         /* DeferMask */
+};
+
+
+/*
+ *  USB Interrupt Handler
+ */
+
+void USB_IRQHandler (void) {
+  USB_IntHandler();
+}
+
 
 /*
  *  Get HID Input Report -> InReport
@@ -118,16 +140,57 @@ void SetOutReport (void) {
 }
 
 
+/*
+ *  HID Task: post an input report in every free slot of the report
+ *  queue, apply the output reports received
+ *   Input report:  byte 0    : buttons (InReport)
+ *                  bytes 1..4: report sequence number, for the host
+ *                              to count lost reports
+ *                  bytes 5.. : test data, sequence number + offset
+ *   Output report: byte 0    : LEDs (OutReport)
+ */
+
+void HID_Task (void) {
+  uint8_t *report;
+  uint32_t n;
+
+  while ((report = USB_HidInSlot(&HID_Dev)) != NULL) {
+    GetInReport();
+    report[0] = InReport;
+    report[1] = (uint8_t)(InSequence);
+    report[2] = (uint8_t)(InSequence >> 8);
+    report[3] = (uint8_t)(InSequence >> 16);
+    report[4] = (uint8_t)(InSequence >> 24);
+    for (n = 5; n < HID_REPORT_SIZE; n++) {
+      report[n] = (uint8_t)(InSequence + n);
+    }
+    if (USB_HidInPost(&HID_Dev) != SUCCESS) {
+      break;
+    }
+    InSequence++;
+  }
+
+  while ((report = USB_HidOutReport(&HID_Dev)) != NULL) {
+    OutReport = report[0];
+    SetOutReport();
+    USB_HidOutRelease(&HID_Dev);
+  }
+}
+
+
 /* Main Program */
 
 int main (void) {
 	LPC_GPIO2 -> FIODIR = LEDMSK;             /* LEDs, port 2, bit 0~7 output only */
 	LPC_GPIO1 -> FIODIR = 0xF0000000;				/* LEDs, port 1, bit 28-31 output */
 
-	USB_Init();                               /* USB Initialization */
+	HID_Init();                               /* HID Class Initialization */
+	USB_Init(&USB_Cfg);                       /* USB Initialization */
 	USB_Connect(TRUE);                        /* USB Connect */
 
-	while (1);                                /* Loop forever */
+	while (1) {                               /* Loop forever */
+		HID_Task();
+	}
 }
 
 #ifdef  DEBUG
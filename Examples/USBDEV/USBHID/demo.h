@@ -27,3 +27,4 @@ extern uint8_t OutReport;
 /* HID Demo Functions */
 extern void GetInReport  (void);
 extern void SetOutReport (void);
+extern void HID_Task     (void);
@@ -0,0 +1,509 @@
+/**********************************************************************
+* $Id$		hid_host.c			2011-03-09
+*//**
+* @file		hid_host.c
+* @brief	Host throughput test of the HID example on the USB controller
+* 			model: the example, the HID class driver and the device
+* 			driver run unmodified against usbsim.c. A simulated host
+* 			enumerates the device, then each frame reads one report
+* 			from the interrupt IN endpoint and writes one to the OUT
+* 			endpoint, with GET_REPORT requests on endpoint 0 and a bus
+* 			reset halfway. The tokens of a frame arrive at random
+* 			register accesses of the device, as the bus runs alongside
+* 			the processor.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_usbdev_hid.h"
+#include "usbdesc.h"
+#include "hiduser.h"
+#include "demo.h"
+#include "usbsim.h"
+
+/* Test parameters */
+#define HOST_FRAMES			20000	/* Default run, frames (ms) */
+#define HOST_ADDR			5		/* Address given to the device */
+#define HOST_SPREAD			64		/* Register accesses over which the
+									   tokens of a frame are spread */
+#define HOST_IRQ_MAX		64		/* Interrupt entries for one request */
+#define HOST_RETRY_MAX		100		/* NAKs of one enumeration stage */
+#define HOST_CTRL_EVERY		16		/* Frames between GET_REPORT requests */
+#define HOST_CTRL_TIMEOUT	8		/* Frames for a GET_REPORT request */
+#define HOST_SHORT_EVERY	50		/* Every n-th OUT report is short */
+#define HOST_SHORT_LEN		8
+#define HOST_PAUSE_EVERY	1000	/* Frames between application pauses */
+#define HOST_PAUSE_FRAMES	12		/* Frames without HID_Task(): OutBuf
+									   fills, InBuf does not run empty */
+#define HOST_MIN_RATE		63.0	/* Expected IN rate, KB/s */
+
+/* From the example */
+extern const USBDEV_CFG_Type USB_Cfg;
+extern uint32_t InSequence;
+void USB_IRQHandler(void);
+
+/* Host side state */
+static uint8_t host_addr;
+static uint32_t host_frame;
+static struct {
+	uint32_t In;			/* IN reports received */
+	uint32_t InNak;
+	uint32_t Lost;			/* Reports missing in the sequence */
+	uint32_t Bad;			/* Wrong reports or token results */
+	uint32_t ResetDrop;		/* Reports dropped by the bus reset */
+	uint32_t Out;			/* OUT reports accepted */
+	uint32_t OutBytes;
+	uint32_t OutNak;
+	uint32_t OutDrop;		/* Accepted, dropped by the bus reset */
+	uint32_t Ctrl;			/* GET_REPORT requests done */
+	uint32_t CtrlTimeout;
+} host;
+static uint32_t host_inseq;
+static int host_insync;
+static uint32_t host_outseq;
+
+/* GET_REPORT request during the run, one stage per token */
+static struct {
+	int state;				/* 0 idle, 1 setup, 2 data, 3 status */
+	int pending;
+	uint32_t start;
+} ctl;
+
+/*********************************************************************//**
+ * @brief		Stub: the peripheral power is not modelled
+ **********************************************************************/
+void CLKPWR_ConfigPPWR(uint32_t PPType, FunctionalState NewState)
+{
+	(void)PPType;
+	(void)NewState;
+}
+
+/*********************************************************************//**
+ * @brief		CHECK_PARAM failure of the drivers: stop the test
+ * @param[in]	file	Source file name
+ * @param[in]	line	Source line number
+ * @return		None
+ **********************************************************************/
+void check_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "check failed: %s line %u\n", (char *)file, (unsigned)line);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Stop the test
+ * @param[in]	msg		Reason
+ * @return		None
+ **********************************************************************/
+static void host_Fail(const char *msg)
+{
+	fprintf(stderr, "FAIL: %s (frame %u)\n", msg, (unsigned)host_frame);
+	exit(1);
+}
+
+/*********************************************************************//**
+ * @brief		Service the USB interrupt while it is requested
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Irq(void)
+{
+	uint32_t n;
+
+	for (n = 0; USBSIM_IrqPending(); n++) {
+		if (n == HOST_IRQ_MAX) {
+			host_Fail("interrupt request not cleared");
+		}
+		USB_IRQHandler();
+	}
+	USBSIM_Check();
+}
+
+/*********************************************************************//**
+ * @brief		Control transfer to endpoint 0, stage by stage with the
+ * 				interrupt serviced after each token
+ * @param[in]	setup	Setup packet
+ * @param[in,out]	data	Data stage, wLength bytes plus a packet
+ * @return		Data stage length, -1 on error
+ **********************************************************************/
+static int host_Control(const uint8_t *setup, uint8_t *data)
+{
+	uint32_t len, done, n, tries;
+	int in, r;
+	uint8_t zlp[USB_MAX_PACKET0];
+
+	len = setup[6] | (setup[7] << 8);
+	in = (setup[0] & 0x80) != 0;
+	if (USBSIM_Setup(host_addr, setup) != USBSIM_ACK) {
+		return -1;
+	}
+	host_Irq();
+
+	for (done = 0; done < len; ) {
+		n = len - done;
+		if (n > USB_MAX_PACKET0) {
+			n = USB_MAX_PACKET0;
+		}
+		for (tries = 0; ; tries++) {
+			r = in ? USBSIM_In(host_addr, 0, data + done) :
+					USBSIM_Out(host_addr, 0, data + done, n);
+			host_Irq();
+			if ((r != USBSIM_NAK) || (tries == HOST_RETRY_MAX)) {
+				break;
+			}
+		}
+		if (r < 0) {
+			return -1;
+		}
+		if (in) {
+			done += r;
+			if (r < USB_MAX_PACKET0) {
+				break;							/* Short packet */
+			}
+		} else {
+			done += n;
+		}
+	}
+
+	for (tries = 0; ; tries++) {
+		r = in ? USBSIM_Out(host_addr, 0, NULL, 0) : USBSIM_In(host_addr, 0, zlp);
+		host_Irq();
+		if ((r != USBSIM_NAK) || (tries == HOST_RETRY_MAX)) {
+			break;
+		}
+	}
+	return (r == 0) ? (int)done : -1;
+}
+
+/*********************************************************************//**
+ * @brief		Build a setup packet
+ **********************************************************************/
+static void host_SetupPacket(uint8_t *s, uint8_t type, uint8_t req,
+							uint16_t value, uint16_t index, uint16_t len)
+{
+	s[0] = type;
+	s[1] = req;
+	s[2] = (uint8_t)value;
+	s[3] = (uint8_t)(value >> 8);
+	s[4] = (uint8_t)index;
+	s[5] = (uint8_t)(index >> 8);
+	s[6] = (uint8_t)len;
+	s[7] = (uint8_t)(len >> 8);
+}
+
+/*********************************************************************//**
+ * @brief		Bus reset and enumeration: descriptors checked against
+ * 				the example, address, configuration, idle rate 0
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Enumerate(void)
+{
+	uint8_t setup[8];
+	uint8_t buf[512];
+	int n, total;
+
+	host_addr = 0;
+	USBSIM_BusReset();
+	host_Irq();
+
+	host_SetupPacket(setup, 0x80, 6, 0x0100, 0, 64);
+	n = host_Control(setup, buf);
+	if ((n != 18) || (memcmp(buf, USB_DeviceDescriptor, 18) != 0)) {
+		host_Fail("device descriptor");
+	}
+	host_SetupPacket(setup, 0x00, 5, HOST_ADDR, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_ADDRESS");
+	}
+	host_addr = HOST_ADDR;
+
+	host_SetupPacket(setup, 0x80, 6, 0x0200, 0, 9);
+	if (host_Control(setup, buf) != 9) {
+		host_Fail("configuration descriptor header");
+	}
+	total = buf[2] | (buf[3] << 8);
+	host_SetupPacket(setup, 0x80, 6, 0x0200, 0, total);
+	n = host_Control(setup, buf);
+	if ((n != total) || (memcmp(buf, USB_ConfigDescriptor, total) != 0)) {
+		host_Fail("configuration descriptor");
+	}
+
+	host_SetupPacket(setup, 0x00, 9, 1, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_CONFIGURATION");
+	}
+	host_SetupPacket(setup, 0x21, 0x0A, 0, 0, 0);
+	if (host_Control(setup, buf) != 0) {
+		host_Fail("SET_IDLE");
+	}
+	host_SetupPacket(setup, 0x81, 6, 0x2200, 0, HID_ReportDescSize);
+	n = host_Control(setup, buf);
+	if ((n != HID_ReportDescSize) ||
+			(memcmp(buf, HID_ReportDescriptor, HID_ReportDescSize) != 0)) {
+		host_Fail("report descriptor");
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Interrupt endpoints of a frame: one IN token, checking
+ * 				the report sequence and pattern of HID_Task(), and one
+ * 				OUT token
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Interrupt(void)
+{
+	uint8_t buf[HID_REPORT_SIZE];
+	uint32_t seq, n, len;
+	int r;
+
+	r = USBSIM_In(host_addr, HID_EP_IN & 0x0F, buf);
+	if (r == USBSIM_NAK) {
+		host.InNak++;
+	} else if (r != HID_REPORT_SIZE) {
+		host.Bad++;
+	} else {
+		seq = buf[1] | (buf[2] << 8) | (buf[3] << 16) | ((uint32_t)buf[4] << 24);
+		for (n = 5; (n < HID_REPORT_SIZE) && (buf[n] == (uint8_t)(seq + n)); n++);
+		if ((n < HID_REPORT_SIZE) || (buf[0] != 0x01)) {
+			host.Bad++;
+		} else if (!host_insync) {
+			host.ResetDrop += seq - host_inseq;
+		} else if (seq > host_inseq) {
+			host.Lost += seq - host_inseq;
+		} else if (seq < host_inseq) {
+			host.Bad++;							/* Repeated */
+		}
+		host_insync = 1;
+		host_inseq = seq + 1;
+		host.In++;
+	}
+
+	len = ((host_outseq % HOST_SHORT_EVERY) == 0) ? HOST_SHORT_LEN : HID_REPORT_SIZE;
+	for (n = 0; n < len; n++) {
+		buf[n] = (uint8_t)(host_outseq + n);
+	}
+	r = USBSIM_Out(host_addr, HID_EP_OUT, buf, len);
+	if (r == USBSIM_ACK) {
+		host.Out++;
+		host.OutBytes += len;
+		host_outseq++;
+	} else if (r == USBSIM_NAK) {
+		host.OutNak++;
+	} else {
+		host.Bad++;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Next token of the GET_REPORT request, rescheduled at a
+ * 				random later register access until the request is done
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_CtrlStep(void)
+{
+	uint8_t setup[8];
+	uint8_t buf[USB_MAX_PACKET0];
+	uint32_t n;
+	int r;
+
+	ctl.pending = 0;
+	switch (ctl.state) {
+	case 1:
+		host_SetupPacket(setup, 0xA1, 0x01, HID_REPORT_INPUT << 8, 0, HID_REPORT_SIZE);
+		if (USBSIM_Setup(host_addr, setup) != USBSIM_ACK) {
+			host.Bad++;
+			ctl.state = 0;
+			return;
+		}
+		ctl.state = 2;
+		break;
+	case 2:
+		r = USBSIM_In(host_addr, 0, buf);
+		if (r == USBSIM_NAK) {
+			break;
+		}
+		for (n = 1; (n < HID_REPORT_SIZE) && (buf[n] == 0); n++);
+		if ((r != HID_REPORT_SIZE) || (n < HID_REPORT_SIZE) || (buf[0] != 0x01)) {
+			host.Bad++;
+			ctl.state = 0;
+			return;
+		}
+		ctl.state = 3;
+		break;
+	case 3:
+		r = USBSIM_Out(host_addr, 0, NULL, 0);
+		if (r == USBSIM_NAK) {
+			break;
+		}
+		if (r != USBSIM_ACK) {
+			host.Bad++;
+		} else {
+			host.Ctrl++;
+		}
+		ctl.state = 0;
+		return;
+	default:
+		return;
+	}
+	ctl.pending = 1;
+	USBSIM_Async(rand() % HOST_SPREAD, host_CtrlStep);
+}
+
+/*********************************************************************//**
+ * @brief		One frame: start of frame, tokens at random register
+ * 				accesses, HID_Task() unless the application pauses
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void host_Frame(void)
+{
+	USBSIM_Frame();
+	USBSIM_Async(rand() % HOST_SPREAD, host_Interrupt);
+
+	if (ctl.state != 0) {
+		if (host_frame - ctl.start > HOST_CTRL_TIMEOUT) {
+			host.CtrlTimeout++;
+			ctl.state = 0;
+		}
+	} else if ((host_frame % HOST_CTRL_EVERY) == 0) {
+		ctl.state = 1;
+		ctl.start = host_frame;
+	}
+	if ((ctl.state != 0) && !ctl.pending) {
+		ctl.pending = 1;
+		USBSIM_Async(rand() % HOST_SPREAD, host_CtrlStep);
+	}
+
+	host_Irq();
+	if ((host_frame % HOST_PAUSE_EVERY) >= HOST_PAUSE_FRAMES) {
+		HID_Task();
+	}
+	host_Irq();
+	USBSIM_Flush();
+	host_Irq();
+}
+
+/*********************************************************************//**
+ * @brief		Print the interrupt statistics of an event, in register
+ * 				accesses (the model counter stands for DWT_CYCCNT)
+ **********************************************************************/
+static void host_PrintStat(const char *name, USBDEV_ISR_STAT_Type *stat)
+{
+	printf("  %-10s %9u events, %6.1f accesses avg, %4u max\n", name,
+			(unsigned)stat->Count,
+			stat->Count ? (double)stat->Cycles / stat->Count : 0.0,
+			(unsigned)stat->Max);
+}
+
+/*********************************************************************//**
+ * @brief		Main program: hid_host [frames [seed]]
+ **********************************************************************/
+int main(int argc, char *argv[])
+{
+	USBDEV_STATS_Type stats;
+	USBSIM_STATS_Type sim;
+	uint32_t frames, fail, n;
+	double inrate, outrate;
+
+	frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : HOST_FRAMES;
+	srand((argc > 2) ? (unsigned)strtoul(argv[2], NULL, 0) : 1);
+
+	USBSIM_Init();
+	LPC_GPIO2->FIODIR = LEDMSK;					/* As main() of the example */
+	LPC_GPIO1->FIODIR = 0xF0000000;
+	HID_Init();
+	USB_Init(&USB_Cfg);
+	USB_Connect(TRUE);
+
+	host_Enumerate();
+	USB_ClearStats();
+	for (host_frame = 1; host_frame <= frames; host_frame++) {
+		if (host_frame == frames / 2) {
+			USBSIM_Flush();
+			host_Irq();
+			ctl.state = 0;
+			ctl.pending = 0;
+			host_insync = 0;
+			host_Enumerate();
+			host.OutDrop = host.Out - HID_Queue.OutCount;
+		}
+		host_Frame();
+	}
+	/* Last OUT reports to the application */
+	for (n = 0; n < 4; n++) {
+		USBSIM_Frame();
+		host_Irq();
+		HID_Task();
+		host_Irq();
+	}
+
+	USB_GetStats(&stats);
+	USBSIM_GetStats(&sim);
+	inrate = (double)host.In * HID_REPORT_SIZE / frames;
+	outrate = (double)host.OutBytes / frames;
+
+	printf("%u frames, bus reset at frame %u\n", (unsigned)frames, (unsigned)(frames / 2));
+	printf("IN:  %8u reports %6.2f KB/s, %u lost, %u dropped by the reset, %u NAK, %u idle frames\n",
+			(unsigned)host.In, inrate, (unsigned)host.Lost, (unsigned)host.ResetDrop,
+			(unsigned)host.InNak, (unsigned)HID_Queue.InIdle);
+	printf("OUT: %8u reports %6.2f KB/s, %u dropped by the reset, %u NAK, %u hold frames\n",
+			(unsigned)host.Out, outrate, (unsigned)host.OutDrop, (unsigned)host.OutNak,
+			(unsigned)HID_Queue.OutHolds);
+	printf("EP0: %8u GET_REPORT, %u timed out\n", (unsigned)host.Ctrl, (unsigned)host.CtrlTimeout);
+	printf("Bad reports or tokens: %u, queue errors: %u\n", (unsigned)host.Bad, (unsigned)HID_Queue.Errors);
+	printf("Model: %u register accesses (%.1f per frame), %u SIE commands, %u DMA packets\n",
+			(unsigned)sim.Accesses, (double)sim.Accesses / frames,
+			(unsigned)sim.Commands, (unsigned)sim.DmaPackets);
+	printf("Model: %u programming errors%s%s, %u stranded endpoint interrupts\n",
+			(unsigned)sim.Violations, sim.Violations ? ", first: " : "",
+			USBSIM_Violation(), (unsigned)sim.Stranded);
+	printf("Interrupt handler (register accesses):\n");
+	host_PrintStat("Total", &stats.Total);
+	host_PrintStat("Frame", &stats.Frame);
+	host_PrintStat("EP0 OUT", &stats.EP[0]);
+	host_PrintStat("EP0 IN", &stats.EP[1]);
+	host_PrintStat("EP1 OUT", &stats.EP[2]);
+	host_PrintStat("EP1 IN", &stats.EP[3]);
+
+	fail = host.Lost | host.Bad | host.CtrlTimeout | HID_Queue.Errors |
+			sim.Violations | sim.Stranded;
+	if (OutReport != (uint8_t)(host_outseq - 1)) {
+		printf("Last OUT report not seen by the application\n");
+		fail = 1;
+	}
+	if ((HID_Queue.OutCount + host.OutDrop != host.Out) || (host.Ctrl == 0)) {
+		printf("OUT reports or GET_REPORT requests missing\n");
+		fail = 1;
+	}
+	if (inrate < HOST_MIN_RATE) {
+		printf("IN rate under %.1f KB/s\n", HOST_MIN_RATE);
+		fail = 1;
+	}
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
@@ -19,128 +19,108 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "hid.h"
-#include "usbcfg.h"
-#include "usbcore.h"
+#include "lpc17xx_usbdev_hid.h"
+#include "usbdesc.h"
 #include "hiduser.h"
 
 #include "demo.h"
 
 
-uint8_t HID_Protocol;
-uint8_t HID_IdleTime[HID_REPORT_NUM];
+/* HID class driver instance */
+USBDEV_HID_Type HID_Dev;
+
+/* Report queue serving the interrupt endpoints by USB DMA */
+USBDEV_HID_QUEUE_Type HID_Queue;
 
 
 /*
  *  HID Get Report Request Callback
- *   Called automatically on HID Get Report Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
+ *   Called by the HID class driver on HID Get Report Request
+ *    Parameters:      hid: HID class driver instance
+ *                     type: report type, id: report ID
+ *                     buf: report buffer, len: buffer size in, report size out
  *    Return Value:    TRUE - Success, FALSE - Error
  */
 
-uint32_t HID_GetReport (void) {
+static uint32_t HID_GetReport (USBDEV_HID_Type *hid, uint8_t type, uint8_t id,
+                               uint8_t *buf, uint32_t *len) {
+  uint32_t n;
 
-  /* ReportID = SetupPacket.wValue.WB.L; */
-  switch (SetupPacket.wValue.WB.H) {
+  switch (type) {
     case HID_REPORT_INPUT:
+      if (*len < HID_REPORT_SIZE) {
+        return (FALSE);
+      }
       GetInReport();
-      EP0Buf[0] = InReport;
-      break;
+      buf[0] = InReport;
+      for (n = 1; n < HID_REPORT_SIZE; n++) {
+        buf[n] = 0;
+      }
+      *len = HID_REPORT_SIZE;
+      return (TRUE);
     case HID_REPORT_OUTPUT:
       return (FALSE);          /* Not Supported */
     case HID_REPORT_FEATURE:
-      /* EP0Buf[] = ...; */
-      /* break; */
       return (FALSE);          /* Not Supported */
   }
-  return (TRUE);
+  return (FALSE);
 }
 
 
 /*
  *  HID Set Report Request Callback
- *   Called automatically on HID Set Report Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
+ *   Called by the HID class driver on HID Set Report Request
+ *    Parameters:      hid: HID class driver instance
+ *                     type: report type, id: report ID
+ *                     buf: report received, len: report size
  *    Return Value:    TRUE - Success, FALSE - Error
  */
 
-uint32_t HID_SetReport (void) {
+static uint32_t HID_SetReport (USBDEV_HID_Type *hid, uint8_t type, uint8_t id,
+                               uint8_t *buf, uint32_t len) {
 
-  /* ReportID = SetupPacket.wValue.WB.L; */
-  switch (SetupPacket.wValue.WB.H) {
+  switch (type) {
     case HID_REPORT_INPUT:
       return (FALSE);          /* Not Supported */
     case HID_REPORT_OUTPUT:
-      OutReport = EP0Buf[0];
+      OutReport = buf[0];
       SetOutReport();
-      break;
+      return (TRUE);
     case HID_REPORT_FEATURE:
       return (FALSE);          /* Not Supported */
   }
-  return (TRUE);
-}
-
-
-/*
- *  HID Get Idle Request Callback
- *   Called automatically on HID Get Idle Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t HID_GetIdle (void) {
-
-  EP0Buf[0] = HID_IdleTime[SetupPacket.wValue.WB.L];
-  return (TRUE);
+  return (FALSE);
 }
 
 
 /*
- *  HID Set Idle Request Callback
- *   Called automatically on HID Set Idle Request
- *    Parameters:      None (global SetupPacket)
- *    Return Value:    TRUE - Success, FALSE - Error
+ *  HID Initialization
+ *   Registers the HID class driver, the interrupt endpoints are served
+ *   by the report queue: input reports are posted by HID_Task(), output
+ *   reports are read by it
+ *    Parameters:      None
+ *    Return Value:    None
  */
 
-uint32_t HID_SetIdle (void) {
-
-  HID_IdleTime[SetupPacket.wValue.WB.L] = SetupPacket.wValue.WB.H;
-
-  /* Idle Handling if needed */
-  /* ... */
-
-  return (TRUE);
-}
-
-
-/*
- *  HID Get Protocol Request Callback
- *   Called automatically on HID Get Protocol Request
- *    Parameters:      None (global SetupPacket)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t HID_GetProtocol (void) {
-
-  EP0Buf[0] = HID_Protocol;
-  return (TRUE);
-}
-
-
-/*
- *  HID Set Protocol Request Callback
- *   Called automatically on HID Set Protocol Request
- *    Parameters:      None (global SetupPacket)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t HID_SetProtocol (void) {
-
-  HID_Protocol = SetupPacket.wValue.WB.L;
-
-  /* Protocol Handling if needed */
-  /* ... */
-
-  return (TRUE);
+void HID_Init (void) {
+
+  HID_Queue.ReportSize = HID_REPORT_SIZE;
+  HID_Queue.InSlots = HID_IN_SLOTS;
+  HID_Queue.OutSlots = HID_OUT_SLOTS;
+  HID_Queue.InBuf = (uint8_t *)DMA_BUF_ADR;
+  HID_Queue.OutBuf = (uint8_t *)DMA_BUF_ADR + HID_IN_SLOTS * HID_REPORT_SIZE;
+
+  HID_Dev.IF = 0;
+  HID_Dev.EP_IN = HID_EP_IN;
+  HID_Dev.EP_OUT = HID_EP_OUT;
+  HID_Dev.NumReports = HID_REPORT_NUM;
+  HID_Dev.HidDescriptor = &USB_ConfigDescriptor[HID_DESC_OFFSET];
+  HID_Dev.ReportDescriptor = HID_ReportDescriptor;
+  HID_Dev.ReportDescSize = HID_ReportDescSize;
+  HID_Dev.GetReport = HID_GetReport;
+  HID_Dev.SetReport = HID_SetReport;
+  HID_Dev.InReady = NULL;
+  HID_Dev.OutReport = NULL;
+  HID_Dev.Queue = &HID_Queue;
+  USB_HidInit(&HID_Dev);
 }
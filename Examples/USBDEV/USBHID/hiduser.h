@@ -23,17 +23,23 @@
 /* HID Number of Reports */
 #define HID_REPORT_NUM      1
 
-/* HID Global Variables */
-extern uint8_t HID_Protocol;
-extern uint8_t HID_IdleTime[HID_REPORT_NUM];
-
-/* HID Requests Callback Functions */
-extern uint32_t HID_GetReport   (void);
-extern uint32_t HID_SetReport   (void);
-extern uint32_t HID_GetIdle     (void);
-extern uint32_t HID_SetIdle     (void);
-extern uint32_t HID_GetProtocol (void);
-extern uint32_t HID_SetProtocol (void);
+/* HID Interrupt In/Out Endpoint Addresses */
+#define HID_EP_IN           0x81
+#define HID_EP_OUT          0x01
+
+/* HID Report Size: Max Packet Size of both Interrupt Endpoints */
+#define HID_REPORT_SIZE     HID_QUEUE_REPORT_MAX
+
+/* HID Report Queue Slots (powers of 2), in USB RAM at DMA_BUF_ADR */
+#define HID_IN_SLOTS        32
+#define HID_OUT_SLOTS       4
+
+/* HID Class Driver Instance and its Report Queue */
+extern USBDEV_HID_Type HID_Dev;
+extern USBDEV_HID_QUEUE_Type HID_Queue;
+
+/* HID Initialization Function */
+extern void HID_Init (void);
 
 
 #endif  /* __HIDUSER_H__ */
@@ -101,8 +101,9 @@
 //#define _I2S
 
 /* USB device ------------------------------- */
-//#define _USBDEV
-//#define _USB_DMA
+#define _USBDEV
+#define _USB_DMA
+#define _USBDEV_HID
 
 /* QEI ------------------------------- */
 //#define _QEI
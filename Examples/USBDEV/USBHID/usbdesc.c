@@ -18,11 +18,9 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "usbcfg.h"
+#include "lpc17xx_usbdev_hid.h"
 #include "usbdesc.h"
-
-#include "hid.h"
+#include "hiduser.h"
 
 /* HID Report Descriptor */
 const uint8_t HID_ReportDescriptor[] = {
@@ -40,6 +38,13 @@ const uint8_t HID_ReportDescriptor[] = {
     HID_ReportCount(1),
     HID_ReportSize(5),
     HID_Input(HID_Constant),
+    HID_UsagePageVendor(0x00),
+    HID_Usage(0x02),
+    HID_LogicalMin(0),
+    HID_LogicalMaxS(0xFF),
+    HID_ReportCount(HID_REPORT_SIZE - 1),
+    HID_ReportSize(8),
+    HID_Input(HID_Data | HID_Variable | HID_Absolute),
     HID_UsagePage(HID_USAGE_PAGE_LED),
     HID_Usage(HID_USAGE_LED_GENERIC_INDICATOR),
     HID_LogicalMin(0),
@@ -47,138 +52,115 @@ const uint8_t HID_ReportDescriptor[] = {
     HID_ReportCount(8),
     HID_ReportSize(1),
     HID_Output(HID_Data | HID_Variable | HID_Absolute),
+    HID_UsagePageVendor(0x00),
+    HID_Usage(0x03),
+    HID_LogicalMin(0),
+    HID_LogicalMaxS(0xFF),
+    HID_ReportCount(HID_REPORT_SIZE - 1),
+    HID_ReportSize(8),
+    HID_Output(HID_Data | HID_Variable | HID_Absolute),
   HID_EndCollection,
 };
 
 const uint16_t HID_ReportDescSize = sizeof(HID_ReportDescriptor);
 
 
+/* Checks of the descriptors against the USB definitions and hiduser.h */
+USB_DESC_ASSERT(ep0_size, (USB_MAX_PACKET0 == 8) || (USB_MAX_PACKET0 == 16)
+                       || (USB_MAX_PACKET0 == 32) || (USB_MAX_PACKET0 == 64));
+USB_DESC_ASSERT(report_size, (HID_REPORT_SIZE > 0) && (HID_REPORT_SIZE <= 64));
+USB_DESC_ASSERT(ep_in_dir, (HID_EP_IN & USB_ENDPOINT_DIRECTION_MASK) != 0);
+USB_DESC_ASSERT(ep_out_dir, (HID_EP_OUT & USB_ENDPOINT_DIRECTION_MASK) == 0);
+USB_DESC_ASSERT(config1_packed, sizeof(USB_CONFIG1_DESC) == USB_CONFIGUARTION_DESC_SIZE
+                + USB_INTERFACE_DESC_SIZE + HID_DESC_SIZE + 2 * USB_ENDPOINT_DESC_SIZE);
+USB_DESC_ASSERT(hid_desc_size, HID_DESC_SIZE == 9);
+USB_DESC_ASSERT(string_num, USB_STR_NUM <= USB_STRING_NUM);
+
 /* USB Standard Device Descriptor */
-const uint8_t USB_DeviceDescriptor[] = {
+const USB_DEVICE_DESCRIPTOR USB_DeviceDesc = {
   USB_DEVICE_DESC_SIZE,              /* bLength */
   USB_DEVICE_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  WBVAL(0x0200), /* 2.00 */          /* bcdUSB */
+  0x0200, /* 2.00 */                 /* bcdUSB */
   0x00,                              /* bDeviceClass */
   0x00,                              /* bDeviceSubClass */
   0x00,                              /* bDeviceProtocol */
   USB_MAX_PACKET0,                   /* bMaxPacketSize0 */
-  WBVAL(0xC251),                     /* idVendor */
-  WBVAL(0x2201),                     /* idProduct */
-  WBVAL(0x0100), /* 1.00 */          /* bcdDevice */
-  0x04,                              /* iManufacturer */
-  0x20,                              /* iProduct */
-  0x42,                              /* iSerialNumber */
+  0xC251,                            /* idVendor */
+  0x2201,                            /* idProduct */
+  0x0100, /* 1.00 */                 /* bcdDevice */
+  USB_STR_MANUFACTURER,              /* iManufacturer */
+  USB_STR_PRODUCT,                   /* iProduct */
+  USB_STR_SERIAL,                    /* iSerialNumber */
   0x01                               /* bNumConfigurations */
 };
 
 /* USB Configuration Descriptor */
 /*   All Descriptors (Configuration, Interface, Endpoint, Class, Vendor */
-const uint8_t USB_ConfigDescriptor[] = {
+const USB_CONFIG_DESC USB_ConfigDesc = {
 /* Configuration 1 */
-  USB_CONFIGUARTION_DESC_SIZE,       /* bDescriptorType */
-  USB_CONFIGURATION_DESCRIPTOR_TYPE, /* bDescriptorType */
-  WBVAL(                             /* wTotalLength */
-    USB_CONFIGUARTION_DESC_SIZE +
-    USB_INTERFACE_DESC_SIZE     +
-    HID_DESC_SIZE               +
-    USB_ENDPOINT_DESC_SIZE
-  ),
-  0x01,                              /* bNumInterfaces */
-  0x01,                              /* bConfigurationValue */
-  0x00,                              /* iConfiguration */
-  USB_CONFIG_BUS_POWERED /*|*/       /* bmAttributes */
-/*USB_CONFIG_REMOTE_WAKEUP*/,
-  USB_CONFIG_POWER_MA(100),          /* bMaxPower */
+ {
+  USB_CONFIG_DESC_INIT(USB_CONFIG1_DESC,
+    0x01,                            /* bNumInterfaces */
+    0x01,                            /* bConfigurationValue */
+    0x00,                            /* iConfiguration */
+    USB_CONFIG_BUS_POWERED /*|*/     /* bmAttributes */
+  /*USB_CONFIG_REMOTE_WAKEUP*/,
+    USB_CONFIG_POWER_MA(100)),       /* bMaxPower */
 /* Interface 0, Alternate Setting 0, HID Class */
-  USB_INTERFACE_DESC_SIZE,           /* bLength */
-  USB_INTERFACE_DESCRIPTOR_TYPE,     /* bDescriptorType */
-  0x00,                              /* bInterfaceNumber */
-  0x00,                              /* bAlternateSetting */
-  0x01,                              /* bNumEndpoints */
-  USB_DEVICE_CLASS_HUMAN_INTERFACE,  /* bInterfaceClass */
-  HID_SUBCLASS_NONE,                 /* bInterfaceSubClass */
-  HID_PROTOCOL_NONE,                 /* bInterfaceProtocol */
-  0x5C,                              /* iInterface */
-/* HID Class Descriptor */
-/* HID_DESC_OFFSET = 0x0012 */
-  HID_DESC_SIZE,                     /* bLength */
-  HID_HID_DESCRIPTOR_TYPE,           /* bDescriptorType */
-  WBVAL(0x0100), /* 1.00 */          /* bcdHID */
-  0x00,                              /* bCountryCode */
-  0x01,                              /* bNumDescriptors */
-  HID_REPORT_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  WBVAL(HID_REPORT_DESC_SIZE),       /* wDescriptorLength */
+  USB_INTERFACE_DESC_INIT(
+    0x00,                            /* bInterfaceNumber */
+    0x00,                            /* bAlternateSetting */
+    USB_DESC_ENDPOINTS(USB_CONFIG1_DESC, EpIn), /* bNumEndpoints */
+    USB_DEVICE_CLASS_HUMAN_INTERFACE,/* bInterfaceClass */
+    HID_SUBCLASS_NONE,               /* bInterfaceSubClass */
+    HID_PROTOCOL_NONE,               /* bInterfaceProtocol */
+    USB_STR_INTERFACE0),             /* iInterface */
+/* HID Class Descriptor, at HID_DESC_OFFSET */
+  {
+    HID_DESC_SIZE,                   /* bLength */
+    HID_HID_DESCRIPTOR_TYPE,         /* bDescriptorType */
+    0x0100, /* 1.00 */               /* bcdHID */
+    0x00,                            /* bCountryCode */
+    0x01,                            /* bNumDescriptors */
+    {{
+      HID_REPORT_DESCRIPTOR_TYPE,    /* bDescriptorType */
+      HID_REPORT_DESC_SIZE           /* wDescriptorLength */
+    }}
+  },
 /* Endpoint, HID Interrupt In */
-  USB_ENDPOINT_DESC_SIZE,            /* bLength */
-  USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
-  USB_ENDPOINT_IN(1),                /* bEndpointAddress */
-  USB_ENDPOINT_TYPE_INTERRUPT,       /* bmAttributes */
-  WBVAL(0x0004),                     /* wMaxPacketSize */
-  0x20,          /* 32ms */          /* bInterval */
+  USB_ENDPOINT_DESC_INIT(
+    HID_EP_IN,                       /* bEndpointAddress */
+    USB_ENDPOINT_TYPE_INTERRUPT,     /* bmAttributes */
+    HID_REPORT_SIZE,                 /* wMaxPacketSize */
+    0x01),         /* 1ms */         /* bInterval */
+/* Endpoint, HID Interrupt Out */
+  USB_ENDPOINT_DESC_INIT(
+    HID_EP_OUT,                      /* bEndpointAddress */
+    USB_ENDPOINT_TYPE_INTERRUPT,     /* bmAttributes */
+    HID_REPORT_SIZE,                 /* wMaxPacketSize */
+    0x01)          /* 1ms */         /* bInterval */
+ },
 /* Terminator */
   0                                  /* bLength */
 };
 
 /* USB String Descriptor (optional) */
-const uint8_t USB_StringDescriptor[] = {
+const USB_STRING_DESC_TABLE USB_StringDesc = {
 /* Index 0x00: LANGID Codes */
-  0x04,                              /* bLength */
-  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  WBVAL(0x0409), /* US English */    /* wLANGID */
-/* Index 0x04: Manufacturer */
-  0x1C,                              /* bLength */
-  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  'N',0,
-  'X',0,
-  'P',0,
-  ' ',0,
-  'S',0,
-  'E',0,
-  'M',0,
-  'I',0,
-  'C',0,
-  'O',0,
-  'N',0,
-  'D',0,
-  ' ',0,
-/* Index 0x20: Product */
-  0x22,                              /* bLength */
-  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  'L',0,
-  'P',0,
-  'C',0,
-  '1',0,
-  '7',0,
-  'x',0,
-  'x',0,
-  ' ',0,
-  'H',0,
-  'I',0,
-  'D',0,
-  ' ',0,
-  ' ',0,
-  ' ',0,
-  ' ',0,
-  ' ',0,
-/* Index 0x42: Serial Number */
-  0x1A,                              /* bLength */
-  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  'D',0,
-  'E',0,
-  'M',0,
-  'O',0,
-  '0',0,
-  '0',0,
-  '0',0,
-  '0',0,
-  '0',0,
-  '0',0,
-  '0',0,
-  '0',0,
-/* Index 0x5C: Interface 0, Alternate Setting 0 */
-  0x08,                              /* bLength */
-  USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
-  'H',0,
-  'I',0,
-  'D',0,
+  { USB_STRING_DESC_HDR(1),
+    { 0x0409 } },                    /* wLANGID: US English */
+/* Index 0x01: Manufacturer */
+  { USB_STRING_DESC_HDR(13),
+    { 'N','X','P',' ','S','E','M','I','C','O','N','D',' ' } },
+/* Index 0x02: Product */
+  { USB_STRING_DESC_HDR(16),
+    { 'L','P','C','1','7','x','x',' ','H','I','D',' ',' ',' ',' ',' ' } },
+/* Index 0x03: Serial Number */
+  { USB_STRING_DESC_HDR(12),
+    { 'D','E','M','O','0','0','0','0','0','0','0','0' } },
+/* Index 0x04: Interface 0, Alternate Setting 0 */
+  { USB_STRING_DESC_HDR(3),
+    { 'H','I','D' } },
+/* Terminator */
+  0                                  /* bLength */
 };
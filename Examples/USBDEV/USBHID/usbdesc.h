@@ -18,20 +18,55 @@
 #define __USBDESC_H__
 
 
-#define WBVAL(x) (x & 0xFF),((x >> 8) & 0xFF)
+#include "lpc17xx_usbdev_hid.h"
 
-#define USB_DEVICE_DESC_SIZE        (sizeof(USB_DEVICE_DESCRIPTOR))
-#define USB_CONFIGUARTION_DESC_SIZE (sizeof(USB_CONFIGURATION_DESCRIPTOR))
-#define USB_INTERFACE_DESC_SIZE     (sizeof(USB_INTERFACE_DESCRIPTOR))
-#define USB_ENDPOINT_DESC_SIZE      (sizeof(USB_ENDPOINT_DESCRIPTOR))
+/* Max Packet Size of Endpoint 0 */
+#define USB_MAX_PACKET0             64
 
-#define HID_DESC_OFFSET              0x0012
+/* String Descriptor Indexes */
+#define USB_STR_LANGID              0x00
+#define USB_STR_MANUFACTURER        0x01
+#define USB_STR_PRODUCT             0x02
+#define USB_STR_SERIAL              0x03
+#define USB_STR_INTERFACE0          0x04
+#define USB_STR_NUM                 5
+
+/* Configuration 1: descriptors in the order they are sent */
+typedef struct {
+  USB_CONFIGURATION_DESCRIPTOR Config;
+  USB_INTERFACE_DESCRIPTOR     Interface0;
+  HID_DESCRIPTOR               Hid;
+  USB_ENDPOINT_DESCRIPTOR      EpIn;
+  USB_ENDPOINT_DESCRIPTOR      EpOut;
+} USB_CONFIG1_DESC;
+
+/* All Configurations */
+typedef struct {
+  USB_CONFIG1_DESC             Config1;
+  uint8_t                      Terminator;
+} USB_CONFIG_DESC;
+
+/* String Descriptors in index order */
+typedef struct {
+  USB_STRING_DESC(1)           LangId;
+  USB_STRING_DESC(13)          Manufacturer;
+  USB_STRING_DESC(16)          Product;
+  USB_STRING_DESC(12)          Serial;
+  USB_STRING_DESC(3)           Interface0;
+  uint8_t                      Terminator;
+} USB_STRING_DESC_TABLE;
+
+#define HID_DESC_OFFSET             offsetof(USB_CONFIG_DESC, Config1.Hid)
 #define HID_DESC_SIZE               (sizeof(HID_DESCRIPTOR))
 #define HID_REPORT_DESC_SIZE        (sizeof(HID_ReportDescriptor))
 
-extern const uint8_t USB_DeviceDescriptor[];
-extern const uint8_t USB_ConfigDescriptor[];
-extern const uint8_t USB_StringDescriptor[];
+extern const USB_DEVICE_DESCRIPTOR USB_DeviceDesc;
+extern const USB_CONFIG_DESC USB_ConfigDesc;
+extern const USB_STRING_DESC_TABLE USB_StringDesc;
+
+#define USB_DeviceDescriptor        ((const uint8_t *)&USB_DeviceDesc)
+#define USB_ConfigDescriptor        ((const uint8_t *)&USB_ConfigDesc)
+#define USB_StringDescriptor        ((const uint8_t *)&USB_StringDesc)
 
 extern const uint8_t HID_ReportDescriptor[];
 extern const uint16_t HID_ReportDescSize;
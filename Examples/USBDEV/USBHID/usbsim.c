@@ -0,0 +1,1059 @@
+/**********************************************************************
+* $Id$		usbsim.c			2011-03-09
+*//**
+* @file		usbsim.c
+* @brief	Host model of the LPC17xx USB device controller. The register
+* 			page is kept inaccessible: each access of the driver faults,
+* 			is single-stepped and applied to the model, so the driver
+* 			runs unmodified. Modelled: device and endpoint interrupts,
+* 			posted SIE commands, single buffered endpoints, the slave
+* 			transfer registers and USB DMA on non-isochronous endpoints
+* 			through the UDCA and its descriptors. x86-64 Linux only.
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "LPC17xx.h"
+#include "usbsim.h"
+
+/* Memory of the device used by the driver and the example */
+#define SIM_SRAM_ADR		0x2007C000UL	/* AHB SRAM, USB RAM in bank 1 */
+#define SIM_SRAM_SZ			0x00008000UL
+#define SIM_GPIO_SZ			0x00004000UL
+#define SIM_PINCON_SZ		0x00001000UL
+#define SIM_SCS_ADR			0xE0000000UL	/* DWT, NVIC, SCB, CoreDebug */
+#define SIM_SCS_SZ			0x00010000UL
+#define SIM_REG_SZ			0x00001000UL	/* USB registers, trapped */
+
+/* Cycle counter of the driver statistics: one count per register access */
+#define SIM_DWT_CYCCNT		(*((volatile uint32_t *)0xE0001004UL))
+
+/* Register access */
+#define SIM_OFS(reg)		offsetof(LPC_USB_TypeDef, reg)
+#define SIM_REG(ofs)		(*((volatile uint32_t *)(LPC_USB_BASE + (ofs))))
+
+/* x86 trap flag, page fault write access */
+#define SIM_EFL_TF			0x00000100
+#define SIM_ERR_WRITE		0x00000002
+
+/* Register accesses taken by a SIE command and by endpoint realization */
+#define SIM_SIE_LATENCY		3
+#define SIM_RLZED_LATENCY	2
+
+#define SIM_EP_NUM			32
+#define SIM_PKT_MAX			64
+#define SIM_ASYNC_NUM		8
+
+/* Device Interrupt Bit Definitions */
+#define FRAME_INT			0x00000001
+#define EP_SLOW_INT			0x00000004
+#define DEV_STAT_INT		0x00000008
+#define CCEMTY_INT			0x00000010
+#define CDFULL_INT			0x00000020
+#define EP_RLZED_INT		0x00000100
+
+/* Rx Packet Length, Control Register Bit Definitions */
+#define PKT_DV				0x00000400
+#define PKT_RDY				0x00000800
+#define CTRL_RD_EN			0x00000001
+#define CTRL_WR_EN			0x00000002
+
+/* SIE command phases and codes */
+#define PHASE_WRITE			0x01
+#define PHASE_READ			0x02
+#define PHASE_COMMAND		0x05
+#define CODE_SET_ADDR		0xD0
+#define CODE_CFG_DEV		0xD8
+#define CODE_SET_MODE		0xF3
+#define CODE_RD_FRAME		0xF5
+#define CODE_RD_TEST		0xFD
+#define CODE_DEV_STAT		0xFE
+#define CODE_RD_ERR_CODE	0xFF
+#define CODE_RD_ERR_STAT	0xFB
+#define CODE_CLR_BUF		0xF2
+#define CODE_VALID_BUF		0xFA
+#define CODE_SEL_EP			0x00
+#define CODE_SEL_EP_CLRI	0x40
+
+/* Device Status, Endpoint Status Bit Definitions */
+#define DEV_EN				0x80
+#define DEV_CON				0x01
+#define DEV_CON_CH			0x02
+#define DEV_SUS_CH			0x08
+#define DEV_RST				0x10
+#define EP_STAT_ST			0x01
+#define EP_STAT_DA			0x20
+
+/* DMA interrupts, descriptor fields */
+#define EOT_INT				0x01
+#define NDD_REQ_INT			0x02
+#define SYS_ERR_INT			0x04
+#define DD_NEXT_VALID		0x00000004
+#define DD_ISO				0x00000010
+#define DD_RETIRED			0x00000001
+#define DD_ST_BUSY			0x01
+#define DD_ST_DONE			0x02
+#define DD_ST_UNDER_RUN		0x03
+#define DD_ST_OVER_RUN		0x08
+
+/** Endpoint buffer: single buffered */
+typedef struct {
+	uint8_t data[SIM_PKT_MAX];
+	uint32_t len;
+	uint32_t maxp;
+	uint8_t full;
+	uint8_t setup;
+	uint8_t stall;
+	uint8_t disabled;
+	uint8_t nak;
+} SIM_EP_Type;
+
+/** Pending host function */
+typedef struct {
+	uint32_t count;
+	USBSIM_ASYNC_FUNC func;
+} SIM_ASYNC_Type;
+
+/** Controller state */
+static struct {
+	/* Device interrupts, SIE */
+	uint32_t devintst;
+	uint32_t devinten;
+	uint32_t cmd;
+	uint32_t cmddata;
+	uint32_t busy;
+	uint32_t done;
+	uint32_t sel;
+	uint32_t framebyte;
+	uint32_t rlzed;
+	/* Transfer registers */
+	uint32_t ctrl;
+	uint32_t rxep;
+	uint32_t rxpos;
+	uint32_t rxdata;
+	uint32_t txep;
+	uint32_t txlen;
+	uint32_t txpos;
+	uint8_t tx[SIM_PKT_MAX];
+	/* Endpoints */
+	uint32_t epintst;
+	uint32_t epinten;
+	uint32_t reep;
+	uint32_t epind;
+	SIM_EP_Type ep[SIM_EP_NUM];
+	/* DMA */
+	uint32_t dmarst;
+	uint32_t udcah;
+	uint32_t epdmast;
+	uint32_t dmainten;
+	uint32_t eot;
+	uint32_t nddr;
+	uint32_t syserr;
+	uint32_t nddrsent;
+	/* Device */
+	uint32_t clk;
+	uint32_t frame;
+	uint8_t addr;
+	uint8_t deven;
+	uint8_t configured;
+	uint8_t devstat;
+} sim;
+
+/* Access being single-stepped */
+static volatile int sim_inhandler;
+static uint32_t sim_ofs;
+static uint32_t sim_write;
+static uint32_t sim_before;
+
+static SIM_ASYNC_Type sim_async[SIM_ASYNC_NUM];
+static USBSIM_STATS_Type sim_stats;
+static char sim_violation[160];
+
+/*********************************************************************//**
+ * @brief		Count a programming error of the driver, keep the first
+ * @param[in]	msg		Description
+ * @return 		None
+ **********************************************************************/
+static void sim_Violation(const char *msg)
+{
+	if (sim_stats.Violations++ == 0) {
+		snprintf(sim_violation, sizeof(sim_violation),
+				"%s (register 0x%03X, access %u)", msg,
+				(unsigned)sim_ofs, (unsigned)sim_stats.Accesses);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Status byte of an endpoint, Select Endpoint command
+ * @param[in]	n		Physical endpoint
+ * @return 		Status
+ **********************************************************************/
+static uint32_t sim_EpStatus(uint32_t n)
+{
+	SIM_EP_Type *ep = &sim.ep[n];
+
+	return (ep->full ? 0x21 : 0) | (ep->stall ? 0x02 : 0) |
+			(ep->setup ? 0x04 : 0) | (ep->nak ? 0x10 : 0);
+}
+
+/*********************************************************************//**
+ * @brief		Start a SIE command, its interrupt flags are set once
+ * 				it has run
+ * @param[in]	done	CCEMTY_INT, CDFULL_INT
+ * @return 		None
+ **********************************************************************/
+static void sim_Post(uint32_t done)
+{
+	sim.busy = SIM_SIE_LATENCY;
+	sim.done = done;
+}
+
+/*********************************************************************//**
+ * @brief		Move packets between an endpoint buffer and its DMA
+ * 				descriptors while the endpoint has a DMA request
+ * @param[in]	n		Physical endpoint
+ * @return 		None
+ **********************************************************************/
+static void sim_Dma(uint32_t n)
+{
+	SIM_EP_Type *ep = &sim.ep[n];
+	volatile uint32_t *udca, *dd;
+	uint32_t bit, maxsize, buflen, count, len, status;
+	uint8_t *buf;
+
+	bit = 1UL << n;
+	if ((sim.epdmast & bit) == 0) {
+		return;
+	}
+	udca = (volatile uint32_t *)(uintptr_t)sim.udcah;
+	for (;;) {
+		/* IN: buffer empty, OUT: packet received */
+		if ((n & 1) ? ep->full : !ep->full) {
+			return;
+		}
+		sim.dmarst |= bit;
+		dd = (volatile uint32_t *)(uintptr_t)udca[n];
+		if ((dd == NULL) || (dd[3] & DD_RETIRED)) {
+			if ((sim.nddrsent & bit) == 0) {
+				sim.nddr |= bit;
+				sim.nddrsent |= bit;
+			}
+			return;
+		}
+		sim.nddrsent &= ~bit;
+		if (dd[1] & DD_ISO) {
+			sim_Violation("isochronous DMA descriptor");
+			return;
+		}
+		maxsize = (dd[1] >> 5) & 0x7FF;
+		buflen = dd[1] >> 16;
+		count = dd[3] >> 16;
+		buf = (uint8_t *)(uintptr_t)(dd[2] + count);
+		if ((maxsize == 0) || (maxsize > ep->maxp)) {
+			sim_Violation("DMA packet size over the endpoint packet size");
+			return;
+		}
+
+		status = DD_ST_BUSY;
+		if (n & 1) {
+			len = buflen - count;
+			if (len > maxsize) {
+				len = maxsize;
+			}
+			memcpy(ep->data, buf, len);
+			ep->len = len;
+			ep->full = 1;
+			count += len;
+			if (count >= buflen) {
+				status = DD_ST_DONE;
+			}
+		} else {
+			len = ep->len;
+			if (count + len > buflen) {
+				len = buflen - count;
+				status = DD_ST_OVER_RUN;
+			}
+			memcpy(buf, ep->data, len);
+			count += len;
+			if (status == DD_ST_BUSY) {
+				if (ep->len < maxsize) {
+					status = DD_ST_UNDER_RUN;	/* Short packet ends it */
+				} else if (count >= buflen) {
+					status = DD_ST_DONE;
+				}
+			}
+			ep->full = 0;
+			ep->setup = 0;
+		}
+		sim_stats.DmaPackets++;
+		sim.dmarst &= ~bit;
+
+		if (status == DD_ST_BUSY) {
+			dd[3] = (count << 16) | (status << 1) | (dd[3] & 0xFF00);
+			continue;
+		}
+		dd[3] = (count << 16) | (status << 1) | DD_RETIRED | (dd[3] & 0xFF00);
+		sim.eot |= bit;
+		if (dd[1] & DD_NEXT_VALID) {
+			udca[n] = dd[0];
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Endpoint event: slave interrupt, or DMA request when the
+ * 				endpoint interrupt is disabled
+ * @param[in]	n		Physical endpoint
+ * @return 		None
+ **********************************************************************/
+static void sim_EpEvent(uint32_t n)
+{
+	uint32_t bit = 1UL << n;
+
+	if (sim.epinten & bit) {
+		sim.epintst |= bit;
+		sim.devintst |= EP_SLOW_INT;
+	} else {
+		sim.dmarst |= bit;
+		sim_Dma(n);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		SIE command register written
+ * @param[in]	val		Phase and code or data
+ * @return 		None
+ **********************************************************************/
+static void sim_Command(uint32_t val)
+{
+	SIM_EP_Type *ep;
+	uint32_t phase, code;
+
+	phase = (val >> 8) & 0xFF;
+	code = (val >> 16) & 0xFF;
+	if (sim.busy) {
+		sim_Violation("SIE command written while the previous one runs");
+	}
+	sim_stats.Commands++;
+
+	switch (phase) {
+	case PHASE_COMMAND:
+		sim.cmd = code;
+		sim.framebyte = 0;
+		if (code < CODE_SEL_EP + SIM_EP_NUM) {
+			sim.sel = code - CODE_SEL_EP;
+		} else if ((code >= CODE_SEL_EP_CLRI) && (code < CODE_SEL_EP_CLRI + SIM_EP_NUM)) {
+			sim.sel = code - CODE_SEL_EP_CLRI;
+		} else if (code == CODE_CLR_BUF) {
+			ep = &sim.ep[sim.sel];
+			if (sim.sel & 1) {
+				sim_Violation("Clear Buffer on an IN endpoint");
+			}
+			ep->full = 0;
+			ep->setup = 0;
+		} else if (code == CODE_VALID_BUF) {
+			ep = &sim.ep[sim.sel];
+			if (((sim.sel & 1) == 0) || (sim.txep != sim.sel) || (sim.txpos < sim.txlen)) {
+				sim_Violation("Validate Buffer without a written packet");
+			} else if (ep->full) {
+				sim_Violation("Validate Buffer on a full IN buffer");
+			} else {
+				memcpy(ep->data, sim.tx, sim.txlen);
+				ep->len = sim.txlen;
+				ep->full = 1;
+				ep->nak = 0;
+			}
+			sim.txep = SIM_EP_NUM;
+		} else if ((code != CODE_SET_ADDR) && (code != CODE_CFG_DEV) &&
+				(code != CODE_SET_MODE) && (code != CODE_RD_FRAME) &&
+				(code != CODE_RD_TEST) && (code != CODE_DEV_STAT) &&
+				(code != CODE_RD_ERR_CODE) && (code != CODE_RD_ERR_STAT)) {
+			sim_Violation("unknown SIE command");
+		}
+		sim_Post(CCEMTY_INT);
+		break;
+
+	case PHASE_WRITE:
+		if (sim.cmd == CODE_SET_ADDR) {
+			sim.addr = code & 0x7F;
+			sim.deven = (code & DEV_EN) != 0;
+		} else if (sim.cmd == CODE_CFG_DEV) {
+			sim.configured = code & 1;
+		} else if (sim.cmd == CODE_DEV_STAT) {
+			if ((code ^ sim.devstat) & DEV_CON) {
+				sim.devstat ^= DEV_CON;
+			}
+		} else if ((sim.cmd >= CODE_SEL_EP_CLRI) && (sim.cmd < CODE_SEL_EP_CLRI + SIM_EP_NUM)) {
+			ep = &sim.ep[sim.sel];
+			ep->stall = (code & EP_STAT_ST) != 0;
+			ep->disabled = (code & EP_STAT_DA) != 0;
+		} else if (sim.cmd != CODE_SET_MODE) {
+			sim_Violation("SIE data written to a command without data");
+		}
+		sim_Post(CCEMTY_INT);
+		break;
+
+	case PHASE_READ:
+		if (code != sim.cmd) {
+			sim_Violation("SIE data read for another command");
+		}
+		if (code == CODE_DEV_STAT) {
+			sim.cmddata = sim.devstat;
+			sim.devstat &= ~(DEV_CON_CH | DEV_SUS_CH | DEV_RST);
+		} else if (code == CODE_RD_FRAME) {
+			sim.cmddata = (sim.framebyte++ == 0) ? (sim.frame & 0xFF) : (sim.frame >> 8);
+		} else if (code < CODE_SEL_EP + SIM_EP_NUM) {
+			sim.cmddata = sim_EpStatus(sim.sel);
+		} else if ((code >= CODE_SEL_EP_CLRI) && (code < CODE_SEL_EP_CLRI + SIM_EP_NUM)) {
+			sim.cmddata = sim_EpStatus(sim.sel);
+			sim.epintst &= ~(1UL << sim.sel);
+		} else if (code == CODE_RD_TEST) {
+			sim.cmddata = (sim.framebyte++ == 0) ? 0x10 : 0xA5;
+		} else {
+			sim.cmddata = 0;
+		}
+		sim_Post(CCEMTY_INT | CDFULL_INT);
+		break;
+
+	default:
+		sim_Violation("bad SIE command phase");
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register read: prepare its value
+ * @param[in]	ofs		Register offset
+ * @return 		None
+ **********************************************************************/
+static void sim_Read(uint32_t ofs)
+{
+	SIM_EP_Type *ep;
+
+	if (ofs == SIM_OFS(USBRxData)) {
+		ep = &sim.ep[sim.rxep];
+		if (((sim.ctrl & CTRL_RD_EN) == 0) || !ep->full || (sim.rxpos >= ep->len)) {
+			sim_Violation("RxData read with no packet being read");
+			sim.rxdata = 0;
+			return;
+		}
+		sim.rxdata = 0;
+		memcpy(&sim.rxdata, &ep->data[sim.rxpos], (ep->len - sim.rxpos < 4) ? ep->len - sim.rxpos : 4);
+		sim.rxpos += 4;
+		if (sim.rxpos >= ep->len) {
+			sim.ctrl &= ~CTRL_RD_EN;			/* Whole packet read */
+		}
+	} else if (ofs == SIM_OFS(USBCmdData)) {
+		if ((sim.devintst & CDFULL_INT) == 0) {
+			sim_Violation("CmdData read before CDFULL");
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register written: apply it
+ * @param[in]	ofs		Register offset
+ * @param[in]	val		Value written
+ * @return 		None
+ **********************************************************************/
+static void sim_Write(uint32_t ofs, uint32_t val)
+{
+	uint32_t n;
+
+	switch (ofs) {
+	case SIM_OFS(USBDevIntEn):
+		sim.devinten = val;
+		break;
+	case SIM_OFS(USBDevIntClr):
+		sim.devintst &= ~val;
+		break;
+	case SIM_OFS(USBDevIntSet):
+		sim.devintst |= val;
+		break;
+	case SIM_OFS(USBCmdCode):
+		sim_Command(val);
+		break;
+	case SIM_OFS(USBTxData):
+		if (((sim.ctrl & CTRL_WR_EN) == 0) || (sim.txpos >= sim.txlen)) {
+			sim_Violation("TxData written with no packet being written");
+			break;
+		}
+		memcpy(&sim.tx[sim.txpos], &val, (sim.txlen - sim.txpos < 4) ? sim.txlen - sim.txpos : 4);
+		sim.txpos += 4;
+		break;
+	case SIM_OFS(USBTxPLen):
+		if ((sim.ctrl & CTRL_WR_EN) == 0) {
+			sim_Violation("TxPLen written without WR_EN");
+			break;
+		}
+		sim.txlen = val & 0x3FF;
+		sim.txpos = 0;
+		if (sim.txlen > sim.ep[sim.txep].maxp) {
+			sim_Violation("IN packet over the endpoint packet size");
+			sim.txlen = sim.ep[sim.txep].maxp;
+		}
+		break;
+	case SIM_OFS(USBCtrl):
+		sim.ctrl = val & (CTRL_RD_EN | CTRL_WR_EN | 0x3C);
+		n = (val >> 2) & 0x0F;
+		if (val & CTRL_RD_EN) {
+			sim.rxep = n * 2;
+			sim.rxpos = 0;
+			if (!sim.ep[sim.rxep].full) {
+				sim_Violation("endpoint read with an empty buffer");
+			}
+		}
+		if (val & CTRL_WR_EN) {
+			sim.txep = n * 2 + 1;
+			sim.txlen = 0;
+			sim.txpos = 0;
+		}
+		break;
+	case SIM_OFS(USBDevIntPri):
+	case SIM_OFS(USBEpIntPri):
+		break;
+	case SIM_OFS(USBEpIntEn):
+		sim.epinten = val;
+		break;
+	case SIM_OFS(USBEpIntClr):
+		/* Clears the interrupts, Select Endpoint/Clear Interrupt of the
+		 * lowest one runs in the SIE */
+		sim.epintst &= ~val;
+		if (val != 0) {
+			for (n = 0; (val & (1UL << n)) == 0; n++);
+			if (sim.busy) {
+				sim_Violation("EpIntClr written while a SIE command runs");
+			}
+			sim.cmd = CODE_SEL_EP_CLRI + n;
+			sim.sel = n;
+			sim.cmddata = sim_EpStatus(n);
+			sim_Post(CCEMTY_INT | CDFULL_INT);
+		}
+		break;
+	case SIM_OFS(USBEpIntSet):
+		sim.epintst |= val;
+		sim.devintst |= EP_SLOW_INT;
+		break;
+	case SIM_OFS(USBReEp):
+		sim.reep = val | 3;
+		sim.rlzed = SIM_RLZED_LATENCY;
+		break;
+	case SIM_OFS(USBEpInd):
+		sim.epind = val & (SIM_EP_NUM - 1);
+		break;
+	case SIM_OFS(USBMaxPSize):
+		if ((val & 0x3FF) > SIM_PKT_MAX) {
+			sim_Violation("packet size over the model buffers");
+		}
+		sim.ep[sim.epind].maxp = val & 0x3FF;
+		sim.rlzed = SIM_RLZED_LATENCY;
+		break;
+	case SIM_OFS(USBDMARClr):
+		sim.dmarst &= ~val;
+		break;
+	case SIM_OFS(USBDMARSet):
+		sim.dmarst |= val;
+		for (n = 0; n < SIM_EP_NUM; n++) {
+			if (val & (1UL << n)) {
+				sim_Dma(n);
+			}
+		}
+		break;
+	case SIM_OFS(USBUDCAH):
+		sim.udcah = val & ~0x7FUL;
+		break;
+	case SIM_OFS(USBEpDMAEn):
+		if (val & 3) {
+			sim_Violation("DMA enabled on endpoint 0");
+		}
+		sim.epdmast |= val & ~3UL;
+		for (n = 2; n < SIM_EP_NUM; n++) {
+			if (val & (1UL << n)) {
+				sim_Dma(n);
+			}
+		}
+		break;
+	case SIM_OFS(USBEpDMADis):
+		sim.epdmast &= ~val;
+		break;
+	case SIM_OFS(USBDMAIntEn):
+		sim.dmainten = val;
+		break;
+	case SIM_OFS(USBEoTIntClr):
+		sim.eot &= ~val;
+		break;
+	case SIM_OFS(USBEoTIntSet):
+		sim.eot |= val;
+		break;
+	case SIM_OFS(USBNDDRIntClr):
+		sim.nddr &= ~val;
+		break;
+	case SIM_OFS(USBNDDRIntSet):
+		sim.nddr |= val;
+		break;
+	case SIM_OFS(USBSysErrIntClr):
+		sim.syserr &= ~val;
+		break;
+	case SIM_OFS(USBSysErrIntSet):
+		sim.syserr |= val;
+		break;
+	case SIM_OFS(USBClkCtrl):
+		sim.clk = val;
+		break;
+	default:
+		sim_Violation("write to a read-only or unmodelled register");
+		break;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Refresh the readable register values
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_Publish(void)
+{
+	SIM_EP_Type *ep = &sim.ep[sim.rxep];
+
+	memset((void *)LPC_USB_BASE, 0, SIM_REG_SZ);
+	SIM_REG(SIM_OFS(USBDevIntSt)) = sim.devintst;
+	SIM_REG(SIM_OFS(USBDevIntEn)) = sim.devinten;
+	SIM_REG(SIM_OFS(USBCmdData)) = sim.cmddata;
+	SIM_REG(SIM_OFS(USBRxData)) = sim.rxdata;
+	if ((sim.ctrl & CTRL_RD_EN) && ep->full) {
+		SIM_REG(SIM_OFS(USBRxPLen)) = PKT_RDY | PKT_DV | ep->len;
+	}
+	SIM_REG(SIM_OFS(USBCtrl)) = sim.ctrl;
+	SIM_REG(SIM_OFS(USBEpIntSt)) = sim.epintst;
+	SIM_REG(SIM_OFS(USBEpIntEn)) = sim.epinten;
+	SIM_REG(SIM_OFS(USBReEp)) = sim.reep;
+	SIM_REG(SIM_OFS(USBMaxPSize)) = sim.ep[sim.epind].maxp;
+	SIM_REG(SIM_OFS(USBDMARSt)) = sim.dmarst;
+	SIM_REG(SIM_OFS(USBUDCAH)) = sim.udcah;
+	SIM_REG(SIM_OFS(USBEpDMASt)) = sim.epdmast;
+	SIM_REG(SIM_OFS(USBDMAIntSt)) = (sim.eot ? EOT_INT : 0) |
+				(sim.nddr ? NDD_REQ_INT : 0) | (sim.syserr ? SYS_ERR_INT : 0);
+	SIM_REG(SIM_OFS(USBDMAIntEn)) = sim.dmainten;
+	SIM_REG(SIM_OFS(USBEoTIntSt)) = sim.eot;
+	SIM_REG(SIM_OFS(USBNDDRIntSt)) = sim.nddr;
+	SIM_REG(SIM_OFS(USBSysErrIntSt)) = sim.syserr;
+	SIM_REG(SIM_OFS(USBClkCtrl)) = sim.clk;
+	SIM_REG(SIM_OFS(USBClkSt)) = sim.clk;
+}
+
+/*********************************************************************//**
+ * @brief		Publish the registers after a change made by the host
+ * 				outside of a register access
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_Update(void)
+{
+	if (!sim_inhandler) {
+		mprotect((void *)LPC_USB_BASE, SIM_REG_SZ, PROT_READ | PROT_WRITE);
+		sim_Publish();
+		mprotect((void *)LPC_USB_BASE, SIM_REG_SZ, PROT_NONE);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		One register access: SIE progress, pending host functions
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+static void sim_Tick(void)
+{
+	uint32_t n;
+
+	sim_stats.Accesses++;
+	SIM_DWT_CYCCNT++;
+	if ((sim.busy != 0) && (--sim.busy == 0)) {
+		sim.devintst |= sim.done;
+	}
+	if ((sim.rlzed != 0) && (--sim.rlzed == 0)) {
+		sim.devintst |= EP_RLZED_INT;
+	}
+	for (n = 0; n < SIM_ASYNC_NUM; n++) {
+		if ((sim_async[n].func != NULL) && (sim_async[n].count != 0)) {
+			sim_async[n].count--;
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Run the host functions that are due
+ * @param[in]	all		TRUE to run all of them
+ * @return 		None
+ **********************************************************************/
+static void sim_RunAsync(int all)
+{
+	USBSIM_ASYNC_FUNC func;
+	uint32_t n;
+
+	for (n = 0; n < SIM_ASYNC_NUM; n++) {
+		func = sim_async[n].func;
+		if ((func != NULL) && (all || (sim_async[n].count == 0))) {
+			sim_async[n].func = NULL;
+			func();
+		}
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Register page fault: prepare the access, single-step it
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Fault(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uintptr_t adr = (uintptr_t)si->si_addr;
+
+	(void)sig;
+	if ((adr < LPC_USB_BASE) || (adr >= LPC_USB_BASE + SIM_REG_SZ) || sim_inhandler) {
+		signal(SIGSEGV, SIG_DFL);				/* Real fault: faults again */
+		return;
+	}
+	sim_inhandler = 1;
+	mprotect((void *)LPC_USB_BASE, SIM_REG_SZ, PROT_READ | PROT_WRITE);
+	sim_ofs = (uint32_t)(adr - LPC_USB_BASE);
+	sim_write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_ERR_WRITE) != 0;
+	if (sim_ofs & 3) {
+		sim_Violation("unaligned register access");
+	}
+	sim_ofs &= ~3UL;
+	sim_Tick();
+	if (!sim_write) {
+		sim_Read(sim_ofs);
+	}
+	sim_Publish();
+	sim_before = SIM_REG(sim_ofs);
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFL_TF;
+}
+
+/*********************************************************************//**
+ * @brief		Access done: apply a write, publish, protect the page
+ * @param[in]	sig, si, ctx	Signal handler arguments
+ * @return 		None
+ **********************************************************************/
+static void sim_Step(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = (ucontext_t *)ctx;
+	uint32_t val;
+
+	(void)sig;
+	(void)si;
+	if (!sim_inhandler) {
+		signal(SIGTRAP, SIG_DFL);
+		raise(SIGTRAP);
+		return;
+	}
+	uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFL_TF;
+	val = SIM_REG(sim_ofs);
+	/* Read-modify-write instructions may fault as a read */
+	if (sim_write || (val != sim_before)) {
+		sim_Write(sim_ofs, val);
+	}
+	sim_RunAsync(0);
+	sim_Publish();
+	mprotect((void *)LPC_USB_BASE, SIM_REG_SZ, PROT_NONE);
+	sim_inhandler = 0;
+}
+
+/*********************************************************************//**
+ * @brief		Map a memory region of the device
+ * @param[in]	adr		Address
+ * @param[in]	size	Size
+ * @param[in]	prot	Protection
+ * @return 		None
+ **********************************************************************/
+static void sim_Map(uintptr_t adr, size_t size, int prot)
+{
+	void *p;
+
+	p = mmap((void *)adr, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if (p != (void *)adr) {
+		fprintf(stderr, "usbsim: cannot map 0x%08lX\n", (unsigned long)adr);
+		exit(2);
+	}
+}
+
+/* Public Functions ----------------------------------------------------------- */
+
+/*********************************************************************//**
+ * @brief		Map the device memory and registers, install the access
+ * 				traps. The device is disconnected with endpoint 0
+ * 				realized, as after power-up
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USBSIM_Init(void)
+{
+	struct sigaction sa;
+
+	sim_Map(SIM_SRAM_ADR, SIM_SRAM_SZ, PROT_READ | PROT_WRITE);
+	sim_Map(LPC_GPIO_BASE, SIM_GPIO_SZ, PROT_READ | PROT_WRITE);
+	sim_Map(LPC_PINCON_BASE, SIM_PINCON_SZ, PROT_READ | PROT_WRITE);
+	sim_Map(SIM_SCS_ADR, SIM_SCS_SZ, PROT_READ | PROT_WRITE);
+	sim_Map(LPC_USB_BASE, SIM_REG_SZ, PROT_READ | PROT_WRITE);
+
+	memset(&sim, 0, sizeof(sim));
+	sim.reep = 3;
+	sim.ep[0].maxp = 8;
+	sim.ep[1].maxp = 8;
+	sim.txep = SIM_EP_NUM;
+	sim_Publish();
+	mprotect((void *)LPC_USB_BASE, SIM_REG_SZ, PROT_NONE);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sim_Fault;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = sim_Step;
+	sigaction(SIGTRAP, &sa, NULL);
+}
+
+/*********************************************************************//**
+ * @brief		USB interrupt request line of the controller
+ * @param[in]	None
+ * @return 		Non zero if the interrupt is requested
+ **********************************************************************/
+uint32_t USBSIM_IrqPending(void)
+{
+	uint32_t dmaintst;
+
+	dmaintst = (sim.eot ? EOT_INT : 0) | (sim.nddr ? NDD_REQ_INT : 0) |
+				(sim.syserr ? SYS_ERR_INT : 0);
+	return ((sim.devintst & sim.devinten) != 0) || ((dmaintst & sim.dmainten) != 0);
+}
+
+/*********************************************************************//**
+ * @brief		Check the controller once the interrupt is serviced:
+ * 				an enabled endpoint interrupt must not be left pending
+ * 				without the slow interrupt that reports it
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USBSIM_Check(void)
+{
+	if ((sim.epintst & sim.epinten) && ((sim.devintst & EP_SLOW_INT) == 0)) {
+		sim_stats.Stranded++;
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Bus reset by the host: default address, not configured,
+ * 				endpoint buffers empty
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USBSIM_BusReset(void)
+{
+	uint32_t n;
+
+	sim.addr = 0;
+	sim.deven = 1;
+	sim.configured = 0;
+	sim.reep = 3;
+	for (n = 0; n < SIM_EP_NUM; n++) {
+		sim.ep[n].full = 0;
+		sim.ep[n].setup = 0;
+		sim.ep[n].stall = 0;
+		sim.ep[n].disabled = 0;
+		sim.ep[n].nak = 0;
+	}
+	sim.devstat |= DEV_RST;
+	sim.devintst |= DEV_STAT_INT;
+	sim_Update();
+}
+
+/*********************************************************************//**
+ * @brief		Start of frame
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USBSIM_Frame(void)
+{
+	sim.frame = (sim.frame + 1) & 0x7FF;
+	sim.devintst |= FRAME_INT;
+	sim_Update();
+}
+
+/*********************************************************************//**
+ * @brief		Host sends the device address and endpoint of a token
+ * @param[in]	addr	Device address
+ * @param[in]	n		Physical endpoint
+ * @return 		TRUE if the device answers it
+ **********************************************************************/
+static int sim_Responds(uint8_t addr, uint32_t n)
+{
+	return sim.deven && (addr == sim.addr) && (sim.devstat & DEV_CON) &&
+			(sim.reep & (1UL << n)) && !sim.ep[n].disabled &&
+			((n < 2) || sim.configured);
+}
+
+/*********************************************************************//**
+ * @brief		SETUP token and its 8 data bytes to endpoint 0
+ * @param[in]	addr	Device address
+ * @param[in]	setup	Setup packet
+ * @return 		USBSIM_ACK or USBSIM_NORESP
+ **********************************************************************/
+int USBSIM_Setup(uint8_t addr, const uint8_t *setup)
+{
+	SIM_EP_Type *ep = &sim.ep[0];
+
+	if (!sim_Responds(addr, 0)) {
+		return USBSIM_NORESP;
+	}
+	memcpy(ep->data, setup, 8);
+	ep->len = 8;
+	ep->full = 1;
+	ep->setup = 1;
+	sim.ep[0].stall = 0;
+	sim.ep[1].stall = 0;
+	sim_EpEvent(0);
+	sim_Update();
+	return USBSIM_ACK;
+}
+
+/*********************************************************************//**
+ * @brief		IN token
+ * @param[in]	addr	Device address
+ * @param[in]	epnum	Endpoint number
+ * @param[out]	buf		Packet, endpoint packet size at most
+ * @return 		Packet length, USBSIM_NAK, USBSIM_STALL or USBSIM_NORESP
+ **********************************************************************/
+int USBSIM_In(uint8_t addr, uint8_t epnum, uint8_t *buf)
+{
+	uint32_t n = (epnum & 0x0F) * 2 + 1;
+	SIM_EP_Type *ep = &sim.ep[n];
+	int len;
+
+	if (!sim_Responds(addr, n)) {
+		return USBSIM_NORESP;
+	}
+	if (ep->stall) {
+		return USBSIM_STALL;
+	}
+	if (!ep->full) {
+		ep->nak = 1;
+		return USBSIM_NAK;
+	}
+	memcpy(buf, ep->data, ep->len);
+	len = (int)ep->len;
+	ep->full = 0;
+	ep->nak = 0;
+	sim_EpEvent(n);
+	sim_Update();
+	return len;
+}
+
+/*********************************************************************//**
+ * @brief		OUT token and its data
+ * @param[in]	addr	Device address
+ * @param[in]	epnum	Endpoint number
+ * @param[in]	buf		Packet
+ * @param[in]	len		Packet length, endpoint packet size at most
+ * @return 		USBSIM_ACK, USBSIM_NAK, USBSIM_STALL or USBSIM_NORESP
+ **********************************************************************/
+int USBSIM_Out(uint8_t addr, uint8_t epnum, const uint8_t *buf, uint32_t len)
+{
+	uint32_t n = (epnum & 0x0F) * 2;
+	SIM_EP_Type *ep = &sim.ep[n];
+
+	if (!sim_Responds(addr, n) || (len > ep->maxp)) {
+		return USBSIM_NORESP;
+	}
+	if (ep->stall) {
+		return USBSIM_STALL;
+	}
+	if (ep->full) {
+		ep->nak = 1;
+		return USBSIM_NAK;
+	}
+	if (len != 0) {
+		memcpy(ep->data, buf, len);
+	}
+	ep->len = len;
+	ep->full = 1;
+	ep->setup = 0;
+	ep->nak = 0;
+	sim_EpEvent(n);
+	sim_Update();
+	return USBSIM_ACK;
+}
+
+/*********************************************************************//**
+ * @brief		Run a host function after some register accesses of the
+ * 				device, as the bus runs alongside the processor
+ * @param[in]	accesses	Register accesses to wait for
+ * @param[in]	func		Function, may use the token functions
+ * @return 		None
+ **********************************************************************/
+void USBSIM_Async(uint32_t accesses, USBSIM_ASYNC_FUNC func)
+{
+	uint32_t n;
+
+	for (n = 0; n < SIM_ASYNC_NUM; n++) {
+		if (sim_async[n].func == NULL) {
+			sim_async[n].count = accesses + 1;
+			sim_async[n].func = func;
+			return;
+		}
+	}
+	func();										/* No slot: run it now */
+}
+
+/*********************************************************************//**
+ * @brief		Run the pending host functions now, once each
+ * @param[in]	None
+ * @return 		None
+ **********************************************************************/
+void USBSIM_Flush(void)
+{
+	sim_RunAsync(1);
+}
+
+/*********************************************************************//**
+ * @brief		Read the model counters
+ * @param[out]	stats	Point to USBSIM_STATS_Type structure
+ * @return 		None
+ **********************************************************************/
+void USBSIM_GetStats(USBSIM_STATS_Type *stats)
+{
+	*stats = sim_stats;
+}
+
+/*********************************************************************//**
+ * @brief		First programming error seen by the model
+ * @param[in]	None
+ * @return 		Description, empty if none
+ **********************************************************************/
+const char *USBSIM_Violation(void)
+{
+	return sim_violation;
+}
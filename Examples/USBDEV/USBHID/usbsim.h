@@ -0,0 +1,66 @@
+/**********************************************************************
+* $Id$		usbsim.h			2011-03-09
+*//**
+* @file		usbsim.h
+* @brief	Host model of the LPC17xx USB device controller: registers,
+* 			SIE commands, endpoint buffers and USB DMA, driven by the
+* 			unmodified device driver and by host side USB tokens
+* @version	1.0
+* @date		09. March. 2011
+* @author	NXP MCU SW Application Team
+*
+* Copyright(C) 2011, NXP Semiconductor
+* All rights reserved.
+*
+***********************************************************************
+* Software that is described herein is for illustrative purposes only
+* which provides customers with programming information regarding the
+* products. This software is supplied "AS IS" without any warranties.
+* NXP Semiconductors assumes no responsibility or liability for the
+* use of the software, conveys no license or title under any patent,
+* copyright, or mask work right to the product. NXP Semiconductors
+* reserves the right to make changes in the software without
+* notification. NXP Semiconductors also make no representation or
+* warranty that such application will be suitable for the specified
+* use without further testing or modification.
+**********************************************************************/
+#ifndef __USBSIM_H
+#define __USBSIM_H
+
+#include <stdint.h>
+
+/** Token results other than a data length */
+#define USBSIM_ACK			0		/**< OUT or SETUP data accepted */
+#define USBSIM_NAK			(-1)	/**< Endpoint not ready */
+#define USBSIM_STALL		(-2)	/**< Endpoint stalled */
+#define USBSIM_NORESP		(-3)	/**< Address or endpoint not enabled */
+
+/** Host function run at a later register access of the device */
+typedef void (*USBSIM_ASYNC_FUNC)(void);
+
+/**
+ * @brief Model counters
+ */
+typedef struct {
+	uint32_t Accesses;		/**< Register accesses of the device */
+	uint32_t Commands;		/**< SIE commands */
+	uint32_t Violations;	/**< Programming errors seen by the model */
+	uint32_t DmaPackets;	/**< Packets moved by USB DMA */
+	uint32_t Stranded;		/**< Endpoint interrupts left pending with
+							 the device slow interrupt cleared */
+} USBSIM_STATS_Type;
+
+void USBSIM_Init(void);
+uint32_t USBSIM_IrqPending(void);
+void USBSIM_Check(void);
+void USBSIM_BusReset(void);
+void USBSIM_Frame(void);
+int USBSIM_Setup(uint8_t addr, const uint8_t *setup);
+int USBSIM_In(uint8_t addr, uint8_t epnum, uint8_t *buf);
+int USBSIM_Out(uint8_t addr, uint8_t epnum, const uint8_t *buf, uint32_t len);
+void USBSIM_Async(uint32_t accesses, USBSIM_ASYNC_FUNC func);
+void USBSIM_Flush(void);
+void USBSIM_GetStats(USBSIM_STATS_Type *stats);
+const char *USBSIM_Violation(void);
+
+#endif /* __USBSIM_H */
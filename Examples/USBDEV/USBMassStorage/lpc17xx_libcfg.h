@@ -43,7 +43,7 @@
 //#define _DBGFWK
 
 /* GPIO ------------------------------- */
-//#define _GPIO
+#define _GPIO
 
 /* EXTI ------------------------------- */
 //#define _EXTI
@@ -59,12 +59,12 @@
 //#define _SPI
 
 /* SSP ------------------------------- */
-//#define _SSP
-//#define _SSP0
+#define _SSP
+#define _SSP0
 //#define _SSP1
 
 /* SYSTICK --------------------------- */
-//#define _SYSTICK
+#define _SYSTICK
 
 /* I2C ------------------------------- */
 //#define _I2C
@@ -80,7 +80,7 @@
 
 
 /* GPDMA ------------------------------- */
-//#define _GPDMA
+#define _GPDMA
 
 
 /* DAC ------------------------------- */
@@ -101,8 +101,13 @@
 //#define _I2S
 
 /* USB device ------------------------------- */
-//#define _USBDEV
-//#define _USB_DMA
+#define _USBDEV
+#define _USB_DMA
+#define _USBDEV_MSC
+
+/* Block devices ------------------------------- */
+#define _BLKDEV
+#define _SDCARD
 
 /* QEI ------------------------------- */
 //#define _QEI
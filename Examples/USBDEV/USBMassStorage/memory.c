@@ -18,10 +18,8 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "usbcfg.h"
-#include "usbhw.h"
-#include "usbcore.h"
+#include "lpc17xx_usbdev_msc.h"
+#include "usbdesc.h"
 #include "mscuser.h"
 
 #include "memory.h"
@@ -29,13 +27,60 @@
 #include "lpc17xx_libcfg.h"
 #include "lpc17xx_nvic.h"
 
+#ifdef _SDCARD
+#include "lpc17xx_sdcard.h"
+#include "lpc17xx_systick.h"
+#endif
+
 /* Example group ----------------------------------------------------------- */
 /** @defgroup USBDEV_USBMassStorage	USBMassStorage
  * @ingroup USBDEV_Examples
  * @{
  */
 
-extern uint8_t Memory[MSC_MemorySize];         /* MSC Memory in RAM */
+extern uint8_t *Memory;                       /* MSC Memory in RAM */
+
+#ifdef _SDCARD
+extern SDC_Type SD_Card;                      /* SD card */
+extern BLK_CACHE_Type SD_Cache;               /* Its sector cache */
+#endif
+
+/* USB device configuration */
+const USBDEV_CFG_Type USB_Cfg = {
+	USB_DeviceDescriptor,
+	USB_ConfigDescriptor,
+	USB_StringDescriptor,
+	0,                                        /* EventMask */
+	NULL,                                     /* Event */
+#ifdef _USB_DMA
+	USBDEV_EP_BIT(MSC_EP_IN) | USBDEV_EP_BIT(MSC_EP_OUT), /* DMAEndpoints */
+#else
+	0,                                        /* DMAEndpoints */
+#endif
+	0                                         /* DeferMask */
+};
+
+
+/* USB Interrupt Handler */
+
+void USB_IRQHandler (void) {
+	USB_IntHandler();
+}
+
+#ifdef _SDCARD
+/* GPDMA Interrupt Handler: SD card data blocks */
+
+void DMA_IRQHandler (void) {
+	SDC_DMAHandler(&SD_Card);
+}
+
+/* SysTick Interrupt Handler: 1ms, sector cache and card waits */
+
+void SysTick_Handler (void) {
+	SYSTICK_ClearCounterFlag();
+	BLK_Poll(&SD_Cache.dev);
+}
+#endif
 
 
 /* Main Program */
@@ -43,11 +88,12 @@ extern uint8_t Memory[MSC_MemorySize];         /* MSC Memory in RAM */
 int main (void) {
 	uint32_t n;
 
-	for (n = 0; n < MSC_ImageSize; n++) {     /* Copy Initial Disk Image */
-		Memory[n] = DiskImage[n];               /*   from Flash to RAM     */
+	if (!MSC_Init()) {                        /* MSC Class Initialization */
+		for (n = 0; n < MSC_ImageSize; n++) {   /* No SD card: RAM disk */
+			Memory[n] = DiskImage[n];             /*   from Flash to RAM     */
+		}
 	}
-
-	USB_Init();                               /* USB Initialization */
+	USB_Init(&USB_Cfg);                       /* USB Initialization */
 	USB_Connect(TRUE);                        /* USB Connect */
 
 	while (1);                                /* Loop forever */
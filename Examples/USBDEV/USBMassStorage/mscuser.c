@@ -16,631 +16,219 @@
  *      Copyright (c) 2005-2009 Keil Software.
  *---------------------------------------------------------------------------*/
 
-#include "LPC17xx.h"
-
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "msc.h"
-#include "usbcfg.h"
-#include "usbhw.h"
-#include "usbcore.h"
+#include "lpc17xx_usbdev_msc.h"
 #include "mscuser.h"
 
 #include "memory.h"
 
+#include "lpc17xx_libcfg.h"
 
-uint8_t  Memory[MSC_MemorySize];  /* MSC RAM */
-
-uint32_t  MemOK;                   /* Memory OK */
+#ifdef _SDCARD
+#include "lpc17xx_sdcard.h"
+#include "lpc17xx_gpio.h"
+#include "lpc17xx_pinsel.h"
+#include "lpc17xx_systick.h"
+#endif
 
-uint32_t Offset;                  /* R/W Offset */
-uint32_t Length;                  /* R/W Length */
 
-uint8_t  BulkStage;               /* Bulk Stage */
+/* MSC RAM: AHB SRAM bank 0, reachable by the USB DMA and the GPDMA.
+   RAM disk when there is no SD card, sector cache otherwise */
+uint8_t *Memory = (uint8_t *)LPC_AHBRAM0_BASE;
 
-uint8_t  BulkBuf[MSC_MAX_PACKET]; /* Bulk In/Out Buffer */
-uint8_t  BulkLen;                 /* Bulk In/Out Length */
+/* MSC class driver instance */
+USBDEV_MSC_Type MSC_Dev;
 
-MSC_CBW CBW;                   /* Command Block Wrapper */
-MSC_CSW CSW;                   /* Command Status Wrapper */
+#ifdef _SDCARD
+/* SD card on SSP0: P0.15 SCK, P0.17 MISO, P0.18 MOSI, P0.16 /CS (GPIO) */
+#define SD_CS_PORT      0
+#define SD_CS_PIN       16
+/* Card detect P4.29, low when a card is inserted */
+#define SD_DETECT_PORT  4
+#define SD_DETECT_PIN   29
+/* SPI clock: SDC_Init() raises PCLK_SSP0 to CCLK / 2 for it */
+#define SD_CLOCK_RATE   25000000
+/* GPDMA channels */
+#define SD_DMA_TX       0
+#define SD_DMA_RX       1
 
+/* Sector cache: 4 lines of 8 blocks = AHB SRAM bank 0 (16KB) */
+#define SD_CACHE_LINES        4
+#define SD_CACHE_LINE_BLOCKS  8
+#define SD_CACHE_READ_AHEAD   2
+#define SD_CACHE_FLUSH_DELAY  500         /* ms idle before write-back */
 
-/*
- *  MSC Mass Storage Reset Request Callback
- *   Called automatically on Mass Storage Reset Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t MSC_Reset (void) {
-
-  BulkStage = MSC_BS_CBW;
-  return (TRUE);
-}
-
-
-/*
- *  MSC Get Max LUN Request Callback
- *   Called automatically on Get Max LUN Request
- *    Parameters:      None (global SetupPacket and EP0Buf)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-uint32_t MSC_GetMaxLUN (void) {
-
-  EP0Buf[0] = 0;               /* No LUN associated with this device */
-  return (TRUE);
-}
+/* SD card block device and its sector cache */
+SDC_Type SD_Card;
+BLK_CACHE_Type SD_Cache;
+#endif
 
 
 /*
  *  MSC Memory Read Callback
- *   Called automatically on Memory Read Event
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_MemoryRead (void) {
-  uint32_t n;
-
-  if (Length > MSC_MAX_PACKET) {
-    n = MSC_MAX_PACKET;
-  } else {
-    n = Length;
-  }
-
-  if ((Offset + n) > MSC_MemorySize) {
-    n = MSC_MemorySize - Offset;
-    BulkStage = MSC_BS_DATA_IN_LAST_STALL;
-  }
-
-  USB_WriteEP(MSC_EP_IN, &Memory[Offset], n);
-  Offset += n;
-  Length -= n;
-
-  CSW.dDataResidue -= n;
-
-  if (Length == 0) {
-    BulkStage = MSC_BS_DATA_IN_LAST;
-  }
-
-  if (BulkStage != MSC_BS_DATA_IN) {
-    CSW.bStatus = CSW_CMD_PASSED;
-  }
-}
-
-
-/*
- *  MSC Memory Write Callback
- *   Called automatically on Memory Write Event
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_MemoryWrite (void) {
-  uint32_t n;
-
-  if ((Offset + BulkLen) > MSC_MemorySize) {
-    BulkLen = MSC_MemorySize - Offset;
-    BulkStage = MSC_BS_CSW;
-    USB_SetStallEP(MSC_EP_OUT);
-  }
-
-  for (n = 0; n < BulkLen; n++) {
-    Memory[Offset + n] = BulkBuf[n];
-  }
-
-  Offset += BulkLen;
-  Length -= BulkLen;
-
-  CSW.dDataResidue -= BulkLen;
-
-  if ((Length == 0) || (BulkStage == MSC_BS_CSW)) {
-    CSW.bStatus = CSW_CMD_PASSED;
-    MSC_SetCSW();
-  }
-}
-
-
-/*
- *  MSC Memory Verify Callback
- *   Called automatically on Memory Verify Event
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_MemoryVerify (void) {
-  uint32_t n;
-
-  if ((Offset + BulkLen) > MSC_MemorySize) {
-    BulkLen = MSC_MemorySize - Offset;
-    BulkStage = MSC_BS_CSW;
-    USB_SetStallEP(MSC_EP_OUT);
-  }
-
-  for (n = 0; n < BulkLen; n++) {
-    if (Memory[Offset + n] != BulkBuf[n]) {
-      MemOK = FALSE;
-      break;
-    }
-  }
-
-  Offset += BulkLen;
-  Length -= BulkLen;
-
-  CSW.dDataResidue -= BulkLen;
-
-  if ((Length == 0) || (BulkStage == MSC_BS_CSW)) {
-    CSW.bStatus = (MemOK) ? CSW_CMD_PASSED : CSW_CMD_FAILED;
-    MSC_SetCSW();
-  }
-}
-
-
-/*
- *  MSC SCSI Read/Write Setup Callback
- *    Parameters:      None (global variables)
+ *   Called by the MSC class driver to read the RAM disk
+ *    Parameters:      msc: MSC class driver instance
+ *                     offset: byte offset, buf: destination, len: bytes
  *    Return Value:    TRUE - Success, FALSE - Error
  */
 
-uint32_t MSC_RWSetup (void) {
+static uint32_t MSC_MemoryRead (USBDEV_MSC_Type *msc, uint32_t offset,
+                                uint8_t *buf, uint32_t len) {
   uint32_t n;
 
-  /* Logical Block Address of First Block */
-  n = (CBW.CB[2] << 24) |
-      (CBW.CB[3] << 16) |
-      (CBW.CB[4] <<  8) |
-      (CBW.CB[5] <<  0);
-
-  Offset = n * MSC_BlockSize;
-
-  /* Number of Blocks to transfer */
-  n = (CBW.CB[7] <<  8) |
-      (CBW.CB[8] <<  0);
-
-  Length = n * MSC_BlockSize;
-
-  if (CBW.dDataLength != Length) {
-    USB_SetStallEP(MSC_EP_IN);
-    USB_SetStallEP(MSC_EP_OUT);
-    CSW.bStatus = CSW_PHASE_ERROR;
-    MSC_SetCSW();
+  if ((offset + len) > MSC_MemorySize) {
     return (FALSE);
   }
-
+  for (n = 0; n < len; n++) {
+    buf[n] = Memory[offset + n];
+  }
   return (TRUE);
 }
 
 
 /*
- *  Check Data IN Format
- *    Parameters:      None (global variables)
+ *  MSC Memory Write Callback
+ *   Called by the MSC class driver to write the RAM disk
+ *    Parameters:      msc: MSC class driver instance
+ *                     offset: byte offset, buf: source, len: bytes
  *    Return Value:    TRUE - Success, FALSE - Error
  */
 
-uint32_t DataInFormat (void) {
+static uint32_t MSC_MemoryWrite (USBDEV_MSC_Type *msc, uint32_t offset,
+                                 uint8_t *buf, uint32_t len) {
+  uint32_t n;
 
-  if (CBW.dDataLength == 0) {
-    CSW.bStatus = CSW_PHASE_ERROR;
-    MSC_SetCSW();
+  if ((offset + len) > MSC_MemorySize) {
     return (FALSE);
   }
-  if ((CBW.bmFlags & 0x80) == 0) {
-    USB_SetStallEP(MSC_EP_OUT);
-    CSW.bStatus = CSW_PHASE_ERROR;
-    MSC_SetCSW();
-    return (FALSE);
+  for (n = 0; n < len; n++) {
+    Memory[offset + n] = buf[n];
   }
   return (TRUE);
 }
 
 
+#ifdef _USB_DMA
 /*
- *  Perform Data IN Transfer
- *    Parameters:      None (global variables)
- *    Return Value:    TRUE - Success, FALSE - Error
- */
-
-void DataInTransfer (void) {
-
-  if (BulkLen > CBW.dDataLength) {
-    BulkLen = CBW.dDataLength;
-  }
-
-  USB_WriteEP(MSC_EP_IN, BulkBuf, BulkLen);
-  BulkStage = MSC_BS_DATA_IN_LAST;
-
-  CSW.dDataResidue -= BulkLen;
-  CSW.bStatus = CSW_CMD_PASSED;
-}
-
-
-/*
- *  MSC SCSI Test Unit Ready Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
+ *  MSC Memory Map Callback
+ *   Called by the MSC class driver to move data by DMA straight
+ *   from and to the RAM disk
+ *    Parameters:      msc: MSC class driver instance
+ *                     offset: byte offset, len: bytes
+ *    Return Value:    Address of the data in the RAM disk
  */
 
-void MSC_TestUnitReady (void) {
-
-  if (CBW.dDataLength != 0) {
-    if ((CBW.bmFlags & 0x80) != 0) {
-      USB_SetStallEP(MSC_EP_IN);
-    } else {
-      USB_SetStallEP(MSC_EP_OUT);
-    }
-  }
-
-  CSW.bStatus = CSW_CMD_PASSED;
-  MSC_SetCSW();
+static uint8_t *MSC_MemoryMap (USBDEV_MSC_Type *msc, uint32_t offset,
+                               uint32_t len) {
+  return (&Memory[offset]);
 }
+#endif
 
 
+#ifdef _SDCARD
 /*
- *  MSC SCSI Request Sense Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
+ *  SD Card Initialization
+ *   Identifies the SD card if one is inserted, then puts the sector
+ *   cache in front of it. SysTick polls the cache every 1ms; USB, GPDMA
+ *   and SysTick interrupts share one priority (block device rule)
+ *    Parameters:      None
+ *    Return Value:    TRUE - SD card ready, FALSE - no card
  */
 
-void MSC_RequestSense (void) {
-
-  if (!DataInFormat()) return;
-
-  BulkBuf[ 0] = 0x70;          /* Response Code */
-  BulkBuf[ 1] = 0x00;
-  BulkBuf[ 2] = 0x02;          /* Sense Key */
-  BulkBuf[ 3] = 0x00;
-  BulkBuf[ 4] = 0x00;
-  BulkBuf[ 5] = 0x00;
-  BulkBuf[ 6] = 0x00;
-  BulkBuf[ 7] = 0x0A;          /* Additional Length */
-  BulkBuf[ 8] = 0x00;
-  BulkBuf[ 9] = 0x00;
-  BulkBuf[10] = 0x00;
-  BulkBuf[11] = 0x00;
-  BulkBuf[12] = 0x30;          /* ASC */
-  BulkBuf[13] = 0x01;          /* ASCQ */
-  BulkBuf[14] = 0x00;
-  BulkBuf[15] = 0x00;
-  BulkBuf[16] = 0x00;
-  BulkBuf[17] = 0x00;
-
-  BulkLen = 18;
-  DataInTransfer();
-}
-
-
-/*
- *  MSC SCSI Inquiry Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_Inquiry (void) {
-
-  if (!DataInFormat()) return;
-
-  BulkBuf[ 0] = 0x00;          /* Direct Access Device */
-  BulkBuf[ 1] = 0x80;          /* RMB = 1: Removable Medium */
-  BulkBuf[ 2] = 0x00;          /* Version: No conformance claim to standard */
-  BulkBuf[ 3] = 0x01;
-
-  BulkBuf[ 4] = 36-4;          /* Additional Length */
-  BulkBuf[ 5] = 0x80;          /* SCCS = 1: Storage Controller Component */
-  BulkBuf[ 6] = 0x00;
-  BulkBuf[ 7] = 0x00;
-
-  BulkBuf[ 8] = 'K';           /* Vendor Identification */
-  BulkBuf[ 9] = 'e';
-  BulkBuf[10] = 'i';
-  BulkBuf[11] = 'l';
-  BulkBuf[12] = ' ';
-  BulkBuf[13] = ' ';
-  BulkBuf[14] = ' ';
-  BulkBuf[15] = ' ';
-
-  BulkBuf[16] = 'L';           /* Product Identification */
-  BulkBuf[17] = 'P';
-  BulkBuf[18] = 'C';
-  BulkBuf[19] = '1';
-  BulkBuf[20] = '7';
-  BulkBuf[21] = 'x';
-  BulkBuf[22] = 'x';
-  BulkBuf[23] = ' ';
-  BulkBuf[24] = 'D';
-  BulkBuf[25] = 'i';
-  BulkBuf[26] = 's';
-  BulkBuf[27] = 'k';
-  BulkBuf[28] = ' ';
-  BulkBuf[29] = ' ';
-  BulkBuf[30] = ' ';
-  BulkBuf[31] = ' ';
-
-  BulkBuf[32] = '1';           /* Product Revision Level */
-  BulkBuf[33] = '.';
-  BulkBuf[34] = '0';
-  BulkBuf[35] = ' ';
-
-  BulkLen = 36;
-  DataInTransfer();
-}
-
-
-/*
- *  MSC SCSI Mode Sense (6-Byte) Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_ModeSense6 (void) {
-
-  if (!DataInFormat()) return;
+static uint32_t MSC_CardInit (void) {
+  PINSEL_CFG_Type PinCfg;
 
-  BulkBuf[ 0] = 0x03;
-  BulkBuf[ 1] = 0x00;
-  BulkBuf[ 2] = 0x00;
-  BulkBuf[ 3] = 0x00;
+  PinCfg.Funcnum = 2;                       /* SSP0 */
+  PinCfg.OpenDrain = 0;
+  PinCfg.Pinmode = 0;
+  PinCfg.Portnum = 0;
+  PinCfg.Pinnum = 15;
+  PINSEL_ConfigPin(&PinCfg);
+  PinCfg.Pinnum = 17;
+  PINSEL_ConfigPin(&PinCfg);
+  PinCfg.Pinnum = 18;
+  PINSEL_ConfigPin(&PinCfg);
+  PinCfg.Funcnum = 0;                       /* GPIO: /CS, card detect */
+  PinCfg.Pinnum = SD_CS_PIN;
+  PINSEL_ConfigPin(&PinCfg);
+  PinCfg.Portnum = SD_DETECT_PORT;
+  PinCfg.Pinnum = SD_DETECT_PIN;
+  PINSEL_ConfigPin(&PinCfg);
+  GPIO_SetDir(SD_DETECT_PORT, (1 << SD_DETECT_PIN), 0);
 
-  BulkLen = 4;
-  DataInTransfer();
-}
-
-
-/*
- *  MSC SCSI Mode Sense (10-Byte) Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_ModeSense10 (void) {
-
-  if (!DataInFormat()) return;
-
-  BulkBuf[ 0] = 0x00;
-  BulkBuf[ 1] = 0x06;
-  BulkBuf[ 2] = 0x00;
-  BulkBuf[ 3] = 0x00;
-  BulkBuf[ 4] = 0x00;
-  BulkBuf[ 5] = 0x00;
-  BulkBuf[ 6] = 0x00;
-  BulkBuf[ 7] = 0x00;
-
-  BulkLen = 8;
-  DataInTransfer();
-}
-
-
-/*
- *  MSC SCSI Read Capacity Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_ReadCapacity (void) {
-
-  if (!DataInFormat()) return;
-
-  /* Last Logical Block */
-  BulkBuf[ 0] = ((MSC_BlockCount - 1) >> 24) & 0xFF;
-  BulkBuf[ 1] = ((MSC_BlockCount - 1) >> 16) & 0xFF;
-  BulkBuf[ 2] = ((MSC_BlockCount - 1) >>  8) & 0xFF;
-  BulkBuf[ 3] = ((MSC_BlockCount - 1) >>  0) & 0xFF;
-
-  /* Block Length */
-  BulkBuf[ 4] = (MSC_BlockSize >> 24) & 0xFF;
-  BulkBuf[ 5] = (MSC_BlockSize >> 16) & 0xFF;
-  BulkBuf[ 6] = (MSC_BlockSize >>  8) & 0xFF;
-  BulkBuf[ 7] = (MSC_BlockSize >>  0) & 0xFF;
-
-  BulkLen = 8;
-  DataInTransfer();
-}
-
-
-/*
- *  MSC SCSI Read Format Capacity Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_ReadFormatCapacity (void) {
-
-  if (!DataInFormat()) return;
-
-  BulkBuf[ 0] = 0x00;
-  BulkBuf[ 1] = 0x00;
-  BulkBuf[ 2] = 0x00;
-  BulkBuf[ 3] = 0x08;          /* Capacity List Length */
-
-  /* Block Count */
-  BulkBuf[ 4] = (MSC_BlockCount >> 24) & 0xFF;
-  BulkBuf[ 5] = (MSC_BlockCount >> 16) & 0xFF;
-  BulkBuf[ 6] = (MSC_BlockCount >>  8) & 0xFF;
-  BulkBuf[ 7] = (MSC_BlockCount >>  0) & 0xFF;
-
-  /* Block Length */
-  BulkBuf[ 8] = 0x02;          /* Descriptor Code: Formatted Media */
-  BulkBuf[ 9] = (MSC_BlockSize >> 16) & 0xFF;
-  BulkBuf[10] = (MSC_BlockSize >>  8) & 0xFF;
-  BulkBuf[11] = (MSC_BlockSize >>  0) & 0xFF;
-
-  BulkLen = 12;
-  DataInTransfer();
-}
-
-
-/*
- *  MSC Get Command Block Wrapper Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_GetCBW (void) {
-  uint32_t n;
-
-  for (n = 0; n < BulkLen; n++) {
-    *((uint8_t *)&CBW + n) = BulkBuf[n];
+  if (GPIO_ReadValue(SD_DETECT_PORT) & (1 << SD_DETECT_PIN)) {
+    return (FALSE);                         /* No card */
   }
-  if ((BulkLen == sizeof(CBW)) && (CBW.dSignature == MSC_CBW_Signature)) {
-    /* Valid CBW */
-    CSW.dTag = CBW.dTag;
-    CSW.dDataResidue = CBW.dDataLength;
-    if ((CBW.bLUN != 0) || (CBW.bCBLength < 1) || CBW.bCBLength > 16) {
-fail: CSW.bStatus = CSW_CMD_FAILED;
-      MSC_SetCSW();
-    } else {
-      switch (CBW.CB[0]) {
-        case SCSI_TEST_UNIT_READY:
-          MSC_TestUnitReady();
-          break;
-        case SCSI_REQUEST_SENSE:
-          MSC_RequestSense();
-          break;
-        case SCSI_FORMAT_UNIT:
-          goto fail;
-        case SCSI_INQUIRY:
-          MSC_Inquiry();
-          break;
-        case SCSI_START_STOP_UNIT:
-          goto fail;
-        case SCSI_MEDIA_REMOVAL:
-          goto fail;
-        case SCSI_MODE_SELECT6:
-          goto fail;
-        case SCSI_MODE_SENSE6:
-          MSC_ModeSense6();
-          break;
-        case SCSI_MODE_SELECT10:
-          goto fail;
-        case SCSI_MODE_SENSE10:
-          MSC_ModeSense10();
-          break;
-        case SCSI_READ_FORMAT_CAPACITIES:
-          MSC_ReadFormatCapacity();
-          break;
-        case SCSI_READ_CAPACITY:
-          MSC_ReadCapacity();
-          break;
-        case SCSI_READ10:
-          if (MSC_RWSetup()) {
-            if ((CBW.bmFlags & 0x80) != 0) {
-              BulkStage = MSC_BS_DATA_IN;
-              MSC_MemoryRead();
-            } else {
-              USB_SetStallEP(MSC_EP_OUT);
-              CSW.bStatus = CSW_PHASE_ERROR;
-              MSC_SetCSW();
-            }
-          }
-          break;
-        case SCSI_WRITE10:
-          if (MSC_RWSetup()) {
-            if ((CBW.bmFlags & 0x80) == 0) {
-              BulkStage = MSC_BS_DATA_OUT;
-            } else {
-              USB_SetStallEP(MSC_EP_IN);
-              CSW.bStatus = CSW_PHASE_ERROR;
-              MSC_SetCSW();
-            }
-          }
-          break;
-        case SCSI_VERIFY10:
-          if (MSC_RWSetup()) {
-            if ((CBW.bmFlags & 0x80) == 0) {
-              BulkStage = MSC_BS_DATA_OUT;
-              MemOK = TRUE;
-            } else {
-              USB_SetStallEP(MSC_EP_IN);
-              CSW.bStatus = CSW_PHASE_ERROR;
-              MSC_SetCSW();
-            }
-          }
-          break;
-        default:
-          goto fail;
-      }
-    }
-  } else {
-    /* Invalid CBW */
-    USB_SetStallEP(MSC_EP_IN);
-    USB_SetStallEP(MSC_EP_OUT);
-    BulkStage = MSC_BS_ERROR;
-  }
-}
 
-
-/*
- *  MSC Set Command Status Wrapper Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_SetCSW (void) {
-
-  CSW.dSignature = MSC_CSW_Signature;
-  USB_WriteEP(MSC_EP_IN, (uint8_t *)&CSW, sizeof(CSW));
-  BulkStage = MSC_BS_CSW;
-}
-
-
-/*
- *  MSC Bulk In Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
-
-void MSC_BulkIn (void) {
-
-  switch (BulkStage) {
-    case MSC_BS_DATA_IN:
-      switch (CBW.CB[0]) {
-        case SCSI_READ10:
-          MSC_MemoryRead();
-          break;
-      }
-      break;
-    case MSC_BS_DATA_IN_LAST:
-      MSC_SetCSW();
-      break;
-    case MSC_BS_DATA_IN_LAST_STALL:
-      USB_SetStallEP(MSC_EP_IN);
-      MSC_SetCSW();
-      break;
-    case MSC_BS_CSW:
-      BulkStage = MSC_BS_CBW;
-      break;
+  GPDMA_Init();
+  SD_Card.SSPx = LPC_SSP0;
+  SD_Card.CSPort = SD_CS_PORT;
+  SD_Card.CSPin = SD_CS_PIN;
+  SD_Card.DMATx = SD_DMA_TX;
+  SD_Card.DMARx = SD_DMA_RX;
+  SD_Card.ClockRate = SD_CLOCK_RATE;
+  SD_Card.PreErase = TRUE;               /* Cache lines written by CMD25 */
+  if (SDC_Init(&SD_Card) != SUCCESS) {
+    return (FALSE);
   }
-}
 
+  SD_Cache.Lower = &SD_Card.dev;
+  SD_Cache.Buf = Memory;
+  SD_Cache.NumLines = SD_CACHE_LINES;
+  SD_Cache.LineBlocks = SD_CACHE_LINE_BLOCKS;
+  SD_Cache.ReadAhead = SD_CACHE_READ_AHEAD;
+  SD_Cache.FlushDelay = SD_CACHE_FLUSH_DELAY;
+  if (BLK_CacheInit(&SD_Cache) != SUCCESS) {
+    return (FALSE);
+  }
 
-/*
- *  MSC Bulk Out Callback
- *    Parameters:      None (global variables)
- *    Return Value:    None
- */
+  NVIC_SetPriority(USB_IRQn, ((0x01<<3)|0x01));
+  NVIC_SetPriority(DMA_IRQn, ((0x01<<3)|0x01));
+  NVIC_SetPriority(SysTick_IRQn, ((0x01<<3)|0x01));
+  NVIC_EnableIRQ(DMA_IRQn);
 
-void MSC_BulkOut (void) {
-
-  BulkLen = USB_ReadEP(MSC_EP_OUT, BulkBuf);
-  switch (BulkStage) {
-    case MSC_BS_CBW:
-      MSC_GetCBW();
-      break;
-    case MSC_BS_DATA_OUT:
-      switch (CBW.CB[0]) {
-        case SCSI_WRITE10:
-          MSC_MemoryWrite();
-          break;
-        case SCSI_VERIFY10:
-          MSC_MemoryVerify();
-          break;
-      }
-      break;
-    default:
-      USB_SetStallEP(MSC_EP_OUT);
-      CSW.bStatus = CSW_PHASE_ERROR;
-      MSC_SetCSW();
-      break;
-  }
+  SYSTICK_InternalInit(1);                  /* 1ms */
+  SYSTICK_IntCmd(ENABLE);
+  SYSTICK_Cmd(ENABLE);
+  return (TRUE);
+}
+#endif
+
+
+/*
+ *  MSC Initialization
+ *   Registers the MSC class driver for the SD card if one is inserted,
+ *   otherwise for the RAM disk
+ *    Parameters:      None
+ *    Return Value:    TRUE - SD card, FALSE - RAM disk (to be loaded)
+ */
+
+uint32_t MSC_Init (void) {
+  uint32_t card = FALSE;
+
+  MSC_Dev.IF = 0;
+  MSC_Dev.EP_IN = MSC_EP_IN;
+  MSC_Dev.EP_OUT = MSC_EP_OUT;
+  MSC_Dev.BlockSize = MSC_BlockSize;
+  MSC_Dev.BlockCount = MSC_BlockCount;
+  MSC_Dev.InquiryID = NULL;
+  MSC_Dev.Read = MSC_MemoryRead;
+  MSC_Dev.Write = MSC_MemoryWrite;
+#ifdef _USB_DMA
+  MSC_Dev.DMABuf = (uint8_t *)DMA_BUF_ADR;  /* CBW, CSW and short responses */
+  MSC_Dev.DMABufSize = DMA_BUF_SZ;
+  MSC_Dev.Map = MSC_MemoryMap;              /* READ10/WRITE10 data in place */
+  MSC_Dev.Dev = NULL;
+#ifdef _SDCARD
+  card = MSC_CardInit();
+  if (card) {
+    MSC_Dev.Dev = &SD_Cache.dev;            /* Sizes taken from the card */
+  }
+#endif
+#else
+  MSC_Dev.DMABuf = NULL;
+#endif
+  USB_MscInit(&MSC_Dev);
+  return (card);
 }
@@ -31,22 +31,12 @@
 #define MSC_BlockCount  (MSC_MemorySize / MSC_BlockSize)
 
 
-/* Max In/Out Packet Size */
-#define MSC_MAX_PACKET  64
-
 /* MSC In/Out Endpoint Address */
 #define MSC_EP_IN       0x82
 #define MSC_EP_OUT      0x02
 
-/* MSC Requests Callback Functions */
-extern uint32_t MSC_Reset     (void);
-extern uint32_t MSC_GetMaxLUN (void);
-
-/* MSC Bulk Callback Functions */
-extern void MSC_GetCBW (void);
-extern void MSC_SetCSW (void);
-extern void MSC_BulkIn (void);
-extern void MSC_BulkOut(void);
+/* MSC Initialization Function */
+extern uint32_t MSC_Init (void);
 
 
 #endif  /* __MSCUSER_H__ */
@@ -18,9 +18,7 @@
 
 #include "lpc_types.h"
 
-#include "usb.h"
-#include "msc.h"
-#include "usbcfg.h"
+#include "lpc17xx_usbdev_msc.h"
 #include "usbdesc.h"
 
 
@@ -36,9 +34,9 @@ const uint8_t USB_DeviceDescriptor[] = {
   WBVAL(0xC251),                     /* idVendor */
   WBVAL(0x1303),                     /* idProduct */
   WBVAL(0x0100), /* 1.00 */          /* bcdDevice */
-  0x04,                              /* iManufacturer */
-  0x20,                              /* iProduct */
-  0x48,                              /* iSerialNumber */
+  0x01,                              /* iManufacturer */
+  0x02,                              /* iProduct */
+  0x03,                              /* iSerialNumber */
   0x01                               /* bNumConfigurations */
 };
 
@@ -68,7 +66,7 @@ const uint8_t USB_ConfigDescriptor[] = {
   USB_DEVICE_CLASS_STORAGE,          /* bInterfaceClass */
   MSC_SUBCLASS_SCSI,                 /* bInterfaceSubClass */
   MSC_PROTOCOL_BULK_ONLY,            /* bInterfaceProtocol */
-  0x62,                              /* iInterface */
+  0x04,                              /* iInterface */
 /* Bulk In Endpoint */
   USB_ENDPOINT_DESC_SIZE,            /* bLength */
   USB_ENDPOINT_DESCRIPTOR_TYPE,      /* bDescriptorType */
@@ -93,7 +91,7 @@ const uint8_t USB_StringDescriptor[] = {
   0x04,                              /* bLength */
   USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
   WBVAL(0x0409), /* US English */    /* wLANGID */
-/* Index 0x04: Manufacturer */
+/* Index 0x01: Manufacturer */
   0x1C,                              /* bLength */
   USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
   'N',0,
@@ -109,7 +107,7 @@ const uint8_t USB_StringDescriptor[] = {
   'n',0,
   'd',0,
   ' ',0,
-/* Index 0x20: Product */
+/* Index 0x02: Product */
   0x28,                              /* bLength */
   USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
   'N',0,
@@ -131,7 +129,7 @@ const uint8_t USB_StringDescriptor[] = {
   'r',0,
   'y',0,
   ' ',0,
-/* Index 0x48: Serial Number */
+/* Index 0x03: Serial Number */
   0x1A,                              /* bLength */
   USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
   'D',0,
@@ -146,7 +144,7 @@ const uint8_t USB_StringDescriptor[] = {
   '0',0,
   '0',0,
   '0',0,
-/* Index 0x62: Interface 0, Alternate Setting 0 */
+/* Index 0x04: Interface 0, Alternate Setting 0 */
   0x0E,                              /* bLength */
   USB_STRING_DESCRIPTOR_TYPE,        /* bDescriptorType */
   'M',0,
@@ -155,4 +153,6 @@ const uint8_t USB_StringDescriptor[] = {
   'o',0,
   'r',0,
   'y',0,
+/* Terminator */
+  0                                  /* bLength */
 };
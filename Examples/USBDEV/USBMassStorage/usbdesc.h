@@ -18,12 +18,10 @@
 #define __USBDESC_H__
 
 
-#define WBVAL(x) (x & 0xFF),((x >> 8) & 0xFF)
+#include "lpc17xx_usbdev.h"
 
-#define USB_DEVICE_DESC_SIZE        (sizeof(USB_DEVICE_DESCRIPTOR))
-#define USB_CONFIGUARTION_DESC_SIZE (sizeof(USB_CONFIGURATION_DESCRIPTOR))
-#define USB_INTERFACE_DESC_SIZE     (sizeof(USB_INTERFACE_DESCRIPTOR))
-#define USB_ENDPOINT_DESC_SIZE      (sizeof(USB_ENDPOINT_DESCRIPTOR))
+/* Max Packet Size of Endpoint 0 */
+#define USB_MAX_PACKET0             64
 
 extern const uint8_t USB_DeviceDescriptor[];
 extern const uint8_t USB_ConfigDescriptor[];